@@ -42,14 +42,27 @@ bool BootControlShared::Init() {
 }
 
 Return<bool> BootControlShared::setSnapshotMergeStatus(MergeStatus status) {
-    return SetMiscVirtualAbMergeStatus(getCurrentSlot(), status);
+    std::lock_guard<std::mutex> lock(mCacheLock);
+    if (!SetMiscVirtualAbMergeStatus(getCurrentSlot(), status)) {
+        // The on-disk state is uncertain after a failed write; drop the cache
+        // so the next query goes back to misc.
+        mMergeStatus.reset();
+        return false;
+    }
+    mMergeStatus = status;
+    return true;
 }
 
 Return<MergeStatus> BootControlShared::getSnapshotMergeStatus() {
+    std::lock_guard<std::mutex> lock(mCacheLock);
+    if (mMergeStatus.has_value()) {
+        return *mMergeStatus;
+    }
     MergeStatus status;
     if (!GetMiscVirtualAbMergeStatus(getCurrentSlot(), &status)) {
         return MergeStatus::UNKNOWN;
     }
+    mMergeStatus = status;
     return status;
 }
 
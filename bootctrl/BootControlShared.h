@@ -20,6 +20,9 @@
 #include <hidl/MQDescriptor.h>
 #include <hidl/Status.h>
 
+#include <mutex>
+#include <optional>
+
 namespace android {
 namespace hardware {
 namespace boot {
@@ -36,6 +39,14 @@ struct BootControlShared : public IBootControl {
 
     Return<bool> setSnapshotMergeStatus(MergeStatus status) override;
     Return<MergeStatus> getSnapshotMergeStatus() override;
+
+  private:
+    // Merge status cached after the first read from misc. The HAL is the only
+    // writer of this field while Android is up, so the cache stays valid until
+    // the next setSnapshotMergeStatus(); update_engine's polling during the
+    // merge window is answered from memory instead of re-reading misc.
+    std::mutex mCacheLock;
+    std::optional<MergeStatus> mMergeStatus;
 };
 
 extern "C" IBootControl *HIDL_FETCH_IBootControl(const char *name);
@@ -35,17 +35,50 @@ using ::android::hardware::boot::V1_0::CommandResult;
 
 BootControl::BootControl(boot_control_module_t *module) : mModule(module) {}
 
+// Returns the cache entry for the given slot, growing the mirror on first
+// use. Must be called with mCacheLock held.
+BootControl::SlotCache *BootControl::slotCacheLocked(uint32_t slot) {
+    if (!mNumSlots) {
+        mNumSlots = mModule->getNumberSlots(mModule);
+    }
+    if (slot >= *mNumSlots) {
+        return nullptr;
+    }
+    if (mSlots.size() < *mNumSlots) {
+        mSlots.resize(*mNumSlots);
+    }
+    return &mSlots[slot];
+}
+
 // Methods from ::android::hardware::boot::V1_0::IBootControl follow.
 Return<uint32_t> BootControl::getNumberSlots() {
-    return mModule->getNumberSlots(mModule);
+    std::lock_guard lock(mCacheLock);
+    if (!mNumSlots) {
+        mNumSlots = mModule->getNumberSlots(mModule);
+    }
+    return *mNumSlots;
 }
 
 Return<uint32_t> BootControl::getCurrentSlot() {
-    return mModule->getCurrentSlot(mModule);
+    std::lock_guard lock(mCacheLock);
+    if (!mCurrentSlot) {
+        mCurrentSlot = mModule->getCurrentSlot(mModule);
+    }
+    return *mCurrentSlot;
 }
 
 Return<void> BootControl::markBootSuccessful(markBootSuccessful_cb _hidl_cb) {
     int ret = mModule->markBootSuccessful(mModule);
+    if (ret == 0) {
+        std::lock_guard lock(mCacheLock);
+        if (!mCurrentSlot) {
+            mCurrentSlot = mModule->getCurrentSlot(mModule);
+        }
+        if (SlotCache *cache = slotCacheLocked(*mCurrentSlot)) {
+            cache->successful = true;
+            cache->bootable = true;
+        }
+    }
     struct CommandResult cr;
     cr.success = (ret == 0);
     cr.errMsg = strerror(-ret);
@@ -55,6 +88,16 @@ Return<void> BootControl::markBootSuccessful(markBootSuccessful_cb _hidl_cb) {
 
 Return<void> BootControl::setActiveBootSlot(uint32_t slot, setActiveBootSlot_cb _hidl_cb) {
     int ret = mModule->setActiveBootSlot(mModule, slot);
+    if (ret == 0) {
+        std::lock_guard lock(mCacheLock);
+        mActiveSlot = slot;
+        // The module also resets the slot's retry/successful state; refetch
+        // those lazily rather than guessing its exact policy.
+        if (SlotCache *cache = slotCacheLocked(slot)) {
+            cache->bootable.reset();
+            cache->successful.reset();
+        }
+    }
     struct CommandResult cr;
     cr.success = (ret == 0);
     cr.errMsg = strerror(-ret);
@@ -64,6 +107,14 @@ Return<void> BootControl::setActiveBootSlot(uint32_t slot, setActiveBootSlot_cb
 
 Return<void> BootControl::setSlotAsUnbootable(uint32_t slot, setSlotAsUnbootable_cb _hidl_cb) {
     int ret = mModule->setSlotAsUnbootable(mModule, slot);
+    if (ret == 0) {
+        std::lock_guard lock(mCacheLock);
+        mActiveSlot.reset();
+        if (SlotCache *cache = slotCacheLocked(slot)) {
+            cache->bootable = false;
+            cache->successful.reset();
+        }
+    }
     struct CommandResult cr;
     cr.success = (ret == 0);
     cr.errMsg = strerror(-ret);
@@ -72,26 +123,52 @@ Return<void> BootControl::setSlotAsUnbootable(uint32_t slot, setSlotAsUnbootable
 }
 
 Return<BoolResult> BootControl::isSlotBootable(uint32_t slot) {
+    std::lock_guard lock(mCacheLock);
+    SlotCache *cache = slotCacheLocked(slot);
+    if (cache != nullptr && cache->bootable) {
+        return *cache->bootable ? BoolResult::TRUE : BoolResult::FALSE;
+    }
     int32_t ret = mModule->isSlotBootable(mModule, slot);
     if (ret < 0) {
         return BoolResult::INVALID_SLOT;
     }
+    if (cache != nullptr) {
+        cache->bootable = (ret != 0);
+    }
     return ret ? BoolResult::TRUE : BoolResult::FALSE;
 }
 
 Return<BoolResult> BootControl::isSlotMarkedSuccessful(uint32_t slot) {
+    std::lock_guard lock(mCacheLock);
+    SlotCache *cache = slotCacheLocked(slot);
+    if (cache != nullptr && cache->successful) {
+        return *cache->successful ? BoolResult::TRUE : BoolResult::FALSE;
+    }
     int32_t ret = mModule->isSlotMarkedSuccessful(mModule, slot);
     if (ret < 0) {
         return BoolResult::INVALID_SLOT;
     }
+    if (cache != nullptr) {
+        cache->successful = (ret != 0);
+    }
     return ret ? BoolResult::TRUE : BoolResult::FALSE;
 }
 
 Return<void> BootControl::getSuffix(uint32_t slot, getSuffix_cb _hidl_cb) {
     hidl_string ans;
+    std::lock_guard lock(mCacheLock);
+    SlotCache *cache = slotCacheLocked(slot);
+    if (cache != nullptr && !cache->suffix.empty()) {
+        ans = cache->suffix.c_str();
+        _hidl_cb(ans);
+        return Void();
+    }
     const char *suffix = mModule->getSuffix(mModule, slot);
     if (suffix) {
         ans = suffix;
+        if (cache != nullptr) {
+            cache->suffix = suffix;
+        }
     }
     _hidl_cb(ans);
     return Void();
@@ -105,7 +182,11 @@ Return<uint32_t> BootControl::getActiveBootSlot() {
               " control HAL.");
         return 0;
     }
-    return get_active_slot(mModule);
+    std::lock_guard lock(mCacheLock);
+    if (!mActiveSlot) {
+        mActiveSlot = get_active_slot(mModule);
+    }
+    return *mActiveSlot;
 }
 
 IBootControl *HIDL_FETCH_IBootControl(const char * /* hal */) {
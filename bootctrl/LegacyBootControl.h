@@ -19,6 +19,11 @@
 #include <hidl/MQDescriptor.h>
 #include <hidl/Status.h>
 
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "BootControlShared.h"
 
 namespace android {
@@ -47,7 +52,26 @@ struct BootControl : public BootControlShared {
     Return<uint32_t> getActiveBootSlot() override;
 
   private:
+    // In-memory mirror of the slot metadata held by the boot control module.
+    // Entries are filled lazily from the module and then served from memory;
+    // the mutation entry points update or invalidate the affected entries, so
+    // update_engine's query loop stops hitting the metadata partition behind
+    // the module on every call.
+    struct SlotCache {
+        std::optional<bool> bootable;
+        std::optional<bool> successful;
+        std::string suffix;
+    };
+
+    SlotCache *slotCacheLocked(uint32_t slot);
+
     boot_control_module_t *mModule;
+
+    std::mutex mCacheLock;
+    std::optional<uint32_t> mNumSlots;
+    std::optional<uint32_t> mCurrentSlot;
+    std::optional<uint32_t> mActiveSlot;
+    std::vector<SlotCache> mSlots;
 };
 
 extern "C" IBootControl *HIDL_FETCH_IBootControl(const char *name);
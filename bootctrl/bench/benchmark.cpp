@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <android-base/file.h>
+#include <bootloader_message/bootloader_message.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "../LegacyBootControl.h"
+#include "misc_writer/misc_writer.h"
+
+namespace {
+
+using ::android::hardware::boot::V1_1::MergeStatus;
+using ::android::hardware::boot::V1_2::IBootControl;
+using ::android::hardware::boot::V1_2::implementation::HIDL_FETCH_IBootControl;
+using ::android::hardware::google::pixel::MiscWriter;
+using ::android::hardware::google::pixel::MiscWriterActions;
+
+/*
+ * The boot control benchmarks run against the device's real bootctrl module
+ * and slot metadata, the same way the HAL serves update_engine; every
+ * operation measured here is idempotent on a successfully booted device
+ * (queries, re-marking the booted slot, rewriting the current merge status),
+ * so the run leaves the on-disk state unchanged. The module is loaded once
+ * and shared across iterations, matching the HAL's lifetime.
+ */
+IBootControl *getBootControl() {
+    static IBootControl *instance = HIDL_FETCH_IBootControl("");
+    return instance;
+}
+
+void BM_LegacyBootControl_QuerySlotMetadata(benchmark::State &state) {
+    IBootControl *hal = getBootControl();
+    if (hal == nullptr) {
+        state.SkipWithError("boot control module unavailable");
+        return;
+    }
+    uint32_t slot = hal->getCurrentSlot();
+    // The query mix update_engine issues while polling an update.
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hal->isSlotBootable(slot));
+        benchmark::DoNotOptimize(hal->isSlotMarkedSuccessful(slot));
+        benchmark::DoNotOptimize(hal->getActiveBootSlot());
+    }
+    state.SetItemsProcessed(state.iterations() * 3);
+}
+BENCHMARK(BM_LegacyBootControl_QuerySlotMetadata);
+
+void BM_LegacyBootControl_MarkBootSuccessful(benchmark::State &state) {
+    IBootControl *hal = getBootControl();
+    if (hal == nullptr) {
+        state.SkipWithError("boot control module unavailable");
+        return;
+    }
+    // Re-marks the already-successful booted slot: a full metadata write
+    // cycle with unchanged resulting state.
+    for (auto _ : state) {
+        hal->markBootSuccessful([](const auto &result) { benchmark::DoNotOptimize(&result); });
+    }
+}
+BENCHMARK(BM_LegacyBootControl_MarkBootSuccessful);
+
+void BM_BootControlShared_GetSnapshotMergeStatus(benchmark::State &state) {
+    IBootControl *hal = getBootControl();
+    if (hal == nullptr) {
+        state.SkipWithError("boot control module unavailable");
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hal->getSnapshotMergeStatus());
+    }
+}
+BENCHMARK(BM_BootControlShared_GetSnapshotMergeStatus);
+
+void BM_BootControlShared_SetSnapshotMergeStatus(benchmark::State &state) {
+    IBootControl *hal = getBootControl();
+    if (hal == nullptr) {
+        state.SkipWithError("boot control module unavailable");
+        return;
+    }
+    MergeStatus current = hal->getSnapshotMergeStatus();
+    if (current == MergeStatus::UNKNOWN) {
+        state.SkipWithError("merge status unknown; refusing to write");
+        return;
+    }
+    // Rewrites the status the device already has.
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hal->setSnapshotMergeStatus(current));
+    }
+}
+BENCHMARK(BM_BootControlShared_SetSnapshotMergeStatus);
+
+/*
+ * The misc writer benchmarks redirect the misc block device to a sparse temp
+ * file via SetMiscBlockDeviceForTest, so they exercise the full
+ * open/seek/write/fsync path without touching the real partition. The
+ * override is process-global and sticky, which is why these register after
+ * the boot control benchmarks; run them in isolation with
+ * --benchmark_filter if in doubt.
+ */
+class MiscWriterBench : public benchmark::Fixture {
+  public:
+    void SetUp(benchmark::State &state) override {
+        if (misc_.fd == -1 || ftruncate(misc_.fd, kMiscImageSize) != 0) {
+            state.SkipWithError("failed to create misc image");
+            return;
+        }
+        SetMiscBlockDeviceForTest(misc_.path);
+    }
+
+    static std::vector<MiscWriter> makeWriters() {
+        // Flag actions that need no payload; six distinct vendor-space fields.
+        return {MiscWriter(MiscWriterActions::kSetDarkThemeFlag),
+                MiscWriter(MiscWriterActions::kClearDarkThemeFlag),
+                MiscWriter(MiscWriterActions::kSetSotaFlag),
+                MiscWriter(MiscWriterActions::kClearSotaFlag),
+                MiscWriter(MiscWriterActions::kSetEnablePkvmFlag),
+                MiscWriter(MiscWriterActions::kSetDisablePkvmFlag)};
+    }
+
+  private:
+    static constexpr off_t kMiscImageSize = 1 << 20;
+    TemporaryFile misc_;
+};
+
+BENCHMARK_F(MiscWriterBench, PerformActionSingle)(benchmark::State &state) {
+    std::vector<MiscWriter> writers = makeWriters();
+    // One open/seek/write/fsync cycle per field, the pre-batching behavior.
+    for (auto _ : state) {
+        for (auto &writer : writers) {
+            if (!writer.PerformAction()) {
+                state.SkipWithError("PerformAction failed");
+                return;
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * makeWriters().size());
+}
+
+BENCHMARK_F(MiscWriterBench, PerformBatch)(benchmark::State &state) {
+    const std::vector<MiscWriter> writers = makeWriters();
+    // All fields committed through a single open and one fsync.
+    for (auto _ : state) {
+        if (!MiscWriter::PerformBatch(writers)) {
+            state.SkipWithError("PerformBatch failed");
+            return;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * writers.size());
+}
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -22,9 +22,11 @@
 #include <dlfcn.h>
 #include <endian.h>
 
+#include <future>
 #include <map>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 // FS headers
@@ -126,6 +128,18 @@ ScopedAStatus SetBrightnessLevel(const std::vector<std::string> &args, std::stri
                                                               message.c_str());
 }
 
+// Waits for the command staged in the pipeline, if any, and surfaces its
+// result. Must be called with mPipelineLock held.
+ScopedAStatus Fastboot::collectStagedCommandLocked(std::string *_aidl_return) {
+    if (!mStagedCmd.valid()) {
+        *_aidl_return = "";
+        return ScopedAStatus::ok();
+    }
+    auto [status, message] = mStagedCmd.get();
+    *_aidl_return = message;
+    return status;
+}
+
 ScopedAStatus Fastboot::doOemCommand(const std::string &in_oemCmd, std::string *_aidl_return) {
     const std::unordered_map<std::string, OEMCommandHandler> kOEMCmdMap = {
             {FB_OEM_SET_BRIGHTNESS, SetBrightnessLevel},
@@ -138,15 +152,47 @@ ScopedAStatus Fastboot::doOemCommand(const std::string &in_oemCmd, std::string *
     }
 
     // args[0] will be "oem", args[1] will be the command name
+    if (args[1] == FB_OEM_PIPELINE_FLUSH) {
+        std::lock_guard lock(mPipelineLock);
+        return collectStagedCommandLocked(_aidl_return);
+    }
+
+    bool pipelined = false;
+    if (args[1] == FB_OEM_PIPELINE) {
+        if (args.size() < 3) {
+            return ScopedAStatus::fromExceptionCodeWithMessage(EX_ILLEGAL_ARGUMENT,
+                                                               "No OEM command to pipeline");
+        }
+        args.erase(args.begin() + 1);
+        pipelined = true;
+    }
+
     auto cmd_handler = kOEMCmdMap.find(args[1]);
-    if (cmd_handler != kOEMCmdMap.end()) {
-        return cmd_handler->second(std::vector<std::string>(args.begin() + 2, args.end()),
-                                   _aidl_return);
-    } else {
+    if (cmd_handler == kOEMCmdMap.end()) {
         return ScopedAStatus::fromServiceSpecificErrorWithMessage(BnFastboot::FAILURE_UNKNOWN,
                                                                   "Unknown OEM Command");
     }
 
+    auto handler = cmd_handler->second;
+    auto handler_args = std::vector<std::string>(args.begin() + 2, args.end());
+    if (!pipelined) {
+        return handler(handler_args, _aidl_return);
+    }
+
+    // Double-buffered staging: collect the previously staged command, failing
+    // fast if it went wrong, then kick this one off on a worker thread and
+    // return so the host can start transferring the next command while this
+    // one commits.
+    std::lock_guard lock(mPipelineLock);
+    if (auto status = collectStagedCommandLocked(_aidl_return); !status.isOk()) {
+        return status;
+    }
+    mStagedCmd = std::async(std::launch::async, [handler, handler_args]() {
+        std::string message;
+        auto status = handler(handler_args, &message);
+        return std::make_pair(std::move(status), std::move(message));
+    });
+    *_aidl_return = "";
     return ScopedAStatus::ok();
 }
 
@@ -214,14 +260,16 @@ bool WipeDigitalCarKeys(void) {
 ScopedAStatus Fastboot::doOemSpecificErase() {
     // Erase metadata partition along with userdata partition.
     // Keep erasing Titan M even if failing on this case.
-    auto wipe_status = wipe_volume("/metadata");
-
-    bool dck_wipe_success = WipeDigitalCarKeys();
+    // The metadata block-device wipe, the DCK wipe and the Titan M
+    // transaction are independent; overlap them instead of serializing.
+    auto wipe_future = std::async(std::launch::async, wipe_volume, "/metadata");
+    auto dck_future = std::async(std::launch::async, WipeDigitalCarKeys);
 
     // Connect to Titan M
     ::nos::NuggetClient client;
     client.Open();
     if (!client.IsOpen()) {
+        // The futures join on destruction, so the wipes still complete.
         return ScopedAStatus::fromServiceSpecificErrorWithMessage(BnFastboot::FAILURE_UNKNOWN,
                                                                   "open Titan M fail");
     }
@@ -234,11 +282,17 @@ ScopedAStatus Fastboot::doOemSpecificErase() {
     uint32_t nugget_status;
     for (uint8_t i = 0; i < retry_count; i++) {
         nugget_status = client.CallApp(APP_ID_NUGGET, NUGGET_PARAM_NUKE_FROM_ORBIT, magic, nullptr);
-        if (nugget_status == APP_SUCCESS && wipe_status == WIPE_OK) {
-            return ScopedAStatus::ok();
+        if (nugget_status == APP_SUCCESS) {
+            break;
         }
     }
 
+    auto wipe_status = wipe_future.get();
+    bool dck_wipe_success = dck_future.get();
+    if (nugget_status == APP_SUCCESS && wipe_status == WIPE_OK) {
+        return ScopedAStatus::ok();
+    }
+
     // Return exactly what happened
     if (nugget_status != APP_SUCCESS && wipe_status != WIPE_OK && !dck_wipe_success) {
         return ScopedAStatus::fromServiceSpecificErrorWithMessage(
@@ -16,6 +16,11 @@
 
 #pragma once
 
+#include <future>
+#include <mutex>
+#include <string>
+#include <utility>
+
 #include "aidl/android/hardware/fastboot/BnFastboot.h"
 
 namespace aidl {
@@ -24,6 +29,8 @@ namespace hardware {
 namespace fastboot {
 class Fastboot : public BnFastboot {
 #define FB_OEM_SET_BRIGHTNESS "setbrightness"
+#define FB_OEM_PIPELINE "pipeline"
+#define FB_OEM_PIPELINE_FLUSH "pipeline-flush"
     ::ndk::ScopedAStatus doOemCommand(const std::string &in_oemCmd,
                                       std::string *_aidl_return) override;
     ::ndk::ScopedAStatus doOemSpecificErase() override;
@@ -33,6 +40,17 @@ class Fastboot : public BnFastboot {
             const std::string &in_partitionName,
             ::aidl::android::hardware::fastboot::FileSystemType *_aidl_return) override;
     ::ndk::ScopedAStatus getVariant(std::string *_aidl_return) override;
+
+  private:
+    // Double-buffered OEM command staging: "oem pipeline <cmd> ..." commits
+    // the command on a worker thread and returns as soon as the previous
+    // staged command has finished, so the host can transfer the next command
+    // while the current one commits. "oem pipeline-flush" drains the pipeline
+    // and reports the final staged command's result.
+    ::ndk::ScopedAStatus collectStagedCommandLocked(std::string *_aidl_return);
+
+    std::mutex mPipelineLock;
+    std::future<std::pair<::ndk::ScopedAStatus, std::string>> mStagedCmd;
 };
 
 }  // namespace fastboot
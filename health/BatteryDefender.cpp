@@ -22,12 +22,16 @@
 #include <android-base/parseint.h>
 #include <android-base/properties.h>
 #include <cutils/klog.h>
+#include <cutils/uevent.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <pixelhealth/BatteryDefender.h>
 #include <pixelhealth/HealthHelper.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/types.h>
 #include <time.h>
+#include <unistd.h>
 #include <utils/Timers.h>
 
 #include <unordered_map>
@@ -66,6 +70,44 @@ void BatteryDefender::setWirelessNotSupported(void) {
     mPathWirelessPresent = PATH_NOT_SUPPORTED;
 }
 
+void BatteryDefender::enableUeventMonitoring(void) {
+    if (mUeventFd.ok()) {
+        return;
+    }
+
+    mUeventFd.reset(uevent_open_socket(64 * 1024, true));
+    if (!mUeventFd.ok()) {
+        LOG(ERROR) << "Failed to open uevent socket; falling back to polling";
+        return;
+    }
+    fcntl(mUeventFd, F_SETFL, O_NONBLOCK);
+
+    mUeventMonitorEnabled = true;
+    mPowerSupplyChanged = true;
+}
+
+void BatteryDefender::pollPowerSupplyUevents(void) {
+    char msg[1024];
+    ssize_t n;
+
+    while ((n = uevent_kernel_multicast_recv(mUeventFd, msg, sizeof(msg) - 2)) > 0) {
+        msg[n] = '\0';
+        msg[n + 1] = '\0';
+        for (char *cp = msg; cp < msg + n; cp += strlen(cp) + 1) {
+            if (!strcmp(cp, "SUBSYSTEM=power_supply") || !strcmp(cp, "SUBSYSTEM=typec")) {
+                mPowerSupplyChanged = true;
+                return;
+            }
+        }
+    }
+
+    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        // Receive buffer overflow (ENOBUFS) or socket error; notifications may
+        // have been lost, so do not trust the gate this cycle.
+        mPowerSupplyChanged = true;
+    }
+}
+
 void BatteryDefender::loadPersistentStorage(void) {
     if (mIsPowerAvailable) {
         // Load accumulated time from persisted storage
@@ -90,6 +132,31 @@ void BatteryDefender::removeLineEndings(std::string *str) {
     str->erase(std::remove(str->begin(), str->end(), '\r'), str->end());
 }
 
+bool BatteryDefender::readFileToString(const std::string &path, std::string *content) {
+    if (mUeventMonitorEnabled) {
+        // Keep the descriptor open and refresh the node with a single pread()
+        // instead of an open/read/close cycle per update.
+        auto [entry, inserted] = mFdCache.try_emplace(path);
+        if (inserted) {
+            entry->second.reset(TEMP_FAILURE_RETRY(open(path.c_str(), O_RDONLY | O_CLOEXEC)));
+        }
+        if (entry->second.ok()) {
+            char buffer[64];
+            const ssize_t n =
+                    TEMP_FAILURE_RETRY(pread(entry->second, buffer, sizeof(buffer) - 1, 0));
+            if (n >= 0) {
+                content->assign(buffer, n);
+                return true;
+            }
+            // The node went away (e.g. a type-C partner detached); drop the
+            // stale descriptor and take the slow path.
+            mFdCache.erase(entry);
+        }
+    }
+
+    return android::base::ReadFileToString(path, content);
+}
+
 int BatteryDefender::readFileToInt(const std::string &path, const bool silent) {
     std::string buffer;
     int value = 0;  // default
@@ -98,7 +165,7 @@ int BatteryDefender::readFileToInt(const std::string &path, const bool silent) {
         return value;
     }
 
-    if (!android::base::ReadFileToString(path, &buffer)) {
+    if (!readFileToString(path, &buffer)) {
         if (silent == false) {
             LOG(ERROR) << "Failed to read " << path;
         }
@@ -171,7 +238,7 @@ void BatteryDefender::writeChargeLevelsToFile(const int vendorStart, const int v
 bool BatteryDefender::isTypeCSink(const std::string &path) {
     std::string buffer;
 
-    if (!android::base::ReadFileToString(path, &buffer)) {
+    if (!readFileToString(path, &buffer)) {
         LOG(ERROR) << "Failed to read " << path;
     }
 
@@ -468,9 +535,16 @@ void BatteryDefender::update(HealthInfo *health_info) {
     const int chargeLevelVendorStop =
             android::base::GetIntProperty(kPropChargeLevelVendorStop, kChargeLevelDefaultStop);
     mIsDefenderDisabled = isBatteryDefenderDisabled(chargeLevelVendorStart, chargeLevelVendorStop);
-    mIsPowerAvailable = isChargePowerAvailable();
+    if (mUeventMonitorEnabled) {
+        pollPowerSupplyUevents();
+    }
+    if (mPowerSupplyChanged || !mUeventMonitorEnabled) {
+        // Without uevent monitoring, presence must be re-read every cycle
+        mIsPowerAvailable = isChargePowerAvailable();
+        mIsDockDefendTrigger = isDockDefendTrigger();
+        mPowerSupplyChanged = false;
+    }
     mTimeBetweenUpdateCalls = getDeltaTimeSeconds(&mTimePreviousSecs);
-    mIsDockDefendTrigger = isDockDefendTrigger();
 
     // Run state machine
     stateMachine_runAction(mCurrentState, *health_info);
@@ -15,9 +15,14 @@
  * limitations under the License.
  */
 
+#include <android-base/unique_fd.h>
+#include <fcntl.h>
 #include <pixelhealth/BatteryMetricsLogger.h>
 #include <pixelhealth/HealthHelper.h>
 #include <pixelhealth/StatsHelper.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace hardware {
 namespace google {
@@ -29,19 +34,61 @@ using aidl::android::hardware::health::HealthInfo;
 
 BatteryMetricsLogger::BatteryMetricsLogger(const char *const batt_res, const char *const batt_ocv,
                                            const char *const batt_avg_res, int sample_period,
-                                           int upload_period)
+                                           int upload_period, const char *const metrics_cache_path)
     : kBatteryResistance(batt_res),
       kBatteryOCV(batt_ocv),
       kBatteryAvgResistance(batt_avg_res),
+      kMetricsCachePath(metrics_cache_path),
       kSamplePeriod(sample_period),
       kUploadPeriod(upload_period),
       kMaxSamples(upload_period / sample_period) {
-    last_sample_ = 0;
-    last_upload_ = 0;
-    num_samples_ = 0;
-    num_res_samples_ = 0;
-    memset(min_, 0, sizeof(min_));
-    memset(max_, 0, sizeof(max_));
+    if (!kMetricsCachePath.empty()) {
+        initCache();
+    }
+}
+
+BatteryMetricsLogger::~BatteryMetricsLogger() {
+    if (state_ != &local_state_) {
+        munmap(state_, sizeof(MetricsCache));
+    }
+}
+
+void BatteryMetricsLogger::initCache(void) {
+    ::android::base::unique_fd fd(TEMP_FAILURE_RETRY(
+            open(kMetricsCachePath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR)));
+    if (fd < 0) {
+        PLOG(ERROR) << "Failed to open metrics cache " << kMetricsCachePath;
+        return;
+    }
+
+    struct stat st;
+    const bool fresh = fstat(fd, &st) != 0 || st.st_size != sizeof(MetricsCache);
+    if (fresh && ftruncate(fd, sizeof(MetricsCache)) != 0) {
+        PLOG(ERROR) << "Failed to size metrics cache " << kMetricsCachePath;
+        return;
+    }
+
+    void *map = mmap(nullptr, sizeof(MetricsCache), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        PLOG(ERROR) << "Failed to map metrics cache " << kMetricsCachePath;
+        return;
+    }
+
+    MetricsCache *cache = static_cast<MetricsCache *>(map);
+    if (fresh || cache->magic != CACHE_MAGIC || cache->version != CACHE_VERSION) {
+        memset(cache, 0, sizeof(*cache));
+        cache->magic = CACHE_MAGIC;
+        cache->version = CACHE_VERSION;
+    } else if (cache->last_sample > getTime()) {
+        // The cache predates this boot; the BOOTTIME-based timers are stale
+        // but the accumulated min/max history is still valid.
+        cache->last_sample = 0;
+        cache->last_upload = 0;
+    } else {
+        LOG(INFO) << "Resuming battery metrics with " << std::to_string(cache->num_samples)
+                  << " samples";
+    }
+    state_ = cache;
 }
 
 int64_t BatteryMetricsLogger::getTime(void) {
@@ -53,12 +100,12 @@ bool BatteryMetricsLogger::uploadOutlierMetric(const std::shared_ptr<IStats> &st
     if (kStatsSnapshotType[type] < 0)
         return false;
 
-    reportBatteryHealthSnapshot(stats_client, kStatsSnapshotType[type], min_[type][TEMP],
-                                min_[type][VOLT], min_[type][CURR], min_[type][OCV],
-                                min_[type][RES], min_[type][SOC]);
-    reportBatteryHealthSnapshot(stats_client, kStatsSnapshotType[type] + 1, max_[type][TEMP],
-                                max_[type][VOLT], max_[type][CURR], max_[type][OCV],
-                                max_[type][RES], max_[type][SOC]);
+    reportBatteryHealthSnapshot(stats_client, kStatsSnapshotType[type], state_->min[type][TEMP],
+                                state_->min[type][VOLT], state_->min[type][CURR], state_->min[type][OCV],
+                                state_->min[type][RES], state_->min[type][SOC]);
+    reportBatteryHealthSnapshot(stats_client, kStatsSnapshotType[type] + 1, state_->max[type][TEMP],
+                                state_->max[type][VOLT], state_->max[type][CURR], state_->max[type][OCV],
+                                state_->max[type][RES], state_->max[type][SOC]);
 
     return true;
 }
@@ -92,11 +139,11 @@ bool BatteryMetricsLogger::uploadAverageBatteryResistance(
 bool BatteryMetricsLogger::uploadMetrics(void) {
     int64_t time = getTime();
 
-    if (last_sample_ == 0)
+    if (state_->last_sample == 0)
         return false;
 
     LOG(INFO) << "Uploading metrics at time " << std::to_string(time) << " w/ "
-              << std::to_string(num_samples_) << " samples";
+              << std::to_string(state_->num_samples) << " samples";
 
     std::shared_ptr<IStats> stats_client = getStatsService();
     if (!stats_client) {
@@ -106,13 +153,13 @@ bool BatteryMetricsLogger::uploadMetrics(void) {
 
     // Only log and upload the min and max for metric types we want to upload
     for (int metric = 0; metric < NUM_FIELDS; metric++) {
-        if ((metric == RES && num_res_samples_ == 0) || kStatsSnapshotType[metric] < 0)
+        if ((metric == RES && state_->num_res_samples == 0) || kStatsSnapshotType[metric] < 0)
             continue;
         std::string log_min = "min-" + std::to_string(metric) + " ";
         std::string log_max = "max-" + std::to_string(metric) + " ";
         for (int j = 0; j < NUM_FIELDS; j++) {
-            log_min += std::to_string(min_[metric][j]) + " ";
-            log_max += std::to_string(max_[metric][j]) + " ";
+            log_min += std::to_string(state_->min[metric][j]) + " ";
+            log_max += std::to_string(state_->max[metric][j]) + " ";
         }
         LOG(INFO) << log_min;
         LOG(INFO) << log_max;
@@ -123,11 +170,11 @@ bool BatteryMetricsLogger::uploadMetrics(void) {
     uploadAverageBatteryResistance(stats_client);
 
     // Clear existing data
-    memset(min_, 0, sizeof(min_));
-    memset(max_, 0, sizeof(max_));
-    num_samples_ = 0;
-    num_res_samples_ = 0;
-    last_upload_ = time;
+    memset(state_->min, 0, sizeof(state_->min));
+    memset(state_->max, 0, sizeof(state_->max));
+    state_->num_samples = 0;
+    state_->num_res_samples = 0;
+    state_->last_upload = time;
     LOG(INFO) << "Finished uploading to tron";
     return true;
 }
@@ -163,7 +210,7 @@ bool BatteryMetricsLogger::recordSample(const HealthInfo &health_info) {
                                   [SOC] = health_info.batteryLevel,
                                   [OCV] = ocv};
     if (health_info.batteryStatus != BatteryStatus::CHARGING) {
-        num_res_samples_++;
+        state_->num_res_samples++;
     }
 
     // Only calculate the min and max for metric types we want to upload
@@ -172,30 +219,30 @@ bool BatteryMetricsLogger::recordSample(const HealthInfo &health_info) {
         if ((metric == RES && health_info.batteryStatus == BatteryStatus::CHARGING) ||
             kStatsSnapshotType[metric] < 0)
             continue;
-        if (num_samples_ == 0 || (metric == RES && num_res_samples_ == 0) ||
-            sample[metric] < min_[metric][metric]) {
+        if (state_->num_samples == 0 || (metric == RES && state_->num_res_samples == 0) ||
+            sample[metric] < state_->min[metric][metric]) {
             for (int i = 0; i < NUM_FIELDS; i++) {  // update new min with current sample
-                min_[metric][i] = sample[i];
+                state_->min[metric][i] = sample[i];
             }
         }
-        if (num_samples_ == 0 || (metric == RES && num_res_samples_ == 0) ||
-            sample[metric] > max_[metric][metric]) {
+        if (state_->num_samples == 0 || (metric == RES && state_->num_res_samples == 0) ||
+            sample[metric] > state_->max[metric][metric]) {
             for (int i = 0; i < NUM_FIELDS; i++) {  // update new max with current sample
-                max_[metric][i] = sample[i];
+                state_->max[metric][i] = sample[i];
             }
         }
     }
 
-    num_samples_++;
-    last_sample_ = time;
+    state_->num_samples++;
+    state_->last_sample = time;
     return true;
 }
 
 void BatteryMetricsLogger::logBatteryProperties(const HealthInfo &health_info) {
     int32_t time = getTime();
-    if (last_sample_ == 0 || time - last_sample_ >= kSamplePeriod)
+    if (state_->last_sample == 0 || time - state_->last_sample >= kSamplePeriod)
         recordSample(health_info);
-    if (last_sample_ - last_upload_ > kUploadPeriod || num_samples_ >= kMaxSamples)
+    if (state_->last_sample - state_->last_upload > kUploadPeriod || state_->num_samples >= kMaxSamples)
         uploadMetrics();
 
     return;
@@ -28,23 +28,40 @@ using android::base::GetIntProperty;
 
 BatteryThermalControl::BatteryThermalControl(const std::string &path) : mThermalSocMode(path) {
     mStatus = true;
+    mPendingStatus = true;
+    // Backdate so the first transition after boot is written immediately.
+    mLastWriteTime = std::chrono::steady_clock::now() - kTransitionDebounce;
 }
 
-void BatteryThermalControl::setThermalMode(bool isEnable, bool isWeakCharger) {
-    std::string action = (isEnable) ? "enabled" : "disabled";
+void BatteryThermalControl::applyPendingMode() {
+    if (mPendingStatus == mStatus)
+        return;
+
+    // Still inside the bounce window of the previous write: hold the target.
+    // Status callbacks keep coming during a bounce, and health updates arrive
+    // periodically regardless, so a held target is applied shortly after the
+    // burst settles rather than toggling sysfs on every edge.
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now - mLastWriteTime < kTransitionDebounce)
+        return;
 
-    if (mStatus != isEnable) {
-        if (!isEnable && isWeakCharger)
-            return;
-        if (android::base::WriteStringToFile(action, mThermalSocMode)) {
-            mStatus = isEnable;
-        } else {
-            LOG(ERROR) << "Error Write: \"" << action << "\" to " << mThermalSocMode
-                       << " error:" << strerror(errno);
-        }
+    std::string action = (mPendingStatus) ? "enabled" : "disabled";
+    if (android::base::WriteStringToFile(action, mThermalSocMode)) {
+        mStatus = mPendingStatus;
+        mLastWriteTime = now;
+    } else {
+        LOG(ERROR) << "Error Write: \"" << action << "\" to " << mThermalSocMode
+                   << " error:" << strerror(errno);
     }
 }
 
+void BatteryThermalControl::setThermalMode(bool isEnable, bool isWeakCharger) {
+    if (!isEnable && isWeakCharger)
+        return;
+    mPendingStatus = isEnable;
+    applyPendingMode();
+}
+
 void BatteryThermalControl::updateThermalState(const struct android::BatteryProperties *props) {
     int bcl_disable = GetIntProperty("persist.vendor.disable.bcl.control", 0);
 
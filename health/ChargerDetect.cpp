@@ -19,16 +19,17 @@
 #include <android-base/file.h>
 #include <android-base/parseint.h>
 #include <android-base/strings.h>
+#include <android-base/unique_fd.h>
 #include <cutils/klog.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <pixelhealth/ChargerDetect.h>
 #include <pixelhealth/HealthHelper.h>
 
 #include <string>
 
 constexpr char kPowerSupplySysfsPath[]{"/sys/class/power_supply/"};
-constexpr char kUsbOnlinePath[]{"/sys/class/power_supply/usb/online"};
-constexpr char kUsbPowerSupplySysfsPath[]{"/sys/class/power_supply/usb/usb_type"};
+constexpr char kUsbPsyPath[]{"/sys/class/power_supply/usb"};
 constexpr char kTcpmPsyFilter[]{"tcpm"};
 using aidl::android::hardware::health::HealthInfo;
 using android::BatteryMonitor;
@@ -38,23 +39,20 @@ namespace google {
 namespace pixel {
 namespace health {
 
-int ChargerDetect::readFromFile(const std::string& path, std::string* buf) {
-    if (android::base::ReadFileToString(path.c_str(), buf)) {
+int ChargerDetect::readPsyAttr(int dirFd, const char* attr, std::string* buf) {
+    buf->clear();
+    if (dirFd < 0)
+        return 0;
+
+    android::base::unique_fd fd(TEMP_FAILURE_RETRY(openat(dirFd, attr, O_RDONLY | O_CLOEXEC)));
+    if (fd.get() < 0)
+        return 0;
+    if (android::base::ReadFdToString(fd, buf)) {
         *buf = android::base::Trim(*buf);
     }
     return buf->length();
 }
 
-int ChargerDetect::getIntField(const std::string& path) {
-    std::string buf;
-    int value = 0;
-
-    if (readFromFile(path, &buf) > 0)
-        android::base::ParseInt(buf, &value);
-
-    return value;
-}
-
 /*
  * Traverses through /sys/class/power_supply/ to identify TCPM(Type-C/PD) power supply.
  * TCPM power supply's name follows the format "tcpm-source-psy-6-0025" with i2c/i3c bus id
@@ -84,20 +82,17 @@ void ChargerDetect::populateTcpmPsyName(std::string* tcpmPsyName) {
  * with the current selected value encloses within square braces.
  * This functions extracts the current selected value and returns it back to the caller.
  */
-int ChargerDetect::getPsyUsbType(const std::string& path, std::string* type) {
+int ChargerDetect::parsePsyUsbType(const std::string& usbType, std::string* type) {
     size_t start;
-    std::string usbType;
-    int ret;
 
-    ret = readFromFile(path, &usbType);
-    if (ret <= 0) {
-        KLOG_ERROR(LOG_TAG, "Error reading %s: %d\n", path.c_str(), ret);
+    if (usbType.empty()) {
+        KLOG_ERROR(LOG_TAG, "Empty usb_type contents\n");
         return -EINVAL;
     }
 
     start = usbType.find('[');
     if (start == std::string::npos) {
-        KLOG_ERROR(LOG_TAG, "'[' not found in %s: %s\n", path.c_str(), usbType.c_str());
+        KLOG_ERROR(LOG_TAG, "'[' not found in usb_type: %s\n", usbType.c_str());
         return -EINVAL;
     }
 
@@ -105,29 +100,62 @@ int ChargerDetect::getPsyUsbType(const std::string& path, std::string* type) {
     return 0;
 }
 
+/*
+ * Reads every attribute onlineUpdate needs in one pass. The psy directory
+ * fds are opened once and cached - sysfs class directories persist for the
+ * life of the device - so a health update costs openat() per attribute
+ * instead of a full path walk per file. Health updates fire on every uevent
+ * during charging negotiation, where this runs dozens of times a second.
+ */
+void ChargerDetect::snapshotPsys(PsySnapshot* snap) {
+    static android::base::unique_fd usbPsyDirFd(
+            TEMP_FAILURE_RETRY(open(kUsbPsyPath, O_RDONLY | O_CLOEXEC | O_DIRECTORY)));
+    static std::string tcpmPsyName;
+    static android::base::unique_fd tcpmPsyDirFd;
+    std::string buf;
+
+    if (tcpmPsyName.empty()) {
+        populateTcpmPsyName(&tcpmPsyName);
+        KLOG_DEBUG(LOG_TAG, "TcpmPsyName:%s\n", tcpmPsyName.c_str());
+        if (!tcpmPsyName.empty()) {
+            tcpmPsyDirFd.reset(TEMP_FAILURE_RETRY(
+                    open((std::string(kPowerSupplySysfsPath) + tcpmPsyName).c_str(),
+                         O_RDONLY | O_CLOEXEC | O_DIRECTORY)));
+        }
+    }
+
+    snap->usbOnline = 0;
+    if (readPsyAttr(usbPsyDirFd.get(), "online", &buf) > 0)
+        android::base::ParseInt(buf, &snap->usbOnline);
+    if (!snap->usbOnline) {
+        // Offline classifies from usbOnline alone; skip the remaining reads.
+        snap->usbType.clear();
+        snap->tcpmUsbType.clear();
+        return;
+    }
+    readPsyAttr(usbPsyDirFd.get(), "usb_type", &snap->usbType);
+    readPsyAttr(tcpmPsyDirFd.get(), "usb_type", &snap->tcpmUsbType);
+}
+
 /*
  * Reads the usb power_supply's usb_type and the tcpm power_supply's usb_type to infer
  * HealthInfo(hardware/interfaces/health/1.0/types.hal) online property.
  */
 void ChargerDetect::onlineUpdate(HealthInfo *health_info) {
-    std::string tcpmOnlinePath, usbPsyType;
-    static std::string tcpmPsyName;
-    int ret;
+    PsySnapshot snap;
+    std::string usbPsyType;
 
     health_info->chargerAcOnline = false;
     health_info->chargerUsbOnline = false;
 
-    if (tcpmPsyName.empty()) {
-        populateTcpmPsyName(&tcpmPsyName);
-        KLOG_DEBUG(LOG_TAG, "TcpmPsyName:%s\n", tcpmPsyName.c_str());
-    }
+    // Classify entirely from the in-memory snapshot.
+    snapshotPsys(&snap);
 
-    if (!getIntField(kUsbOnlinePath)) {
+    if (!snap.usbOnline) {
         return;
     }
 
-    ret = getPsyUsbType(kUsbPowerSupplySysfsPath, &usbPsyType);
-    if (!ret) {
+    if (!parsePsyUsbType(snap.usbType, &usbPsyType)) {
         if (usbPsyType == "CDP" || usbPsyType == "DCP") {
             health_info->chargerAcOnline = true;
             return;
@@ -140,13 +168,11 @@ void ChargerDetect::onlineUpdate(HealthInfo *health_info) {
     /* Safe to assume AC charger here if BC1.2 non compliant */
     health_info->chargerAcOnline = true;
 
-    if (tcpmPsyName.empty()) {
+    if (snap.tcpmUsbType.empty()) {
         return;
     }
 
-    ret = getPsyUsbType(std::string(kPowerSupplySysfsPath) + tcpmPsyName + "/usb_type",
-                        &usbPsyType);
-    if (ret < 0) {
+    if (parsePsyUsbType(snap.tcpmUsbType, &usbPsyType) < 0) {
         return;
     }
 
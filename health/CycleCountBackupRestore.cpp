@@ -14,7 +14,13 @@
  * limitations under the License.
  */
 
+#include <fcntl.h>
 #include <pixelhealth/CycleCountBackupRestore.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
 
 namespace hardware {
 namespace google {
@@ -37,9 +43,13 @@ CycleCountBackupRestore::CycleCountBackupRestore(int nb_buckets, const char *sys
 
 void CycleCountBackupRestore::Restore() {
     if (CheckSerial()) {
-        Read(persist_path_, sw_bins_);
+        // Fall back to the legacy space-separated format for records
+        // persisted before the binary layout existed.
+        if (!ReadPersistBinary()) {
+            Read(persist_path_, sw_bins_);
+        }
     }
-    Read(sysfs_path_, hw_bins_);
+    ReadSysfs(hw_bins_);
     UpdateAndSave();
 }
 
@@ -83,12 +93,124 @@ void CycleCountBackupRestore::Backup(int battery_level) {
     saved_soc_ = battery_level;
     // To avoid writting file too often just rate limit it
     if (soc_inc_ >= kBackupTrigger) {
-        Read(sysfs_path_, hw_bins_);
+        ReadSysfs(hw_bins_);
         UpdateAndSave();
         soc_inc_ = 0;
     }
 }
 
+uint32_t CycleCountBackupRestore::Checksum(const int *bins) const {
+    uint32_t sum = kPersistVersion;
+
+    for (int i = 0; i < nb_buckets_; ++i) {
+        sum = sum * 31 + static_cast<uint32_t>(bins[i]);
+    }
+
+    return sum;
+}
+
+bool CycleCountBackupRestore::ReadPersistBinary() {
+    std::string buffer;
+    PersistHeader header;
+    const size_t record_size = sizeof(PersistHeader) + nb_buckets_ * sizeof(int32_t);
+
+    if (!android::base::ReadFileToString(persist_path_, &buffer)) {
+        LOG(ERROR) << "Failed to read " << persist_path_;
+        return false;
+    }
+
+    if (buffer.size() != record_size) {
+        return false;
+    }
+
+    memcpy(&header, buffer.data(), sizeof(header));
+    if (header.magic != kPersistMagic || header.version != kPersistVersion ||
+        header.nb_buckets != static_cast<uint32_t>(nb_buckets_)) {
+        return false;
+    }
+
+    std::vector<int32_t> bins(nb_buckets_);
+    memcpy(bins.data(), buffer.data() + sizeof(header), nb_buckets_ * sizeof(int32_t));
+    std::copy(bins.begin(), bins.end(), sw_bins_);
+
+    if (header.checksum != Checksum(sw_bins_)) {
+        LOG(ERROR) << "Discarding " << persist_path_ << " with bad checksum";
+        memset(sw_bins_, 0, nb_buckets_ * sizeof(int));
+        return false;
+    }
+
+    return true;
+}
+
+void CycleCountBackupRestore::WritePersistBinary() {
+    const size_t record_size = sizeof(PersistHeader) + nb_buckets_ * sizeof(int32_t);
+    std::vector<char> record(record_size);
+    const PersistHeader header = {
+            .magic = kPersistMagic,
+            .version = kPersistVersion,
+            .nb_buckets = static_cast<uint32_t>(nb_buckets_),
+            .checksum = Checksum(sw_bins_),
+    };
+    std::vector<int32_t> bins(sw_bins_, sw_bins_ + nb_buckets_);
+
+    memcpy(record.data(), &header, sizeof(header));
+    memcpy(record.data() + sizeof(header), bins.data(), nb_buckets_ * sizeof(int32_t));
+
+    ::android::base::unique_fd fd(TEMP_FAILURE_RETRY(
+            open(persist_path_.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR)));
+    if (fd < 0) {
+        LOG(ERROR) << "Open " << persist_path_ << " error: " << strerror(errno);
+        return;
+    }
+
+    // Land the whole record in one pwrite; a torn write is caught by the
+    // checksum on the next restore. Truncate in case a longer legacy
+    // ASCII record is being replaced.
+    ssize_t ret = TEMP_FAILURE_RETRY(pwrite(fd, record.data(), record_size, 0));
+    if (ret != static_cast<ssize_t>(record_size)) {
+        LOG(ERROR) << "Write to " << persist_path_ << " error: " << strerror(errno);
+        return;
+    }
+    if (ftruncate(fd, record_size) != 0) {
+        LOG(ERROR) << "Truncate " << persist_path_ << " error: " << strerror(errno);
+    }
+}
+
+void CycleCountBackupRestore::ReadSysfs(int *bins) {
+    if (!sysfs_fd_.ok()) {
+        sysfs_fd_.reset(TEMP_FAILURE_RETRY(open(sysfs_path_.c_str(), O_RDONLY | O_CLOEXEC)));
+    }
+    if (!sysfs_fd_.ok()) {
+        Read(sysfs_path_, bins);
+        return;
+    }
+
+    // One pread on a kept-open descriptor; the node is ASCII, so parse the
+    // tokens in place instead of splitting into per-value strings.
+    std::vector<char> buffer(32 * nb_buckets_ + 2);
+    ssize_t n = TEMP_FAILURE_RETRY(pread(sysfs_fd_, buffer.data(), buffer.size() - 1, 0));
+    if (n <= 0) {
+        LOG(ERROR) << "Failed to read " << sysfs_path_;
+        sysfs_fd_.reset();
+        return;
+    }
+    buffer[n] = '\0';
+
+    std::vector<int> counts(nb_buckets_);
+    char *cursor = buffer.data();
+    for (int i = 0; i < nb_buckets_; ++i) {
+        char *next;
+        long value = strtol(cursor, &next, 10);
+        if (next == cursor) {
+            LOG(ERROR) << "data format \"" << buffer.data() << "\" is wrong in " << sysfs_path_;
+            return;
+        }
+        counts[i] = static_cast<int>(value);
+        cursor = next;
+    }
+    std::copy(counts.begin(), counts.end(), bins);
+}
+
 void CycleCountBackupRestore::Read(const std::string &path, int *bins) {
     std::string buffer;
 
@@ -139,7 +261,7 @@ void CycleCountBackupRestore::UpdateAndSave() {
     if (restore)
         Write(hw_bins_, sysfs_path_);
     if (backup)
-        Write(sw_bins_, persist_path_);
+        WritePersistBinary();
 }
 
 }  // namespace health
@@ -15,9 +15,13 @@
  */
 
 #include <android-base/logging.h>
+#include <android-base/strings.h>
 #include <android/hardware/health/translate-ndk.h>
+#include <fcntl.h>
 #include <hal_conversion.h>
 #include <pixelhealth/HealthHelper.h>
+#include <stdlib.h>
+#include <unistd.h>
 
 using HidlHealthInfo = android::hardware::health::V2_0::HealthInfo;
 using aidl::android::hardware::health::HealthInfo;
@@ -37,6 +41,91 @@ HealthInfo ToHealthInfo(const struct android::BatteryProperties *props) {
     return aidl_health_info;
 }
 
+PowerSupplySnapshot::PowerSupplySnapshot(const std::string &dir,
+                                         const std::vector<std::string> &nodes) {
+    dir_fd_.reset(TEMP_FAILURE_RETRY(open(dir.c_str(), O_DIRECTORY | O_RDONLY | O_CLOEXEC)));
+    if (!dir_fd_.ok()) {
+        PLOG(ERROR) << "Failed to open " << dir;
+    }
+
+    entries_.reserve(nodes.size());
+    for (const auto &node : nodes) {
+        entries_.emplace_back();
+        entries_.back().name = node;
+    }
+}
+
+bool PowerSupplySnapshot::Refresh() {
+    bool all_valid = dir_fd_.ok();
+    char scratch[128];
+
+    buffer_.clear();
+    for (auto &entry : entries_) {
+        entry.valid = false;
+        if (!entry.fd.ok() && dir_fd_.ok()) {
+            entry.fd.reset(TEMP_FAILURE_RETRY(
+                    openat(dir_fd_, entry.name.c_str(), O_RDONLY | O_CLOEXEC)));
+        }
+        if (!entry.fd.ok()) {
+            all_valid = false;
+            continue;
+        }
+
+        const ssize_t n = TEMP_FAILURE_RETRY(pread(entry.fd, scratch, sizeof(scratch), 0));
+        if (n < 0) {
+            // The node may have been removed; retry the openat() next cycle.
+            entry.fd.reset();
+            all_valid = false;
+            continue;
+        }
+
+        entry.offset = buffer_.size();
+        entry.len = n;
+        entry.valid = true;
+        buffer_.append(scratch, n);
+    }
+
+    return all_valid;
+}
+
+const PowerSupplySnapshot::Entry *PowerSupplySnapshot::Find(const std::string &node) const {
+    for (const auto &entry : entries_) {
+        if (entry.name == node) {
+            return entry.valid ? &entry : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+bool PowerSupplySnapshot::GetInt(const std::string &node, int64_t *value) const {
+    std::string content;
+
+    if (!GetString(node, &content)) {
+        return false;
+    }
+
+    char *end;
+    const int64_t parsed = strtoll(content.c_str(), &end, 10);
+    if (end == content.c_str()) {
+        LOG(ERROR) << "Failed to parse " << node << ": \"" << content << "\"";
+        return false;
+    }
+
+    *value = parsed;
+    return true;
+}
+
+bool PowerSupplySnapshot::GetString(const std::string &node, std::string *value) const {
+    const Entry *entry = Find(node);
+
+    if (entry == nullptr) {
+        return false;
+    }
+
+    *value = ::android::base::Trim(buffer_.substr(entry->offset, entry->len));
+    return true;
+}
+
 }  // namespace health
 }  // namespace pixel
 }  // namespace google
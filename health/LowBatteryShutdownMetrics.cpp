@@ -15,9 +15,13 @@
  * limitations under the License.
  */
 
+#include <android-base/parseint.h>
+#include <fcntl.h>
 #include <pixelhealth/HealthHelper.h>
 #include <pixelhealth/LowBatteryShutdownMetrics.h>
 #include <pixelhealth/StatsHelper.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 namespace hardware {
 namespace google {
@@ -31,16 +35,70 @@ using android::base::ReadFileToString;
 using android::base::SetProperty;
 
 LowBatteryShutdownMetrics::LowBatteryShutdownMetrics(const char *const voltage_avg,
-                                                     const char *const persist_prop)
+                                                     const char *const persist_prop,
+                                                     const char *const journal_path)
     : kVoltageAvg(voltage_avg), kPersistProp(persist_prop) {
     prop_written_ = false;
     prop_empty_ = false;
+    if (journal_path && journal_path[0] != '\0') {
+        initJournal(journal_path);
+    }
+}
+
+LowBatteryShutdownMetrics::~LowBatteryShutdownMetrics() {
+    if (journal_ != nullptr) {
+        munmap(journal_, sizeof(ShutdownJournal));
+    }
+}
+
+void LowBatteryShutdownMetrics::initJournal(const char *path) {
+    ::android::base::unique_fd fd(
+            TEMP_FAILURE_RETRY(open(path, O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR)));
+    if (fd < 0) {
+        PLOG(ERROR) << "Failed to open shutdown journal " << path;
+        return;
+    }
+    if (ftruncate(fd, sizeof(ShutdownJournal)) != 0) {
+        PLOG(ERROR) << "Failed to size shutdown journal " << path;
+        return;
+    }
+
+    void *map = mmap(nullptr, sizeof(ShutdownJournal), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        PLOG(ERROR) << "Failed to map shutdown journal " << path;
+        return;
+    }
+
+    journal_ = static_cast<ShutdownJournal *>(map);
+    if (journal_->magic != kJournalMagic || journal_->version != kJournalVersion ||
+        journal_->count > kJournalEntries) {
+        memset(journal_, 0, sizeof(ShutdownJournal));
+        journal_->magic = kJournalMagic;
+        journal_->version = kJournalVersion;
+    }
+
+    // Pre-open the fuel gauge node as well, so the shutdown path is preads
+    // and stores with no file creation at all.
+    voltage_fd_.reset(TEMP_FAILURE_RETRY(open(kVoltageAvg, O_RDONLY | O_CLOEXEC)));
+}
+
+bool LowBatteryShutdownMetrics::readVoltageAvg(std::string *value) {
+    if (voltage_fd_.ok()) {
+        char buffer[32];
+        const ssize_t n = TEMP_FAILURE_RETRY(pread(voltage_fd_, buffer, sizeof(buffer) - 1, 0));
+        if (n > 0) {
+            value->assign(buffer, n);
+            return true;
+        }
+    }
+    return ReadFileToString(kVoltageAvg, value);
 }
 
 bool LowBatteryShutdownMetrics::uploadVoltageAvg(void) {
     std::string prop_contents = GetProperty(kPersistProp, "");
     LOG(INFO) << kPersistProp << " property contents: " << prop_contents;
-    if (prop_contents.size() == 0) {  // we don't have anything to upload
+    const uint32_t journal_count = (journal_ != nullptr) ? journal_->count : 0;
+    if (prop_contents.size() == 0 && journal_count == 0) {  // we don't have anything to upload
         prop_empty_ = true;
         return false;
     }
@@ -51,9 +109,22 @@ bool LowBatteryShutdownMetrics::uploadVoltageAvg(void) {
         return false;
     }
 
+    // Upload and clear journal entries recorded at previous shutdowns
+    for (uint32_t i = 0; i < journal_count; i++) {
+        LOG(INFO) << "Uploading voltage_avg: " << std::to_string(journal_->voltage_avg[i]);
+        reportBatteryCausedShutdown(stats_client, journal_->voltage_avg[i]);
+    }
+    if (journal_count > 0) {
+        journal_->count = 0;
+        msync(journal_, sizeof(ShutdownJournal), MS_ASYNC);
+    }
+
     // Process and upload comma-delimited last voltage values
     int32_t voltage_avg;
     for (const auto &item : android::base::Split(prop_contents, ",")) {
+        if (item.empty()) {
+            continue;
+        }
         if (!(voltage_avg = stoi(item))) {
             LOG(ERROR) << "Couldn't process voltage value " << item;
             continue;
@@ -63,7 +134,9 @@ bool LowBatteryShutdownMetrics::uploadVoltageAvg(void) {
     }
 
     // Clear property now that we've uploaded its contents
-    SetProperty(kPersistProp, "");
+    if (prop_contents.size() > 0) {
+        SetProperty(kPersistProp, "");
+    }
     return true;
 }
 
@@ -71,11 +144,27 @@ bool LowBatteryShutdownMetrics::saveVoltageAvg(void) {
     std::string voltage_avg;
     std::string prop_contents;
 
-    if (!ReadFileToString(kVoltageAvg, &voltage_avg)) {
+    if (!readVoltageAvg(&voltage_avg)) {
         LOG(ERROR) << "Can't read the Maxim fuel gauge average voltage value";
         return false;
     }
     voltage_avg = ::android::base::Trim(voltage_avg);
+
+    if (journal_ != nullptr) {
+        int32_t voltage;
+        if (!android::base::ParseInt(voltage_avg, &voltage)) {
+            LOG(ERROR) << "Couldn't parse voltage value " << voltage_avg;
+            return false;
+        }
+        if (journal_->count < kJournalEntries) {
+            // Store the entry before publishing it through count, so a
+            // brownout between the two stores cannot expose a torn entry
+            journal_->voltage_avg[journal_->count] = voltage;
+            journal_->count++;
+        }
+        msync(journal_, sizeof(ShutdownJournal), MS_SYNC);
+        return true;
+    }
     prop_contents = GetProperty(kPersistProp, "");
 
     // Comma delimit additional values
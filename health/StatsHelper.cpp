@@ -14,10 +14,18 @@
  * limitations under the License.
  */
 
+#include <android-base/chrono_utils.h>
 #include <android-base/logging.h>
 #include <android/binder_manager.h>
 #include <pixelhealth/StatsHelper.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 #include "pixelatoms_defs.h"
 
 #define LOG_TAG "pixelhealth-vendor"
@@ -34,6 +42,135 @@ using aidl::android::frameworks::stats::VendorAtomValue;
 
 namespace PixelAtoms = hardware::google::pixel::PixelAtoms;
 
+namespace {
+
+// How long the flush thread lingers after the first atom of a burst, so the
+// atoms of one health update cycle go out as a single batch.
+constexpr std::chrono::milliseconds kFlushDelay(500);
+
+// Identical snapshot payloads repeating within this window are dropped;
+// health snapshots often carry the exact same min/max values across cycles.
+constexpr std::chrono::nanoseconds kSnapshotDedupeWindow = std::chrono::hours(1);
+
+int64_t getBootTimeNs() {
+    return ::android::base::boot_clock::now().time_since_epoch().count();
+}
+
+// Batches vendor atoms from the health update loop and reports them from a
+// dedicated thread, so atom serialization and IStats binder calls never run
+// on the charging-state-change path.
+class StatsBatcher {
+  public:
+    static StatsBatcher *getInstance() {
+        // Deliberately leaked: the flush thread runs for the process lifetime.
+        static StatsBatcher *instance = new StatsBatcher();
+        return instance;
+    }
+
+    void enqueue(const std::shared_ptr<IStats> &stats_client, VendorAtom event) {
+        std::unique_lock<std::mutex> lock(queue_lock_);
+        if (isDuplicate(event)) {
+            return;
+        }
+        queue_.push_back({stats_client, std::move(event)});
+        lock.unlock();
+        queue_cv_.notify_one();
+    }
+
+  private:
+    struct PendingAtom {
+        std::shared_ptr<IStats> stats_client;
+        VendorAtom event;
+    };
+    struct DedupeEntry {
+        std::vector<VendorAtomValue> values;
+        int64_t timestamp_ns;
+    };
+
+    StatsBatcher() {
+        std::thread(&StatsBatcher::flushLoop, this).detach();
+    }
+
+    static std::chrono::nanoseconds dedupeWindow(int32_t atom_id) {
+        switch (atom_id) {
+            case PixelAtoms::VENDOR_BATTERY_HEALTH_SNAPSHOT:
+                return kSnapshotDedupeWindow;
+            default:
+                // Shutdown and other one-shot atoms are always reported
+                return std::chrono::nanoseconds::zero();
+        }
+    }
+
+    // Key atoms by type plus the leading subtype value, so e.g. the min and
+    // max variants of a snapshot dedupe independently of each other
+    static uint64_t dedupeKey(const VendorAtom &event) {
+        uint64_t key = static_cast<uint64_t>(static_cast<uint32_t>(event.atomId)) << 32;
+        if (!event.values.empty() && event.values[0].getTag() == VendorAtomValue::intValue) {
+            key |= static_cast<uint32_t>(event.values[0].get<VendorAtomValue::intValue>());
+        }
+        return key;
+    }
+
+    // Caller must hold queue_lock_
+    bool isDuplicate(const VendorAtom &event) {
+        const std::chrono::nanoseconds window = dedupeWindow(event.atomId);
+        if (window.count() == 0) {
+            return false;
+        }
+        const int64_t now_ns = getBootTimeNs();
+        DedupeEntry &entry = last_enqueued_[dedupeKey(event)];
+        if (!entry.values.empty() && entry.values == event.values &&
+            now_ns - entry.timestamp_ns < window.count()) {
+            return true;
+        }
+        entry.values = event.values;
+        entry.timestamp_ns = now_ns;
+        return false;
+    }
+
+    void flushLoop() {
+        std::unique_lock<std::mutex> lock(queue_lock_);
+        while (true) {
+            queue_cv_.wait(lock, [this] { return !queue_.empty(); });
+            lock.unlock();
+            std::this_thread::sleep_for(kFlushDelay);
+            lock.lock();
+            std::vector<PendingAtom> batch;
+            std::swap(batch, queue_);
+            lock.unlock();
+
+            std::shared_ptr<IStats> stats_client;
+            for (const auto &pending : batch) {
+                // Prefer the client captured at enqueue time; reconnect once
+                // per batch if a caller had none
+                if (pending.stats_client) {
+                    stats_client = pending.stats_client;
+                } else if (!stats_client) {
+                    stats_client = getStatsService();
+                }
+                if (!stats_client) {
+                    LOG(ERROR) << "Unable to report atom " << pending.event.atomId
+                               << ": no IStats service";
+                    continue;
+                }
+                const ndk::ScopedAStatus ret = stats_client->reportVendorAtom(pending.event);
+                if (!ret.isOk())
+                    LOG(ERROR) << "Unable to report atom " << pending.event.atomId
+                               << " to IStats service";
+            }
+            lock.lock();
+        }
+    }
+
+    std::mutex queue_lock_;
+    std::condition_variable queue_cv_;
+    std::vector<PendingAtom> queue_;
+    // Last enqueued payload per dedupe key, guarded by queue_lock_
+    std::unordered_map<uint64_t, DedupeEntry> last_enqueued_;
+};
+
+}  // namespace
+
 std::shared_ptr<IStats> getStatsService() {
     const std::string instance = std::string() + IStats::descriptor + "/default";
     static bool isStatsDeclared = false;
@@ -73,12 +210,10 @@ void reportBatteryHealthSnapshot(const std::shared_ptr<IStats> &stats_client, in
     tmp.set<VendorAtomValue::intValue>(level_percent);
     values[6] = tmp;
 
-    // Send vendor atom to IStats HAL
+    // Queue vendor atom for the flush thread to send to the IStats HAL
     VendorAtom event = {.atomId = PixelAtoms::VENDOR_BATTERY_HEALTH_SNAPSHOT,
                         .values = std::move(values)};
-    const ndk::ScopedAStatus ret = stats_client->reportVendorAtom(event);
-    if (!ret.isOk())
-        LOG(ERROR) << "Unable to report VendorBatteryHealthSnapshot to IStats service";
+    StatsBatcher::getInstance()->enqueue(stats_client, std::move(event));
 }
 
 void reportBatteryCausedShutdown(const std::shared_ptr<IStats> &stats_client,
@@ -89,12 +224,10 @@ void reportBatteryCausedShutdown(const std::shared_ptr<IStats> &stats_client,
     tmp.set<VendorAtomValue::intValue>(last_recorded_micro_volt);
     values[0] = tmp;
 
-    // Send vendor atom to IStats HAL
+    // Queue vendor atom for the flush thread to send to the IStats HAL
     VendorAtom event = {.atomId = PixelAtoms::VENDOR_BATTERY_CAUSED_SHUTDOWN,
                         .values = std::move(values)};
-    const ndk::ScopedAStatus ret = stats_client->reportVendorAtom(event);
-    if (!ret.isOk())
-        LOG(ERROR) << "Unable to report VendorBatteryHealthSnapshot to IStats service";
+    StatsBatcher::getInstance()->enqueue(stats_client, std::move(event));
 }
 
 }  // namespace health
@@ -18,11 +18,13 @@
 #define HARDWARE_GOOGLE_PIXEL_HEALTH_BATTERYDEFENDER_H
 
 #include <aidl/android/hardware/health/HealthInfo.h>
+#include <android-base/unique_fd.h>
 #include <batteryservice/BatteryService.h>
 #include <stdbool.h>
 #include <time.h>
 
 #include <string>
+#include <unordered_map>
 
 namespace hardware {
 namespace google {
@@ -68,6 +70,12 @@ class BatteryDefender {
     // (must be checked at runtime)
     void setWirelessNotSupported(void);
 
+    // Subscribe to power_supply/typec uevents so that charger presence sysfs
+    // nodes are only re-read when the kernel reports a change, and keep the
+    // backing descriptors open for single-pread refreshes. Without this call
+    // every update() re-reads all nodes (the legacy polling behavior).
+    void enableUeventMonitoring(void);
+
   private:
     enum state_E {
         STATE_INIT,
@@ -144,6 +152,12 @@ class BatteryDefender {
     bool mIsDockDefendTrigger = false;
     int32_t mTimeToActivateSecsModified;
 
+    // Uevent monitoring (see enableUeventMonitoring)
+    bool mUeventMonitorEnabled = false;
+    bool mPowerSupplyChanged = true; /* Force a read on the first update() */
+    ::android::base::unique_fd mUeventFd;
+    std::unordered_map<std::string, ::android::base::unique_fd> mFdCache;
+
     // State
     state_E mCurrentState = STATE_INIT;
     int64_t mTimeChargerPresentSecs = 0;
@@ -174,6 +188,8 @@ class BatteryDefender {
     int64_t getDeltaTimeSeconds(int64_t *timeStartSecs);
     int32_t getTimeToActivate(void);
     void removeLineEndings(std::string *str);
+    void pollPowerSupplyUevents(void);
+    bool readFileToString(const std::string &path, std::string *content);
     int readFileToInt(const std::string &path, const bool silent = false);
     bool writeIntToFile(const std::string &path, const int value);
     void writeTimeToFile(const std::string &path, const int value, int64_t *previous);
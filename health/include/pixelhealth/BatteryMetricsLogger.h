@@ -44,7 +44,9 @@ class BatteryMetricsLogger {
   public:
     BatteryMetricsLogger(const char *const batt_res, const char *const batt_ocv,
                          const char *const batt_avg_res = "", int sample_period = TEN_MINUTES_SEC,
-                         int upload_period = ONE_DAY_SEC);
+                         int upload_period = ONE_DAY_SEC,
+                         const char *const metrics_cache_path = "");
+    ~BatteryMetricsLogger();
     // Deprecated. Use logBatteryProperties(const HealthInfo&)
     void logBatteryProperties(struct android::BatteryProperties *props);
     void logBatteryProperties(const aidl::android::hardware::health::HealthInfo &props);
@@ -74,22 +76,36 @@ class BatteryMetricsLogger {
     const char *const kBatteryResistance;
     const char *const kBatteryOCV;
     const char *const kBatteryAvgResistance;
+    const std::string kMetricsCachePath;
     const int kSamplePeriod;
     const int kUploadPeriod;
     const int kMaxSamples;
     static constexpr int TEN_MINUTES_SEC = 10 * 60;
     static constexpr int ONE_DAY_SEC = 24 * 60 * 60;
 
-    // min and max are referenced by type in both the X and Y axes
-    // i.e. min[TYPE] is the event where the minimum of that type occurred, and
-    // min[TYPE][TYPE] is the reading of that type at that minimum event
-    int32_t min_[NUM_FIELDS][NUM_FIELDS];
-    int32_t max_[NUM_FIELDS][NUM_FIELDS];
-    int32_t num_res_samples_;  // number of res samples since last upload
-    int32_t num_samples_;      // number of min/max samples since last upload
-    int64_t last_sample_;      // time in seconds since boot of last sample
-    int64_t last_upload_;      // time in seconds since boot of last upload
+    // Fixed-size binary image of the aggregation state. When a cache path is
+    // given this struct is mmap'd from a file so every sample lands on a
+    // mapped page and a HAL restart resumes with the history intact.
+    struct MetricsCache {
+        uint32_t magic;
+        uint32_t version;
+        int32_t num_res_samples;  // number of res samples since last upload
+        int32_t num_samples;      // number of min/max samples since last upload
+        int64_t last_sample;      // time in seconds since boot of last sample
+        int64_t last_upload;      // time in seconds since boot of last upload
+        // min and max are referenced by type in both the X and Y axes
+        // i.e. min[TYPE] is the event where the minimum of that type occurred,
+        // and min[TYPE][TYPE] is the reading of that type at that minimum event
+        int32_t min[NUM_FIELDS][NUM_FIELDS];
+        int32_t max[NUM_FIELDS][NUM_FIELDS];
+    };
+    static constexpr uint32_t CACHE_MAGIC = 0x424d4c43;  // "BMLC"
+    static constexpr uint32_t CACHE_VERSION = 1;
+
+    MetricsCache local_state_ = {};
+    MetricsCache *state_ = &local_state_;  // points into the mapped cache when available
 
+    void initCache();
     int64_t getTime();
     bool recordSample(const aidl::android::hardware::health::HealthInfo &health_info);
     bool uploadMetrics();
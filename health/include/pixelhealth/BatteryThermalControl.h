@@ -23,6 +23,7 @@
 #include <android-base/strings.h>
 #include <batteryservice/BatteryService.h>
 
+#include <chrono>
 #include <string>
 
 namespace hardware {
@@ -45,9 +46,19 @@ class BatteryThermalControl {
 
   private:
     void setThermalMode(bool isEnable, bool isWeakCharger);
+    void applyPendingMode();
+
+    // Transitions arriving within this window of the previous sysfs write are
+    // treated as a plug/unplug bounce: the target is recorded but the write is
+    // held until a later update, so a bounce that settles back to the written
+    // state costs no writes at all.
+    static constexpr std::chrono::milliseconds kTransitionDebounce =
+            std::chrono::milliseconds(2000);
 
     const std::string mThermalSocMode;
-    bool mStatus;
+    bool mStatus;         // last state written to sysfs
+    bool mPendingStatus;  // latest requested state; applied by applyPendingMode()
+    std::chrono::steady_clock::time_point mLastWriteTime;
 };
 
 }  // namespace health
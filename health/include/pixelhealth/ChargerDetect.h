@@ -36,9 +36,16 @@ class ChargerDetect {
     static void populateTcpmPsyName(std::string *tcpmPsyName);
 
   private:
-    static int getPsyUsbType(const std::string &path, std::string *type);
-    static int readFromFile(const std::string &path, std::string *buf);
-    static int getIntField(const std::string &path);
+    // One consistent read of every power_supply attribute onlineUpdate needs,
+    // taken up front so classification runs from memory.
+    struct PsySnapshot {
+        int usbOnline;
+        std::string usbType;      // usb psy's usb_type contents
+        std::string tcpmUsbType;  // tcpm psy's usb_type contents, if present
+    };
+    static void snapshotPsys(PsySnapshot *snap);
+    static int readPsyAttr(int dirFd, const char *attr, std::string *buf);
+    static int parsePsyUsbType(const std::string &usbType, std::string *type);
 };
 
 }  // namespace health
@@ -20,6 +20,9 @@
 #include <android-base/file.h>
 #include <android-base/logging.h>
 #include <android-base/strings.h>
+#include <android-base/unique_fd.h>
+#include <stdint.h>
+
 #include <string>
 
 namespace hardware {
@@ -37,6 +40,17 @@ class CycleCountBackupRestore {
   private:
     const char *kPersistSerial = "/mnt/vendor/persist/battery/serial_number";
 
+    // Fixed-size header preceding the nb_buckets_ int32 bins in the persisted
+    // binary record; guards restores against partial or foreign writes.
+    struct PersistHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t nb_buckets;
+        uint32_t checksum;
+    };
+    static constexpr uint32_t kPersistMagic = 0x43434252;  // "CCBR"
+    static constexpr uint32_t kPersistVersion = 1;
+
     int nb_buckets_;
     int *sw_bins_;
     int *hw_bins_;
@@ -45,7 +59,12 @@ class CycleCountBackupRestore {
     std::string sysfs_path_;
     std::string persist_path_;
     std::string serial_path_;
+    ::android::base::unique_fd sysfs_fd_;
 
+    uint32_t Checksum(const int *bins) const;
+    bool ReadPersistBinary();
+    void WritePersistBinary();
+    void ReadSysfs(int *bins);
     void Read(const std::string &path, int *bins);
     void Write(int *bins, const std::string &path);
     void UpdateAndSave();
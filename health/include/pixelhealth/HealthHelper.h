@@ -18,8 +18,12 @@
 #define HARDWARE_GOOGLE_PIXEL_HEALTH_HEALTHHELPER_H
 
 #include <aidl/android/hardware/health/HealthInfo.h>
+#include <android-base/unique_fd.h>
 #include <batteryservice/BatteryService.h>
 
+#include <string>
+#include <vector>
+
 namespace hardware {
 namespace google {
 namespace pixel {
@@ -29,6 +33,39 @@ namespace health {
 aidl::android::hardware::health::HealthInfo ToHealthInfo(
         const struct android::BatteryProperties *props);
 
+// Snapshot of a fixed set of sysfs nodes under one power_supply device
+// directory. The directory and the nodes are opened once and kept; each
+// Refresh() is then a single pread() per node into a shared buffer, instead
+// of an open/read/close cycle per property per health update. Accessors
+// parse out of the snapshot, so repeated reads of the same property within
+// one update cycle cost nothing.
+class PowerSupplySnapshot {
+  public:
+    PowerSupplySnapshot(const std::string &dir, const std::vector<std::string> &nodes);
+
+    // Re-reads every node; returns false if any node could not be read.
+    // Nodes that failed stay invalid until the next Refresh().
+    bool Refresh();
+
+    bool GetInt(const std::string &node, int64_t *value) const;
+    bool GetString(const std::string &node, std::string *value) const;
+
+  private:
+    struct Entry {
+        std::string name;
+        ::android::base::unique_fd fd;
+        size_t offset = 0;  // into buffer_
+        size_t len = 0;
+        bool valid = false;
+    };
+
+    const Entry *Find(const std::string &node) const;
+
+    ::android::base::unique_fd dir_fd_;
+    std::vector<Entry> entries_;
+    std::string buffer_;
+};
+
 }  // namespace health
 }  // namespace pixel
 }  // namespace google
@@ -22,8 +22,10 @@
 #include <android-base/logging.h>
 #include <android-base/properties.h>
 #include <android-base/strings.h>
+#include <android-base/unique_fd.h>
 #include <batteryservice/BatteryService.h>
 #include <math.h>
+#include <stdint.h>
 #include <time.h>
 #include <utils/Timers.h>
 
@@ -38,12 +40,28 @@ class LowBatteryShutdownMetrics {
   public:
     LowBatteryShutdownMetrics(
             const char *const voltage_avg,
-            const char *const persist_prop = "persist.vendor.shutdown.voltage_avg");
+            const char *const persist_prop = "persist.vendor.shutdown.voltage_avg",
+            const char *const journal_path = "");
+    ~LowBatteryShutdownMetrics();
     // Deprecated. Use logShutdownVoltage(const HealthInfo&)
     void logShutdownVoltage(struct android::BatteryProperties *props);
     void logShutdownVoltage(const aidl::android::hardware::health::HealthInfo &health_info);
 
   private:
+    // Preallocated journal page, mapped at init. Recording a shutdown voltage
+    // is then plain stores plus an msync; no file creation or property
+    // transaction happens on the brownout-adjacent shutdown path.
+    static constexpr uint32_t kJournalMagic = 0x4c42534a;  // "LBSJ"
+    static constexpr uint32_t kJournalVersion = 1;
+    static constexpr uint32_t kJournalEntries = 16;
+
+    struct ShutdownJournal {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t count;  // number of valid voltage_avg entries
+        int32_t voltage_avg[kJournalEntries];
+    };
+
     const char *const kVoltageAvg;
     const char *const kPersistProp;
 
@@ -52,6 +70,11 @@ class LowBatteryShutdownMetrics {
     // Help us avoid polling kPersistProp if it's empty
     bool prop_empty_;
 
+    ShutdownJournal *journal_ = nullptr;
+    ::android::base::unique_fd voltage_fd_;
+
+    void initJournal(const char *path);
+    bool readVoltageAvg(std::string *value);
     bool saveVoltageAvg();
     void readStatus();
     bool uploadVoltageAvg();
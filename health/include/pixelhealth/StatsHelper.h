@@ -28,6 +28,10 @@ using aidl::android::frameworks::stats::IStats;
 
 std::shared_ptr<IStats> getStatsService();
 
+// The report* helpers below enqueue the atom on an internal batching queue
+// and return immediately; a dedicated thread dedupes repeated payloads and
+// reports the batch to the IStats HAL off the health update loop.
+
 void reportBatteryHealthSnapshot(const std::shared_ptr<IStats> &stats_client, int32_t type,
                                  int32_t temperature_deci_celsius, int32_t voltage_micro_volt,
                                  int32_t current_micro_amps, int32_t open_circuit_micro_volt,
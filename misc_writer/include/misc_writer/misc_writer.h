@@ -21,12 +21,20 @@
 
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace android {
 namespace hardware {
 namespace google {
 namespace pixel {
 
+// A single pending write to the vendor space in /misc. |offset| is relative to
+// the start of the vendor space.
+struct VendorSpaceUpdate {
+  size_t offset;
+  std::string content;
+};
+
 enum class MiscWriterActions : int32_t {
   kSetDarkThemeFlag = 0,
   kClearDarkThemeFlag,
@@ -95,6 +103,13 @@ class MiscWriter {
   // offset is in relative to the start of the vendor space.
   static bool WriteMiscPartitionVendorSpace(const void* data, size_t size, size_t offset,
                                             std::string* err);
+  // Commits all of |updates| with a single open of the misc block device, instead of one
+  // open/seek/write/sync cycle per field. With |verify| set, reads every field back after the
+  // sync and fails on a mismatch.
+  static bool WriteMiscPartitionVendorSpaceBatch(const std::vector<VendorSpaceUpdate>& updates,
+                                                 std::string* err, bool verify = false);
+  // Performs the actions stored in |writers| as one batch commit on the misc block device.
+  static bool PerformBatch(const std::vector<MiscWriter>& writers, bool verify = false);
 
   explicit MiscWriter(const MiscWriterActions& action) : action_(action) {}
   explicit MiscWriter(const MiscWriterActions &action, const char data)
@@ -103,10 +118,16 @@ class MiscWriter {
       : action_(action), stringdata_(data) {}
 
   // Performs the stored MiscWriterActions. If |override_offset| is set, writes to the input offset
-  // in the vendor space of /misc instead of the default offset.
-  bool PerformAction(std::optional<size_t> override_offset = std::nullopt);
+  // in the vendor space of /misc instead of the default offset. With |verify| set, reads the
+  // written fields back and fails on a mismatch.
+  bool PerformAction(std::optional<size_t> override_offset = std::nullopt, bool verify = false);
 
  private:
+  // Translates the stored action into the (offset, content) updates it stands for, appending
+  // them to |updates|. Returns false if the action is unset.
+  bool AppendUpdates(std::optional<size_t> override_offset,
+                     std::vector<VendorSpaceUpdate>* updates) const;
+
   MiscWriterActions action_{ MiscWriterActions::kUnset };
   char chardata_{'0'};
   std::string stringdata_;
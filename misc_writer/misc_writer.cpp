@@ -20,8 +20,12 @@
 #include <android-base/logging.h>
 #include <android-base/properties.h>
 #include <android-base/stringprintf.h>
+#include <android-base/unique_fd.h>
 #include <bootloader_message/bootloader_message.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <string.h>
+#include <unistd.h>
 
 namespace android {
 namespace hardware {
@@ -47,9 +51,63 @@ bool MiscWriter::WriteMiscPartitionVendorSpace(const void* data, size_t size, si
                               err);
 }
 
-bool MiscWriter::PerformAction(std::optional<size_t> override_offset) {
+bool MiscWriter::WriteMiscPartitionVendorSpaceBatch(const std::vector<VendorSpaceUpdate>& updates,
+                                                    std::string* err, bool verify) {
+  for (const auto& update : updates) {
+    if (!OffsetAndSizeInVendorSpace(update.offset, update.content.size())) {
+      *err = android::base::StringPrintf("Out of bound write (offset %zu size %zu)", update.offset,
+                                         update.content.size());
+      return false;
+    }
+  }
+  auto misc_blk_device = get_misc_blk_device(err);
+  if (misc_blk_device.empty()) {
+    return false;
+  }
+  android::base::unique_fd fd(
+      TEMP_FAILURE_RETRY(open(misc_blk_device.c_str(), O_RDWR | O_CLOEXEC)));
+  if (!fd.ok()) {
+    *err = android::base::StringPrintf("Failed to open %s: %s", misc_blk_device.c_str(),
+                                       strerror(errno));
+    return false;
+  }
+  for (const auto& update : updates) {
+    if (!android::base::WriteFullyAtOffset(fd, update.content.data(), update.content.size(),
+                                           VENDOR_SPACE_OFFSET_IN_MISC + update.offset)) {
+      *err = android::base::StringPrintf("Failed to write %zu bytes at offset %zu: %s",
+                                         update.content.size(), update.offset, strerror(errno));
+      return false;
+    }
+  }
+  if (fsync(fd) == -1) {
+    *err = android::base::StringPrintf("Failed to fsync %s: %s", misc_blk_device.c_str(),
+                                       strerror(errno));
+    return false;
+  }
+  if (verify) {
+    std::string readback;
+    for (const auto& update : updates) {
+      readback.resize(update.content.size());
+      if (!android::base::ReadFullyAtOffset(fd, readback.data(), readback.size(),
+                                            VENDOR_SPACE_OFFSET_IN_MISC + update.offset)) {
+        *err = android::base::StringPrintf("Failed to read back %zu bytes at offset %zu: %s",
+                                           readback.size(), update.offset, strerror(errno));
+        return false;
+      }
+      if (readback != update.content) {
+        *err = android::base::StringPrintf("Readback mismatch at offset %zu", update.offset);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool MiscWriter::AppendUpdates(std::optional<size_t> override_offset,
+                               std::vector<VendorSpaceUpdate>* updates) const {
   size_t offset = 0;
   std::string content;
+  bool has_content = true;
   switch (action_) {
     case MiscWriterActions::kSetDarkThemeFlag:
     case MiscWriterActions::kClearDarkThemeFlag:
@@ -104,7 +162,9 @@ bool MiscWriter::PerformAction(std::optional<size_t> override_offset) {
         content.resize(32);
         break;
     case MiscWriterActions::kSetSotaConfig:
-        goto sota_config;
+        // Only writes the property-derived fields appended below.
+        has_content = false;
+        break;
     case MiscWriterActions::kWriteDstTransition:
         offset = override_offset.value_or(kDstTransitionOffsetInVendorSpace);
         content = std::string(kDstTransition) + stringdata_;
@@ -120,37 +180,50 @@ bool MiscWriter::PerformAction(std::optional<size_t> override_offset) {
       return false;
   }
 
-  if (std::string err;
-      !WriteMiscPartitionVendorSpace(content.data(), content.size(), offset, &err)) {
-    LOG(ERROR) << "Failed to write " << content << " at offset " << offset << " : " << err;
-    return false;
+  if (has_content) {
+    updates->push_back({offset, std::move(content)});
   }
 
-sota_config:
   if (action_ == MiscWriterActions::kSetSotaFlag || action_ == MiscWriterActions::kSetSotaConfig) {
     content = ::android::base::GetProperty("persist.vendor.nfc.factoryota.state", "");
     if (content.size() != 0 && content.size() <= 40) {
-      offset = kSotaStateOffsetInVendorSpace;
-      if (std::string err;
-          !WriteMiscPartitionVendorSpace(content.data(), content.size(), offset, &err)) {
-          LOG(ERROR) << "Failed to write " << content << " at offset " << offset << " : " << err;
-          return false;
-      }
+      updates->push_back({kSotaStateOffsetInVendorSpace, std::move(content)});
     }
     content = ::android::base::GetProperty("persist.vendor.nfc.factoryota.schedule_shipmode", "");
     if (content.size() != 0 && content.size() <= 32) {
-      offset = kSotaScheduleShipmodeOffsetInVendorSpace;
-      if (std::string err;
-          !WriteMiscPartitionVendorSpace(content.data(), content.size(), offset, &err)) {
-          LOG(ERROR) << "Failed to write " << content << " at offset " << offset << " : " << err;
-          return false;
-      }
+      updates->push_back({kSotaScheduleShipmodeOffsetInVendorSpace, std::move(content)});
     }
   }
 
   return true;
 }
 
+bool MiscWriter::PerformAction(std::optional<size_t> override_offset, bool verify) {
+  std::vector<VendorSpaceUpdate> updates;
+  if (!AppendUpdates(override_offset, &updates)) {
+    return false;
+  }
+  if (std::string err; !WriteMiscPartitionVendorSpaceBatch(updates, &err, verify)) {
+    LOG(ERROR) << "Failed to write misc partition vendor space: " << err;
+    return false;
+  }
+  return true;
+}
+
+bool MiscWriter::PerformBatch(const std::vector<MiscWriter>& writers, bool verify) {
+  std::vector<VendorSpaceUpdate> updates;
+  for (const auto& writer : writers) {
+    if (!writer.AppendUpdates(std::nullopt, &updates)) {
+      return false;
+    }
+  }
+  if (std::string err; !WriteMiscPartitionVendorSpaceBatch(updates, &err, verify)) {
+    LOG(ERROR) << "Failed to write misc partition vendor space: " << err;
+    return false;
+  }
+  return true;
+}
+
 }  // namespace pixel
 }  // namespace google
 }  // namespace hardware
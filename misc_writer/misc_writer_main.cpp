@@ -20,10 +20,10 @@
 
 #include <iostream>
 #include <map>
-#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include <android-base/logging.h>
 #include <android-base/parseint.h>
@@ -36,7 +36,9 @@ using android::hardware::google::pixel::MiscWriterActions;
 
 static int Usage(std::string_view name) {
   std::cerr << name << " usage:\n";
-  std::cerr << name << " [--override-vendor-space-offset <offset>] --<misc_writer_action>\n";
+  std::cerr << name
+            << " [--override-vendor-space-offset <offset>] [--verify] --<misc_writer_action>"
+               " [--<misc_writer_action> ...]\n";
   std::cerr << "Supported misc_writer_action is one of: \n";
   std::cerr << "  --set-dark-theme     Write the dark theme flag\n";
   std::cerr << "  --clear-dark-theme   Clear the dark theme flag\n";
@@ -57,7 +59,9 @@ static int Usage(std::string_view name) {
   std::cerr << "  --set-dstoffset               Write the time offset during the next dst transition\n";
   std::cerr << "Writes the given hex string to the specified offset in vendor space in /misc "
                "partition.\nDefault offset is used for each action unless "
-               "--override-vendor-space-offset is specified.\n";
+               "--override-vendor-space-offset is specified.\n"
+               "Multiple actions are committed with a single open of the misc block device;\n"
+               "--verify reads the written fields back after the commit.\n";
   return EXIT_FAILURE;
 }
 
@@ -81,6 +85,7 @@ int main(int argc, char** argv) {
     { "set-sota-config", no_argument, nullptr, 0 },
     { "set-dsttransition", required_argument, nullptr, 0},
     { "set-dstoffset", required_argument, nullptr, 0 },
+    { "verify", no_argument, nullptr, 0 },
     { nullptr, 0, nullptr, 0 },
   };
 
@@ -95,8 +100,9 @@ int main(int argc, char** argv) {
     { "set-sota-config", MiscWriterActions::kSetSotaConfig },
   };
 
-  std::unique_ptr<MiscWriter> misc_writer;
+  std::vector<MiscWriter> misc_writers;
   std::optional<size_t> override_offset;
+  bool verify = false;
 
   int arg;
   int option_index = 0;
@@ -124,12 +130,8 @@ int main(int argc, char** argv) {
         LOG(ERROR) << "Orientation out of range: " << optarg;
         return Usage(argv[0]);
       }
-      if (misc_writer) {
-        LOG(ERROR) << "Misc writer action has already been set";
-        return Usage(argv[0]);
-      }
-      misc_writer = std::make_unique<MiscWriter>(MiscWriterActions::kSetWristOrientationFlag,
-                                                     '0' + orientation);
+      misc_writers.emplace_back(MiscWriterActions::kSetWristOrientationFlag,
+                                static_cast<char>('0' + orientation));
     } else if (option_name == "set-timeformat"s) {
       int timeformat;
       if (!android::base::ParseInt(optarg, &timeformat)) {
@@ -140,12 +142,8 @@ int main(int argc, char** argv) {
         LOG(ERROR) << "Time format out of range: " << optarg;
         return Usage(argv[0]);
       }
-      if (misc_writer) {
-        LOG(ERROR) << "Misc writer action has already been set";
-        return Usage(argv[0]);
-      }
-      misc_writer = std::make_unique<MiscWriter>(MiscWriterActions::kWriteTimeFormat,
-                                                     '0' + timeformat);
+      misc_writers.emplace_back(MiscWriterActions::kWriteTimeFormat,
+                                static_cast<char>('0' + timeformat));
     } else if (option_name == "set-timeoffset"s) {
       int timeoffset;
       if (!android::base::ParseInt(optarg, &timeoffset)) {
@@ -156,12 +154,7 @@ int main(int argc, char** argv) {
         LOG(ERROR) << "Time offset out of range: " << optarg;
         return Usage(argv[0]);
       }
-      if (misc_writer) {
-        LOG(ERROR) << "Misc writer action has already been set";
-        return Usage(argv[0]);
-      }
-      misc_writer = std::make_unique<MiscWriter>(MiscWriterActions::kWriteTimeOffset,
-                                                     std::to_string(timeoffset));
+      misc_writers.emplace_back(MiscWriterActions::kWriteTimeOffset, std::to_string(timeoffset));
     } else if (option_name == "set-max-ram-size"s) {
       int max_ram_size;
       if (!android::base::ParseInt(optarg, &max_ram_size)) {
@@ -173,16 +166,10 @@ int main(int argc, char** argv) {
         LOG(ERROR) << "max_ram_size out of range: " << optarg;
         return Usage(argv[0]);
       }
-      if (misc_writer) {
-        LOG(ERROR) << "Misc writer action has already been set";
-        return Usage(argv[0]);
-      }
-
       if (max_ram_size == MiscWriter::kRamSizeDefault) {
-        misc_writer = std::make_unique<MiscWriter>(MiscWriterActions::kClearMaxRamSize);
+        misc_writers.emplace_back(MiscWriterActions::kClearMaxRamSize);
       } else {
-        misc_writer = std::make_unique<MiscWriter>(MiscWriterActions::kSetMaxRamSize,
-                                                   std::to_string(max_ram_size));
+        misc_writers.emplace_back(MiscWriterActions::kSetMaxRamSize, std::to_string(max_ram_size));
       }
     } else if (option_name == "set-timertcoffset"s) {
       long long int timertcoffset = strtoll(optarg, NULL, 10);
@@ -190,65 +177,56 @@ int main(int argc, char** argv) {
         LOG(ERROR) << "Failed to parse the timertcoffset:" << optarg;
         return Usage(argv[0]);
       }
-      if (misc_writer) {
-        LOG(ERROR) << "Misc writer action has already been set";
-        return Usage(argv[0]);
-      }
-      misc_writer = std::make_unique<MiscWriter>(MiscWriterActions::kWriteTimeRtcOffset,
-                                                     std::to_string(timertcoffset));
+      misc_writers.emplace_back(MiscWriterActions::kWriteTimeRtcOffset,
+                                std::to_string(timertcoffset));
     } else if (option_name == "set-minrtc"s) {
       long long int minrtc = strtoll(optarg, NULL, 10);
       if (0 == minrtc) {
         LOG(ERROR) << "Failed to parse the minrtc:" << optarg;
         return Usage(argv[0]);
       }
-      if (misc_writer) {
-        LOG(ERROR) << "Misc writer action has already been set";
-        return Usage(argv[0]);
-      }
-      misc_writer = std::make_unique<MiscWriter>(MiscWriterActions::kWriteTimeMinRtc,
-                                                     std::to_string(minrtc));
+      misc_writers.emplace_back(MiscWriterActions::kWriteTimeMinRtc, std::to_string(minrtc));
+    } else if (option_name == "verify"s) {
+      verify = true;
     } else if (auto iter = action_map.find(option_name); iter != action_map.end()) {
-      if (misc_writer) {
-        LOG(ERROR) << "Misc writer action has already been set";
-        return Usage(argv[0]);
-      }
-      misc_writer = std::make_unique<MiscWriter>(iter->second);
+      misc_writers.emplace_back(iter->second);
     } else if (option_name == "set-dsttransition"s) {
       long long int dst_transition = strtoll(optarg, NULL, 10);
       if (0 == dst_transition) {
         LOG(ERROR) << "Failed to parse the dst transition:" << optarg;
         return Usage(argv[0]);
       }
-      if (misc_writer) {
-        LOG(ERROR) << "Misc writer action has already been set";
-        return Usage(argv[0]);
-      }
-      misc_writer = std::make_unique<MiscWriter>(MiscWriterActions::kWriteDstTransition,
-                                                     std::to_string(dst_transition));
+      misc_writers.emplace_back(MiscWriterActions::kWriteDstTransition,
+                                std::to_string(dst_transition));
     } else if (option_name == "set-dstoffset"s) {
       int dst_offset;
       if (!android::base::ParseInt(optarg, &dst_offset)) {
         LOG(ERROR) << "Failed to parse the dst offset: " << optarg;
         return Usage(argv[0]);
       }
-      if (misc_writer) {
-        LOG(ERROR) << "Misc writer action has already been set";
-        return Usage(argv[0]);
-      }
-      misc_writer = std::make_unique<MiscWriter>(MiscWriterActions::kWriteDstOffset,
-                                                     std::to_string(dst_offset));
+      misc_writers.emplace_back(MiscWriterActions::kWriteDstOffset, std::to_string(dst_offset));
     } else {
       LOG(FATAL) << "Unreachable path, option_name: " << option_name;
     }
   }
 
-  if (!misc_writer) {
+  if (misc_writers.empty()) {
     LOG(ERROR) << "An action must be specified for misc writer";
     return Usage(argv[0]);
   }
 
-  if (!misc_writer->PerformAction(override_offset)) {
+  if (misc_writers.size() == 1) {
+    if (!misc_writers.front().PerformAction(override_offset, verify)) {
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  if (override_offset) {
+    LOG(ERROR) << "--override-vendor-space-offset only applies to a single action";
+    return Usage(argv[0]);
+  }
+  if (!MiscWriter::PerformBatch(misc_writers, verify)) {
     return EXIT_FAILURE;
   }
 
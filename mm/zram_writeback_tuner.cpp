@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// zram_writeback_tuner: adaptive replacement for the fixed zram writeback
+// triggers in the pixel-mm rc scripts.
+//
+// The static policy marks pages idle and writes them back on fixed timers
+// (ro.zram.mark_idle_delay_mins and friends), regardless of how full zram
+// actually is or how hard the device is thrashing. This daemon samples
+// /sys/block/zram0 statistics and PSI memory pressure, and each window
+// decides whether to mark idle pages and how large a writeback quota to
+// grant, under a daily flash-write budget.
+
+#define LOG_TAG "zram_writeback_tuner"
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/parseint.h>
+#include <android-base/properties.h>
+#include <android-base/strings.h>
+
+namespace {
+
+constexpr char kZramDir[] = "/sys/block/zram0";
+constexpr char kPsiMemory[] = "/proc/pressure/memory";
+
+// Tunables, overridable for experiments without a rebuild.
+constexpr char kIntervalProp[] = "vendor.zram.tuner.interval_secs";
+constexpr char kBudgetProp[] = "vendor.zram.tuner.wb_budget_mb_per_day";
+constexpr char kHighUtilProp[] = "vendor.zram.tuner.high_util_percent";
+constexpr char kLowUtilProp[] = "vendor.zram.tuner.low_util_percent";
+
+constexpr uint32_t kDefaultIntervalSecs = 300;
+constexpr uint32_t kDefaultBudgetMbPerDay = 128;
+constexpr uint32_t kDefaultHighUtilPercent = 70;
+constexpr uint32_t kDefaultLowUtilPercent = 30;
+
+// Skip idle marking when short-term pressure is already high, and skip
+// writeback entirely when the device is visibly stalling on memory.
+constexpr double kMarkPsiSomeAvg60Limit = 25.0;
+constexpr double kWritebackPsiFullAvg10Limit = 10.0;
+
+constexpr uint64_t kPageSize = 4096;
+constexpr uint64_t kSecsPerDay = 24 * 60 * 60;
+
+struct ZramSample {
+  uint64_t orig_data_size;  // bytes of uncompressed data stored
+  uint64_t same_pages;      // pages deduplicated to a fill pattern
+  uint64_t bd_writes;       // cumulative pages written to the backing device
+  uint64_t disksize;        // bytes
+};
+
+bool ReadNodeToString(const std::string &node, std::string *content) {
+  if (!android::base::ReadFileToString(std::string(kZramDir) + "/" + node, content)) {
+    PLOG(ERROR) << "Failed to read " << kZramDir << "/" << node;
+    return false;
+  }
+  return true;
+}
+
+bool WriteNodeString(const std::string &node, const std::string &value) {
+  if (!android::base::WriteStringToFile(value, std::string(kZramDir) + "/" + node)) {
+    PLOG(ERROR) << "Failed to write \"" << value << "\" to " << kZramDir << "/" << node;
+    return false;
+  }
+  return true;
+}
+
+bool ReadZramSample(ZramSample *sample) {
+  std::string contents;
+
+  // mm_stat: orig_data_size compr_data_size mem_used_total mem_limit
+  //          mem_used_max same_pages pages_compacted [huge_pages ...]
+  if (!ReadNodeToString("mm_stat", &contents)) {
+    return false;
+  }
+  uint64_t compr, mem_used, mem_limit, mem_max;
+  if (sscanf(contents.c_str(), "%" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64
+             " %" SCNu64,
+             &sample->orig_data_size, &compr, &mem_used, &mem_limit, &mem_max,
+             &sample->same_pages) != 6) {
+    LOG(ERROR) << "Unexpected mm_stat format: " << contents;
+    return false;
+  }
+
+  // bd_stat: bd_count bd_reads bd_writes, all in 4K page units. Absent when
+  // no backing device is configured, in which case there is nothing to tune.
+  if (!ReadNodeToString("bd_stat", &contents)) {
+    return false;
+  }
+  uint64_t bd_count, bd_reads;
+  if (sscanf(contents.c_str(), "%" SCNu64 " %" SCNu64 " %" SCNu64, &bd_count, &bd_reads,
+             &sample->bd_writes) != 3) {
+    LOG(ERROR) << "Unexpected bd_stat format: " << contents;
+    return false;
+  }
+
+  if (!ReadNodeToString("disksize", &contents)) {
+    return false;
+  }
+  if (!android::base::ParseUint(android::base::Trim(contents), &sample->disksize) ||
+      sample->disksize == 0) {
+    LOG(ERROR) << "Unexpected disksize: " << contents;
+    return false;
+  }
+
+  return true;
+}
+
+// Parses one average out of /proc/pressure/memory, e.g. the avg60 field of
+// the line starting with "some". Returns 0.0 on failure so the policy errs
+// toward treating pressure as low.
+double ReadPsiAvg(const char *line_tag, const char *avg_tag) {
+  std::string contents;
+  if (!android::base::ReadFileToString(kPsiMemory, &contents)) {
+    return 0.0;
+  }
+  for (const auto &line : android::base::Split(contents, "\n")) {
+    if (!android::base::StartsWith(line, line_tag)) {
+      continue;
+    }
+    auto pos = line.find(avg_tag);
+    if (pos == std::string::npos) {
+      return 0.0;
+    }
+    return strtod(line.c_str() + pos + strlen(avg_tag), nullptr);
+  }
+  return 0.0;
+}
+
+uint32_t GetTunable(const char *prop, uint32_t def) {
+  return android::base::GetUintProperty<uint32_t>(prop, def);
+}
+
+}  // namespace
+
+int main() {
+  const uint32_t interval_secs = GetTunable(kIntervalProp, kDefaultIntervalSecs);
+  const uint32_t budget_mb = GetTunable(kBudgetProp, kDefaultBudgetMbPerDay);
+  const uint32_t high_util = GetTunable(kHighUtilProp, kDefaultHighUtilPercent);
+  const uint32_t low_util = GetTunable(kLowUtilProp, kDefaultLowUtilPercent);
+  const uint64_t budget_pages_per_day = budget_mb * (1024ull * 1024ull) / kPageSize;
+
+  ZramSample sample;
+  if (!ReadZramSample(&sample)) {
+    // Most likely no writeback backing device on this target.
+    LOG(INFO) << "zram writeback statistics unavailable, exiting";
+    return 0;
+  }
+
+  if (!WriteNodeString("writeback_limit_enable", "1")) {
+    return 1;
+  }
+
+  LOG(INFO) << "Tuning zram writeback: interval " << interval_secs << "s, budget " << budget_mb
+            << "MB/day, utilization window " << low_util << "-" << high_util << "%";
+
+  uint64_t last_bd_writes = sample.bd_writes;
+  uint64_t budget_pages_left = budget_pages_per_day;
+  uint64_t secs_into_day = 0;
+
+  for (;; sleep(interval_secs), secs_into_day += interval_secs) {
+    if (secs_into_day >= kSecsPerDay) {
+      secs_into_day = 0;
+      budget_pages_left = budget_pages_per_day;
+    }
+
+    if (!ReadZramSample(&sample)) {
+      continue;
+    }
+
+    // Charge the flash writes of the previous window against the budget.
+    const uint64_t written = sample.bd_writes - last_bd_writes;
+    last_bd_writes = sample.bd_writes;
+    budget_pages_left -= std::min(budget_pages_left, written);
+
+    const uint64_t util_percent = sample.orig_data_size * 100 / sample.disksize;
+    const double psi_some_avg60 = ReadPsiAvg("some", "avg60=");
+    const double psi_full_avg10 = ReadPsiAvg("full", "avg10=");
+
+    LOG(DEBUG) << "zram util " << util_percent << "%, same_pages " << sample.same_pages
+               << ", psi some/avg60 " << psi_some_avg60 << ", budget left " << budget_pages_left
+               << " pages";
+
+    if (util_percent < low_util || budget_pages_left == 0) {
+      // Plenty of room in zram (or out of flash budget): leave the pages
+      // where they are instead of wearing the backing device.
+      continue;
+    }
+
+    // Marking walks the zram table; skip it while the device is already
+    // under sustained pressure and reuse whatever was marked earlier.
+    if (psi_some_avg60 <= kMarkPsiSomeAvg60Limit) {
+      WriteNodeString("idle", "all");
+    }
+
+    if (psi_full_avg10 > kWritebackPsiFullAvg10Limit) {
+      // The device is stalling on memory right now; adding flash writes to
+      // the reclaim path would make the stalls worse.
+      continue;
+    }
+
+    // Grant this window a quota proportional to how full zram is: a fuller
+    // device gets a larger slice of the remaining daily budget.
+    uint64_t quota = budget_pages_left * interval_secs / kSecsPerDay;
+    if (util_percent >= high_util) {
+      quota *= 4;
+    }
+    quota = std::min(quota, budget_pages_left);
+    if (quota == 0) {
+      continue;
+    }
+
+    WriteNodeString("writeback_limit", std::to_string(quota));
+    WriteNodeString("writeback", "idle");
+  }
+
+  return 0;
+}
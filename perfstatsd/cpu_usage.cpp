@@ -19,6 +19,14 @@
 #include "cpu_usage.h"
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 using namespace android::pixel::perfstatsd;
 
@@ -29,21 +37,133 @@ static constexpr char TOP_HEADER[] = "[CPU_TOP]  PID, PROCESS_NAME, USR_TIME, SY
 static constexpr char FMT_TOP_PROFILE[] = "%6.2f%%   %5d %s %" PRIu64 " %" PRIu64 "\n";
 
 CpuUsage::CpuUsage(void) {
-    std::string procstat;
-    if (android::base::ReadFileToString("/proc/stat", &procstat)) {
-        std::istringstream stream(procstat);
-        std::string line;
-        while (getline(stream, line)) {
-            std::vector<std::string> fields = android::base::Split(line, " ");
-            if (fields[0].find("cpu") != std::string::npos && fields[0] != "cpu") {
-                CpuData data;
-                mPrevCoresUsage.push_back(data);
+    mStatBuf.resize(8192);
+    mCurCounters.assign(kStatRows * kStatFields, 0);
+    mPrevCounters.assign(kStatRows * kStatFields, 0);
+    mDiffCounters.assign(kStatRows * kStatFields, 0);
+    // Seed the counters so the first refresh reports usage since startup
+    // rather than since boot, and count the online cores.
+    mCores = readProcStat() ? __builtin_popcount(mCoresMask) : 0;
+    mProfileThreshold = CPU_USAGE_PROFILE_THRESHOLD;
+    mTopcount = TOP_PROCESS_COUNT;
+    openProcEvents();
+}
+
+void CpuUsage::openProcEvents() {
+    mProcEvents.reset(
+        socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR));
+    if (mProcEvents.get() < 0) {
+        PLOG(WARNING) << "proc connector socket unavailable, scanning /proc every refresh";
+        return;
+    }
+
+    struct sockaddr_nl addr = {};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_pid = getpid();
+    addr.nl_groups = CN_IDX_PROC;
+    if (bind(mProcEvents.get(), (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        PLOG(WARNING) << "proc connector bind failed, scanning /proc every refresh";
+        mProcEvents.reset();
+        return;
+    }
+
+    struct __attribute__((aligned(NLMSG_ALIGNTO))) {
+        struct nlmsghdr header;
+        struct __attribute__((__packed__)) {
+            struct cn_msg msg;
+            enum proc_cn_mcast_op op;
+        } body;
+    } request = {};
+    request.header.nlmsg_len = sizeof(request);
+    request.header.nlmsg_pid = getpid();
+    request.header.nlmsg_type = NLMSG_DONE;
+    request.body.msg.id.idx = CN_IDX_PROC;
+    request.body.msg.id.val = CN_VAL_PROC;
+    request.body.msg.len = sizeof(enum proc_cn_mcast_op);
+    request.body.op = PROC_CN_MCAST_LISTEN;
+    if (send(mProcEvents.get(), &request, sizeof(request), 0) < 0) {
+        PLOG(WARNING) << "proc connector subscribe failed, scanning /proc every refresh";
+        mProcEvents.reset();
+        return;
+    }
+    LOG(INFO) << "tracking processes via proc connector events";
+}
+
+void CpuUsage::trackProcess(uint32_t pid) {
+    if (mProcFds.find(pid) != mProcFds.end())
+        return;
+    std::string path = "/proc/" + std::to_string(pid) + "/stat";
+    ::android::base::unique_fd fd(TEMP_FAILURE_RETRY(open(path.c_str(), O_RDONLY | O_CLOEXEC)));
+    if (fd.get() < 0)
+        return;  // already gone
+    mProcFds.emplace(pid, std::move(fd));
+}
+
+void CpuUsage::drainProcEvents() {
+    char buf[4096];
+    while (true) {
+        ssize_t len = recv(mProcEvents.get(), buf, sizeof(buf), 0);
+        if (len < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == ENOBUFS) {
+                // Events were dropped; resynchronize with a full scan.
+                mRescanProc = true;
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                PLOG(ERROR) << "proc connector recv failed, scanning /proc every refresh";
+                mProcEvents.reset();
+                mRescanProc = true;
+            }
+            break;
+        }
+        for (struct nlmsghdr *nh = (struct nlmsghdr *)buf; NLMSG_OK(nh, (size_t)len);
+             nh = NLMSG_NEXT(nh, len)) {
+            if (nh->nlmsg_type != NLMSG_DONE)
+                continue;
+            struct cn_msg *cn = (struct cn_msg *)NLMSG_DATA(nh);
+            if (cn->id.idx != CN_IDX_PROC || cn->id.val != CN_VAL_PROC)
+                continue;
+            struct proc_event *event = (struct proc_event *)cn->data;
+            switch (event->what) {
+                case proc_event::PROC_EVENT_FORK:
+                    // Threads share the group leader's stat; track tgids only.
+                    if (event->event_data.fork.child_pid == event->event_data.fork.child_tgid)
+                        trackProcess(event->event_data.fork.child_tgid);
+                    break;
+                case proc_event::PROC_EVENT_EXIT:
+                    if (event->event_data.exit.process_pid == event->event_data.exit.process_tgid)
+                        mProcFds.erase(event->event_data.exit.process_tgid);
+                    break;
+                default:
+                    break;
             }
         }
     }
-    mCores = mPrevCoresUsage.size();
-    mProfileThreshold = CPU_USAGE_PROFILE_THRESHOLD;
-    mTopcount = TOP_PROCESS_COUNT;
+}
+
+void CpuUsage::updateProcessCache() {
+    if (mProcEvents.get() < 0)
+        mRescanProc = true;
+    else
+        drainProcEvents();
+
+    if (mRescanProc) {
+        DIR *dir = opendir("/proc/");
+        if (dir == NULL) {
+            LOG(ERROR) << "Fail to open /proc/";
+            return;
+        }
+        struct dirent *ent;
+        while ((ent = readdir(dir)) != NULL) {
+            uint32_t pid;
+            if (ent->d_type == DT_DIR && android::base::ParseUint(ent->d_name, &pid))
+                trackProcess(pid);
+        }
+        closedir(dir);
+        mRescanProc = false;
+    }
 }
 
 void CpuUsage::setOptions(const std::string &key, const std::string &value) {
@@ -65,191 +185,240 @@ void CpuUsage::setOptions(const std::string &key, const std::string &value) {
             cDebug = (val != 0);
             LOG(INFO) << "set debug " << cDebug;
         } else if (key == CPU_TOPCOUNT) {
+            // Bounded by the record array the history ring stores.
+            if (val > CPU_USAGE_TOP_MAX) {
+                LOG(WARNING) << "top count " << val << " clamped to " << CPU_USAGE_TOP_MAX;
+                val = CPU_USAGE_TOP_MAX;
+            }
             mTopcount = val;
             LOG(INFO) << "set top count " << mTopcount;
         }
     }
 }
 
-void CpuUsage::profileProcess(std::string *out) {
-    // Read cpu usage per process and find the top ones
-    DIR *dir;
-    struct dirent *ent;
+void CpuUsage::profileProcess(CpuRecord *record) {
+    // pread every cached stat fd and find the top consumers
     std::unordered_map<uint32_t, ProcData> procUsage;
     std::priority_queue<ProcData, std::vector<ProcData>, ProcdataCompare> procList;
-    if ((dir = opendir("/proc/")) != NULL) {
-        while ((ent = readdir(dir)) != NULL) {
-            if (ent->d_type == DT_DIR) {
-                std::string pidStr = ent->d_name;
-                std::string::const_iterator it = pidStr.begin();
-                while (it != pidStr.end() && isdigit(*it)) ++it;
-                if (!pidStr.empty() && it == pidStr.end()) {
-                    std::string pidStat;
-                    if (android::base::ReadFileToString("/proc/" + pidStr + "/stat", &pidStat)) {
-                        std::vector<std::string> fields = android::base::Split(pidStat, " ");
-                        uint32_t pid = 0;
-                        uint64_t utime = 0;
-                        uint64_t stime = 0;
-                        uint64_t cutime = 0;
-                        uint64_t cstime = 0;
-
-                        if (!base::ParseUint(fields[0], &pid) ||
-                            !base::ParseUint(fields[13], &utime) ||
-                            !base::ParseUint(fields[14], &stime) ||
-                            !base::ParseUint(fields[15], &cutime) ||
-                            !base::ParseUint(fields[16], &cstime)) {
-                            LOG(ERROR) << "Invalid proc data\n" << pidStat;
-                            continue;
-                        }
-                        std::string proc = fields[1];
-                        std::string name =
-                            proc.length() > 2 ? proc.substr(1, proc.length() - 2) : "";
-                        uint64_t user = utime + cutime;
-                        uint64_t system = stime + cstime;
-                        uint64_t totalUsage = user + system;
-
-                        uint64_t diffUser = user - mPrevProcdata[pid].user;
-                        uint64_t diffSystem = system - mPrevProcdata[pid].system;
-                        uint64_t diffUsage = totalUsage - mPrevProcdata[pid].usage;
-
-                        ProcData ldata;
-                        ldata.user = user;
-                        ldata.system = system;
-                        ldata.usage = totalUsage;
-                        procUsage[pid] = ldata;
-
-                        float usageRatio = (float)(diffUsage * 100.0 / mDiffCpu);
-                        if (cDebug && usageRatio > 100) {
-                            LOG(INFO) << "pid: " << pid << " , ratio: " << usageRatio
-                                      << " , prev usage: " << mPrevProcdata[pid].usage
-                                      << " , cur usage: " << totalUsage
-                                      << " , total cpu diff: " << mDiffCpu;
-                        }
-
-                        ProcData data;
-                        data.pid = pid;
-                        data.name = name;
-                        data.usageRatio = usageRatio;
-                        data.user = diffUser;
-                        data.system = diffSystem;
-                        procList.push(data);
-                    }
-                }
+    std::vector<uint32_t> deadPids;
+    char buf[2048];
+    for (const auto &proc : mProcFds) {
+        ssize_t n = TEMP_FAILURE_RETRY(pread(proc.second.get(), buf, sizeof(buf) - 1, 0));
+        if (n <= 0) {
+            // The fd pins the process it was opened on; ESRCH means it exited.
+            deadPids.push_back(proc.first);
+            continue;
+        }
+        buf[n] = '\0';
+        std::string pidStat(buf);
+        std::vector<std::string> fields = android::base::Split(pidStat, " ");
+        uint32_t pid = 0;
+        uint64_t utime = 0;
+        uint64_t stime = 0;
+        uint64_t cutime = 0;
+        uint64_t cstime = 0;
+
+        if (fields.size() < 17 || !base::ParseUint(fields[0], &pid) ||
+            !base::ParseUint(fields[13], &utime) || !base::ParseUint(fields[14], &stime) ||
+            !base::ParseUint(fields[15], &cutime) || !base::ParseUint(fields[16], &cstime)) {
+            LOG(ERROR) << "Invalid proc data\n" << pidStat;
+            continue;
+        }
+        std::string proc_name = fields[1];
+        std::string name =
+            proc_name.length() > 2 ? proc_name.substr(1, proc_name.length() - 2) : "";
+        uint64_t user = utime + cutime;
+        uint64_t system = stime + cstime;
+        uint64_t totalUsage = user + system;
+
+        uint64_t diffUser = user - mPrevProcdata[pid].user;
+        uint64_t diffSystem = system - mPrevProcdata[pid].system;
+        uint64_t diffUsage = totalUsage - mPrevProcdata[pid].usage;
+
+        ProcData ldata;
+        ldata.user = user;
+        ldata.system = system;
+        ldata.usage = totalUsage;
+        procUsage[pid] = ldata;
+
+        float usageRatio = (float)(diffUsage * 100.0 / mDiffCpu);
+        if (cDebug && usageRatio > 100) {
+            LOG(INFO) << "pid: " << pid << " , ratio: " << usageRatio
+                      << " , prev usage: " << mPrevProcdata[pid].usage
+                      << " , cur usage: " << totalUsage << " , total cpu diff: " << mDiffCpu;
+        }
+
+        ProcData data;
+        data.pid = pid;
+        data.name = name;
+        data.usageRatio = usageRatio;
+        data.user = diffUser;
+        data.system = diffSystem;
+        procList.push(data);
+    }
+    for (uint32_t pid : deadPids) {
+        mProcFds.erase(pid);
+    }
+    mPrevProcdata = std::move(procUsage);
+    uint32_t count = 0;
+    for (; !procList.empty() && count < mTopcount && count < CPU_USAGE_TOP_MAX; count++) {
+        const ProcData &data = procList.top();
+        record->top[count].usageRatio = data.usageRatio;
+        record->top[count].pid = data.pid;
+        strlcpy(record->top[count].name, data.name.c_str(), CPU_USAGE_COMM_MAX);
+        record->top[count].user = data.user;
+        record->top[count].system = data.system;
+        procList.pop();
+    }
+    record->topCount = count;
+}
+
+/**
+ * Pread /proc/stat through the persistent fd into the reusable buffer and
+ * scan the leading cpu lines in place into the SoA counter block. Lines are
+ * located with memchr and the counters parsed with a plain digit loop; no
+ * per-line strings are allocated.
+ */
+bool CpuUsage::readProcStat() {
+    if (mStatFd.get() < 0) {
+        mStatFd.reset(TEMP_FAILURE_RETRY(open("/proc/stat", O_RDONLY | O_CLOEXEC)));
+        if (mStatFd.get() < 0) {
+            PLOG(ERROR) << "Fail to open /proc/stat";
+            return false;
+        }
+    }
+
+    ssize_t n;
+    for (;;) {
+        n = TEMP_FAILURE_RETRY(pread(mStatFd.get(), mStatBuf.data(), mStatBuf.size(), 0));
+        if (n < 0) {
+            PLOG(ERROR) << "Fail to read /proc/stat";
+            return false;
+        }
+        if ((size_t)n < mStatBuf.size())
+            break;
+        // The whole file must fit so one pread sees a consistent snapshot.
+        mStatBuf.resize(mStatBuf.size() * 2);
+    }
+
+    mCoresMask = 0;
+    const char *pos = mStatBuf.data();
+    const char *end = pos + n;
+    while (pos < end) {
+        const char *eol = static_cast<const char *>(memchr(pos, '\n', end - pos));
+        if (eol == nullptr)
+            eol = end;
+        // The cpu lines lead the file; stop at the first non-cpu line.
+        if (eol - pos < 4 || memcmp(pos, "cpu", 3) != 0)
+            break;
+
+        // cpu  6013 3243 6311 92390 517 693 319 0 0 0  <-- row 0
+        // cpu0 558 139 568 12135 67 121 50 0 0 0       <-- row 1
+        const char *p = pos + 3;
+        uint32_t row = 0;
+        if (*p != ' ') {
+            uint32_t core = 0;
+            bool valid = false;
+            while (p < eol && *p >= '0' && *p <= '9') {
+                core = core * 10 + (*p++ - '0');
+                valid = true;
             }
+            if (!valid || core >= CPU_USAGE_CORES_MAX) {
+                LOG(ERROR) << "Invalid /proc/stat core id";
+                pos = eol + 1;
+                continue;
+            }
+            row = core + 1;
+            mCoresMask |= 1u << core;
         }
-        mPrevProcdata = std::move(procUsage);
-        out->append(TOP_HEADER);
-        for (uint32_t count = 0; !procList.empty() && count < mTopcount; count++) {
-            ProcData data = procList.top();
-            out->append(android::base::StringPrintf(FMT_TOP_PROFILE, data.usageRatio, data.pid,
-                                                    data.name.c_str(), data.user, data.system));
-            procList.pop();
+
+        uint64_t *out = &mCurCounters[row * kStatFields];
+        for (uint32_t field = 0; field < kStatFields; field++) {
+            while (p < eol && *p == ' ')
+                p++;
+            uint64_t value = 0;
+            while (p < eol && *p >= '0' && *p <= '9')
+                value = value * 10 + (*p++ - '0');
+            out[field] = value;
         }
-        closedir(dir);
-    } else {
-        LOG(ERROR) << "Fail to open /proc/";
+        pos = eol + 1;
     }
+    return true;
 }
 
-void CpuUsage::getOverallUsage(std::chrono::system_clock::time_point &now, std::string *out) {
+void CpuUsage::getOverallUsage(CpuRecord *record) {
     mDiffCpu = 0;
     mTotalRatio = 0.0f;
-    std::string procStat;
-
-    // Get overall cpu usage
-    if (android::base::ReadFileToString("/proc/stat", &procStat)) {
-        std::istringstream stream(procStat);
-        std::string line;
-        while (getline(stream, line)) {
-            std::vector<std::string> fields = android::base::Split(line, " ");
-            if (fields[0].find("cpu") != std::string::npos) {
-                std::string cpuStr = fields[0];
-                std::string core = cpuStr.length() > 3 ? cpuStr.substr(3, cpuStr.length() - 3) : "";
-                uint64_t user = 0;
-                uint64_t nice = 0;
-                uint64_t system = 0;
-                uint64_t idle = 0;
-                uint64_t iowait = 0;
-                uint64_t irq = 0;
-                uint64_t softirq = 0;
-                uint64_t steal = 0;
-
-                // cpu  6013 3243 6311 92390 517 693 319 0 0 0  <-- (fields[1] = "")
-                // cpu0 558 139 568 12135 67 121 50 0 0 0
-                uint32_t base = core.compare("") ? 1 : 2;
-
-                if (!base::ParseUint(fields[base], &user) ||
-                    !base::ParseUint(fields[base + 1], &nice) ||
-                    !base::ParseUint(fields[base + 2], &system) ||
-                    !base::ParseUint(fields[base + 3], &idle) ||
-                    !base::ParseUint(fields[base + 4], &iowait) ||
-                    !base::ParseUint(fields[base + 5], &irq) ||
-                    !base::ParseUint(fields[base + 6], &softirq) ||
-                    !base::ParseUint(fields[base + 7], &steal)) {
-                    LOG(ERROR) << "Invalid /proc/stat data\n" << line;
-                    continue;
-                }
-
-                uint64_t cpuTime = user + nice + system + idle + iowait + irq + softirq + steal;
-                uint64_t cpuUsage = cpuTime - idle - iowait;
-                uint64_t userUsage = user + nice;
-
-                if (!core.compare("")) {
-                    uint64_t diffUsage = cpuUsage - mPrevUsage.cpuUsage;
-                    mDiffCpu = cpuTime - mPrevUsage.cpuTime;
-                    uint64_t diffUser = userUsage - mPrevUsage.userUsage;
-                    uint64_t diffSys = system - mPrevUsage.sysUsage;
-                    uint64_t diffIo = iowait - mPrevUsage.ioUsage;
-
-                    mTotalRatio = (float)(diffUsage * 100.0 / mDiffCpu);
-                    float userRatio = (float)(diffUser * 100.0 / mDiffCpu);
-                    float sysRatio = (float)(diffSys * 100.0 / mDiffCpu);
-                    float ioRatio = (float)(diffIo * 100.0 / mDiffCpu);
-
-                    if (cDebug) {
-                        LOG(INFO) << "prev total: " << mPrevUsage.cpuUsage
-                                  << " , cur total: " << cpuUsage << " , diffusage: " << diffUsage
-                                  << " , diffcpu: " << mDiffCpu << " , ratio: " << mTotalRatio;
-                    }
-
-                    mPrevUsage.cpuUsage = cpuUsage;
-                    mPrevUsage.cpuTime = cpuTime;
-                    mPrevUsage.userUsage = userUsage;
-                    mPrevUsage.sysUsage = system;
-                    mPrevUsage.ioUsage = iowait;
-
-                    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - mLast);
-                    out->append(android::base::StringPrintf(FMT_CPU_TOTAL, ms.count() / 1000,
-                                                            ms.count() % 1000, mTotalRatio,
-                                                            userRatio, sysRatio, ioRatio));
-                } else {
-                    // calculate total cpu usage of each core
-                    uint32_t c = 0;
-                    if (!base::ParseUint(core, &c)) {
-                        LOG(ERROR) << "Invalid core: " << core;
-                        continue;
-                    }
-                    uint64_t diffUsage = cpuUsage - mPrevCoresUsage[c].cpuUsage;
-                    float coreTotalRatio = (float)(diffUsage * 100.0 / mDiffCpu);
-                    if (cDebug) {
-                        LOG(INFO) << "core " << c
-                                  << " , prev cpu usage: " << mPrevCoresUsage[c].cpuUsage
-                                  << " , cur cpu usage: " << cpuUsage
-                                  << " , diffusage: " << diffUsage
-                                  << " , difftotalcpu: " << mDiffCpu
-                                  << " , ratio: " << coreTotalRatio;
-                    }
-                    mPrevCoresUsage[c].cpuUsage = cpuUsage;
-
-                    char buf[64];
-                    sprintf(buf, "%.2f%%]", coreTotalRatio);
-                    out->append("[" + core + ":" + std::string(buf));
-                }
-            }
+
+    // Field offsets within a counter row.
+    constexpr uint32_t USER = 0, NICE = 1, SYSTEM = 2, IDLE = 3, IOWAIT = 4;
+
+    std::swap(mPrevCounters, mCurCounters);
+    if (!readProcStat()) {
+        std::swap(mPrevCounters, mCurCounters);  // keep the last good sample
+        return;
+    }
+
+    // Carry the last-seen counters forward for offline cores so a core
+    // re-appearing after hotplug diffs against its last online sample.
+    for (uint32_t c = 0; c < CPU_USAGE_CORES_MAX; c++) {
+        if (!(mCoresMask & (1u << c)))
+            memcpy(&mCurCounters[(c + 1) * kStatFields], &mPrevCounters[(c + 1) * kStatFields],
+                   kStatFields * sizeof(uint64_t));
+    }
+
+    // One flat, vectorizable subtraction over the whole SoA block.
+    for (size_t i = 0; i < mDiffCounters.size(); i++)
+        mDiffCounters[i] = mCurCounters[i] - mPrevCounters[i];
+
+    // Aggregate "cpu" row
+    const uint64_t *diff = mDiffCounters.data();
+    uint64_t diffCpu = 0;
+    for (uint32_t field = 0; field < kStatFields; field++)
+        diffCpu += diff[field];
+    mDiffCpu = diffCpu;
+
+    uint64_t diffUsage = diffCpu - diff[IDLE] - diff[IOWAIT];
+    uint64_t diffUser = diff[USER] + diff[NICE];
+    uint64_t diffSys = diff[SYSTEM];
+    uint64_t diffIo = diff[IOWAIT];
+
+    mTotalRatio = (float)(diffUsage * 100.0 / mDiffCpu);
+    float userRatio = (float)(diffUser * 100.0 / mDiffCpu);
+    float sysRatio = (float)(diffSys * 100.0 / mDiffCpu);
+    float ioRatio = (float)(diffIo * 100.0 / mDiffCpu);
+
+    if (cDebug) {
+        LOG(INFO) << "diffusage: " << diffUsage << " , diffcpu: " << mDiffCpu
+                  << " , ratio: " << mTotalRatio;
+    }
+
+    record->sampled = true;
+    record->totalRatio = mTotalRatio;
+    record->userRatio = userRatio;
+    record->sysRatio = sysRatio;
+    record->ioRatio = ioRatio;
+
+    // calculate total cpu usage of each online core
+    for (uint32_t c = 0; c < CPU_USAGE_CORES_MAX; c++) {
+        if (!(mCoresMask & (1u << c)))
+            continue;
+        const uint64_t *coreDiff = &mDiffCounters[(c + 1) * kStatFields];
+        uint64_t coreDiffCpu = 0;
+        for (uint32_t field = 0; field < kStatFields; field++)
+            coreDiffCpu += coreDiff[field];
+        uint64_t coreDiffUsage = coreDiffCpu - coreDiff[IDLE] - coreDiff[IOWAIT];
+        float coreTotalRatio = (float)(coreDiffUsage * 100.0 / mDiffCpu);
+        if (cDebug) {
+            LOG(INFO) << "core " << c << " , diffusage: " << coreDiffUsage
+                      << " , difftotalcpu: " << mDiffCpu << " , ratio: " << coreTotalRatio;
+        }
+
+        if (record->coreCount < CPU_USAGE_CORES_MAX) {
+            record->coreId[record->coreCount] = c;
+            record->coreRatio[record->coreCount] = coreTotalRatio;
+            record->coreCount++;
         }
-        out->append("\n");
-    } else {
-        LOG(ERROR) << "Fail to read /proc/stat";
     }
 }
 
@@ -257,29 +426,75 @@ void CpuUsage::refresh(void) {
     if (mDisabled)
         return;
 
-    std::string out;
+    // Drain fork/exit events every cycle so the netlink queue cannot
+    // overflow while profiling is idle.
+    updateProcessCache();
+
+    CpuRecord record = {};
     std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+    record.time = now;
+    record.periodMs =
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - mLast).count();
 
-    getOverallUsage(now, &out);
+    getOverallUsage(&record);
 
     if (mTotalRatio >= mProfileThreshold) {
         if (cDebug)
             LOG(INFO) << "Total CPU usage over " << mProfileThreshold << "%";
-        std::string profileResult;
-        profileProcess(&profileResult);
-        if (mProfileProcess) {
+        profileProcess(&record);
+        if (!mProfileProcess) {
             // Dump top processes once met threshold continuously at least twice.
-            out.append(profileResult);
-        } else
+            record.topCount = 0;
             mProfileProcess = true;
+        }
     } else
         mProfileProcess = false;
 
-    append(now, out);
+    (mBurst ? mBurstBuffer : mBuffer).emplace(record);
     mLast = now;
     if (cDebug) {
         auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::system_clock::now() - now);
-        LOG(INFO) << "Took " << ms.count() << " ms, data bytes: " << out.length();
+        LOG(INFO) << "Took " << ms.count() << " ms, record bytes: " << sizeof(record);
+    }
+}
+
+void CpuUsage::dump(
+    std::priority_queue<StatsData, std::vector<StatsData>, StatsdataCompare> *queue) {
+    // Burst records carry their own timestamps, so the merged queue
+    // interleaves them with the regular history in time order.
+    dumpRecords(mBuffer.snapshot(), queue);
+    dumpRecords(mBurstBuffer.snapshot(), queue);
+}
+
+void CpuUsage::dumpRecords(
+    const std::vector<CpuRecord> &records,
+    std::priority_queue<StatsData, std::vector<StatsData>, StatsdataCompare> *queue) {
+    for (const CpuRecord &record : records) {
+        std::string out;
+        if (record.sampled) {
+            out.append(android::base::StringPrintf(
+                FMT_CPU_TOTAL, (long long)(record.periodMs / 1000),
+                (long long)(record.periodMs % 1000), record.totalRatio, record.userRatio,
+                record.sysRatio, record.ioRatio));
+            for (uint32_t i = 0; i < record.coreCount; i++) {
+                out.append(android::base::StringPrintf("[%" PRIu32 ":%.2f%%]", record.coreId[i],
+                                                       record.coreRatio[i]));
+            }
+            out.append("\n");
+        }
+        if (record.topCount > 0) {
+            out.append(TOP_HEADER);
+            for (uint32_t i = 0; i < record.topCount; i++) {
+                out.append(android::base::StringPrintf(
+                    FMT_TOP_PROFILE, record.top[i].usageRatio, record.top[i].pid,
+                    record.top[i].name, record.top[i].user, record.top[i].system));
+            }
+        }
+        StatsData data;
+        std::chrono::system_clock::time_point time = record.time;
+        data.setTime(time);
+        data.setData(out);
+        queue->push(data);
     }
 }
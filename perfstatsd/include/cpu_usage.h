@@ -17,11 +17,16 @@
 #ifndef _CPU_USAGE_H_
 #define _CPU_USAGE_H_
 
+#include <android-base/unique_fd.h>
 #include <statstype.h>
 
 #define CPU_USAGE_BUFFER_SIZE (6 * 30)
 #define TOP_PROCESS_COUNT (5)
 #define CPU_USAGE_PROFILE_THRESHOLD (50)
+// Record array bounds; comm length matches the kernel's TASK_COMM_LEN.
+#define CPU_USAGE_CORES_MAX (32)
+#define CPU_USAGE_TOP_MAX (10)
+#define CPU_USAGE_COMM_MAX (16)
 
 #define PROCPROF_THRESHOLD "cpu.procprof.threshold"
 #define CPU_DISABLED "cpu.disabled"
@@ -32,14 +37,6 @@ namespace android {
 namespace pixel {
 namespace perfstatsd {
 
-struct CpuData {
-    uint64_t cpuUsage;
-    uint64_t cpuTime;
-    uint64_t userUsage;
-    uint64_t sysUsage;
-    uint64_t ioUsage;
-};
-
 struct ProcData {
     uint32_t pid;
     std::string name;
@@ -49,11 +46,38 @@ struct ProcData {
     uint64_t system;
 };
 
+// Binary history record; formatted to text only at dump time.
+struct CpuRecord {
+    std::chrono::system_clock::time_point time;
+    int64_t periodMs;  // time since the previous sample
+    bool sampled;      // false when /proc/stat could not be read
+    float totalRatio;
+    float userRatio;
+    float sysRatio;
+    float ioRatio;
+    uint32_t coreCount;
+    uint32_t coreId[CPU_USAGE_CORES_MAX];
+    float coreRatio[CPU_USAGE_CORES_MAX];
+    uint32_t topCount;
+    struct {
+        float usageRatio;
+        uint32_t pid;
+        char name[CPU_USAGE_COMM_MAX];
+        uint64_t user;
+        uint64_t system;
+    } top[CPU_USAGE_TOP_MAX];
+};
+
 class CpuUsage : public StatsType {
   public:
     CpuUsage(void);
-    void refresh(void);
-    void setOptions(const std::string &key, const std::string &value);
+    void refresh(void) override;
+    void setOptions(const std::string &key, const std::string &value) override;
+    void dump(std::priority_queue<StatsData, std::vector<StatsData>, StatsdataCompare> *queue)
+            override;
+    void setBufferSize(size_t size) override { mBuffer.setSize(size); }
+    void setBurst(bool enabled) override { mBurst = enabled; }
+    void setBurstBufferSize(size_t size) override { mBurstBuffer.setSize(size); }
 
   private:
     std::chrono::system_clock::time_point mLast;
@@ -62,13 +86,44 @@ class CpuUsage : public StatsType {
     uint32_t mTopcount;
     bool mDisabled;
     bool mProfileProcess;
-    CpuData mPrevUsage;                                    // cpu usage of last record
-    std::vector<CpuData> mPrevCoresUsage;                  // cpu usage per core of last record
     std::unordered_map<uint32_t, ProcData> mPrevProcdata;  // <pid, last_usage>
+    // /proc/stat counters in structure-of-arrays layout: row 0 is the
+    // aggregate "cpu" line, row c + 1 is core c, and each row holds the first
+    // kStatFields counters (user nice system idle iowait irq softirq steal).
+    // The file is pread into a reusable buffer through a persistent fd and
+    // scanned in place; deltas against the previous sample are one flat
+    // array subtraction.
+    static constexpr uint32_t kStatFields = 8;
+    static constexpr uint32_t kStatRows = CPU_USAGE_CORES_MAX + 1;
+    ::android::base::unique_fd mStatFd;
+    std::vector<char> mStatBuf;
+    std::vector<uint64_t> mCurCounters;
+    std::vector<uint64_t> mPrevCounters;
+    std::vector<uint64_t> mDiffCounters;
+    uint32_t mCoresMask = 0;  // cores seen in the latest parse
+    bool readProcStat();
     uint64_t mDiffCpu;
     float mTotalRatio;
-    void getOverallUsage(std::chrono::system_clock::time_point &, std::string *);
-    void profileProcess(std::string *);
+    PerfstatsRing<CpuRecord> mBuffer;
+    PerfstatsRing<CpuRecord> mBurstBuffer;  // burst-mode samples only
+    bool mBurst = false;
+    // Persistent /proc/<pid>/stat fds, one per live process. A pinned fd
+    // returns ESRCH once its process exits (even if the pid is reused), so
+    // the fd itself guards against stale identities; the map is maintained
+    // from proc connector fork/exit events and each profile pass is one
+    // pread per live fd instead of a full /proc enumeration.
+    std::unordered_map<uint32_t, ::android::base::unique_fd> mProcFds;
+    ::android::base::unique_fd mProcEvents;  // netlink proc connector socket
+    bool mRescanProc = true;  // full /proc scan needed (startup, lost events)
+    void openProcEvents();
+    void drainProcEvents();
+    void trackProcess(uint32_t pid);
+    void updateProcessCache();
+    void getOverallUsage(CpuRecord *record);
+    void profileProcess(CpuRecord *record);
+    void dumpRecords(
+            const std::vector<CpuRecord> &records,
+            std::priority_queue<StatsData, std::vector<StatsData>, StatsdataCompare> *queue);
 };
 
 struct ProcdataCompare {
@@ -16,7 +16,10 @@
 #ifndef _IO_USAGE_H_
 #define _IO_USAGE_H_
 
+#include <latency_histogram.h>
 #include <statstype.h>
+#include <time.h>
+
 #include <chrono>
 #include <sstream>
 #include <string>
@@ -25,6 +28,9 @@
 
 #define IO_USAGE_BUFFER_SIZE (6 * 30)
 #define IO_TOP_MAX 5
+// Process/package names come from /proc/pid/status (TASK_COMM_LEN) or
+// getpwuid, both well under this bound.
+#define IO_USAGE_NAME_MAX 32
 
 namespace android {
 namespace pixel {
@@ -44,6 +50,24 @@ class ProcPidIoStats {
     bool getNameForUid(uint32_t uid, std::string *name);
 };
 
+/*
+ * uid -> package-name cache built from /data/system/packages.list. The list
+ * is mmap'd and parsed once, then re-parsed only when its mtime changes
+ * (package install/uninstall), so a steady-state lookup is a hash probe
+ * instead of the per-cycle /proc walk ProcPidIoStats needs. Uids the list
+ * does not cover - or everything, when the file is not readable - fall back
+ * to that walk.
+ */
+class PackageUidNameCache {
+  public:
+    bool getNameForUid(uint32_t uid, std::string *name);
+
+  private:
+    void reloadIfNeeded();
+    std::unordered_map<uint32_t, std::string> mUidNames;
+    struct timespec mMtime = {0, 0};
+};
+
 struct UserIo {
     uint32_t uid;
     uint64_t fgRead;
@@ -88,9 +112,9 @@ struct UserIo {
         return r;
     }
 
-    uint64_t sumWrite() { return fgWrite + bgWrite; }
+    uint64_t sumWrite() const { return fgWrite + bgWrite; }
 
-    uint64_t sumRead() { return fgRead + bgRead; }
+    uint64_t sumRead() const { return fgRead + bgRead; }
 
     void reset() {
         uid = 0;
@@ -103,18 +127,33 @@ struct UserIo {
     }
 };
 
+/*
+ * Section timer: every timed scope feeds the always-on shared-page latency
+ * histogram for its section; the formatted text log remains opt-in via
+ * setEnabled (the debug option), as before.
+ */
 class ScopeTimer {
   private:
     bool mDisabled;
+    int mSectionId;
     std::string mName;
     std::chrono::system_clock::time_point mStart;
 
   public:
     ScopeTimer() : ScopeTimer("") {}
-    ScopeTimer(std::string name) : mDisabled(false), mName(name) {
+    ScopeTimer(std::string name)
+        : mDisabled(false),
+          mSectionId(LatencyHistogramSet::getInstance()->sectionId(name)),
+          mName(name) {
         mStart = std::chrono::system_clock::now();
     }
     ~ScopeTimer() {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::system_clock::now() - mStart)
+                      .count();
+        if (us < 0)  // the wall clock can step backwards
+            us = 0;
+        LatencyHistogramSet::getInstance()->record(mSectionId, us);
         if (!mDisabled) {
             std::string msg;
             dump(&msg);
@@ -125,6 +164,53 @@ class ScopeTimer {
     void dump(std::string *outAppend);
 };
 
+// Binary history record; formatted to text only at dump time. Names are
+// resolved at refresh time since the uid/name maps belong to the refresh
+// thread.
+struct IoRecord {
+    std::chrono::system_clock::time_point time;
+    int64_t periodMs;
+    uint64_t totalRead;
+    uint64_t totalWrite;
+    uint64_t totalFsync;
+    // Dump thresholds in effect when the record was taken.
+    uint64_t minRead;
+    uint64_t minWrite;
+    struct Entry {
+        uint32_t uid;
+        uint64_t fgBytes;
+        uint64_t bgBytes;
+        uint64_t fgFsync;
+        uint64_t bgFsync;
+        char name[IO_USAGE_NAME_MAX];
+    };
+    uint32_t readCount;
+    uint32_t writeCount;
+    Entry readTop[IO_TOP_MAX];
+    Entry writeTop[IO_TOP_MAX];
+};
+
+/*
+ * Streaming top-K tracker: a fixed-size min-heap keyed on the caller's
+ * usage sum. A sample below the current minimum costs one compare; only a
+ * displacing sample pays the log-K heap repair.
+ */
+class IoTopK {
+  public:
+    void reset() { mCount = 0; }
+    void push(const UserIo &usage, uint64_t key);
+    // Copies up to IO_TOP_MAX entries into out, largest key first.
+    uint32_t copySorted(UserIo *out) const;
+
+  private:
+    struct Item {
+        uint64_t key;
+        UserIo usage;
+    };
+    Item mHeap[IO_TOP_MAX];  // min-heap on key
+    uint32_t mCount = 0;
+};
+
 constexpr uint64_t IO_USAGE_DUMP_THRESHOLD = 50L * 1000L * 1000L;  // 50MB
 class IoStats {
   private:
@@ -134,16 +220,15 @@ class IoStats {
     std::chrono::system_clock::time_point mNow;
     std::unordered_map<uint32_t, UserIo> mPrevious;
     UserIo mTotal;
-    UserIo mWriteTop[IO_TOP_MAX];
-    UserIo mReadTop[IO_TOP_MAX];
+    IoTopK mWriteTop;
+    IoTopK mReadTop;
     std::vector<uint32_t> mUnknownUidList;
     std::unordered_map<uint32_t, std::string> mUidNameMap;
     ProcPidIoStats mProcIoStats;
+    PackageUidNameCache mPackageCache;
     // Functions
     std::unordered_map<uint32_t, UserIo> calcIncrement(
         const std::unordered_map<uint32_t, UserIo> &data);
-    void updateTopWrite(UserIo usage);
-    void updateTopRead(UserIo usage);
     void updateUnknownUidList();
 
   public:
@@ -154,18 +239,29 @@ class IoStats {
     void calcAll(std::unordered_map<uint32_t, UserIo> &&data);
     void setDumpThresholdSizeForRead(uint64_t size) { mMinSizeOfTotalRead = size; }
     void setDumpThresholdSizeForWrite(uint64_t size) { mMinSizeOfTotalWrite = size; }
-    bool dump(std::stringstream *output);
+    void fill(IoRecord *record);
 };
 
 class IoUsage : public StatsType {
   private:
     bool mDisabled;
     IoStats mStats;
+    PerfstatsRing<IoRecord> mBuffer;
+    PerfstatsRing<IoRecord> mBurstBuffer;  // burst-mode samples only
+    bool mBurst = false;
+    void dumpRecords(
+            const std::vector<IoRecord> &records,
+            std::priority_queue<StatsData, std::vector<StatsData>, StatsdataCompare> *queue);
 
   public:
     IoUsage() : mDisabled(false) {}
-    void refresh(void);
-    void setOptions(const std::string &key, const std::string &value);
+    void refresh(void) override;
+    void setOptions(const std::string &key, const std::string &value) override;
+    void dump(std::priority_queue<StatsData, std::vector<StatsData>, StatsdataCompare> *queue)
+            override;
+    void setBufferSize(size_t size) override { mBuffer.setSize(size); }
+    void setBurst(bool enabled) override { mBurst = enabled; }
+    void setBurstBufferSize(size_t size) override { mBurstBuffer.setSize(size); }
 };
 
 }  // namespace perfstatsd
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _LATENCY_HISTOGRAM_H_
+#define _LATENCY_HISTOGRAM_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace android {
+namespace pixel {
+namespace perfstatsd {
+
+/*
+ * Fixed ABI of the published histogram page; bump kVersion on any layout
+ * change. An external profiling agent maps the page read-only (it is exported
+ * as a sealed memfd, reachable via /proc/<pid>/fd/<n>) and reads the counters
+ * racily; every field is a relaxed atomic, so readers see momentarily torn
+ * totals at worst, never corruption.
+ */
+struct LatencyHistogramPage {
+    static constexpr uint32_t kMagic = 0x50464c48;  // "PFLH"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kMaxSections = 16;
+    // Buckets are log2 of the duration in microseconds; the last bucket
+    // collects everything at or above 2^(kBuckets - 1) us (~262 ms).
+    static constexpr uint32_t kBuckets = 20;
+    static constexpr uint32_t kNameMax = 32;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t bucketCount;
+    // Sections below [0, sectionCount) are fully initialized; the count is
+    // published with release ordering after the name is written.
+    std::atomic<uint32_t> sectionCount;
+    struct Section {
+        char name[kNameMax];  // NUL-terminated
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sumUs;
+        std::atomic<uint64_t> buckets[kBuckets];
+    } sections[kMaxSections];
+};
+static_assert(sizeof(LatencyHistogramPage) <= 4096, "histogram page must fit one page");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "page counters must be lock-free");
+
+/*
+ * Always-on latency histograms for named code sections, backing ScopeTimer.
+ * Section registration is the only locked (cold) path; recording a sample is
+ * three relaxed atomic adds into the shared page - no syscall, no lock.
+ */
+class LatencyHistogramSet {
+  public:
+    static LatencyHistogramSet *getInstance();
+
+    // Returns a stable section id for name, registering it on first use.
+    // Returns -1 when the page is out of section slots.
+    int sectionId(const std::string &name);
+    // Records one sample; id -1 is ignored.
+    void record(int id, uint64_t durationUs);
+    // Appends a human-readable rendering of all sections, for dumps.
+    void dump(std::string *outAppend);
+
+  private:
+    LatencyHistogramSet();
+
+    LatencyHistogramPage *mPage;
+    std::mutex mRegisterLock;
+    std::unordered_map<std::string, int> mIds;  // guarded by mRegisterLock
+};
+
+}  // namespace perfstatsd
+}  // namespace pixel
+}  // namespace android
+
+#endif /* _LATENCY_HISTOGRAM_H_ */
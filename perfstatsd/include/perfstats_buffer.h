@@ -22,6 +22,7 @@
 #include <pthread.h>
 #include <time.h>
 
+#include <atomic>
 #include <chrono>
 #include <iomanip>
 #include <list>
@@ -60,18 +61,77 @@ class StatsData {
     std::string mData;
 };
 
-class PerfstatsBuffer {
+/*
+ * Lock-free history ring of typed binary records. The refresh thread is the
+ * only writer; it overwrites the oldest slot and never takes a lock or
+ * allocates, so a periodic sample costs a few cache-line writes. Dump
+ * threads copy records out under a per-slot sequence counter and drop any
+ * slot that was being overwritten mid-copy. Record must be trivially
+ * copyable since readers may observe (and then discard) torn slots.
+ */
+template <typename Record>
+class PerfstatsRing {
   public:
-    size_t size() { return mBufferSize; }
-    size_t count() { return mStorage.size(); }
+    size_t size() const { return mCapacity; }
+    size_t count() const { return std::min<uint64_t>(mHead.load(std::memory_order_acquire), mCapacity); }
+
+    // Must be called before the writer starts; not safe against concurrent
+    // emplace/snapshot.
+    void setSize(size_t size) {
+        mCapacity = size;
+        mSlots = std::make_unique<Slot[]>(size);
+        mHead.store(0, std::memory_order_relaxed);
+    }
 
-    void setSize(size_t size) { mBufferSize = size; }
-    void emplace(StatsData &&data);
-    const std::queue<StatsData> &dump(void);
+    // Writer side (refresh thread only).
+    void emplace(const Record &record) {
+        if (mCapacity == 0) {
+            return;
+        }
+        uint64_t head = mHead.load(std::memory_order_relaxed);
+        Slot &slot = mSlots[head % mCapacity];
+        slot.seq.store(slot.seq.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);  // odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.record = record;
+        slot.seq.store(slot.seq.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_release);  // even: stable
+        mHead.store(head + 1, std::memory_order_release);
+    }
+
+    // Reader side; returns stable records, oldest first.
+    std::vector<Record> snapshot() const {
+        std::vector<Record> records;
+        if (mCapacity == 0) {
+            return records;
+        }
+        uint64_t head = mHead.load(std::memory_order_acquire);
+        uint64_t depth = std::min<uint64_t>(head, mCapacity);
+        records.reserve(depth);
+        for (uint64_t i = head - depth; i < head; i++) {
+            const Slot &slot = mSlots[i % mCapacity];
+            uint32_t seq = slot.seq.load(std::memory_order_acquire);
+            if (seq & 1) {
+                continue;
+            }
+            Record record = slot.record;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != seq) {
+                continue;  // overwritten while copying
+            }
+            records.push_back(record);
+        }
+        return records;
+    }
 
   private:
-    size_t mBufferSize = 0U;
-    std::queue<StatsData> mStorage;
+    struct Slot {
+        std::atomic<uint32_t> seq{0};
+        Record record;
+    };
+    size_t mCapacity = 0U;
+    std::unique_ptr<Slot[]> mSlots;
+    std::atomic<uint64_t> mHead{0};  // next slot to write
 };
 
 struct StatsdataCompare {
@@ -17,12 +17,18 @@
 #ifndef _PERFSTATSD_H_
 #define _PERFSTATSD_H_
 
+#include <condition_variable>
+
 #include "cpu_usage.h"
 #include "io_usage.h"
 #include "statstype.h"
 
 #define DEFAULT_DATA_COLLECT_PERIOD (10)  // seconds
 #define PERFSTATSD_PERIOD "perfstatsd.period"
+#define BURST_DATA_COLLECT_PERIOD_MS (100)
+#define BURST_MAX_DURATION (30)  // seconds
+// Burst ring capacity: the longest allowed burst at the fast cadence.
+#define BURST_BUFFER_SIZE (BURST_MAX_DURATION * 1000 / BURST_DATA_COLLECT_PERIOD_MS)
 
 namespace android {
 namespace pixel {
@@ -32,13 +38,25 @@ class Perfstatsd : public RefBase {
   private:
     std::list<std::unique_ptr<StatsType>> mStats;
     uint32_t mRefreshPeriod;
+    // Burst profiling state, guarded by mBurstLock. The binder thread only
+    // requests or extends a burst; the refresh thread flips the stats types
+    // in pause() so their ring writers stay single-threaded.
+    std::mutex mBurstLock;
+    std::condition_variable mBurstCv;
+    std::chrono::steady_clock::time_point mBurstEnd;
+    bool mBurstRequested = false;
+    bool mBurstActive = false;
 
   public:
     Perfstatsd(void);
     void refresh(void);
-    void pause(void) { sleep(mRefreshPeriod); }
+    void pause(void);
     void getHistory(std::string *ret);
     void setOptions(const std::string &key, const std::string &value);
+    // Samples every BURST_DATA_COLLECT_PERIOD_MS for the given duration
+    // (capped at BURST_MAX_DURATION seconds), then returns to the regular
+    // cadence. Safe to call from binder threads.
+    void startBurst(uint32_t durationSeconds);
 };
 
 }  // namespace perfstatsd
@@ -33,7 +33,9 @@ class PerfstatsdPrivateService : public android::BinderService<PerfstatsdPrivate
     static char const *getServiceName() { return "perfstatsd_pri"; }
 
     android::binder::Status dumpHistory(std::string *_aidl_return);
+    android::binder::Status dumpHistoryFd(android::os::ParcelFileDescriptor *_aidl_return);
     android::binder::Status setOptions(const std::string &key, const std::string &value);
+    android::binder::Status startBurst(int32_t durationSeconds);
 };
 
 android::sp<IPerfstatsdPrivate> getPerfstatsdPrivateService();
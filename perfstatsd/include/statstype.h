@@ -23,41 +23,28 @@ namespace android {
 namespace pixel {
 namespace perfstatsd {
 
+/*
+ * Each stats type owns a PerfstatsRing of its own binary record type and
+ * formats records into StatsData text only when dump() runs, so the
+ * periodic refresh path never builds strings nobody reads.
+ */
 class StatsType : public RefBase {
   public:
     virtual void refresh() = 0;
     virtual void setOptions(const std::string &, const std::string &) = 0;
-    void dump(std::priority_queue<StatsData, std::vector<StatsData>, StatsdataCompare> *queue) {
-        std::unique_lock<std::mutex> mlock(mMutex);
-        std::queue<StatsData> buffer = mBuffer.dump();
-        while (!buffer.empty()) {
-            queue->push(buffer.front());
-            buffer.pop();
-        }
-    }
-    size_t bufferSize() { return mBuffer.size(); }
-    void setBufferSize(size_t size) { mBuffer.setSize(size); }
-    size_t bufferCount() { return mBuffer.count(); }
-
-  protected:
-    void append(StatsData &&data) {
-        std::unique_lock<std::mutex> mlock(mMutex);
-        mBuffer.emplace(std::forward<StatsData>(data));
-    }
-    void append(std::chrono::system_clock::time_point &time, std::string &content) {
-        StatsData data;
-        data.setTime(time);
-        data.setData(content);
-        append(std::move(data));
-    }
-    void append(std::string &content) {
-        std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
-        append(now, content);
-    }
-
-  private:
-    PerfstatsBuffer mBuffer;
-    std::mutex mMutex;
+    // Formats the buffered records and pushes one StatsData per record.
+    // Runs on the dump thread, concurrently with refresh().
+    virtual void dump(
+            std::priority_queue<StatsData, std::vector<StatsData>, StatsdataCompare> *queue) = 0;
+    // Must be called before the refresh thread starts.
+    virtual void setBufferSize(size_t size) = 0;
+    // Burst mode routes refresh() samples into a dedicated preallocated
+    // ring so a high-frequency capture cannot evict the regular history.
+    // Called from the refresh thread only, so the ring writers stay
+    // single-threaded.
+    virtual void setBurst(bool enabled) = 0;
+    // Must be called before the refresh thread starts.
+    virtual void setBurstBufferSize(size_t size) = 0;
 };
 
 }  // namespace perfstatsd
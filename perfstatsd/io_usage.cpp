@@ -17,12 +17,18 @@
 #define LOG_TAG "perfstatsd_io"
 
 #include "io_usage.h"
+#include <android-base/mapped_file.h>
 #include <android-base/parseint.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
+#include <android-base/unique_fd.h>
 #include <cutils/android_filesystem_config.h>
+#include <fcntl.h>
 #include <inttypes.h>
 #include <pwd.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
 
 using namespace android::pixel::perfstatsd;
 static constexpr const char *UID_IO_STATS_PATH = "/proc/uid_io/stats";
@@ -164,28 +170,121 @@ bool ProcPidIoStats::getNameForUid(uint32_t uid, std::string *name) {
     return false;
 }
 
-void IoStats::updateTopRead(UserIo usage) {
-    UserIo tmp;
-    for (int i = 0, len = IO_TOP_MAX; i < len; i++) {
-        if (usage.sumRead() > mReadTop[i].sumRead()) {
-            // if new read > old read, then swap values
-            tmp = mReadTop[i];
-            mReadTop[i] = usage;
-            usage = tmp;
+static constexpr const char *PACKAGES_LIST_PATH = "/data/system/packages.list";
+
+void PackageUidNameCache::reloadIfNeeded() {
+    struct stat st;
+    if (stat(PACKAGES_LIST_PATH, &st) != 0) {
+        // Not readable (early boot, or access denied): keep whatever we
+        // have; callers fall back to the /proc walk.
+        return;
+    }
+    if (st.st_mtim.tv_sec == mMtime.tv_sec && st.st_mtim.tv_nsec == mMtime.tv_nsec) {
+        return;
+    }
+
+    ScopeTimer _debugTimer("reload packages.list UID/Name cache");
+    _debugTimer.setEnabled(sOptDebug);
+
+    mUidNames.clear();
+    mMtime = st.st_mtim;
+    if (st.st_size == 0) {
+        return;
+    }
+
+    android::base::unique_fd fd(TEMP_FAILURE_RETRY(open(PACKAGES_LIST_PATH, O_RDONLY | O_CLOEXEC)));
+    if (fd.get() < 0) {
+        return;
+    }
+    auto file = android::base::MappedFile::FromFd(fd, 0, st.st_size, PROT_READ);
+    if (!file) {
+        return;
+    }
+
+    // Each line is "<package-name> <uid> ...". Shared uids list several
+    // packages; the first one seen stands in for all of them.
+    const char *p = file->data();
+    const char *end = p + file->size();
+    while (p < end) {
+        const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        if (eol == nullptr) {
+            eol = end;
+        }
+        const char *sp = static_cast<const char *>(memchr(p, ' ', eol - p));
+        if (sp != nullptr && sp > p && sp + 1 < eol && isdigit(sp[1])) {
+            uint32_t uid = 0;
+            const char *q = sp + 1;
+            while (q < eol && isdigit(*q)) {
+                uid = uid * 10 + (*q++ - '0');
+            }
+            mUidNames.emplace(uid, std::string(p, sp - p));
         }
+        p = eol + 1;
+    }
+}
+
+bool PackageUidNameCache::getNameForUid(uint32_t uid, std::string *name) {
+    reloadIfNeeded();
+    const auto it = mUidNames.find(uid);
+    if (it == mUidNames.end()) {
+        return false;
     }
+    *name = it->second;
+    return true;
 }
 
-void IoStats::updateTopWrite(UserIo usage) {
-    UserIo tmp;
-    for (int i = 0, len = IO_TOP_MAX; i < len; i++) {
-        if (usage.sumWrite() > mWriteTop[i].sumWrite()) {
-            // if new write > old write, then swap values
-            tmp = mWriteTop[i];
-            mWriteTop[i] = usage;
-            usage = tmp;
+void IoTopK::push(const UserIo &usage, uint64_t key) {
+    if (key == 0) {
+        return;
+    }
+    uint32_t idx;
+    if (mCount < IO_TOP_MAX) {
+        // Sift the new entry up.
+        idx = mCount++;
+        mHeap[idx] = {key, usage};
+        while (idx > 0) {
+            uint32_t parent = (idx - 1) / 2;
+            if (mHeap[parent].key <= mHeap[idx].key) {
+                break;
+            }
+            std::swap(mHeap[parent], mHeap[idx]);
+            idx = parent;
+        }
+        return;
+    }
+    if (key <= mHeap[0].key) {
+        return;  // common case: below the current top-K minimum
+    }
+    // Replace the minimum and sift it down.
+    mHeap[0] = {key, usage};
+    idx = 0;
+    while (true) {
+        uint32_t smallest = idx;
+        uint32_t left = 2 * idx + 1;
+        uint32_t right = 2 * idx + 2;
+        if (left < mCount && mHeap[left].key < mHeap[smallest].key) {
+            smallest = left;
+        }
+        if (right < mCount && mHeap[right].key < mHeap[smallest].key) {
+            smallest = right;
         }
+        if (smallest == idx) {
+            break;
+        }
+        std::swap(mHeap[idx], mHeap[smallest]);
+        idx = smallest;
+    }
+}
+
+uint32_t IoTopK::copySorted(UserIo *out) const {
+    Item sorted[IO_TOP_MAX];
+    std::copy(mHeap, mHeap + mCount, sorted);
+    std::sort(sorted, sorted + mCount,
+              [](const Item &a, const Item &b) { return a.key > b.key; });
+    for (uint32_t i = 0; i < mCount; i++) {
+        out[i] = sorted[i].usage;
     }
+    return mCount;
 }
 
 void IoStats::updateUnknownUidList() {
@@ -194,34 +293,47 @@ void IoStats::updateUnknownUidList() {
     }
     ScopeTimer _debugTimer("update overall UID/Name");
     _debugTimer.setEnabled(sOptDebug);
-    mProcIoStats.update(false);
-    for (uint32_t i = 0, len = mUnknownUidList.size(); i < len; i++) {
-        uint32_t uid = mUnknownUidList[i];
+
+    // Resolve without touching /proc first: the packages.list cache covers
+    // app uids, getpwuid covers system/native uids.
+    std::vector<uint32_t> unresolved;
+    std::vector<uint32_t> needProcScan;
+    for (uint32_t uid : mUnknownUidList) {
         if (isAppUid(uid)) {
-            // Get IO throughput for App processes
             std::string pname;
-            if (!mProcIoStats.getNameForUid(uid, &pname)) {
-                if (sOptDebug)
-                    LOG(WARNING) << "unable to find App uid:" << uid;
-                continue;
+            if (mPackageCache.getNameForUid(uid, &pname)) {
+                mUidNameMap[uid] = pname;
+            } else {
+                needProcScan.push_back(uid);
             }
-            mUidNameMap[uid] = pname;
         } else {
-            // Get IO throughput for system/native processes
             passwd *usrpwd = getpwuid(uid);
-            if (!usrpwd) {
+            if (usrpwd) {
+                mUidNameMap[uid] = std::string(usrpwd->pw_name);
+            } else {
                 if (sOptDebug)
                     LOG(WARNING) << "unable to find uid:" << uid << " by getpwuid";
-                continue;
+                unresolved.push_back(uid);
             }
-            mUidNameMap[uid] = std::string(usrpwd->pw_name);
-            if (std::find(mUnknownUidList.begin(), mUnknownUidList.end(), uid) !=
-                mUnknownUidList.end()) {
+        }
+    }
+
+    // Only app uids the package list does not know (isolated uids, or the
+    // list being unreadable) pay for the /proc walk.
+    if (needProcScan.size()) {
+        mProcIoStats.update(false);
+        for (uint32_t uid : needProcScan) {
+            std::string pname;
+            if (mProcIoStats.getNameForUid(uid, &pname)) {
+                mUidNameMap[uid] = pname;
+            } else {
+                if (sOptDebug)
+                    LOG(WARNING) << "unable to find App uid:" << uid;
+                unresolved.push_back(uid);
             }
         }
-        mUnknownUidList.erase(std::remove(mUnknownUidList.begin(), mUnknownUidList.end(), uid),
-                              mUnknownUidList.end());
     }
+    mUnknownUidList = std::move(unresolved);
 
     if (sOptDebug && mUnknownUidList.size() > 0) {
         std::stringstream msg;
@@ -278,95 +390,62 @@ void IoStats::calcAll(std::unordered_map<uint32_t, UserIo> &&data) {
     mPrevious = std::move(data);
     // Reset Total and Tops
     mTotal.reset();
-    for (int i = 0, len = IO_TOP_MAX; i < len; i++) {
-        mReadTop[i].reset();
-        mWriteTop[i].reset();
-    }
+    mReadTop.reset();
+    mWriteTop.reset();
     for (const auto &it : amounts) {
         const UserIo &d = it.second;
         // Add into total
         mTotal = mTotal + d;
         // Check if it's top
-        updateTopRead(d);
-        updateTopWrite(d);
+        mReadTop.push(d, d.sumRead());
+        mWriteTop.push(d, d.sumWrite());
     }
 }
 
-/* Dump IO usage (Sample Log)
- *
- * [IO_TOTAL: 10.160s] RD:371,703,808 WR:15,929,344 fsync:567
- * [TOP Usage ]    fg bytes,    bg bytes,fgsyn,bgsyn :  UID   NAME
- * [R1: 33.99%]           0,    73240576,    0,  240 : 10016 .android.gms.ui
- * [R2: 28.34%]    16039936,    45027328,    1,   21 : 10082 -
- * [R3: 16.54%]    11243520,    24395776,    0,   25 : 10055 -
- * [R4: 10.93%]    22241280,     1318912,    0,    1 : 10123 oid.apps.photos
- * [R5: 10.19%]    21528576,      421888,   23,   20 : 10061 android.vending
- * [W1: 58.19%]           0,     7655424,    0,  240 : 10016 .android.gms.ui
- * [W2: 17.03%]     1265664,      974848,   38,   45 : 10069 -
- * [W3: 11.30%]     1486848,           0,   58,    0 :  1000 system
- * [W4:  8.13%]      667648,      401408,   23,   20 : 10061 android.vending
- * [W5:  5.35%]           0,      704512,    0,   25 : 10055 -
- *
+/*
+ * Snapshots the totals and tops of the last calcAll() into a binary record.
+ * Names are resolved here because the uid/name maps are owned by the
+ * refresh thread; the text itself is produced at dump time.
  */
-bool IoStats::dump(std::stringstream *output) {
-    std::stringstream &out = (*output);
-
+void IoStats::fill(IoRecord *record) {
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(mNow - mLast);
-    char readTotal[32];
-    char writeTotal[32];
-    if (!formatNum(mTotal.sumRead(), readTotal, 32)) {
-        LOG(ERROR) << "formatNum buffer size is too small for read: " << mTotal.sumRead();
-    }
-    if (!formatNum(mTotal.sumWrite(), writeTotal, 32)) {
-        LOG(ERROR) << "formatNum buffer size is too small for write: " << mTotal.sumWrite();
-    }
 
-    out << android::base::StringPrintf(FMT_STR_TOTAL_USAGE, ms.count() / 1000, ms.count() % 1000,
-                                       readTotal, writeTotal, mTotal.fgFsync + mTotal.bgFsync);
+    record->time = mNow;
+    record->periodMs = ms.count();
+    record->totalRead = mTotal.sumRead();
+    record->totalWrite = mTotal.sumWrite();
+    record->totalFsync = mTotal.fgFsync + mTotal.bgFsync;
+    record->minRead = mMinSizeOfTotalRead;
+    record->minWrite = mMinSizeOfTotalWrite;
 
-    if (mTotal.sumRead() >= mMinSizeOfTotalRead || mTotal.sumWrite() >= mMinSizeOfTotalWrite) {
-        out << STR_TOP_HEADER;
-    }
-    // Dump READ TOP
-    if (mTotal.sumRead() < mMinSizeOfTotalRead) {
-        out << android::base::StringPrintf(FMT_STR_SKIP_TOP_READ, mMinSizeOfTotalRead / 1000000)
-            << std::endl;
-    } else {
-        for (int i = 0, len = IO_TOP_MAX; i < len; i++) {
-            UserIo &target = mReadTop[i];
-            if (target.sumRead() == 0) {
-                break;
-            }
-            float percent = 100.0f * target.sumRead() / mTotal.sumRead();
-            const char *package = mUidNameMap.find(target.uid) == mUidNameMap.end()
-                                      ? "-"
-                                      : mUidNameMap[target.uid].c_str();
-            out << android::base::StringPrintf(FMT_STR_TOP_READ_USAGE, i + 1, percent,
-                                               target.fgRead, target.bgRead, target.fgFsync,
-                                               target.bgFsync, target.uid, package);
-        }
+    UserIo tops[IO_TOP_MAX];
+    record->readCount = mReadTop.copySorted(tops);
+    for (uint32_t i = 0; i < record->readCount; i++) {
+        const UserIo &target = tops[i];
+        IoRecord::Entry &entry = record->readTop[i];
+        entry.uid = target.uid;
+        entry.fgBytes = target.fgRead;
+        entry.bgBytes = target.bgRead;
+        entry.fgFsync = target.fgFsync;
+        entry.bgFsync = target.bgFsync;
+        const char *package =
+            mUidNameMap.find(target.uid) == mUidNameMap.end() ? "-" : mUidNameMap[target.uid].c_str();
+        strlcpy(entry.name, package, IO_USAGE_NAME_MAX);
     }
 
-    // Dump WRITE TOP
-    if (mTotal.sumWrite() < mMinSizeOfTotalWrite) {
-        out << android::base::StringPrintf(FMT_STR_SKIP_TOP_WRITE, mMinSizeOfTotalWrite / 1000000)
-            << std::endl;
-    } else {
-        for (int i = 0, len = IO_TOP_MAX; i < len; i++) {
-            UserIo &target = mWriteTop[i];
-            if (target.sumWrite() == 0) {
-                break;
-            }
-            float percent = 100.0f * target.sumWrite() / mTotal.sumWrite();
-            const char *package = mUidNameMap.find(target.uid) == mUidNameMap.end()
-                                      ? "-"
-                                      : mUidNameMap[target.uid].c_str();
-            out << android::base::StringPrintf(FMT_STR_TOP_WRITE_USAGE, i + 1, percent,
-                                               target.fgWrite, target.bgWrite, target.fgFsync,
-                                               target.bgFsync, target.uid, package);
-        }
+    record->writeCount = mWriteTop.copySorted(tops);
+    for (uint32_t i = 0; i < record->writeCount; i++) {
+        const UserIo &target = tops[i];
+        IoRecord::Entry &entry = record->writeTop[i];
+        entry.uid = target.uid;
+        entry.fgBytes = target.fgWrite;
+        entry.bgBytes = target.bgWrite;
+        entry.fgFsync = target.fgFsync;
+        entry.bgFsync = target.bgFsync;
+        const char *package =
+            mUidNameMap.find(target.uid) == mUidNameMap.end() ? "-" : mUidNameMap[target.uid].c_str();
+        strlcpy(entry.name, package, IO_USAGE_NAME_MAX);
     }
-    return true;
 }
 
 static bool loadDataFromLine(std::string &&line, UserIo &data) {
@@ -451,12 +530,94 @@ void IoUsage::refresh(void) {
         datas[data.uid] = data;
     }
     mStats.calcAll(std::move(datas));
-    std::stringstream out;
-    mStats.dump(&out);
-    const std::string &str = out.str();
+    IoRecord record = {};
+    mStats.fill(&record);
     if (sOptDebug) {
-        LOG(INFO) << str;
-        LOG(INFO) << "output append length:" << str.length();
+        LOG(INFO) << "record bytes:" << sizeof(record);
+    }
+    (mBurst ? mBurstBuffer : mBuffer).emplace(record);
+}
+
+/* Dump IO usage (Sample Log)
+ *
+ * [IO_TOTAL: 10.160s] RD:371,703,808 WR:15,929,344 fsync:567
+ * [TOP Usage ]    fg bytes,    bg bytes,fgsyn,bgsyn :  UID   NAME
+ * [R1: 33.99%]           0,    73240576,    0,  240 : 10016 .android.gms.ui
+ * [R2: 28.34%]    16039936,    45027328,    1,   21 : 10082 -
+ * [R3: 16.54%]    11243520,    24395776,    0,   25 : 10055 -
+ * [R4: 10.93%]    22241280,     1318912,    0,    1 : 10123 oid.apps.photos
+ * [R5: 10.19%]    21528576,      421888,   23,   20 : 10061 android.vending
+ * [W1: 58.19%]           0,     7655424,    0,  240 : 10016 .android.gms.ui
+ * [W2: 17.03%]     1265664,      974848,   38,   45 : 10069 -
+ * [W3: 11.30%]     1486848,           0,   58,    0 :  1000 system
+ * [W4:  8.13%]      667648,      401408,   23,   20 : 10061 android.vending
+ * [W5:  5.35%]           0,      704512,    0,   25 : 10055 -
+ *
+ */
+void IoUsage::dump(
+    std::priority_queue<StatsData, std::vector<StatsData>, StatsdataCompare> *queue) {
+    // Burst records carry their own timestamps, so the merged queue
+    // interleaves them with the regular history in time order.
+    dumpRecords(mBuffer.snapshot(), queue);
+    dumpRecords(mBurstBuffer.snapshot(), queue);
+}
+
+void IoUsage::dumpRecords(
+    const std::vector<IoRecord> &records,
+    std::priority_queue<StatsData, std::vector<StatsData>, StatsdataCompare> *queue) {
+    for (const IoRecord &record : records) {
+        std::stringstream out;
+
+        char readTotal[32];
+        char writeTotal[32];
+        if (!formatNum(record.totalRead, readTotal, 32)) {
+            LOG(ERROR) << "formatNum buffer size is too small for read: " << record.totalRead;
+        }
+        if (!formatNum(record.totalWrite, writeTotal, 32)) {
+            LOG(ERROR) << "formatNum buffer size is too small for write: " << record.totalWrite;
+        }
+
+        out << android::base::StringPrintf(FMT_STR_TOTAL_USAGE,
+                                           (long long)(record.periodMs / 1000),
+                                           (long long)(record.periodMs % 1000), readTotal,
+                                           writeTotal, record.totalFsync);
+
+        if (record.totalRead >= record.minRead || record.totalWrite >= record.minWrite) {
+            out << STR_TOP_HEADER;
+        }
+        // Dump READ TOP
+        if (record.totalRead < record.minRead) {
+            out << android::base::StringPrintf(FMT_STR_SKIP_TOP_READ, record.minRead / 1000000)
+                << std::endl;
+        } else {
+            for (uint32_t i = 0; i < record.readCount; i++) {
+                const IoRecord::Entry &entry = record.readTop[i];
+                float percent = 100.0f * (entry.fgBytes + entry.bgBytes) / record.totalRead;
+                out << android::base::StringPrintf(FMT_STR_TOP_READ_USAGE, (int)(i + 1), percent,
+                                                   entry.fgBytes, entry.bgBytes, entry.fgFsync,
+                                                   entry.bgFsync, entry.uid, entry.name);
+            }
+        }
+
+        // Dump WRITE TOP
+        if (record.totalWrite < record.minWrite) {
+            out << android::base::StringPrintf(FMT_STR_SKIP_TOP_WRITE, record.minWrite / 1000000)
+                << std::endl;
+        } else {
+            for (uint32_t i = 0; i < record.writeCount; i++) {
+                const IoRecord::Entry &entry = record.writeTop[i];
+                float percent = 100.0f * (entry.fgBytes + entry.bgBytes) / record.totalWrite;
+                out << android::base::StringPrintf(FMT_STR_TOP_WRITE_USAGE, (int)(i + 1), percent,
+                                                   entry.fgBytes, entry.bgBytes, entry.fgFsync,
+                                                   entry.bgFsync, entry.uid, entry.name);
+            }
+        }
+
+        StatsData data;
+        std::chrono::system_clock::time_point time = record.time;
+        data.setTime(time);
+        std::string str = out.str();
+        data.setData(str);
+        queue->push(data);
     }
-    append((std::string &)str);
 }
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "perfstatsd_hist"
+
+#include "latency_histogram.h"
+
+#include <android-base/logging.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <new>
+
+namespace android {
+namespace pixel {
+namespace perfstatsd {
+
+LatencyHistogramSet *LatencyHistogramSet::getInstance() {
+    // Deliberately leaked; the page must outlive any exiting thread.
+    static LatencyHistogramSet *instance = new LatencyHistogramSet();
+    return instance;
+}
+
+LatencyHistogramSet::LatencyHistogramSet() {
+    void *map = MAP_FAILED;
+    int fd = memfd_create("perfstatsd_latency", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd >= 0 && ftruncate(fd, sizeof(LatencyHistogramPage)) == 0) {
+        map = mmap(nullptr, sizeof(LatencyHistogramPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                   0);
+    }
+    if (map != MAP_FAILED) {
+        // Seal the size so a read-only mapper cannot be truncated under.
+        if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) != 0)
+            PLOG(WARNING) << "Failed to seal latency histogram page";
+        // The fd is kept open for the process lifetime; an agent maps it
+        // read-only through /proc/<pid>/fd/<n>.
+        LOG(INFO) << "latency histograms at /proc/" << getpid() << "/fd/" << fd;
+    } else {
+        PLOG(WARNING) << "Failed to create shared latency histogram page, keeping it private";
+        if (fd >= 0)
+            close(fd);
+        map = mmap(nullptr, sizeof(LatencyHistogramPage), PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        CHECK(map != MAP_FAILED);
+    }
+
+    mPage = new (map) LatencyHistogramPage();
+    mPage->magic = LatencyHistogramPage::kMagic;
+    mPage->version = LatencyHistogramPage::kVersion;
+    mPage->bucketCount = LatencyHistogramPage::kBuckets;
+}
+
+int LatencyHistogramSet::sectionId(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mRegisterLock);
+    auto itr = mIds.find(name);
+    if (itr != mIds.end())
+        return itr->second;
+
+    uint32_t id = mPage->sectionCount.load(std::memory_order_relaxed);
+    if (id >= LatencyHistogramPage::kMaxSections) {
+        LOG(WARNING) << "latency histogram page full, dropping section " << name;
+        return -1;
+    }
+    strlcpy(mPage->sections[id].name, name.c_str(), LatencyHistogramPage::kNameMax);
+    // Publish the section only after its name is in place.
+    mPage->sectionCount.store(id + 1, std::memory_order_release);
+    mIds.emplace(name, id);
+    return id;
+}
+
+void LatencyHistogramSet::record(int id, uint64_t durationUs) {
+    if (id < 0)
+        return;
+    uint32_t bucket = durationUs == 0 ? 0 : 63 - __builtin_clzll(durationUs);
+    if (bucket >= LatencyHistogramPage::kBuckets)
+        bucket = LatencyHistogramPage::kBuckets - 1;
+    LatencyHistogramPage::Section &section = mPage->sections[id];
+    section.count.fetch_add(1, std::memory_order_relaxed);
+    section.sumUs.fetch_add(durationUs, std::memory_order_relaxed);
+    section.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void LatencyHistogramSet::dump(std::string *outAppend) {
+    uint32_t sections = mPage->sectionCount.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < sections; i++) {
+        const LatencyHistogramPage::Section &section = mPage->sections[i];
+        uint64_t count = section.count.load(std::memory_order_relaxed);
+        uint64_t sumUs = section.sumUs.load(std::memory_order_relaxed);
+        outAppend->append(section.name);
+        outAppend->append(": n=");
+        outAppend->append(std::to_string(count));
+        outAppend->append(" avg=");
+        outAppend->append(std::to_string(count ? sumUs / count : 0));
+        outAppend->append("us");
+        for (uint32_t b = 0; b < LatencyHistogramPage::kBuckets; b++) {
+            uint64_t samples = section.buckets[b].load(std::memory_order_relaxed);
+            if (samples == 0)
+                continue;
+            outAppend->append(" [2^");
+            outAppend->append(std::to_string(b));
+            outAppend->append("us]=");
+            outAppend->append(std::to_string(samples));
+        }
+        outAppend->append("\n");
+    }
+}
+
+}  // namespace perfstatsd
+}  // namespace pixel
+}  // namespace android
@@ -16,10 +16,13 @@
 
 #define LOG_TAG "perfstatsd"
 
+#include <android-base/file.h>
+#include <android-base/unique_fd.h>
 #include <perfstatsd.h>
 #include <perfstatsd_service.h>
+#include <unistd.h>
 
-enum MODE { DUMP_HISTORY, SET_OPTION };
+enum MODE { DUMP_HISTORY, SET_OPTION, BURST_PROFILE };
 
 android::sp<Perfstatsd> perfstatsdSp;
 
@@ -36,11 +39,12 @@ void *perfstatsdMain(void *) {
 
 void help(char **argv) {
     std::string usage = argv[0];
-    usage = "Usage: " + usage + " [-s][-d][-o]\n" +
+    usage = "Usage: " + usage + " [-s][-d][-o][-b]\n" +
             "Options:\n"
             "    -s, start as service\n"
             "    -d, dump perf stats history for dumpstate_board\n"
-            "    -o, set key/value option";
+            "    -o, set key/value option\n"
+            "    -b, burst profile: collect high-frequency samples for N seconds";
 
     fprintf(stderr, "%s\n", usage.c_str());
 }
@@ -83,6 +87,21 @@ int serviceCall(int mode, const std::string &key, const std::string &value) {
         case DUMP_HISTORY: {
             std::string history;
             LOG(INFO) << "dump perfstats history.";
+            // Prefer the memfd-based dump: the history bypasses the binder
+            // transaction buffer, so large dumps cannot hit
+            // TRANSACTION_TOO_LARGE.
+            android::os::ParcelFileDescriptor historyFd;
+            if (perfstatsdPrivateService->dumpHistoryFd(&historyFd).isOk()) {
+                android::base::unique_fd fd(historyFd.release());
+                // The passed fd shares the service's file offset; rewind
+                // before reading.
+                if (fd.ok() && lseek(fd.get(), 0, SEEK_SET) == 0 &&
+                    android::base::ReadFdToString(fd, &history) && !history.empty()) {
+                    fprintf(stdout, "%s\n", history.c_str());
+                    break;
+                }
+            }
+            // Fall back to the string-returning call (older service).
             if (!perfstatsdPrivateService->dumpHistory(&history).isOk() || history.empty()) {
                 PLOG(ERROR) << "perf stats history is not available";
                 fprintf(stdout, "perf stats history is not available\n");
@@ -102,6 +121,20 @@ int serviceCall(int mode, const std::string &key, const std::string &value) {
                 return -1;
             }
             break;
+        case BURST_PROFILE: {
+            uint32_t seconds = 0;
+            if (!android::base::ParseUint(key, &seconds) || seconds < 1) {
+                fprintf(stdout, "invalid burst duration: %s\n", key.c_str());
+                return -1;
+            }
+            LOG(INFO) << "start burst profiling for " << seconds << " seconds";
+            if (!perfstatsdPrivateService->startBurst(static_cast<int32_t>(seconds)).isOk()) {
+                PLOG(ERROR) << "fail to start burst profiling";
+                fprintf(stdout, "fail to start burst profiling\n");
+                return -1;
+            }
+            break;
+        }
     }
     return 0;
 }
@@ -115,12 +148,17 @@ int main(int argc, char **argv) {
     android::base::InitLogging(argv, android::base::LogdLogger(android::base::SYSTEM));
 
     int c;
-    while ((c = getopt(argc, argv, "sdo:h")) != -1) {
+    while ((c = getopt(argc, argv, "sdo:b:h")) != -1) {
         switch (c) {
             case 's':
                 return startService();
             case 'd':
                 return serviceCall(DUMP_HISTORY);
+            case 'b': {
+                std::string duration(optarg);
+                std::string empty("");
+                return serviceCall(BURST_PROFILE, std::move(duration), std::move(empty));
+            }
             case 'o':
                 // set options
                 if (argc == 4) {
@@ -17,6 +17,7 @@
 #define LOG_TAG "perfstatsd"
 
 #include <perfstatsd.h>
+#include <pixelscheduler/WakeupScheduler.h>
 
 using namespace android::pixel::perfstatsd;
 
@@ -25,13 +26,68 @@ Perfstatsd::Perfstatsd(void) {
 
     std::unique_ptr<StatsType> cpuUsage(new CpuUsage);
     cpuUsage->setBufferSize(CPU_USAGE_BUFFER_SIZE);
+    cpuUsage->setBurstBufferSize(BURST_BUFFER_SIZE);
     mStats.emplace_back(std::move(cpuUsage));
 
     std::unique_ptr<StatsType> ioUsage(new IoUsage);
     ioUsage->setBufferSize(IO_USAGE_BUFFER_SIZE);
+    ioUsage->setBurstBufferSize(BURST_BUFFER_SIZE);
     mStats.emplace_back(std::move(ioUsage));
 }
 
+void Perfstatsd::pause(void) {
+    std::unique_lock<std::mutex> lock(mBurstLock);
+    if (mBurstActive) {
+        if (std::chrono::steady_clock::now() < mBurstEnd) {
+            lock.unlock();
+            std::this_thread::sleep_for(
+                std::chrono::milliseconds(BURST_DATA_COLLECT_PERIOD_MS));
+            return;
+        }
+        mBurstActive = false;
+        for (auto const &stats : mStats) {
+            stats->setBurst(false);
+        }
+        LOG(INFO) << "burst profiling finished; back to " << mRefreshPeriod << "s cadence";
+    }
+    // Wait until the next boottime-aligned grid point for our period instead
+    // of a free-running interval, so the refresh wake coalesces with other
+    // pixel daemons (e.g. pixelstats) sharing the libpixelscheduler grid.
+    // The condition variable runs on the monotonic clock, so the first wake
+    // after a suspend simply re-aligns to the grid.
+    using ::android::hardware::google::pixel::WakeupScheduler;
+    int64_t now = WakeupScheduler::bootNow();
+    int64_t wait_sec = WakeupScheduler::nextAlignedDeadline(mRefreshPeriod, now) - now;
+    mBurstCv.wait_for(lock, std::chrono::seconds(wait_sec), [this] { return mBurstRequested; });
+    if (mBurstRequested) {
+        mBurstRequested = false;
+        mBurstActive = true;
+        for (auto const &stats : mStats) {
+            stats->setBurst(true);
+        }
+        LOG(INFO) << "burst profiling started at " << BURST_DATA_COLLECT_PERIOD_MS << "ms cadence";
+    }
+}
+
+void Perfstatsd::startBurst(uint32_t durationSeconds) {
+    uint32_t capped = std::min(durationSeconds, static_cast<uint32_t>(BURST_MAX_DURATION));
+    if (capped < 1) {
+        LOG(ERROR) << "Invalid value. Minimum burst duration is 1 second";
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mBurstLock);
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(capped);
+    if (!mBurstActive || end > mBurstEnd) {
+        mBurstEnd = end;
+    }
+    if (!mBurstActive) {
+        mBurstRequested = true;
+        mBurstCv.notify_one();
+    }
+    LOG(INFO) << "burst profiling requested for " << capped << " seconds";
+}
+
 void Perfstatsd::refresh(void) {
     for (auto const &stats : mStats) {
         stats->refresh();
@@ -14,10 +14,15 @@
  * limitations under the License.
  */
 
+#include <android-base/file.h>
+#include <android-base/unique_fd.h>
 #include <binder/IBinder.h>
 #include <binder/IServiceManager.h>
+#include <fcntl.h>
+#include <linux/memfd.h>
 #include <perfstatsd.h>
 #include <perfstatsd_service.h>
+#include <sys/mman.h>
 
 android::status_t PerfstatsdPrivateService::start() {
     return BinderService<PerfstatsdPrivateService>::publish();
@@ -28,6 +33,30 @@ android::binder::Status PerfstatsdPrivateService::dumpHistory(std::string *_aidl
     return android::binder::Status::ok();
 }
 
+android::binder::Status PerfstatsdPrivateService::dumpHistoryFd(
+        android::os::ParcelFileDescriptor *_aidl_return) {
+    std::string history;
+    perfstatsdSp->getHistory(&history);
+
+    // The dump travels as a sealed memfd rather than through the binder
+    // transaction buffer, so its size is not capped by the transaction limit.
+    android::base::unique_fd fd(
+            memfd_create("perfstatsd_history", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+    if (fd.get() < 0) {
+        return android::binder::Status::fromServiceSpecificError(errno);
+    }
+    if (!android::base::WriteFully(fd, history.data(), history.size())) {
+        return android::binder::Status::fromServiceSpecificError(errno);
+    }
+    // Seal the region so the client can consume it without racing any
+    // further writes.
+    if (fcntl(fd.get(), F_ADD_SEALS, F_SEAL_GROW | F_SEAL_SHRINK | F_SEAL_WRITE) < 0) {
+        return android::binder::Status::fromServiceSpecificError(errno);
+    }
+    *_aidl_return = android::os::ParcelFileDescriptor(std::move(fd));
+    return android::binder::Status::ok();
+}
+
 android::binder::Status PerfstatsdPrivateService::setOptions(const std::string &key,
                                                              const std::string &value) {
     perfstatsdSp->setOptions(std::forward<const std::string>(key),
@@ -35,6 +64,15 @@ android::binder::Status PerfstatsdPrivateService::setOptions(const std::string &
     return android::binder::Status::ok();
 }
 
+android::binder::Status PerfstatsdPrivateService::startBurst(int32_t durationSeconds) {
+    if (durationSeconds < 1) {
+        return android::binder::Status::fromExceptionCode(
+            android::binder::Status::EX_ILLEGAL_ARGUMENT);
+    }
+    perfstatsdSp->startBurst(static_cast<uint32_t>(durationSeconds));
+    return android::binder::Status::ok();
+}
+
 android::sp<IPerfstatsdPrivate> getPerfstatsdPrivateService() {
     android::sp<android::IServiceManager> sm = android::defaultServiceManager();
     if (sm == NULL)
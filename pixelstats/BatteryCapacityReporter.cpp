@@ -16,12 +16,16 @@
 
 #define LOG_TAG "pixelstats-uevent: BatteryCapacityFG"
 
+#include <fcntl.h>
 #include <log/log.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
 #include <utils/Timers.h>
 #include <cmath>
 
 #include <android-base/file.h>
+#include <android-base/unique_fd.h>
 
 #include <pixelstats/BatteryCapacityReporter.h>
 #include <pixelstats/StatsHelper.h>
@@ -36,7 +40,6 @@ namespace pixel {
 using aidl::android::frameworks::stats::IStats;
 using aidl::android::frameworks::stats::VendorAtom;
 using aidl::android::frameworks::stats::VendorAtomValue;
-using android::base::ReadFileToString;
 using android::hardware::google::pixel::PixelAtoms::BatteryCapacityFG;
 
 #define ONE_HOUR_SECS (60 * 60)
@@ -60,7 +63,28 @@ BatteryCapacityReporter::BatteryCapacityReporter() {
 
 void BatteryCapacityReporter::checkAndReport(const std::shared_ptr<IStats> &stats_client,
                                              const std::string &path) {
-    if (parse(path)) {
+    char buf[kMaxSsocDetailsSize];
+
+    ::android::base::unique_fd fd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (!fd.ok()) {
+        ALOGE("Unable to open ssoc_details path: %s - %s", path.c_str(), strerror(errno));
+        return;
+    }
+
+    const ssize_t len = pread(fd.get(), buf, sizeof(buf) - 1, 0);
+    if (len < 0) {
+        ALOGE("Unable to read ssoc_details path: %s - %s", path.c_str(), strerror(errno));
+        return;
+    }
+    buf[len] = '\0';
+
+    /* Unchanged raw contents cannot produce a new log event; skip all work. */
+    if (len == last_raw_len_ && memcmp(buf, last_raw_, len) == 0)
+        return;
+    memcpy(last_raw_, buf, len + 1);
+    last_raw_len_ = len;
+
+    if (parse(buf, path)) {
         if (checkLogEvent()) {
             reportEvent(stats_client);
         }
@@ -71,24 +95,17 @@ int64_t BatteryCapacityReporter::getTimeSecs(void) {
     return nanoseconds_to_seconds(systemTime(SYSTEM_TIME_BOOTTIME));
 }
 
-bool BatteryCapacityReporter::parse(const std::string &path) {
-    std::string batterySSOCContents;
-    if (!ReadFileToString(path, &batterySSOCContents)) {
-        ALOGE("Unable to read ssoc_details path: %s - %s", path.c_str(), strerror(errno));
-        return false;
-    }
-
+bool BatteryCapacityReporter::parse(const char *buf, const std::string &path) {
     // Parse file. Example format:
     // soc: l=97% gdf=97.72 uic=97.72 rl=97.72
     // curve:[15.00 15.00][97.87 97.87][100.00 100.00]
     // status: ct=1 rl=0 s=1
-    if (sscanf(batterySSOCContents.c_str(),
+    if (sscanf(buf,
                "soc: %*s gdf=%f %*s rl=%f\n"
                "curve:[%*f %*f][%f %f][%*f %*f]\n"
                "status: %*s %*s s=%d",
                &gdf_, &ssoc_, &gdf_curve_, &ssoc_curve_, &status_) != 5) {
-        ALOGE("Unable to parse ssoc_details [%s] from file %s to int.", batterySSOCContents.c_str(),
-              path.c_str());
+        ALOGE("Unable to parse ssoc_details [%s] from file %s to int.", buf, path.c_str());
         return false;
     }
 
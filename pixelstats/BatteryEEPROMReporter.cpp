@@ -40,6 +40,11 @@ using android::hardware::google::pixel::PixelAtoms::BatteryEEPROM;
 #define LINESIZE_V2 31
 #define LINESIZE_MAX17201_HIST 80
 
+/* Snapshot of the history contents as of the last upload; needs sepolicy
+ * access to the pixelstats vendor data directory. */
+static constexpr char kHistorySnapshotPath[] =
+        "/data/vendor/pixelstats/battery_history_snapshot";
+
 BatteryEEPROMReporter::BatteryEEPROMReporter() {}
 
 static bool fileExists(const std::string &path) {
@@ -48,6 +53,20 @@ static bool fileExists(const std::string &path) {
     return stat(path.c_str(), &sb) == 0;
 }
 
+void BatteryEEPROMReporter::loadHistorySnapshot() {
+    snapshot_loaded_ = true;
+    if (!ReadFileToString(kHistorySnapshotPath, &last_reported_history_)) {
+        /* First boot cycle or wiped data: report everything once. */
+        last_reported_history_.clear();
+    }
+}
+
+void BatteryEEPROMReporter::saveHistorySnapshot(const std::string &contents) {
+    last_reported_history_ = contents;
+    if (!android::base::WriteStringToFile(contents, kHistorySnapshotPath))
+        ALOGE("Unable to write %s - %s", kHistorySnapshotPath, strerror(errno));
+}
+
 void BatteryEEPROMReporter::checkAndReport(const std::shared_ptr<IStats> &stats_client,
                                            const std::string &path) {
     std::string file_contents;
@@ -66,6 +85,25 @@ void BatteryEEPROMReporter::checkAndReport(const std::shared_ptr<IStats> &stats_
         return;
     }
 
+    if (!snapshot_loaded_)
+        loadHistorySnapshot();
+
+    if (file_contents == last_reported_history_) {
+        ALOGD("Battery history unchanged since last report");
+        return;
+    }
+
+    /* True when the entry bytes differ from the snapshot taken at the last
+     * upload; unchanged entries were already reported. */
+    auto entryChanged = [this, &file_contents](size_t offset, size_t len) {
+        if (offset + len > file_contents.size())
+            len = file_contents.size() - offset;
+        if (offset + len > last_reported_history_.size())
+            return true;
+        return memcmp(file_contents.data() + offset, last_reported_history_.data() + offset,
+                      len) != 0;
+    };
+
     int16_t i, num;
     struct BatteryHistory hist;
     const int kHistTotalLen = file_contents.size();
@@ -78,6 +116,8 @@ void BatteryEEPROMReporter::checkAndReport(const std::shared_ptr<IStats> &stats_
             size_t history_offset = i * LINESIZE_V2;
             if (history_offset > file_contents.size())
                 break;
+            if (!entryChanged(history_offset, LINESIZE_V2))
+                continue;
             history_each = file_contents.substr(history_offset, LINESIZE_V2);
             unsigned int data[4];
 
@@ -131,12 +171,15 @@ void BatteryEEPROMReporter::checkAndReport(const std::shared_ptr<IStats> &stats_
             reportEvent(stats_client, hist);
             report_time_ = getTimeSecs();
         }
+        saveHistorySnapshot(file_contents);
         return;
     }
 
     for (i = 0; i < (LINESIZE * BATT_HIST_NUM_MAX); i = i + LINESIZE) {
         if (i + LINESIZE > kHistTotalLen)
             break;
+        if (!entryChanged(i, LINESIZE))
+            continue;
         history_each = file_contents.substr(i, LINESIZE);
         num = sscanf(history_each.c_str(),
                    "%4" SCNx16 "%4" SCNx16 "%4" SCNx16 "%4" SCNx16
@@ -162,6 +205,7 @@ void BatteryEEPROMReporter::checkAndReport(const std::shared_ptr<IStats> &stats_
             report_time_ = getTimeSecs();
         }
     }
+    saveHistorySnapshot(file_contents);
 }
 
 int64_t BatteryEEPROMReporter::getTimeSecs(void) {
@@ -16,6 +16,7 @@
 
 #define LOG_TAG "pixelstats: BatteryFGReporter"
 
+#include <ctype.h>
 #include <log/log.h>
 #include <time.h>
 #include <utils/Timers.h>
@@ -24,6 +25,7 @@
 
 #include <android-base/file.h>
 #include <pixelstats/BatteryFGReporter.h>
+#include <pixelstats/StatsHelper.h>
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
 
 namespace android {
@@ -140,14 +142,56 @@ void BatteryFGReporter::reportEvent(const std::shared_ptr<IStats> &stats_client,
         ALOGE("Unable to report BatteryEEPROM to Stats service");
 }
 
+/*
+ * A learning history record is ten "tt:vvvv" hex groups: a two-digit register
+ * tag followed by a four-digit value. The field table below maps the groups,
+ * in record order, onto BatteryFGLearningParam, so each record is decoded in
+ * a single pass over the line rather than a 20-conversion sscanf.
+ */
+bool BatteryFGReporter::parseFGLearningLine(std::string_view line,
+                                            struct BatteryFGLearningParam *params) {
+    static constexpr uint16_t BatteryFGLearningParam::*kFieldTable[] = {
+            &BatteryFGLearningParam::fcnom,  &BatteryFGLearningParam::dpacc,
+            &BatteryFGLearningParam::dqacc,  &BatteryFGLearningParam::fcrep,
+            &BatteryFGLearningParam::repsoc, &BatteryFGLearningParam::msoc,
+            &BatteryFGLearningParam::vfsoc,  &BatteryFGLearningParam::fstat,
+            &BatteryFGLearningParam::rcomp0, &BatteryFGLearningParam::tempco};
+    const char *p = line.data();
+    const char *end = p + line.size();
+
+    for (const auto field : kFieldTable) {
+        uint16_t value = 0;
+        int digits;
+
+        while (p < end && isspace(*p))
+            p++;
+
+        /* two-digit register tag, discarded like the old %*2x */
+        for (digits = 0; digits < 2 && p < end && isxdigit(*p); digits++)
+            p++;
+        if (digits != 2 || p == end || *p != ':')
+            return false;
+        p++;
+
+        /* up to four value digits, matching the old %4x conversion */
+        for (digits = 0; digits < 4 && p < end && isxdigit(*p); digits++, p++) {
+            char c = *p;
+            value = (value << 4) | (c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+        }
+        if (digits == 0)
+            return false;
+
+        params->*field = value;
+    }
+
+    return true;
+}
+
 void BatteryFGReporter::checkAndReportFGLearning(const std::shared_ptr<IStats> &stats_client,
                                                  const std::vector<std::string> &paths) {
     struct BatteryFGLearningParam params;
-    std::string file_contents, line, path;
-    std::istringstream ss;
-    int16_t num;
-    const char* data;
-    int pos = 0;
+    std::string file_contents, path;
+    std::string_view remaining, line;
 
     if (paths.empty())
         return;
@@ -173,17 +217,9 @@ void BatteryFGReporter::checkAndReportFGLearning(const std::shared_ptr<IStats> &
 
     /* LH: Learning History */
     params.type = EvtFGLearningParams;
-    ss.str(file_contents);
-    while (std::getline(ss, line)) {
-        data = line.c_str();
-        num = sscanf(&data[pos], "%*2" SCNx16 ":%4" SCNx16 "%*2" SCNx16 ":%4" SCNx16
-                    "%*2" SCNx16 ":%4" SCNx16 "%*2" SCNx16 ":%4" SCNx16 "%*2" SCNx16 ":%4" SCNx16
-                    "%*2" SCNx16 ":%4" SCNx16 "%*2" SCNx16 ":%4" SCNx16 "%*2" SCNx16 ":%4" SCNx16
-                    "%*2" SCNx16 ":%4" SCNx16 "%*2" SCNx16 ":%4" SCNx16 "\n",
-                    &params.fcnom, &params.dpacc, &params.dqacc, &params.fcrep, &params.repsoc,
-                    &params.msoc, &params.vfsoc, &params.fstat, &params.rcomp0, &params.tempco);
-
-        if (num != kNumFGLearningFields)
+    remaining = file_contents;
+    while (getNextLine(&remaining, &line)) {
+        if (!parseFGLearningLine(line, &params))
             continue;
 
         if (old_learn_params[0] != params.fcnom || old_learn_params[1] != params.dpacc ||
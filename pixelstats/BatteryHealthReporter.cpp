@@ -34,7 +34,6 @@ namespace pixel {
 using aidl::android::frameworks::stats::IStats;
 using aidl::android::frameworks::stats::VendorAtom;
 using aidl::android::frameworks::stats::VendorAtomValue;
-using android::base::ReadFileToString;
 using android::base::WriteStringToFile;
 using android::hardware::google::pixel::PixelAtoms::BatteryHealthStatus;
 using android::hardware::google::pixel::PixelAtoms::BatteryHealthUsage;
@@ -52,7 +51,7 @@ bool BatteryHealthReporter::reportBatteryHealthStatus(const std::shared_ptr<ISta
     std::string file_contents, line;
     std::istringstream ss;
 
-    if (!ReadFileToString(path.c_str(), &file_contents)) {
+    if (!readSysfsCached(path, &file_contents)) {
         ALOGD("Unsupported path %s - %s", path.c_str(), strerror(errno));
         return false;
     }
@@ -118,7 +117,7 @@ bool BatteryHealthReporter::reportBatteryHealthUsage(const std::shared_ptr<IStat
     std::string file_contents, line;
     std::istringstream ss;
 
-    if (!ReadFileToString(path.c_str(), &file_contents)) {
+    if (!readSysfsCached(path, &file_contents)) {
         ALOGD("Unsupported path %s - %s", path.c_str(), strerror(errno));
         return false;
     }
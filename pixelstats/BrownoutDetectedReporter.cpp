@@ -22,14 +22,24 @@
 #include <android-base/properties.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
+#include <android-base/unique_fd.h>
 #include <android/binder_manager.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
+#include <limits.h>
 #include <pixelstats/BrownoutDetectedReporter.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
 #include <utils/Log.h>
 
 #include <map>
-#include <regex>
+#include <string_view>
+#include <vector>
 
 namespace android {
 namespace hardware {
@@ -39,25 +49,121 @@ namespace pixel {
 using aidl::android::frameworks::stats::IStats;
 using aidl::android::frameworks::stats::VendorAtom;
 using aidl::android::frameworks::stats::VendorAtomValue;
-using android::base::ReadFileToString;
 using android::hardware::google::pixel::PixelAtoms::BrownoutDetected;
 
-#define READING_IDX 2
-#define KEY_IDX 0
 #define DEFAULT_BATTERY_TEMP 9999999
 #define DEFAULT_BATTERY_SOC 100
 #define DEFAULT_BATTERY_VOLT 5000000
 #define ONE_SECOND_IN_US 1000000
 
-const std::regex kTimestampPattern("^\\S+\\s[0-9]+:[0-9]+:[0-9]+\\S+$");
-const std::regex kIrqPattern("^(\\S+)\\striggered\\sat\\s\\S+$");
-const std::regex kOdpmPattern("^CH\\d+\\[(\\S+)\\],\\s(\\d+)$");
-const std::regex kDvfsPattern("^([A-Z1-9]+):(\\d+)$");
-const std::regex kFgPattern("^(voltage_now):(\\d+)$");
-const std::regex kBatteryTempPattern("^(battery):(\\d+)$");
-const std::regex kBatteryCyclePattern("^(battery_cycle):(\\d+)$");
-const std::regex kBatterySocPattern("^(soc):(\\d+)$");
-const std::regex kAlreadyUpdatedPattern("^(LASTMEAL_UPDATED)$");
+constexpr char kAlreadyUpdatedMarker[] = "LASTMEAL_UPDATED";
+
+/*
+ * Hand-rolled matchers for the fixed-format mitigation log lines. These
+ * replace the per-line std::regex passes, which dominated the reporter's
+ * cost on large logs after brownout storms.
+ */
+
+// ^\d+$ into *value.
+static bool parseUintField(std::string_view field, int *value) {
+    if (field.empty())
+        return false;
+    long parsed = 0;
+    for (char c : field) {
+        if (!isdigit(static_cast<unsigned char>(c)))
+            return false;
+        parsed = parsed * 10 + (c - '0');
+        if (parsed > INT_MAX)
+            return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+// atoi equivalent for a non-terminated field (CSV cells).
+static int parseIntField(std::string_view field) {
+    size_t idx = 0;
+    bool negative = false;
+    if (!field.empty() && (field[0] == '-' || field[0] == '+')) {
+        negative = field[0] == '-';
+        idx = 1;
+    }
+    long parsed = 0;
+    for (; idx < field.size() && isdigit(static_cast<unsigned char>(field[idx])); idx++)
+        parsed = parsed * 10 + (field[idx] - '0');
+    return negative ? -parsed : parsed;
+}
+
+// ^<key>:(\d+)$
+static bool matchKeyValue(std::string_view line, std::string_view key, int *value) {
+    if (line.size() <= key.size() + 1 || line.substr(0, key.size()) != key ||
+        line[key.size()] != ':')
+        return false;
+    return parseUintField(line.substr(key.size() + 1), value);
+}
+
+// ^[A-Z1-9]+:(\d+)$
+static bool matchDvfs(std::string_view line, int *value) {
+    size_t colon = line.find(':');
+    if (colon == std::string_view::npos || colon == 0)
+        return false;
+    for (char c : line.substr(0, colon)) {
+        if (!isupper(static_cast<unsigned char>(c)) && !(c >= '1' && c <= '9'))
+            return false;
+    }
+    return parseUintField(line.substr(colon + 1), value);
+}
+
+// ^CH\d+\[\S+\],\s(\d+)$
+static bool matchOdpm(std::string_view line, int *value) {
+    if (line.size() < 3 || line.substr(0, 2) != "CH")
+        return false;
+    size_t idx = 2;
+    while (idx < line.size() && isdigit(static_cast<unsigned char>(line[idx])))
+        idx++;
+    if (idx == 2 || idx >= line.size() || line[idx] != '[')
+        return false;
+    size_t close = line.find("], ", idx);
+    if (close == std::string_view::npos)
+        return false;
+    std::string_view channel = line.substr(idx + 1, close - idx - 1);
+    if (channel.empty() || channel.find(' ') != std::string_view::npos)
+        return false;
+    return parseUintField(line.substr(close + 3), value);
+}
+
+// ^(\S+)\striggered\sat\s\S+$, *irq gets the first group.
+static bool matchIrq(std::string_view line, std::string_view *irq) {
+    constexpr std::string_view kTriggeredAt = " triggered at ";
+    size_t pos = line.find(kTriggeredAt);
+    if (pos == std::string_view::npos || pos == 0)
+        return false;
+    *irq = line.substr(0, pos);
+    if (irq->find(' ') != std::string_view::npos)
+        return false;
+    std::string_view rest = line.substr(pos + kTriggeredAt.size());
+    return !rest.empty() && rest.find(' ') == std::string_view::npos;
+}
+
+// ^\S+\s[0-9]+:[0-9]+:[0-9]+\S+$
+static bool matchTimestamp(std::string_view line) {
+    size_t space = line.find(' ');
+    if (space == std::string_view::npos || space == 0 || space + 1 >= line.size())
+        return false;
+    std::string_view rest = line.substr(space + 1);
+    if (rest.find(' ') != std::string_view::npos)
+        return false;
+    for (int group = 0; group < 2; group++) {
+        size_t digits = 0;
+        while (digits < rest.size() && isdigit(static_cast<unsigned char>(rest[digits])))
+            digits++;
+        if (digits == 0 || digits >= rest.size() || rest[digits] != ':')
+            return false;
+        rest = rest.substr(digits + 1);
+    }
+    // Third digit group plus at least one trailing non-space character.
+    return rest.size() >= 2 && isdigit(static_cast<unsigned char>(rest[0]));
+}
 
 const std::map<std::string, int> kBrownoutReason = {{"uvlo,pmic,if", BrownoutDetected::UVLO_IF},
                                                     {"ocp,pmic,if", BrownoutDetected::OCP_IF},
@@ -89,27 +195,47 @@ const std::map<std::string, int> kBrownoutReason = {{"uvlo,pmic,if", BrownoutDet
                                                     {"ocp,buckcs", BrownoutDetected::OCP_BCS},
                                                     {"ocp,buckds", BrownoutDetected::OCP_BDS}};
 
-bool BrownoutDetectedReporter::updateIfFound(std::string line, std::regex pattern,
-                                             int *current_value, Update flag) {
-    bool found = false;
-    std::smatch pattern_match;
-    if (std::regex_match(line, pattern_match, pattern)) {
-        if (pattern_match.size() < (READING_IDX + 1)) {
-            return found;
+static void updateValue(int reading, int *current_value, Update flag) {
+    if (flag == kUpdateMax) {
+        if (*current_value < reading) {
+            *current_value = reading;
         }
-        found = true;
-        int reading = std::stoi(pattern_match[READING_IDX].str());
-        if (flag == kUpdateMax) {
-            if (*current_value < reading) {
-                *current_value = reading;
-            }
-        } else {
-            if (*current_value > reading) {
-                *current_value = reading;
-            }
+    } else {
+        if (*current_value > reading) {
+            *current_value = reading;
         }
     }
-    return found;
+}
+
+/*
+ * Maps the log read-only for in-place scanning. Returns false when the file
+ * is missing/empty or when the first line is already the reported marker, in
+ * which case the check costs one small pread instead of reading the file.
+ */
+static bool mapLogFile(const std::string &path, android::base::unique_fd *fd, const char **data,
+                       size_t *size) {
+    fd->reset(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (*fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(*fd, &st) < 0 || st.st_size == 0)
+        return false;
+
+    // The marker is the persisted high-water mark: everything in a marked
+    // log has been uploaded already.
+    char marker[sizeof(kAlreadyUpdatedMarker) - 1];
+    if (pread(*fd, marker, sizeof(marker), 0) == static_cast<ssize_t>(sizeof(marker)) &&
+        memcmp(marker, kAlreadyUpdatedMarker, sizeof(marker)) == 0)
+        return false;
+
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, *fd, 0);
+    if (map == MAP_FAILED) {
+        ALOGE("Unable to map %s - %s", path.c_str(), strerror(errno));
+        return false;
+    }
+    *data = static_cast<const char *>(map);
+    *size = st.st_size;
+    return true;
 }
 
 void BrownoutDetectedReporter::setAtomFieldValue(std::vector<VendorAtomValue> *values, int offset,
@@ -232,8 +358,7 @@ int BrownoutDetectedReporter::brownoutReasonCheck(const std::string &brownoutRea
     return key->second;
 }
 
-int parseIRQ(const std::string &element) {
-    int idx = atoi(element.c_str());
+static int parseIRQ(int idx) {
     if (idx == SMPL_WARN) {
         return BrownoutDetected::SMPL_WARN;
     } else if (idx == UVLO1) {
@@ -251,125 +376,135 @@ int parseIRQ(const std::string &element) {
 void BrownoutDetectedReporter::logBrownoutCsv(const std::shared_ptr<IStats> &stats_client,
                                               const std::string &CsvFilePath,
                                               const std::string &brownoutReasonProp) {
-    std::string csvFile;
-    if (!android::base::ReadFileToString(CsvFilePath, &csvFile)) {
-        return;
-    }
-    std::istringstream content(csvFile);
-    std::string line;
     struct BrownoutDetectedInfo max_value = {};
     max_value.voltage_now_ = DEFAULT_BATTERY_VOLT;
     max_value.battery_soc_ = DEFAULT_BATTERY_SOC;
     max_value.battery_temp_ = DEFAULT_BATTERY_TEMP;
-    std::smatch pattern_match;
     max_value.brownout_reason_ = brownoutReasonCheck(brownoutReasonProp);
     if (max_value.brownout_reason_ < 0) {
         return;
     }
-    bool isAlreadyUpdated = false;
-    std::vector<std::vector<std::string>> rows;
+    ::android::base::unique_fd fd;
+    const char *data;
+    size_t size;
+    if (!mapLogFile(CsvFilePath, &fd, &data, &size)) {
+        return;
+    }
     int row_num = 0;
-    while (std::getline(content, line)) {
-        if (std::regex_match(line, pattern_match, kAlreadyUpdatedPattern)) {
-            isAlreadyUpdated = true;
-            break;
-        }
+    std::string_view remaining(data, size);
+    while (!remaining.empty()) {
+        size_t eol = remaining.find('\n');
+        std::string_view line = remaining.substr(0, eol);
+        remaining = eol == std::string_view::npos ? std::string_view()
+                                                  : remaining.substr(eol + 1);
         row_num++;
         if (row_num == 1) {
+            // Header row.
             continue;
         }
-        std::vector<std::string> row;
-        std::stringstream ss(line);
-        std::string field;
-        while (getline(ss, field, ',')) {
-            row.push_back(field);
+        std::vector<std::string_view> row;
+        std::string_view rest = line;
+        while (true) {
+            size_t comma = rest.find(',');
+            row.push_back(rest.substr(0, comma));
+            if (comma == std::string_view::npos)
+                break;
+            rest = rest.substr(comma + 1);
+        }
+        if (row.size() < ODPM_CHANNEL_0 + ODPM_MAX_IDX) {
+            continue;
         }
 
-        max_value.triggered_timestamp_ = parseTimestamp(row[TIMESTAMP_IDX].c_str());
-        max_value.triggered_irq_ = parseIRQ(row[IRQ_IDX]);
-        max_value.battery_soc_ = atoi(row[SOC_IDX].c_str());
-        max_value.battery_temp_ = atoi(row[TEMP_IDX].c_str());
-        max_value.battery_cycle_ = atoi(row[CYCLE_IDX].c_str());
-        max_value.voltage_now_ = atoi(row[VOLTAGE_IDX].c_str());
+        max_value.triggered_timestamp_ = parseTimestamp(std::string(row[TIMESTAMP_IDX]));
+        max_value.triggered_irq_ = parseIRQ(parseIntField(row[IRQ_IDX]));
+        max_value.battery_soc_ = parseIntField(row[SOC_IDX]);
+        max_value.battery_temp_ = parseIntField(row[TEMP_IDX]);
+        max_value.battery_cycle_ = parseIntField(row[CYCLE_IDX]);
+        max_value.voltage_now_ = parseIntField(row[VOLTAGE_IDX]);
         for (int i = 0; i < DVFS_MAX_IDX; i++) {
-            max_value.dvfs_value_[i] = atoi(row[i + DVFS_CHANNEL_0].c_str());
+            max_value.dvfs_value_[i] = parseIntField(row[i + DVFS_CHANNEL_0]);
         }
         for (int i = 0; i < ODPM_MAX_IDX; i++) {
-            max_value.odpm_value_[i] = atoi(row[i + ODPM_CHANNEL_0].c_str());
+            max_value.odpm_value_[i] = parseIntField(row[i + ODPM_CHANNEL_0]);
         }
     }
-    if (!isAlreadyUpdated && max_value.battery_temp_ != DEFAULT_BATTERY_TEMP) {
-        std::string file_content = "LASTMEAL_UPDATED\n" + csvFile;
+    if (max_value.battery_temp_ != DEFAULT_BATTERY_TEMP) {
+        std::string file_content =
+                std::string(kAlreadyUpdatedMarker) + "\n" + std::string(data, size);
+        munmap(const_cast<char *>(data), size);
         android::base::WriteStringToFile(file_content, CsvFilePath);
         uploadData(stats_client, max_value);
+    } else {
+        munmap(const_cast<char *>(data), size);
     }
 }
 
 void BrownoutDetectedReporter::logBrownout(const std::shared_ptr<IStats> &stats_client,
                                            const std::string &logFilePath,
                                            const std::string &brownoutReasonProp) {
-    std::string logFile;
-    if (!android::base::ReadFileToString(logFilePath, &logFile)) {
-        return;
-    }
-    std::istringstream content(logFile);
-    std::string line;
     struct BrownoutDetectedInfo max_value = {};
     max_value.voltage_now_ = DEFAULT_BATTERY_VOLT;
     max_value.battery_soc_ = DEFAULT_BATTERY_SOC;
     max_value.battery_temp_ = DEFAULT_BATTERY_TEMP;
-    std::smatch pattern_match;
-    int odpm_index = 0, dvfs_index = 0;
+    int odpm_index = 0, dvfs_index = 0, reading;
     max_value.brownout_reason_ = brownoutReasonCheck(brownoutReasonProp);
     if (max_value.brownout_reason_ < 0) {
         return;
     }
-    bool isAlreadyUpdated = false;
-    while (std::getline(content, line)) {
-        if (std::regex_match(line, pattern_match, kAlreadyUpdatedPattern)) {
-            isAlreadyUpdated = true;
-            break;
-        }
-        if (std::regex_match(line, pattern_match, kIrqPattern)) {
-            if (pattern_match.size() < (KEY_IDX + 1)) {
-                return;
-            }
-            std::ssub_match irq = pattern_match[KEY_IDX];
-            if (irq.str().find("batoilo") != std::string::npos) {
+    ::android::base::unique_fd fd;
+    const char *data;
+    size_t size;
+    if (!mapLogFile(logFilePath, &fd, &data, &size)) {
+        return;
+    }
+    std::string_view remaining(data, size);
+    while (!remaining.empty()) {
+        size_t eol = remaining.find('\n');
+        std::string_view line = remaining.substr(0, eol);
+        remaining = eol == std::string_view::npos ? std::string_view()
+                                                  : remaining.substr(eol + 1);
+        std::string_view irq;
+        if (matchIrq(line, &irq)) {
+            if (irq.find("batoilo") != std::string_view::npos) {
                 max_value.triggered_irq_ = BrownoutDetected::BATOILO;
                 continue;
             }
-            if (irq.str().find("vdroop1") != std::string::npos) {
+            if (irq.find("vdroop1") != std::string_view::npos) {
                 max_value.triggered_irq_ = BrownoutDetected::UVLO1;
                 continue;
             }
-            if (irq.str().find("vdroop2") != std::string::npos) {
+            if (irq.find("vdroop2") != std::string_view::npos) {
                 max_value.triggered_irq_ = BrownoutDetected::UVLO2;
                 continue;
             }
-            if (irq.str().find("smpl_gm") != std::string::npos) {
+            if (irq.find("smpl_gm") != std::string_view::npos) {
                 max_value.triggered_irq_ = BrownoutDetected::SMPL_WARN;
                 continue;
             }
             continue;
         }
-        if (std::regex_match(line, pattern_match, kTimestampPattern)) {
-            max_value.triggered_timestamp_ = parseTimestamp(line.c_str());
+        if (matchTimestamp(line)) {
+            max_value.triggered_timestamp_ = parseTimestamp(std::string(line));
             continue;
         }
-        if (updateIfFound(line, kBatterySocPattern, &max_value.battery_soc_, kUpdateMin)) {
+        if (matchKeyValue(line, "soc", &reading)) {
+            updateValue(reading, &max_value.battery_soc_, kUpdateMin);
             continue;
         }
-        if (updateIfFound(line, kBatteryTempPattern, &max_value.battery_temp_, kUpdateMin)) {
+        if (matchKeyValue(line, "battery", &reading)) {
+            updateValue(reading, &max_value.battery_temp_, kUpdateMin);
             continue;
         }
-        if (updateIfFound(line, kBatteryCyclePattern, &max_value.battery_cycle_, kUpdateMax)) {
+        if (matchKeyValue(line, "battery_cycle", &reading)) {
+            updateValue(reading, &max_value.battery_cycle_, kUpdateMax);
             continue;
         }
-        if (updateIfFound(line, kFgPattern, &max_value.voltage_now_, kUpdateMin)) {
+        if (matchKeyValue(line, "voltage_now", &reading)) {
+            updateValue(reading, &max_value.voltage_now_, kUpdateMin);
             continue;
         }
-        if (updateIfFound(line, kDvfsPattern, &max_value.dvfs_value_[dvfs_index], kUpdateMax)) {
+        if (matchDvfs(line, &reading)) {
+            updateValue(reading, &max_value.dvfs_value_[dvfs_index], kUpdateMax);
             dvfs_index++;
             // Discarding previous value and update with new DVFS value
             if (dvfs_index == DVFS_MAX_IDX) {
@@ -377,7 +512,8 @@ void BrownoutDetectedReporter::logBrownout(const std::shared_ptr<IStats> &stats_
             }
             continue;
         }
-        if (updateIfFound(line, kOdpmPattern, &max_value.odpm_value_[odpm_index], kUpdateMax)) {
+        if (matchOdpm(line, &reading)) {
+            updateValue(reading, &max_value.odpm_value_[odpm_index], kUpdateMax);
             odpm_index++;
             // Discarding previous value and update with new ODPM value
             if (odpm_index == ODPM_MAX_IDX) {
@@ -386,10 +522,14 @@ void BrownoutDetectedReporter::logBrownout(const std::shared_ptr<IStats> &stats_
             continue;
         }
     }
-    if (!isAlreadyUpdated && max_value.battery_temp_ != DEFAULT_BATTERY_TEMP) {
-        std::string file_content = "LASTMEAL_UPDATED\n" + logFile;
+    if (max_value.battery_temp_ != DEFAULT_BATTERY_TEMP) {
+        std::string file_content =
+                std::string(kAlreadyUpdatedMarker) + "\n" + std::string(data, size);
+        munmap(const_cast<char *>(data), size);
         android::base::WriteStringToFile(file_content, logFilePath);
         uploadData(stats_client, max_value);
+    } else {
+        munmap(const_cast<char *>(data), size);
     }
 }
 
@@ -17,6 +17,8 @@
 #define LOG_TAG "pixelstats-uevent: ChargeStatsReporter"
 
 #include <android-base/file.h>
+#include <android-base/unique_fd.h>
+#include <fcntl.h>
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
 #include <log/log.h>
 #include <pixelstats/ChargeStatsReporter.h>
@@ -231,6 +233,26 @@ bool ChargeStatsReporter::shouldReportEvent(void) {
     return false;
 }
 
+/**
+ * The charger appends a session to the stats node when charging ends, and the
+ * node is acked by writing "0", which also makes it read back as "0" until the
+ * next session. Peeking at the first bytes is much cheaper than reading and
+ * splitting the whole node, and most checks find nothing to report. An open
+ * failure reports as "new session" so the full path logs the error as before.
+ */
+bool ChargeStatsReporter::hasNewSession(const std::string &path) {
+    char head[2];
+    android::base::unique_fd fd(TEMP_FAILURE_RETRY(open(path.c_str(), O_RDONLY | O_CLOEXEC)));
+    if (fd < 0) {
+        return true;
+    }
+    ssize_t len = TEMP_FAILURE_RETRY(read(fd.get(), head, sizeof(head)));
+    if (len <= 0) {
+        return false;
+    }
+    return !(head[0] == '0' && (len == 1 || head[1] == '\n'));
+}
+
 void ChargeStatsReporter::checkAndReport(const std::shared_ptr<IStats> &stats_client,
                                          const std::string &path) {
     std::string file_contents, line, wfile_contents, wline_at, wline_ac, pca_file_contents,
@@ -238,6 +260,10 @@ void ChargeStatsReporter::checkAndReport(const std::shared_ptr<IStats> &stats_cl
     std::istringstream ss;
     bool has_wireless, has_pca, has_thermal, has_gcharger, has_dual_batt;
 
+    if (!hasNewSession(path)) {
+        return;
+    }
+
     if (!ReadFileToString(path.c_str(), &file_contents)) {
         ALOGE("Unable to read %s - %s", path.c_str(), strerror(errno));
         return;
@@ -315,6 +341,10 @@ void ChargeStatsReporter::checkAndReport(const std::shared_ptr<IStats> &stats_cl
 }
 
 bool ChargeStatsReporter::checkContentsAndAck(std::string *file_contents, const std::string &path) {
+    if (!hasNewSession(path)) {
+        return false;
+    }
+
     if (!ReadFileToString(path.c_str(), file_contents)) {
         return false;
     }
@@ -25,6 +25,8 @@
 #include <android/binder_manager.h>
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
 #include <pixelstats/DisplayStatsReporter.h>
+#include <string.h>
+#include <sys/stat.h>
 #include <utils/Log.h>
 
 #include <cinttypes>
@@ -38,9 +40,61 @@ using aidl::android::frameworks::stats::IStats;
 using aidl::android::frameworks::stats::VendorAtom;
 using aidl::android::frameworks::stats::VendorAtomValue;
 using android::base::ReadFileToString;
+using android::base::WriteStringToFile;
 using android::hardware::google::pixel::PixelAtoms::DisplayPanelErrorStats;
 
-DisplayStatsReporter::DisplayStatsReporter() {}
+static constexpr uint32_t kStateMagic = 0x44535052; /* "DSPR" */
+static constexpr uint32_t kStateVersion = 1;
+
+DisplayStatsReporter::DisplayStatsReporter() {
+    loadPersistedState();
+}
+
+void DisplayStatsReporter::loadPersistedState() {
+    std::string boot_id;
+    if (!ReadFileToString("/proc/sys/kernel/random/boot_id", &boot_id)) {
+        ALOGE("Unable to read boot id - %s; display stats state not persisted", strerror(errno));
+        return;
+    }
+    boot_id_ = android::base::Trim(boot_id);
+    if (boot_id_.size() != sizeof(PersistedState::boot_id)) {
+        boot_id_.clear();
+        return;
+    }
+
+    std::string contents;
+    if (!ReadFileToString(kStatePath, &contents) || contents.size() != sizeof(PersistedState))
+        return;
+
+    PersistedState state;
+    memcpy(&state, contents.data(), sizeof(state));
+    if (state.magic != kStateMagic || state.version != kStateVersion ||
+        memcmp(state.boot_id, boot_id_.data(), sizeof(state.boot_id)) != 0)
+        return;
+
+    prev_panel_data_ = state.panel;
+    memcpy(prev_dp_data_, state.dp, sizeof(prev_dp_data_));
+    memcpy(prev_hdcp_data_, state.hdcp, sizeof(prev_hdcp_data_));
+    ALOGI("Resumed display stats baselines from %s", kStatePath);
+}
+
+void DisplayStatsReporter::persistState() {
+    if (boot_id_.size() != sizeof(PersistedState::boot_id))
+        return;
+
+    PersistedState state = {};
+    state.magic = kStateMagic;
+    state.version = kStateVersion;
+    memcpy(state.boot_id, boot_id_.data(), sizeof(state.boot_id));
+    state.panel = prev_panel_data_;
+    memcpy(state.dp, prev_dp_data_, sizeof(state.dp));
+    memcpy(state.hdcp, prev_hdcp_data_, sizeof(state.hdcp));
+
+    mkdir(kStateDir, 0770);
+    if (!WriteStringToFile(std::string(reinterpret_cast<const char *>(&state), sizeof(state)),
+                           kStatePath))
+        ALOGE("Unable to persist display stats state - %s", strerror(errno));
+}
 
 bool DisplayStatsReporter::readDisplayErrorCount(const std::string &path, int64_t *val) {
     std::string file_contents;
@@ -335,7 +389,9 @@ void DisplayStatsReporter::logDisplayStats(const std::shared_ptr<IStats> &stats_
             break;
         default:
             ALOGE("Unsupport display state type(%d)", stats_type);
+            return;
     }
+    persistState();
 }
 
 }  // namespace pixel
@@ -25,6 +25,7 @@
 
 #include <inttypes.h>
 #include <math.h>
+#include <stdlib.h>
 
 using aidl::android::frameworks::stats::IStats;
 using aidl::android::frameworks::stats::VendorAtom;
@@ -95,7 +96,42 @@ sp<DropDetect> DropDetect::start(const uint64_t drop_detect_app_id, const char *
     return dropDetect;
 }
 
+/**
+ * The nanoapp-list query after a (re)connect only verifies that the drop
+ * nanoapp is loaded; it is diagnostics, not required for event delivery.
+ * SocketClient reconnects on its own whenever CHRE restarts, so during a
+ * sensor-hub crash loop this callback fires continuously and each query
+ * costs an encode, a send and a list-response decode. Back the query off
+ * exponentially (with jitter, so a fleet of daemons does not requery in
+ * lockstep) while reconnects keep arriving inside the streak window, and
+ * return to querying immediately once the hub stays up.
+ */
 void DropDetect::onConnected() {
+    constexpr auto kReconnectStreakWindow = std::chrono::seconds(60);
+    constexpr auto kQueryBackoffBase = std::chrono::seconds(1);
+    constexpr uint32_t kQueryBackoffMaxShift = 6; /* up to 64s */
+    constexpr uint32_t kQueryJitterMs = 1000;
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - mLastConnect < kReconnectStreakWindow) {
+        mReconnectStreak++;
+    } else {
+        mReconnectStreak = 0;
+    }
+    mLastConnect = now;
+
+    if (now < mNextNanoappQuery) {
+        ALOGW("CHRE reconnect streak of %u; nanoapp query suppressed", mReconnectStreak);
+        return;
+    }
+
+    if (mReconnectStreak > 0) {
+        const auto backoff =
+                kQueryBackoffBase * (1u << std::min(mReconnectStreak, kQueryBackoffMaxShift));
+        mNextNanoappQuery =
+                now + backoff + std::chrono::milliseconds(std::rand() % kQueryJitterMs);
+    }
+
     requestNanoappList(this);
 }
 
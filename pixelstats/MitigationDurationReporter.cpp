@@ -25,6 +25,7 @@
 #include <android/binder_manager.h>
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
 #include <pixelstats/MitigationDurationReporter.h>
+#include <pixelstats/StatsHelper.h>
 #include <utils/Log.h>
 
 namespace android {
@@ -76,17 +77,9 @@ enum DurationOutputOrder {
 
 MitigationDurationReporter::MitigationDurationReporter() {}
 
-bool MitigationDurationReporter::getStatFromLine(const std::string *line, int *val) {
-    std::vector<std::string> strs = android::base::Split(*line, ":");
-    if (strs.size() != 2) {
-        ALOGI("Unable to split %s", line->c_str());
-        return false;
-    }
-    std::string str = strs[1];
-    str = android::base::Trim(str);
-    str.erase(std::remove(str.begin(), str.end(), '\n'), str.cend());
-    if (!android::base::ParseInt(str, val)) {
-        ALOGI("Unable to convert %s to int - %s", str.c_str(), strerror(errno));
+bool MitigationDurationReporter::getStatFromLine(std::string_view line, int *val) {
+    if (scanLine(line, "%*[^:]:%d", val) != 1) {
+        ALOGI("Unable to parse %.*s", static_cast<int>(line.size()), line.data());
         return false;
     }
     return true;
@@ -152,7 +145,7 @@ void MitigationDurationReporter::logMitigationDuration(const std::shared_ptr<ISt
         ALOGE("Unable to report to Stats service");
 }
 
-int MitigationDurationReporter::updateStat(const std::string *line, int *val) {
+int MitigationDurationReporter::updateStat(std::string_view line, int *val) {
     int stat_value;
     if (!getStatFromLine(line, &stat_value) || *val == stat_value) {
         return 0;
@@ -171,8 +164,14 @@ bool MitigationDurationReporter::getIrqDurationCountHelper(
         return false;
     }
 
-    std::vector<std::string> lines = android::base::Split(file_contents, "\n");
-    if (lines.size() < kExpectedNumberOfLines) {
+    // The node is one "NAME: value" line per counter; walk it as views into
+    // file_contents instead of splitting into per-line string copies.
+    std::string_view lines[kExpectedNumberOfLines];
+    std::string_view remaining(file_contents), line;
+    int num_lines = 0;
+    while (num_lines < kExpectedNumberOfLines && getNextLine(&remaining, &line))
+        lines[num_lines++] = line;
+    if (num_lines < kExpectedNumberOfLines) {
         ALOGI("Readback size is invalid");
         return false;
     }
@@ -180,22 +179,22 @@ bool MitigationDurationReporter::getIrqDurationCountHelper(
     int16_t i;
     int num_stats = 0;
 
-    num_stats += updateStat(&lines[UVLO1], &counts->uvlo1_none);
-    num_stats += updateStat(&lines[UVLO1_MMWAVE], &counts->uvlo1_mmwave);
-    num_stats += updateStat(&lines[UVLO1_RFFE], &counts->uvlo1_rffe);
-    num_stats += updateStat(&lines[UVLO2], &counts->uvlo2_none);
-    num_stats += updateStat(&lines[UVLO2_MMWAVE], &counts->uvlo2_mmwave);
-    num_stats += updateStat(&lines[UVLO2_RFFE], &counts->uvlo2_rffe);
-    num_stats += updateStat(&lines[BATOILO], &counts->batoilo_none);
-    num_stats += updateStat(&lines[BATOILO_MMWAVE], &counts->batoilo_mmwave);
-    num_stats += updateStat(&lines[BATOILO_RFFE], &counts->batoilo_rffe);
+    num_stats += updateStat(lines[UVLO1], &counts->uvlo1_none);
+    num_stats += updateStat(lines[UVLO1_MMWAVE], &counts->uvlo1_mmwave);
+    num_stats += updateStat(lines[UVLO1_RFFE], &counts->uvlo1_rffe);
+    num_stats += updateStat(lines[UVLO2], &counts->uvlo2_none);
+    num_stats += updateStat(lines[UVLO2_MMWAVE], &counts->uvlo2_mmwave);
+    num_stats += updateStat(lines[UVLO2_RFFE], &counts->uvlo2_rffe);
+    num_stats += updateStat(lines[BATOILO], &counts->batoilo_none);
+    num_stats += updateStat(lines[BATOILO_MMWAVE], &counts->batoilo_mmwave);
+    num_stats += updateStat(lines[BATOILO_RFFE], &counts->batoilo_rffe);
 
     for (i = MAIN0; i <= MAIN11; i++) {
-        num_stats += updateStat(&lines[i], &counts->main[i - MAIN0]);
+        num_stats += updateStat(lines[i], &counts->main[i - MAIN0]);
     }
 
     for (i = SUB0; i <= SUB11; i++) {
-        num_stats += updateStat(&lines[i], &counts->sub[i - SUB0]);
+        num_stats += updateStat(lines[i], &counts->sub[i - SUB0]);
     }
 
     return num_stats > 0;
@@ -23,8 +23,11 @@
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
 #include <android/binder_manager.h>
+#include <ctype.h>
+#include <fcntl.h>
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
 #include <pixelstats/MitigationStatsReporter.h>
+#include <unistd.h>
 #include <utils/Log.h>
 
 namespace android {
@@ -56,11 +59,52 @@ bool MitigationStatsReporter::ReadFileToInt(const std::string &path, int *val) {
     return true;
 }
 
+void MitigationStatsReporter::openDirFds(const std::string &kMitigationDir) {
+    if (dirfds_opened_)
+        return;
+    dirfds_opened_ = true;
+    count_dirfd_.reset(TEMP_FAILURE_RETRY(open((kMitigationDir + "/last_triggered_count").c_str(),
+                                               O_DIRECTORY | O_PATH | O_CLOEXEC)));
+    cap_dirfd_.reset(TEMP_FAILURE_RETRY(open((kMitigationDir + "/last_triggered_capacity").c_str(),
+                                             O_DIRECTORY | O_PATH | O_CLOEXEC)));
+    if (!count_dirfd_.ok() || !cap_dirfd_.ok())
+        ALOGI("Unable to open mitigation dirs under %s - %s; falling back to full paths",
+              kMitigationDir.c_str(), strerror(errno));
+}
+
+bool MitigationStatsReporter::readNodeToInt(const ::android::base::unique_fd &dirfd,
+                                            const std::string &dir, const char *name, int *val) {
+    if (!dirfd.ok())
+        return ReadFileToInt(dir + "/" + name, val);
+
+    char buf[32];
+    ::android::base::unique_fd fd(
+            TEMP_FAILURE_RETRY(openat(dirfd.get(), name, O_RDONLY | O_CLOEXEC)));
+    if (fd < 0) {
+        ALOGI("Unable to open %s/%s - %s", dir.c_str(), name, strerror(errno));
+        return false;
+    }
+    ssize_t len = TEMP_FAILURE_RETRY(read(fd.get(), buf, sizeof(buf) - 1));
+    if (len <= 0) {
+        ALOGI("Unable to read %s/%s - %s", dir.c_str(), name, strerror(errno));
+        return false;
+    }
+    while (len > 0 && isspace(buf[len - 1]))
+        len--;
+    buf[len] = '\0';
+    if (!android::base::ParseInt(buf, val)) {
+        ALOGI("Unable to convert %s/%s to int - %s", dir.c_str(), name, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
 void MitigationStatsReporter::logMitigationStatsPerHour(const std::shared_ptr<IStats> &stats_client,
                                                         const std::string &path) {
     struct MitigationCount last_count = {};
     struct MitigationCap last_cap = {};
 
+    openDirFds(path);
     if (!logMitigationCount(path, &last_count))
         return;
     logMitigationCap(path, &last_cap);
@@ -132,83 +176,56 @@ void MitigationStatsReporter::logMitigationStatsPerHour(const std::shared_ptr<IS
 
 void MitigationStatsReporter::logMitigationCap(const std::string kMitigationDir,
                                                struct MitigationCap *last_cap) {
-    ReadFileToInt(kMitigationDir + "/last_triggered_capacity/batoilo_cap",
-                  &(last_cap->batoilo_cap));
-    ReadFileToInt(kMitigationDir + "/last_triggered_capacity/ocp_cpu1_cap",
-                  &(last_cap->ocp_cpu1_cap));
-    ReadFileToInt(kMitigationDir + "/last_triggered_capacity/ocp_cpu2_cap",
-                  &(last_cap->ocp_cpu2_cap));
-    ReadFileToInt(kMitigationDir + "/last_triggered_capacity/ocp_gpu_cap",
-                  &(last_cap->ocp_gpu_cap));
-    ReadFileToInt(kMitigationDir + "/last_triggered_capacity/ocp_tpu_cap",
-                  &(last_cap->ocp_tpu_cap));
-    ReadFileToInt(kMitigationDir + "/last_triggered_capacity/smpl_warn_cap",
-                  &(last_cap->smpl_warn_cap));
-    ReadFileToInt(kMitigationDir + "/last_triggered_capacity/soft_ocp_cpu1_cap",
-                  &(last_cap->soft_ocp_cpu1_cap));
-    ReadFileToInt(kMitigationDir + "/last_triggered_capacity/soft_ocp_cpu2_cap",
-                  &(last_cap->soft_ocp_cpu2_cap));
-    ReadFileToInt(kMitigationDir + "/last_triggered_capacity/soft_ocp_gpu_cap",
-                  &(last_cap->soft_ocp_gpu_cap));
-    ReadFileToInt(kMitigationDir + "/last_triggered_capacity/soft_ocp_tpu_cap",
-                  &(last_cap->soft_ocp_tpu_cap));
-    ReadFileToInt(kMitigationDir + "/last_triggered_capacity/vdroop1_cap",
-                  &(last_cap->vdroop1_cap));
-    ReadFileToInt(kMitigationDir + "/last_triggered_capacity/vdroop2_cap",
-                  &(last_cap->vdroop2_cap));
+    static constexpr struct {
+        const char *name;
+        int MitigationCap::*field;
+    } kCapNodes[] = {
+            {"batoilo_cap", &MitigationCap::batoilo_cap},
+            {"ocp_cpu1_cap", &MitigationCap::ocp_cpu1_cap},
+            {"ocp_cpu2_cap", &MitigationCap::ocp_cpu2_cap},
+            {"ocp_gpu_cap", &MitigationCap::ocp_gpu_cap},
+            {"ocp_tpu_cap", &MitigationCap::ocp_tpu_cap},
+            {"smpl_warn_cap", &MitigationCap::smpl_warn_cap},
+            {"soft_ocp_cpu1_cap", &MitigationCap::soft_ocp_cpu1_cap},
+            {"soft_ocp_cpu2_cap", &MitigationCap::soft_ocp_cpu2_cap},
+            {"soft_ocp_gpu_cap", &MitigationCap::soft_ocp_gpu_cap},
+            {"soft_ocp_tpu_cap", &MitigationCap::soft_ocp_tpu_cap},
+            {"vdroop1_cap", &MitigationCap::vdroop1_cap},
+            {"vdroop2_cap", &MitigationCap::vdroop2_cap},
+    };
+    const std::string cap_dir = kMitigationDir + "/last_triggered_capacity";
+
+    for (const auto &node : kCapNodes)
+        readNodeToInt(cap_dirfd_, cap_dir, node.name, &(last_cap->*node.field));
 }
 
 bool MitigationStatsReporter::logMitigationCount(const std::string kMitigationDir,
                                                  struct MitigationCount *last_count) {
+    static constexpr struct {
+        const char *name;
+        int MitigationCount::*field;
+    } kCountNodes[] = {
+            {"batoilo_count", &MitigationCount::batoilo_count},
+            {"ocp_cpu1_count", &MitigationCount::ocp_cpu1_count},
+            {"ocp_cpu2_count", &MitigationCount::ocp_cpu2_count},
+            {"ocp_gpu_count", &MitigationCount::ocp_gpu_count},
+            {"ocp_tpu_count", &MitigationCount::ocp_tpu_count},
+            {"smpl_warn_count", &MitigationCount::smpl_warn_count},
+            {"soft_ocp_cpu1_count", &MitigationCount::soft_ocp_cpu1_count},
+            {"soft_ocp_cpu2_count", &MitigationCount::soft_ocp_cpu2_count},
+            {"soft_ocp_gpu_count", &MitigationCount::soft_ocp_gpu_count},
+            {"soft_ocp_tpu_count", &MitigationCount::soft_ocp_tpu_count},
+            {"vdroop1_count", &MitigationCount::vdroop1_count},
+            {"vdroop2_count", &MitigationCount::vdroop2_count},
+    };
+    const std::string count_dir = kMitigationDir + "/last_triggered_count";
     bool send_stats = false;
-    if (!ReadFileToInt(kMitigationDir + "/last_triggered_count/batoilo_count",
-                       &(last_count->batoilo_count)))
-        return false;
-    send_stats |= (last_count->batoilo_count - prev_count.batoilo_count) > 0;
-    if (!ReadFileToInt(kMitigationDir + "/last_triggered_count/ocp_cpu1_count",
-                       &(last_count->ocp_cpu1_count)))
-        return false;
-    send_stats |= (last_count->ocp_cpu1_count - prev_count.ocp_cpu1_count) > 0;
-    if (!ReadFileToInt(kMitigationDir + "/last_triggered_count/ocp_cpu2_count",
-                       &(last_count->ocp_cpu2_count)))
-        return false;
-    send_stats |= (last_count->ocp_cpu2_count - prev_count.ocp_cpu2_count) > 0;
-    if (!ReadFileToInt(kMitigationDir + "/last_triggered_count/ocp_gpu_count",
-                       &(last_count->ocp_gpu_count)))
-        return false;
-    send_stats |= (last_count->ocp_gpu_count - prev_count.ocp_gpu_count) > 0;
-    if (!ReadFileToInt(kMitigationDir + "/last_triggered_count/ocp_tpu_count",
-                       &(last_count->ocp_tpu_count)))
-        return false;
-    send_stats |= (last_count->ocp_tpu_count - prev_count.ocp_tpu_count) > 0;
-    if (!ReadFileToInt(kMitigationDir + "/last_triggered_count/smpl_warn_count",
-                       &(last_count->smpl_warn_count)))
-        return false;
-    send_stats |= (last_count->smpl_warn_count - prev_count.smpl_warn_count) > 0;
-    if (!ReadFileToInt(kMitigationDir + "/last_triggered_count/soft_ocp_cpu1_count",
-                       &(last_count->soft_ocp_cpu1_count)))
-        return false;
-    send_stats |= (last_count->soft_ocp_cpu1_count - prev_count.soft_ocp_cpu1_count) > 0;
-    if (!ReadFileToInt(kMitigationDir + "/last_triggered_count/soft_ocp_cpu2_count",
-                       &(last_count->soft_ocp_cpu2_count)))
-        return false;
-    send_stats |= (last_count->soft_ocp_cpu2_count - prev_count.soft_ocp_cpu2_count) > 0;
-    if (!ReadFileToInt(kMitigationDir + "/last_triggered_count/soft_ocp_gpu_count",
-                       &(last_count->soft_ocp_gpu_count)))
-        return false;
-    send_stats |= (last_count->soft_ocp_gpu_count - prev_count.soft_ocp_gpu_count) > 0;
-    if (!ReadFileToInt(kMitigationDir + "/last_triggered_count/soft_ocp_tpu_count",
-                       &(last_count->soft_ocp_tpu_count)))
-        return false;
-    send_stats |= (last_count->soft_ocp_tpu_count - prev_count.soft_ocp_tpu_count) > 0;
-    if (!ReadFileToInt(kMitigationDir + "/last_triggered_count/vdroop1_count",
-                       &(last_count->vdroop1_count)))
-        return false;
-    send_stats |= (last_count->vdroop1_count - prev_count.vdroop1_count) > 0;
-    if (!ReadFileToInt(kMitigationDir + "/last_triggered_count/vdroop2_count",
-                       &(last_count->vdroop2_count)))
-        return false;
-    send_stats |= (last_count->vdroop2_count - prev_count.vdroop2_count) > 0;
+
+    for (const auto &node : kCountNodes) {
+        if (!readNodeToInt(count_dirfd_, count_dir, node.name, &(last_count->*node.field)))
+            return false;
+        send_stats |= (last_count->*node.field - prev_count.*node.field) > 0;
+    }
     return send_stats;
 }
 
@@ -25,9 +25,13 @@
 #include <android-base/strings.h>
 #include <android/binder_manager.h>
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
+#include <fcntl.h>
+#include <inttypes.h>
 #include <pixelstats/MmMetricsReporter.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <time.h>
 #include <unistd.h>
 #include <utils/Log.h>
 
@@ -286,12 +290,73 @@ bool MmMetricsReporter::reportVendorAtom(const std::shared_ptr<IStats> &stats_cl
     return true;
 }
 
+bool ProcCounterReader::ensureOpen() {
+    if (fd_ >= 0)
+        return true;
+    fd_.reset(open(path_.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fd_ < 0) {
+        // Don't print this log if the file doesn't exist, since logs will be printed repeatedly.
+        if (errno != ENOENT)
+            ALOGE("Unable to open %s, err: %s", path_.c_str(), strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool ProcCounterReader::read(std::map<std::string, uint64_t> *out) {
+    if (!ensureOpen())
+        return false;
+
+    if (buf_.empty())
+        buf_.resize(8192);
+    ssize_t n;
+    while (true) {
+        n = TEMP_FAILURE_RETRY(pread(fd_, buf_.data(), buf_.size() - 1, 0));
+        if (n < 0) {
+            ALOGE("Unable to read %s, err: %s", path_.c_str(), strerror(errno));
+            fd_.reset();
+            return false;
+        }
+        if (static_cast<size_t>(n) < buf_.size() - 1)
+            break;
+        buf_.resize(buf_.size() * 2);
+    }
+    buf_[n] = '\0';
+
+    size_t line = 0;
+    const char *cp = buf_.data();
+    const char *end = cp + n;
+    while (cp < end) {
+        const char *nl = static_cast<const char *>(memchr(cp, '\n', end - cp));
+        const char *eol = nl ? nl : end;
+        const char *sp = static_cast<const char *>(memchr(cp, ' ', eol - cp));
+        if (sp) {
+            size_t key_len = sp - cp;
+            if (line >= line_keys_.size()) {
+                line_keys_.emplace_back(cp, key_len);
+            } else if (line_keys_[line].size() != key_len ||
+                       memcmp(line_keys_[line].data(), cp, key_len) != 0) {
+                // Key order changed (e.g. a module registered a counter);
+                // re-record from here on.
+                line_keys_[line].assign(cp, key_len);
+            }
+            char *parse_end;
+            errno = 0;
+            unsigned long long value = strtoull(sp + 1, &parse_end, 10);
+            if (parse_end != sp + 1 && errno == 0)
+                (*out)[line_keys_[line]] = value;
+            line++;
+        }
+        cp = eol + 1;
+    }
+    return true;
+}
+
 /**
  * Parse the output of /proc/vmstat or the sysfs having the same output format.
  * The map containing pairs of {field_string, data} will be returned.
  */
 std::map<std::string, uint64_t> MmMetricsReporter::readVmStat(const char *path) {
-    std::string file_contents;
     std::map<std::string, uint64_t> vmstat_data;
 
     if (path == nullptr) {
@@ -299,25 +364,88 @@ std::map<std::string, uint64_t> MmMetricsReporter::readVmStat(const char *path)
         return vmstat_data;
     }
 
-    if (!ReadFileToString(path, &file_contents)) {
-        ALOGE("Unable to read vmstat from %s, err: %s", path, strerror(errno));
-        return vmstat_data;
+    auto reader = vmstat_readers_.try_emplace(path, path).first;
+    if (!reader->second.read(&vmstat_data))
+        ALOGE("Unable to read vmstat from %s", path);
+    return vmstat_data;
+}
+
+int MmMetricsReporter::preparePsiMemoryTrigger() {
+    if (!MmMetricsSupported())
+        return -1;
+
+    std::string spec = ::android::base::GetProperty("persist.vendor.mm_metrics.psi_trigger",
+                                                    kPsiDefaultTriggerSpec);
+    psi_trigger_fd_.reset(
+            TEMP_FAILURE_RETRY(open(kPsiMemoryPath, O_RDWR | O_NONBLOCK | O_CLOEXEC)));
+    if (!psi_trigger_fd_.ok()) {
+        ALOGI("Unable to open %s for PSI trigger - %s", kPsiMemoryPath, strerror(errno));
+        return -1;
     }
+    if (write(psi_trigger_fd_, spec.c_str(), spec.size() + 1) < 0) {
+        ALOGI("Unable to register PSI trigger \"%s\" - %s", spec.c_str(), strerror(errno));
+        psi_trigger_fd_.reset();
+        return -1;
+    }
+    ALOGI("Registered PSI memory trigger \"%s\"", spec.c_str());
+    return psi_trigger_fd_.get();
+}
 
-    std::istringstream data(file_contents);
-    std::string line;
-    while (std::getline(data, line)) {
-        std::vector<std::string> words = android::base::Split(line, " ");
-        if (words.size() != 2)
-            continue;
+/**
+ * Log a burst snapshot of the reclaim counters when the PSI memory trigger
+ * fires. Counters are reported as deltas since the previous burst (or since
+ * boot for the first one), so the lines correlate the stall with the reclaim
+ * activity that accompanied it.
+ */
+void MmMetricsReporter::logPsiBurstSnapshot() {
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    if (last_burst_sec_ != 0 && ts.tv_sec - last_burst_sec_ < kPsiBurstMinIntervalSec)
+        return;
+    int64_t since_sec = (last_burst_sec_ != 0) ? ts.tv_sec - last_burst_sec_ : 0;
+    last_burst_sec_ = ts.tv_sec;
+
+    std::map<std::string, uint64_t> vmstat = readVmStat(kVmstatPath);
+    if (vmstat.size() == 0)
+        return;
 
-        uint64_t i;
-        if (!android::base::ParseUint(words[1], &i))
+    // Levels are logged as-is, counters as deltas against the previous burst.
+    static constexpr const char *kBurstLevelKeys[] = {"nr_free_pages", "nr_file_pages"};
+    static constexpr const char *kBurstCounterKeys[] = {
+            "pgscan_kswapd",  "pgscan_direct",           "pgsteal_kswapd", "pgsteal_direct",
+            "allocstall_normal", "workingset_refault_file", "pswpout",        "oom_kill"};
+
+    std::string snapshot;
+    for (const char *key : kBurstLevelKeys) {
+        auto it = vmstat.find(key);
+        if (it != vmstat.end())
+            snapshot += ::android::base::StringPrintf(" %s=%" PRIu64, key, it->second);
+    }
+    for (const char *key : kBurstCounterKeys) {
+        auto it = vmstat.find(key);
+        if (it == vmstat.end())
             continue;
+        auto prev = prev_burst_vmstat_.find(key);
+        uint64_t delta = (prev != prev_burst_vmstat_.end()) ? it->second - prev->second
+                                                            : it->second;
+        snapshot += ::android::base::StringPrintf(" %s=+%" PRIu64, key, delta);
+    }
 
-        vmstat_data[words[0]] = i;
+    std::vector<long> direct_reclaim;
+    readDirectReclaimStat(&direct_reclaim);
+    if (!direct_reclaim.empty()) {
+        long total = 0;
+        for (long val : direct_reclaim)
+            total += val;
+        long delta = (prev_burst_direct_reclaim_total_ >= 0)
+                             ? total - prev_burst_direct_reclaim_total_
+                             : total;
+        prev_burst_direct_reclaim_total_ = total;
+        snapshot += ::android::base::StringPrintf(" direct_reclaim_ns=+%ld", delta);
     }
-    return vmstat_data;
+
+    prev_burst_vmstat_ = std::move(vmstat);
+    ALOGI("PSI memory trigger burst (+%" PRId64 "s):%s", since_sec, snapshot.c_str());
 }
 
 uint64_t MmMetricsReporter::getIonTotalPools() {
@@ -464,10 +592,10 @@ void MmMetricsReporter::logPixelMmMetricsPerDay(const std::shared_ptr<IStats> &s
     std::map<std::string, uint64_t> pixel_vmstat =
             readVmStat(android::base::StringPrintf("%s/vmstat", kPixelStatMm).c_str());
     fillAtomValues(kMmMetricsPerDayInfo, pixel_vmstat, &prev_day_pixel_vmstat_, &values);
-    fillProcessStime(PixelMmMetricsPerDay::kKswapdStimeClksFieldNumber, "kswapd0", &kswapd_pid_,
+    fillProcessStime(PixelMmMetricsPerDay::kKswapdStimeClksFieldNumber, "kswapd0", &kswapd_stat_,
                      &prev_kswapd_stime_, &values);
     fillProcessStime(PixelMmMetricsPerDay::kKcompactdStimeClksFieldNumber, "kcompactd0",
-                     &kcompactd_pid_, &prev_kcompactd_stime_, &values);
+                     &kcompactd_stat_, &prev_kcompactd_stime_, &values);
     fillDirectReclaimStatAtom(direct_reclaim, &values);
     fillCompactionDurationStatAtom(direct_reclaim, &values);
 
@@ -479,24 +607,6 @@ void MmMetricsReporter::logPixelMmMetricsPerDay(const std::shared_ptr<IStats> &s
     }
 }
 
-/**
- * Check if /proc/<pid>/comm is equal to name.
- */
-bool MmMetricsReporter::isValidPid(int pid, const char *name) {
-    if (pid <= 0)
-        return false;
-
-    std::string file_contents;
-    std::string path = android::base::StringPrintf("/proc/%d/comm", pid);
-    if (!ReadFileToString(path, &file_contents)) {
-        ALOGI("Unable to read %s, err: %s", path.c_str(), strerror(errno));
-        return false;
-    }
-
-    file_contents = android::base::Trim(file_contents);
-    return !file_contents.compare(name);
-}
-
 /**
  * Return pid if /proc/<pid>/comm is equal to name, or -1 if not found.
  */
@@ -532,42 +642,84 @@ int MmMetricsReporter::findPidByProcessName(const char *name) {
 }
 
 /**
- * Get stime of a process from /proc/<pid>/stat
- * stime is the 15th field.
+ * Resolve the pid of a kernel thread by name and open a persistent fd to its
+ * /proc/<pid>/stat, recording the starttime for later revalidation.
  */
-uint64_t MmMetricsReporter::getStimeByPid(int pid) {
-    const int stime_idx = 15;
+bool MmMetricsReporter::openProcStatFile(const char *name, KernelProcStatFile *stat_file) {
+    stat_file->fd.reset();
+    stat_file->pid = findPidByProcessName(name);
+    if (stat_file->pid <= 0) {
+        ALOGI("Unable to find pid of %s, err: %s", name, strerror(errno));
+        return false;
+    }
+
+    std::string path = android::base::StringPrintf("/proc/%d/stat", stat_file->pid);
+    stat_file->fd.reset(TEMP_FAILURE_RETRY(open(path.c_str(), O_RDONLY | O_CLOEXEC)));
+    if (stat_file->fd < 0) {
+        ALOGI("Unable to open %s, err: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+
     uint64_t stime;
-    std::string file_contents;
-    std::string path = android::base::StringPrintf("/proc/%d/stat", pid);
-    if (!ReadFileToString(path, &file_contents)) {
-        ALOGI("Unable to read %s, err: %s", path.c_str(), strerror(errno));
+    if (!readProcStatFile(*stat_file, &stime, &stat_file->starttime)) {
+        stat_file->fd.reset();
         return false;
     }
+    return true;
+}
+
+/**
+ * Get stime (field 15) and starttime (field 22) of a process by pread()ing
+ * its cached /proc/<pid>/stat fd into a fixed buffer. The fields are counted
+ * from the ')' closing the comm field, so a comm containing spaces cannot
+ * shift them.
+ */
+bool MmMetricsReporter::readProcStatFile(const KernelProcStatFile &stat_file, uint64_t *stime,
+                                         uint64_t *starttime) {
+    const int stime_idx = 15;
+    const int starttime_idx = 22;
+    char buf[1024];
 
-    std::vector<std::string> data = android::base::Split(file_contents, " ");
-    if (data.size() < stime_idx) {
-        ALOGI("Unable to find stime from %s. size: %zu", path.c_str(), data.size());
+    ssize_t ret = TEMP_FAILURE_RETRY(pread(stat_file.fd, buf, sizeof(buf) - 1, 0));
+    if (ret <= 0) {
+        ALOGI("Unable to read /proc/%d/stat, err: %s", stat_file.pid, strerror(errno));
         return false;
     }
+    buf[ret] = '\0';
 
-    if (android::base::ParseUint(data[stime_idx - 1], &stime))
-        return stime;
-    else
-        return 0;
+    char *pos = strrchr(buf, ')');
+    if (pos == nullptr)
+        return false;
+    pos++;  // fields 3.. follow the ')', separated by single spaces
+
+    uint64_t value = 0;
+    for (int field = 3; field <= starttime_idx; field++) {
+        char *end;
+        value = strtoull(pos, &end, 10);
+        if (end == pos && field > 3)  // field 3 (state) is not numeric
+            return false;
+        if (field == stime_idx)
+            *stime = value;
+        pos = strchr(field == 3 ? pos + 1 : end, ' ');
+        if (pos == nullptr)
+            return false;
+        pos++;
+    }
+    *starttime = value;
+    return true;
 }
 
 /**
  * Find stime of the process and copy it into atom_values
  * atom_key: Currently, it can only be kKswapdTimeFieldNumber or kKcompactdTimeFieldNumber
  * name: process name
- * pid: The pid of the process. It would be the pid we found last time,
- *      or -1 if not found.
+ * stat_file: Persistent handle to the process's /proc/<pid>/stat, resolved on
+ *            the first call and revalidated by starttime afterwards.
  * prev_stime: The stime of the process collected last time.
  * atom_values: The atom we will report later.
  */
-void MmMetricsReporter::fillProcessStime(int atom_key, const char *name, int *pid,
-                                         uint64_t *prev_stime,
+void MmMetricsReporter::fillProcessStime(int atom_key, const char *name,
+                                         KernelProcStatFile *stat_file, uint64_t *prev_stime,
                                          std::vector<VendorAtomValue> *atom_values) {
     // resize atom_values if there is no space for this stime field.
     int atom_idx = atom_key - kVendorAtomOffset;
@@ -577,15 +729,16 @@ void MmMetricsReporter::fillProcessStime(int atom_key, const char *name, int *pi
     if (atom_values->size() < size)
         atom_values->resize(size, tmp);
 
-    if (!isValidPid(*pid, name)) {
-        (*pid) = findPidByProcessName(name);
-        if ((*pid) <= 0) {
-            ALOGI("Unable to find pid of %s, err: %s", name, strerror(errno));
+    // The cached fd stays valid for the life of the kernel thread; a read
+    // failure or a starttime change (pid reuse) forces one re-resolve.
+    uint64_t stime, starttime;
+    if (stat_file->fd < 0 || !readProcStatFile(*stat_file, &stime, &starttime) ||
+        starttime != stat_file->starttime) {
+        if (!openProcStatFile(name, stat_file) ||
+            !readProcStatFile(*stat_file, &stime, &starttime))
             return;
-        }
     }
 
-    uint64_t stime = getStimeByPid(*pid);
     tmp.set<VendorAtomValue::longValue>(stime - *prev_stime);
     (*atom_values)[atom_idx] = tmp;
     (*prev_stime) = stime;
@@ -23,6 +23,7 @@
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
 #include <log/log.h>
 #include <pixelstats/PcaChargeStats.h>
+#include <pixelstats/StatsHelper.h>
 
 namespace android {
 namespace hardware {
@@ -34,8 +35,7 @@ using android::base::WriteStringToFile;
 
 bool PcaChargeStats::CheckPcaContentsAndAck(std::string *file_contents) {
     std::string path = kPcaChargeMetricsPath;
-    std::string line;
-    std::istringstream ss;
+    std::string_view remaining, line;
 
     if (!ReadFileToString(path.c_str(), file_contents)) {
         if (!ReadFileToString(kPca94xxChargeMetricsPath.c_str(), file_contents)) {
@@ -48,9 +48,8 @@ bool PcaChargeStats::CheckPcaContentsAndAck(std::string *file_contents) {
         }
     }
 
-    ss.str(*file_contents);
-
-    if (!std::getline(ss, line)) {
+    remaining = *file_contents;
+    if (!getNextLine(&remaining, &line)) {
         ALOGE("Unable to read first line %s - %s", path.c_str(), strerror(errno));
         return false;
     }
@@ -14,13 +14,28 @@
  * limitations under the License.
  */
 
+#include <android-base/file.h>
+#include <android-base/unique_fd.h>
 #include <android/binder_manager.h>
+#include <fcntl.h>
 #include <pixelstats/StatsHelper.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #define LOG_TAG "pixelstats-vendor"
 
 #include <utils/Log.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 namespace android {
 namespace hardware {
 namespace google {
@@ -34,6 +49,374 @@ using aidl::android::frameworks::stats::VendorAtomValue;
 // -2.
 const int kVendorAtomOffset = 2;
 
+namespace {
+
+// How long the submitter waits after the first queued atom before draining,
+// so a periodic collector run lands in one drain instead of one binder
+// wakeup per atom.
+constexpr auto kBatchWindow = std::chrono::milliseconds(100);
+// Bound on queued atoms; an overflowing enqueue drains inline rather than
+// dropping metrics.
+constexpr size_t kMaxQueuedAtoms = 256;
+
+// On-disk spool for atoms that could not be delivered because statsd was
+// unavailable (early boot, crash loop). Atoms are framed as
+// length-prefixed records behind a magic/version header, appended with a
+// single write + fsync, and replayed in order once a submission succeeds
+// again — so the data collected around a crash, which is exactly the data
+// worth having, survives the outage. The file is size-capped; when the cap
+// is hit the oldest records are dropped, keeping the newest (most
+// crash-adjacent) samples. Only scalar and string values are spooled;
+// atoms carrying repeated or byte-array values are rare on these paths and
+// are dropped with a log.
+class AtomSpool {
+  public:
+    static AtomSpool &getInstance() {
+        static AtomSpool *instance = new AtomSpool();
+        return *instance;
+    }
+
+    void append(const VendorAtom &event) {
+        std::string record;
+        if (!serialize(event, &record)) {
+            ALOGW("Not spooling atom %d: unsupported value type", event.atomId);
+            return;
+        }
+
+        std::lock_guard lock(lock_);
+        std::string contents;
+        if (!::android::base::ReadFileToString(kSpoolPath, &contents) || !validHeader(contents)) {
+            mkdir(kSpoolDir, 0770);
+            contents.assign(reinterpret_cast<const char *>(kHeader), sizeof(kHeader));
+        }
+        while (contents.size() + record.size() > kMaxBytes) {
+            if (!dropOldestRecord(&contents)) {
+                contents.assign(reinterpret_cast<const char *>(kHeader), sizeof(kHeader));
+                break;
+            }
+        }
+        contents += record;
+        writeContents(contents);
+    }
+
+    // Replays spooled atoms through stats_client. Records that fail to
+    // submit stay spooled for the next attempt.
+    void replay(const std::shared_ptr<IStats> &stats_client) {
+        std::lock_guard lock(lock_);
+        std::string contents;
+        if (!::android::base::ReadFileToString(kSpoolPath, &contents) || !validHeader(contents))
+            return;
+        if (contents.size() == sizeof(kHeader))
+            return;
+
+        size_t offset = sizeof(kHeader);
+        int replayed = 0;
+        while (offset < contents.size()) {
+            VendorAtom event;
+            size_t next = deserialize(contents, offset, &event);
+            if (next == 0) {
+                ALOGE("Corrupt atom spool, discarding %zu bytes", contents.size() - offset);
+                offset = contents.size();
+                break;
+            }
+            if (!stats_client->reportVendorAtom(event).isOk())
+                break;
+            replayed++;
+            offset = next;
+        }
+        if (replayed > 0)
+            ALOGI("Replayed %d spooled atoms", replayed);
+
+        // Keep whatever did not make it.
+        std::string remainder(reinterpret_cast<const char *>(kHeader), sizeof(kHeader));
+        remainder += contents.substr(offset);
+        writeContents(remainder);
+    }
+
+  private:
+    static constexpr char kSpoolDir[] = "/data/vendor/pixelstats";
+    static constexpr char kSpoolPath[] = "/data/vendor/pixelstats/atom_spool.bin";
+    static constexpr size_t kMaxBytes = 512 * 1024;
+    static constexpr uint32_t kHeader[2] = {0x50535350 /* "PSSP" */, 1 /* version */};
+
+    // Record layout: uint32 payload size | int32 atomId | uint32 nvalues |
+    // nvalues x (uint8 tag + payload). Strings carry a uint32 length.
+    enum ValueTag : uint8_t { kTagInt = 0, kTagLong = 1, kTagFloat = 2, kTagString = 3 };
+
+    AtomSpool() = default;
+
+    static bool validHeader(const std::string &contents) {
+        return contents.size() >= sizeof(kHeader) &&
+               memcmp(contents.data(), kHeader, sizeof(kHeader)) == 0;
+    }
+
+    template <typename T>
+    static void appendRaw(std::string *out, const T &val) {
+        out->append(reinterpret_cast<const char *>(&val), sizeof(val));
+    }
+
+    template <typename T>
+    static bool readRaw(const std::string &in, size_t *offset, T *val) {
+        if (*offset + sizeof(T) > in.size())
+            return false;
+        memcpy(val, in.data() + *offset, sizeof(T));
+        *offset += sizeof(T);
+        return true;
+    }
+
+    static bool serialize(const VendorAtom &event, std::string *out) {
+        std::string payload;
+        appendRaw(&payload, event.atomId);
+        appendRaw(&payload, static_cast<uint32_t>(event.values.size()));
+        for (const VendorAtomValue &value : event.values) {
+            switch (value.getTag()) {
+                case VendorAtomValue::intValue:
+                    appendRaw(&payload, static_cast<uint8_t>(kTagInt));
+                    appendRaw(&payload, value.get<VendorAtomValue::intValue>());
+                    break;
+                case VendorAtomValue::longValue:
+                    appendRaw(&payload, static_cast<uint8_t>(kTagLong));
+                    appendRaw(&payload, value.get<VendorAtomValue::longValue>());
+                    break;
+                case VendorAtomValue::floatValue:
+                    appendRaw(&payload, static_cast<uint8_t>(kTagFloat));
+                    appendRaw(&payload, value.get<VendorAtomValue::floatValue>());
+                    break;
+                case VendorAtomValue::stringValue: {
+                    const std::string &str = value.get<VendorAtomValue::stringValue>();
+                    appendRaw(&payload, static_cast<uint8_t>(kTagString));
+                    appendRaw(&payload, static_cast<uint32_t>(str.size()));
+                    payload += str;
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        appendRaw(out, static_cast<uint32_t>(payload.size()));
+        *out += payload;
+        return true;
+    }
+
+    // Parses one record at offset. Returns the offset of the next record,
+    // or 0 on corruption.
+    static size_t deserialize(const std::string &contents, size_t offset, VendorAtom *event) {
+        uint32_t payload_size;
+        if (!readRaw(contents, &offset, &payload_size))
+            return 0;
+        const size_t end = offset + payload_size;
+        if (end > contents.size())
+            return 0;
+
+        uint32_t nvalues;
+        if (!readRaw(contents, &offset, &event->atomId) ||
+            !readRaw(contents, &offset, &nvalues))
+            return 0;
+
+        event->reverseDomainName = "";
+        event->values.resize(nvalues);
+        for (uint32_t i = 0; i < nvalues; i++) {
+            uint8_t tag;
+            if (!readRaw(contents, &offset, &tag))
+                return 0;
+            switch (tag) {
+                case kTagInt: {
+                    int32_t val;
+                    if (!readRaw(contents, &offset, &val))
+                        return 0;
+                    event->values[i].set<VendorAtomValue::intValue>(val);
+                    break;
+                }
+                case kTagLong: {
+                    int64_t val;
+                    if (!readRaw(contents, &offset, &val))
+                        return 0;
+                    event->values[i].set<VendorAtomValue::longValue>(val);
+                    break;
+                }
+                case kTagFloat: {
+                    float val;
+                    if (!readRaw(contents, &offset, &val))
+                        return 0;
+                    event->values[i].set<VendorAtomValue::floatValue>(val);
+                    break;
+                }
+                case kTagString: {
+                    uint32_t len;
+                    if (!readRaw(contents, &offset, &len) || offset + len > end)
+                        return 0;
+                    event->values[i].set<VendorAtomValue::stringValue>(
+                            contents.substr(offset, len));
+                    offset += len;
+                    break;
+                }
+                default:
+                    return 0;
+            }
+        }
+        return (offset == end) ? end : 0;
+    }
+
+    // Removes the record following the header. Returns false if the spool
+    // is empty or unparsable.
+    static bool dropOldestRecord(std::string *contents) {
+        size_t offset = sizeof(kHeader);
+        uint32_t payload_size;
+        if (!readRaw(*contents, &offset, &payload_size) ||
+            offset + payload_size > contents->size())
+            return false;
+        contents->erase(sizeof(kHeader), sizeof(payload_size) + payload_size);
+        return true;
+    }
+
+    void writeContents(const std::string &contents) {
+        ::android::base::unique_fd fd(TEMP_FAILURE_RETRY(
+                open(kSpoolPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0660)));
+        if (!fd.ok()) {
+            ALOGE("Unable to open atom spool %s - %s", kSpoolPath, strerror(errno));
+            return;
+        }
+        if (!::android::base::WriteFully(fd, contents.data(), contents.size())) {
+            ALOGE("Unable to write atom spool %s - %s", kSpoolPath, strerror(errno));
+            return;
+        }
+        fsync(fd);
+    }
+
+    std::mutex lock_;
+};
+
+// Batches atom submissions onto a background thread. SysfsCollector's
+// periodic run fires dozens of atoms back-to-back; queueing them and
+// draining once per window keeps the binder/socket overhead off the
+// collector thread and coalesces its wakeups. IStats has no multi-atom
+// call, so a drain is still one reportVendorAtom per atom, just contiguous
+// and off the hot path.
+class VendorAtomBatcher {
+  public:
+    static VendorAtomBatcher &getInstance() {
+        static VendorAtomBatcher *instance = new VendorAtomBatcher();
+        return *instance;
+    }
+
+    void enqueue(const std::shared_ptr<IStats> &stats_client, VendorAtom &&event) {
+        std::unique_lock<std::mutex> lock(lock_);
+        if (queue_.size() >= kMaxQueuedAtoms) {
+            std::vector<Entry> batch;
+            batch.swap(queue_);
+            lock.unlock();
+            submitBatch(batch);
+            lock.lock();
+        }
+        queue_.push_back({stats_client, std::move(event)});
+        cv_.notify_one();
+    }
+
+  private:
+    struct Entry {
+        std::shared_ptr<IStats> stats_client;
+        VendorAtom event;
+    };
+
+    VendorAtomBatcher() {
+        std::thread(&VendorAtomBatcher::submitLoop, this).detach();
+    }
+
+    void submitLoop() {
+        std::unique_lock<std::mutex> lock(lock_);
+        while (true) {
+            cv_.wait(lock, [this] { return !queue_.empty(); });
+            // Let the rest of the burst arrive before draining.
+            lock.unlock();
+            std::this_thread::sleep_for(kBatchWindow);
+            lock.lock();
+            std::vector<Entry> batch;
+            batch.swap(queue_);
+            lock.unlock();
+            submitBatch(batch);
+            lock.lock();
+        }
+    }
+
+    static void submitBatch(const std::vector<Entry> &batch) {
+        bool all_ok = true;
+        for (const Entry &entry : batch) {
+            const ndk::ScopedAStatus ret = entry.stats_client->reportVendorAtom(entry.event);
+            if (!ret.isOk()) {
+                ALOGE("Unable to report atom %d to Stats service, spooling",
+                      entry.event.atomId);
+                AtomSpool::getInstance().append(entry.event);
+                all_ok = false;
+            }
+        }
+        // A fully successful drain means statsd is back; deliver whatever
+        // was spooled while it was away.
+        if (all_ok && !batch.empty())
+            AtomSpool::getInstance().replay(batch.front().stats_client);
+    }
+
+    std::mutex lock_;
+    std::condition_variable cv_;
+    std::vector<Entry> queue_;
+};
+
+std::mutex sysfs_cache_lock;
+std::unordered_map<std::string, std::string> sysfs_cache;
+
+}  // namespace
+
+void enqueueVendorAtom(const std::shared_ptr<IStats> &stats_client, VendorAtom &&event) {
+    VendorAtomBatcher::getInstance().enqueue(stats_client, std::move(event));
+}
+
+bool readSysfsCached(const std::string &path, std::string *content) {
+    {
+        std::lock_guard lock(sysfs_cache_lock);
+        auto entry = sysfs_cache.find(path);
+        if (entry != sysfs_cache.end()) {
+            *content = entry->second;
+            return true;
+        }
+    }
+    if (!::android::base::ReadFileToString(path, content))
+        return false;
+    std::lock_guard lock(sysfs_cache_lock);
+    sysfs_cache.emplace(path, *content);
+    return true;
+}
+
+void invalidateSysfsCache() {
+    std::lock_guard lock(sysfs_cache_lock);
+    sysfs_cache.clear();
+}
+
+bool getNextLine(std::string_view *remaining, std::string_view *line) {
+    if (remaining->empty())
+        return false;
+    size_t end = remaining->find('\n');
+    if (end == std::string_view::npos) {
+        *line = *remaining;
+        remaining->remove_prefix(remaining->size());
+    } else {
+        *line = remaining->substr(0, end);
+        remaining->remove_prefix(end + 1);
+    }
+    return true;
+}
+
+int scanLine(std::string_view line, const char *fmt, ...) {
+    char buf[256];
+    size_t len = std::min(line.size(), sizeof(buf) - 1);
+    memcpy(buf, line.data(), len);
+    buf[len] = '\0';
+
+    va_list args;
+    va_start(args, fmt);
+    int matched = vsscanf(buf, fmt, args);
+    va_end(args);
+    return matched;
+}
+
 std::shared_ptr<IStats> getStatsService() {
     const std::string instance = std::string() + IStats::descriptor + "/default";
     static bool isStatsDeclared = false;
@@ -58,13 +441,11 @@ void reportSpeakerImpedance(const std::shared_ptr<IStats> &stats_client,
     tmp.set<VendorAtomValue::intValue>(speakerImpedance.impedance());
     values[1] = tmp;
 
-    // Send vendor atom to IStats HAL
+    // Queue vendor atom for the IStats HAL
     VendorAtom event = {.reverseDomainName = "",
                         .atomId = PixelAtoms::Atom::kVendorSpeakerImpedance,
                         .values = std::move(values)};
-    const ndk::ScopedAStatus ret = stats_client->reportVendorAtom(event);
-    if (!ret.isOk())
-        ALOGE("Unable to report VendorSpeakerImpedance to Stats service");
+    enqueueVendorAtom(stats_client, std::move(event));
 }
 
 void reportSpeakerHealthStat(const std::shared_ptr<IStats> &stats_client,
@@ -83,13 +464,11 @@ void reportSpeakerHealthStat(const std::shared_ptr<IStats> &stats_client,
     tmp.set<VendorAtomValue::intValue>(speakerHealthStat.heartbeat());
     values[4] = tmp;
 
-    // Send vendor atom to IStats HAL
+    // Queue vendor atom for the IStats HAL
     VendorAtom event = {.reverseDomainName = "",
                         .atomId = PixelAtoms::Atom::kVendorSpeakerStatsReported,
                         .values = std::move(values)};
-    const ndk::ScopedAStatus ret = stats_client->reportVendorAtom(event);
-    if (!ret.isOk())
-        ALOGE("Unable to report VendorSpeakerStatsReported to Stats service");
+    enqueueVendorAtom(stats_client, std::move(event));
 }
 
 void reportSlowIo(const std::shared_ptr<IStats> &stats_client,
@@ -102,13 +481,11 @@ void reportSlowIo(const std::shared_ptr<IStats> &stats_client,
     tmp.set<VendorAtomValue::intValue>(slowIo.count());
     values[1] = tmp;
 
-    // Send vendor atom to IStats HAL
+    // Queue vendor atom for the IStats HAL
     VendorAtom event = {.reverseDomainName = "",
                         .atomId = PixelAtoms::Atom::kVendorSlowIo,
                         .values = std::move(values)};
-    const ndk::ScopedAStatus ret = stats_client->reportVendorAtom(event);
-    if (!ret.isOk())
-        ALOGE("Unable to report VendorSlowIo to Stats service");
+    enqueueVendorAtom(stats_client, std::move(event));
 }
 
 void reportChargeCycles(const std::shared_ptr<IStats> &stats_client,
@@ -123,13 +500,11 @@ void reportChargeCycles(const std::shared_ptr<IStats> &stats_client,
         values[bucketIdx] = tmp;
     }
 
-    // Send vendor atom to IStats HAL
+    // Queue vendor atom for the IStats HAL
     VendorAtom event = {.reverseDomainName = "",
                         .atomId = PixelAtoms::Atom::kVendorChargeCycles,
                         .values = std::move(values)};
-    const ndk::ScopedAStatus ret = stats_client->reportVendorAtom(event);
-    if (!ret.isOk())
-        ALOGE("Unable to report VendorChargeCycles to Stats service");
+    enqueueVendorAtom(stats_client, std::move(event));
 }
 
 void reportHardwareFailed(const std::shared_ptr<IStats> &stats_client,
@@ -144,13 +519,11 @@ void reportHardwareFailed(const std::shared_ptr<IStats> &stats_client,
     tmp.set<VendorAtomValue::intValue>(failure.failure_code());
     values[2] = tmp;
 
-    // Send vendor atom to IStats HAL
+    // Queue vendor atom for the IStats HAL
     VendorAtom event = {.reverseDomainName = "",
                         .atomId = PixelAtoms::Atom::kVendorHardwareFailed,
                         .values = std::move(values)};
-    const ndk::ScopedAStatus ret = stats_client->reportVendorAtom(event);
-    if (!ret.isOk())
-        ALOGE("Unable to report VendorHardwareFailed to Stats service");
+    enqueueVendorAtom(stats_client, std::move(event));
 }
 
 void reportSpeechDspStat(const std::shared_ptr<IStats> &stats_client,
@@ -167,13 +540,11 @@ void reportSpeechDspStat(const std::shared_ptr<IStats> &stats_client,
     tmp.set<VendorAtomValue::intValue>(dsp_stats.total_recover_count());
     values[3] = tmp;
 
-    // Send vendor atom to IStats HAL
+    // Queue vendor atom for the IStats HAL
     VendorAtom event = {.reverseDomainName = "",
                         .atomId = PixelAtoms::Atom::kVendorSpeechDspStat,
                         .values = std::move(values)};
-    const ndk::ScopedAStatus ret = stats_client->reportVendorAtom(event);
-    if (!ret.isOk())
-        ALOGE("Unable to report VendorSpeechDspStat to Stats service");
+    enqueueVendorAtom(stats_client, std::move(event));
 }
 
 void reportUsbPortOverheat(const std::shared_ptr<IStats> &stats_client,
@@ -192,13 +563,11 @@ void reportUsbPortOverheat(const std::shared_ptr<IStats> &stats_client,
     tmp.set<VendorAtomValue::intValue>(overheat_info.time_to_inactive_secs());
     values[4] = tmp;
 
-    // Send vendor atom to IStats HAL
+    // Queue vendor atom for the IStats HAL
     VendorAtom event = {.reverseDomainName = "",
                         .atomId = PixelAtoms::Atom::kVendorUsbPortOverheat,
                         .values = std::move(values)};
-    const ndk::ScopedAStatus ret = stats_client->reportVendorAtom(event);
-    if (!ret.isOk())
-        ALOGE("Unable to report VendorUsbPortOverheat to Stats service");
+    enqueueVendorAtom(stats_client, std::move(event));
 }
 
 void reportUsbDataSessionEvent(const std::shared_ptr<IStats> &stats_client,
@@ -217,13 +586,11 @@ void reportUsbDataSessionEvent(const std::shared_ptr<IStats> &stats_client,
     tmp.set<VendorAtomValue::longValue>(usb_data_event.duration_ms());
     values[3] = tmp;
 
-    // Send vendor atom to IStats HAL
+    // Queue vendor atom for the IStats HAL
     VendorAtom event = {.reverseDomainName = "",
                         .atomId = PixelAtoms::Atom::kVendorUsbDataSessionEvent,
                         .values = std::move(values)};
-    const ndk::ScopedAStatus ret = stats_client->reportVendorAtom(event);
-    if (!ret.isOk())
-        ALOGE("Unable to report VendorUsbDataSessionEvent to Stats service");
+    enqueueVendorAtom(stats_client, std::move(event));
 }
 
 }  // namespace pixel
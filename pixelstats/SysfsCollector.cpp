@@ -28,10 +28,19 @@
 #include <utils/Timers.h>
 
 #include <mntent.h>
-#include <sys/timerfd.h>
+#include <pixelscheduler/WakeupScheduler.h>
+#include <poll.h>
+#include <sys/inotify.h>
 #include <sys/vfs.h>
+#include <algorithm>
+#include <atomic>
 #include <cinttypes>
+#include <functional>
+#include <mutex>
+#include <queue>
 #include <string>
+#include <thread>
+#include <vector>
 
 #ifndef ARRAY_SIZE
 #define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
@@ -62,6 +71,7 @@ using android::hardware::google::pixel::PixelAtoms::PartitionsUsedSpaceReported;
 using android::hardware::google::pixel::PixelAtoms::PcieLinkStatsReported;
 using android::hardware::google::pixel::PixelAtoms::StorageUfsHealth;
 using android::hardware::google::pixel::PixelAtoms::StorageUfsResetCount;
+using android::hardware::google::pixel::PixelAtoms::SysfsCollectorStallReported;
 using android::hardware::google::pixel::PixelAtoms::ThermalDfsStats;
 using android::hardware::google::pixel::PixelAtoms::VendorAudioAdaptedInfoStatsReported;
 using android::hardware::google::pixel::PixelAtoms::VendorAudioBtMediaStatsReported;
@@ -171,7 +181,7 @@ void SysfsCollector::logBatteryChargeCycles(const std::shared_ptr<IStats> &stats
         ALOGV("Battery charge cycle path not specified");
         return;
     }
-    if (!ReadFileToString(kCycleCountBinsPath, &file_contents)) {
+    if (!readSysfsCached(kCycleCountBinsPath, &file_contents)) {
         ALOGE("Unable to read battery charge cycles %s - %s", kCycleCountBinsPath, strerror(errno));
         return;
     }
@@ -2064,53 +2074,152 @@ void SysfsCollector::logMitigationDurationCounts(const std::shared_ptr<IStats> &
     mitigation_duration_reporter_.logMitigationDuration(stats_client, kPowerMitigationDurationPath);
 }
 
+/**
+ * Wall-time budget for a single reporter task. A reporter is expected to read
+ * a handful of sysfs nodes and make one IStats call; anything past this is a
+ * stall (e.g. the speaker codec path blocking on wedged amp firmware) and is
+ * reported through SysfsCollectorStallReported so it shows up in metrics
+ * instead of silently delaying the whole collection pass.
+ */
+constexpr int64_t kReporterDeadlineMs = 100;
+/* Worker threads used by runReporters(); bounds peak sysfs/binder concurrency. */
+constexpr size_t kReporterPoolSize = 4;
+
+void SysfsCollector::reportCollectorStall(const std::shared_ptr<IStats> &stats_client,
+                                          const char *name, int64_t duration_ms) {
+    VendorAtomValue tmp;
+    std::vector<VendorAtomValue> values(3);
+    tmp.set<VendorAtomValue::stringValue>(name);
+    values[SysfsCollectorStallReported::kReporterNameFieldNumber - kVendorAtomOffset] = tmp;
+    tmp.set<VendorAtomValue::intValue>(static_cast<int32_t>(duration_ms));
+    values[SysfsCollectorStallReported::kDurationMillisFieldNumber - kVendorAtomOffset] = tmp;
+    tmp.set<VendorAtomValue::intValue>(static_cast<int32_t>(kReporterDeadlineMs));
+    values[SysfsCollectorStallReported::kDeadlineMillisFieldNumber - kVendorAtomOffset] = tmp;
+
+    // Send vendor atom to IStats HAL
+    VendorAtom event = {.reverseDomainName = "",
+                        .atomId = PixelAtoms::Atom::kSysfsCollectorStallReported,
+                        .values = std::move(values)};
+    const ndk::ScopedAStatus ret = stats_client->reportVendorAtom(event);
+    if (!ret.isOk()) {
+        ALOGE("Unable to report collector stall to Stats service");
+    }
+}
+
+/**
+ * Run the given reporter tasks on a small worker pool so collection wall time
+ * approaches the slowest reporter rather than the sum of all of them. Each
+ * task's duration is measured against kReporterDeadlineMs; overruns are logged
+ * and reported once the pass completes. A stalled task still occupies its
+ * worker until it returns - the pool cannot preempt it - but the remaining
+ * workers keep the rest of the pass moving.
+ */
+void SysfsCollector::runReporters(const std::shared_ptr<IStats> &stats_client,
+                                  std::vector<ReporterTask> &&tasks) {
+    std::atomic<size_t> next(0);
+    std::mutex stall_lock;
+    std::vector<std::pair<const char *, int64_t>> stalls;
+
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < tasks.size(); i = next.fetch_add(1)) {
+            const nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+            tasks[i].fn();
+            const int64_t duration_ms = ns2ms(systemTime(SYSTEM_TIME_MONOTONIC) - start);
+            if (duration_ms > kReporterDeadlineMs) {
+                ALOGW("Reporter %s took %" PRId64 " ms (deadline %" PRId64 " ms)", tasks[i].name,
+                      duration_ms, kReporterDeadlineMs);
+                std::lock_guard<std::mutex> lock(stall_lock);
+                stalls.emplace_back(tasks[i].name, duration_ms);
+            }
+        }
+    };
+
+    // The calling thread is one of the workers.
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(kReporterPoolSize, tasks.size()); i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (const auto &stall : stalls) {
+        reportCollectorStall(stats_client, stall.first, stall.second);
+    }
+}
+
 void SysfsCollector::logPerDay() {
     const std::shared_ptr<IStats> stats_client = getStatsService();
     if (!stats_client) {
         ALOGE("Unable to get AIDL Stats service");
         return;
     }
-    // Collect once per service init; can be multiple due to service reinit
+    // Collect once per service init; can be multiple due to service reinit.
+    // Runs before the pool since it flips log_once_reported.
     if (!log_once_reported) {
         logBootStats(stats_client);
     }
-    logBatteryCapacity(stats_client);
-    logBatteryChargeCycles(stats_client);
-    logBatteryEEPROM(stats_client);
-    logBatteryHealth(stats_client);
-    logBlockStatsReported(stats_client);
-    logCodec1Failed(stats_client);
-    logCodecFailed(stats_client);
-    logDisplayStats(stats_client);
-    logDisplayPortStats(stats_client);
-    logHDCPStats(stats_client);
-    logF2fsStats(stats_client);
-    logF2fsAtomicWriteInfo(stats_client);
-    logF2fsCompressionInfo(stats_client);
-    logF2fsGcSegmentInfo(stats_client);
-    logF2fsSmartIdleMaintEnabled(stats_client);
-    logSlowIO(stats_client);
-    logSpeakerImpedance(stats_client);
-    logSpeechDspStat(stats_client);
-    logUFSLifetime(stats_client);
-    logUFSErrorStats(stats_client);
-    logSpeakerHealthStats(stats_client);
-    mm_metrics_reporter_.logCmaStatus(stats_client);
-    mm_metrics_reporter_.logPixelMmMetricsPerDay(stats_client);
-    logVendorAudioHardwareStats(stats_client);
-    logThermalStats(stats_client);
-    logTempResidencyStats(stats_client);
-    logVendorLongIRQStatsReported(stats_client);
-    logVendorResumeLatencyStats(stats_client);
-    logPartitionUsedSpace(stats_client);
-    logPcieLinkStats(stats_client);
-    logMitigationDurationCounts(stats_client);
-    logVendorAudioPdmStatsReported(stats_client);
-    logWavesStats(stats_client);
-    logAdaptedInfoStats(stats_client);
-    logPcmUsageStats(stats_client);
-    logOffloadEffectsStats(stats_client);
-    logBluetoothAudioUsage(stats_client);
+    // Calls sharing a reporter member (e.g. mm_metrics_reporter_) stay in one
+    // task; everything else may run concurrently. The shared sysfs read cache
+    // in StatsHelper is mutex-guarded, and the IStats proxy is thread-safe.
+    std::vector<ReporterTask> tasks = {
+            {"BatteryCapacity", [this, stats_client] { logBatteryCapacity(stats_client); }},
+            {"BatteryChargeCycles", [this, stats_client] { logBatteryChargeCycles(stats_client); }},
+            {"BatteryEEPROM", [this, stats_client] { logBatteryEEPROM(stats_client); }},
+            {"BatteryHealth", [this, stats_client] { logBatteryHealth(stats_client); }},
+            {"BlockStats", [this, stats_client] { logBlockStatsReported(stats_client); }},
+            {"Codec",
+             [this, stats_client] {
+                 logCodec1Failed(stats_client);
+                 logCodecFailed(stats_client);
+             }},
+            {"DisplayStats",
+             [this, stats_client] {
+                 logDisplayStats(stats_client);
+                 logDisplayPortStats(stats_client);
+                 logHDCPStats(stats_client);
+             }},
+            {"F2fsStats",
+             [this, stats_client] {
+                 logF2fsStats(stats_client);
+                 logF2fsAtomicWriteInfo(stats_client);
+                 logF2fsCompressionInfo(stats_client);
+                 logF2fsGcSegmentInfo(stats_client);
+                 logF2fsSmartIdleMaintEnabled(stats_client);
+             }},
+            {"SlowIO", [this, stats_client] { logSlowIO(stats_client); }},
+            {"SpeakerImpedance", [this, stats_client] { logSpeakerImpedance(stats_client); }},
+            {"SpeechDspStat", [this, stats_client] { logSpeechDspStat(stats_client); }},
+            {"UFSLifetime", [this, stats_client] { logUFSLifetime(stats_client); }},
+            {"UFSErrorStats", [this, stats_client] { logUFSErrorStats(stats_client); }},
+            {"SpeakerHealthStats", [this, stats_client] { logSpeakerHealthStats(stats_client); }},
+            {"MmMetrics",
+             [this, stats_client] {
+                 mm_metrics_reporter_.logCmaStatus(stats_client);
+                 mm_metrics_reporter_.logPixelMmMetricsPerDay(stats_client);
+             }},
+            {"VendorAudioHardwareStats",
+             [this, stats_client] { logVendorAudioHardwareStats(stats_client); }},
+            {"ThermalStats", [this, stats_client] { logThermalStats(stats_client); }},
+            {"TempResidencyStats", [this, stats_client] { logTempResidencyStats(stats_client); }},
+            {"VendorLongIRQStats",
+             [this, stats_client] { logVendorLongIRQStatsReported(stats_client); }},
+            {"VendorResumeLatencyStats",
+             [this, stats_client] { logVendorResumeLatencyStats(stats_client); }},
+            {"PartitionUsedSpace", [this, stats_client] { logPartitionUsedSpace(stats_client); }},
+            {"PcieLinkStats", [this, stats_client] { logPcieLinkStats(stats_client); }},
+            {"MitigationDurationCounts",
+             [this, stats_client] { logMitigationDurationCounts(stats_client); }},
+            {"VendorAudioPdmStats",
+             [this, stats_client] { logVendorAudioPdmStatsReported(stats_client); }},
+            {"WavesStats", [this, stats_client] { logWavesStats(stats_client); }},
+            {"AdaptedInfoStats", [this, stats_client] { logAdaptedInfoStats(stats_client); }},
+            {"PcmUsageStats", [this, stats_client] { logPcmUsageStats(stats_client); }},
+            {"OffloadEffectsStats", [this, stats_client] { logOffloadEffectsStats(stats_client); }},
+            {"BluetoothAudioUsage", [this, stats_client] { logBluetoothAudioUsage(stats_client); }},
+    };
+    runReporters(stats_client, std::move(tasks));
 }
 
 void SysfsCollector::aggregatePer5Min() {
@@ -2141,21 +2250,36 @@ void SysfsCollector::logPerHour() {
         ALOGE("Unable to get AIDL Stats service");
         return;
     }
-    mm_metrics_reporter_.logPixelMmMetricsPerHour(stats_client);
-    logZramStats(stats_client);
-    if (kPowerMitigationStatsPath != nullptr && strlen(kPowerMitigationStatsPath) > 0)
-        mitigation_stats_reporter_.logMitigationStatsPerHour(stats_client,
-                                                             kPowerMitigationStatsPath);
+    std::vector<ReporterTask> tasks = {
+            {"MmMetricsPerHour",
+             [this, stats_client] { mm_metrics_reporter_.logPixelMmMetricsPerHour(stats_client); }},
+            {"ZramStats", [this, stats_client] { logZramStats(stats_client); }},
+    };
+    if (kPowerMitigationStatsPath != nullptr && strlen(kPowerMitigationStatsPath) > 0) {
+        tasks.push_back({"MitigationStats", [this, stats_client] {
+                             mitigation_stats_reporter_.logMitigationStatsPerHour(
+                                     stats_client, kPowerMitigationStatsPath);
+                         }});
+    }
+    runReporters(stats_client, std::move(tasks));
 }
 
 /**
  * Loop forever collecting stats from sysfs nodes and reporting them via
  * IStats.
+ *
+ * Each source declares its natural period below and the shared
+ * libpixelscheduler deadline heap arms the timer for the earliest deadline
+ * only, so a wake happens exactly when some source is due. Deadlines sit on
+ * the scheduler's boottime-aligned grid, which other pixel daemons
+ * (perfstatsd) share, so their periodic wakes coalesce into the same window
+ * instead of each waking the SoC on its own phase. Event-driven sources
+ * register an inotify trigger and report when their file is written rather
+ * than on the next period.
  */
 void SysfsCollector::collect(void) {
-    int timerfd = timerfd_create(CLOCK_BOOTTIME, 0);
-    if (timerfd < 0) {
-        ALOGE("Unable to create timerfd - %s", strerror(errno));
+    WakeupScheduler scheduler;
+    if (!scheduler.valid()) {
         return;
     }
 
@@ -2163,6 +2287,7 @@ void SysfsCollector::collect(void) {
     sleep(30);
 
     // sample & aggregate for the first time.
+    invalidateSysfsCache();
     aggregatePer5Min();
 
     // Collect first set of stats on boot.
@@ -2170,66 +2295,71 @@ void SysfsCollector::collect(void) {
     logPerHour();
     logPerDay();
 
-    struct itimerspec period;
-
-    // gcd (greatest common divisor) of all the following timings
-    constexpr int kSecondsPerWake = 5 * 60;
-
-    constexpr int kWakesPer5Min = 5 * 60 / kSecondsPerWake;
-    constexpr int kWakesPerHour = 60 * 60 / kSecondsPerWake;
-    constexpr int kWakesPerDay = 24 * 60 * 60 / kSecondsPerWake;
+    scheduler.addPeriodic("aggregate-5min", 5 * 60, [this] { aggregatePer5Min(); });
+    scheduler.addPeriodic("per-hour", 60 * 60, [this] { logPerHour(); });
+    scheduler.addPeriodic("per-day", 24 * 60 * 60, [this] { logPerDay(); });
 
-    int wake_5min = 0;
-    int wake_hours = 0;
-    int wake_days = 0;
-
-    period.it_interval.tv_sec = kSecondsPerWake;
-    period.it_interval.tv_nsec = 0;
-    period.it_value.tv_sec = kSecondsPerWake;
-    period.it_value.tv_nsec = 0;
-
-    if (timerfd_settime(timerfd, 0, &period, NULL)) {
-        ALOGE("Unable to set one hour timer - %s", strerror(errno));
-        return;
+    // Brownout is event-driven: watch the log the detector writes and
+    // report as soon as it lands instead of once per boot.
+    int inotifyfd = inotify_init1(IN_CLOEXEC);
+    int brownout_wd = -1;
+    const char *brownout_path = nullptr;
+    if (kBrownoutCsvPath != nullptr && strlen(kBrownoutCsvPath) > 0)
+        brownout_path = kBrownoutCsvPath;
+    else if (kBrownoutLogPath != nullptr && strlen(kBrownoutLogPath) > 0)
+        brownout_path = kBrownoutLogPath;
+    if (inotifyfd >= 0 && brownout_path != nullptr) {
+        brownout_wd = inotify_add_watch(inotifyfd, brownout_path, IN_CLOSE_WRITE);
+        if (brownout_wd < 0)
+            ALOGI("Not watching %s - %s", brownout_path, strerror(errno));
     }
 
+    // PSI-triggered burst capture: when memory stalls cross the trigger
+    // threshold, snapshot the reclaim counters immediately instead of
+    // letting the spike dissolve into the next periodic sample.
+    int psi_trigger_fd = mm_metrics_reporter_.preparePsiMemoryTrigger();
+
     while (1) {
-        int readval;
-        union {
-            char buf[8];
-            uint64_t count;
-        } expire;
+        if (!scheduler.arm()) {
+            ALOGE("Unable to set collection timer");
+            return;
+        }
 
+        // Entries with a negative fd are ignored by poll().
+        struct pollfd fds[3] = {{scheduler.fd(), POLLIN, 0},
+                                {(brownout_wd >= 0) ? inotifyfd : -1, POLLIN, 0},
+                                {psi_trigger_fd, POLLPRI, 0}};
+        nfds_t nfds = 3;
+        int ret;
         do {
             errno = 0;
-            readval = read(timerfd, expire.buf, sizeof(expire.buf));
-        } while (readval < 0 && errno == EINTR);
-        if (readval < 0) {
+            ret = poll(fds, nfds, -1);
+        } while (ret < 0 && errno == EINTR);
+        if (ret < 0) {
             ALOGE("Timerfd error - %s\n", strerror(errno));
             return;
         }
 
-        wake_5min += expire.count;
-        wake_hours += expire.count;
-        wake_days += expire.count;
-
-        if (wake_5min >= kWakesPer5Min) {
-            wake_5min %= kWakesPer5Min;
-            aggregatePer5Min();
+        if (fds[0].revents & POLLIN) {
+            // Every task due on this wake sees one consistent snapshot of
+            // the nodes read through the shared cache.
+            invalidateSysfsCache();
+            scheduler.dispatch();
         }
 
-        if (wake_hours >= kWakesPerHour) {
-            if (wake_hours >= 2 * kWakesPerHour)
-                ALOGW("Hourly wake: sleep too much: expire.count=%" PRId64, expire.count);
-            wake_hours %= kWakesPerHour;
-            logPerHour();
+        if (fds[1].fd >= 0 && (fds[1].revents & POLLIN)) {
+            char buf[512];
+            read(inotifyfd, buf, sizeof(buf));
+            logBrownout();
         }
 
-        if (wake_days >= kWakesPerDay) {
-            if (wake_hours >= 2 * kWakesPerDay)
-                ALOGW("Daily wake: sleep too much: expire.count=%" PRId64, expire.count);
-            wake_days %= kWakesPerDay;
-            logPerDay();
+        if (fds[2].fd >= 0) {
+            if (fds[2].revents & POLLPRI) {
+                mm_metrics_reporter_.logPsiBurstSnapshot();
+            } else if (fds[2].revents & POLLERR) {
+                ALOGE("PSI trigger fd error, disabling burst capture");
+                psi_trigger_fd = -1;
+            }
         }
     }
 }
@@ -21,9 +21,13 @@
 #include <android-base/file.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
+#include <android-base/unique_fd.h>
 #include <android/binder_manager.h>
+#include <fcntl.h>
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
+#include <pixelstats/StatsHelper.h>
 #include <pixelstats/TempResidencyReporter.h>
+#include <string.h>
 #include <utils/Log.h>
 
 #include <cinttypes>
@@ -45,10 +49,27 @@ bool updateOffsetAndCheckBound(int *offset, const int &bytes_read, const int &da
     return *offset <= data_len;
 }
 
+/**
+ * Cheap pre-check for logTempResidencyStats(): a populated residency node
+ * starts with a "THERMAL ZONE:" header, so peeking at the first bytes tells
+ * whether there is anything to parse without pulling in the whole blob.
+ * An open failure reports as "has data" so the full path logs the error.
+ */
+static bool hasResidencyData(std::string_view path) {
+    static constexpr char kHeader[] = "THERMAL ZONE:";
+    char head[sizeof(kHeader) - 1];
+    android::base::unique_fd fd(TEMP_FAILURE_RETRY(open(path.data(), O_RDONLY | O_CLOEXEC)));
+    if (fd < 0) {
+        return true;
+    }
+    ssize_t len = TEMP_FAILURE_RETRY(read(fd.get(), head, sizeof(head)));
+    return len == sizeof(head) && memcmp(head, kHeader, sizeof(head)) == 0;
+}
+
 /**
  * Parse file_contents and read residency stats into stats.
  */
-bool parse_file_contents(std::string file_contents,
+bool parse_file_contents(const std::string &file_contents,
                          std::map<std::string, TempResidencyStats> *stats) {
     const char *data = file_contents.c_str();
     int data_len = file_contents.length();
@@ -91,6 +112,8 @@ bool parse_file_contents(std::string file_contents,
             !updateOffsetAndCheckBound(&offset, bytes_read, data_len))
             return false;
 
+        temp_residency_stats.temp_residency_buckets.reserve(num_stats_buckets);
+
         while (index < num_stats_buckets) {
             if (sscanf(data + offset, "-inf - %*d ====> %" PRId64 "ms\n%n", &temp_res_value,
                        &bytes_read) != 1 &&
@@ -107,7 +130,7 @@ bool parse_file_contents(std::string file_contents,
             if ((offset >= data_len) && (index < num_stats_buckets))
                 return false;
         }
-        (*stats)[sensor_name_str] = temp_residency_stats;
+        (*stats)[sensor_name_str] = std::move(temp_residency_stats);
     }
     return true;
 }
@@ -122,6 +145,10 @@ void TempResidencyReporter::logTempResidencyStats(
         ALOGV("TempResidency Stats/Reset path not specified");
         return;
     }
+    if (!hasResidencyData(temperature_residency_path)) {
+        ALOGV("No TempResidencyStats to report");
+        return;
+    }
     std::string file_contents;
     if (!ReadFileToString(temperature_residency_path.data(), &file_contents)) {
         ALOGE("Unable to read TempResidencyStatsPath");
@@ -151,6 +178,7 @@ void TempResidencyReporter::logTempResidencyStats(
     // Iterate through stats_map by sensor_name
     while (stats_map_iterator != stats_map.end()) {
         std::vector<VendorAtomValue> values;
+        values.reserve(kMaxBucketLen + 6);
         const auto &sensor_name_str = stats_map_iterator->first;
         const auto &temp_residency_stats = stats_map_iterator->second;
         const auto &temp_residency_buckets_count =
@@ -182,13 +210,12 @@ void TempResidencyReporter::logTempResidencyStats(
         values.push_back(tmp_atom_value);
         tmp_atom_value.set<VendorAtomValue::longValue>(temp_residency_stats.min_temp_timestamp);
         values.push_back(tmp_atom_value);
-        //  Send vendor atom to IStats HAL
+        //  Queue vendor atom for the IStats HAL; the whole per-zone burst
+        //  drains in one pass on the batcher thread.
         VendorAtom event = {.reverseDomainName = "",
                             .atomId = PixelAtoms::Atom::kVendorTempResidencyStats,
                             .values = std::move(values)};
-        ndk::ScopedAStatus ret = stats_client->reportVendorAtom(event);
-        if (!ret.isOk())
-            ALOGE("Unable to report VendorTempResidencyStats to Stats service");
+        enqueueVendorAtom(stats_client, std::move(event));
 
         stats_map_iterator++;
     }
@@ -45,17 +45,22 @@
 #include <cutils/uevent.h>
 #include <fcntl.h>
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
+#include <linux/filter.h>
 #include <linux/thermal.h>
 #include <log/log.h>
 #include <pixelstats/StatsHelper.h>
 #include <pixelstats/UeventListener.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include <utils/StrongPointer.h>
 
+#include <algorithm>
+#include <array>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace android {
 namespace hardware {
@@ -73,7 +78,6 @@ using android::hardware::google::pixel::PixelAtoms::ThermalSensorAbnormalityDete
 using android::hardware::google::pixel::PixelAtoms::VendorHardwareFailed;
 using android::hardware::google::pixel::PixelAtoms::VendorUsbPortOverheat;
 
-constexpr int32_t UEVENT_MSG_LEN = 2048;  // it's 2048 in all other users.
 constexpr int32_t PRODUCT_TYPE_OFFSET = 23;
 constexpr int32_t PRODUCT_TYPE_MASK = 7;
 constexpr int32_t PRODUCT_TYPE_CHARGER = 3;
@@ -85,6 +89,63 @@ constexpr uint32_t PID_P30 = 0x4f05;
 constexpr const char *THERMAL_ABNORMAL_INFO_EQ = "THERMAL_ABNORMAL_INFO=";
 constexpr const char *THERMAL_ABNORMAL_TYPE_EQ = "THERMAL_ABNORMAL_TYPE=";
 
+namespace {
+
+// Slots for the key/value tokens ProcessUevent cares about.
+enum UeventSlot {
+    kSlotDriver,
+    kSlotDevpath,
+    kSlotSubsystem,
+    kSlotMicBreakStatus,
+    kSlotMicDegradeStatus,
+    kSlotGpuEventType,
+    kSlotGpuEventInfo,
+    kSlotThermalAbnormalType,
+    kSlotThermalAbnormalInfo,
+    kNumUeventSlots,
+};
+
+struct UeventMatcher {
+    const char *key;  // including the trailing '='
+    uint8_t len;
+    uint8_t slot;
+};
+
+// Sorted by the first byte of the key so kFirstByteRange below can hand
+// each token a contiguous candidate range.
+constexpr UeventMatcher kUeventMatchers[] = {
+        {"DEVPATH=", 8, kSlotDevpath},
+        {"DRIVER=", 7, kSlotDriver},
+        {"GPU_UEVENT_INFO=", 16, kSlotGpuEventInfo},
+        {"GPU_UEVENT_TYPE=", 16, kSlotGpuEventType},
+        {"MIC_BREAK_STATUS=", 17, kSlotMicBreakStatus},
+        {"MIC_DEGRADE_STATUS=", 19, kSlotMicDegradeStatus},
+        {"SUBSYSTEM=", 10, kSlotSubsystem},
+        {"THERMAL_ABNORMAL_INFO=", 22, kSlotThermalAbnormalInfo},
+        {"THERMAL_ABNORMAL_TYPE=", 22, kSlotThermalAbnormalType},
+};
+
+struct UeventMatcherRange {
+    uint8_t begin;
+    uint8_t end;
+};
+
+// First-byte dispatch: almost every token of a non-matching event (>99% of
+// traffic during USB enumeration storms) is rejected on its first byte
+// without any strncmp at all.
+const std::array<UeventMatcherRange, 256> kFirstByteRange = [] {
+    std::array<UeventMatcherRange, 256> ranges{};
+    for (uint8_t i = 0; i < std::size(kUeventMatchers); i++) {
+        UeventMatcherRange &range = ranges[static_cast<uint8_t>(kUeventMatchers[i].key[0])];
+        if (range.end == 0)
+            range.begin = i;
+        range.end = i + 1;
+    }
+    return ranges;
+}();
+
+}  // namespace
+
 bool UeventListener::ReadFileToInt(const std::string &path, int *val) {
     return ReadFileToInt(path.c_str(), val);
 }
@@ -116,7 +177,7 @@ void UeventListener::ReportMicStatusUevents(const std::shared_ptr<IStats> &stats
                                             const char *devpath, const char *mic_status) {
     if (!devpath || !mic_status)
         return;
-    if (!strcmp(devpath, ("DEVPATH=" + kAudioUevent).c_str())) {
+    if (!strcmp(devpath, kAudioDevPath.c_str())) {
         std::vector<std::string> value = android::base::Split(mic_status, "=");
         bool isbroken;
 
@@ -396,15 +457,80 @@ void UeventListener::ReportThermalAbnormalEvent(const std::shared_ptr<IStats> &s
         ALOGE("Unable to report Thermal Abnormal event.");
 }
 
+/**
+ * Kernel-side uevent filtering. The daemon only acts on a handful of token
+ * families, but without a socket filter it is woken for every uevent in the
+ * system (block, cgroup, ...). Classic BPF has no loops, so the filter is an
+ * unrolled scan: at every byte offset of the message it compares one 32-bit
+ * word against the 4-byte signatures below and accepts on any hit. Absolute
+ * loads past the end of a short message make the kernel drop it, which is
+ * exactly the "scanned everything, nothing matched" verdict; messages longer
+ * than the scan window fall through to the final accept, so the filter can
+ * delay nothing we would have acted on - the interesting traffic is either
+ * matched or passed through, and only short irrelevant events (the vast
+ * majority of the storm traffic) are dropped without a wakeup.
+ */
+void UeventListener::AttachUeventFilter(int fd) const {
+    // One signature per family ProcessUevent matches on:
+    //   "powe" - SUBSYSTEM=power_supply and power_supply devpaths
+    //   "goog" - DRIVER=google,battery / DRIVER=google,overheat_mitigation
+    //   "=max" - DRIVER=max77779-fg / maxfg / max1720x fuel gauges
+    //   "mali" - DRIVER=mali* GPU events
+    //   "MIC_" - MIC_BREAK_STATUS= / MIC_DEGRADE_STATUS=
+    //   "THER" - THERMAL_ABNORMAL_TYPE= / THERMAL_ABNORMAL_INFO=
+    std::vector<std::string> needles = {"powe", "goog", "=max", "mali", "MIC_", "THER"};
+
+    // The Type-C partner key is configurable; filter on the first 4 bytes of
+    // its value ("DEVTYPE=" itself would match nearly everything).
+    const size_t partner_value = kTypeCPartnerUevent.find('=');
+    if (partner_value != std::string::npos &&
+        kTypeCPartnerUevent.size() >= partner_value + 1 + 4) {
+        std::string needle = kTypeCPartnerUevent.substr(partner_value + 1, 4);
+        if (std::find(needles.begin(), needles.end(), needle) == needles.end()) {
+            needles.push_back(needle);
+        }
+    }
+
+    // Window sized to stay under the classic-BPF instruction limit (4096):
+    // each offset costs needles.size() + 2 instructions.
+    constexpr size_t kScanWindow = 384;
+
+    std::vector<struct sock_filter> insns;
+    insns.reserve(kScanWindow * (needles.size() + 2) + 1);
+    for (size_t off = 0; off < kScanWindow; off++) {
+        insns.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, off));
+        for (size_t i = 0; i < needles.size(); i++) {
+            const uint8_t c0 = needles[i][0], c1 = needles[i][1];
+            const uint8_t c2 = needles[i][2], c3 = needles[i][3];
+            const uint32_t word = (static_cast<uint32_t>(c0) << 24) |
+                                  (static_cast<uint32_t>(c1) << 16) |
+                                  (static_cast<uint32_t>(c2) << 8) | c3;
+            // On a hit, jump over the remaining compares and the skip below,
+            // landing on this block's accept.
+            insns.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, word,
+                                     static_cast<uint8_t>(needles.size() - i), 0));
+        }
+        insns.push_back(BPF_STMT(BPF_JMP | BPF_JA, 1));  // no hit: next offset
+        insns.push_back(BPF_STMT(BPF_RET | BPF_K, 0xFFFFFFFF));
+    }
+    // Longer than the scan window: accept rather than risk dropping a match
+    // past the window.
+    insns.push_back(BPF_STMT(BPF_RET | BPF_K, 0xFFFFFFFF));
+
+    struct sock_fprog prog = {
+            .len = static_cast<unsigned short>(insns.size()),
+            .filter = insns.data(),
+    };
+    if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog))) {
+        ALOGE("Unable to attach uevent socket filter - %s", strerror(errno));
+    }
+}
+
 bool UeventListener::ProcessUevent() {
-    char msg[UEVENT_MSG_LEN + 2];
     char *cp;
-    const char *driver, *product, *subsystem;
-    const char *mic_break_status, *mic_degrade_status;
-    const char *devpath;
+    const char *fields[kNumUeventSlots] = {};
     bool collect_partner_id = false;
-    const char *gpu_event_type = nullptr, *gpu_event_info = nullptr;
-    const char *thermal_abnormal_event_type = nullptr, *thermal_abnormal_event_info = nullptr;
+    bool any_match = false;
     int n;
 
     if (uevent_fd_ < 0) {
@@ -413,6 +539,11 @@ bool UeventListener::ProcessUevent() {
             ALOGE("uevent_init: uevent_open_socket failed\n");
             return false;
         }
+#ifndef LOG_UEVENTS_TO_FILE_ONLY_FOR_DEVEL
+        // Not attached when uevent logging is compiled in: the log is meant
+        // to capture everything.
+        AttachUeventFilter(uevent_fd_);
+#endif
     }
 
 #ifdef LOG_UEVENTS_TO_FILE_ONLY_FOR_DEVEL
@@ -424,73 +555,75 @@ bool UeventListener::ProcessUevent() {
     }
 #endif
 
-    n = uevent_kernel_multicast_recv(uevent_fd_, msg, UEVENT_MSG_LEN);
-    if (n <= 0 || n >= UEVENT_MSG_LEN)
+    n = uevent_kernel_multicast_recv(uevent_fd_, uevent_msg_, kUeventMsgLen);
+    if (n <= 0 || n >= kUeventMsgLen)
         return false;
 
-    // Ensure double-null termination of msg.
-    msg[n] = '\0';
-    msg[n + 1] = '\0';
-
-    driver = product = subsystem = NULL;
-    mic_break_status = mic_degrade_status = devpath = NULL;
+    // Ensure double-null termination of the message.
+    uevent_msg_[n] = '\0';
+    uevent_msg_[n + 1] = '\0';
 
     /**
-     * msg is a sequence of null-terminated strings.
-     * Iterate through and record positions of string/value pairs of interest.
-     * Double null indicates end of the message. (enforced above).
+     * The message is a sequence of null-terminated strings. Tokenize in
+     * place and record positions of key/value pairs of interest; each token
+     * is dispatched on its first byte so uninteresting ones are dropped
+     * without a compare. Double null indicates end of the message (enforced
+     * above).
      */
-    cp = msg;
+    cp = uevent_msg_;
     while (*cp) {
         if (log_fd_ > 0) {
             write(log_fd_, cp, strlen(cp));
             write(log_fd_, "\n", 1);
         }
-        if (!strncmp(cp, "DRIVER=", strlen("DRIVER="))) {
-            driver = cp;
-        } else if (!strncmp(cp, "PRODUCT=", strlen("PRODUCT="))) {
-            product = cp;
-        } else if (!strncmp(cp, "MIC_BREAK_STATUS=", strlen("MIC_BREAK_STATUS="))) {
-            mic_break_status = cp;
-        } else if (!strncmp(cp, "MIC_DEGRADE_STATUS=", strlen("MIC_DEGRADE_STATUS="))) {
-            mic_degrade_status = cp;
-        } else if (!strncmp(cp, "DEVPATH=", strlen("DEVPATH="))) {
-            devpath = cp;
-        } else if (!strncmp(cp, "SUBSYSTEM=", strlen("SUBSYSTEM="))) {
-            subsystem = cp;
-        } else if (!strncmp(cp, kTypeCPartnerUevent.c_str(), kTypeCPartnerUevent.size())) {
+        const UeventMatcherRange &range = kFirstByteRange[static_cast<uint8_t>(*cp)];
+        for (uint8_t i = range.begin; i < range.end; i++) {
+            const UeventMatcher &matcher = kUeventMatchers[i];
+            if (!strncmp(cp, matcher.key, matcher.len)) {
+                fields[matcher.slot] = cp;
+                any_match = true;
+                break;
+            }
+        }
+        // The partner uevent key is configurable, so it lives outside the
+        // static table; reject on the first byte all the same.
+        if (*cp == kTypeCPartnerUevent[0] &&
+            !strncmp(cp, kTypeCPartnerUevent.c_str(), kTypeCPartnerUevent.size())) {
             collect_partner_id = true;
-        } else if (!strncmp(cp, "GPU_UEVENT_TYPE=", strlen("GPU_UEVENT_TYPE="))) {
-            gpu_event_type = cp;
-        } else if (!strncmp(cp, "GPU_UEVENT_INFO=", strlen("GPU_UEVENT_INFO="))) {
-            gpu_event_info = cp;
-        } else if (!strncmp(cp, THERMAL_ABNORMAL_TYPE_EQ, strlen(THERMAL_ABNORMAL_TYPE_EQ))) {
-            thermal_abnormal_event_type = cp;
-        } else if (!strncmp(cp, THERMAL_ABNORMAL_INFO_EQ, strlen(THERMAL_ABNORMAL_INFO_EQ))) {
-            thermal_abnormal_event_info = cp;
         }
         /* advance to after the next \0 */
         while (*cp++) {
         }
     }
 
+    // The common case during uevent storms: nothing of interest in the
+    // event. Bail out before touching the Stats service.
+    if (!any_match && !collect_partner_id) {
+        if (log_fd_ > 0) {
+            write(log_fd_, "\n", 1);
+        }
+        return true;
+    }
+
     std::shared_ptr<IStats> stats_client = getStatsService();
     if (!stats_client) {
         ALOGE("Unable to get Stats service instance.");
     } else {
         /* Process the strings recorded. */
-        ReportMicStatusUevents(stats_client, devpath, mic_break_status);
-        ReportMicStatusUevents(stats_client, devpath, mic_degrade_status);
-        ReportUsbPortOverheatEvent(stats_client, driver);
-        ReportChargeMetricsEvent(stats_client, driver);
-        ReportBatteryCapacityFGEvent(stats_client, subsystem);
+        ReportMicStatusUevents(stats_client, fields[kSlotDevpath], fields[kSlotMicBreakStatus]);
+        ReportMicStatusUevents(stats_client, fields[kSlotDevpath], fields[kSlotMicDegradeStatus]);
+        ReportUsbPortOverheatEvent(stats_client, fields[kSlotDriver]);
+        ReportChargeMetricsEvent(stats_client, fields[kSlotDriver]);
+        ReportBatteryCapacityFGEvent(stats_client, fields[kSlotSubsystem]);
         if (collect_partner_id) {
             ReportTypeCPartnerId(stats_client);
         }
-        ReportGpuEvent(stats_client, driver, gpu_event_type, gpu_event_info);
-        ReportThermalAbnormalEvent(stats_client, devpath, thermal_abnormal_event_type,
-                                   thermal_abnormal_event_info);
-        ReportFGMetricsEvent(stats_client, driver);
+        ReportGpuEvent(stats_client, fields[kSlotDriver], fields[kSlotGpuEventType],
+                       fields[kSlotGpuEventInfo]);
+        ReportThermalAbnormalEvent(stats_client, fields[kSlotDevpath],
+                                   fields[kSlotThermalAbnormalType],
+                                   fields[kSlotThermalAbnormalInfo]);
+        ReportFGMetricsEvent(stats_client, fields[kSlotDriver]);
     }
 
     if (log_fd_ > 0) {
@@ -508,6 +641,7 @@ UeventListener::UeventListener(const std::string audio_uevent, const std::string
                                const std::string fw_update_path,
                                const std::vector<std::string> fg_modelloading_path)
     : kAudioUevent(audio_uevent),
+      kAudioDevPath("DEVPATH=" + audio_uevent),
       kBatterySSOCPath(ssoc_details_path),
       kUsbPortOverheatPath(overheat_path),
       kChargeMetricsPath(charge_metrics_path),
@@ -522,6 +656,7 @@ UeventListener::UeventListener(const std::string audio_uevent, const std::string
 
 UeventListener::UeventListener(const struct UeventPaths &uevents_paths)
     : kAudioUevent((uevents_paths.AudioUevent == nullptr) ? "" : uevents_paths.AudioUevent),
+      kAudioDevPath("DEVPATH=" + kAudioUevent),
       kBatterySSOCPath((uevents_paths.SsocDetailsPath == nullptr) ? ssoc_details_path
                                                                   : uevents_paths.SsocDetailsPath),
       kUsbPortOverheatPath((uevents_paths.OverheatPath == nullptr) ? overheat_path_default
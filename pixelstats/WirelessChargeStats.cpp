@@ -22,6 +22,7 @@
 #include <android-base/strings.h>
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
 #include <log/log.h>
+#include <pixelstats/StatsHelper.h>
 #include <pixelstats/WirelessChargeStats.h>
 
 namespace android {
@@ -53,15 +54,13 @@ int WirelessChargeStats::TranslateSysModeToAtomValue(const int sys_mode) {
 }
 
 bool WirelessChargeStats::CheckWirelessContentsAndAck(std::string *file_contents) {
-    std::string line;
-    std::istringstream ss;
+    std::string_view remaining, line;
 
     if (!ReadFileToString(kWirelessChargeMetricsPath.c_str(), file_contents))
         return false;
 
-    ss.str(*file_contents);
-
-    if (!std::getline(ss, line)) {
+    remaining = *file_contents;
+    if (!getNextLine(&remaining, &line)) {
         ALOGE("Unable to read first line %s - %s", kWirelessChargeMetricsPath.c_str(),
               strerror(errno));
         return false;
@@ -102,16 +101,15 @@ void WirelessChargeStats::CalculateWirelessChargeMetrics(const int pout_min, con
 
 void WirelessChargeStats::CalculateWirelessChargeStats(const int ssoc_tmp,
                                                        const std::string file_contents) {
-    std::string line;
-    std::istringstream ss;
+    std::string_view remaining(file_contents), line;
 
     ResetChargeMetrics();
-    ss.str(file_contents);
 
-    while (std::getline(ss, line)) {
+    while (getNextLine(&remaining, &line)) {
         int32_t buf[11] = {0};
-        if (sscanf(line.c_str(), "%d:%d, %d,%d,%d, %d,%d, %d,%d,%d,%d", &buf[0], &buf[1], &buf[2],
-                   &buf[3], &buf[4], &buf[5], &buf[6], &buf[7], &buf[8], &buf[9], &buf[10]) == 11) {
+        if (scanLine(line, "%d:%d, %d,%d,%d, %d,%d, %d,%d,%d,%d", &buf[0], &buf[1], &buf[2],
+                     &buf[3], &buf[4], &buf[5], &buf[6], &buf[7], &buf[8], &buf[9],
+                     &buf[10]) == 11) {
             const int32_t soc = buf[0];
 
             /* calculate wireless charge stats of next voltage tier */
@@ -119,7 +117,8 @@ void WirelessChargeStats::CalculateWirelessChargeStats(const int ssoc_tmp,
                 const int32_t alignment = buf[6];
 
                 if (alignment >= 0 && alignment < 100)
-                    ALOGD("WirelessChargeStats: misalignment %s", line.c_str());
+                    ALOGD("WirelessChargeStats: misalignment %.*s", static_cast<int>(line.size()),
+                          line.data());
 
                 CalculateWirelessChargeMetrics(buf[2], buf[3], buf[4], buf[5], buf[6]);
                 if (soc >= ssoc_tmp) {
@@ -0,0 +1,283 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Cost benchmarks for the hot pixelstats reporters, run against a synthetic
+ * sysfs tree with production-shaped contents. The existing tests in
+ * pixelstats/test cover correctness; these hold the daemon's per-cycle
+ * budget (<10 ms) against regressions.
+ *
+ * Notes:
+ *  - Individual reporter benchmarks feed atoms into a no-op IStats sink, so
+ *    they time collection and parsing, not the statsd round trip.
+ *  - The SysfsCollector pass benchmarks go through the real IStats service
+ *    (the pass looks the service up itself) and report synthetic atoms to
+ *    it; run them on dev devices only.
+ *  - MmMetricsReporter reads fixed /proc and /sys paths that are not
+ *    injectable, so its benchmarks measure against the live kernel nodes.
+ *  - BatteryEEPROMReporter persists its upload snapshot under
+ *    /data/vendor/pixelstats; on a device running the real daemon this
+ *    clobbers that snapshot, which at worst causes one redundant re-upload.
+ */
+
+#define LOG_TAG "pixelstats-benchmark"
+
+#include <aidl/android/frameworks/stats/BnStats.h>
+#include <android-base/file.h>
+#include <android-base/properties.h>
+#include <benchmark/benchmark.h>
+#include <pixelstats/BatteryEEPROMReporter.h>
+#include <pixelstats/BrownoutDetectedReporter.h>
+#include <pixelstats/ChargeStatsReporter.h>
+#include <pixelstats/MmMetricsReporter.h>
+#include <pixelstats/SysfsCollector.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+namespace android {
+namespace hardware {
+namespace google {
+namespace pixel {
+
+using aidl::android::frameworks::stats::BnStats;
+using aidl::android::frameworks::stats::IStats;
+using aidl::android::frameworks::stats::VendorAtom;
+
+namespace {
+
+/* IStats sink that discards every atom. */
+class NoopStats : public BnStats {
+  public:
+    ndk::ScopedAStatus reportVendorAtom(const VendorAtom & /* vendorAtom */) override {
+        return ndk::ScopedAStatus::ok();
+    }
+};
+
+std::shared_ptr<IStats> noopStats() {
+    static std::shared_ptr<IStats> client = ndk::SharedRefBase::make<NoopStats>();
+    return client;
+}
+
+/*
+ * Synthetic sysfs tree under a temporary directory. file() seeds (or
+ * re-seeds) a node and returns a stable path to it, so reporters that
+ * consume-and-ack their input can be re-armed between iterations.
+ */
+class SysfsFixture {
+  public:
+    const char *file(const std::string &name, const std::string &contents) {
+        std::string &path = paths_[name];
+        if (path.empty())
+            path = std::string(dir_.path) + "/" + name;
+        android::base::WriteStringToFile(contents, path);
+        return path.c_str();
+    }
+
+    /* gsx01-shaped v2 battery history: 75 entries of 31 bytes. */
+    std::string eepromHistory() {
+        std::string contents;
+        for (int i = 0; i < 75; i++) {
+            contents += "aabbccdd112233 445566 778899 a\n";
+        }
+        return contents;
+    }
+
+    /* Charge session head line: capacity tiers then tier coulomb counts. */
+    std::string chargeStats() { return "1,98,56, 1650000,4350000,250000,4400000\n"; }
+
+    /* Brownout mitigation CSV: header plus rows of timestamp, trigger and
+     * per-channel DVFS/ODPM samples. */
+    std::string brownoutCsv() {
+        std::string contents = "timestamp,irq,soc,temp,cycle,voltage,odpm_irq";
+        for (int i = 0; i < 29; i++) {
+            contents += ",ch" + std::to_string(i);
+        }
+        contents += "\n";
+        for (int row = 0; row < 16; row++) {
+            std::string line = "2024-01-01 00:00:01.123,0,85,298,123,3900,0";
+            for (int i = 0; i < 29; i++) {
+                line += "," + std::to_string(1000 + row * 29 + i);
+            }
+            contents += line + "\n";
+        }
+        return contents;
+    }
+
+  private:
+    TemporaryDir dir_;
+    std::map<std::string, std::string> paths_;  // node name -> stable path
+};
+
+SysfsFixture *fixture() {
+    static SysfsFixture fixture;
+    return &fixture;
+}
+
+}  // namespace
+
+/* Benchmark seam: drives one collection pass without entering collect()'s
+ * poll loop. Granted friendship by SysfsCollector. */
+class SysfsCollectorPeer {
+  public:
+    static void logPerDay(SysfsCollector *collector) { collector->logPerDay(); }
+    static void logPerHour(SysfsCollector *collector) { collector->logPerHour(); }
+};
+
+namespace {
+
+/* Every path the collector dereferences points into the fixture or at an
+ * empty string (skipped or fails the read gracefully) - never nullptr. */
+SysfsCollector::SysfsPaths fixturePaths() {
+    SysfsFixture *fix = fixture();
+    return {
+            .SlowioReadCntPath = fix->file("slowio_read_cnt", "17\n"),
+            .SlowioWriteCntPath = fix->file("slowio_write_cnt", "4\n"),
+            .SlowioUnmapCntPath = fix->file("slowio_unmap_cnt", "0\n"),
+            .SlowioSyncCntPath = fix->file("slowio_sync_cnt", "2\n"),
+            .CycleCountBinsPath = fix->file("cycle_count_bins", "152 134 64 12 3 0 0 0 0 0\n"),
+            .ImpedancePath = fix->file("impedance", "32100,32400\n"),
+            .CodecPath = fix->file("codec_state", "0\n"),
+            .Codec1Path = fix->file("codec1_state", "0\n"),
+            .SpeechDspPath = fix->file("speech_dsp", "1000 2000 300 4\n"),
+            .BatteryCapacityCC = fix->file("capacity_cc", "9560\n"),
+            .BatteryCapacityVFSOC = fix->file("capacity_vfsoc", "9530\n"),
+            .UFSLifetimeA = fix->file("ufs_lifetime_a", "5\n"),
+            .UFSLifetimeB = fix->file("ufs_lifetime_b", "3\n"),
+            .UFSLifetimeC = fix->file("ufs_lifetime_c", "1\n"),
+            .F2fsStatsPath = "",
+            .UserdataBlockProp = "",
+            .ZramMmStatPath = "",
+            .ZramBdStatPath = "",
+            .EEPROMPath = fix->file("eeprom_history", fix->eepromHistory()),
+            .MitigationPath = "",
+            .MitigationDurationPath = "",
+            .BrownoutCsvPath = "",
+            .BrownoutLogPath = "",
+            .BrownoutReasonProp = "",
+            .SpeakerTemperaturePath = fix->file("speaker_temp", "30.1,30.2\n"),
+            .SpeakerExcursionPath = fix->file("speaker_excursion", "0.1,0.2\n"),
+            .SpeakerHeartBeatPath = fix->file("speaker_heartbeat", "100,100\n"),
+            .UFSErrStatsPath = {},
+            .BlockStatsLength = 0,
+            .AmsRatePath = "",
+            .ThermalStatsPaths = {},
+            .DisplayStatsPaths = {},
+            .DisplayPortStatsPaths = {},
+            .HDCPStatsPaths = {},
+            .CCARatePath = "",
+            .TempResidencyAndResetPaths = {},
+            .LongIRQMetricsPath = "",
+            .StormIRQMetricsPath = "",
+            .IRQStatsResetPath = "",
+            .ResumeLatencyMetricsPath = "",
+            .ModemPcieLinkStatsPath = "",
+            .WifiPcieLinkStatsPath = "",
+            .PDMStatePath = "",
+            .WavesPath = "",
+            .AdaptedInfoCountPath = "",
+            .AdaptedInfoDurationPath = "",
+            .PcmLatencyPath = "",
+            .PcmCountPath = "",
+            .TotalCallCountPath = "",
+            .OffloadEffectsIdPath = "",
+            .OffloadEffectsDurationPath = "",
+            .BluetoothAudioUsagePath = "",
+            .GMSRPath = {},
+    };
+}
+
+void BM_SysfsCollectorPerDay(benchmark::State &state) {
+    SysfsCollector::SysfsPaths paths = fixturePaths();
+    SysfsCollector collector(paths);
+    for (auto _ : state) {
+        SysfsCollectorPeer::logPerDay(&collector);
+    }
+}
+BENCHMARK(BM_SysfsCollectorPerDay);
+
+void BM_SysfsCollectorPerHour(benchmark::State &state) {
+    SysfsCollector::SysfsPaths paths = fixturePaths();
+    SysfsCollector collector(paths);
+    for (auto _ : state) {
+        SysfsCollectorPeer::logPerHour(&collector);
+    }
+}
+BENCHMARK(BM_SysfsCollectorPerHour);
+
+void BM_BatteryEEPROMReporter(benchmark::State &state) {
+    std::string path = fixture()->file("eeprom_history", fixture()->eepromHistory());
+    for (auto _ : state) {
+        /* Fresh reporter each round: checkAndReport rate-limits per
+         * instance to one upload a month. */
+        BatteryEEPROMReporter reporter;
+        reporter.checkAndReport(noopStats(), path);
+    }
+}
+BENCHMARK(BM_BatteryEEPROMReporter);
+
+void BM_ChargeStatsReporter(benchmark::State &state) {
+    for (auto _ : state) {
+        state.PauseTiming();
+        /* checkAndReport consumes the session (clears the file), so re-arm
+         * it and reset the per-instance event rate limit. */
+        std::string path = fixture()->file("charge_stats", fixture()->chargeStats());
+        ChargeStatsReporter reporter;
+        state.ResumeTiming();
+        reporter.checkAndReport(noopStats(), path);
+    }
+}
+BENCHMARK(BM_ChargeStatsReporter);
+
+void BM_BrownoutDetectedReporter(benchmark::State &state) {
+    const std::string reason_prop = "debug.pixelstats.benchmark.brownout_reason";
+    android::base::SetProperty(reason_prop, "uvlo,pmic,if");
+    for (auto _ : state) {
+        state.PauseTiming();
+        /* A successful pass rewrites the CSV with the uploaded marker. */
+        std::string path = fixture()->file("brownout.csv", fixture()->brownoutCsv());
+        state.ResumeTiming();
+        BrownoutDetectedReporter reporter;
+        reporter.logBrownoutCsv(noopStats(), path, reason_prop);
+    }
+}
+BENCHMARK(BM_BrownoutDetectedReporter);
+
+void BM_MmMetricsAggregatePer5Min(benchmark::State &state) {
+    MmMetricsReporter reporter;
+    for (auto _ : state) {
+        reporter.aggregatePixelMmMetricsPer5Min();
+    }
+}
+BENCHMARK(BM_MmMetricsAggregatePer5Min);
+
+void BM_MmMetricsPerHour(benchmark::State &state) {
+    MmMetricsReporter reporter;
+    for (auto _ : state) {
+        reporter.logPixelMmMetricsPerHour(noopStats());
+    }
+}
+BENCHMARK(BM_MmMetricsPerHour);
+
+}  // namespace
+
+}  // namespace pixel
+}  // namespace google
+}  // namespace hardware
+}  // namespace android
+
+BENCHMARK_MAIN();
@@ -39,7 +39,7 @@ class BatteryCapacityReporter {
   private:
     int64_t getTimeSecs();
 
-    bool parse(const std::string &path);
+    bool parse(const char *buf, const std::string &path);
     bool checkLogEvent(void);
     bool shouldReportEvent(void);
     void reportEvent(const std::shared_ptr<IStats> &stats_client);
@@ -76,6 +76,14 @@ class BatteryCapacityReporter {
     int num_events_in_last_hour_ = 0;
     int64_t log_event_time_secs_[MAX_LOG_EVENTS_PER_HOUR] = {0};
 
+    // Raw snapshot of the last ssoc_details read. Identical raw contents
+    // cannot change any gating decision, so comparing the fresh read against
+    // this makes the no-change path a single read plus a memcmp, with no
+    // parsing or float work.
+    static constexpr size_t kMaxSsocDetailsSize = 512;
+    char last_raw_[kMaxSsocDetailsSize];
+    ssize_t last_raw_len_ = -1;
+
     // Proto messages are 1-indexed and VendorAtom field numbers start at 2, so
     // store everything in the values array at the index of the field number
     // -2.
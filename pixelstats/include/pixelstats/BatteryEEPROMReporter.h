@@ -135,6 +135,13 @@ class BatteryEEPROMReporter {
     int64_t report_time_ = 0;
     int64_t getTimeSecs();
 
+    /* Raw history contents as of the last upload, mirrored in a state file so
+     * the common no-change cycle is one read plus a memcmp. */
+    std::string last_reported_history_;
+    bool snapshot_loaded_ = false;
+    void loadHistorySnapshot();
+    void saveHistorySnapshot(const std::string &contents);
+
     bool checkLogEvent(struct BatteryHistory hist);
     void reportEvent(const std::shared_ptr<IStats> &stats_client,
                      const struct BatteryHistory &hist);
@@ -19,6 +19,7 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 
 #include <aidl/android/frameworks/stats/IStats.h>
 
@@ -69,6 +70,7 @@ class BatteryFGReporter {
 
     void reportEvent(const std::shared_ptr<IStats> &stats_client,
                      const struct BatteryFGLearningParam &params);
+    bool parseFGLearningLine(std::string_view line, struct BatteryFGLearningParam *params);
 
     const int kNumFGLearningFields = 10;
     const int kNumFwUpdateFields = 3;
@@ -21,7 +21,6 @@
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
 
 #include <map>
-#include <regex>
 #include <string>
 
 namespace android {
@@ -95,7 +94,6 @@ class BrownoutDetectedReporter {
 
     void setAtomFieldValue(std::vector<VendorAtomValue> *values, int offset, int content);
     long parseTimestamp(std::string timestamp);
-    bool updateIfFound(std::string line, std::regex pattern, int *current_value, Update flag);
     void uploadData(const std::shared_ptr<IStats> &stats_client,
                     const struct BrownoutDetectedInfo max_value);
     // Proto messages are 1-indexed and VendorAtom field numbers start at 2, so
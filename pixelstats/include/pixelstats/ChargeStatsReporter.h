@@ -37,6 +37,7 @@ class ChargeStatsReporter {
     void checkAndReport(const std::shared_ptr<IStats> &stats_client, const std::string &path);
 
   private:
+    static bool hasNewSession(const std::string &path);
     bool checkContentsAndAck(std::string *file_contents, const std::string &path);
     void ReportVoltageTierStats(const std::shared_ptr<IStats> &stats_client, const char *line,
                                 const bool has_wireless, const std::string &wfile_contents);
@@ -116,6 +116,32 @@ class DisplayStatsReporter {
                               const std::vector<std::string> &hdcp_stats_paths);
     bool captureHDCPAuthTypeStats(const std::vector<std::string> &hdcp_stats_paths,
                                   int64_t *cur_data);
+
+    /* Persisted diff baseline.
+     * The sysfs error counters are cumulative since boot, and the baselines
+     * above restarted at zero whenever pixelstats restarted, so the next
+     * collection after a crash re-reported the whole boot's counts as new
+     * errors. The baselines are mirrored to a small binary state file keyed
+     * by boot id: a restart within the same boot resumes diffing where it
+     * left off, while a state file from an earlier boot (counters back at
+     * zero) is ignored.
+     */
+    struct PersistedState {
+        uint32_t magic;
+        uint32_t version;
+        char boot_id[36];
+        char reserved[4]; /* keeps the counter arrays naturally aligned */
+        struct DisplayPanelErrorStats panel;
+        int64_t dp[DISPLAY_PORT_ERROR_STATS_SIZE];
+        int64_t hdcp[HDCP_AUTH_TYPE_STATS_SIZE];
+    };
+    static constexpr char kStateDir[] = "/data/vendor/pixelstats";
+    static constexpr char kStatePath[] = "/data/vendor/pixelstats/display_state.bin";
+
+    void loadPersistedState();
+    void persistState();
+
+    std::string boot_id_;
 };
 
 }  // namespace pixel
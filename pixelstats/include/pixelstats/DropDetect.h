@@ -18,6 +18,9 @@
 #define HARDWARE_GOOGLE_PIXEL_PIXELSTATS_DROPDETECT_H
 
 #include <utils/StrongPointer.h>
+
+#include <chrono>
+
 #include "chre_host/host_protocol_host.h"
 #include "chre_host/socket_client.h"
 
@@ -42,6 +45,13 @@ class DropDetect : public android::chre::SocketClient::ICallbacks,
     DropDetect(const uint64_t drop_detect_app_id);
 
     const uint64_t kDropDetectAppId;
+
+    // Reconnect bookkeeping, only touched from the socket callback thread.
+    // The nanoapp-list query after each (re)connect is backed off during
+    // sensor-hub crash loops; see onConnected().
+    std::chrono::steady_clock::time_point mLastConnect{};
+    std::chrono::steady_clock::time_point mNextNanoappQuery{};
+    uint32_t mReconnectStreak = 0;
 };
 
 }  // namespace pixel
@@ -22,6 +22,7 @@
 
 #include <map>
 #include <string>
+#include <string_view>
 
 namespace android {
 namespace hardware {
@@ -62,16 +63,16 @@ class MitigationDurationReporter {
     // store everything in the values array at the index of the field number
     // -2.
     const int kVendorAtomOffset = 2;
-    const int kExpectedNumberOfLines = 33;
+    static constexpr int kExpectedNumberOfLines = 33;
     const std::string kGreaterThanTenMsSysfsNode = "/greater_than_10ms_count";
 
     void valueAssignmentHelper(std::vector<VendorAtomValue> *values, int *val, int fieldNumber);
 
-    int updateStat(const std::string *line, int *val);
+    int updateStat(std::string_view line, int *val);
 
     bool getIrqDurationCountHelper(const std::string kMitigationDurationFile,
                                    struct IrqDurationCounts *counts);
-    bool getStatFromLine(const std::string *line, int *val);
+    bool getStatFromLine(std::string_view line, int *val);
 };
 
 }  // namespace pixel
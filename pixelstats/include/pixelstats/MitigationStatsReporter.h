@@ -21,6 +21,7 @@
 #include <string>
 
 #include <aidl/android/frameworks/stats/IStats.h>
+#include <android-base/unique_fd.h>
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
 
 namespace android {
@@ -80,6 +81,18 @@ class MitigationStatsReporter {
     bool logMitigationCount(const std::string kMitigationDir, struct MitigationCount *last_count);
     void logMitigationCap(const std::string kMitigationDir, struct MitigationCap *last_cap);
     bool ReadFileToInt(const std::string &path, int *val);
+
+    // The mitigation directory never moves, so both subdirectories are opened
+    // once and every node is read via openat() from the cached fd, skipping
+    // 24 path constructions and prefix walks per hourly collection. When a
+    // directory fails to open, reads fall back to full paths.
+    void openDirFds(const std::string &kMitigationDir);
+    bool readNodeToInt(const ::android::base::unique_fd &dirfd, const std::string &dir,
+                       const char *name, int *val);
+
+    ::android::base::unique_fd count_dirfd_;
+    ::android::base::unique_fd cap_dirfd_;
+    bool dirfds_opened_ = false;
 };
 
 }  // namespace pixel
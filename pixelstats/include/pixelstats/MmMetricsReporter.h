@@ -19,8 +19,10 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include <aidl/android/frameworks/stats/IStats.h>
+#include <android-base/unique_fd.h>
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
 
 namespace android {
@@ -31,6 +33,32 @@ namespace pixel {
 using aidl::android::frameworks::stats::IStats;
 using aidl::android::frameworks::stats::VendorAtomValue;
 
+/**
+ * Streaming reader for vmstat-format files (one "key value" pair per line).
+ * Keeps a persistent fd and preads the whole file into a reusable buffer,
+ * then tokenizes in place against the line-key table recorded on the first
+ * read — the key order of /proc/vmstat and the pixel_stat mirrors is stable
+ * for the life of a boot — so steady-state cycles parse without per-line
+ * string allocations.
+ */
+class ProcCounterReader {
+  public:
+    explicit ProcCounterReader(std::string path) : path_(std::move(path)) {}
+    // Parses the file into out. Returns false if the file cannot be read;
+    // out is left untouched in that case.
+    bool read(std::map<std::string, uint64_t> *out);
+
+  private:
+    bool ensureOpen();
+
+    const std::string path_;
+    ::android::base::unique_fd fd_;
+    std::vector<char> buf_;
+    // Key of each line, recorded on the first parse and verified by memcmp
+    // afterwards.
+    std::vector<std::string> line_keys_;
+};
+
 /**
  * A class to upload Pixel MM health metrics
  */
@@ -41,6 +69,13 @@ class MmMetricsReporter {
     void logPixelMmMetricsPerHour(const std::shared_ptr<IStats> &stats_client);
     void logPixelMmMetricsPerDay(const std::shared_ptr<IStats> &stats_client);
     void logCmaStatus(const std::shared_ptr<IStats> &stats_client);
+    // Registers a stall trigger on /proc/pressure/memory and returns the fd
+    // to poll for POLLPRI, or -1 when unsupported. When the trigger fires,
+    // logPsiBurstSnapshot() records reclaim counter deltas since the previous
+    // burst, so pressure spikes between periodic samples leave
+    // causally-aligned data behind instead of being averaged away.
+    int preparePsiMemoryTrigger();
+    void logPsiBurstSnapshot();
 
   private:
     struct MmMetricsInfo {
@@ -140,11 +175,24 @@ class MmMetricsReporter {
                         const std::map<std::string, uint64_t> &mm_metrics,
                         std::map<std::string, uint64_t> *prev_mm_metrics,
                         std::vector<VendorAtomValue> *atom_values);
-    bool isValidPid(int pid, const char *name);
+    /**
+     * Persistent handle to a kernel thread's /proc/<pid>/stat. Kernel threads
+     * like kswapd0 keep their pid for the life of a boot, so the /proc comm
+     * scan runs once; the cached fd is revalidated against the recorded
+     * starttime on every read and a mismatch forces a re-resolve.
+     */
+    struct KernelProcStatFile {
+        ::android::base::unique_fd fd;
+        int pid = -1;
+        uint64_t starttime = 0;
+    };
+
     int findPidByProcessName(const char *name);
-    uint64_t getStimeByPid(int pid);
-    void fillProcessStime(int atom_key, const char *name, int *pid, uint64_t *prev_stime,
-                          std::vector<VendorAtomValue> *atom_values);
+    bool openProcStatFile(const char *name, KernelProcStatFile *stat_file);
+    bool readProcStatFile(const KernelProcStatFile &stat_file, uint64_t *stime,
+                          uint64_t *starttime);
+    void fillProcessStime(int atom_key, const char *name, KernelProcStatFile *stat_file,
+                          uint64_t *prev_stime, std::vector<VendorAtomValue> *atom_values);
     std::map<std::string, uint64_t> readCmaStat(const std::string &cma_type,
                                                 const std::vector<MmMetricsInfo> &metrics_info);
     void reportCmaStatusAtom(
@@ -172,13 +220,26 @@ class MmMetricsReporter {
     long psi_total_[kPsiNumAllTotals];
     long psi_aggregated_[kPsiNumAllUploadAvgMetrics];  // min, max and avg of original avgXXX
     int psi_data_set_count_ = 0;
+    // Persistent readers, one per vmstat-format path.
+    std::map<std::string, ProcCounterReader> vmstat_readers_;
     std::map<std::string, uint64_t> prev_hour_vmstat_;
     std::map<std::string, uint64_t> prev_day_vmstat_;
     std::map<std::string, uint64_t> prev_day_pixel_vmstat_;
     std::map<std::string, std::map<std::string, uint64_t>> prev_cma_stat_;
     std::map<std::string, std::map<std::string, uint64_t>> prev_cma_stat_ext_;
-    int kswapd_pid_ = -1;
-    int kcompactd_pid_ = -1;
+    // PSI-triggered burst capture. The trigger spec follows the kernel
+    // format "<some|full> <stall us> <window us>"; bursts are rate limited
+    // so a sustained stall cannot flood the log.
+    static constexpr const char *kPsiMemoryPath = "/proc/pressure/memory";
+    static constexpr const char *kPsiDefaultTriggerSpec = "some 100000 1000000";
+    static constexpr int64_t kPsiBurstMinIntervalSec = 30;
+    ::android::base::unique_fd psi_trigger_fd_;
+    std::map<std::string, uint64_t> prev_burst_vmstat_;
+    long prev_burst_direct_reclaim_total_ = -1;
+    int64_t last_burst_sec_ = 0;
+
+    KernelProcStatFile kswapd_stat_;
+    KernelProcStatFile kcompactd_stat_;
     uint64_t prev_kswapd_stime_ = 0;
     uint64_t prev_kcompactd_stime_ = 0;
     bool is_user_build_;
@@ -20,6 +20,8 @@
 #include <aidl/android/frameworks/stats/IStats.h>
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
 
+#include <string_view>
+
 namespace android {
 namespace hardware {
 namespace google {
@@ -29,6 +31,37 @@ using aidl::android::frameworks::stats::IStats;
 
 std::shared_ptr<IStats> getStatsService();
 
+/**
+ * Read-through cache over read-only sysfs nodes, shared by all reporters in
+ * one collection cycle. SysfsCollector invalidates it at the start of each
+ * cycle, so nodes that several reporters read (battery voltage, cycle count,
+ * temperature) cost one read per cycle and every reporter sees the same
+ * snapshot. Nodes with read-and-clear semantics must not go through the
+ * cache. Failed reads are not cached.
+ */
+bool readSysfsCached(const std::string &path, std::string *content);
+void invalidateSysfsCache();
+
+/**
+ * Zero-copy line iteration for the charge-stats style multi-line sysfs dumps.
+ * getNextLine() stores the next line (without the trailing newline) as a view
+ * into the original buffer and advances *remaining past it; it returns false
+ * once the buffer is exhausted. scanLine() applies an sscanf format to such a
+ * view, bouncing it through a fixed stack buffer since a view into a larger
+ * buffer is not NUL-terminated, and returns the number of converted fields.
+ */
+bool getNextLine(std::string_view *remaining, std::string_view *line);
+int scanLine(std::string_view line, const char *fmt, ...) __attribute__((format(scanf, 2, 3)));
+
+/**
+ * Queues the atom for submission from the shared batcher thread, so reporters
+ * emitting a burst of atoms in one collection cycle cost one drain instead of
+ * one binder call each. Delivery failures are spooled and replayed; see the
+ * report* helpers below, which all go through the same path.
+ */
+void enqueueVendorAtom(const std::shared_ptr<IStats> &stats_client,
+                       aidl::android::frameworks::stats::VendorAtom &&event);
+
 void reportSpeakerImpedance(const std::shared_ptr<IStats> &stats_client,
                             const PixelAtoms::VendorSpeakerImpedance &speakerImpedance);
 
@@ -20,6 +20,9 @@
 #include <aidl/android/frameworks/stats/IStats.h>
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
 
+#include <functional>
+#include <vector>
+
 #include "BatteryEEPROMReporter.h"
 #include "BatteryHealthReporter.h"
 #include "BrownoutDetectedReporter.h"
@@ -100,8 +103,23 @@ class SysfsCollector {
     void collect();
 
   private:
+    // Benchmark seam: lets pixelstats_benchmark drive single collection
+    // passes without entering collect()'s poll loop.
+    friend class SysfsCollectorPeer;
+
     bool ReadFileToInt(const std::string &path, int *val);
     bool ReadFileToInt(const char *path, int *val);
+    // A named reporter closure dispatched by runReporters(). Closures that
+    // touch the same reporter object must live in the same task - the pool
+    // only isolates tasks from each other.
+    struct ReporterTask {
+        const char *name;
+        std::function<void()> fn;
+    };
+    void runReporters(const std::shared_ptr<IStats> &stats_client,
+                      std::vector<ReporterTask> &&tasks);
+    void reportCollectorStall(const std::shared_ptr<IStats> &stats_client, const char *name,
+                              int64_t duration_ms);
     void aggregatePer5Min();
     void logOnce();
     void logBrownout();
@@ -62,6 +62,7 @@ class UeventListener {
     constexpr static const char *const typec_partner_pid_path_default =
             "/sys/class/typec/port0-partner/identity/product";
     constexpr static const char *const typec_partner_uevent_default = "DEVTYPE=typec_partner";
+    constexpr static int32_t kUeventMsgLen = 2048;  // it's 2048 in all other users.
 
     UeventListener(const std::string audio_uevent, const std::string ssoc_details_path = "",
                    const std::string overheat_path = overheat_path_default,
@@ -77,6 +78,10 @@ class UeventListener {
     void ListenForever();  // Process Uevents forever
 
   private:
+    // Attaches a classic-BPF filter to the uevent socket so the kernel only
+    // wakes the listener for messages carrying a token family ProcessUevent
+    // acts on. Best effort: on failure the socket stays unfiltered.
+    void AttachUeventFilter(int fd) const;
     bool ReadFileToInt(const std::string &path, int *val);
     bool ReadFileToInt(const char *path, int *val);
     void ReportMicStatusUevents(const std::shared_ptr<IStats> &stats_client, const char *devpath,
@@ -102,6 +107,9 @@ class UeventListener {
     void ReportFGMetricsEvent(const std::shared_ptr<IStats> &stats_client, const char *driver);
 
     const std::string kAudioUevent;
+    // "DEVPATH=" + kAudioUevent, precomputed so the mic status path does not
+    // concatenate strings per event.
+    const std::string kAudioDevPath;
     const std::string kBatterySSOCPath;
     const std::string kUsbPortOverheatPath;
     const std::string kChargeMetricsPath;
@@ -204,6 +212,9 @@ class UeventListener {
 
     int uevent_fd_;
     int log_fd_;
+    // Reusable receive buffer; tokens are matched in place, so processing an
+    // event does not allocate. Only touched by the listener thread.
+    char uevent_msg_[kUeventMsgLen + 2];
 };
 
 }  // namespace pixel
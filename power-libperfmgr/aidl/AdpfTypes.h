@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <perfmgr/AdpfConfig.h>
+
 #include <cstdint>
 
 namespace aidl {
@@ -42,6 +44,52 @@ enum class AdpfHintType : int32_t {
 constexpr int kUclampMin{0};
 constexpr int kUclampMax{1024};
 
+// Finalized ADPF profile values for the per-frame heuristic. Built once per
+// profile switch from AdpfConfig: the integral limits are pre-divided by the
+// I gain and the boolean knobs are folded into a bitmask, so the frame path
+// reads plain members instead of chasing the shared_ptr profile and
+// re-deriving limits on every batch.
+struct AdpfConfigSnapshot {
+    enum Flags : uint32_t {
+        kPidOn = 1u << 0,
+        kUclampMinOn = 1u << 1,
+    };
+    uint32_t flags{0};
+    uint32_t uclampMinInit{0};
+    uint32_t uclampMinHigh{0};
+    uint32_t uclampMinLow{0};
+    double pidPo{0};
+    double pidPu{0};
+    double pidI{0};
+    double pidDo{0};
+    double pidDu{0};
+    int64_t pidIHighDivI{0};
+    int64_t pidILowDivI{0};
+    uint64_t samplingWindowP{0};
+    uint64_t samplingWindowI{0};
+    uint64_t samplingWindowD{0};
+
+    AdpfConfigSnapshot() = default;
+    explicit AdpfConfigSnapshot(::android::perfmgr::AdpfConfig &config)
+        : flags((config.mPidOn ? kPidOn : 0) | (config.mUclampMinOn ? kUclampMinOn : 0)),
+          uclampMinInit(config.mUclampMinInit),
+          uclampMinHigh(config.mUclampMinHigh),
+          uclampMinLow(config.mUclampMinLow),
+          pidPo(config.mPidPo),
+          pidPu(config.mPidPu),
+          pidI(config.mPidI),
+          pidDo(config.mPidDo),
+          pidDu(config.mPidDu),
+          pidIHighDivI(config.getPidIHighDivI()),
+          pidILowDivI(config.getPidILowDivI()),
+          samplingWindowP(config.mSamplingWindowP),
+          samplingWindowI(config.mSamplingWindowI),
+          samplingWindowD(config.mSamplingWindowD) {}
+
+    bool pidOn() const { return flags & kPidOn; }
+    bool uclampMinOn() const { return flags & kUclampMinOn; }
+};
+
 }  // namespace pixel
 }  // namespace impl
 }  // namespace power
@@ -18,7 +18,10 @@
 
 #include <aidl/android/hardware/power/SessionMode.h>
 #include <android-base/stringprintf.h>
+#include <cutils/trace.h>
 
+#include <array>
+#include <mutex>
 #include <string>
 
 namespace aidl {
@@ -38,33 +41,21 @@ constexpr size_t enum_size() {
 // and is separate so that it can be used as a pointer for
 // easily passing to the pid function
 struct AppDescriptorTrace {
-    AppDescriptorTrace(const std::string &idString) {
-        using ::android::base::StringPrintf;
-        trace_pid_err = StringPrintf("adpf.%s-%s", idString.c_str(), "pid.err");
-        trace_pid_integral = StringPrintf("adpf.%s-%s", idString.c_str(), "pid.integral");
-        trace_pid_derivative = StringPrintf("adpf.%s-%s", idString.c_str(), "pid.derivative");
-        trace_pid_pOut = StringPrintf("adpf.%s-%s", idString.c_str(), "pid.pOut");
-        trace_pid_iOut = StringPrintf("adpf.%s-%s", idString.c_str(), "pid.iOut");
-        trace_pid_dOut = StringPrintf("adpf.%s-%s", idString.c_str(), "pid.dOut");
-        trace_pid_output = StringPrintf("adpf.%s-%s", idString.c_str(), "pid.output");
-        trace_target = StringPrintf("adpf.%s-%s", idString.c_str(), "target");
-        trace_active = StringPrintf("adpf.%s-%s", idString.c_str(), "active");
-        trace_add_threads = StringPrintf("adpf.%s-%s", idString.c_str(), "add_threads");
-        trace_actl_last = StringPrintf("adpf.%s-%s", idString.c_str(), "act_last");
-        trace_min = StringPrintf("adpf.%s-%s", idString.c_str(), "min");
-        trace_batch_size = StringPrintf("adpf.%s-%s", idString.c_str(), "batch_size");
-        trace_hint_count = StringPrintf("adpf.%s-%s", idString.c_str(), "hint_count");
-        trace_hint_overtime = StringPrintf("adpf.%s-%s", idString.c_str(), "hint_overtime");
-        trace_is_first_frame = StringPrintf("adpf.%s-%s", idString.c_str(), "is_first_frame");
-        trace_session_hint = StringPrintf("adpf.%s-%s", idString.c_str(), "session_hint");
-        for (size_t i = 0; i < trace_modes.size(); ++i) {
-            trace_modes[i] = StringPrintf(
-                    "adpf.%s-%s_mode", idString.c_str(),
-                    toString(static_cast<aidl::android::hardware::power::SessionMode>(i)).c_str());
+    explicit AppDescriptorTrace(const std::string &idString) : id_string_(idString) {}
+
+    // True when atrace is capturing the power/HAL tags. The ~20 per-session
+    // name strings are formatted on the first enabled call rather than at
+    // session creation, and every trace point is guarded by this check, so
+    // ADPF tracing costs nothing on the session paths until a trace starts.
+    bool enabled() {
+        if (CC_LIKELY(!atrace_is_tag_enabled(ATRACE_TAG_POWER | ATRACE_TAG_HAL))) {
+            return false;
         }
+        std::call_once(build_once_, [this] { buildTraceNames(); });
+        return true;
     }
 
-    // Trace values
+    // Trace values, valid only after enabled() has returned true once
     std::string trace_pid_err;
     std::string trace_pid_integral;
     std::string trace_pid_derivative;
@@ -83,6 +74,36 @@ struct AppDescriptorTrace {
     std::string trace_is_first_frame;
     std::string trace_session_hint;
     std::array<std::string, enum_size<aidl::android::hardware::power::SessionMode>()> trace_modes;
+
+  private:
+    void buildTraceNames() {
+        using ::android::base::StringPrintf;
+        trace_pid_err = StringPrintf("adpf.%s-%s", id_string_.c_str(), "pid.err");
+        trace_pid_integral = StringPrintf("adpf.%s-%s", id_string_.c_str(), "pid.integral");
+        trace_pid_derivative = StringPrintf("adpf.%s-%s", id_string_.c_str(), "pid.derivative");
+        trace_pid_pOut = StringPrintf("adpf.%s-%s", id_string_.c_str(), "pid.pOut");
+        trace_pid_iOut = StringPrintf("adpf.%s-%s", id_string_.c_str(), "pid.iOut");
+        trace_pid_dOut = StringPrintf("adpf.%s-%s", id_string_.c_str(), "pid.dOut");
+        trace_pid_output = StringPrintf("adpf.%s-%s", id_string_.c_str(), "pid.output");
+        trace_target = StringPrintf("adpf.%s-%s", id_string_.c_str(), "target");
+        trace_active = StringPrintf("adpf.%s-%s", id_string_.c_str(), "active");
+        trace_add_threads = StringPrintf("adpf.%s-%s", id_string_.c_str(), "add_threads");
+        trace_actl_last = StringPrintf("adpf.%s-%s", id_string_.c_str(), "act_last");
+        trace_min = StringPrintf("adpf.%s-%s", id_string_.c_str(), "min");
+        trace_batch_size = StringPrintf("adpf.%s-%s", id_string_.c_str(), "batch_size");
+        trace_hint_count = StringPrintf("adpf.%s-%s", id_string_.c_str(), "hint_count");
+        trace_hint_overtime = StringPrintf("adpf.%s-%s", id_string_.c_str(), "hint_overtime");
+        trace_is_first_frame = StringPrintf("adpf.%s-%s", id_string_.c_str(), "is_first_frame");
+        trace_session_hint = StringPrintf("adpf.%s-%s", id_string_.c_str(), "session_hint");
+        for (size_t i = 0; i < trace_modes.size(); ++i) {
+            trace_modes[i] = StringPrintf(
+                    "adpf.%s-%s_mode", id_string_.c_str(),
+                    toString(static_cast<aidl::android::hardware::power::SessionMode>(i)).c_str());
+        }
+    }
+
+    const std::string id_string_;
+    std::once_flag build_once_;
 };
 
 }  // namespace pixel
@@ -77,25 +77,36 @@ void PriorityQueueWorkerPool::removeCallback(int64_t templateQueueWorkerId) {
 }
 
 void PriorityQueueWorkerPool::schedule(int64_t templateQueueWorkerId, int64_t packageId,
-                                       std::chrono::steady_clock::time_point deadline) {
+                                       std::chrono::steady_clock::time_point deadline,
+                                       WorkerPriority priority) {
     std::unique_lock<std::mutex> lock(mMutex);
-    mPackageQueue.emplace(deadline, templateQueueWorkerId, packageId);
+    if (priority == WorkerPriority::kUrgent) {
+        mUrgentQueue.emplace(deadline, templateQueueWorkerId, packageId);
+    } else {
+        mPackageQueue.emplace(deadline, templateQueueWorkerId, packageId);
+    }
     mCv.notify_all();
 }
 
+std::chrono::steady_clock::time_point PriorityQueueWorkerPool::nextDeadlineLocked() const {
+    // Default to longest wait possible without overflowing if there is
+    // nothing to work on in either queue
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    if (!mUrgentQueue.empty()) {
+        deadline = mUrgentQueue.top().deadline;
+    }
+    if (!mPackageQueue.empty() && mPackageQueue.top().deadline < deadline) {
+        deadline = mPackageQueue.top().deadline;
+    }
+    return deadline;
+}
+
 void PriorityQueueWorkerPool::loop() {
     Package package;
     while (mRunning) {
         std::unique_lock<std::mutex> lock(mMutex);
-        // Default to longest wait possible without overflowing if there is
-        // nothing to work on in the queue
-        std::chrono::steady_clock::time_point deadline =
-                std::chrono::steady_clock::time_point::max();
-
         // Use next item to work on deadline if available
-        if (!mPackageQueue.empty()) {
-            deadline = mPackageQueue.top().deadline;
-        }
+        std::chrono::steady_clock::time_point deadline = nextDeadlineLocked();
 
         // Wait until signal or deadline
         mCv.wait_until(lock, deadline, [&]() {
@@ -103,14 +114,12 @@ void PriorityQueueWorkerPool::loop() {
             if (!mRunning)
                 return true;
 
-            // Check if nothing in queue (e.g. spurious wakeup), wait as long as possible again
-            if (mPackageQueue.empty()) {
-                deadline = std::chrono::steady_clock::time_point::max();
+            // Earliest deadline across both lanes; max() means nothing queued
+            // (e.g. spurious wakeup), wait as long as possible again
+            deadline = nextDeadlineLocked();
+            if (deadline == std::chrono::steady_clock::time_point::max())
                 return false;
-            }
 
-            // Something in queue, use that as next deadline
-            deadline = mPackageQueue.top().deadline;
             // Check if deadline is in the future still, continue waiting with updated deadline
             if (deadline > std::chrono::steady_clock::now())
                 return false;
@@ -120,12 +129,23 @@ void PriorityQueueWorkerPool::loop() {
 
         if (!mRunning)
             break;
-        if (mPackageQueue.empty())
+
+        // Urgent lane first: when both lanes have due work, de-boost and vote
+        // expiry packages run before bookkeeping regardless of whose deadline
+        // is earlier.
+        const auto now = std::chrono::steady_clock::now();
+        std::priority_queue<Package> *queue = nullptr;
+        if (!mUrgentQueue.empty() && mUrgentQueue.top().deadline <= now) {
+            queue = &mUrgentQueue;
+        } else if (!mPackageQueue.empty() && mPackageQueue.top().deadline <= now) {
+            queue = &mPackageQueue;
+        } else {
             continue;
+        }
 
         // Copy work entry from queue and unlock
-        package = mPackageQueue.top();
-        mPackageQueue.pop();
+        package = queue->top();
+        queue->pop();
         lock.unlock();
 
         // Find callback based on package's callback id
@@ -35,6 +35,12 @@ namespace power {
 namespace impl {
 namespace pixel {
 
+// Scheduling lane for queued work. Urgent work (vote expiry, uclamp
+// restore) is drained before normal work whenever both lanes have due
+// packages, so a de-boost never waits behind queued bookkeeping and
+// boost-overrun is bounded by scheduler latency rather than queue depth.
+enum class WorkerPriority { kUrgent, kNormal };
+
 // Background thread processing from priority queue based on time deadline
 // This class isn't meant to be used directly, use TemplatePriorityQueueWorker below
 class PriorityQueueWorkerPool {
@@ -51,7 +57,8 @@ class PriorityQueueWorkerPool {
     void removeCallback(int64_t templateQueueWorkerId);
     // Schedule work for specific worker id with package id to be run at time deadline
     void schedule(int64_t templateQueueWorkerId, int64_t packageId,
-                  std::chrono::steady_clock::time_point deadline);
+                  std::chrono::steady_clock::time_point deadline,
+                  WorkerPriority priority = WorkerPriority::kNormal);
 
   private:
     // Thread coordination
@@ -75,6 +82,10 @@ class PriorityQueueWorkerPool {
         // Sort time earliest first
         bool operator<(const Package &p) const { return deadline > p.deadline; }
     };
+    // Earliest deadline across both lanes, time_point::max() when idle
+    std::chrono::steady_clock::time_point nextDeadlineLocked() const;
+    // Two lanes, both deadline-ordered; the urgent lane is drained first
+    std::priority_queue<Package> mUrgentQueue;
     std::priority_queue<Package> mPackageQueue;
 
     // Callback management
@@ -90,10 +101,15 @@ class PriorityQueueWorkerPool {
 template <typename PACKAGE>
 class TemplatePriorityQueueWorker {
   public:
-    // CTOR, callback to run when added work is run, worker to use for adding work to
+    // CTOR, callback to run when added work is run, worker to use for adding work to,
+    // priority selects the pool lane all of this worker's packages run in
     TemplatePriorityQueueWorker(std::function<void(const PACKAGE &)> cb,
-                                std::shared_ptr<PriorityQueueWorkerPool> worker)
-        : mCallbackId(reinterpret_cast<std::intptr_t>(this)), mCallback(cb), mWorker(worker) {
+                                std::shared_ptr<PriorityQueueWorkerPool> worker,
+                                WorkerPriority priority = WorkerPriority::kNormal)
+        : mCallbackId(reinterpret_cast<std::intptr_t>(this)),
+          mCallback(cb),
+          mWorker(worker),
+          mPriority(priority) {
         if (!mCallback) {
             mCallback = [](const auto &) {};
         }
@@ -110,7 +126,7 @@ class TemplatePriorityQueueWorker {
             ++mPackageIdCounter;
             mPackages.emplace(mPackageIdCounter, package);
         }
-        mWorker->schedule(mCallbackId, mPackageIdCounter, t);
+        mWorker->schedule(mCallbackId, mPackageIdCounter, t, mPriority);
     }
 
   private:
@@ -118,6 +134,7 @@ class TemplatePriorityQueueWorker {
     std::function<void(const PACKAGE &)> mCallback;
     // Must ensure PriorityQueueWorker does not go out of scope before this class does
     std::shared_ptr<PriorityQueueWorkerPool> mWorker;
+    const WorkerPriority mPriority;
     mutable std::mutex mMutex;
     // Counter is used as a unique identifier for work packages
     int64_t mPackageIdCounter{0};
@@ -29,6 +29,7 @@ namespace impl {
 namespace pixel {
 
 GpuCapacityNode::~GpuCapacityNode() {
+    stop_sampling();
     fd_interface_->close(frequency_fd_);
     fd_interface_->close(capacity_headroom_fd_);
 }
@@ -120,6 +121,47 @@ std::optional<Frequency> GpuCapacityNode::gpu_frequency() const {
     return Frequency(frequency_raw * 1000);
 }
 
+void GpuCapacityNode::start_sampling(std::chrono::milliseconds period) {
+    std::lock_guard lk(sampler_mutex_);
+    if (sampler_running_) {
+        return;
+    }
+    sampler_running_ = true;
+    sampler_thread_ = std::thread([this, period] {
+        std::unique_lock lk(sampler_mutex_);
+        while (sampler_running_) {
+            lk.unlock();
+            auto const frequency = gpu_frequency();
+            cached_frequency_hz_.store(frequency ? static_cast<int>(*frequency) : kFrequencyUnknown,
+                                       std::memory_order_relaxed);
+            lk.lock();
+            sampler_cv_.wait_for(lk, period, [this] { return !sampler_running_; });
+        }
+    });
+}
+
+void GpuCapacityNode::stop_sampling() {
+    {
+        std::lock_guard lk(sampler_mutex_);
+        if (!sampler_running_) {
+            return;
+        }
+        sampler_running_ = false;
+        sampler_cv_.notify_all();
+    }
+    if (sampler_thread_.joinable()) {
+        sampler_thread_.join();
+    }
+}
+
+std::optional<Frequency> GpuCapacityNode::cached_gpu_frequency() const {
+    auto const frequency_hz = cached_frequency_hz_.load(std::memory_order_relaxed);
+    if (frequency_hz <= 0) {
+        return {};
+    }
+    return Frequency(frequency_hz);
+}
+
 }  // namespace pixel
 }  // namespace impl
 }  // namespace power
@@ -19,11 +19,15 @@
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <utility>
 
 #include "PhysicalQuantityTypes.h"
@@ -73,6 +77,16 @@ struct GpuCapacityNode final {
     bool set_gpu_capacity(Cycles capacity) const;
     std::optional<Frequency> gpu_frequency() const;
 
+    // The synchronous read above can stall for hundreds of microseconds when
+    // the GPU driver holds its internal lock, so heuristics on the frame
+    // report path should read the sampled copy instead. start_sampling spawns
+    // a thread that refreshes the cache at the given cadence; the cached read
+    // is a single atomic load and returns nullopt until the first sample
+    // lands (or if sampling was never started).
+    void start_sampling(std::chrono::milliseconds period);
+    void stop_sampling();
+    std::optional<Frequency> cached_gpu_frequency() const;
+
   private:
     std::unique_ptr<FdInterface> const fd_interface_;
     std::string const capacity_node_path_;
@@ -80,6 +94,13 @@ struct GpuCapacityNode final {
     int const frequency_fd_;
     std::mutex mutable freq_mutex_;
     std::mutex mutable capacity_mutex_;
+    // Sampler state; frequency is in hz, negative means no valid sample yet
+    static constexpr int kFrequencyUnknown = -1;
+    std::atomic<int> cached_frequency_hz_{kFrequencyUnknown};
+    std::mutex sampler_mutex_;
+    std::condition_variable sampler_cv_;
+    bool sampler_running_ = false;
+    std::thread sampler_thread_;
 };
 
 }  // namespace pixel
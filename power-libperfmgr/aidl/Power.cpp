@@ -23,8 +23,6 @@
 #include <android-base/properties.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
-#include <fmq/AidlMessageQueue.h>
-#include <fmq/EventFlag.h>
 #include <perfmgr/HintManager.h>
 #include <utils/Log.h>
 
@@ -45,11 +43,6 @@ namespace pixel {
 using ::aidl::google::hardware::power::impl::pixel::PowerHintSession;
 using ::android::perfmgr::HintManager;
 
-using ::aidl::android::hardware::common::fmq::MQDescriptor;
-using ::aidl::android::hardware::common::fmq::SynchronizedReadWrite;
-using ::aidl::android::hardware::power::ChannelMessage;
-using ::android::AidlMessageQueue;
-
 constexpr char kPowerHalStateProp[] = "vendor.powerhal.state";
 constexpr char kPowerHalAudioProp[] = "vendor.powerhal.audio";
 constexpr char kPowerHalRenderingProp[] = "vendor.powerhal.rendering";
@@ -94,38 +87,85 @@ Power::Power(std::shared_ptr<DisplayLowPower> dlpw)
 
     auto status = this->getInterfaceVersion(&mServiceVersion);
     LOG(INFO) << "PowerHAL InterfaceVersion:" << mServiceVersion << " isOK: " << status.isOk();
+
+    // Resolve every known mode/boost to its hint name and dense HintManager
+    // id up front; the singleton's actions never change shape after this
+    // point, so the ids stay valid for the service's lifetime.
+    for (const auto mode : ::ndk::enum_range<Mode>()) {
+        const size_t idx = static_cast<size_t>(mode);
+        if (mModeHints.size() <= idx) {
+            mModeHints.resize(idx + 1, {"", HintManager::kInvalidHintId});
+        }
+        std::string name = toString(mode);
+        mModeHints[idx].id = HintManager::GetInstance()->GetHintId(name);
+        mModeHints[idx].name = std::move(name);
+    }
+    for (const auto boost : ::ndk::enum_range<Boost>()) {
+        const size_t idx = static_cast<size_t>(boost);
+        if (mBoostHints.size() <= idx) {
+            mBoostHints.resize(idx + 1, {"", HintManager::kInvalidHintId});
+        }
+        std::string name = toString(boost);
+        mBoostHints[idx].id = HintManager::GetInstance()->GetHintId(name);
+        mBoostHints[idx].name = std::move(name);
+    }
 }
 
 ndk::ScopedAStatus Power::setMode(Mode type, bool enabled) {
-    LOG(DEBUG) << "Power setMode: " << toString(type) << " to: " << enabled;
+    const size_t type_idx = static_cast<size_t>(type);
+    if (type_idx >= mModeHints.size()) {
+        // A mode newer than this HAL was built against: keep the legacy
+        // string dispatch, which is also what the default case below does.
+        LOG(DEBUG) << "Power setMode: " << toString(type) << " to: " << enabled;
+        if (HintManager::GetInstance()->GetAdpfProfile() &&
+            HintManager::GetInstance()->GetAdpfProfile()->mReportingRateLimitNs > 0) {
+            PowerSessionManager::getInstance()->updateHintMode(toString(type), enabled);
+        }
+        if (enabled) {
+            HintManager::GetInstance()->DoHint(toString(type));
+        } else {
+            HintManager::GetInstance()->EndHint(toString(type));
+        }
+        return ndk::ScopedAStatus::ok();
+    }
+
+    const ResolvedHint &hint = mModeHints[type_idx];
+    LOG(DEBUG) << "Power setMode: " << hint.name << " to: " << enabled;
     if (HintManager::GetInstance()->GetAdpfProfile() &&
         HintManager::GetInstance()->GetAdpfProfile()->mReportingRateLimitNs > 0) {
-        PowerSessionManager::getInstance()->updateHintMode(toString(type), enabled);
+        PowerSessionManager::getInstance()->updateHintMode(hint.name, enabled);
     }
     switch (type) {
         case Mode::LOW_POWER:
             mDisplayLowPower->SetDisplayLowPower(enabled);
             if (enabled) {
-                HintManager::GetInstance()->DoHint(toString(type));
+                HintManager::GetInstance()->DoHint(hint.id);
             } else {
-                HintManager::GetInstance()->EndHint(toString(type));
+                HintManager::GetInstance()->EndHint(hint.id);
             }
             break;
+        // The sustained/VR transitions retract one mode hint and raise
+        // another; committing them as one transaction lands all the related
+        // node writes in a single looper pass instead of one wake per hint.
         case Mode::SUSTAINED_PERFORMANCE:
             if (enabled && !mSustainedPerfModeOn) {
                 if (!mVRModeOn) {  // Sustained mode only.
                     HintManager::GetInstance()->DoHint("SUSTAINED_PERFORMANCE");
                 } else {  // Sustained + VR mode.
-                    HintManager::GetInstance()->EndHint("VR");
-                    HintManager::GetInstance()->DoHint("VR_SUSTAINED_PERFORMANCE");
+                    HintManager::GetInstance()
+                            ->BeginTransaction()
+                            .EndHint("VR")
+                            .DoHint("VR_SUSTAINED_PERFORMANCE")
+                            .Commit();
                 }
                 mSustainedPerfModeOn = true;
             } else if (!enabled && mSustainedPerfModeOn) {
-                HintManager::GetInstance()->EndHint("VR_SUSTAINED_PERFORMANCE");
-                HintManager::GetInstance()->EndHint("SUSTAINED_PERFORMANCE");
+                auto tx = HintManager::GetInstance()->BeginTransaction();
+                tx.EndHint("VR_SUSTAINED_PERFORMANCE").EndHint("SUSTAINED_PERFORMANCE");
                 if (mVRModeOn) {  // Switch back to VR Mode.
-                    HintManager::GetInstance()->DoHint("VR");
+                    tx.DoHint("VR");
                 }
+                tx.Commit();
                 mSustainedPerfModeOn = false;
             }
             break;
@@ -134,16 +174,20 @@ ndk::ScopedAStatus Power::setMode(Mode type, bool enabled) {
                 if (!mSustainedPerfModeOn) {  // VR mode only.
                     HintManager::GetInstance()->DoHint("VR");
                 } else {  // Sustained + VR mode.
-                    HintManager::GetInstance()->EndHint("SUSTAINED_PERFORMANCE");
-                    HintManager::GetInstance()->DoHint("VR_SUSTAINED_PERFORMANCE");
+                    HintManager::GetInstance()
+                            ->BeginTransaction()
+                            .EndHint("SUSTAINED_PERFORMANCE")
+                            .DoHint("VR_SUSTAINED_PERFORMANCE")
+                            .Commit();
                 }
                 mVRModeOn = true;
             } else if (!enabled && mVRModeOn) {
-                HintManager::GetInstance()->EndHint("VR_SUSTAINED_PERFORMANCE");
-                HintManager::GetInstance()->EndHint("VR");
+                auto tx = HintManager::GetInstance()->BeginTransaction();
+                tx.EndHint("VR_SUSTAINED_PERFORMANCE").EndHint("VR");
                 if (mSustainedPerfModeOn) {  // Switch back to sustained Mode.
-                    HintManager::GetInstance()->DoHint("SUSTAINED_PERFORMANCE");
+                    tx.DoHint("SUSTAINED_PERFORMANCE");
                 }
+                tx.Commit();
                 mVRModeOn = false;
             }
             break;
@@ -178,9 +222,9 @@ ndk::ScopedAStatus Power::setMode(Mode type, bool enabled) {
             [[fallthrough]];
         default:
             if (enabled) {
-                HintManager::GetInstance()->DoHint(toString(type));
+                HintManager::GetInstance()->DoHint(hint.id);
             } else {
-                HintManager::GetInstance()->EndHint(toString(type));
+                HintManager::GetInstance()->EndHint(hint.id);
             }
             break;
     }
@@ -224,10 +268,34 @@ ndk::ScopedAStatus Power::isModeSupported(Mode type, bool *_aidl_return) {
 }
 
 ndk::ScopedAStatus Power::setBoost(Boost type, int32_t durationMs) {
-    LOG(DEBUG) << "Power setBoost: " << toString(type) << " duration: " << durationMs;
+    const size_t type_idx = static_cast<size_t>(type);
+    if (type_idx >= mBoostHints.size()) {
+        // A boost newer than this HAL was built against: keep the legacy
+        // string dispatch, which is also what the default case below does.
+        LOG(DEBUG) << "Power setBoost: " << toString(type) << " duration: " << durationMs;
+        if (HintManager::GetInstance()->GetAdpfProfile() &&
+            HintManager::GetInstance()->GetAdpfProfile()->mReportingRateLimitNs > 0) {
+            PowerSessionManager::getInstance()->updateHintBoost(toString(type), durationMs);
+        }
+        if (mVRModeOn || mSustainedPerfModeOn) {
+            return ndk::ScopedAStatus::ok();
+        }
+        if (durationMs > 0) {
+            HintManager::GetInstance()->DoHint(toString(type),
+                                               std::chrono::milliseconds(durationMs));
+        } else if (durationMs == 0) {
+            HintManager::GetInstance()->DoHint(toString(type));
+        } else {
+            HintManager::GetInstance()->EndHint(toString(type));
+        }
+        return ndk::ScopedAStatus::ok();
+    }
+
+    const ResolvedHint &hint = mBoostHints[type_idx];
+    LOG(DEBUG) << "Power setBoost: " << hint.name << " duration: " << durationMs;
     if (HintManager::GetInstance()->GetAdpfProfile() &&
         HintManager::GetInstance()->GetAdpfProfile()->mReportingRateLimitNs > 0) {
-        PowerSessionManager::getInstance()->updateHintBoost(toString(type), durationMs);
+        PowerSessionManager::getInstance()->updateHintBoost(hint.name, durationMs);
     }
     switch (type) {
         case Boost::INTERACTION:
@@ -251,12 +319,12 @@ ndk::ScopedAStatus Power::setBoost(Boost type, int32_t durationMs) {
                 break;
             }
             if (durationMs > 0) {
-                HintManager::GetInstance()->DoHint(toString(type),
+                HintManager::GetInstance()->DoHint(hint.id,
                                                    std::chrono::milliseconds(durationMs));
             } else if (durationMs == 0) {
-                HintManager::GetInstance()->DoHint(toString(type));
+                HintManager::GetInstance()->DoHint(hint.id);
             } else {
-                HintManager::GetInstance()->EndHint(toString(type));
+                HintManager::GetInstance()->EndHint(hint.id);
             }
             break;
     }
@@ -345,30 +413,41 @@ ndk::ScopedAStatus Power::createHintSessionWithConfig(
         *_aidl_return = nullptr;
         return ndk::ScopedAStatus::fromExceptionCode(EX_ILLEGAL_ARGUMENT);
     }
-    std::shared_ptr<IPowerHintSession> session =
+    std::shared_ptr<PowerHintSession> session =
             ndk::SharedRefBase::make<PowerHintSession>(tgid, uid, threadIds, durationNanos, tag);
     *_aidl_return = session;
-    static_cast<PowerHintSession *>(_aidl_return->get())->getSessionConfig(config);
+    session->getSessionConfig(config);
+    // Register for the FMQ channel path, so a ChannelMessage's session id can
+    // be routed back to this session without a binder identity
+    PowerSessionManager::getInstance()->registerSession(session, config->id);
     return ndk::ScopedAStatus::ok();
 }
 
-ndk::ScopedAStatus Power::getSessionChannel(int32_t, int32_t, ChannelConfig *_aidl_return) {
-    static AidlMessageQueue<ChannelMessage, SynchronizedReadWrite> stubQueue{20, true};
-    static std::thread stubThread([&] {
-        ChannelMessage data;
-        // This loop will only run while there is data waiting
-        // to be processed, and blocks on a futex all other times
-        while (stubQueue.readBlocking(&data, 1, 0)) {
+static int64_t channelKey(int32_t tgid, int32_t uid) {
+    return (static_cast<int64_t>(tgid) << 32) | static_cast<uint32_t>(uid);
+}
+
+ndk::ScopedAStatus Power::getSessionChannel(int32_t tgid, int32_t uid,
+                                            ChannelConfig *_aidl_return) {
+    const int64_t key = channelKey(tgid, uid);
+    std::lock_guard<std::mutex> lock(mChannelsMutex);
+    auto &channel = mChannels[key];
+    if (!channel) {
+        channel = std::make_unique<SessionChannel>(tgid, uid);
+        if (!channel->isValid()) {
+            mChannels.erase(key);
+            return ndk::ScopedAStatus::fromExceptionCode(EX_ILLEGAL_STATE);
         }
-    });
-    _aidl_return->channelDescriptor = stubQueue.dupeDesc();
-    _aidl_return->readFlagBitmask = 0x01;
-    _aidl_return->writeFlagBitmask = 0x02;
-    _aidl_return->eventFlagDescriptor = std::nullopt;
+    }
+    channel->getConfig(_aidl_return);
     return ndk::ScopedAStatus::ok();
 }
 
-ndk::ScopedAStatus Power::closeSessionChannel(int32_t, int32_t) {
+ndk::ScopedAStatus Power::closeSessionChannel(int32_t tgid, int32_t uid) {
+    std::lock_guard<std::mutex> lock(mChannelsMutex);
+    if (mChannels.erase(channelKey(tgid, uid)) == 0) {
+        return ndk::ScopedAStatus::fromExceptionCode(EX_ILLEGAL_ARGUMENT);
+    }
     return ndk::ScopedAStatus::ok();
 }
 
@@ -20,10 +20,15 @@
 
 #include <atomic>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "aidl/android/hardware/power/ChannelConfig.h"
 #include "aidl/android/hardware/power/SessionConfig.h"
+#include "SessionChannel.h"
 #include "disp-power/DisplayLowPower.h"
 #include "disp-power/InteractionHandler.h"
 
@@ -63,11 +68,27 @@ class Power : public ::aidl::android::hardware::power::BnPower {
     binder_status_t dump(int fd, const char **args, uint32_t numArgs) override;
 
   private:
+    // Mode/Boost ordinal -> hint name and pre-resolved HintManager hint id,
+    // built once in the constructor so the per-call dispatch in
+    // setMode/setBoost is an array index instead of a toString() allocation
+    // plus string hashing on every call.
+    struct ResolvedHint {
+        std::string name;
+        int id;
+    };
+
     std::shared_ptr<DisplayLowPower> mDisplayLowPower;
     std::unique_ptr<InteractionHandler> mInteractionHandler;
     std::atomic<bool> mVRModeOn;
     std::atomic<bool> mSustainedPerfModeOn;
     int32_t mServiceVersion;
+    std::vector<ResolvedHint> mModeHints;
+    std::vector<ResolvedHint> mBoostHints;
+
+    // One FMQ channel per (tgid, uid), created on the first getSessionChannel
+    // call and torn down on closeSessionChannel
+    std::mutex mChannelsMutex;
+    std::unordered_map<int64_t, std::unique_ptr<SessionChannel>> mChannels;
 };
 
 }  // namespace pixel
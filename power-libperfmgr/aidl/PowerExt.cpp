@@ -42,10 +42,14 @@ using ::android::perfmgr::HintManager;
 ndk::ScopedAStatus PowerExt::setMode(const std::string &mode, bool enabled) {
     LOG(DEBUG) << "PowerExt setMode: " << mode << " to: " << enabled;
 
+    // Resolve the hint string once and dispatch by id, so the hint map is
+    // hashed a single time per call instead of once for the support check
+    // and again for the action lookup.
+    const int hintId = HintManager::GetInstance()->GetHintId(mode);
     if (enabled) {
-        HintManager::GetInstance()->DoHint(mode);
+        HintManager::GetInstance()->DoHint(hintId);
     } else {
-        HintManager::GetInstance()->EndHint(mode);
+        HintManager::GetInstance()->EndHint(hintId);
     }
     if (HintManager::GetInstance()->GetAdpfProfile() &&
         HintManager::GetInstance()->GetAdpfProfile()->mReportingRateLimitNs > 0) {
@@ -73,12 +77,13 @@ ndk::ScopedAStatus PowerExt::setBoost(const std::string &boost, int32_t duration
         PowerSessionManager::getInstance()->updateHintBoost(boost, durationMs);
     }
 
+    const int hintId = HintManager::GetInstance()->GetHintId(boost);
     if (durationMs > 0) {
-        HintManager::GetInstance()->DoHint(boost, std::chrono::milliseconds(durationMs));
+        HintManager::GetInstance()->DoHint(hintId, std::chrono::milliseconds(durationMs));
     } else if (durationMs == 0) {
-        HintManager::GetInstance()->DoHint(boost);
+        HintManager::GetInstance()->DoHint(hintId);
     } else {
-        HintManager::GetInstance()->EndHint(boost);
+        HintManager::GetInstance()->EndHint(hintId);
     }
 
     return ndk::ScopedAStatus::ok();
@@ -30,8 +30,12 @@
 #include <utils/Trace.h>
 
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include "PowerSessionManager.h"
+#include "WorkDurationStatistics.h"
 
 namespace aidl {
 namespace google {
@@ -58,17 +62,34 @@ static inline int64_t ns_to_100us(int64_t ns) {
 
 }  // namespace
 
+const AdpfConfigSnapshot &PowerHintSession::adpfSnapshot() {
+    AdpfConfig *profile = HintManager::GetInstance()->GetAdpfProfilePtr();
+    if (profile != mAdpfSnapshotSource) {
+        mAdpfSnapshot = AdpfConfigSnapshot(*profile);
+        mAdpfSnapshotSource = profile;
+    }
+    return mAdpfSnapshot;
+}
+
 int64_t PowerHintSession::convertWorkDurationToBoostByPid(
-        const std::vector<WorkDuration> &actualDurations) {
-    std::shared_ptr<AdpfConfig> adpfConfig = HintManager::GetInstance()->GetAdpfProfile();
+        const std::vector<int64_t> &actualDurationsNs) {
+    const AdpfConfigSnapshot &adpfConfig = adpfSnapshot();
     const nanoseconds &targetDuration = mDescriptor->targetNs;
     int64_t &integral_error = mDescriptor->integral_error;
     int64_t &previous_error = mDescriptor->previous_error;
-    uint64_t samplingWindowP = adpfConfig->mSamplingWindowP;
-    uint64_t samplingWindowI = adpfConfig->mSamplingWindowI;
-    uint64_t samplingWindowD = adpfConfig->mSamplingWindowD;
+    uint64_t samplingWindowP = adpfConfig.samplingWindowP;
+    uint64_t samplingWindowI = adpfConfig.samplingWindowI;
+    uint64_t samplingWindowD = adpfConfig.samplingWindowD;
     int64_t targetDurationNanos = (int64_t)targetDuration.count();
-    int64_t length = actualDurations.size();
+    int64_t length = actualDurationsNs.size();
+
+    // Outlier check hoisted out of the control loop so the batch scan runs
+    // through the vectorized kernel instead of a per-element branch
+    int64_t maxAbsDurationNanos = WorkDurationMaxAbs(actualDurationsNs.data(), length);
+    if (maxAbsDurationNanos > targetDurationNanos * 20) {
+        ALOGW("The actual duration is way far from the target (%" PRId64 " >> %" PRId64 ")",
+              maxAbsDurationNanos, targetDurationNanos);
+    }
     int64_t p_start =
             samplingWindowP == 0 || samplingWindowP > length ? 0 : length - samplingWindowP;
     int64_t i_start =
@@ -79,13 +100,8 @@ int64_t PowerHintSession::convertWorkDurationToBoostByPid(
     int64_t err_sum = 0;
     int64_t derivative_sum = 0;
     for (int64_t i = std::min({p_start, i_start, d_start}); i < length; i++) {
-        int64_t actualDurationNanos = actualDurations[i].durationNanos;
-        if (std::abs(actualDurationNanos) > targetDurationNanos * 20) {
-            ALOGW("The actual duration is way far from the target (%" PRId64 " >> %" PRId64 ")",
-                  actualDurationNanos, targetDurationNanos);
-        }
         // PID control algorithm
-        int64_t error = ns_to_100us(actualDurationNanos - targetDurationNanos);
+        int64_t error = ns_to_100us(actualDurationsNs[i] - targetDurationNanos);
         if (i >= d_start) {
             derivative_sum += error - previous_error;
         }
@@ -94,27 +110,29 @@ int64_t PowerHintSession::convertWorkDurationToBoostByPid(
         }
         if (i >= i_start) {
             integral_error += error * dt;
-            integral_error = std::min(adpfConfig->getPidIHighDivI(), integral_error);
-            integral_error = std::max(adpfConfig->getPidILowDivI(), integral_error);
+            integral_error = std::min(adpfConfig.pidIHighDivI, integral_error);
+            integral_error = std::max(adpfConfig.pidILowDivI, integral_error);
         }
         previous_error = error;
     }
-    int64_t pOut = static_cast<int64_t>((err_sum > 0 ? adpfConfig->mPidPo : adpfConfig->mPidPu) *
+    int64_t pOut = static_cast<int64_t>((err_sum > 0 ? adpfConfig.pidPo : adpfConfig.pidPu) *
                                         err_sum / (length - p_start));
-    int64_t iOut = static_cast<int64_t>(adpfConfig->mPidI * integral_error);
+    int64_t iOut = static_cast<int64_t>(adpfConfig.pidI * integral_error);
     int64_t dOut =
-            static_cast<int64_t>((derivative_sum > 0 ? adpfConfig->mPidDo : adpfConfig->mPidDu) *
+            static_cast<int64_t>((derivative_sum > 0 ? adpfConfig.pidDo : adpfConfig.pidDu) *
                                  derivative_sum / dt / (length - d_start));
 
     int64_t output = pOut + iOut + dOut;
-    ATRACE_INT(mAppDescriptorTrace.trace_pid_err.c_str(), err_sum / (length - p_start));
-    ATRACE_INT(mAppDescriptorTrace.trace_pid_integral.c_str(), integral_error);
-    ATRACE_INT(mAppDescriptorTrace.trace_pid_derivative.c_str(),
-               derivative_sum / dt / (length - d_start));
-    ATRACE_INT(mAppDescriptorTrace.trace_pid_pOut.c_str(), pOut);
-    ATRACE_INT(mAppDescriptorTrace.trace_pid_iOut.c_str(), iOut);
-    ATRACE_INT(mAppDescriptorTrace.trace_pid_dOut.c_str(), dOut);
-    ATRACE_INT(mAppDescriptorTrace.trace_pid_output.c_str(), output);
+    if (mAppDescriptorTrace.enabled()) {
+        ATRACE_INT(mAppDescriptorTrace.trace_pid_err.c_str(), err_sum / (length - p_start));
+        ATRACE_INT(mAppDescriptorTrace.trace_pid_integral.c_str(), integral_error);
+        ATRACE_INT(mAppDescriptorTrace.trace_pid_derivative.c_str(),
+                   derivative_sum / dt / (length - d_start));
+        ATRACE_INT(mAppDescriptorTrace.trace_pid_pOut.c_str(), pOut);
+        ATRACE_INT(mAppDescriptorTrace.trace_pid_iOut.c_str(), iOut);
+        ATRACE_INT(mAppDescriptorTrace.trace_pid_dOut.c_str(), dOut);
+        ATRACE_INT(mAppDescriptorTrace.trace_pid_output.c_str(), output);
+    }
     return output;
 }
 
@@ -133,18 +151,70 @@ AppHintDesc::AppHintDesc(int64_t sessionId, int32_t tgid, int32_t uid,
       integral_error(0),
       previous_error(0) {}
 
+namespace {
+// Free list of descriptors from closed sessions, shared by all sessions in
+// the service. Bounded so a burst of closures cannot pin memory.
+constexpr size_t kDescPoolDepth = 16;
+std::mutex sDescPoolMutex;
+std::vector<std::unique_ptr<AppHintDesc>> sDescPool;
+}  // namespace
+
+std::shared_ptr<AppHintDesc> AppHintDesc::obtain(int64_t sessionId, int32_t tgid, int32_t uid,
+                                                 const std::vector<int32_t> &threadIds,
+                                                 SessionTag tag,
+                                                 std::chrono::nanoseconds pTargetNs) {
+    std::unique_ptr<AppHintDesc> desc;
+    {
+        std::lock_guard<std::mutex> lock(sDescPoolMutex);
+        if (!sDescPool.empty()) {
+            desc = std::move(sDescPool.back());
+            sDescPool.pop_back();
+        }
+    }
+    if (!desc) {
+        desc = std::make_unique<AppHintDesc>(sessionId, tgid, uid, threadIds, tag, pTargetNs);
+    } else {
+        desc->sessionId = sessionId;
+        desc->tgid = tgid;
+        desc->uid = uid;
+        desc->targetNs = pTargetNs;
+        // assign() reuses the vector's existing capacity
+        desc->thread_ids.assign(threadIds.begin(), threadIds.end());
+        desc->tag = tag;
+        desc->pidControlVariable = 0;
+        desc->is_active = true;
+        desc->update_count = 0;
+        desc->integral_error = 0;
+        desc->previous_error = 0;
+    }
+    // The deleter returns the descriptor to the free list, so reuse is tied
+    // to the last reference dropping: the session's heuristic worker can
+    // still hold the descriptor while the session itself is being destroyed.
+    return std::shared_ptr<AppHintDesc>(desc.release(), [](AppHintDesc *p) {
+        std::unique_ptr<AppHintDesc> retired(p);
+        std::lock_guard<std::mutex> lock(sDescPoolMutex);
+        if (sDescPool.size() < kDescPoolDepth) {
+            sDescPool.emplace_back(std::move(retired));
+        }
+    });
+}
+
 PowerHintSession::PowerHintSession(int32_t tgid, int32_t uid, const std::vector<int32_t> &threadIds,
                                    int64_t durationNs, SessionTag tag)
     : mPSManager(PowerSessionManager::getInstance()),
       mSessionId(++sSessionIDCounter),
       mIdString(StringPrintf("%" PRId32 "-%" PRId32 "-%" PRId64, tgid, uid, mSessionId)),
-      mDescriptor(std::make_shared<AppHintDesc>(mSessionId, tgid, uid, threadIds, tag,
-                                                std::chrono::nanoseconds(durationNs))),
+      mDescriptor(AppHintDesc::obtain(mSessionId, tgid, uid, threadIds, tag,
+                                      std::chrono::nanoseconds(durationNs))),
       mAppDescriptorTrace(mIdString),
-      mTag(tag) {
+      mTag(tag),
+      mHeuristicWorker([this](const auto &) { evaluateReportedDurations(); },
+                       PowerSessionManager::getInstance()->getWorkerPool()) {
     ATRACE_CALL();
-    ATRACE_INT(mAppDescriptorTrace.trace_target.c_str(), mDescriptor->targetNs.count());
-    ATRACE_INT(mAppDescriptorTrace.trace_active.c_str(), mDescriptor->is_active.load());
+    if (mAppDescriptorTrace.enabled()) {
+        ATRACE_INT(mAppDescriptorTrace.trace_target.c_str(), mDescriptor->targetNs.count());
+        ATRACE_INT(mAppDescriptorTrace.trace_active.c_str(), mDescriptor->is_active.load());
+    }
 
     mLastUpdatedTime.store(std::chrono::steady_clock::now());
     mPSManager->addPowerSession(mIdString, mDescriptor, threadIds);
@@ -164,9 +234,11 @@ PowerHintSession::~PowerHintSession() {
     ATRACE_CALL();
     close();
     ALOGV("PowerHintSession deleted: %s", mDescriptor->toString().c_str());
-    ATRACE_INT(mAppDescriptorTrace.trace_target.c_str(), 0);
-    ATRACE_INT(mAppDescriptorTrace.trace_actl_last.c_str(), 0);
-    ATRACE_INT(mAppDescriptorTrace.trace_active.c_str(), 0);
+    if (mAppDescriptorTrace.enabled()) {
+        ATRACE_INT(mAppDescriptorTrace.trace_target.c_str(), 0);
+        ATRACE_INT(mAppDescriptorTrace.trace_actl_last.c_str(), 0);
+        ATRACE_INT(mAppDescriptorTrace.trace_active.c_str(), 0);
+    }
 }
 
 bool PowerHintSession::isAppSession() {
@@ -184,7 +256,9 @@ void PowerHintSession::updatePidControlVariable(int pidControlVariable, bool upd
                                                                 adpfConfig->mStaleTimeFactor),
                                      nanoseconds(adpfConfig->mReportingRateLimitNs) * 2));
     }
-    ATRACE_INT(mAppDescriptorTrace.trace_min.c_str(), pidControlVariable);
+    if (mAppDescriptorTrace.enabled()) {
+        ATRACE_INT(mAppDescriptorTrace.trace_min.c_str(), pidControlVariable);
+    }
 }
 
 void PowerHintSession::tryToSendPowerHint(std::string hint) {
@@ -214,8 +288,10 @@ ndk::ScopedAStatus PowerHintSession::pause() {
     mPSManager->setThreadsFromPowerSession(mSessionId, {});
     mDescriptor->is_active.store(false);
     mPSManager->pause(mSessionId);
-    ATRACE_INT(mAppDescriptorTrace.trace_active.c_str(), false);
-    ATRACE_INT(mAppDescriptorTrace.trace_min.c_str(), 0);
+    if (mAppDescriptorTrace.enabled()) {
+        ATRACE_INT(mAppDescriptorTrace.trace_active.c_str(), false);
+        ATRACE_INT(mAppDescriptorTrace.trace_min.c_str(), 0);
+    }
     return ndk::ScopedAStatus::ok();
 }
 
@@ -230,8 +306,10 @@ ndk::ScopedAStatus PowerHintSession::resume() {
     mDescriptor->is_active.store(true);
     // resume boost
     mPSManager->resume(mSessionId);
-    ATRACE_INT(mAppDescriptorTrace.trace_active.c_str(), true);
-    ATRACE_INT(mAppDescriptorTrace.trace_min.c_str(), mDescriptor->pidControlVariable);
+    if (mAppDescriptorTrace.enabled()) {
+        ATRACE_INT(mAppDescriptorTrace.trace_active.c_str(), true);
+        ATRACE_INT(mAppDescriptorTrace.trace_min.c_str(), mDescriptor->pidControlVariable);
+    }
     return ndk::ScopedAStatus::ok();
 }
 
@@ -243,7 +321,9 @@ ndk::ScopedAStatus PowerHintSession::close() {
     // Remove the session from PowerSessionManager first to avoid racing.
     mPSManager->removePowerSession(mSessionId);
     mDescriptor->is_active.store(false);
-    ATRACE_INT(mAppDescriptorTrace.trace_min.c_str(), 0);
+    if (mAppDescriptorTrace.enabled()) {
+        ATRACE_INT(mAppDescriptorTrace.trace_min.c_str(), 0);
+    }
     return ndk::ScopedAStatus::ok();
 }
 
@@ -262,7 +342,9 @@ ndk::ScopedAStatus PowerHintSession::updateTargetWorkDuration(int64_t targetDura
     mDescriptor->targetNs = std::chrono::nanoseconds(targetDurationNanos);
     mPSManager->updateTargetWorkDuration(mSessionId, AdpfHintType::ADPF_VOTE_DEFAULT,
                                          mDescriptor->targetNs);
-    ATRACE_INT(mAppDescriptorTrace.trace_target.c_str(), targetDurationNanos);
+    if (mAppDescriptorTrace.enabled()) {
+        ATRACE_INT(mAppDescriptorTrace.trace_target.c_str(), targetDurationNanos);
+    }
 
     return ndk::ScopedAStatus::ok();
 }
@@ -285,16 +367,18 @@ ndk::ScopedAStatus PowerHintSession::reportActualWorkDuration(
         ALOGE("Error: shouldn't report duration during pause state.");
         return ndk::ScopedAStatus::fromExceptionCode(EX_ILLEGAL_STATE);
     }
-    auto adpfConfig = HintManager::GetInstance()->GetAdpfProfile();
     mDescriptor->update_count++;
     bool isFirstFrame = isTimeout();
-    ATRACE_INT(mAppDescriptorTrace.trace_batch_size.c_str(), actualDurations.size());
-    ATRACE_INT(mAppDescriptorTrace.trace_actl_last.c_str(), actualDurations.back().durationNanos);
-    ATRACE_INT(mAppDescriptorTrace.trace_target.c_str(), mDescriptor->targetNs.count());
-    ATRACE_INT(mAppDescriptorTrace.trace_hint_count.c_str(), mDescriptor->update_count);
-    ATRACE_INT(mAppDescriptorTrace.trace_hint_overtime.c_str(),
-               actualDurations.back().durationNanos - mDescriptor->targetNs.count() > 0);
-    ATRACE_INT(mAppDescriptorTrace.trace_is_first_frame.c_str(), (isFirstFrame) ? (1) : (0));
+    if (mAppDescriptorTrace.enabled()) {
+        ATRACE_INT(mAppDescriptorTrace.trace_batch_size.c_str(), actualDurations.size());
+        ATRACE_INT(mAppDescriptorTrace.trace_actl_last.c_str(),
+                   actualDurations.back().durationNanos);
+        ATRACE_INT(mAppDescriptorTrace.trace_target.c_str(), mDescriptor->targetNs.count());
+        ATRACE_INT(mAppDescriptorTrace.trace_hint_count.c_str(), mDescriptor->update_count);
+        ATRACE_INT(mAppDescriptorTrace.trace_hint_overtime.c_str(),
+                   actualDurations.back().durationNanos - mDescriptor->targetNs.count() > 0);
+        ATRACE_INT(mAppDescriptorTrace.trace_is_first_frame.c_str(), (isFirstFrame) ? (1) : (0));
+    }
 
     mLastUpdatedTime.store(std::chrono::steady_clock::now());
     if (isFirstFrame) {
@@ -305,22 +389,63 @@ ndk::ScopedAStatus PowerHintSession::reportActualWorkDuration(
         mPSManager->updateUniversalBoostMode();
     }
 
+    // Stage the batch in the ring and hand the heuristic to the background
+    // worker so the binder call returns immediately. The uclamp vote lands one
+    // scheduling hop later, which is well inside the staleness the votes
+    // already tolerate. If the ring is full the overflow is dropped: the PID
+    // input window just gets shorter for one evaluation.
+    const uint64_t tail = mReportTail.load(std::memory_order_acquire);
+    uint64_t head = mReportHead.load(std::memory_order_relaxed);
+    size_t appended = 0;
+    for (const auto &d : actualDurations) {
+        if (head - tail >= kReportRingSize) {
+            ALOGV("Report ring full on session %s, dropping %zu duration(s)", mIdString.c_str(),
+                  actualDurations.size() - appended);
+            break;
+        }
+        mReportRing[head % kReportRingSize] = d.durationNanos;
+        head++;
+        appended++;
+    }
+    mReportHead.store(head, std::memory_order_release);
+    mHeuristicWorker.schedule(EventEvaluate{});
+    return ndk::ScopedAStatus::ok();
+}
+
+void PowerHintSession::evaluateReportedDurations() {
+    if (mSessionClosed.load() || !mDescriptor->is_active.load()) {
+        return;
+    }
+
+    // Drain everything reported since the last evaluation
+    uint64_t tail = mReportTail.load(std::memory_order_relaxed);
+    const uint64_t head = mReportHead.load(std::memory_order_acquire);
+    if (head == tail) {
+        return;
+    }
+    std::vector<int64_t> batch;
+    batch.reserve(head - tail);
+    for (; tail != head; ++tail) {
+        batch.push_back(mReportRing[tail % kReportRingSize]);
+    }
+    mReportTail.store(tail, std::memory_order_release);
+
     mPSManager->disableBoosts(mSessionId);
 
-    if (!adpfConfig->mPidOn) {
-        updatePidControlVariable(adpfConfig->mUclampMinHigh);
-        return ndk::ScopedAStatus::ok();
+    const AdpfConfigSnapshot &adpfConfig = adpfSnapshot();
+    if (!adpfConfig.pidOn()) {
+        updatePidControlVariable(adpfConfig.uclampMinHigh);
+        return;
     }
 
-    int64_t output = convertWorkDurationToBoostByPid(actualDurations);
+    int64_t output = convertWorkDurationToBoostByPid(batch);
 
     // Apply to all the threads in the group
-    int next_min = std::min(static_cast<int>(adpfConfig->mUclampMinHigh),
+    int next_min = std::min(static_cast<int>(adpfConfig.uclampMinHigh),
                             mDescriptor->pidControlVariable + static_cast<int>(output));
-    next_min = std::max(static_cast<int>(adpfConfig->mUclampMinLow), next_min);
+    next_min = std::max(static_cast<int>(adpfConfig.uclampMinLow), next_min);
 
     updatePidControlVariable(next_min);
-    return ndk::ScopedAStatus::ok();
 }
 
 ndk::ScopedAStatus PowerHintSession::sendHint(SessionHint hint) {
@@ -336,10 +461,12 @@ ndk::ScopedAStatus PowerHintSession::sendHint(SessionHint hint) {
 
     switch (hint) {
         case SessionHint::CPU_LOAD_UP:
+            // Latency sensitive: stage the boost floor straight into the
+            // batched sched_setattr engine instead of recomputing all votes.
             updatePidControlVariable(mDescriptor->pidControlVariable);
-            mPSManager->voteSet(mSessionId, AdpfHintType::ADPF_CPU_LOAD_UP,
-                                adpfConfig->mUclampMinHigh, kUclampMax,
-                                std::chrono::steady_clock::now(), mDescriptor->targetNs * 2);
+            mPSManager->voteSetFast(mSessionId, AdpfHintType::ADPF_CPU_LOAD_UP,
+                                    adpfConfig->mUclampMinHigh, std::chrono::steady_clock::now(),
+                                    mDescriptor->targetNs * 2);
             break;
         case SessionHint::CPU_LOAD_DOWN:
             updatePidControlVariable(adpfConfig->mUclampMinLow);
@@ -375,10 +502,17 @@ ndk::ScopedAStatus PowerHintSession::sendHint(SessionHint hint) {
             ALOGE("Error: hint is invalid");
             return ndk::ScopedAStatus::fromExceptionCode(EX_ILLEGAL_ARGUMENT);
     }
-    tryToSendPowerHint(toString(hint));
+    if (hint != SessionHint::CPU_LOAD_UP) {
+        // Load-up took the uclamp fast path above; routing it through the
+        // string-keyed hint pipeline would add node-looper latency for a
+        // boost that must land within a frame.
+        tryToSendPowerHint(toString(hint));
+    }
     mLastUpdatedTime.store(std::chrono::steady_clock::now());
     mLastHintSent = static_cast<int>(hint);
-    ATRACE_INT(mAppDescriptorTrace.trace_session_hint.c_str(), static_cast<int>(hint));
+    if (mAppDescriptorTrace.enabled()) {
+        ATRACE_INT(mAppDescriptorTrace.trace_session_hint.c_str(), static_cast<int>(hint));
+    }
     return ndk::ScopedAStatus::ok();
 }
 
@@ -397,7 +531,9 @@ ndk::ScopedAStatus PowerHintSession::setMode(SessionMode mode, bool enabled) {
     }
 
     mModes[static_cast<size_t>(mode)] = enabled;
-    ATRACE_INT(mAppDescriptorTrace.trace_modes[static_cast<size_t>(mode)].c_str(), enabled);
+    if (mAppDescriptorTrace.enabled()) {
+        ATRACE_INT(mAppDescriptorTrace.trace_modes[static_cast<size_t>(mode)].c_str(), enabled);
+    }
     mLastUpdatedTime.store(std::chrono::steady_clock::now());
     return ndk::ScopedAStatus::ok();
 }
@@ -27,7 +27,9 @@
 #include <array>
 #include <unordered_map>
 
+#include "AdpfTypes.h"
 #include "AppDescriptorTrace.h"
+#include "BackgroundWorker.h"
 
 namespace aidl {
 namespace google {
@@ -60,10 +62,19 @@ struct AppHintDesc {
     AppHintDesc(int64_t sessionId, int32_t tgid, int32_t uid, const std::vector<int32_t> &threadIds,
                 SessionTag tag, std::chrono::nanoseconds pTargetNs);
 
+    // Pooled construction: session churn on app startup is hot, so closed
+    // sessions' descriptors go on a bounded free list and obtain() hands one
+    // back re-initialized - the thread id vector keeps its capacity - instead
+    // of allocating. The returned pointer's deleter recycles the descriptor
+    // when the last reference drops.
+    static std::shared_ptr<AppHintDesc> obtain(int64_t sessionId, int32_t tgid, int32_t uid,
+                                               const std::vector<int32_t> &threadIds,
+                                               SessionTag tag, std::chrono::nanoseconds pTargetNs);
+
     std::string toString() const;
     int64_t sessionId{0};
-    const int32_t tgid;
-    const int32_t uid;
+    int32_t tgid;
+    int32_t uid;
     nanoseconds targetNs;
     std::vector<int32_t> thread_ids;
     SessionTag tag;
@@ -106,7 +117,7 @@ class PowerHintSession : public BnPowerHintSession {
   private:
     void tryToSendPowerHint(std::string hint);
     void updatePidControlVariable(int pidControlVariable, bool updateVote = true);
-    int64_t convertWorkDurationToBoostByPid(const std::vector<WorkDuration> &actualDurations);
+    int64_t convertWorkDurationToBoostByPid(const std::vector<int64_t> &actualDurationsNs);
     // Data
     sp<PowerSessionManager> mPSManager;
     int64_t mSessionId = 0;
@@ -124,6 +135,32 @@ class PowerHintSession : public BnPowerHintSession {
     std::array<bool, enum_size<SessionMode>()> mModes{};
     // Tag labeling what kind of session this is
     SessionTag mTag;
+
+    // Deferred heuristic evaluation: reportActualWorkDuration only appends the
+    // incoming batch to this ring and schedules mHeuristicWorker, so the binder
+    // call returns without running the PID computation or taking the session
+    // lock. The ring is single-producer single-consumer: reports for a session
+    // come from one client thread, and the worker pool has a single thread so
+    // evaluations are serialized.
+    struct EventEvaluate {};
+    void evaluateReportedDurations();
+    // Snapshot of the active ADPF profile, rebuilt only when the profile
+    // pointer changes, so the heuristic reads finalized plain members.
+    // Touched exclusively from the single-threaded worker pool.
+    const AdpfConfigSnapshot &adpfSnapshot();
+    AdpfConfigSnapshot mAdpfSnapshot;
+    const ::android::perfmgr::AdpfConfig *mAdpfSnapshotSource{nullptr};
+    // The ring is structure-of-arrays: the heuristic only consumes
+    // durationNanos, and the dense int64 layout is what the statistics
+    // kernels in WorkDurationStatistics.h vectorize over.
+    static constexpr size_t kReportRingSize = 64;  // power of two
+    std::array<int64_t, kReportRingSize> mReportRing;
+    // Next slot to write (binder thread) and to read (worker thread)
+    std::atomic<uint64_t> mReportHead{0};
+    std::atomic<uint64_t> mReportTail{0};
+    // Declared last so its destructor runs first and drains any in-flight
+    // evaluation before the members above go away
+    TemplatePriorityQueueWorker<EventEvaluate> mHeuristicWorker;
 };
 
 }  // namespace pixel
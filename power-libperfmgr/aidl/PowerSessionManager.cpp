@@ -28,6 +28,8 @@
 #include <sys/syscall.h>
 #include <utils/Trace.h>
 
+#include <algorithm>
+
 #include "AdpfTypes.h"
 
 namespace aidl {
@@ -118,7 +120,7 @@ void PowerSessionManager::addPowerSession(const std::string &idString,
     sve.isActive = sessionDescriptor->is_active;
     sve.isAppSession = sessionDescriptor->uid >= AID_APP_START;
     sve.lastUpdatedTime = timeNow;
-    sve.votes = std::make_shared<Votes>();
+    sve.votes = acquireVotes();
     sve.votes->add(
             static_cast<std::underlying_type_t<AdpfHintType>>(AdpfHintType::ADPF_VOTE_DEFAULT),
             CpuVote(false, timeNow, sessionDescriptor->targetNs, kUclampMin, kUclampMax));
@@ -135,7 +137,52 @@ void PowerSessionManager::addPowerSession(const std::string &idString,
     setThreadsFromPowerSession(sessionDescriptor->sessionId, threadIds);
 }
 
+std::shared_ptr<Votes> PowerSessionManager::acquireVotes() {
+    {
+        std::lock_guard<std::mutex> lock(mVotesPoolMutex);
+        if (!mVotesPool.empty()) {
+            auto votes = std::move(mVotesPool.back());
+            mVotesPool.pop_back();
+            return votes;
+        }
+    }
+    return std::make_shared<Votes>();
+}
+
+void PowerSessionManager::recycleVotes(std::shared_ptr<Votes> votes) {
+    // Only a sole owner may be reset and reused; the task map side can still
+    // hold references briefly while a removal is in flight
+    if (!votes || votes.use_count() != 1) {
+        return;
+    }
+    votes->reset();
+    std::lock_guard<std::mutex> lock(mVotesPoolMutex);
+    if (mVotesPool.size() < kVotesPoolDepth) {
+        mVotesPool.emplace_back(std::move(votes));
+    }
+}
+
+void PowerSessionManager::registerSession(const std::shared_ptr<PowerHintSession> &session,
+                                          int64_t sessionId) {
+    std::lock_guard<std::mutex> lock(mSessionRegistryMutex);
+    mSessionRegistry[sessionId] = session;
+}
+
+std::shared_ptr<PowerHintSession> PowerSessionManager::getSession(int64_t sessionId) {
+    std::lock_guard<std::mutex> lock(mSessionRegistryMutex);
+    auto it = mSessionRegistry.find(sessionId);
+    if (it == mSessionRegistry.end()) {
+        return nullptr;
+    }
+    return it->second.lock();
+}
+
 void PowerSessionManager::removePowerSession(int64_t sessionId) {
+    {
+        std::lock_guard<std::mutex> lock(mSessionRegistryMutex);
+        mSessionRegistry.erase(sessionId);
+    }
+
     // To remove a session we also need to undo the effects the session
     // has on currently enabled votes which means setting vote to inactive
     // and then forceing a uclamp update to occur
@@ -143,15 +190,21 @@ void PowerSessionManager::removePowerSession(int64_t sessionId) {
 
     std::vector<pid_t> addedThreads;
     std::vector<pid_t> removedThreads;
+    std::shared_ptr<Votes> retiredVotes;
 
     {
         // Wait till end to remove session because it needs to be around for apply U clamp
         // to work above since applying the uclamp needs a valid session id
         std::lock_guard<std::mutex> lock(mSessionTaskMapMutex);
+        if (auto sessionVal = mSessionTaskMap.findSession(sessionId)) {
+            retiredVotes = sessionVal->votes;
+        }
         mSessionTaskMap.replace(sessionId, {}, &addedThreads, &removedThreads);
         mSessionTaskMap.remove(sessionId);
     }
 
+    recycleVotes(std::move(retiredVotes));
+
     for (auto tid : removedThreads) {
         if (!SetTaskProfiles(tid, {"NoResetUclampGrp"})) {
             ALOGE("Failed to set NoResetUclampGrp task profile for tid:%d", tid);
@@ -163,10 +216,47 @@ void PowerSessionManager::setThreadsFromPowerSession(int64_t sessionId,
                                                      const std::vector<int32_t> &threadIds) {
     std::vector<pid_t> addedThreads;
     std::vector<pid_t> removedThreads;
-    forceSessionActive(sessionId, false);
+    // Every tid entering or leaving the session; unchanged tids keep their
+    // current uclamp and are not touched, so a thread-pool resize costs
+    // O(delta) syscalls instead of a deactivate/reactivate pass over the
+    // whole session.
+    std::vector<pid_t> changedThreads;
+    const bool uclampMinOn = HintManager::GetInstance()->GetAdpfProfile()->mUclampMinOn;
+    const auto timeNow = std::chrono::steady_clock::now();
+    bool scheduleApply = false;
     {
         std::lock_guard<std::mutex> lock(mSessionTaskMapMutex);
+        auto sessValPtr = mSessionTaskMap.findSession(sessionId);
+        if (nullptr == sessValPtr) {
+            return;
+        }
+        // Copy: replace() overwrites the linked task list
+        const std::vector<pid_t> oldTids = mSessionTaskMap.getTaskIds(sessionId);
         mSessionTaskMap.replace(sessionId, threadIds, &addedThreads, &removedThreads);
+        for (auto tid : oldTids) {
+            if (std::find(threadIds.begin(), threadIds.end(), tid) == threadIds.end()) {
+                changedThreads.push_back(tid);
+            }
+        }
+        for (auto tid : threadIds) {
+            if (std::find(oldTids.begin(), oldTids.end(), tid) == oldTids.end()) {
+                changedThreads.push_back(tid);
+            }
+        }
+        if (uclampMinOn && !changedThreads.empty()) {
+            // Stage the recomputed floors into the batched apply engine:
+            // joiners pick up the session's votes, leavers drop them (tids
+            // in no session fall back to the default range).
+            std::lock_guard<std::mutex> applyLock(mPendingUclampMutex);
+            for (const auto tid : changedThreads) {
+                UclampRange uclampRange;
+                mSessionTaskMap.getTaskVoteRange(tid, timeNow, &uclampRange.uclampMin,
+                                                 &uclampRange.uclampMax);
+                mPendingUclamp[tid] = {uclampRange.uclampMin, sessionId};
+            }
+            scheduleApply = true;
+        }
+        sessValPtr->lastUpdatedTime = timeNow;
     }
     for (auto tid : addedThreads) {
         if (!SetTaskProfiles(tid, {"ResetUclampGrp"})) {
@@ -178,7 +268,9 @@ void PowerSessionManager::setThreadsFromPowerSession(int64_t sessionId,
             ALOGE("Failed to set NoResetUclampGrp task profile for tid:%d", tid);
         }
     }
-    forceSessionActive(sessionId, true);
+    if (scheduleApply) {
+        mApplyUclampWorker.schedule(EventApplyUclamp{});
+    }
 }
 
 std::optional<bool> PowerSessionManager::isAnyAppSessionActive() {
@@ -326,6 +418,59 @@ void PowerSessionManager::voteSet(int64_t sessionId, AdpfHintType voteId, int uc
     }
 }
 
+void PowerSessionManager::voteSetFast(int64_t sessionId, AdpfHintType voteId, int uclampMin,
+                                      std::chrono::steady_clock::time_point startTime,
+                                      std::chrono::nanoseconds durationNs) {
+    const int voteIdInt = static_cast<std::underlying_type_t<AdpfHintType>>(voteId);
+    const auto timeoutDeadline = startTime + durationNs;
+    const bool uclampMinOn = HintManager::GetInstance()->GetAdpfProfile()->mUclampMinOn;
+    bool scheduleTimeout = false;
+    bool scheduleApply = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mSessionTaskMapMutex);
+        auto sessValPtr = mSessionTaskMap.findSession(sessionId);
+        if (nullptr == sessValPtr) {
+            return;
+        }
+
+        if (!sessValPtr->votes->voteIsActive(voteIdInt) ||
+            timeoutDeadline < sessValPtr->votes->voteTimeout(voteIdInt)) {
+            scheduleTimeout = true;
+        }
+        sessValPtr->votes->add(voteIdInt,
+                               CpuVote(true, startTime, durationNs, uclampMin, kUclampMax));
+        sessValPtr->lastUpdatedTime = startTime;
+
+        if (uclampMinOn) {
+            // A boost can only raise the floor, so skip the full vote-range
+            // recompute and lift each task's staged value to the boost
+            // directly. The timeout handler runs the exact recompute when the
+            // boost expires.
+            auto &threadList = mSessionTaskMap.getTaskIds(sessionId);
+            std::lock_guard<std::mutex> applyLock(mPendingUclampMutex);
+            for (const auto threadId : threadList) {
+                auto &pending = mPendingUclamp[threadId];
+                pending.uclampMin = std::max(pending.uclampMin, uclampMin);
+                pending.sessionId = sessionId;
+            }
+            scheduleApply = !threadList.empty();
+        }
+    }
+
+    if (scheduleApply) {
+        mApplyUclampWorker.schedule(EventApplyUclamp{});
+    }
+
+    if (scheduleTimeout) {
+        EventSessionTimeout eTimeout;
+        eTimeout.timeStamp = startTime;
+        eTimeout.sessionId = sessionId;
+        eTimeout.voteId = voteIdInt;
+        mEventSessionTimeoutWorker.schedule(eTimeout, timeoutDeadline);
+    }
+}
+
 void PowerSessionManager::disableBoosts(int64_t sessionId) {
     {
         std::lock_guard<std::mutex> lock(mSessionTaskMapMutex);
@@ -412,6 +557,7 @@ void PowerSessionManager::applyUclamp(int64_t sessionId,
                                       std::chrono::steady_clock::time_point timePoint) {
     const bool uclampMinOn = HintManager::GetInstance()->GetAdpfProfile()->mUclampMinOn;
 
+    bool scheduleApply = false;
     {
         std::lock_guard<std::mutex> lock(mSessionTaskMapMutex);
         auto sessValPtr = mSessionTaskMap.findSession(sessionId);
@@ -422,28 +568,55 @@ void PowerSessionManager::applyUclamp(int64_t sessionId,
         if (!uclampMinOn) {
             ALOGV("PowerSessionManager::set_uclamp_min: skip");
         } else {
+            // Compute the per-task deltas under the lock; the syscalls run on
+            // the apply worker so a many-threaded session does not serialize
+            // its sched_setattr calls on the caller.
             auto &threadList = mSessionTaskMap.getTaskIds(sessionId);
-            auto tidIter = threadList.begin();
-            while (tidIter != threadList.end()) {
+            std::lock_guard<std::mutex> applyLock(mPendingUclampMutex);
+            for (const auto threadId : threadList) {
                 UclampRange uclampRange;
-                mSessionTaskMap.getTaskVoteRange(*tidIter, timePoint, &uclampRange.uclampMin,
+                mSessionTaskMap.getTaskVoteRange(threadId, timePoint, &uclampRange.uclampMin,
                                                  &uclampRange.uclampMax);
-                int stat = set_uclamp_min(*tidIter, uclampRange.uclampMin);
-                if (stat == ESRCH) {
-                    ALOGV("Removing dead thread %d from hint session %s.", *tidIter,
-                          sessValPtr->idString.c_str());
-                    if (mSessionTaskMap.removeDeadTaskSessionMap(sessionId, *tidIter)) {
-                        ALOGV("Removed dead thread-session map.");
-                    }
-                    tidIter = threadList.erase(tidIter);
-                } else {
-                    tidIter++;
-                }
+                // Last write wins so repeated vote changes within a frame
+                // collapse to one syscall per task
+                mPendingUclamp[threadId] = {uclampRange.uclampMin, sessionId};
             }
+            scheduleApply = !mPendingUclamp.empty();
         }
 
         sessValPtr->lastUpdatedTime = timePoint;
     }
+    if (scheduleApply) {
+        mApplyUclampWorker.schedule(EventApplyUclamp{});
+    }
+}
+
+void PowerSessionManager::applyPendingUclamp() {
+    std::unordered_map<pid_t, PendingUclamp> batch;
+    {
+        std::lock_guard<std::mutex> lock(mPendingUclampMutex);
+        batch.swap(mPendingUclamp);
+    }
+    for (const auto &[threadId, pending] : batch) {
+        if (set_uclamp_min(threadId, pending.uclampMin) == ESRCH) {
+            removeDeadThread(pending.sessionId, threadId);
+        }
+    }
+}
+
+void PowerSessionManager::removeDeadThread(int64_t sessionId, pid_t threadId) {
+    std::lock_guard<std::mutex> lock(mSessionTaskMapMutex);
+    auto sessValPtr = mSessionTaskMap.findSession(sessionId);
+    if (nullptr == sessValPtr) {
+        return;
+    }
+    ALOGV("Removing dead thread %d from hint session %s.", threadId, sessValPtr->idString.c_str());
+    if (mSessionTaskMap.removeDeadTaskSessionMap(sessionId, threadId)) {
+        ALOGV("Removed dead thread-session map.");
+    }
+    auto &threadList = mSessionTaskMap.getTaskIds(sessionId);
+    threadList.erase(std::remove(threadList.begin(), threadList.end(), threadId),
+                     threadList.end());
 }
 
 void PowerSessionManager::forceSessionActive(int64_t sessionId, bool isActive) {
@@ -22,6 +22,7 @@
 
 #include <mutex>
 #include <optional>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "BackgroundWorker.h"
@@ -70,14 +71,32 @@ class PowerSessionManager : public ::android::RefBase {
                  std::chrono::steady_clock::time_point startTime,
                  std::chrono::nanoseconds durationNs);
 
+    // Fast path for load-up style boosts: records the vote like voteSet but
+    // stages the boost floor straight into the batched sched_setattr engine
+    // instead of recomputing every vote on every task. Only valid for votes
+    // that raise the uclamp floor; the regular timeout/recompute machinery
+    // settles the exact value when the vote expires.
+    void voteSetFast(int64_t sessionId, AdpfHintType voteId, int uclampMin,
+                     std::chrono::steady_clock::time_point startTime,
+                     std::chrono::nanoseconds durationNs);
+
     void disableBoosts(int64_t sessionId);
 
+    // Registry of live session objects, so the FMQ channel drain can route a
+    // ChannelMessage's session id back to its PowerHintSession. Entries are
+    // weak: ownership stays with the client's binder reference.
+    void registerSession(const std::shared_ptr<PowerHintSession> &session, int64_t sessionId);
+    std::shared_ptr<PowerHintSession> getSession(int64_t sessionId);
+
     // Singleton
     static sp<PowerSessionManager> getInstance() {
         static sp<PowerSessionManager> instance = new PowerSessionManager();
         return instance;
     }
 
+    // Shared background pool, for workers owned by individual sessions
+    std::shared_ptr<PriorityQueueWorkerPool> getWorkerPool() { return mPriorityQueueWorkerPool; }
+
   private:
     std::optional<bool> isAnyAppSessionActive();
     void disableSystemTopAppBoost();
@@ -89,6 +108,21 @@ class PowerSessionManager : public ::android::RefBase {
     // Rewrite specific
     mutable std::mutex mSessionTaskMapMutex;
     SessionTaskMap mSessionTaskMap;
+
+    // Session object registry; expired entries are reaped when their session
+    // is removed
+    std::mutex mSessionRegistryMutex;
+    std::unordered_map<int64_t, std::weak_ptr<PowerHintSession>> mSessionRegistry;
+
+    // Free list of vote stores from closed sessions. Apps churn sessions on
+    // the startup critical path; handing a recycled Votes object to the next
+    // createHintSession replaces two hash-map constructions with a pointer
+    // swap. Bounded so a burst of closures cannot pin memory.
+    std::shared_ptr<Votes> acquireVotes();
+    void recycleVotes(std::shared_ptr<Votes> votes);
+    static constexpr size_t kVotesPoolDepth = 16;
+    std::mutex mVotesPoolMutex;
+    std::vector<std::shared_ptr<Votes>> mVotesPool;
     std::shared_ptr<PriorityQueueWorkerPool> mPriorityQueueWorkerPool;
 
     // Session timeout
@@ -100,6 +134,23 @@ class PowerSessionManager : public ::android::RefBase {
     void handleEvent(const EventSessionTimeout &e);
     TemplatePriorityQueueWorker<EventSessionTimeout> mEventSessionTimeoutWorker;
 
+    // Batched uclamp application: applyUclamp computes the (tid, uclamp min)
+    // deltas under the session lock and stages them here; the apply worker
+    // drains the whole batch outside the lock, so repeated updates to the
+    // same tid within a frame collapse to the latest vote and binder threads
+    // never serialize on per-task sched_setattr calls.
+    struct PendingUclamp {
+        int uclampMin{0};
+        int64_t sessionId{0};
+    };
+    struct EventApplyUclamp {};
+    void applyPendingUclamp();
+    // Drop a thread that sched_setattr reported dead from its session
+    void removeDeadThread(int64_t sessionId, pid_t threadId);
+    std::mutex mPendingUclampMutex;
+    std::unordered_map<pid_t, PendingUclamp> mPendingUclamp;
+    TemplatePriorityQueueWorker<EventApplyUclamp> mApplyUclampWorker;
+
     // Calculate uclamp range
     void applyUclamp(int64_t sessionId, std::chrono::steady_clock::time_point timePoint);
     // Force a session active or in-active, helper for other methods
@@ -111,7 +162,13 @@ class PowerSessionManager : public ::android::RefBase {
                                                              "ADPF_DISABLE_TA_BOOST")),
           mDisplayRefreshRate(60),
           mPriorityQueueWorkerPool(new PriorityQueueWorkerPool(1, "adpf_handler")),
-          mEventSessionTimeoutWorker([&](auto e) { handleEvent(e); }, mPriorityQueueWorkerPool) {}
+          // Timeout handling and uclamp application are the de-boost paths;
+          // they run in the urgent lane so queued bookkeeping (e.g. session
+          // heuristics) can't extend a boost past its intended duration.
+          mEventSessionTimeoutWorker([&](auto e) { handleEvent(e); }, mPriorityQueueWorkerPool,
+                                     WorkerPriority::kUrgent),
+          mApplyUclampWorker([&](const auto &) { applyPendingUclamp(); },
+                             mPriorityQueueWorkerPool, WorkerPriority::kUrgent) {}
     PowerSessionManager(PowerSessionManager const &) = delete;
     void operator=(PowerSessionManager const &) = delete;
 };
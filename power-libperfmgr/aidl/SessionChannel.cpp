@@ -0,0 +1,157 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "powerhal-libperfmgr"
+
+#include "SessionChannel.h"
+
+#include <android-base/logging.h>
+#include <android-base/stringprintf.h>
+#include <inttypes.h>
+
+#include "PowerHintSession.h"
+#include "PowerSessionManager.h"
+
+namespace aidl {
+namespace google {
+namespace hardware {
+namespace power {
+namespace impl {
+namespace pixel {
+
+using ChannelMessageContents = ChannelMessage::ChannelMessageContents;
+
+SessionChannel::SessionChannel(int32_t tgid, int32_t uid)
+    : mTgid(tgid), mUid(uid), mQueue(kQueueDepth, true) {
+    if (!mQueue.isValid()) {
+        LOG(ERROR) << "Failed to create session channel queue for tgid: " << tgid
+                   << " uid: " << uid;
+        return;
+    }
+    ::android::status_t status =
+            ::android::hardware::EventFlag::createEventFlag(mQueue.getEventFlagWord(), &mEventFlag);
+    if (status != ::android::OK || mEventFlag == nullptr) {
+        LOG(ERROR) << "Failed to create session channel event flag for tgid: " << tgid
+                   << " uid: " << uid;
+        return;
+    }
+    mDrainThread = std::thread([this]() {
+        pthread_setname_np(pthread_self(),
+                           ::android::base::StringPrintf("channel-%" PRId32, mUid).c_str());
+        drainLoop();
+    });
+}
+
+SessionChannel::~SessionChannel() {
+    if (mDrainThread.joinable()) {
+        mEventFlag->wake(kExitBit);
+        mDrainThread.join();
+    }
+    if (mEventFlag != nullptr) {
+        ::android::hardware::EventFlag::deleteEventFlag(&mEventFlag);
+    }
+}
+
+bool SessionChannel::isValid() const {
+    return mQueue.isValid() && mEventFlag != nullptr;
+}
+
+void SessionChannel::getConfig(ChannelConfig *config) {
+    config->channelDescriptor = mQueue.dupeDesc();
+    // The flag word lives inside the queue region, so no separate descriptor
+    config->eventFlagDescriptor = std::nullopt;
+    config->readFlagBitmask = kReadBit;
+    config->writeFlagBitmask = kWriteBit;
+}
+
+void SessionChannel::drainLoop() {
+    std::vector<ChannelMessage> msgs(kQueueDepth);
+    while (true) {
+        uint32_t state = 0;
+        mEventFlag->wait(kWriteBit | kExitBit, &state);
+        if (state & kExitBit) {
+            return;
+        }
+        // Drain everything that accumulated while we were processing; a
+        // client that keeps writing keeps us out of the futex entirely.
+        size_t avail;
+        while ((avail = mQueue.availableToRead()) > 0) {
+            if (!mQueue.read(msgs.data(), avail)) {
+                break;
+            }
+            mEventFlag->wake(kReadBit);
+            processMessages(msgs.data(), avail);
+        }
+    }
+}
+
+void SessionChannel::processMessages(ChannelMessage *msgs, size_t count) {
+    auto manager = PowerSessionManager::getInstance();
+    size_t i = 0;
+    while (i < count) {
+        const ChannelMessage &msg = msgs[i];
+        std::shared_ptr<PowerHintSession> session = manager->getSession(msg.sessionID);
+        if (!session) {
+            // Already closed; drop its backlog
+            ++i;
+            continue;
+        }
+        if (msg.data.getTag() == ChannelMessageContents::Tag::workDuration) {
+            // A run of duration reports for one session becomes a single
+            // reportActualWorkDuration batch
+            mDurationBatch.clear();
+            while (i < count && msgs[i].sessionID == msg.sessionID &&
+                   msgs[i].data.getTag() == ChannelMessageContents::Tag::workDuration) {
+                const auto &w = msgs[i].data.get<ChannelMessageContents::Tag::workDuration>();
+                mDurationBatch.emplace_back(WorkDuration{
+                        .timeStampNanos = msgs[i].timeStampNanos,
+                        .durationNanos = w.durationNanos,
+                        .workPeriodStartTimestampNanos = w.workPeriodStartTimestampNanos,
+                        .cpuDurationNanos = w.cpuDurationNanos,
+                        .gpuDurationNanos = w.gpuDurationNanos,
+                });
+                ++i;
+            }
+            session->reportActualWorkDuration(mDurationBatch);
+            continue;
+        }
+        switch (msg.data.getTag()) {
+            case ChannelMessageContents::Tag::targetDuration:
+                session->updateTargetWorkDuration(
+                        msg.data.get<ChannelMessageContents::Tag::targetDuration>());
+                break;
+            case ChannelMessageContents::Tag::hint:
+                session->sendHint(msg.data.get<ChannelMessageContents::Tag::hint>());
+                break;
+            case ChannelMessageContents::Tag::mode: {
+                const auto &setter = msg.data.get<ChannelMessageContents::Tag::mode>();
+                session->setMode(setter.modeInt, setter.enabled);
+                break;
+            }
+            default:
+                LOG(WARNING) << "Invalid channel message tag from tgid: " << mTgid;
+                break;
+        }
+        ++i;
+    }
+}
+
+}  // namespace pixel
+}  // namespace impl
+}  // namespace power
+}  // namespace hardware
+}  // namespace google
+}  // namespace aidl
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <aidl/android/hardware/power/ChannelConfig.h>
+#include <aidl/android/hardware/power/ChannelMessage.h>
+#include <aidl/android/hardware/power/WorkDuration.h>
+#include <fmq/AidlMessageQueue.h>
+#include <fmq/EventFlag.h>
+
+#include <thread>
+#include <vector>
+
+namespace aidl {
+namespace google {
+namespace hardware {
+namespace power {
+namespace impl {
+namespace pixel {
+
+using ::aidl::android::hardware::common::fmq::SynchronizedReadWrite;
+using ::aidl::android::hardware::power::ChannelConfig;
+using ::aidl::android::hardware::power::ChannelMessage;
+using ::aidl::android::hardware::power::WorkDuration;
+using ::android::AidlMessageQueue;
+
+// One FMQ-backed session channel for a (tgid, uid) pair. The client writes
+// ChannelMessage records into the shared ring instead of making a binder
+// transaction per reportActualWorkDuration; the drain thread blocks on the
+// queue's event flag, reads whatever has accumulated and routes each message
+// to its session through the PowerSessionManager registry. Consecutive work
+// duration reports for the same session are batched into a single
+// reportActualWorkDuration call, so a burst of frames costs one session-lock
+// acquisition rather than one per frame.
+class SessionChannel {
+  public:
+    SessionChannel(int32_t tgid, int32_t uid);
+    ~SessionChannel();
+    SessionChannel(const SessionChannel &) = delete;
+    void operator=(const SessionChannel &) = delete;
+
+    // Whether the queue and its event flag came up; an invalid channel must
+    // not be handed out to a client.
+    bool isValid() const;
+    // Fills in the descriptor and flag bitmasks for the client side.
+    void getConfig(ChannelConfig *config);
+
+  private:
+    void drainLoop();
+    void processMessages(ChannelMessage *msgs, size_t count);
+
+    // Enough for several 120 Hz frames of backlog from every session of one
+    // process before a writer would have to wait for space.
+    static constexpr size_t kQueueDepth = 256;
+    // Set by the drain thread after freeing queue space
+    static constexpr uint32_t kReadBit = 0x1;
+    // Set by the client after publishing messages
+    static constexpr uint32_t kWriteBit = 0x2;
+    // Set by the destructor to tear down the drain thread
+    static constexpr uint32_t kExitBit = 0x4;
+
+    const int32_t mTgid;
+    const int32_t mUid;
+    AidlMessageQueue<ChannelMessage, SynchronizedReadWrite> mQueue;
+    ::android::hardware::EventFlag *mEventFlag = nullptr;
+    // Reused across drain passes so the steady state allocates nothing
+    std::vector<WorkDuration> mDurationBatch;
+    std::thread mDrainThread;
+};
+
+}  // namespace pixel
+}  // namespace impl
+}  // namespace power
+}  // namespace hardware
+}  // namespace google
+}  // namespace aidl
@@ -36,6 +36,7 @@ bool SessionTaskMap::add(int64_t sessionId, const SessionValueEntry &sv,
     (*sessValPtr) = sv;
     sessValPtr->sessionId = sessionId;
 
+    mGeneration++;
     auto &sessEntry = mSessions[sessionId];
     sessEntry.val = sessValPtr;
     sessEntry.linkedTasks = taskIds;
@@ -59,10 +60,16 @@ void SessionTaskMap::addVote(int64_t sessionId, int voteId, int uclampMin, int u
 }
 
 std::shared_ptr<SessionValueEntry> SessionTaskMap::findSession(int64_t sessionId) {
+    if (sessionId == mCachedSessionId && mCachedSessionGen == mGeneration) {
+        return mCachedSession;
+    }
     auto sessItr = mSessions.find(sessionId);
     if (sessItr == mSessions.end()) {
         return nullptr;
     }
+    mCachedSessionId = sessionId;
+    mCachedSessionGen = mGeneration;
+    mCachedSession = sessItr->second.val;
     return sessItr->second.val;
 }
 
@@ -128,6 +135,12 @@ bool SessionTaskMap::remove(int64_t sessionId) {
         return false;
     }
 
+    mGeneration++;
+    if (sessionId == mCachedSessionId) {
+        mCachedSessionId = -1;
+        mCachedSession.reset();
+    }
+
     // For each task id in linked tasks need to remove the corresponding
     // task to session mapping in the task map
     for (const auto taskId : sessItr->second.linkedTasks) {
@@ -180,6 +193,7 @@ bool SessionTaskMap::removeDeadTaskSessionMap(int64_t sessionId, pid_t taskId) {
     }
 
     // Remove session id from task map
+    mGeneration++;
     taskItr->second.erase(taskSessItr);
     if (taskItr->second.empty()) {
         mTasks.erase(taskItr);
@@ -195,35 +209,56 @@ bool SessionTaskMap::replace(int64_t sessionId, const std::vector<pid_t> &taskId
         return false;
     }
 
-    // Make copies of val and threads
-    auto svTmp = itr->second.val;
-    const auto previousTaskIds = itr->second.linkedTasks;
+    mGeneration++;
+    auto sessValPtr = itr->second.val;
+    auto &linkedTasks = itr->second.linkedTasks;
 
-    // Determine newly added threads
-    if (addedThreads) {
-        for (auto tid : taskIds) {
-            auto taskSessItr = mTasks.find(tid);
-            if (taskSessItr == mTasks.end()) {
-                addedThreads->push_back(tid);
+    // Diff in place instead of tearing the session down and rebuilding it:
+    // the session value, its votes and the links of unchanged tasks all stay
+    // where they are. Thread lists are small, so the linear membership scans
+    // beat the allocations the remove/add cycle used to pay.
+
+    // Unlink tasks that are not in the new set
+    for (auto tid : linkedTasks) {
+        if (std::find(taskIds.begin(), taskIds.end(), tid) != taskIds.end()) {
+            continue;
+        }
+        auto taskItr = mTasks.find(tid);
+        if (taskItr == mTasks.end()) {
+            // Inconsisent state
+            continue;
+        }
+        auto taskSessItr = std::find(taskItr->second.begin(), taskItr->second.end(), sessValPtr);
+        if (taskSessItr != taskItr->second.end()) {
+            taskItr->second.erase(taskSessItr);
+        }
+        if (taskItr->second.empty()) {
+            mTasks.erase(taskItr);
+            // Task is not linked to any session anymore
+            if (removedThreads) {
+                removedThreads->push_back(tid);
             }
         }
     }
 
-    // Remove session from mappings
-    remove(sessionId);
-    // Add session value and task mappings
-    add(sessionId, *svTmp, taskIds);
-
-    // Determine completely removed threads
-    if (removedThreads) {
-        for (auto tid : previousTaskIds) {
-            auto taskSessItr = mTasks.find(tid);
-            if (taskSessItr == mTasks.end()) {
-                removedThreads->push_back(tid);
+    // Link tasks that are new for this session
+    for (auto tid : taskIds) {
+        if (std::find(linkedTasks.begin(), linkedTasks.end(), tid) != linkedTasks.end()) {
+            continue;
+        }
+        auto taskItr = mTasks.find(tid);
+        if (taskItr == mTasks.end()) {
+            // Task was not linked to any session before
+            if (addedThreads) {
+                addedThreads->push_back(tid);
             }
+            mTasks[tid].push_back(sessValPtr);
+        } else {
+            taskItr->second.push_back(sessValPtr);
         }
     }
 
+    linkedTasks = taskIds;
     return true;
 }
 
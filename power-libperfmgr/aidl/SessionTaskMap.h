@@ -43,6 +43,16 @@ namespace pixel {
  */
 class SessionTaskMap {
   public:
+    SessionTaskMap() {
+        // Sized for a heavy multi-session load up front; rehashing on the
+        // per-frame report path is what the reserve avoids, and the low load
+        // factor keeps lookup chains short.
+        mSessions.max_load_factor(0.5f);
+        mTasks.max_load_factor(0.5f);
+        mSessions.reserve(32);
+        mTasks.reserve(256);
+    }
+
     // Add a session with associated tasks to mapping
     bool add(int64_t sessionId, const SessionValueEntry &sv, const std::vector<pid_t> &taskIds);
 
@@ -121,6 +131,15 @@ class SessionTaskMap {
     std::unordered_map<int64_t, ValEntry> mSessions;
     // Map task id to set of session ids
     std::unordered_map<pid_t, std::vector<std::shared_ptr<SessionValueEntry>>> mTasks;
+    // Structural generation, bumped whenever session or task links change;
+    // validates the one-entry findSession cache below without any bookkeeping
+    // on the structural operations themselves.
+    uint64_t mGeneration{0};
+    // Per-frame callers resolve the same session id many times in a row, so
+    // memoize the last hit.
+    int64_t mCachedSessionId{-1};
+    uint64_t mCachedSessionGen{0};
+    std::shared_ptr<SessionValueEntry> mCachedSession;
 };
 
 }  // namespace pixel
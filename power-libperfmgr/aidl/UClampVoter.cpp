@@ -23,15 +23,6 @@ namespace power {
 namespace impl {
 namespace pixel {
 
-static void confine(UclampRange *uclampRange, const CpuVote &cpu_vote,
-                    std::chrono::steady_clock::time_point t) {
-    if (!cpu_vote.isTimeInRange(t)) {
-        return;
-    }
-    uclampRange->uclampMin = std::max(uclampRange->uclampMin, cpu_vote.mUclampRange.uclampMin);
-    uclampRange->uclampMax = std::min(uclampRange->uclampMax, cpu_vote.mUclampRange.uclampMax);
-}
-
 std::ostream &operator<<(std::ostream &o, const UclampRange &uc) {
     o << "[" << uc.uclampMin << "," << uc.uclampMax << "]";
     return o;
@@ -50,6 +41,7 @@ static inline bool isGpuVote(int type_raw) {
 void Votes::add(int id, CpuVote const &vote) {
     if (!isGpuVote(id)) {
         mCpuVotes[id] = vote;
+        mCacheDirty = true;
     }
 }
 
@@ -79,6 +71,7 @@ void Votes::updateDuration(int voteId, std::chrono::nanoseconds durationNs) {
     auto const voteItr = mCpuVotes.find(voteId);
     if (voteItr != mCpuVotes.end()) {
         voteItr->second.updateDuration(durationNs);
+        mCacheDirty = true;
     }
 }
 
@@ -87,10 +80,30 @@ void Votes::getUclampRange(UclampRange *uclampRange,
     if (nullptr == uclampRange) {
         return;
     }
-    for (auto it = mCpuVotes.begin(); it != mCpuVotes.end(); it++) {
-        auto timings_it = mCpuVotes.find(it->first);
-        confine(uclampRange, it->second, t);
+
+    if (mCacheDirty || t < mCacheTime || t > mNextChange) {
+        // Recompute the aggregate and the window it stays valid for: until
+        // the earliest expiry of a contributing vote, or the earliest start
+        // of a vote that has not begun yet
+        UclampRange aggregate;
+        auto nextChange = std::chrono::steady_clock::time_point::max();
+        for (const auto &[id, vote] : mCpuVotes) {
+            if (vote.isTimeInRange(t)) {
+                aggregate.uclampMin = std::max(aggregate.uclampMin, vote.mUclampRange.uclampMin);
+                aggregate.uclampMax = std::min(aggregate.uclampMax, vote.mUclampRange.uclampMax);
+                nextChange = std::min(nextChange, vote.startTime() + vote.durationNs());
+            } else if (vote.active() && vote.startTime() > t) {
+                nextChange = std::min(nextChange, vote.startTime());
+            }
+        }
+        mCachedRange = aggregate;
+        mCacheTime = t;
+        mNextChange = nextChange;
+        mCacheDirty = false;
     }
+
+    uclampRange->uclampMin = std::max(uclampRange->uclampMin, mCachedRange.uclampMin);
+    uclampRange->uclampMax = std::min(uclampRange->uclampMax, mCachedRange.uclampMax);
 }
 
 bool Votes::anyTimedOut(std::chrono::steady_clock::time_point t) const {
@@ -136,12 +149,19 @@ bool Votes::remove(int voteId) {
     auto const it = mCpuVotes.find(voteId);
     if (it != mCpuVotes.end()) {
         mCpuVotes.erase(it);
+        mCacheDirty = true;
         return true;
     }
 
     return false;
 }
 
+void Votes::reset() {
+    mCpuVotes.clear();
+    mGpuVotes.clear();
+    mCacheDirty = true;
+}
+
 bool Votes::setUseVote(int voteId, bool active) {
     if (isGpuVote(voteId)) {
         auto const itr = mGpuVotes.find(voteId);
@@ -157,6 +177,7 @@ bool Votes::setUseVote(int voteId, bool active) {
         return false;
     }
     itr->second.setActive(active);
+    mCacheDirty = true;
     return true;
 }
 
@@ -132,6 +132,11 @@ class Votes {
     // false if remove failed for example no vote with that id exists
     bool remove(int voteId);
 
+    // Drop all votes for reuse by another session. The hash maps keep their
+    // bucket arrays across clear(), so a recycled Votes object serves its
+    // next session without reallocating them.
+    void reset();
+
     // Turn on/off vote
     bool setUseVote(int voteId, bool active);
 
@@ -145,6 +150,18 @@ class Votes {
   private:
     std::unordered_map<int, CpuVote> mCpuVotes;
     std::unordered_map<int, GpuVote> mGpuVotes;
+
+    // Cached aggregate of the active CPU votes so the per-frame
+    // getUclampRange call does not rescan the map. The cache records the
+    // time window [mCacheTime, mNextChange] in which no vote starts or
+    // expires; queries inside the window are two comparisons and a clamp.
+    // Vote mutations mark the cache dirty, queries outside the window
+    // recompute it. Mutable because queries repopulate it under the same
+    // external synchronization that guards the vote maps themselves.
+    mutable bool mCacheDirty{true};
+    mutable std::chrono::steady_clock::time_point mCacheTime{};
+    mutable std::chrono::steady_clock::time_point mNextChange{};
+    mutable UclampRange mCachedRange{};
 };
 
 }  // namespace pixel
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace aidl {
+namespace google {
+namespace hardware {
+namespace power {
+namespace impl {
+namespace pixel {
+
+// Statistics kernels over contiguous nanosecond duration arrays, as drained
+// from a session's report ring. Durations are kept structure-of-arrays
+// (plain int64_t, not WorkDuration) precisely so these loops touch dense
+// memory. The NEON paths consume two 64-bit lanes per iteration; the scalar
+// loops handle the tail and non-NEON builds.
+
+inline int64_t WorkDurationSum(const int64_t *durations, size_t n) {
+    size_t i = 0;
+    int64_t sum = 0;
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    int64x2_t acc = vdupq_n_s64(0);
+    for (; i + 2 <= n; i += 2) {
+        acc = vaddq_s64(acc, vld1q_s64(durations + i));
+    }
+    sum = vaddvq_s64(acc);
+#endif
+    for (; i < n; ++i) {
+        sum += durations[i];
+    }
+    return sum;
+}
+
+inline int64_t WorkDurationMaxAbs(const int64_t *durations, size_t n) {
+    size_t i = 0;
+    int64_t max_abs = 0;
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    // NEON has no 64-bit integer max, so build one from compare-and-select
+    int64x2_t acc = vdupq_n_s64(0);
+    for (; i + 2 <= n; i += 2) {
+        int64x2_t v = vabsq_s64(vld1q_s64(durations + i));
+        acc = vbslq_s64(vcgtq_s64(v, acc), v, acc);
+    }
+    max_abs = std::max(vgetq_lane_s64(acc, 0), vgetq_lane_s64(acc, 1));
+#endif
+    for (; i < n; ++i) {
+        max_abs = std::max(max_abs, std::abs(durations[i]));
+    }
+    return max_abs;
+}
+
+// Mean absolute successive difference, a cheap jitter measure over a batch.
+// Returns 0 for batches shorter than two entries.
+inline int64_t WorkDurationJitter(const int64_t *durations, size_t n) {
+    if (n < 2) {
+        return 0;
+    }
+    size_t i = 1;
+    int64_t diff_sum = 0;
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    int64x2_t acc = vdupq_n_s64(0);
+    for (; i + 2 <= n; i += 2) {
+        // Unaligned overlapping loads give the shifted-by-one operand
+        int64x2_t cur = vld1q_s64(durations + i);
+        int64x2_t prev = vld1q_s64(durations + i - 1);
+        acc = vaddq_s64(acc, vabsq_s64(vsubq_s64(cur, prev)));
+    }
+    diff_sum = vaddvq_s64(acc);
+#endif
+    for (; i < n; ++i) {
+        diff_sum += std::abs(durations[i] - durations[i - 1]);
+    }
+    return diff_sum / static_cast<int64_t>(n - 1);
+}
+
+// Percentile over a scratch copy of the batch; pct in [0, 100]. Selection is
+// branchy so it stays scalar, but it runs on the dense duration array rather
+// than strided WorkDuration structs.
+inline int64_t WorkDurationPercentile(const int64_t *durations, size_t n, int pct) {
+    if (n == 0) {
+        return 0;
+    }
+    std::vector<int64_t> scratch(durations, durations + n);
+    size_t idx = std::min(n - 1, (n * static_cast<size_t>(std::clamp(pct, 0, 100))) / 100);
+    std::nth_element(scratch.begin(), scratch.begin() + idx, scratch.end());
+    return scratch[idx];
+}
+
+}  // namespace pixel
+}  // namespace impl
+}  // namespace power
+}  // namespace hardware
+}  // namespace google
+}  // namespace aidl
@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Throughput benchmark for the ADPF stack. Replays a session trace modeled
+// on a recorded gaming run (per-frame reportActualWorkDuration with jank
+// spikes, CPU_LOAD_UP on jank, refresh-rate driven target changes) against
+// real PowerHintSession/PowerSessionManager/HintManager instances, with the
+// hint nodes pointed at a temporary directory instead of sysfs. Reports
+// calls/sec plus the p99 binder-side latency of reportActualWorkDuration,
+// which is the number the per-frame optimizations are gated on.
+
+#include <android-base/file.h>
+#include <android-base/stringprintf.h>
+#include <benchmark/benchmark.h>
+#include <sys/syscall.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+// define private as public to expose the private members, matching the
+// approach of PowerHintSessionTest.
+#define private public
+#include "aidl/PowerHintSession.h"
+#include "aidl/PowerSessionManager.h"
+#undef private
+
+#define gettid() syscall(SYS_gettid)
+
+namespace aidl {
+namespace google {
+namespace hardware {
+namespace power {
+namespace impl {
+namespace pixel {
+namespace {
+
+using ::aidl::android::hardware::power::SessionTag;
+using ::aidl::android::hardware::power::WorkDuration;
+using ::android::base::StringPrintf;
+using ::android::perfmgr::HintManager;
+
+// Node paths substituted with files under a TemporaryDir before parsing.
+constexpr char kConfigTemplate[] = R"(
+{
+    "Nodes": [
+        {
+            "Name": "CPUCluster0MinFreq",
+            "Path": "%s/cpu0_scaling_min_freq",
+            "Values": ["1512000", "1134000", "384000"],
+            "DefaultIndex": 2,
+            "ResetOnInit": true
+        }
+    ],
+    "Actions": [
+        {
+            "PowerHint": "INTERACTION",
+            "Node": "CPUCluster0MinFreq",
+            "Value": "1134000",
+            "Duration": 800
+        }
+    ],
+    "AdpfConfig": [
+        {
+            "Name": "REFRESH_120FPS",
+            "PID_On": true,
+            "PID_Po": 5.0,
+            "PID_Pu": 3.0,
+            "PID_I": 0.001,
+            "PID_I_Init": 200,
+            "PID_I_High": 512,
+            "PID_I_Low": -120,
+            "PID_Do": 500.0,
+            "PID_Du": 0.0,
+            "SamplingWindow_P": 1,
+            "SamplingWindow_I": 0,
+            "SamplingWindow_D": 1,
+            "UclampMin_On": true,
+            "UclampMin_Init": 100,
+            "UclampMin_High": 384,
+            "UclampMin_Low": 0,
+            "ReportingRateLimitNs": 166666660,
+            "EarlyBoost_On": false,
+            "EarlyBoost_TimeFactor": 0.8,
+            "TargetTimeFactor": 1.0,
+            "StaleTimeFactor": 10.0
+        }
+    ]
+}
+)";
+
+// One entry of the replayed trace, kept POD so the replay loop itself adds
+// no measurable overhead.
+enum class TraceOp : uint8_t {
+    kReport,
+    kSendLoadUp,
+    kSendLoadReset,
+    kUpdateTarget,
+};
+
+struct TraceEvent {
+    TraceOp op;
+    uint8_t session;
+    int64_t valueNs;
+};
+
+// Shape of the recorded run this trace reproduces: two sessions (game main
+// and render thread groups) reporting every frame at 120Hz, ~1% jank frames
+// at 2.5x target followed by CPU_LOAD_UP, and a couple of target changes as
+// the refresh rate flips.
+constexpr int kNumSessions = 2;
+constexpr int kThreadsPerSession = 2;
+constexpr int kFramesPerTrace = 2000;
+constexpr int64_t kTargetNs = 8333333;
+
+std::vector<TraceEvent> buildTrace() {
+    std::vector<TraceEvent> trace;
+    trace.reserve(kFramesPerTrace * kNumSessions + 64);
+    std::mt19937 rng(42);
+    std::normal_distribution<double> jitter(0.85, 0.08);
+    std::uniform_int_distribution<int> jankDice(0, 99);
+    for (int frame = 0; frame < kFramesPerTrace; ++frame) {
+        if (frame == kFramesPerTrace / 3 || frame == 2 * kFramesPerTrace / 3) {
+            for (uint8_t s = 0; s < kNumSessions; ++s) {
+                trace.push_back({TraceOp::kUpdateTarget, s, kTargetNs});
+            }
+        }
+        for (uint8_t s = 0; s < kNumSessions; ++s) {
+            const bool jank = jankDice(rng) == 0;
+            const double factor = jank ? 2.5 : std::max(0.3, jitter(rng));
+            trace.push_back({TraceOp::kReport, s, static_cast<int64_t>(kTargetNs * factor)});
+            if (jank) {
+                trace.push_back({TraceOp::kSendLoadUp, s, 0});
+                trace.push_back({TraceOp::kSendLoadReset, s, 0});
+            }
+        }
+    }
+    return trace;
+}
+
+// Real threads so sched_setattr in the uclamp engine targets live tids.
+class SessionThreads {
+  public:
+    explicit SessionThreads(int count) : mAlive(true) {
+        std::atomic<int> ready{0};
+        mTids.resize(count);
+        for (int i = 0; i < count; ++i) {
+            mThreads.emplace_back([this, i, &ready]() {
+                mTids[i] = gettid();
+                ready.fetch_add(1);
+                while (mAlive.load()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                }
+            });
+        }
+        while (ready.load() < count) {
+            std::this_thread::yield();
+        }
+    }
+    ~SessionThreads() {
+        mAlive.store(false);
+        for (auto &t : mThreads) {
+            t.join();
+        }
+    }
+    const std::vector<int32_t> &tids() const { return mTids; }
+
+  private:
+    std::atomic<bool> mAlive;
+    std::vector<int32_t> mTids;
+    std::vector<std::thread> mThreads;
+};
+
+// Point the HintManager singleton at the mocked config once per process.
+void ensureHintManager() {
+    static bool initialized = [] {
+        static TemporaryDir nodeDir;
+        static TemporaryFile configFile;
+        const std::string config = StringPrintf(kConfigTemplate, nodeDir.path);
+        if (!::android::base::WriteStringToFile(config, configFile.path)) {
+            return false;
+        }
+        HintManager::mInstance = HintManager::GetFromJSON(configFile.path, false);
+        return HintManager::mInstance != nullptr;
+    }();
+    if (!initialized) {
+        abort();
+    }
+}
+
+void BM_ReplayAdpfSessionTrace(benchmark::State &state) {
+    ensureHintManager();
+    static const std::vector<TraceEvent> trace = buildTrace();
+    SessionThreads threads(kNumSessions * kThreadsPerSession);
+
+    std::vector<int64_t> reportLatenciesNs;
+    reportLatenciesNs.reserve(kFramesPerTrace * kNumSessions);
+    int64_t calls = 0;
+
+    for (auto _ : state) {
+        std::vector<std::shared_ptr<PowerHintSession>> sessions;
+        for (int s = 0; s < kNumSessions; ++s) {
+            std::vector<int32_t> tids(
+                    threads.tids().begin() + s * kThreadsPerSession,
+                    threads.tids().begin() + (s + 1) * kThreadsPerSession);
+            sessions.push_back(ndk::SharedRefBase::make<PowerHintSession>(
+                    getpid(), 1000 + s, tids, kTargetNs, SessionTag::GAME));
+            ++calls;
+        }
+        std::vector<WorkDuration> batch(1);
+        for (const auto &event : trace) {
+            auto &session = *sessions[event.session];
+            switch (event.op) {
+                case TraceOp::kReport: {
+                    batch[0].durationNanos = event.valueNs;
+                    batch[0].timeStampNanos = 0;
+                    const auto start = std::chrono::steady_clock::now();
+                    session.reportActualWorkDuration(batch);
+                    reportLatenciesNs.push_back(
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now() - start)
+                                    .count());
+                    break;
+                }
+                case TraceOp::kSendLoadUp:
+                    session.sendHint(SessionHint::CPU_LOAD_UP);
+                    break;
+                case TraceOp::kSendLoadReset:
+                    session.sendHint(SessionHint::CPU_LOAD_RESET);
+                    break;
+                case TraceOp::kUpdateTarget:
+                    session.updateTargetWorkDuration(event.valueNs);
+                    break;
+            }
+            ++calls;
+        }
+        for (auto &session : sessions) {
+            session->close();
+        }
+    }
+
+    state.SetItemsProcessed(calls);
+    if (!reportLatenciesNs.empty()) {
+        std::sort(reportLatenciesNs.begin(), reportLatenciesNs.end());
+        state.counters["report_p99_ns"] = static_cast<double>(
+                reportLatenciesNs[reportLatenciesNs.size() * 99 / 100]);
+        state.counters["report_p50_ns"] =
+                static_cast<double>(reportLatenciesNs[reportLatenciesNs.size() / 2]);
+    }
+}
+BENCHMARK(BM_ReplayAdpfSessionTrace)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}  // namespace
+}  // namespace pixel
+}  // namespace impl
+}  // namespace power
+}  // namespace hardware
+}  // namespace google
+}  // namespace aidl
+
+BENCHMARK_MAIN();
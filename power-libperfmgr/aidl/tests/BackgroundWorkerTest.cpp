@@ -109,6 +109,58 @@ TEST(TemplatePriorityQueueWorker, testSingle) {
     EXPECT_NEAR(500, getDurationMs(vec[2].t, tNow).count(), kTIMING_TOLERANCE_MS);
 }
 
+TEST(PriorityQueueWorkerPool, testUrgentLaneDrainedFirst) {
+    const int normalId = 1;
+    const int urgentId = 2;
+    const int blockerId = 3;
+    std::condition_variable cv;
+    std::mutex m;
+    std::vector<work> vec;
+    bool blockerStarted = false;
+    bool release = false;
+
+    auto p = std::make_shared<PriorityQueueWorkerPool>(1, "adpf_");
+    p->addCallback(blockerId, [&](int64_t) {
+        // Hold the single worker thread until both lanes are populated
+        std::unique_lock<std::mutex> lock(m);
+        blockerStarted = true;
+        cv.notify_all();
+        cv.wait(lock, [&]() { return release; });
+    });
+    p->addCallback(normalId, [&](int64_t packageId) {
+        std::lock_guard<std::mutex> lock(m);
+        vec.push_back({packageId, std::chrono::steady_clock::now()});
+        cv.notify_all();
+    });
+    p->addCallback(urgentId, [&](int64_t packageId) {
+        std::lock_guard<std::mutex> lock(m);
+        vec.push_back({packageId, std::chrono::steady_clock::now()});
+        cv.notify_all();
+    });
+
+    const auto tNow = std::chrono::steady_clock::now();
+    p->schedule(blockerId, 0, tNow);
+    {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [&]() { return blockerStarted; });
+    }
+    // Both packages are due once the worker is released; the normal one has
+    // the earlier deadline, but the urgent lane must still run first.
+    p->schedule(normalId, 100, tNow - 5ms);
+    p->schedule(urgentId, 200, tNow, WorkerPriority::kUrgent);
+    {
+        std::lock_guard<std::mutex> lock(m);
+        release = true;
+        cv.notify_all();
+    }
+
+    std::unique_lock<std::mutex> lock(m);
+    cv.wait_for(lock, 1500ms, [&]() { return vec.size() == 2; });
+    ASSERT_EQ(2, vec.size());
+    EXPECT_EQ(200, vec[0].val);
+    EXPECT_EQ(100, vec[1].val);
+}
+
 TEST(TemplatePriorityQueueWorker, testDouble) {
     std::condition_variable cv;
     std::mutex m;
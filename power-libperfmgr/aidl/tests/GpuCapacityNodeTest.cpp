@@ -254,6 +254,36 @@ TEST_F(GpuCapacityNodeTest, nonsense_returned_from_frequency2) {
     EXPECT_FALSE(capacity_node.gpu_frequency());
 }
 
+TEST_F(GpuCapacityNodeTest, cached_frequency_follows_sampler) {
+    static constexpr auto value = "100";
+    bool data_pending = true;
+    ON_CALL(*mock_fd_interface, read(another_fake_fd, _, _))
+            .WillByDefault(Invoke([&](auto, void *buf, size_t len) -> ssize_t {
+                if (!data_pending) {
+                    data_pending = true;
+                    return 0;
+                }
+                data_pending = false;
+                strncpy(static_cast<char *>(buf), value, len);
+                return 3;
+            }));
+    ON_CALL(*mock_fd_interface, lseek(another_fake_fd, 0, SEEK_SET)).WillByDefault(Return(0));
+
+    GpuCapacityNode capacity_node(std::make_unique<FdInterfaceWrapper>(mock_fd_interface), fake_fd,
+                                  another_fake_fd, path);
+    EXPECT_FALSE(capacity_node.cached_gpu_frequency());
+
+    capacity_node.start_sampling(std::chrono::milliseconds(1));
+    std::optional<Frequency> frequency;
+    for (auto i = 0; i < 100 && !frequency; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        frequency = capacity_node.cached_gpu_frequency();
+    }
+    capacity_node.stop_sampling();
+    ASSERT_TRUE(frequency);
+    EXPECT_THAT(*frequency, Eq(Frequency(100000)));
+}
+
 TEST_F(GpuCapacityNodeTest, nonsense_returned_from_frequency4) {
     static constexpr auto value = "0";
     EXPECT_CALL(*mock_fd_interface, read(another_fake_fd, _, _))
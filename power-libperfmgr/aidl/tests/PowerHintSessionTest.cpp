@@ -137,8 +137,12 @@ TEST_F(PowerHintSessionTest, removeDeadThread) {
                         .count();
     WorkDuration wDur(tNow, 1100000);
     sess1->reportActualWorkDuration(std::vector<WorkDuration>{wDur});
+    // The heuristic and the uclamp update run on the background worker now, so
+    // give it a moment to drain before checking the map.
+    std::this_thread::sleep_for(100ms);
     ASSERT_EQ(sessManager->mSessionTaskMap.mTasks[deadThreadID].size(), 1);
     sess2->reportActualWorkDuration(std::vector<WorkDuration>{wDur});
+    std::this_thread::sleep_for(100ms);
     ASSERT_EQ(sessManager->mSessionTaskMap.mTasks.count(deadThreadID), 0);
     std::erase(session1Threads, deadThreadID);
     std::erase(session2Threads, deadThreadID);
@@ -155,6 +159,7 @@ TEST_F(PowerHintSessionTest, removeDeadThread) {
                    std::chrono::high_resolution_clock::now().time_since_epoch())
                    .count();
     sess1->reportActualWorkDuration(std::vector<WorkDuration>{wDur});
+    std::this_thread::sleep_for(100ms);
     ASSERT_EQ(2, sessManager->mSessionTaskMap.mSessions.size());  // Session still alive
     ASSERT_EQ(sessManager->mSessionTaskMap.mSessions[sess1->mSessionId].linkedTasks.size(), 0);
 }
@@ -59,12 +59,16 @@ static const uint32_t kMaxDurationMs =
         ::android::base::GetUintProperty("vendor.powerhal.interaction.max", /*default*/ 5650U);
 static const uint32_t kDurationOffsetMs =
         ::android::base::GetUintProperty("vendor.powerhal.interaction.offset", /*default*/ 650U);
-
-static size_t CalcTimespecDiffMs(struct timespec start, struct timespec end) {
-    size_t diff_in_ms = 0;
-    diff_in_ms += (end.tv_sec - start.tv_sec) * MSINSEC;
-    diff_in_ms += (end.tv_nsec - start.tv_nsec) / NSINMS;
-    return diff_in_ms;
+// Deadline coarsening window: the worker's wait is only rearmed when a new
+// deadline lands more than this far past the armed one, so the boost may be
+// released up to this many ms early in exchange for far fewer wakeups.
+static const uint32_t kDeadlineSlackMs =
+        ::android::base::GetUintProperty("vendor.powerhal.interaction.slack", /*default*/ 50U);
+
+static int64_t MonotonicMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * MSINSEC + ts.tv_nsec / NSINMS;
 }
 
 static int FbIdleOpen(void) {
@@ -83,7 +87,7 @@ static int FbIdleOpen(void) {
 using ::android::perfmgr::HintManager;
 
 InteractionHandler::InteractionHandler()
-    : mState(INTERACTION_STATE_UNINITIALIZED), mDurationMs(0) {}
+    : mState(INTERACTION_STATE_UNINITIALIZED), mBoostDeadlineMs(0), mArmedDeadlineMs(0) {}
 
 InteractionHandler::~InteractionHandler() {
     Exit();
@@ -118,7 +122,7 @@ void InteractionHandler::Exit() {
     if (mState == INTERACTION_STATE_UNINITIALIZED)
         return;
 
-    AbortWaitLocked();
+    AbortWait();
     mState = INTERACTION_STATE_UNINITIALIZED;
     lk.unlock();
 
@@ -146,8 +150,6 @@ void InteractionHandler::PerfRel() {
 void InteractionHandler::Acquire(int32_t duration) {
     ATRACE_CALL();
 
-    std::lock_guard<std::mutex> lk(mLock);
-
     int inputDuration = duration + kDurationOffsetMs;
     int finalDuration;
     if (inputDuration > kMaxDurationMs)
@@ -160,63 +162,81 @@ void InteractionHandler::Acquire(int32_t duration) {
     // Fallback to do boost directly
     // 1) override property is set OR
     // 2) InteractionHandler not initialized
-    if (!kDisplayIdleSupport || mState == INTERACTION_STATE_UNINITIALIZED) {
+    if (!kDisplayIdleSupport || mState.load() == INTERACTION_STATE_UNINITIALIZED) {
         HintManager::GetInstance()->DoHint("INTERACTION", std::chrono::milliseconds(finalDuration));
         return;
     }
 
-    struct timespec cur_timespec;
-    clock_gettime(CLOCK_MONOTONIC, &cur_timespec);
-    if (mState != INTERACTION_STATE_IDLE && finalDuration <= mDurationMs) {
-        size_t elapsed_time = CalcTimespecDiffMs(mLastTimespec, cur_timespec);
-        // don't hint if previous hint's duration covers this hint's duration
-        if (elapsed_time <= (mDurationMs - finalDuration)) {
-            ALOGV("%s: Previous duration (%d) cover this (%d) elapsed: %lld", __func__,
-                  static_cast<int>(mDurationMs), static_cast<int>(finalDuration),
-                  static_cast<long long>(elapsed_time));
+    const int64_t new_deadline_ms = MonotonicMs() + finalDuration;
+
+    // Fast path: the boost is already held. Publish the later deadline with a
+    // CAS max-update and poke the worker only when the new deadline lands
+    // more than the slack past the one its wait was armed with; at sustained
+    // frame rates nearly every notification resolves here without taking the
+    // mutex or waking the worker.
+    InteractionState state = mState.load();
+    if (state == INTERACTION_STATE_INTERACTION || state == INTERACTION_STATE_WAITING) {
+        int64_t cur_deadline_ms = mBoostDeadlineMs.load();
+        while (cur_deadline_ms < new_deadline_ms &&
+               !mBoostDeadlineMs.compare_exchange_weak(cur_deadline_ms, new_deadline_ms)) {
+        }
+        if (mState.load() != INTERACTION_STATE_IDLE) {
+            if (new_deadline_ms >
+                mArmedDeadlineMs.load() + static_cast<int64_t>(kDeadlineSlackMs)) {
+                AbortWait();
+            }
             return;
         }
+        // The worker released the boost while the deadline was being
+        // published; fall through and restart it.
     }
-    mLastTimespec = cur_timespec;
-    mDurationMs = finalDuration;
 
     ALOGV("%s: input: %d final duration: %d", __func__, duration, finalDuration);
 
-    if (mState == INTERACTION_STATE_WAITING)
-        AbortWaitLocked();
-    else if (mState == INTERACTION_STATE_IDLE)
+    std::lock_guard<std::mutex> lk(mLock);
+    int64_t cur_deadline_ms = mBoostDeadlineMs.load();
+    while (cur_deadline_ms < new_deadline_ms &&
+           !mBoostDeadlineMs.compare_exchange_weak(cur_deadline_ms, new_deadline_ms)) {
+    }
+    if (mState.load() == INTERACTION_STATE_IDLE) {
         PerfLock();
-
-    mState = INTERACTION_STATE_INTERACTION;
-    mCond.notify_one();
+        mArmedDeadlineMs.store(new_deadline_ms);
+        mState.store(INTERACTION_STATE_INTERACTION);
+        mCond.notify_one();
+    }
 }
 
-void InteractionHandler::Release() {
+bool InteractionHandler::TryRelease(int64_t expected_deadline_ms) {
     std::lock_guard<std::mutex> lk(mLock);
-    if (mState == INTERACTION_STATE_WAITING) {
+    if (mBoostDeadlineMs.load() >
+        expected_deadline_ms + static_cast<int64_t>(kDeadlineSlackMs)) {
+        // A racing Acquire() published a later deadline after the worker
+        // decided to release; keep the boost and let the worker rearm.
+        return false;
+    }
+    if (mState.load() == INTERACTION_STATE_WAITING) {
         ATRACE_CALL();
         PerfRel();
-        mState = INTERACTION_STATE_IDLE;
-    } else {
-        // clear any wait aborts pending in event fd
-        uint64_t val;
-        ssize_t ret = read(mEventFd, &val, sizeof(val));
-
-        ALOGW_IF(ret < 0, "%s: failed to clear eventfd (%zd, %d)", __func__, ret, errno);
+        mState.store(INTERACTION_STATE_IDLE);
     }
+    return true;
 }
 
-// should be called while locked
-void InteractionHandler::AbortWaitLocked() {
+void InteractionHandler::AbortWait() {
     uint64_t val = 1;
     ssize_t ret = write(mEventFd, &val, sizeof(val));
     if (ret != sizeof(val))
         ALOGW("Unable to write to event fd (%zd)", ret);
 }
 
-void InteractionHandler::WaitForIdle(int32_t wait_ms, int32_t timeout_ms) {
+// Returns true when the display went idle or the wait timed out or failed —
+// i.e. the caller should decide on a release. Returns false when the wait was
+// aborted through the event fd so the caller rechecks the deadline and
+// rearms.
+bool InteractionHandler::WaitForIdle(int32_t wait_ms, int32_t timeout_ms) {
     char data[MAX_LENGTH];
     ssize_t ret;
+    uint64_t val;
     struct pollfd pfd[2];
 
     ATRACE_CALL();
@@ -231,32 +251,39 @@ void InteractionHandler::WaitForIdle(int32_t wait_ms, int32_t timeout_ms) {
     ret = poll(pfd, 1, wait_ms);
     if (ret > 0) {
         ALOGV("%s: wait aborted", __func__);
-        return;
+        ret = read(mEventFd, &val, sizeof(val));
+        ALOGW_IF(ret < 0, "%s: failed to clear eventfd (%zd, %d)", __func__, ret, errno);
+        return false;
     } else if (ret < 0) {
         ALOGE("%s: error in poll while waiting", __func__);
-        return;
+        return true;
     }
 
     ret = pread(mIdleFd, data, sizeof(data), 0);
     if (!ret) {
         ALOGE("%s: Unexpected EOF!", __func__);
-        return;
+        return true;
     }
 
     if (!strncmp(data, "idle", 4)) {
         ALOGV("%s: already idle", __func__);
-        return;
+        return true;
     }
 
     ret = poll(pfd, 2, timeout_ms);
-    if (ret < 0)
+    if (ret < 0) {
         ALOGE("%s: Error on waiting for idle (%zd)", __func__, ret);
-    else if (ret == 0)
+    } else if (ret == 0) {
         ALOGV("%s: timed out waiting for idle", __func__);
-    else if (pfd[0].revents)
+    } else if (pfd[0].revents) {
         ALOGV("%s: wait for idle aborted", __func__);
-    else if (pfd[1].revents)
+        ret = read(mEventFd, &val, sizeof(val));
+        ALOGW_IF(ret < 0, "%s: failed to clear eventfd (%zd, %d)", __func__, ret, errno);
+        return false;
+    } else if (pfd[1].revents) {
         ALOGV("%s: idle detected", __func__);
+    }
+    return true;
 }
 
 void InteractionHandler::Routine() {
@@ -265,14 +292,27 @@ void InteractionHandler::Routine() {
 
     while (true) {
         lk.lock();
-        mCond.wait(lk, [&] { return mState != INTERACTION_STATE_IDLE; });
-        if (mState == INTERACTION_STATE_UNINITIALIZED)
+        mCond.wait(lk, [&] { return mState.load() != INTERACTION_STATE_IDLE; });
+        if (mState.load() == INTERACTION_STATE_UNINITIALIZED)
             return;
-        mState = INTERACTION_STATE_WAITING;
+        mState.store(INTERACTION_STATE_WAITING);
         lk.unlock();
 
-        WaitForIdle(kWaitMs, mDurationMs);
-        Release();
+        // Sleep toward the published deadline; frame notifications that only
+        // extend it within the slack never wake this thread, and the armed
+        // deadline tells Acquire() when a poke is actually needed.
+        while (mState.load() == INTERACTION_STATE_WAITING) {
+            const int64_t deadline_ms = mBoostDeadlineMs.load();
+            const int64_t now_ms = MonotonicMs();
+            if (now_ms < deadline_ms) {
+                mArmedDeadlineMs.store(deadline_ms);
+                if (!WaitForIdle(kWaitMs, static_cast<int32_t>(deadline_ms - now_ms))) {
+                    continue;  // aborted: pick up the later deadline
+                }
+            }
+            if (TryRelease(deadline_ms))
+                break;
+        }
     }
 }
 
@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -45,19 +47,24 @@ class InteractionHandler {
     void Acquire(int32_t duration);
 
   private:
-    void Release();
-    void WaitForIdle(int32_t wait_ms, int32_t timeout_ms);
-    void AbortWaitLocked();
+    bool TryRelease(int64_t expected_deadline_ms);
+    bool WaitForIdle(int32_t wait_ms, int32_t timeout_ms);
+    void AbortWait();
     void Routine();
 
     void PerfLock();
     void PerfRel();
 
-    enum InteractionState mState;
+    std::atomic<InteractionState> mState;
     int mIdleFd;
     int mEventFd;
-    int32_t mDurationMs;
-    struct timespec mLastTimespec;
+    // Boost release deadline (CLOCK_MONOTONIC ms), published by Acquire()
+    // with a CAS max-update so frame notifications never take the mutex while
+    // the boost is held. The worker records the deadline it armed its wait
+    // with; Acquire() only pokes the event fd when the new deadline moves
+    // past the armed one by more than the configured slack.
+    std::atomic<int64_t> mBoostDeadlineMs;
+    std::atomic<int64_t> mArmedDeadlineMs;
     std::unique_ptr<std::thread> mThread;
     std::mutex mLock;
     std::condition_variable mCond;
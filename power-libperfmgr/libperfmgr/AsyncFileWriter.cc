@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specic language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "libperfmgr"
+
+#include "perfmgr/AsyncFileWriter.h"
+
+#include <android-base/logging.h>
+
+#include "perfmgr/Node.h"
+
+namespace android {
+namespace perfmgr {
+
+AsyncFileWriter *AsyncFileWriter::GetInstance() {
+    static AsyncFileWriter instance;
+    return &instance;
+}
+
+AsyncFileWriter::AsyncFileWriter() {
+    workers_.reserve(kNumWorkers);
+    for (std::size_t i = 0; i < kNumWorkers; i++) {
+        workers_.emplace_back(&AsyncFileWriter::WorkerLoop, this);
+    }
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    {
+        std::lock_guard<std::mutex> _l(lock_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+void AsyncFileWriter::Submit(Node *node, std::size_t value_index, bool log_error) {
+    {
+        std::lock_guard<std::mutex> _l(lock_);
+        const bool was_pending = pending_.count(node) > 0;
+        pending_[node] = {value_index, log_error};
+        if (!was_pending && inflight_.count(node) == 0) {
+            ready_queue_.push_back(node);
+        }
+    }
+    cv_.notify_one();
+}
+
+void AsyncFileWriter::WorkerLoop() {
+    std::unique_lock<std::mutex> _l(lock_);
+    while (true) {
+        cv_.wait(_l, [this] { return stop_ || !ready_queue_.empty(); });
+        if (stop_) {
+            return;
+        }
+        Node *node = ready_queue_.front();
+        ready_queue_.pop_front();
+        const PendingWrite write = pending_.at(node);
+        pending_.erase(node);
+        inflight_.insert(node);
+        _l.unlock();
+
+        node->WriteValue(write.value_index, write.log_error);
+
+        _l.lock();
+        inflight_.erase(node);
+        // A newer value may have been queued while the write ran
+        if (pending_.count(node) > 0) {
+            ready_queue_.push_back(node);
+        }
+    }
+}
+
+}  // namespace perfmgr
+}  // namespace android
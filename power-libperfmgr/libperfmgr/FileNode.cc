@@ -27,6 +27,9 @@
 #include <android-base/strings.h>
 #include <utils/Trace.h>
 
+#include "perfmgr/AsyncFileWriter.h"
+#include "perfmgr/HintLatencyStats.h"
+
 namespace android {
 namespace perfmgr {
 
@@ -37,6 +40,7 @@ FileNode::FileNode(std::string name, std::string node_path, std::vector<RequestG
       hold_fd_(hold_fd),
       truncate_(truncate),
       write_only_(write_only),
+      async_write_(android::base::GetBoolProperty("vendor.powerhal.async_node_write", false)),
       warn_timeout_(android::base::GetBoolProperty("ro.debuggable", false) ? 5ms : 50ms) {}
 
 std::chrono::milliseconds FileNode::Update(bool log_error) {
@@ -53,54 +57,67 @@ std::chrono::milliseconds FileNode::Update(bool log_error) {
 
     // Update node only if request index changes
     if (value_index != current_val_index_ || reset_on_init_) {
-        const std::string& req_value =
-            req_sorted_[value_index].GetRequestValue();
-        if (ATRACE_ENABLED()) {
-            const std::string tag = GetName() + ":" + req_value;
-            ATRACE_BEGIN(tag.c_str());
-        }
-        android::base::Timer t;
-        int flags = O_WRONLY | O_CLOEXEC;
-        if (GetTruncate()) {
-            flags |= O_TRUNC;
-        }
-        fd_.reset(TEMP_FAILURE_RETRY(open(node_path_.c_str(), flags)));
-
-        if (fd_ == -1 || !android::base::WriteStringToFd(req_value, fd_)) {
-            if (log_error) {
-                LOG(WARNING) << "Failed to write to node: " << node_path_
-                             << " with value: " << req_value << ", fd: " << fd_;
-            }
+        if (async_write_) {
+            AsyncFileWriter::GetInstance()->Submit(this, value_index, log_error);
+            // Check back shortly: a failed queued write leaves the current
+            // index unchanged, so the next Update() resubmits it.
+            expire_time = std::min(expire_time, std::chrono::milliseconds(500));
+        } else if (!WriteValue(value_index, log_error)) {
             // Retry in 500ms or sooner
             expire_time = std::min(expire_time, std::chrono::milliseconds(500));
-        } else {
-            // For regular file system, we need fsync
-            fsync(fd_);
-            // Some dev node requires file to remain open during the entire hint
-            // duration e.g. /dev/cpu_dma_latency, so fd_ is intentionally kept
-            // open during any requested value other than default one. If
-            // request a default value, node will write the value and then
-            // release the fd.
-            if ((!hold_fd_) || value_index == default_val_index_) {
-                fd_.reset();
-            }
-            auto duration = t.duration();
-            if (duration > warn_timeout_) {
-                LOG(WARNING) << "Slow writing to file: '" << node_path_
-                             << "' with value: '" << req_value
-                             << "' took: " << duration.count() << " ms";
-            }
-            // Update current index only when succeed
-            current_val_index_ = value_index;
-            reset_on_init_ = false;
-        }
-        if (ATRACE_ENABLED()) {
-            ATRACE_END();
         }
     }
     return expire_time;
 }
 
+bool FileNode::WriteValue(std::size_t value_index, bool log_error) {
+    const std::string& req_value = req_sorted_[value_index].GetRequestValue();
+    if (ATRACE_ENABLED()) {
+        const std::string tag = GetName() + ":" + req_value;
+        ATRACE_BEGIN(tag.c_str());
+    }
+    android::base::Timer t;
+    int flags = O_WRONLY | O_CLOEXEC;
+    if (GetTruncate()) {
+        flags |= O_TRUNC;
+    }
+    fd_.reset(TEMP_FAILURE_RETRY(open(node_path_.c_str(), flags)));
+
+    bool success = true;
+    if (fd_ == -1 || !android::base::WriteStringToFd(req_value, fd_)) {
+        if (log_error) {
+            LOG(WARNING) << "Failed to write to node: " << node_path_
+                         << " with value: " << req_value << ", fd: " << fd_;
+        }
+        success = false;
+    } else {
+        // For regular file system, we need fsync
+        fsync(fd_);
+        // Some dev node requires file to remain open during the entire hint
+        // duration e.g. /dev/cpu_dma_latency, so fd_ is intentionally kept
+        // open during any requested value other than default one. If
+        // request a default value, node will write the value and then
+        // release the fd.
+        if ((!hold_fd_) || value_index == default_val_index_) {
+            fd_.reset();
+        }
+        auto duration = t.duration();
+        HintLatencyStats::GetInstance()->RecordNodeWrite(duration);
+        if (duration > warn_timeout_) {
+            LOG(WARNING) << "Slow writing to file: '" << node_path_
+                         << "' with value: '" << req_value
+                         << "' took: " << duration.count() << " ms";
+        }
+        // Update current index only when succeed
+        current_val_index_ = value_index;
+        reset_on_init_ = false;
+    }
+    if (ATRACE_ENABLED()) {
+        ATRACE_END();
+    }
+    return success;
+}
+
 bool FileNode::GetHoldFd() const {
     return hold_fd_;
 }
@@ -123,8 +140,9 @@ void FileNode::DumpToFd(int fd) const {
                                         "Hold FD\t"
                                         "Truncate\n"
                                         "%s\t%s\t%zu\t%s\t%d\t%d\n",
-                                        name_.c_str(), node_path_.c_str(), current_val_index_,
-                                        node_value.c_str(), hold_fd_, truncate_));
+                                        name_.c_str(), node_path_.c_str(),
+                                        current_val_index_.load(), node_value.c_str(), hold_fd_,
+                                        truncate_));
     if (!android::base::WriteStringToFd(buf, fd)) {
         LOG(ERROR) << "Failed to dump fd: " << fd;
     }
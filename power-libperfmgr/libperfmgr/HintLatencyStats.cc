@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "libperfmgr"
+
+#include "perfmgr/HintLatencyStats.h"
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/properties.h>
+#include <android-base/stringprintf.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <sstream>
+
+namespace android {
+namespace perfmgr {
+
+namespace {
+
+constexpr uint32_t kHintLatencyStatsVersion = 1;
+constexpr char kLatencyStatsProperty[] = "vendor.powerhal.latency_stats";
+
+}  // namespace
+
+HintLatencyStats *HintLatencyStats::GetInstance() {
+    static HintLatencyStats instance;
+    return &instance;
+}
+
+HintLatencyStats::~HintLatencyStats() {
+    if (page_ != nullptr) {
+        munmap(page_, page_size_);
+    }
+}
+
+HintLatencyEntry *HintLatencyStats::EntryAt(std::size_t idx) {
+    return reinterpret_cast<HintLatencyEntry *>(static_cast<char *>(page_) +
+                                                sizeof(HintLatencyHeader)) +
+           idx;
+}
+
+std::size_t HintLatencyStats::BucketFor(uint64_t latency_us) {
+    std::size_t bucket = 0;
+    while (bucket < kNumLatencyBuckets - 1 && latency_us >= kLatencyBucketBoundsUs[bucket]) {
+        bucket++;
+    }
+    return bucket;
+}
+
+bool HintLatencyStats::Initialize(const std::vector<std::string> &hint_names) {
+    if (!android::base::GetBoolProperty(kLatencyStatsProperty, false)) {
+        return false;
+    }
+    if (page_ != nullptr) {
+        LOG(ERROR) << "Hint latency stats already initialized";
+        return false;
+    }
+    if (hint_names.empty()) {
+        return false;
+    }
+
+    page_size_ = sizeof(HintLatencyHeader) + hint_names.size() * sizeof(HintLatencyEntry);
+    fd_.reset(memfd_create("powerhal_hint_latency", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+    if (!fd_.ok()) {
+        PLOG(ERROR) << "Failed to create hint latency stats memfd";
+        return false;
+    }
+    if (ftruncate(fd_.get(), page_size_) < 0) {
+        PLOG(ERROR) << "Failed to size hint latency stats to " << page_size_;
+        fd_.reset();
+        return false;
+    }
+    // Readers map the page for real, so make sure it can never shrink under them.
+    if (fcntl(fd_.get(), F_ADD_SEALS, F_SEAL_GROW | F_SEAL_SHRINK | F_SEAL_SEAL) < 0) {
+        PLOG(WARNING) << "Failed to seal hint latency stats page";
+    }
+
+    page_ = mmap(nullptr, page_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_.get(), 0);
+    if (page_ == MAP_FAILED) {
+        PLOG(ERROR) << "Failed to map hint latency stats page";
+        page_ = nullptr;
+        fd_.reset();
+        return false;
+    }
+
+    auto *header = static_cast<HintLatencyHeader *>(page_);
+    header->version = kHintLatencyStatsVersion;
+    header->hint_count = hint_names.size();
+    for (std::size_t i = 0; i < hint_names.size(); ++i) {
+        strlcpy(EntryAt(i)->name, hint_names[i].c_str(), sizeof(EntryAt(i)->name));
+        entry_index_map_.emplace(hint_names[i], i);
+    }
+    pending_.reserve(kMaxPendingRecords);
+    enabled_.store(true, std::memory_order_release);
+
+    LOG(INFO) << "Hint latency stats initialized with " << hint_names.size() << " hints, "
+              << page_size_ << " bytes";
+    return true;
+}
+
+void HintLatencyStats::RecordEnqueue(const std::string &hint_type) {
+    if (!IsEnabled()) {
+        return;
+    }
+    const auto it = entry_index_map_.find(hint_type);
+    if (it == entry_index_map_.end()) {
+        return;
+    }
+
+    auto *header = static_cast<HintLatencyHeader *>(page_);
+    const uint64_t seq = header->next_seq.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> _lock(pending_lock_);
+    if (pending_.size() >= kMaxPendingRecords) {
+        EntryAt(it->second)->drops.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    pending_.push_back({it->second, seq, std::chrono::steady_clock::now()});
+}
+
+void HintLatencyStats::RecordApplied() {
+    if (!IsEnabled()) {
+        return;
+    }
+    std::lock_guard<std::mutex> _lock(pending_lock_);
+    if (pending_.empty()) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    for (const auto &record : pending_) {
+        const uint64_t latency_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                            now - record.enqueue_time)
+                                            .count();
+        HintLatencyEntry *entry = EntryAt(record.entry_index);
+        entry->count.fetch_add(1, std::memory_order_relaxed);
+        entry->sum_us.fetch_add(latency_us, std::memory_order_relaxed);
+        uint64_t max_us = entry->max_us.load(std::memory_order_relaxed);
+        while (latency_us > max_us &&
+               !entry->max_us.compare_exchange_weak(max_us, latency_us,
+                                                    std::memory_order_relaxed)) {
+        }
+        entry->buckets[BucketFor(latency_us)].fetch_add(1, std::memory_order_relaxed);
+    }
+    pending_.clear();
+}
+
+void HintLatencyStats::RecordNodeWrite(std::chrono::milliseconds duration) {
+    if (!IsEnabled()) {
+        return;
+    }
+    const uint64_t duration_us =
+            std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    auto *header = static_cast<HintLatencyHeader *>(page_);
+    header->write_count.fetch_add(1, std::memory_order_relaxed);
+    header->write_sum_us.fetch_add(duration_us, std::memory_order_relaxed);
+    uint64_t max_us = header->write_max_us.load(std::memory_order_relaxed);
+    while (duration_us > max_us &&
+           !header->write_max_us.compare_exchange_weak(max_us, duration_us,
+                                                       std::memory_order_relaxed)) {
+    }
+    header->write_buckets[BucketFor(duration_us)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void HintLatencyStats::DumpToFd(int fd) {
+    if (!IsEnabled()) {
+        return;
+    }
+    std::ostringstream dump_buf;
+    dump_buf << "========== Begin hint latency stats ==========\n";
+    dump_buf << "Hint\tCount\tAvgUs\tMaxUs\tDrops\tBuckets\n";
+    auto *header = static_cast<HintLatencyHeader *>(page_);
+    for (std::size_t i = 0; i < header->hint_count; ++i) {
+        HintLatencyEntry *entry = EntryAt(i);
+        const uint64_t count = entry->count.load(std::memory_order_relaxed);
+        dump_buf << entry->name << "\t" << count << "\t"
+                 << (count ? entry->sum_us.load(std::memory_order_relaxed) / count : 0) << "\t"
+                 << entry->max_us.load(std::memory_order_relaxed) << "\t"
+                 << entry->drops.load(std::memory_order_relaxed) << "\t";
+        for (std::size_t b = 0; b < kNumLatencyBuckets; ++b) {
+            dump_buf << entry->buckets[b].load(std::memory_order_relaxed)
+                     << (b + 1 < kNumLatencyBuckets ? "," : "\n");
+        }
+    }
+    const uint64_t write_count = header->write_count.load(std::memory_order_relaxed);
+    dump_buf << "NodeWrites\t" << write_count << "\t"
+             << (write_count ? header->write_sum_us.load(std::memory_order_relaxed) / write_count
+                             : 0)
+             << "\t" << header->write_max_us.load(std::memory_order_relaxed) << "\t-\t";
+    for (std::size_t b = 0; b < kNumLatencyBuckets; ++b) {
+        dump_buf << header->write_buckets[b].load(std::memory_order_relaxed)
+                 << (b + 1 < kNumLatencyBuckets ? "," : "\n");
+    }
+    dump_buf << "==========  End hint latency stats  ==========\n";
+    if (!android::base::WriteStringToFd(dump_buf.str(), fd)) {
+        LOG(ERROR) << "Failed to dump fd: " << fd;
+    }
+}
+
+}  // namespace perfmgr
+}  // namespace android
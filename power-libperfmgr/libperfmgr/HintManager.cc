@@ -32,6 +32,7 @@
 #include <set>
 
 #include "perfmgr/FileNode.h"
+#include "perfmgr/HintLatencyStats.h"
 #include "perfmgr/PropertyNode.h"
 
 namespace android {
@@ -65,8 +66,44 @@ bool HintManager::IsHintSupported(const std::string& hint_type) const {
 }
 
 bool HintManager::IsHintEnabled(const std::string &hint_type) const {
-    std::lock_guard<std::mutex> lock(actions_.at(hint_type).hint_lock);
-    return actions_.at(hint_type).mask_requesters.empty();
+    return IsHintEnabled(actions_.at(hint_type));
+}
+
+bool HintManager::IsHintEnabled(const Hint &hint) const {
+    if (hint.hint_id >= 0) {
+        const uint64_t word = hint_mask_bits_[hint.hint_id >> 6].load(std::memory_order_relaxed);
+        return (word & (1ULL << (hint.hint_id & 63))) == 0;
+    }
+    std::lock_guard<std::mutex> lock(hint.hint_lock);
+    return hint.mask_requesters.empty();
+}
+
+void HintManager::RefreshMaskBit(const Hint &hint) {
+    if (hint.hint_id < 0) {
+        return;
+    }
+    std::atomic<uint64_t> &word = hint_mask_bits_[hint.hint_id >> 6];
+    const uint64_t bit = 1ULL << (hint.hint_id & 63);
+    if (hint.mask_requesters.empty()) {
+        word.fetch_and(~bit, std::memory_order_relaxed);
+    } else {
+        word.fetch_or(bit, std::memory_order_relaxed);
+    }
+}
+
+void HintManager::BuildHintIdTable() {
+    hint_dispatch_table_.reserve(actions_.size());
+    for (auto &action : actions_) {
+        action.second.hint_id = static_cast<int>(hint_dispatch_table_.size());
+        hint_id_map_.emplace(action.first, action.second.hint_id);
+        hint_dispatch_table_.emplace_back(&action.first, &action.second);
+    }
+    hint_mask_bits_ = std::vector<std::atomic<uint64_t>>((hint_dispatch_table_.size() + 63) / 64);
+}
+
+int HintManager::GetHintId(const std::string &hint_type) const {
+    const auto it = hint_id_map_.find(hint_type);
+    return it == hint_id_map_.end() ? kInvalidHintId : it->second;
 }
 
 bool HintManager::InitHintStatus(const std::unique_ptr<HintManager> &hm) {
@@ -88,43 +125,50 @@ bool HintManager::InitHintStatus(const std::unique_ptr<HintManager> &hm) {
         }
         a.second.status.reset(new HintStatus(timeout));
     }
+
+    // Property-gated; a no-op unless latency stats are enabled.
+    std::vector<std::string> hint_names;
+    hint_names.reserve(hm->actions_.size());
+    for (const auto &a : hm->actions_) {
+        hint_names.push_back(a.first);
+    }
+    HintLatencyStats::GetInstance()->Initialize(hint_names);
     return true;
 }
 
-void HintManager::DoHintStatus(const std::string &hint_type, std::chrono::milliseconds timeout_ms) {
-    std::lock_guard<std::mutex> lock(actions_.at(hint_type).hint_lock);
-    actions_.at(hint_type).status->stats.count.fetch_add(1);
+void HintManager::DoHintStatus(const std::string &hint_type, Hint &hint,
+                               std::chrono::milliseconds timeout_ms) {
+    std::lock_guard<std::mutex> lock(hint.hint_lock);
+    hint.status->stats.count.fetch_add(1);
     auto now = std::chrono::steady_clock::now();
     ATRACE_INT(hint_type.c_str(), (timeout_ms == kMilliSecondZero) ? std::numeric_limits<int>::max()
                                                                    : timeout_ms.count());
-    if (now > actions_.at(hint_type).status->end_time) {
-        actions_.at(hint_type).status->stats.duration_ms.fetch_add(
-                std::chrono::duration_cast<std::chrono::milliseconds>(
-                        actions_.at(hint_type).status->end_time -
-                        actions_.at(hint_type).status->start_time)
+    if (now > hint.status->end_time) {
+        hint.status->stats.duration_ms.fetch_add(
+                std::chrono::duration_cast<std::chrono::milliseconds>(hint.status->end_time -
+                                                                      hint.status->start_time)
                         .count());
-        actions_.at(hint_type).status->start_time = now;
+        hint.status->start_time = now;
     }
-    actions_.at(hint_type).status->end_time =
-            (timeout_ms == kMilliSecondZero) ? kTimePointMax : now + timeout_ms;
+    hint.status->end_time = (timeout_ms == kMilliSecondZero) ? kTimePointMax : now + timeout_ms;
 }
 
-void HintManager::EndHintStatus(const std::string &hint_type) {
-    std::lock_guard<std::mutex> lock(actions_.at(hint_type).hint_lock);
+void HintManager::EndHintStatus(const std::string &hint_type, Hint &hint) {
+    std::lock_guard<std::mutex> lock(hint.hint_lock);
     // Update HintStats if the hint ends earlier than expected end_time
     auto now = std::chrono::steady_clock::now();
     ATRACE_INT(hint_type.c_str(), 0);
-    if (now < actions_.at(hint_type).status->end_time) {
-        actions_.at(hint_type).status->stats.duration_ms.fetch_add(
-                std::chrono::duration_cast<std::chrono::milliseconds>(
-                        now - actions_.at(hint_type).status->start_time)
+    if (now < hint.status->end_time) {
+        hint.status->stats.duration_ms.fetch_add(
+                std::chrono::duration_cast<std::chrono::milliseconds>(now -
+                                                                      hint.status->start_time)
                         .count());
-        actions_.at(hint_type).status->end_time = now;
+        hint.status->end_time = now;
     }
 }
 
-void HintManager::DoHintAction(const std::string &hint_type) {
-    for (auto &action : actions_.at(hint_type).hint_actions) {
+void HintManager::DoHintAction(const std::string &hint_type, Hint &hint) {
+    for (auto &action : hint.hint_actions) {
         if (!action.enable_property.empty() &&
             !android::base::GetBoolProperty(action.enable_property, true)) {
             // Disabled action based on its control property
@@ -141,8 +185,10 @@ void HintManager::DoHintAction(const std::string &hint_type) {
                 if (actions_.find(action.value) == actions_.end()) {
                     LOG(ERROR) << "Failed to find " << action.value << " action";
                 } else {
-                    std::lock_guard<std::mutex> lock(actions_.at(hint_type).hint_lock);
-                    actions_.at(action.value).mask_requesters.insert(hint_type);
+                    Hint &masked = actions_.at(action.value);
+                    std::lock_guard<std::mutex> lock(hint.hint_lock);
+                    masked.mask_requesters.insert(hint_type);
+                    RefreshMaskBit(masked);
                 }
                 break;
             default:
@@ -154,56 +200,208 @@ void HintManager::DoHintAction(const std::string &hint_type) {
     }
 }
 
-void HintManager::EndHintAction(const std::string &hint_type) {
-    for (auto &action : actions_.at(hint_type).hint_actions) {
+void HintManager::EndHintAction(const std::string &hint_type, Hint &hint) {
+    for (auto &action : hint.hint_actions) {
         if (action.type == HintActionType::MaskHint &&
             actions_.find(action.value) != actions_.end()) {
-            std::lock_guard<std::mutex> lock(actions_.at(hint_type).hint_lock);
-            actions_.at(action.value).mask_requesters.erase(hint_type);
+            Hint &masked = actions_.at(action.value);
+            std::lock_guard<std::mutex> lock(hint.hint_lock);
+            masked.mask_requesters.erase(hint_type);
+            RefreshMaskBit(masked);
         }
     }
 }
 
-bool HintManager::DoHint(const std::string& hint_type) {
+bool HintManager::DoHintImpl(const std::string &hint_type, Hint &hint) {
     LOG(VERBOSE) << "Do Powerhint: " << hint_type;
-    if (!ValidateHint(hint_type) || !IsHintEnabled(hint_type) ||
-        !nm_->Request(actions_.at(hint_type).node_actions, hint_type)) {
+    if (nm_.get() == nullptr) {
+        LOG(ERROR) << "NodeLooperThread not present";
         return false;
     }
-    DoHintStatus(hint_type, actions_.at(hint_type).status->max_timeout);
-    DoHintAction(hint_type);
+    if (!IsHintEnabled(hint) || !nm_->Request(hint.node_actions, hint_type)) {
+        return false;
+    }
+    HintLatencyStats::GetInstance()->RecordEnqueue(hint_type);
+    DoHintStatus(hint_type, hint, hint.status->max_timeout);
+    DoHintAction(hint_type, hint);
     return true;
 }
 
-bool HintManager::DoHint(const std::string& hint_type,
-                         std::chrono::milliseconds timeout_ms_override) {
-    LOG(VERBOSE) << "Do Powerhint: " << hint_type << " for "
-                 << timeout_ms_override.count() << "ms";
-    if (!ValidateHint(hint_type) || !IsHintEnabled(hint_type)) {
+bool HintManager::DoHintImpl(const std::string &hint_type, Hint &hint,
+                             std::chrono::milliseconds timeout_ms_override) {
+    LOG(VERBOSE) << "Do Powerhint: " << hint_type << " for " << timeout_ms_override.count()
+                 << "ms";
+    if (nm_.get() == nullptr) {
+        LOG(ERROR) << "NodeLooperThread not present";
         return false;
     }
-    std::vector<NodeAction> actions_override = actions_.at(hint_type).node_actions;
+    if (!IsHintEnabled(hint)) {
+        return false;
+    }
+    std::vector<NodeAction> actions_override = hint.node_actions;
     for (auto& action : actions_override) {
         action.timeout_ms = timeout_ms_override;
     }
     if (!nm_->Request(actions_override, hint_type)) {
         return false;
     }
-    DoHintStatus(hint_type, timeout_ms_override);
-    DoHintAction(hint_type);
+    HintLatencyStats::GetInstance()->RecordEnqueue(hint_type);
+    DoHintStatus(hint_type, hint, timeout_ms_override);
+    DoHintAction(hint_type, hint);
     return true;
 }
 
-bool HintManager::EndHint(const std::string& hint_type) {
+bool HintManager::EndHintImpl(const std::string &hint_type, Hint &hint) {
     LOG(VERBOSE) << "End Powerhint: " << hint_type;
-    if (!ValidateHint(hint_type) || !nm_->Cancel(actions_.at(hint_type).node_actions, hint_type)) {
+    if (nm_.get() == nullptr) {
+        LOG(ERROR) << "NodeLooperThread not present";
+        return false;
+    }
+    if (!nm_->Cancel(hint.node_actions, hint_type)) {
         return false;
     }
-    EndHintStatus(hint_type);
-    EndHintAction(hint_type);
+    EndHintStatus(hint_type, hint);
+    EndHintAction(hint_type, hint);
     return true;
 }
 
+bool HintManager::DoHint(const std::string& hint_type) {
+    if (!IsHintSupported(hint_type)) {
+        return false;
+    }
+    return DoHintImpl(hint_type, actions_.at(hint_type));
+}
+
+bool HintManager::DoHint(const std::string& hint_type,
+                         std::chrono::milliseconds timeout_ms_override) {
+    if (!IsHintSupported(hint_type)) {
+        return false;
+    }
+    return DoHintImpl(hint_type, actions_.at(hint_type), timeout_ms_override);
+}
+
+bool HintManager::EndHint(const std::string& hint_type) {
+    if (!IsHintSupported(hint_type)) {
+        return false;
+    }
+    return EndHintImpl(hint_type, actions_.at(hint_type));
+}
+
+bool HintManager::DoHint(int hint_id) {
+    if (hint_id < 0 || hint_id >= static_cast<int>(hint_dispatch_table_.size())) {
+        return false;
+    }
+    const auto &entry = hint_dispatch_table_[hint_id];
+    return DoHintImpl(*entry.first, *entry.second);
+}
+
+bool HintManager::DoHint(int hint_id, std::chrono::milliseconds timeout_ms_override) {
+    if (hint_id < 0 || hint_id >= static_cast<int>(hint_dispatch_table_.size())) {
+        return false;
+    }
+    const auto &entry = hint_dispatch_table_[hint_id];
+    return DoHintImpl(*entry.first, *entry.second, timeout_ms_override);
+}
+
+bool HintManager::EndHint(int hint_id) {
+    if (hint_id < 0 || hint_id >= static_cast<int>(hint_dispatch_table_.size())) {
+        return false;
+    }
+    const auto &entry = hint_dispatch_table_[hint_id];
+    return EndHintImpl(*entry.first, *entry.second);
+}
+
+HintManager::HintTransaction HintManager::BeginTransaction() {
+    return HintTransaction(this);
+}
+
+HintManager::HintTransaction &HintManager::HintTransaction::DoHint(const std::string &hint_type) {
+    ops_.push_back({false, hint_type, false, kMilliSecondZero});
+    return *this;
+}
+
+HintManager::HintTransaction &HintManager::HintTransaction::DoHint(
+        const std::string &hint_type, std::chrono::milliseconds timeout_ms_override) {
+    ops_.push_back({false, hint_type, true, timeout_ms_override});
+    return *this;
+}
+
+HintManager::HintTransaction &HintManager::HintTransaction::EndHint(const std::string &hint_type) {
+    ops_.push_back({true, hint_type, false, kMilliSecondZero});
+    return *this;
+}
+
+bool HintManager::HintTransaction::Commit() {
+    if (committed_) {
+        LOG(ERROR) << "Hint transaction already committed";
+        return false;
+    }
+    committed_ = true;
+    if (hm_->nm_.get() == nullptr) {
+        LOG(ERROR) << "NodeLooperThread not present";
+        return false;
+    }
+    LOG(VERBOSE) << "Commit powerhint transaction of " << ops_.size() << " ops";
+
+    // First pass: resolve every op and collect its node updates into one
+    // looper batch, so the whole group is published with a single wake and
+    // applied in the same looper pass.
+    bool ret = true;
+    std::vector<std::pair<const Op *, Hint *>> applied;
+    applied.reserve(ops_.size());
+    NodeLooperThread::RequestBatch batch(hm_->nm_.get());
+    for (const auto &op : ops_) {
+        if (!hm_->IsHintSupported(op.hint_type)) {
+            ret = false;
+            continue;
+        }
+        Hint &hint = hm_->actions_.at(op.hint_type);
+        if (op.end) {
+            if (!batch.Cancel(hint.node_actions, op.hint_type)) {
+                ret = false;
+                continue;
+            }
+        } else {
+            if (!hm_->IsHintEnabled(hint)) {
+                ret = false;
+                continue;
+            }
+            if (op.has_override) {
+                std::vector<NodeAction> actions_override = hint.node_actions;
+                for (auto &action : actions_override) {
+                    action.timeout_ms = op.timeout_ms_override;
+                }
+                if (!batch.Request(actions_override, op.hint_type)) {
+                    ret = false;
+                    continue;
+                }
+            } else if (!batch.Request(hint.node_actions, op.hint_type)) {
+                ret = false;
+                continue;
+            }
+            HintLatencyStats::GetInstance()->RecordEnqueue(op.hint_type);
+        }
+        applied.emplace_back(&op, &hint);
+    }
+    batch.Submit();
+
+    // Second pass after the publish: status and chained-action bookkeeping,
+    // matching what the individual DoHint/EndHint calls do. Chained
+    // DoHint/EndHint actions go through the regular single-hint path.
+    for (const auto &[op, hint] : applied) {
+        if (op->end) {
+            hm_->EndHintStatus(op->hint_type, *hint);
+            hm_->EndHintAction(op->hint_type, *hint);
+        } else {
+            hm_->DoHintStatus(op->hint_type, *hint,
+                              op->has_override ? op->timeout_ms_override
+                                               : hint->status->max_timeout);
+            hm_->DoHintAction(op->hint_type, *hint);
+        }
+    }
+    return ret;
+}
+
 bool HintManager::IsRunning() const {
     return (nm_.get() == nullptr) ? false : nm_->isRunning();
 }
@@ -274,6 +472,9 @@ void HintManager::DumpToFd(int fd) {
             LOG(ERROR) << "Failed to dump fd: " << fd;
         }
     }
+
+    // No-op unless latency stats are enabled
+    HintLatencyStats::GetInstance()->DumpToFd(fd);
     fsync(fd);
 }
 
@@ -309,6 +510,21 @@ std::shared_ptr<HintManager> HintManager::GetInstance() {
     return mInstance;
 }
 
+// Parse a config document into a Json::Value tree shared by the section
+// parsers. Comment collection is off: device configs carry large comment
+// blocks that would otherwise be copied into the tree.
+static bool ParseJsonDoc(const std::string& json_doc, Json::Value* root) {
+    Json::CharReaderBuilder builder;
+    builder["collectComments"] = false;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string errorMessage;
+    if (!reader->parse(&*json_doc.begin(), &*json_doc.end(), root, &errorMessage)) {
+        LOG(ERROR) << "Failed to parse JSON config: " << errorMessage;
+        return false;
+    }
+    return true;
+}
+
 std::unique_ptr<HintManager> HintManager::GetFromJSON(
     const std::string& config_path, bool start) {
     std::string json_doc;
@@ -318,17 +534,25 @@ std::unique_ptr<HintManager> HintManager::GetFromJSON(
         return nullptr;
     }
 
-    std::vector<std::unique_ptr<Node>> nodes = ParseNodes(json_doc);
+    // Parse the document once; Nodes, Actions and AdpfConfig are read from
+    // the same tree instead of re-parsing the raw string per section.
+    Json::Value root;
+    if (!ParseJsonDoc(json_doc, &root)) {
+        LOG(ERROR) << "Failed to parse JSON config from " << config_path;
+        return nullptr;
+    }
+
+    std::vector<std::unique_ptr<Node>> nodes = ParseNodes(root);
     if (nodes.empty()) {
         LOG(ERROR) << "Failed to parse Nodes section from " << config_path;
         return nullptr;
     }
-    std::vector<std::shared_ptr<AdpfConfig>> adpfs = HintManager::ParseAdpfConfigs(json_doc);
+    std::vector<std::shared_ptr<AdpfConfig>> adpfs = HintManager::ParseAdpfConfigs(root);
     if (adpfs.empty()) {
         LOG(INFO) << "No AdpfConfig section in the " << config_path;
     }
 
-    std::unordered_map<std::string, Hint> actions = HintManager::ParseActions(json_doc, nodes);
+    std::unordered_map<std::string, Hint> actions = HintManager::ParseActions(root, nodes);
 
     if (actions.empty()) {
         LOG(ERROR) << "Failed to parse Actions section from " << config_path;
@@ -353,19 +577,18 @@ std::unique_ptr<HintManager> HintManager::GetFromJSON(
 
 std::vector<std::unique_ptr<Node>> HintManager::ParseNodes(
     const std::string& json_doc) {
+    Json::Value root;
+    if (!ParseJsonDoc(json_doc, &root)) {
+        return {};
+    }
+    return ParseNodes(root);
+}
+
+std::vector<std::unique_ptr<Node>> HintManager::ParseNodes(const Json::Value& root) {
     // function starts
     std::vector<std::unique_ptr<Node>> nodes_parsed;
     std::set<std::string> nodes_name_parsed;
     std::set<std::string> nodes_path_parsed;
-    Json::Value root;
-    Json::CharReaderBuilder builder;
-    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
-    std::string errorMessage;
-
-    if (!reader->parse(&*json_doc.begin(), &*json_doc.end(), &root, &errorMessage)) {
-        LOG(ERROR) << "Failed to parse JSON config: " << errorMessage;
-        return nodes_parsed;
-    }
 
     Json::Value nodes = root["Nodes"];
     for (Json::Value::ArrayIndex i = 0; i < nodes.size(); ++i) {
@@ -520,17 +743,17 @@ std::vector<std::unique_ptr<Node>> HintManager::ParseNodes(
 
 std::unordered_map<std::string, Hint> HintManager::ParseActions(
         const std::string &json_doc, const std::vector<std::unique_ptr<Node>> &nodes) {
-    // function starts
-    std::unordered_map<std::string, Hint> actions_parsed;
     Json::Value root;
-    Json::CharReaderBuilder builder;
-    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
-    std::string errorMessage;
-
-    if (!reader->parse(&*json_doc.begin(), &*json_doc.end(), &root, &errorMessage)) {
-        LOG(ERROR) << "Failed to parse JSON config";
-        return actions_parsed;
+    if (!ParseJsonDoc(json_doc, &root)) {
+        return {};
     }
+    return ParseActions(root, nodes);
+}
+
+std::unordered_map<std::string, Hint> HintManager::ParseActions(
+        const Json::Value &root, const std::vector<std::unique_ptr<Node>> &nodes) {
+    // function starts
+    std::unordered_map<std::string, Hint> actions_parsed;
 
     Json::Value actions = root["Actions"];
     std::size_t total_parsed = 0;
@@ -656,6 +879,14 @@ std::unordered_map<std::string, Hint> HintManager::ParseActions(
 
 std::vector<std::shared_ptr<AdpfConfig>> HintManager::ParseAdpfConfigs(
         const std::string &json_doc) {
+    Json::Value root;
+    if (!ParseJsonDoc(json_doc, &root)) {
+        return {};
+    }
+    return ParseAdpfConfigs(root);
+}
+
+std::vector<std::shared_ptr<AdpfConfig>> HintManager::ParseAdpfConfigs(const Json::Value &root) {
     // function starts
     bool pidOn;
     double pidPOver;
@@ -678,14 +909,6 @@ std::vector<std::shared_ptr<AdpfConfig>> HintManager::ParseAdpfConfigs(
     double targetTimeFactor;
     std::vector<std::shared_ptr<AdpfConfig>> adpfs_parsed;
     std::set<std::string> name_parsed;
-    Json::Value root;
-    Json::CharReaderBuilder builder;
-    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
-    std::string errorMessage;
-    if (!reader->parse(&*json_doc.begin(), &*json_doc.end(), &root, &errorMessage)) {
-        LOG(ERROR) << "Failed to parse JSON config: " << errorMessage;
-        return adpfs_parsed;
-    }
     Json::Value adpfs = root["AdpfConfig"];
     for (Json::Value::ArrayIndex i = 0; i < adpfs.size(); ++i) {
         std::string name = adpfs[i]["Name"].asString();
@@ -739,6 +962,12 @@ std::shared_ptr<AdpfConfig> HintManager::GetAdpfProfile() const {
     return adpfs_[adpf_index_];
 }
 
+AdpfConfig *HintManager::GetAdpfProfilePtr() const {
+    if (adpfs_.empty())
+        return nullptr;
+    return adpfs_[adpf_index_].get();
+}
+
 bool HintManager::SetAdpfProfile(const std::string &profile_name) {
     for (std::size_t i = 0; i < adpfs_.size(); ++i) {
         if (adpfs_[i]->mName == profile_name) {
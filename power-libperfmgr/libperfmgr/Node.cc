@@ -93,5 +93,9 @@ std::vector<std::string> Node::GetValues() const {
     return values;
 }
 
+std::size_t Node::GetValueCount() const {
+    return req_sorted_.size();
+}
+
 }  // namespace perfmgr
 }  // namespace android
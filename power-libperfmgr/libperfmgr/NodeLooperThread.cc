@@ -22,25 +22,120 @@
 #include <android-base/file.h>
 #include <android-base/logging.h>
 #include <android-base/properties.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 #include <utils/Trace.h>
 
+#include <limits>
+
+#include "perfmgr/HintLatencyStats.h"
+
 namespace android {
 namespace perfmgr {
 
-bool NodeLooperThread::Request(const std::vector<NodeAction>& actions,
-                               const std::string& hint_type) {
+NodeLooperThread::NodeLooperThread(std::vector<std::unique_ptr<Node>> nodes)
+    : Thread(false), nodes_(std::move(nodes)) {
+    // Every node starts dirty so the first wake initializes all of them.
+    dirty_flags_.assign(nodes_.size(), true);
+    node_deadlines_.assign(nodes_.size(), ReqTime::max());
+    dirty_nodes_.reserve(nodes_.size());
+    for (std::size_t i = 0; i < nodes_.size(); i++) {
+        dirty_nodes_.push_back(i);
+    }
+    wake_fd_.reset(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+    if (!wake_fd_.ok()) {
+        PLOG(FATAL) << "Failed to create looper eventfd";
+    }
+}
+
+NodeLooperThread::~NodeLooperThread() {
+    Stop();
+    // Free any requests that were enqueued but never drained
+    QueuedRequest* head = request_stack_.exchange(nullptr, std::memory_order_acquire);
+    while (head != nullptr) {
+        QueuedRequest* next = head->next;
+        delete head;
+        head = next;
+    }
+}
+
+void NodeLooperThread::WakeLooper() {
+    uint64_t one = 1;
+    TEMP_FAILURE_RETRY(write(wake_fd_.get(), &one, sizeof(one)));
+}
+
+void NodeLooperThread::Enqueue(QueuedRequest* req) {
+    EnqueueChain(req, req);
+}
+
+void NodeLooperThread::EnqueueChain(QueuedRequest* top, QueuedRequest* bottom) {
+    bottom->next = request_stack_.load(std::memory_order_relaxed);
+    while (!request_stack_.compare_exchange_weak(bottom->next, top, std::memory_order_release,
+                                                 std::memory_order_relaxed)) {
+    }
+    WakeLooper();
+}
+
+void NodeLooperThread::DrainRequestQueueLocked() {
+    QueuedRequest* head = request_stack_.exchange(nullptr, std::memory_order_acquire);
+    // Reverse the stolen LIFO stack so requests replay in arrival order
+    QueuedRequest* fifo = nullptr;
+    while (head != nullptr) {
+        QueuedRequest* next = head->next;
+        head->next = fifo;
+        fifo = head;
+        head = next;
+    }
+    while (fifo != nullptr) {
+        std::unique_ptr<QueuedRequest> req(fifo);
+        fifo = fifo->next;
+        for (const auto& a : req->actions) {
+            if (req->cancel) {
+                nodes_[a.node_index]->RemoveRequest(req->hint_type);
+            } else {
+                // End time set to steady time point max
+                ReqTime end_time = ReqTime::max();
+                // Timeout is non-zero
+                if (a.timeout_ms != std::chrono::milliseconds::zero()) {
+                    // Overflow protection in case timeout_ms is too big to
+                    // overflow time point which is unsigned integer
+                    if (std::chrono::duration_cast<std::chrono::milliseconds>(
+                                ReqTime::max() - req->req_time) > a.timeout_ms) {
+                        end_time = req->req_time + a.timeout_ms;
+                    }
+                }
+                nodes_[a.node_index]->AddRequest(a.value_index, req->hint_type, end_time);
+            }
+            MarkDirtyLocked(a.node_index);
+        }
+    }
+}
+
+NodeLooperThread::QueuedRequest* NodeLooperThread::BuildRequest(
+        const std::vector<NodeAction>& actions, const std::string& hint_type, bool cancel,
+        bool* valid) {
     if (::android::Thread::exitPending()) {
         LOG(WARNING) << "NodeLooperThread is exiting";
-        return false;
+        *valid = false;
+        return nullptr;
     }
     if (!::android::Thread::isRunning()) {
-        LOG(WARNING) << "NodeLooperThread is not running, request " << hint_type;
+        LOG(WARNING) << "NodeLooperThread is not running, " << (cancel ? "cancel " : "request ")
+                     << hint_type;
     }
 
-    bool ret = true;
-    ::android::AutoMutex _l(lock_);
+    // Validate up front against the immutable node table so the return value
+    // matches what applying the actions would report; only valid actions are
+    // enqueued. nodes_ never changes shape, so no lock is needed here.
+    *valid = true;
+    auto req = std::make_unique<QueuedRequest>();
+    req->cancel = cancel;
+    req->hint_type = hint_type;
+    req->req_time = std::chrono::steady_clock::now();
+    req->actions.reserve(actions.size());
     for (const auto& a : actions) {
-        if (!a.enable_property.empty() &&
+        if (!cancel && !a.enable_property.empty() &&
             !android::base::GetBoolProperty(a.enable_property, true)) {
             // Disabled action based on its control property
             continue;
@@ -48,52 +143,76 @@ bool NodeLooperThread::Request(const std::vector<NodeAction>& actions,
         if (a.node_index >= nodes_.size()) {
             LOG(ERROR) << "Node index out of bound: " << a.node_index
                        << " ,size: " << nodes_.size();
-            ret = false;
+            *valid = false;
+        } else if (!cancel && a.value_index >= nodes_[a.node_index]->GetValueCount()) {
+            LOG(ERROR) << "Value index out of bound: " << a.value_index
+                       << " ,size: " << nodes_[a.node_index]->GetValueCount();
+            *valid = false;
         } else {
-            // End time set to steady time point max
-            ReqTime end_time = ReqTime::max();
-            // Timeout is non-zero
-            if (a.timeout_ms != std::chrono::milliseconds::zero()) {
-                auto now = std::chrono::steady_clock::now();
-                // Overflow protection in case timeout_ms is too big to overflow
-                // time point which is unsigned integer
-                if (std::chrono::duration_cast<std::chrono::milliseconds>(
-                        ReqTime::max() - now) > a.timeout_ms) {
-                    end_time = now + a.timeout_ms;
-                }
-            }
-            ret = nodes_[a.node_index]->AddRequest(a.value_index, hint_type,
-                                                   end_time) &&
-                  ret;
+            req->actions.push_back(a);
         }
     }
-    wake_cond_.signal();
-    return ret;
+    if (req->actions.empty()) {
+        return nullptr;
+    }
+    return req.release();
+}
+
+bool NodeLooperThread::Request(const std::vector<NodeAction>& actions,
+                               const std::string& hint_type) {
+    bool valid;
+    QueuedRequest* req = BuildRequest(actions, hint_type, false /* cancel */, &valid);
+    if (req != nullptr) {
+        Enqueue(req);
+    }
+    return valid;
 }
 
 bool NodeLooperThread::Cancel(const std::vector<NodeAction>& actions,
                               const std::string& hint_type) {
-    if (::android::Thread::exitPending()) {
-        LOG(WARNING) << "NodeLooperThread is exiting";
-        return false;
+    bool valid;
+    QueuedRequest* req = BuildRequest(actions, hint_type, true /* cancel */, &valid);
+    if (req != nullptr) {
+        Enqueue(req);
     }
-    if (!::android::Thread::isRunning()) {
-        LOG(WARNING) << "NodeLooperThread is not running, cancel " << hint_type;
+    return valid;
+}
+
+bool NodeLooperThread::RequestBatch::Request(const std::vector<NodeAction>& actions,
+                                             const std::string& hint_type) {
+    bool valid;
+    QueuedRequest* req = looper_->BuildRequest(actions, hint_type, false /* cancel */, &valid);
+    if (req != nullptr) {
+        req->next = top_;
+        top_ = req;
+        if (bottom_ == nullptr) {
+            bottom_ = req;
+        }
     }
+    return valid;
+}
 
-    bool ret = true;
-    ::android::AutoMutex _l(lock_);
-    for (const auto& a : actions) {
-        if (a.node_index >= nodes_.size()) {
-            LOG(ERROR) << "Node index out of bound: " << a.node_index
-                       << " ,size: " << nodes_.size();
-            ret = false;
-        } else {
-            nodes_[a.node_index]->RemoveRequest(hint_type);
+bool NodeLooperThread::RequestBatch::Cancel(const std::vector<NodeAction>& actions,
+                                            const std::string& hint_type) {
+    bool valid;
+    QueuedRequest* req = looper_->BuildRequest(actions, hint_type, true /* cancel */, &valid);
+    if (req != nullptr) {
+        req->next = top_;
+        top_ = req;
+        if (bottom_ == nullptr) {
+            bottom_ = req;
         }
     }
-    wake_cond_.signal();
-    return ret;
+    return valid;
+}
+
+void NodeLooperThread::RequestBatch::Submit() {
+    if (top_ == nullptr) {
+        return;
+    }
+    looper_->EnqueueChain(top_, bottom_);
+    top_ = nullptr;
+    bottom_ = nullptr;
 }
 
 void NodeLooperThread::DumpToFd(int fd) {
@@ -104,30 +223,78 @@ void NodeLooperThread::DumpToFd(int fd) {
 }
 
 bool NodeLooperThread::threadLoop() {
-    ::android::AutoMutex _l(lock_);
-    std::chrono::milliseconds timeout_ms = kMaxUpdatePeriod;
+    int poll_timeout_ms = -1;
+    {
+        ::android::AutoMutex _l(lock_);
+        // Clear the wakeup counter before stealing the queue so a request
+        // enqueued after the steal leaves the counter raised and the next
+        // poll() returns immediately.
+        uint64_t wake_count;
+        TEMP_FAILURE_RETRY(read(wake_fd_.get(), &wake_count, sizeof(wake_count)));
+        DrainRequestQueueLocked();
+        auto now = std::chrono::steady_clock::now();
 
-    // Update 2 passes: some node may have dependency in other node
-    // e.g. update cpufreq min to VAL while cpufreq max still set to
-    // a value lower than VAL, is expected to fail in first pass
-    ATRACE_BEGIN("update_nodes");
-    for (auto& n : nodes_) {
-        n->Update(false);
-    }
-    for (auto& n : nodes_) {
-        timeout_ms = std::min(n->Update(true), timeout_ms);
-    }
-    ATRACE_END();
+        // Collect the nodes worth visiting this wake: the ones touched by
+        // queued requests, plus the ones whose earliest request expiry has
+        // passed. Untouched nodes keep their previous state and deadline,
+        // so they are safe to skip entirely.
+        std::vector<std::size_t> pending = std::move(dirty_nodes_);
+        dirty_nodes_.clear();
+        for (std::size_t i = 0; i < nodes_.size(); i++) {
+            if (!dirty_flags_[i] && node_deadlines_[i] <= now) {
+                pending.push_back(i);
+            }
+            dirty_flags_[i] = false;
+        }
 
-    nsecs_t sleep_timeout_ns = std::numeric_limits<nsecs_t>::max();
-    if (timeout_ms.count() < sleep_timeout_ns / 1000 / 1000) {
-        sleep_timeout_ns = timeout_ms.count() * 1000 * 1000;
+        // Update 2 passes: some node may have dependency in other node
+        // e.g. update cpufreq min to VAL while cpufreq max still set to
+        // a value lower than VAL, is expected to fail in first pass
+        ATRACE_BEGIN("update_nodes");
+        for (std::size_t i : pending) {
+            nodes_[i]->Update(false);
+        }
+        for (std::size_t i : pending) {
+            std::chrono::milliseconds expire = nodes_[i]->Update(true);
+            // Overflow protection; milliseconds::max() means no outstanding
+            // timed request on this node
+            if (expire == kMaxUpdatePeriod ||
+                std::chrono::duration_cast<std::chrono::milliseconds>(ReqTime::max() - now) <=
+                        expire) {
+                node_deadlines_[i] = ReqTime::max();
+            } else {
+                node_deadlines_[i] = now + expire;
+            }
+        }
+        ATRACE_END();
+
+        // Close out latency records for the requests applied by this wake;
+        // no-op unless latency stats are enabled
+        if (!pending.empty()) {
+            HintLatencyStats::GetInstance()->RecordApplied();
+        }
+
+        // Sleep until the earliest deadline across all nodes
+        ReqTime next_deadline = ReqTime::max();
+        for (const auto& deadline : node_deadlines_) {
+            next_deadline = std::min(next_deadline, deadline);
+        }
+        if (next_deadline != ReqTime::max()) {
+            auto timeout_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::max(next_deadline - now, std::chrono::steady_clock::duration::zero()));
+            poll_timeout_ms = timeout_ms.count() > std::numeric_limits<int>::max()
+                                      ? std::numeric_limits<int>::max()
+                                      : static_cast<int>(timeout_ms.count());
+        }
     }
+
+    // Wait outside the lock so dump and queue producers never block on the
+    // looper; poll's relative timeout is immune to wall time changes.
     // VERBOSE level won't print by default in user/userdebug build
-    LOG(VERBOSE) << "NodeLooperThread will wait for " << sleep_timeout_ns
-                 << "ns";
+    LOG(VERBOSE) << "NodeLooperThread will wait for " << poll_timeout_ms << "ms";
+    struct pollfd wake_poll = {.fd = wake_fd_.get(), .events = POLLIN, .revents = 0};
     ATRACE_BEGIN("wait");
-    wake_cond_.waitRelative(lock_, sleep_timeout_ns);
+    TEMP_FAILURE_RETRY(poll(&wake_poll, 1, poll_timeout_ms));
     ATRACE_END();
     return true;
 }
@@ -145,11 +312,8 @@ bool NodeLooperThread::Start() {
 void NodeLooperThread::Stop() {
     if (::android::Thread::isRunning()) {
         LOG(INFO) << "NodeLooperThread stopping";
-        {
-            ::android::AutoMutex _l(lock_);
-            wake_cond_.signal();
-            ::android::Thread::requestExit();
-        }
+        ::android::Thread::requestExit();
+        WakeLooper();
         ::android::Thread::join();
         LOG(INFO) << "NodeLooperThread stopped";
     }
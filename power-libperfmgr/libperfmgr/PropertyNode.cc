@@ -26,6 +26,8 @@
 #include <android-base/strings.h>
 #include <utils/Trace.h>
 
+#include "perfmgr/AsyncFileWriter.h"
+
 namespace android {
 namespace perfmgr {
 
@@ -33,9 +35,11 @@ PropertyNode::PropertyNode(std::string name, std::string node_path,
                            std::vector<RequestGroup> req_sorted,
                            std::size_t default_val_index, bool reset_on_init)
     : Node(std::move(name), std::move(node_path), std::move(req_sorted),
-           default_val_index, reset_on_init) {}
+           default_val_index, reset_on_init),
+      async_write_(
+          android::base::GetBoolProperty("vendor.powerhal.async_node_write", false)) {}
 
-std::chrono::milliseconds PropertyNode::Update(bool) {
+std::chrono::milliseconds PropertyNode::Update(bool log_error) {
     std::size_t value_index = default_val_index_;
     std::chrono::milliseconds expire_time = std::chrono::milliseconds::max();
 
@@ -49,27 +53,44 @@ std::chrono::milliseconds PropertyNode::Update(bool) {
 
     // Update node only if request index changes
     if (value_index != current_val_index_ || reset_on_init_) {
-        const std::string& req_value =
-            req_sorted_[value_index].GetRequestValue();
-        if (ATRACE_ENABLED()) {
-            const std::string tag = GetName() + ":" + req_value;
-            ATRACE_BEGIN(tag.c_str());
-        }
-        if (!android::base::SetProperty(node_path_, req_value)) {
-            LOG(WARNING) << "Failed to set property to : " << node_path_
-                         << " with value: " << req_value;
-        } else {
-            // Update current index only when succeed
-            current_val_index_ = value_index;
-            reset_on_init_ = false;
-        }
-        if (ATRACE_ENABLED()) {
-            ATRACE_END();
+        if (async_write_) {
+            // Property-service round trips run hundreds of microseconds
+            // under load; setting off the looper keeps them from stalling
+            // the file-node writes queued behind this node.
+            AsyncFileWriter::GetInstance()->Submit(this, value_index, log_error);
+            // Check back shortly: a failed queued set leaves the current
+            // index unchanged, so the next Update() resubmits it.
+            expire_time = std::min(expire_time, std::chrono::milliseconds(500));
+        } else if (!WriteValue(value_index, log_error)) {
+            // Retry in 500ms or sooner
+            expire_time = std::min(expire_time, std::chrono::milliseconds(500));
         }
     }
     return expire_time;
 }
 
+bool PropertyNode::WriteValue(std::size_t value_index, bool) {
+    const std::string& req_value = req_sorted_[value_index].GetRequestValue();
+    if (ATRACE_ENABLED()) {
+        const std::string tag = GetName() + ":" + req_value;
+        ATRACE_BEGIN(tag.c_str());
+    }
+    bool success = true;
+    if (!android::base::SetProperty(node_path_, req_value)) {
+        LOG(WARNING) << "Failed to set property to : " << node_path_
+                     << " with value: " << req_value;
+        success = false;
+    } else {
+        // Update current index only when succeed
+        current_val_index_ = value_index;
+        reset_on_init_ = false;
+    }
+    if (ATRACE_ENABLED()) {
+        ATRACE_END();
+    }
+    return success;
+}
+
 void PropertyNode::DumpToFd(int fd) const {
     std::string node_value = android::base::GetProperty(node_path_, "");
     std::string buf(android::base::StringPrintf(
@@ -78,7 +99,7 @@ void PropertyNode::DumpToFd(int fd) const {
             "Current Index\t"
             "Current Value\n"
             "%s\t%s\t%zu\t%s\n",
-            name_.c_str(), node_path_.c_str(), current_val_index_, node_value.c_str()));
+            name_.c_str(), node_path_.c_str(), current_val_index_.load(), node_value.c_str()));
     if (!android::base::WriteStringToFd(buf, fd)) {
         LOG(ERROR) << "Failed to dump fd: " << fd;
     }
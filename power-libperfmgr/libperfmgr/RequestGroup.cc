@@ -26,20 +26,44 @@
 namespace android {
 namespace perfmgr {
 
+RequestGroup::Request* RequestGroup::FindActiveRequest(const std::string& hint_type) {
+    for (auto& req : requests_) {
+        if (req.active && req.hint_type == hint_type) {
+            return &req;
+        }
+    }
+    return nullptr;
+}
+
 bool RequestGroup::AddRequest(const std::string& hint_type, ReqTime end_time) {
-    if (request_map_.find(hint_type) == request_map_.end()) {
-        request_map_.emplace(hint_type, end_time);
-        return true;
-    } else {
-        if (request_map_[hint_type] < end_time) {
-            request_map_[hint_type] = end_time;
+    Request* req = FindActiveRequest(hint_type);
+    if (req != nullptr) {
+        if (req->end_time < end_time) {
+            req->end_time = end_time;
         }
         return false;
     }
+    for (auto& slot : requests_) {
+        if (!slot.active) {
+            // Reuse a tombstoned slot; assigning into the retained string
+            // capacity avoids allocating on the per-frame boost path
+            slot.hint_type.assign(hint_type);
+            slot.end_time = end_time;
+            slot.active = true;
+            return true;
+        }
+    }
+    requests_.push_back({hint_type, end_time, true});
+    return true;
 }
 
 bool RequestGroup::RemoveRequest(const std::string& hint_type) {
-    return request_map_.erase(hint_type);
+    Request* req = FindActiveRequest(hint_type);
+    if (req == nullptr) {
+        return false;
+    }
+    req->active = false;
+    return true;
 }
 
 const std::string& RequestGroup::GetRequestValue() const {
@@ -51,15 +75,17 @@ bool RequestGroup::GetExpireTime(std::chrono::milliseconds* expire_time) {
     *expire_time = std::chrono::milliseconds::max();
 
     bool active = false;
-    for (auto it = request_map_.begin(); it != request_map_.end();) {
+    for (auto& req : requests_) {
+        if (!req.active) {
+            continue;
+        }
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-            it->second - now);
+            req.end_time - now);
         if (duration <= std::chrono::milliseconds::zero()) {
-            it = request_map_.erase(it);
+            req.active = false;
         } else {
             *expire_time = std::min(duration, *expire_time);
             active = true;
-            ++it;
         }
     }
     return active;
@@ -68,11 +94,14 @@ bool RequestGroup::GetExpireTime(std::chrono::milliseconds* expire_time) {
 void RequestGroup::DumpToFd(int fd, const std::string& prefix) const {
     std::ostringstream dump_buf;
     ReqTime now = std::chrono::steady_clock::now();
-    for (auto it = request_map_.begin(); it != request_map_.end(); it++) {
+    for (const auto& req : requests_) {
+        if (!req.active) {
+            continue;
+        }
         auto remaining_duration =
-            std::chrono::duration_cast<std::chrono::milliseconds>(it->second -
+            std::chrono::duration_cast<std::chrono::milliseconds>(req.end_time -
                                                                   now);
-        dump_buf << prefix << it->first << "\t" << remaining_duration.count()
+        dump_buf << prefix << req.hint_type << "\t" << remaining_duration.count()
                  << "\t" << request_value_ << "\n";
     }
     if (!android::base::WriteStringToFd(dump_buf.str(), fd)) {
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specic language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_LIBPERFMGR_ASYNCFILEWRITER_H_
+#define ANDROID_LIBPERFMGR_ASYNCFILEWRITER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace android {
+namespace perfmgr {
+
+class Node;
+
+// Small worker pool that applies node writes off the NodeLooperThread, so one
+// slow store - a multi-ms sysfs write under governor contention or a
+// property-service round trip - cannot delay boost application for every
+// other queued node. Submissions coalesce per node to the most recent value,
+// and writes for the same node never run concurrently, preserving per-node
+// ordering. Nodes are owned by NodeLooperThread for the lifetime of the
+// process, so queued pointers stay valid.
+class AsyncFileWriter {
+  public:
+    static AsyncFileWriter *GetInstance();
+
+    // Queue a write of node's value at value_index, replacing any write for
+    // the same node that has not started yet.
+    void Submit(Node *node, std::size_t value_index, bool log_error);
+
+  private:
+    AsyncFileWriter();
+    ~AsyncFileWriter();
+    AsyncFileWriter(const AsyncFileWriter &) = delete;
+    AsyncFileWriter &operator=(const AsyncFileWriter &) = delete;
+
+    void WorkerLoop();
+
+    struct PendingWrite {
+        std::size_t value_index;
+        bool log_error;
+    };
+
+    static constexpr std::size_t kNumWorkers = 2;
+
+    std::mutex lock_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    // Coalesced pending value per node
+    std::unordered_map<Node *, PendingWrite> pending_;
+    // Nodes with a pending entry and no write in flight
+    std::deque<Node *> ready_queue_;
+    // Nodes currently being written by a worker
+    std::unordered_set<Node *> inflight_;
+    std::vector<std::thread> workers_;
+};
+
+}  // namespace perfmgr
+}  // namespace android
+
+#endif  // ANDROID_LIBPERFMGR_ASYNCFILEWRITER_H_
@@ -37,6 +37,9 @@ class FileNode : public Node {
 
     std::chrono::milliseconds Update(bool log_error) override;
 
+    // Open/write/fsync the node value at value_index
+    bool WriteValue(std::size_t value_index, bool log_error) override;
+
     bool GetHoldFd() const;
     bool GetTruncate() const;
 
@@ -50,6 +53,8 @@ class FileNode : public Node {
     const bool truncate_;
     // node will be read in DumpToFd
     const bool write_only_;
+    // write off the looper through AsyncFileWriter
+    const bool async_write_;
     const std::chrono::milliseconds warn_timeout_;
     android::base::unique_fd fd_;
 };
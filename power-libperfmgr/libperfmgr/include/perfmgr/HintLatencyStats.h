@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_LIBPERFMGR_HINTLATENCYSTATS_H_
+#define ANDROID_LIBPERFMGR_HINTLATENCYSTATS_H_
+
+#include <android-base/unique_fd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace android {
+namespace perfmgr {
+
+// Latency histogram bucket upper bounds in microseconds; the last bucket is
+// open-ended. Shared by the per-hint enqueue-to-apply histograms and the
+// aggregate node write duration histogram.
+inline constexpr uint64_t kLatencyBucketBoundsUs[] = {100,  200,  500,   1000,
+                                                      2000, 5000, 10000};
+inline constexpr std::size_t kNumLatencyBuckets =
+        sizeof(kLatencyBucketBoundsUs) / sizeof(kLatencyBucketBoundsUs[0]) + 1;
+
+// One counter record per hint in the shared page. All fields are monotonic
+// counters updated with relaxed atomics, so readers need no lock: a torn
+// snapshot is at worst one sample off.
+struct HintLatencyEntry {
+    char name[64];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum_us;
+    std::atomic<uint64_t> max_us;
+    std::atomic<uint64_t> drops;
+    std::atomic<uint32_t> buckets[kNumLatencyBuckets];
+};
+
+struct HintLatencyHeader {
+    uint32_t version;
+    uint32_t hint_count;
+    // Global sequence stamped on every recorded hint request.
+    std::atomic<uint64_t> next_seq;
+    // Aggregate sysfs write duration across all file nodes; node writes are
+    // not 1:1 with hints, so duration is not attributed per hint.
+    std::atomic<uint64_t> write_count;
+    std::atomic<uint64_t> write_sum_us;
+    std::atomic<uint64_t> write_max_us;
+    std::atomic<uint32_t> write_buckets[kNumLatencyBuckets];
+};
+
+// Publishes per-hint boost-application latency counters into a memfd-backed
+// page readable by stats daemons without binder traffic. DoHint stamps an
+// enqueue record, the looper closes it after the wake that applies the
+// request, and FileNode reports raw write durations. Off by default; enabled
+// with the vendor.powerhal.latency_stats property.
+class HintLatencyStats {
+  public:
+    static HintLatencyStats *GetInstance();
+
+    // Sizes and maps the page with one entry per hint name. Returns false
+    // when stats are disabled by property or the page cannot be created.
+    bool Initialize(const std::vector<std::string> &hint_names);
+    // Stamps a sequence and enqueue time for a hint request about to reach
+    // the looper. Bumps the hint's drop counter when the pending ring is
+    // full.
+    void RecordEnqueue(const std::string &hint_type);
+    // Closes all pending enqueue records against the wake that just applied
+    // them; called by the looper after its update pass.
+    void RecordApplied();
+    // Accounts one sysfs node write into the aggregate write histogram.
+    void RecordNodeWrite(std::chrono::milliseconds duration);
+    // Dump all histograms to fd in text form.
+    void DumpToFd(int fd);
+
+    // The page fd, sealed against resize, to be duped out to readers.
+    int GetFd() const { return fd_.get(); }
+    bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  private:
+    HintLatencyStats() = default;
+    ~HintLatencyStats();
+    HintLatencyStats(const HintLatencyStats &) = delete;
+    void operator=(const HintLatencyStats &) = delete;
+
+    // Bounded so a stalled looper cannot grow unbounded bookkeeping; new
+    // records are dropped (and counted) when full.
+    static constexpr std::size_t kMaxPendingRecords = 64;
+
+    struct PendingRecord {
+        std::size_t entry_index;
+        uint64_t seq;
+        std::chrono::steady_clock::time_point enqueue_time;
+    };
+
+    HintLatencyEntry *EntryAt(std::size_t idx);
+    static std::size_t BucketFor(uint64_t latency_us);
+
+    std::atomic<bool> enabled_{false};
+    ::android::base::unique_fd fd_;
+    void *page_ = nullptr;
+    std::size_t page_size_ = 0;
+    std::unordered_map<std::string, std::size_t> entry_index_map_;
+    std::mutex pending_lock_;
+    std::vector<PendingRecord> pending_;
+};
+
+}  // namespace perfmgr
+}  // namespace android
+
+#endif  // ANDROID_LIBPERFMGR_HINTLATENCYSTATS_H_
@@ -18,6 +18,7 @@
 #define ANDROID_LIBPERFMGR_HINTMANAGER_H_
 
 #include <android-base/thread_annotations.h>
+#include <json/value.h>
 
 #include <atomic>
 #include <cstddef>
@@ -74,12 +75,15 @@ struct Hint {
         : node_actions(obj.node_actions),
           hint_actions(obj.hint_actions),
           mask_requesters(obj.mask_requesters),
-          status(obj.status) {}
+          status(obj.status),
+          hint_id(obj.hint_id) {}
     std::vector<NodeAction> node_actions;
     std::vector<HintAction> hint_actions;
     mutable std::mutex hint_lock;
     std::set<std::string> mask_requesters GUARDED_BY(hint_lock);
     std::shared_ptr<HintStatus> status GUARDED_BY(hint_lock);
+    // Dense id assigned by HintManager::BuildHintIdTable; -1 until then
+    int hint_id{-1};
 };
 
 // HintManager is the external interface of the library to be used by PowerHAL
@@ -90,7 +94,9 @@ class HintManager {
   public:
     HintManager(sp<NodeLooperThread> nm, const std::unordered_map<std::string, Hint> &actions,
                 const std::vector<std::shared_ptr<AdpfConfig>> &adpfs)
-        : nm_(std::move(nm)), actions_(actions), adpfs_(adpfs), adpf_index_(0) {}
+        : nm_(std::move(nm)), actions_(actions), adpfs_(adpfs), adpf_index_(0) {
+        BuildHintIdTable();
+    }
     ~HintManager() {
         if (nm_.get() != nullptr) nm_->Stop();
     }
@@ -113,6 +119,53 @@ class HintManager {
     // NodeLooperThread::Cancel succeeds; otherwise return false.
     bool EndHint(const std::string& hint_type);
 
+    // Returned by GetHintId for hint types not present in the actions.
+    static constexpr int kInvalidHintId = -1;
+
+    // Resolve a hint type to the dense id assigned when the actions map was
+    // built; ids stay stable for the manager's lifetime. Callers on per-frame
+    // paths should resolve once and use the id overloads below, which dispatch
+    // by array index instead of hashing the hint string on every call.
+    int GetHintId(const std::string &hint_type) const;
+
+    // Id-based counterparts of DoHint/EndHint for pre-resolved hint types.
+    bool DoHint(int hint_id);
+    bool DoHint(int hint_id, std::chrono::milliseconds timeout_ms_override);
+    bool EndHint(int hint_id);
+
+    // Groups several DoHint/EndHint calls into one batch: on Commit() all of
+    // their node updates are published to the looper as a single unit and
+    // applied in one looper pass, so e.g. a display or mode transition lands
+    // all related sysfs changes in one wake instead of several. Ops apply in
+    // the order they were added; Commit() returns true only when every op
+    // resolved to a supported, unmasked hint and enqueued cleanly, mirroring
+    // the return values of the individual DoHint/EndHint calls.
+    class HintTransaction {
+      public:
+        HintTransaction &DoHint(const std::string &hint_type);
+        HintTransaction &DoHint(const std::string &hint_type,
+                                std::chrono::milliseconds timeout_ms_override);
+        HintTransaction &EndHint(const std::string &hint_type);
+        bool Commit();
+
+      private:
+        friend class HintManager;
+        explicit HintTransaction(HintManager *hm) : hm_(hm) {}
+
+        struct Op {
+            bool end;
+            std::string hint_type;
+            bool has_override;
+            std::chrono::milliseconds timeout_ms_override;
+        };
+        HintManager *const hm_;
+        std::vector<Op> ops_;
+        bool committed_ = false;
+    };
+
+    // Begin a transaction grouping multiple hint changes into one looper pass.
+    HintTransaction BeginTransaction();
+
     // Query if given hint supported.
     bool IsHintSupported(const std::string& hint_type) const;
 
@@ -125,6 +178,11 @@ class HintManager {
     // get current ADPF.
     std::shared_ptr<AdpfConfig> GetAdpfProfile() const;
 
+    // Raw-pointer variant for hot paths that only need to detect a profile
+    // switch; skips the shared_ptr refcount round trip. The pointee stays
+    // valid for the lifetime of the HintManager.
+    AdpfConfig *GetAdpfProfilePtr() const;
+
     // Query if given AdpfProfile supported.
     bool IsAdpfProfileSupported(const std::string &name) const;
 
@@ -149,11 +207,18 @@ class HintManager {
     static std::shared_ptr<HintManager> Reload(bool start);
 
   protected:
+    // The string overloads parse json_doc and delegate to the Json::Value
+    // overloads below; GetFromJSON parses the document once and feeds the
+    // same tree to all three section parsers.
     static std::vector<std::unique_ptr<Node>> ParseNodes(
         const std::string& json_doc);
+    static std::vector<std::unique_ptr<Node>> ParseNodes(const Json::Value& root);
     static std::unordered_map<std::string, Hint> ParseActions(
             const std::string &json_doc, const std::vector<std::unique_ptr<Node>> &nodes);
+    static std::unordered_map<std::string, Hint> ParseActions(
+            const Json::Value &root, const std::vector<std::unique_ptr<Node>> &nodes);
     static std::vector<std::shared_ptr<AdpfConfig>> ParseAdpfConfigs(const std::string &json_doc);
+    static std::vector<std::shared_ptr<AdpfConfig>> ParseAdpfConfigs(const Json::Value &root);
     static bool InitHintStatus(const std::unique_ptr<HintManager> &hm);
 
   private:
@@ -162,16 +227,39 @@ class HintManager {
     static std::shared_ptr<HintManager> mInstance;
 
     bool ValidateHint(const std::string& hint_type) const;
+    // Assign dense ids to the hints in actions_; entries point into the map,
+    // which never changes shape after construction.
+    void BuildHintIdTable();
+    // Mask check on an already-resolved hint
+    bool IsHintEnabled(const Hint &hint) const;
+    // Republish hint's masked/unmasked state into hint_mask_bits_. Called
+    // with hint's mask_requesters freshly mutated, under the same lock that
+    // guarded the mutation.
+    void RefreshMaskBit(const Hint &hint);
+    // Resolved-hint implementations shared by the string and id entry points
+    bool DoHintImpl(const std::string &hint_type, Hint &hint);
+    bool DoHintImpl(const std::string &hint_type, Hint &hint,
+                    std::chrono::milliseconds timeout_ms_override);
+    bool EndHintImpl(const std::string &hint_type, Hint &hint);
     // Helper function to update the HintStatus when DoHint
-    void DoHintStatus(const std::string &hint_type, std::chrono::milliseconds timeout_ms);
+    void DoHintStatus(const std::string &hint_type, Hint &hint,
+                      std::chrono::milliseconds timeout_ms);
     // Helper function to update the HintStatus when EndHint
-    void EndHintStatus(const std::string &hint_type);
+    void EndHintStatus(const std::string &hint_type, Hint &hint);
     // Helper function to take hint actions when DoHint
-    void DoHintAction(const std::string &hint_type);
+    void DoHintAction(const std::string &hint_type, Hint &hint);
     // Helper function to take hint actions when EndHint
-    void EndHintAction(const std::string &hint_type);
+    void EndHintAction(const std::string &hint_type, Hint &hint);
     sp<NodeLooperThread> nm_;
     std::unordered_map<std::string, Hint> actions_;
+    // Dense id -> (type, hint) dispatch table over actions_
+    std::vector<std::pair<const std::string *, Hint *>> hint_dispatch_table_;
+    std::unordered_map<std::string, int> hint_id_map_;
+    // One bit per dense hint id, set while the hint has any mask requester.
+    // Mask changes recompute the affected bit out-of-line, so the DoHint hot
+    // path decides enablement with a single load and AND no matter how many
+    // MaskHint rules the config carries.
+    std::vector<std::atomic<uint64_t>> hint_mask_bits_;
     std::vector<std::shared_ptr<AdpfConfig>> adpfs_;
     uint32_t adpf_index_;
 };
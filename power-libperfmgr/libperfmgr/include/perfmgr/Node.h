@@ -19,6 +19,7 @@
 
 #include <android-base/unique_fd.h>
 
+#include <atomic>
 #include <cstddef>
 #include <string>
 #include <vector>
@@ -61,9 +62,19 @@ class Node {
     // active request.
     virtual std::chrono::milliseconds Update(bool log_error) = 0;
 
+    // Apply the value at value_index to the underlying target and update the
+    // current index bookkeeping. Runs inline on the looper by default, or on
+    // an AsyncFileWriter worker when async node writes are enabled. Returns
+    // false if the write failed; the current index is left unchanged in that
+    // case so the next Update() retries.
+    virtual bool WriteValue(std::size_t value_index, bool log_error) = 0;
+
     const std::string& GetName() const;
     const std::string& GetPath() const;
     std::vector<std::string> GetValues() const;
+    // Number of possible values; cheap enough for request validation on the
+    // boost path, unlike GetValues() which copies the strings.
+    std::size_t GetValueCount() const;
     std::size_t GetDefaultIndex() const;
     bool GetResetOnInit() const;
     bool GetValueIndex(const std::string& value, std::size_t* index) const;
@@ -82,8 +93,10 @@ class Node {
     std::vector<RequestGroup> req_sorted_;
     const std::size_t default_val_index_;
     // node will be explicitly initialized when first time called Update().
-    bool reset_on_init_;
-    std::size_t current_val_index_;
+    // Atomic because asynchronous file writes clear/publish these from an
+    // AsyncFileWriter worker while the looper reads them in Update().
+    std::atomic<bool> reset_on_init_;
+    std::atomic<std::size_t> current_val_index_;
 };
 
 }  // namespace perfmgr
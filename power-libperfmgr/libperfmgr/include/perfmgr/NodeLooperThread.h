@@ -17,8 +17,10 @@
 #ifndef ANDROID_LIBPERFMGR_NODELOOPERTHREAD_H_
 #define ANDROID_LIBPERFMGR_NODELOOPERTHREAD_H_
 
+#include <android-base/unique_fd.h>
 #include <utils/Thread.h>
 
+#include <atomic>
 #include <cstddef>
 #include <memory>
 #include <string>
@@ -54,24 +56,56 @@ struct NodeAction {
 // to maintain the sysfs nodes, and that thread is woken up both to handle
 // powerhint requests and when the timeout expires for an in-progress powerhint.
 class NodeLooperThread : public ::android::Thread {
+    struct QueuedRequest;
+
   public:
-    explicit NodeLooperThread(std::vector<std::unique_ptr<Node>> nodes)
-        : Thread(false), nodes_(std::move(nodes)) {}
-    virtual ~NodeLooperThread() { Stop(); }
+    explicit NodeLooperThread(std::vector<std::unique_ptr<Node>> nodes);
+    virtual ~NodeLooperThread();
+
+    // Groups several Request/Cancel submissions into one publish: the
+    // collected requests are linked into a single chain, pushed onto the
+    // request stack with one CAS and one looper wake, so the looper applies
+    // the whole group in the same drain and all of its node writes land in a
+    // single pass. An unsubmitted batch is published by the destructor.
+    class RequestBatch {
+      public:
+        explicit RequestBatch(NodeLooperThread *looper) : looper_(looper) {}
+        ~RequestBatch() { Submit(); }
+
+        // Same validation and return contract as the NodeLooperThread methods
+        // of the same name, but the enqueue is deferred until Submit().
+        bool Request(const std::vector<NodeAction> &actions, const std::string &hint_type);
+        bool Cancel(const std::vector<NodeAction> &actions, const std::string &hint_type);
+
+        // Publish everything collected with a single looper wake; no-op on an
+        // empty or already-submitted batch.
+        void Submit();
+
+      private:
+        RequestBatch(RequestBatch const &) = delete;
+        void operator=(RequestBatch const &) = delete;
+
+        NodeLooperThread *const looper_;
+        // Chain kept in reverse arrival order so pushing top_ onto the LIFO
+        // request stack replays the batch in arrival order after the drain
+        // reversal.
+        QueuedRequest *top_ = nullptr;
+        QueuedRequest *bottom_ = nullptr;
+    };
 
     // Need call Stop() as the threadloop will hold a strong pointer
     // itself and wait for Condition fired or timeout (60s) before
     // the out looper can call deconstructor to Stop() thread
     void Stop();
 
-    // Return true when successfully adds request from actions for the hint_type
-    // in each individual node. Return false if any of the actions has either
-    // invalid node index or value index.
+    // Validate and enqueue a request from actions for the hint_type; the
+    // looper applies it on its next wake, so callers never block on looper
+    // work. Return false if any of the actions has either invalid node index
+    // or value index. Action end times are anchored at the enqueue time.
     bool Request(const std::vector<NodeAction>& actions,
                  const std::string& hint_type);
-    // Return when successfully cancels request from actions for the hint_type
-    // in each individual node. Return false if any of the actions has invalid
-    // node index.
+    // Validate and enqueue a cancellation of the actions for the hint_type.
+    // Return false if any of the actions has invalid node index.
     bool Cancel(const std::vector<NodeAction>& actions,
                 const std::string& hint_type);
 
@@ -88,13 +122,60 @@ class NodeLooperThread : public ::android::Thread {
 
     static constexpr auto kMaxUpdatePeriod = std::chrono::milliseconds::max();
 
+    // A validated request or cancellation enqueued by a binder thread for the
+    // looper to apply. Linked through next on a lock-free intrusive stack;
+    // the looper steals the whole stack and replays it in arrival order.
+    // (Declared at the top of the class so RequestBatch can name it.)
+    struct QueuedRequest {
+        bool cancel;
+        std::vector<NodeAction> actions;
+        std::string hint_type;
+        // Enqueue time; action end times are computed from this so a busy
+        // looper does not shift boost expirations.
+        ReqTime req_time;
+        QueuedRequest* next = nullptr;
+    };
+
+    // Validate actions against the immutable node table and build the queued
+    // request; shared by Request/Cancel and RequestBatch. *valid reports the
+    // Request/Cancel return value; nullptr is returned when no action
+    // survived validation.
+    QueuedRequest* BuildRequest(const std::vector<NodeAction>& actions,
+                                const std::string& hint_type, bool cancel, bool* valid);
+    // Push onto the request stack and wake the looper; lock-free.
+    void Enqueue(QueuedRequest* req);
+    // Push a pre-linked chain (top through bottom) with one CAS and one wake.
+    void EnqueueChain(QueuedRequest* top, QueuedRequest* bottom);
+    // Steal the stack and apply all queued requests; caller must hold lock_.
+    void DrainRequestQueueLocked();
+    // Bump the eventfd counter to make poll() in the looper return.
+    void WakeLooper();
+
+    // Queue node_index for the next wake; caller must hold lock_.
+    void MarkDirtyLocked(std::size_t node_index) {
+        if (!dirty_flags_[node_index]) {
+            dirty_flags_[node_index] = true;
+            dirty_nodes_.push_back(node_index);
+        }
+    }
+
     std::vector<std::unique_ptr<Node>> nodes_;  // parsed from Config
 
-    // conditional variable from C++ standard library can be affected by wall
-    // time change as it is using CLOCK_REAL (b/35756266). The component should
-    // not be impacted by wall time, thus need use Android specific Condition
-    // class for waking up threadloop.
-    ::android::Condition wake_cond_;
+    // Dirty-set scheduling state, all guarded by lock_: Request/Cancel queue
+    // the touched node indices, and each node's earliest request expiry is
+    // recorded after its Update() so a wake only visits dirty or expired
+    // nodes instead of scanning the whole config.
+    std::vector<std::size_t> dirty_nodes_;
+    std::vector<bool> dirty_flags_;
+    std::vector<ReqTime> node_deadlines_;
+
+    // Incoming requests from binder threads; producers only touch this stack
+    // and the eventfd, never lock_, so they cannot contend with looper work.
+    std::atomic<QueuedRequest*> request_stack_{nullptr};
+    // The looper sleeps in poll() on this eventfd with a relative timeout, so
+    // wakeups are immune to wall time changes (b/35756266) and producers wake
+    // it with a single non-blocking write.
+    ::android::base::unique_fd wake_fd_;
 
     // lock to protect nodes_
     ::android::Mutex lock_;
@@ -35,11 +35,17 @@ class PropertyNode : public Node {
 
     std::chrono::milliseconds Update(bool log_error) override;
 
+    // SetProperty the value at value_index
+    bool WriteValue(std::size_t value_index, bool log_error) override;
+
     void DumpToFd(int fd) const override;
 
   private:
     PropertyNode(const Node& other) = delete;
     PropertyNode& operator=(Node const&) = delete;
+
+    // set off the looper through AsyncFileWriter
+    const bool async_write_;
 };
 
 }  // namespace perfmgr
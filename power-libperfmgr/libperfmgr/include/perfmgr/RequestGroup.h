@@ -18,9 +18,10 @@
 #define ANDROID_LIBPERFMGR_REQUESTGROUP_H_
 
 #include <chrono>
-#include <map>
+#include <cstddef>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace android {
 namespace perfmgr {
@@ -31,13 +32,16 @@ using ReqTime = std::chrono::time_point<std::chrono::steady_clock>;
 // particular sysfs node, and the interface is simple: there is a function to
 // add requests, a function to remove requests, and a function to check for the
 // next expiration time if there is an outstanding request, and a function to
-// check the requested value. There may only be one request per PowerHint, so
-// the representation is simple: a map from PowerHint to the expiration time for
-// that hint.
+// check the requested value. There may only be one request per PowerHint.
+// Requests live in a small slot vector rather than a map: removed slots are
+// tombstoned and reused by the next AddRequest, so boost hints that add and
+// remove requests every frame do not allocate in steady state.
 class RequestGroup {
   public:
     RequestGroup(const std::string &request_value)  // NOLINT(runtime/explicit)
-        : request_value_(request_value) {}
+        : request_value_(request_value) {
+        requests_.reserve(kInlineRequestSlots);
+    }
 
     // Remove expired request in the map and return true when request_map_ is
     // not empty, false when request_map_ is empty; also update expire_time with
@@ -57,8 +61,25 @@ class RequestGroup {
     void DumpToFd(int fd, const std::string& prefix) const;
 
   private:
+    // Slots reserved up front for the handful of hints that typically share
+    // one value on a node; the vector only grows past that if more hints are
+    // concurrently active than ever before.
+    static constexpr std::size_t kInlineRequestSlots = 4;
+
+    // A request slot for one hint type. Slots are tombstoned on removal and
+    // reused by the next AddRequest: the slot's string keeps its capacity
+    // across reuse, so the add/remove cycle on the per-frame boost path is
+    // allocation-free.
+    struct Request {
+        std::string hint_type;
+        ReqTime end_time;
+        bool active;
+    };
+
+    Request* FindActiveRequest(const std::string& hint_type);
+
     const std::string request_value_;
-    std::map<std::string, ReqTime> request_map_;
+    std::vector<Request> requests_;
 };
 
 }  // namespace perfmgr
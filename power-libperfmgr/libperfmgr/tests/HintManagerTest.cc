@@ -381,6 +381,84 @@ TEST_F(HintManagerTest, HintTest) {
     _VerifyPropertyValue(prop_, "n2_value2");
 }
 
+// Test hint/cancel via pre-resolved hint ids
+TEST_F(HintManagerTest, HintIdTest) {
+    auto hm = std::make_unique<HintManager>(nm_, actions_,
+                                            std::vector<std::shared_ptr<AdpfConfig>>());
+    EXPECT_TRUE(InitHintStatus(hm));
+    EXPECT_TRUE(hm->Start());
+    EXPECT_TRUE(hm->IsRunning());
+    int interaction_id = hm->GetHintId("INTERACTION");
+    int launch_id = hm->GetHintId("LAUNCH");
+    EXPECT_NE(HintManager::kInvalidHintId, interaction_id);
+    EXPECT_NE(HintManager::kInvalidHintId, launch_id);
+    EXPECT_NE(interaction_id, launch_id);
+    EXPECT_EQ(HintManager::kInvalidHintId, hm->GetHintId("NO_SUCH_HINT"));
+    EXPECT_FALSE(hm->DoHint(HintManager::kInvalidHintId));
+    EXPECT_TRUE(hm->DoHint(interaction_id));
+    std::this_thread::sleep_for(kSLEEP_TOLERANCE_MS);
+    _VerifyPathValue(files_[0]->path, "n0_value1");
+    _VerifyPathValue(files_[1]->path, "n1_value1");
+    _VerifyPropertyValue(prop_, "n2_value1");
+    EXPECT_TRUE(hm->DoHint(launch_id, 500ms));
+    std::this_thread::sleep_for(kSLEEP_TOLERANCE_MS);
+    _VerifyPathValue(files_[0]->path, "n0_value0");
+    _VerifyPathValue(files_[1]->path, "n1_value0");
+    _VerifyPropertyValue(prop_, "n2_value0");
+    EXPECT_TRUE(hm->EndHint(launch_id));
+    EXPECT_TRUE(hm->EndHint(interaction_id));
+    std::this_thread::sleep_for(kSLEEP_TOLERANCE_MS);
+    _VerifyPathValue(files_[0]->path, "n0_value2");
+    _VerifyPathValue(files_[1]->path, "n1_value2");
+    _VerifyPropertyValue(prop_, "n2_value2");
+}
+
+// Test grouping hint changes into one committed transaction
+TEST_F(HintManagerTest, HintTransactionTest) {
+    auto hm = std::make_unique<HintManager>(nm_, actions_,
+                                            std::vector<std::shared_ptr<AdpfConfig>>());
+    EXPECT_TRUE(InitHintStatus(hm));
+    EXPECT_TRUE(hm->Start());
+    EXPECT_TRUE(hm->IsRunning());
+    EXPECT_TRUE(hm->DoHint("INTERACTION"));
+    std::this_thread::sleep_for(kSLEEP_TOLERANCE_MS);
+    _VerifyPathValue(files_[0]->path, "n0_value1");
+    _VerifyPathValue(files_[1]->path, "n1_value1");
+    _VerifyPropertyValue(prop_, "n2_value1");
+    // Swap INTERACTION for LAUNCH in one commit; both land in the same
+    // looper pass.
+    EXPECT_TRUE(hm->BeginTransaction().EndHint("INTERACTION").DoHint("LAUNCH").Commit());
+    std::this_thread::sleep_for(kSLEEP_TOLERANCE_MS);
+    _VerifyPathValue(files_[0]->path, "n0_value0");
+    _VerifyPathValue(files_[1]->path, "n1_value0");
+    _VerifyPropertyValue(prop_, "n2_value0");
+    // Later ops win within a transaction, and the timeout override applies.
+    EXPECT_TRUE(hm->BeginTransaction()
+                        .EndHint("LAUNCH")
+                        .DoHint("INTERACTION", 200ms)
+                        .Commit());
+    std::this_thread::sleep_for(kSLEEP_TOLERANCE_MS);
+    _VerifyPathValue(files_[0]->path, "n0_value1");
+    _VerifyPathValue(files_[1]->path, "n1_value1");
+    _VerifyPropertyValue(prop_, "n2_value1");
+    // Overridden INTERACTION expired
+    std::this_thread::sleep_for(200ms + kSLEEP_TOLERANCE_MS);
+    _VerifyPathValue(files_[0]->path, "n0_value2");
+    _VerifyPathValue(files_[1]->path, "n1_value2");
+    _VerifyPropertyValue(prop_, "n2_value2");
+    // An unsupported hint fails the commit but the valid ops still apply
+    auto tx = hm->BeginTransaction();
+    tx.DoHint("NO_SUCH_HINT").DoHint("LAUNCH");
+    EXPECT_FALSE(tx.Commit());
+    std::this_thread::sleep_for(kSLEEP_TOLERANCE_MS);
+    _VerifyPathValue(files_[0]->path, "n0_value0");
+    _VerifyPathValue(files_[1]->path, "n1_value0");
+    _VerifyPropertyValue(prop_, "n2_value0");
+    // A transaction commits only once
+    EXPECT_FALSE(tx.Commit());
+    EXPECT_TRUE(hm->EndHint("LAUNCH"));
+}
+
 // Test collecting stats with simple actions
 TEST_F(HintManagerTest, HintStatsTest) {
     auto hm = std::make_unique<HintManager>(nm_, actions_,
@@ -16,11 +16,17 @@
 
 #include <aidl/android/hardware/power/IPower.h>
 #include <aidl/google/hardware/power/extension/pixel/IPowerExt.h>
+#include <android-base/file.h>
 #include <android-base/logging.h>
 #include <android/binder_manager.h>
 
 #include <getopt.h>
 
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
 using ::aidl::android::hardware::power::IPower;
 using ::aidl::google::hardware::power::extension::pixel::IPowerExt;
 
@@ -48,6 +54,16 @@ static void printUsage(const char *exec_name) {
             "       Boost for hint\n\n"
             "   --duration, -d\n"
             "       Boost duration\n\n"
+            "   --iterations, -n\n"
+            "       Benchmark mode: apply and clear the hint this many times and\n"
+            "       report round-trip latency percentiles\n\n"
+            "   --file, -f\n"
+            "       Sysfs path written by the hint; may be repeated. In benchmark\n"
+            "       mode each iteration waits until every path changed from its\n"
+            "       resting content before the latency sample is taken\n\n"
+            "   --timeout, -t\n"
+            "       Benchmark mode: per-iteration confirmation timeout in ms\n"
+            "       (default 1000)\n\n"
             "   --help, -h\n"
             "       print this message\n\n";
 
@@ -100,23 +116,159 @@ static bool setBoost(std::shared_ptr<IPowerExt> hal, const std::string &type,
     }
 }
 
+static bool readFiles(const std::vector<std::string> &paths, std::vector<std::string> *contents) {
+    contents->clear();
+    for (const auto &path : paths) {
+        std::string s;
+        if (!android::base::ReadFileToString(path, &s)) {
+            LOG(ERROR) << "Cannot read node path: " << path;
+            return false;
+        }
+        contents->push_back(s);
+    }
+    return true;
+}
+
+// Poll the node paths until every one differs from (or, on clear, matches
+// again) its resting content, so the sample covers the full pipeline: binder
+// call, looper wake and the sysfs write landing.
+static bool waitForNodes(const std::vector<std::string> &paths,
+                         const std::vector<std::string> &resting, bool expect_resting,
+                         int32_t timeout_ms) {
+    const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    std::vector<std::string> contents;
+    while (true) {
+        if (!readFiles(paths, &contents)) {
+            return false;
+        }
+        bool settled = true;
+        for (size_t i = 0; i < paths.size(); i++) {
+            if ((contents[i] == resting[i]) != expect_resting) {
+                settled = false;
+                break;
+            }
+        }
+        if (settled) {
+            return true;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+static int64_t percentileUs(const std::vector<int64_t> &sorted_us, int percent) {
+    size_t index = sorted_us.size() * percent / 100;
+    if (index >= sorted_us.size()) {
+        index = sorted_us.size() - 1;
+    }
+    return sorted_us[index];
+}
+
+static void reportLatency(const std::string &label, std::vector<int64_t> *samples_us) {
+    if (samples_us->empty()) {
+        LOG(INFO) << label << ": no confirmed samples";
+        return;
+    }
+    std::sort(samples_us->begin(), samples_us->end());
+    int64_t sum = 0;
+    for (auto s : *samples_us) {
+        sum += s;
+    }
+    LOG(INFO) << label << ": samples: " << samples_us->size()
+              << " min: " << samples_us->front() << "us avg: " << sum / samples_us->size()
+              << "us p50: " << percentileUs(*samples_us, 50)
+              << "us p90: " << percentileUs(*samples_us, 90)
+              << "us p99: " << percentileUs(*samples_us, 99)
+              << "us max: " << samples_us->back() << "us";
+}
+
+// Benchmark mode: round-trip the hint iterations times. A boost is applied
+// with duration 0 (forever) and cleared with a negative duration; a mode is
+// toggled on and off. Each direction is confirmed against the node paths
+// before its latency is recorded, so an unconfirmed iteration counts as a
+// timeout rather than polluting the percentiles.
+static int runBenchmark(std::shared_ptr<IPowerExt> hal, const std::string &boost,
+                        const std::string &mode, int32_t iterations,
+                        const std::vector<std::string> &paths, int32_t timeout_ms) {
+    const std::string hint = boost.empty() ? mode : boost;
+    std::vector<std::string> resting;
+    if (!readFiles(paths, &resting)) {
+        return 1;
+    }
+
+    std::vector<int64_t> apply_us;
+    std::vector<int64_t> clear_us;
+    apply_us.reserve(iterations);
+    clear_us.reserve(iterations);
+    int32_t apply_timeouts = 0;
+    int32_t clear_timeouts = 0;
+
+    for (int32_t i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        bool sent = boost.empty() ? hal->setMode(hint, true).isOk()
+                                  : hal->setBoost(hint, 0).isOk();
+        if (!sent) {
+            LOG(ERROR) << "Fail to apply hint: " << hint << " at iteration: " << i;
+            return 1;
+        }
+        if (waitForNodes(paths, resting, false /* expect_resting */, timeout_ms)) {
+            apply_us.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                                       std::chrono::steady_clock::now() - start)
+                                       .count());
+        } else {
+            apply_timeouts++;
+        }
+
+        start = std::chrono::steady_clock::now();
+        sent = boost.empty() ? hal->setMode(hint, false).isOk()
+                             : hal->setBoost(hint, -1).isOk();
+        if (!sent) {
+            LOG(ERROR) << "Fail to clear hint: " << hint << " at iteration: " << i;
+            return 1;
+        }
+        if (waitForNodes(paths, resting, true /* expect_resting */, timeout_ms)) {
+            clear_us.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                                       std::chrono::steady_clock::now() - start)
+                                       .count());
+        } else {
+            clear_timeouts++;
+        }
+    }
+
+    LOG(INFO) << "Benchmark of hint: " << hint << " iterations: " << iterations
+              << " nodes: " << paths.size() << " apply timeouts: " << apply_timeouts
+              << " clear timeouts: " << clear_timeouts;
+    reportLatency("apply", &apply_us);
+    reportLatency("clear", &clear_us);
+    return (apply_timeouts || clear_timeouts) ? 1 : 0;
+}
+
 int main(int argc, char *argv[]) {
     android::base::SetLogger(DualLogger);
     std::string boost;
     unsigned int duration_ms = 0;
     std::string mode;
     bool enabled = true;
+    int32_t iterations = 0;
+    int32_t timeout_ms = 1000;
+    std::vector<std::string> node_paths;
 
     static struct option opts[] = {
             {"boost", optional_argument, nullptr, 'b'},
             {"duration", optional_argument, nullptr, 'd'},
             {"mode", optional_argument, nullptr, 'm'},
             {"enable", optional_argument, nullptr, 'e'},
+            {"iterations", optional_argument, nullptr, 'n'},
+            {"file", optional_argument, nullptr, 'f'},
+            {"timeout", optional_argument, nullptr, 't'},
             {0, 0, 0, 0}  // termination of the option list
     };
 
     int c = -1;
-    while ((c = getopt_long(argc, argv, "b:d:m:e:h", opts, nullptr)) != -1) {
+    while ((c = getopt_long(argc, argv, "b:d:m:e:n:f:t:h", opts, nullptr)) != -1) {
         switch (c) {
             case 'b':
                 boost = optarg;
@@ -130,6 +282,15 @@ int main(int argc, char *argv[]) {
             case 'e':
                 enabled = std::stoi(optarg);
                 break;
+            case 'n':
+                iterations = std::stoi(optarg);
+                break;
+            case 'f':
+                node_paths.push_back(optarg);
+                break;
+            case 't':
+                timeout_ms = std::stoi(optarg);
+                break;
             case 'h':
                 printUsage(argv[0]);
                 return 0;
@@ -149,6 +310,24 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
+    if (iterations > 0) {
+        if (!boost.empty() && !mode.empty()) {
+            LOG(ERROR) << "Benchmark mode takes a single boost or mode";
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (node_paths.empty()) {
+            LOG(ERROR) << "Benchmark mode needs at least one node path (--file)";
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (timeout_ms < 1) {
+            LOG(ERROR) << "Invalid confirmation timeout: " << timeout_ms;
+            return 1;
+        }
+        return runBenchmark(powerext, boost, mode, iterations, node_paths, timeout_ms);
+    }
+
     if (!boost.empty() && !setBoost(powerext, boost, duration_ms)) {
         return 1;
     }
@@ -15,7 +15,13 @@
  */
 
 #include "PowerShare.h"
+#include <cutils/uevent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
 #include <fstream>
+#include <mutex>
 
 #define WLC_DEV_DIR "/sys/class/power_supply/wireless/device"
 #define RTX_ENABLE_PATH WLC_DEV_DIR "/rtx"
@@ -40,12 +46,61 @@ static T get(const std::string& path, const T& def) {
 
 namespace vendor::lineage::powershare::pixel {
 
+PowerShare::PowerShare() {
+    mUeventFd.reset(uevent_open_socket(64 * 1024, true));
+    if (mUeventFd.ok()) {
+        fcntl(mUeventFd, F_SETFL, O_NONBLOCK);
+    }
+}
+
+/*
+ * Drain pending uevents and mark the cached state stale if the power_supply
+ * subsystem reported a change (the wireless driver sysfs_notify()s through
+ * it). A receive overflow also marks the cache stale, since events may have
+ * been dropped.
+ */
+void PowerShare::pollUevents() {
+    char msg[1024];
+
+    for (;;) {
+        ssize_t n = uevent_kernel_multicast_recv(mUeventFd, msg, sizeof(msg) - 1);
+        if (n <= 0) {
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                mStale = true;
+            }
+            return;
+        }
+        msg[n] = '\0';
+
+        for (char *cp = msg; cp < msg + n;) {
+            if (strcmp(cp, "SUBSYSTEM=power_supply") == 0) {
+                mStale = true;
+                break;
+            }
+            cp += strlen(cp) + 1;
+        }
+    }
+}
+
 Return<bool> PowerShare::isEnabled() {
-    return get(RTX_ENABLE_PATH, 0) == 1;
+    std::lock_guard lock(mLock);
+    if (mUeventFd.ok()) {
+        pollUevents();
+        if (!mStale) {
+            return mEnabled;
+        }
+    }
+    mEnabled = get(RTX_ENABLE_PATH, 0) == 1;
+    mStale = false;
+    return mEnabled;
 }
 
 Return<bool> PowerShare::setEnabled(bool enable) {
-    set(RTX_ENABLE_PATH, enable ? 1 : 0);
+    {
+        std::lock_guard lock(mLock);
+        set(RTX_ENABLE_PATH, enable ? 1 : 0);
+        mStale = true;
+    }
     return isEnabled();
 }
 
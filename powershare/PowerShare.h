@@ -17,9 +17,12 @@
 #pragma once
 
 #include <vendor/lineage/powershare/1.0/IPowerShare.h>
+#include <android-base/unique_fd.h>
 #include <hidl/MQDescriptor.h>
 #include <hidl/Status.h>
 
+#include <mutex>
+
 namespace vendor::lineage::powershare::pixel {
 
 using ::android::hardware::hidl_array;
@@ -31,11 +34,25 @@ using ::android::hardware::Void;
 using ::android::sp;
 
 struct PowerShare : public V1_0::IPowerShare {
+    PowerShare();
+
     // Methods from ::vendor::lineage::powershare::V1_0::IPowerShare follow.
     Return<bool> isEnabled() override;
     Return<bool> setEnabled(bool enable) override;
     Return<uint32_t> getMinBattery() override;
     Return<uint32_t> setMinBattery(uint32_t minBattery) override;
+
+  private:
+    // Cached rtx state, invalidated by power_supply uevents. SystemUI polls
+    // isEnabled() while the tile is visible; with the uevent socket open the
+    // poll costs a non-blocking recv instead of a sysfs read, and the node is
+    // re-read only after the driver actually signals a change.
+    void pollUevents();
+
+    std::mutex mLock;
+    ::android::base::unique_fd mUeventFd;
+    bool mStale = true;
+    bool mEnabled = false;
 };
 
 }  // namespace vendor::lineage::powershare::pixel
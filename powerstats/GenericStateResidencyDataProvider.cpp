@@ -17,9 +17,7 @@
 #define LOG_TAG "libpixelpowerstats"
 
 #include <android-base/logging.h>
-#include <android-base/strings.h>
 #include <pixelpowerstats/GenericStateResidencyDataProvider.h>
-#include <pixelpowerstats/PowerStatsUtils.h>
 
 #include <cstdio>
 #include <cstring>
@@ -65,84 +63,36 @@ PowerEntityConfig::PowerEntityConfig(const uint32_t start_id, const std::string
     }
 }
 
-static bool parseState(PowerEntityStateResidencyData *data, const StateResidencyConfig &config,
-                       FILE *fp, char **line, size_t *len) {
-    size_t numFieldsRead = 0;
-    const size_t numFields =
-            config.entryCountSupported + config.totalTimeSupported + config.lastEntrySupported;
+void GenericStateResidencyDataProvider::compileMatchers() {
+    mEntityMatcher = HeaderMatcher();
+    mStateMatchers.assign(mPowerEntityConfigs.size(), HeaderMatcher());
+    for (size_t i = 0; i < mPowerEntityConfigs.size(); ++i) {
+        mEntityMatcher.add(mPowerEntityConfigs[i].second.mHeader, i);
 
-    while ((numFieldsRead < numFields) && (getline(line, len, fp) != -1)) {
-        uint64_t stat = 0;
-        // Attempt to extract data from the current line
-        if (config.entryCountSupported &&
-            utils::extractStat(*line, config.entryCountPrefix, stat)) {
-            data->totalStateEntryCount =
-                    config.entryCountTransform ? config.entryCountTransform(stat) : stat;
-            ++numFieldsRead;
-        } else if (config.totalTimeSupported &&
-                   utils::extractStat(*line, config.totalTimePrefix, stat)) {
-            data->totalTimeInStateMs =
-                    config.totalTimeTransform ? config.totalTimeTransform(stat) : stat;
-            ++numFieldsRead;
-        } else if (config.lastEntrySupported &&
-                   utils::extractStat(*line, config.lastEntryPrefix, stat)) {
-            data->lastEntryTimestampMs =
-                    config.lastEntryTransform ? config.lastEntryTransform(stat) : stat;
-            ++numFieldsRead;
+        const auto &stateConfigs = mPowerEntityConfigs[i].second.mStateResidencyConfigs;
+        for (size_t j = 0; j < stateConfigs.size(); ++j) {
+            mStateMatchers[i].add(stateConfigs[j].second.header, j);
         }
     }
-
-    // End of file was reached and not all state data was parsed. Something
-    // went wrong
-    if (numFieldsRead != numFields) {
-        LOG(ERROR) << __func__ << ": failed to parse stats for:" << config.name;
-        return false;
-    }
-
-    return true;
+    mMatchersCompiled = true;
 }
 
-template <class T, class Func>
-static auto findNext(const std::vector<T> &collection, FILE *fp, char **line, size_t *len,
-                     Func pred) {
-    // handling the case when there is no header to look for
-    if (pred(collection.front(), "")) {
-        return collection.cbegin();
-    }
-
-    while (getline(line, len, fp) != -1) {
-        for (auto it = collection.cbegin(); it != collection.cend(); ++it) {
-            if (pred(*it, *line)) {
-                return it;
-            }
-        }
-    }
-
-    return collection.cend();
-}
-
-static bool getStateData(
+bool GenericStateResidencyDataProvider::getStateData(
         PowerEntityStateResidencyResult *result,
-        const std::vector<std::pair<uint32_t, StateResidencyConfig>> &stateResidencyConfigs,
-        FILE *fp, char **line, size_t *len) {
+        const std::vector<std::pair<uint32_t, StateResidencyConfig>> &configs,
+        const HeaderMatcher &matcher, FILE *fp, char **line, size_t *len) const {
     size_t numStatesRead = 0;
-    size_t numStates = stateResidencyConfigs.size();
-    auto nextState = stateResidencyConfigs.cbegin();
-    auto endState = stateResidencyConfigs.cend();
-    auto pred = [](auto a, char const *b) {
-        // return true if b matches the header contained in a, ignoring whitespace
-        return (a.second.header == android::base::Trim(b));
-    };
+    size_t numStates = configs.size();
+    int32_t nextState = -1;
 
     result->stateResidencyData.resize(numStates);
 
     // Search for state headers until we have found them all or can't find anymore
     while ((numStatesRead < numStates) &&
-           (nextState = findNext<std::pair<uint32_t, StateResidencyConfig>>(
-                    stateResidencyConfigs, fp, line, len, pred)) != endState) {
+           (nextState = parser::findNextIndex(matcher, fp, line, len)) >= 0) {
         // Found a matching state header. Parse the contents
-        PowerEntityStateResidencyData data = {.powerEntityStateId = nextState->first};
-        if (parseState(&data, nextState->second, fp, line, len)) {
+        PowerEntityStateResidencyData data = {.powerEntityStateId = configs[nextState].first};
+        if (parser::parseState(&data, configs[nextState].second, fp, line, len)) {
             result->stateResidencyData[numStatesRead] = data;
             ++numStatesRead;
         } else {
@@ -160,6 +110,10 @@ static bool getStateData(
 
 bool GenericStateResidencyDataProvider::getResults(
         std::unordered_map<uint32_t, PowerEntityStateResidencyResult> &results) {
+    if (!mMatchersCompiled) {
+        compileMatchers();
+    }
+
     // Using FILE* instead of std::ifstream for performance reasons (b/122253123)
     std::unique_ptr<FILE, decltype(&fclose)> fp(fopen(mPath.c_str(), "r"), fclose);
     if (!fp) {
@@ -172,35 +126,38 @@ bool GenericStateResidencyDataProvider::getResults(
     char *line = nullptr;
     size_t numEntitiesRead = 0;
     size_t numEntities = mPowerEntityConfigs.size();
-    auto nextConfig = mPowerEntityConfigs.cbegin();
-    auto endConfig = mPowerEntityConfigs.cend();
-    auto pred = [](auto a, char const *b) {
-        // return true if b matches the header contained in a, ignoring whitespace
-        return (a.second.mHeader == android::base::Trim(b));
-    };
+    int32_t nextConfig = -1;
     bool skipFindNext = false;
 
     // Search for entity headers until we have found them all or can't find anymore
-    while ((numEntitiesRead < numEntities) &&
-           (skipFindNext ||
-            (nextConfig = findNext<decltype(mPowerEntityConfigs)::value_type>(
-                     mPowerEntityConfigs, fp.get(), &line, &len, pred)) != endConfig)) {
+    while (numEntitiesRead < numEntities) {
+        if (skipFindNext) {
+            // Same header as the previous config; its states follow directly.
+            ++nextConfig;
+        } else {
+            nextConfig = parser::findNextIndex(mEntityMatcher, fp.get(), &line, &len);
+            if (nextConfig < 0) {
+                break;
+            }
+        }
+
         // Found a matching header. Retrieve its state data
-        PowerEntityStateResidencyResult result = {.powerEntityId = nextConfig->first};
-        if (getStateData(&result, nextConfig->second.mStateResidencyConfigs, fp.get(), &line,
-                         &len)) {
+        const auto &config = mPowerEntityConfigs[nextConfig];
+        PowerEntityStateResidencyResult result = {.powerEntityId = config.first};
+        if (getStateData(&result, config.second.mStateResidencyConfigs, mStateMatchers[nextConfig],
+                         fp.get(), &line, &len)) {
             // If a power entity already exists, then merge in the
             // StateResidencyData.
-            if (results.find(nextConfig->first) != results.end()) {
-                uint32_t size = results[nextConfig->first].stateResidencyData.size();
-                results[nextConfig->first].stateResidencyData.resize(
-                        size + result.stateResidencyData.size());
+            if (results.find(config.first) != results.end()) {
+                uint32_t size = results[config.first].stateResidencyData.size();
+                results[config.first].stateResidencyData.resize(size +
+                                                                result.stateResidencyData.size());
                 for (uint32_t i = 0; i < result.stateResidencyData.size(); i++) {
-                    results[nextConfig->first].stateResidencyData[size + i] =
+                    results[config.first].stateResidencyData[size + i] =
                             result.stateResidencyData[i];
                 }
             } else {
-                results.emplace(nextConfig->first, result);
+                results.emplace(config.first, result);
             }
             ++numEntitiesRead;
         } else {
@@ -210,12 +167,8 @@ bool GenericStateResidencyDataProvider::getResults(
         // If the header of the next PowerEntityConfig is equal to the
         // current, don't search for it within the file since we'll be search
         // for more states.
-        auto currConfig = nextConfig++;
-        if (nextConfig != endConfig && nextConfig->second.mHeader == currConfig->second.mHeader) {
-            skipFindNext = true;
-        } else {
-            skipFindNext = false;
-        }
+        skipFindNext = (static_cast<size_t>(nextConfig) + 1 < numEntities) &&
+                       mPowerEntityConfigs[nextConfig + 1].second.mHeader == config.second.mHeader;
     }
 
     free(line);
@@ -231,6 +184,8 @@ bool GenericStateResidencyDataProvider::getResults(
 
 void GenericStateResidencyDataProvider::addEntity(uint32_t id, const PowerEntityConfig &config) {
     mPowerEntityConfigs.emplace_back(id, config);
+    // Header pointers into the grown vector must be re-taken.
+    mMatchersCompiled = false;
 }
 
 std::vector<PowerEntityStateSpace> GenericStateResidencyDataProvider::getStateSpaces() {
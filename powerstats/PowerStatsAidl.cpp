@@ -24,9 +24,13 @@
 #include <android-base/strings.h>
 
 #include <inttypes.h>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <numeric>
 #include <string>
+#include <string_view>
+#include <thread>
 
 namespace aidl {
 namespace android {
@@ -44,6 +48,7 @@ void PowerStats::addStateResidencyDataProvider(std::unique_ptr<IStateResidencyDa
 
     size_t index = mStateResidencyDataProviders.size();
     mStateResidencyDataProviders.emplace_back(std::move(p));
+    mResidencyCaches.emplace_back(std::make_unique<ResidencyCache>());
 
     for (const auto &[entityName, states] : info) {
         PowerEntity i = {
@@ -61,8 +66,81 @@ ndk::ScopedAStatus PowerStats::getPowerEntityInfo(std::vector<PowerEntity> *_aid
     return ndk::ScopedAStatus::ok();
 }
 
+/* Fan-out width for provider reads; each provider does its own sysfs/RPC I/O */
+static constexpr size_t kMaxConcurrentProviders = 4;
+
+/*
+ * Freshness window for cached provider results. batterystats, pwrstats_util
+ * and vendor debug tools often query within the same second; repeats inside
+ * the window are served from memory instead of re-reading sysfs.
+ */
+static constexpr std::chrono::milliseconds kResidencyCacheTtl{500};
+
+void PowerStats::readProviderResidencies(
+        size_t providerIndex, bool forceRefresh,
+        std::unordered_map<std::string, std::vector<StateResidency>> *stateResidencies) {
+    ResidencyCache *cache = mResidencyCaches.at(providerIndex).get();
+
+    /* The lock is held across the provider read: concurrent queries for the
+     * same provider wait here and then serve the freshly stamped result */
+    std::scoped_lock lock(cache->lock);
+
+    if (!forceRefresh && cache->valid &&
+        (std::chrono::steady_clock::now() - cache->lastUpdate) < kResidencyCacheTtl) {
+        *stateResidencies = cache->residencies;
+        return;
+    }
+
+    cache->residencies.clear();
+    /* A failed read is not cached; the next query retries the provider */
+    cache->valid =
+            mStateResidencyDataProviders.at(providerIndex)->getStateResidencies(&cache->residencies);
+    cache->lastUpdate = std::chrono::steady_clock::now();
+    *stateResidencies = cache->residencies;
+}
+
+void PowerStats::getStateResidenciesConcurrently(
+        const std::vector<size_t> &providerIndexes, bool forceRefresh,
+        std::unordered_map<std::string, std::vector<StateResidency>> *stateResidencies) {
+    // Each provider fills its own map, so no locking is needed until the merge
+    std::vector<std::unordered_map<std::string, std::vector<StateResidency>>> results(
+            providerIndexes.size());
+    std::atomic<size_t> nextWork{0};
+
+    auto worker = [&]() {
+        while (true) {
+            size_t i = nextWork.fetch_add(1, std::memory_order_relaxed);
+            if (i >= providerIndexes.size()) {
+                return;
+            }
+            readProviderResidencies(providerIndexes[i], forceRefresh, &results[i]);
+        }
+    };
+
+    // The calling thread works too, so the single-provider case stays inline
+    size_t threadCount = std::min(kMaxConcurrentProviders, providerIndexes.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (auto &result : results) {
+        stateResidencies->merge(result);
+    }
+}
+
 ndk::ScopedAStatus PowerStats::getStateResidency(const std::vector<int32_t> &in_powerEntityIds,
                                                  std::vector<StateResidencyResult> *_aidl_return) {
+    return getStateResidencyInternal(in_powerEntityIds, _aidl_return, false /* forceRefresh */);
+}
+
+ndk::ScopedAStatus PowerStats::getStateResidencyInternal(
+        const std::vector<int32_t> &in_powerEntityIds,
+        std::vector<StateResidencyResult> *_aidl_return, bool forceRefresh) {
     if (mPowerEntityInfos.empty()) {
         return ndk::ScopedAStatus::ok();
     }
@@ -71,25 +149,32 @@ ndk::ScopedAStatus PowerStats::getStateResidency(const std::vector<int32_t> &in_
     if (in_powerEntityIds.empty()) {
         std::vector<int32_t> v(mPowerEntityInfos.size());
         std::iota(std::begin(v), std::end(v), 0);
-        return getStateResidency(v, _aidl_return);
+        return getStateResidencyInternal(v, _aidl_return, forceRefresh);
     }
 
-    std::unordered_map<std::string, std::vector<StateResidency>> stateResidencies;
-
+    // Collect the set of providers to query, validating ids up front
+    std::vector<size_t> providerIndexes;
     for (const int32_t id : in_powerEntityIds) {
         // check for invalid ids
         if (id < 0 || id >= mPowerEntityInfos.size()) {
             return ndk::ScopedAStatus(AStatus_fromExceptionCode(EX_ILLEGAL_ARGUMENT));
         }
 
-        // Check to see if we already have data for the given id
-        std::string powerEntityName = mPowerEntityInfos[id].name;
-        if (stateResidencies.find(powerEntityName) == stateResidencies.end()) {
-            mStateResidencyDataProviders.at(mStateResidencyDataProviderIndex.at(id))
-                    ->getStateResidencies(&stateResidencies);
+        size_t index = mStateResidencyDataProviderIndex.at(id);
+        if (std::find(providerIndexes.begin(), providerIndexes.end(), index) ==
+            providerIndexes.end()) {
+            providerIndexes.emplace_back(index);
         }
+    }
+
+    // Query the providers concurrently; the call costs the slowest provider
+    // rather than the sum of all of them
+    std::unordered_map<std::string, std::vector<StateResidency>> stateResidencies;
+    getStateResidenciesConcurrently(providerIndexes, forceRefresh, &stateResidencies);
 
+    for (const int32_t id : in_powerEntityIds) {
         // Append results if we have them
+        std::string powerEntityName = mPowerEntityInfos[id].name;
         auto stateResidency = stateResidencies.find(powerEntityName);
         if (stateResidency != stateResidencies.end()) {
             StateResidencyResult res = {
@@ -203,7 +288,43 @@ void PowerStats::getChannelNames(std::unordered_map<int32_t, std::string> *chann
     }
 }
 
-void PowerStats::dumpEnergyMeter(std::ostringstream &oss, bool delta) {
+namespace {
+
+/*
+ * Bounded dump writer: accumulates formatted lines and flushes them to the fd
+ * whenever the scratch string crosses a fixed watermark, so a report streams
+ * section by section and its working memory stays a few KB regardless of the
+ * rail and entity counts.
+ */
+class DumpStream {
+  public:
+    explicit DumpStream(int fd) : mFd(fd) { mBuf.reserve(kFlushWatermark + 512); }
+    ~DumpStream() { flush(); }
+
+    void append(std::string_view text) {
+        mBuf.append(text.data(), text.size());
+        if (mBuf.size() >= kFlushWatermark) {
+            flush();
+        }
+    }
+
+    void flush() {
+        if (!mBuf.empty()) {
+            ::android::base::WriteStringToFd(mBuf, mFd);
+            mBuf.clear();
+        }
+    }
+
+  private:
+    static constexpr size_t kFlushWatermark = 4096;
+
+    int mFd;
+    std::string mBuf;
+};
+
+}  // namespace
+
+void PowerStats::dumpEnergyMeter(int fd, bool delta) {
     const char *headerFormat = "  %32s   %18s\n";
     const char *dataFormat = "  %32s   %14.2f mWs\n";
     const char *headerFormatDelta = "  %32s   %18s (%14s)\n";
@@ -212,7 +333,8 @@ void PowerStats::dumpEnergyMeter(std::ostringstream &oss, bool delta) {
     std::unordered_map<int32_t, std::string> channelNames;
     getChannelNames(&channelNames);
 
-    oss << "\n============= PowerStats HAL 2.0 energy meter ==============\n";
+    DumpStream ds(fd);
+    ds.append("\n============= PowerStats HAL 2.0 energy meter ==============\n");
 
     std::vector<EnergyMeasurement> energyData;
     readEnergyMeter({}, &energyData);
@@ -222,12 +344,14 @@ void PowerStats::dumpEnergyMeter(std::ostringstream &oss, bool delta) {
         ::android::base::boot_clock::time_point curTime = ::android::base::boot_clock::now();
         static ::android::base::boot_clock::time_point prevTime = curTime;
 
-        oss << "Elapsed time: "
-            << std::chrono::duration_cast<std::chrono::milliseconds>(curTime - prevTime).count()
-            << " ms\n";
+        ds.append(::android::base::StringPrintf(
+                "Elapsed time: %" PRId64 " ms\n",
+                static_cast<int64_t>(
+                        std::chrono::duration_cast<std::chrono::milliseconds>(curTime - prevTime)
+                                .count())));
 
-        oss << ::android::base::StringPrintf(headerFormatDelta, "Channel", "Cumulative Energy",
-                                             "Delta   ");
+        ds.append(::android::base::StringPrintf(headerFormatDelta, "Channel", "Cumulative Energy",
+                                                "Delta   "));
 
         std::unordered_map<int32_t, int64_t> prevEnergyDataMap;
         for (const auto &data : prevEnergyData) {
@@ -241,26 +365,27 @@ void PowerStats::dumpEnergyMeter(std::ostringstream &oss, bool delta) {
                 deltaEnergy = data.energyUWs - prevEnergyDataIt->second;
             }
 
-            oss << ::android::base::StringPrintf(dataFormatDelta, channelNames.at(data.id).c_str(),
-                                                 static_cast<float>(data.energyUWs) / 1000.0,
-                                                 static_cast<float>(deltaEnergy) / 1000.0);
+            ds.append(::android::base::StringPrintf(dataFormatDelta,
+                                                    channelNames.at(data.id).c_str(),
+                                                    static_cast<float>(data.energyUWs) / 1000.0,
+                                                    static_cast<float>(deltaEnergy) / 1000.0));
         }
 
         prevEnergyData = energyData;
         prevTime = curTime;
     } else {
-        oss << ::android::base::StringPrintf(headerFormat, "Channel", "Cumulative Energy");
+        ds.append(::android::base::StringPrintf(headerFormat, "Channel", "Cumulative Energy"));
 
         for (const auto &data : energyData) {
-            oss << ::android::base::StringPrintf(dataFormat, channelNames.at(data.id).c_str(),
-                                                 static_cast<float>(data.energyUWs) / 1000.0);
+            ds.append(::android::base::StringPrintf(dataFormat, channelNames.at(data.id).c_str(),
+                                                    static_cast<float>(data.energyUWs) / 1000.0));
         }
     }
 
-    oss << "========== End of PowerStats HAL 2.0 energy meter ==========\n";
+    ds.append("========== End of PowerStats HAL 2.0 energy meter ==========\n");
 }
 
-void PowerStats::dumpStateResidency(std::ostringstream &oss, bool delta) {
+void PowerStats::dumpStateResidency(int fd, bool delta) {
     const char *headerFormat = "  %16s   %18s   %16s   %15s   %17s\n";
     const char *dataFormat =
             "  %16s   %18s   %13" PRIu64 " ms   %15" PRIu64 "   %14" PRIu64 " ms\n";
@@ -273,23 +398,27 @@ void PowerStats::dumpStateResidency(std::ostringstream &oss, bool delta) {
     std::unordered_map<int32_t, std::unordered_map<int32_t, std::string>> stateNames;
     getEntityStateNames(&entityNames, &stateNames);
 
-    oss << "\n============= PowerStats HAL 2.0 state residencies ==============\n";
+    DumpStream ds(fd);
+    ds.append("\n============= PowerStats HAL 2.0 state residencies ==============\n");
 
+    // Debug dumps want ground truth, not a cache hit
     std::vector<StateResidencyResult> results;
-    getStateResidency({}, &results);
+    getStateResidencyInternal({}, &results, true /* forceRefresh */);
 
     if (delta) {
         static std::vector<StateResidencyResult> prevResults;
         ::android::base::boot_clock::time_point curTime = ::android::base::boot_clock::now();
         static ::android::base::boot_clock::time_point prevTime = curTime;
 
-        oss << "Elapsed time: "
-            << std::chrono::duration_cast<std::chrono::milliseconds>(curTime - prevTime).count()
-            << " ms\n";
+        ds.append(::android::base::StringPrintf(
+                "Elapsed time: %" PRId64 " ms\n",
+                static_cast<int64_t>(
+                        std::chrono::duration_cast<std::chrono::milliseconds>(curTime - prevTime)
+                                .count())));
 
-        oss << ::android::base::StringPrintf(headerFormatDelta, "Entity", "State", "Total time",
-                                             "Delta   ", "Total entries", "Delta   ",
-                                             "Last entry tstamp", "Delta ");
+        ds.append(::android::base::StringPrintf(headerFormatDelta, "Entity", "State", "Total time",
+                                                "Delta   ", "Total entries", "Delta   ",
+                                                "Last entry tstamp", "Delta "));
 
         // Process prevResults into a 2-tier lookup table for easy reference
         std::unordered_map<int32_t, std::unordered_map<int32_t, StateResidency>> prevResultsMap;
@@ -330,67 +459,197 @@ void PowerStats::dumpStateResidency(std::ostringstream &oss, bool delta) {
                     }
                 }
 
-                oss << ::android::base::StringPrintf(
+                ds.append(::android::base::StringPrintf(
                         dataFormatDelta, entityName, stateName, stateResidency.totalTimeInStateMs,
                         deltaTotalTime, stateResidency.totalStateEntryCount, deltaTotalCount,
-                        stateResidency.lastEntryTimestampMs, deltaTimestamp);
+                        stateResidency.lastEntryTimestampMs, deltaTimestamp));
             }
         }
 
         prevResults = results;
         prevTime = curTime;
     } else {
-        oss << ::android::base::StringPrintf(headerFormat, "Entity", "State", "Total time",
-                                             "Total entries", "Last entry tstamp");
+        ds.append(::android::base::StringPrintf(headerFormat, "Entity", "State", "Total time",
+                                                "Total entries", "Last entry tstamp"));
         for (const auto &result : results) {
             for (const auto &stateResidency : result.stateResidencyData) {
-                oss << ::android::base::StringPrintf(
+                ds.append(::android::base::StringPrintf(
                         dataFormat, entityNames.at(result.id).c_str(),
                         stateNames.at(result.id).at(stateResidency.id).c_str(),
                         stateResidency.totalTimeInStateMs, stateResidency.totalStateEntryCount,
-                        stateResidency.lastEntryTimestampMs);
+                        stateResidency.lastEntryTimestampMs));
             }
         }
     }
 
-    oss << "========== End of PowerStats HAL 2.0 state residencies ==========\n";
+    ds.append("========== End of PowerStats HAL 2.0 state residencies ==========\n");
 }
 
-void PowerStats::dumpEnergyConsumer(std::ostringstream &oss, bool delta) {
+void PowerStats::dumpEnergyConsumer(int fd, bool delta) {
     (void)delta;
 
     std::vector<EnergyConsumerResult> results;
     getEnergyConsumed({}, &results);
 
-    oss << "\n============= PowerStats HAL 2.0 energy consumers ==============\n";
+    DumpStream ds(fd);
+    ds.append("\n============= PowerStats HAL 2.0 energy consumers ==============\n");
 
     for (const auto &result : results) {
-        oss << ::android::base::StringPrintf("%-12s : %14.2f mWs\n",
-                                             mEnergyConsumers[result.id]->getConsumerName().c_str(),
-                                             static_cast<float>(result.energyUWs) / 1000.0);
+        ds.append(::android::base::StringPrintf(
+                "%-12s : %14.2f mWs\n", mEnergyConsumers[result.id]->getConsumerName().c_str(),
+                static_cast<float>(result.energyUWs) / 1000.0));
         for (auto &attr : result.attribution) {
-            oss << ::android::base::StringPrintf("  %10d - %14.2f mWs\n", attr.uid,
-                                                 static_cast<float>(attr.energyUWs) / 1000.0);
+            ds.append(::android::base::StringPrintf("  %10d - %14.2f mWs\n", attr.uid,
+                                                    static_cast<float>(attr.energyUWs) / 1000.0));
         }
     }
 
-    oss << "========== End of PowerStats HAL 2.0 energy consumers ==========\n";
+    ds.append("========== End of PowerStats HAL 2.0 energy consumers ==========\n");
+}
+
+/* Fixed byte budget for the residency history ring */
+static constexpr size_t kHistoryBudgetBytes = 64 * 1024;
+/* A key frame with absolute values every N records bounds how much history
+ * budget eviction discards and gives the offline decoder a base */
+static constexpr uint32_t kHistoryKeyFrameInterval = 32;
+
+static void putVarint(std::vector<uint8_t> *out, uint64_t value) {
+    while (value >= 0x80) {
+        out->push_back(0x80 | (value & 0x7f));
+        value >>= 7;
+    }
+    out->push_back(value);
+}
+
+static void putSignedVarint(std::vector<uint8_t> *out, int64_t value) {
+    /* zigzag encoding; small negative deltas stay small on the wire */
+    putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void PowerStats::appendHistoryRecord(const std::vector<StateResidencyResult> &results,
+                                     uint64_t timestampMs) {
+    std::scoped_lock lock(mHistoryLock);
+
+    // A layout change (provider failure dropped an entity) forces a key frame
+    bool layoutMatches = results.size() == mHistoryPrevious.size();
+    for (size_t i = 0; layoutMatches && i < results.size(); ++i) {
+        layoutMatches = results[i].id == mHistoryPrevious[i].id &&
+                        results[i].stateResidencyData.size() ==
+                                mHistoryPrevious[i].stateResidencyData.size();
+    }
+    bool keyFrame = !layoutMatches || mHistoryRecordsSinceKeyFrame >= kHistoryKeyFrameInterval;
+
+    std::vector<uint8_t> record;
+    record.push_back(keyFrame ? 1 : 0);
+    if (keyFrame) {
+        putVarint(&record, timestampMs);
+        putVarint(&record, results.size());
+        for (const auto &result : results) {
+            putVarint(&record, result.id);
+            putVarint(&record, result.stateResidencyData.size());
+            for (const auto &state : result.stateResidencyData) {
+                putVarint(&record, state.id);
+                putVarint(&record, state.totalTimeInStateMs);
+                putVarint(&record, state.totalStateEntryCount);
+            }
+        }
+        mHistoryRecordsSinceKeyFrame = 0;
+    } else {
+        putVarint(&record, timestampMs - mHistoryPreviousTimestampMs);
+        for (size_t i = 0; i < results.size(); ++i) {
+            for (size_t j = 0; j < results[i].stateResidencyData.size(); ++j) {
+                const auto &cur = results[i].stateResidencyData[j];
+                const auto &prev = mHistoryPrevious[i].stateResidencyData[j];
+                putSignedVarint(&record, cur.totalTimeInStateMs - prev.totalTimeInStateMs);
+                putSignedVarint(&record, cur.totalStateEntryCount - prev.totalStateEntryCount);
+            }
+        }
+        mHistoryRecordsSinceKeyFrame++;
+    }
+
+    mHistoryBytes += record.size();
+    mHistoryRecords.emplace_back(std::move(record));
+    mHistoryPrevious = results;
+    mHistoryPreviousTimestampMs = timestampMs;
+
+    // Enforce the budget; the ring must keep starting at a key frame so the
+    // surviving deltas stay decodable
+    while (mHistoryBytes > kHistoryBudgetBytes && !mHistoryRecords.empty()) {
+        mHistoryBytes -= mHistoryRecords.front().size();
+        mHistoryRecords.pop_front();
+        while (!mHistoryRecords.empty() && !(mHistoryRecords.front()[0] & 1)) {
+            mHistoryBytes -= mHistoryRecords.front().size();
+            mHistoryRecords.pop_front();
+        }
+    }
+}
+
+void PowerStats::residencyHistoryLoop(uint32_t intervalMs) {
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+
+        std::vector<StateResidencyResult> results;
+        getStateResidencyInternal({}, &results, false /* forceRefresh */);
+        if (results.empty()) {
+            continue;
+        }
+
+        uint64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 ::android::base::boot_clock::now().time_since_epoch())
+                                 .count();
+        appendHistoryRecord(results, nowMs);
+    }
+}
+
+void PowerStats::enableResidencyHistory(uint32_t intervalMs) {
+    std::thread([this, intervalMs]() { residencyHistoryLoop(intervalMs); }).detach();
+}
+
+/*
+ * Binary dump, decoded offline:
+ *   magic "PSRH", u8 version, then the ring's records oldest first. Each
+ *   record is a u8 flags byte (bit 0: key frame) followed by:
+ *     key frame: varint timestampMs, varint entityCount, per entity
+ *       varint id + varint stateCount, per state varint id + varint
+ *       totalTimeMs + varint entryCount
+ *     delta: varint timestampMs delta, then per state in key-frame order a
+ *       zigzag varint totalTimeMs delta + zigzag varint entryCount delta
+ */
+void PowerStats::dumpResidencyHistory(int fd) {
+    std::string out("PSRH\x01", 5);
+    {
+        std::scoped_lock lock(mHistoryLock);
+        for (const auto &record : mHistoryRecords) {
+            out.append(reinterpret_cast<const char *>(record.data()), record.size());
+        }
+    }
+    ::android::base::WriteStringToFd(out, fd);
 }
 
 binder_status_t PowerStats::dump(int fd, const char **args, uint32_t numArgs) {
-    std::ostringstream oss;
+    if ((numArgs == 1) && (std::string(args[0]) == "residency-history")) {
+        dumpResidencyHistory(fd);
+        fsync(fd);
+        return STATUS_OK;
+    }
+
     bool delta = (numArgs == 1) && (std::string(args[0]) == "delta");
 
-    // Generate debug output for state residency
-    dumpStateResidency(oss, delta);
+    // Stream the report from a worker thread: each section writes to the fd
+    // with bounded scratch, and the binder thread only waits, keeping the
+    // threadpool's stacks and allocator state out of the report generation.
+    std::thread worker([this, fd, delta]() {
+        // Generate debug output for state residency
+        dumpStateResidency(fd, delta);
 
-    // Generate debug output for energy consumer
-    dumpEnergyConsumer(oss, delta);
+        // Generate debug output for energy consumer
+        dumpEnergyConsumer(fd, delta);
 
-    // Generate debug output energy meter
-    dumpEnergyMeter(oss, delta);
+        // Generate debug output energy meter
+        dumpEnergyMeter(fd, delta);
+    });
+    worker.join();
 
-    ::android::base::WriteStringToFd(oss.str(), fd);
     fsync(fd);
     return STATUS_OK;
 }
@@ -37,7 +37,9 @@ DisplayStateResidencyDataProvider::DisplayStateResidencyDataProvider(
     : mPath(std::move(path)),
       mName(std::move(name)),
       mStates(states),
+      mSeq(0),
       mCurState(-1),
+      mCurStateSinceMs(0),
       mLooper(new ::android::Looper(true)) {
     // Construct mResidencies
     mResidencies.reserve(mStates.size());
@@ -70,18 +72,30 @@ DisplayStateResidencyDataProvider::~DisplayStateResidencyDataProvider() {
 
 bool DisplayStateResidencyDataProvider::getStateResidencies(
         std::unordered_map<std::string, std::vector<StateResidency>> *residencies) {
-    std::scoped_lock lk(mLock);
-
-    // Get current time since boot in milliseconds
-    uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
-                           ::android::base::boot_clock::now().time_since_epoch())
-                           .count();
-
-    // Construct residency result based on current residency data
-    auto result = mResidencies;
-
-    if (mCurState > -1) {
-        result[mCurState].totalTimeInStateMs += now - result[mCurState].lastEntryTimestampMs;
+    std::vector<StateResidency> result;
+    int32_t curState;
+    uint64_t curStateSinceMs;
+
+    // Take a consistent snapshot of the accumulated counters. The poll thread
+    // folds elapsed time into mResidencies on every wakeup, so the snapshot is
+    // a plain copy; retry if the poll thread updated it mid-read.
+    uint32_t seq;
+    do {
+        seq = mSeq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            continue;
+        }
+        result = mResidencies;
+        curState = mCurState;
+        curStateSinceMs = mCurStateSinceMs;
+    } while (mSeq.load(std::memory_order_acquire) != seq);
+
+    // Account for the portion of the current state not yet folded in
+    if (curState > -1) {
+        uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               ::android::base::boot_clock::now().time_since_epoch())
+                               .count();
+        result[curState].totalTimeInStateMs += now - curStateSinceMs;
     }
 
     residencies->emplace(mName, result);
@@ -98,8 +112,16 @@ std::unordered_map<std::string, std::vector<State>> DisplayStateResidencyDataPro
     return {{mName, stateInfos}};
 }
 
-// Called when there is new data to be read from
-// display state file descriptor indicating a state change
+void DisplayStateResidencyDataProvider::foldCurrentState(uint64_t nowMs) {
+    if (mCurState > -1) {
+        mResidencies[mCurState].totalTimeInStateMs += nowMs - mCurStateSinceMs;
+        mCurStateSinceMs = nowMs;
+    }
+}
+
+// Called on every poll wakeup: folds the elapsed time of the current state
+// into its residency counter and, if the display state file changed,
+// switches the current state
 void DisplayStateResidencyDataProvider::updateStats() {
     char data[32];
     char *trim;
@@ -121,8 +143,14 @@ void DisplayStateResidencyDataProvider::updateStats() {
     }
 
     // Update residency stats based on state read
-    {  // acquire lock
-        std::scoped_lock lk(mLock);
+    {  // begin write section: odd sequence tells readers a write is in flight
+        mSeq.fetch_add(1, std::memory_order_acquire);
+
+        // Fold the elapsed time of the current state, even when the state did
+        // not change, so the accumulated counters stay fresh at poll
+        // granularity and queries are a plain copy
+        foldCurrentState(now);
+
         for (uint32_t i = 0; i < mStates.size(); ++i) {
             if (strcmp(data, mStates[i].c_str()) == 0) {
                 if (i == mCurState) {
@@ -131,20 +159,17 @@ void DisplayStateResidencyDataProvider::updateStats() {
 
                 LOG(VERBOSE) << "display state: " << data;
 
-                // Update total time of the previous state
-                if (mCurState > -1) {
-                    mResidencies[mCurState].totalTimeInStateMs +=
-                            now - mResidencies[mCurState].lastEntryTimestampMs;
-                }
-
                 // Set current state
                 mCurState = i;
+                mCurStateSinceMs = now;
                 mResidencies[i].totalStateEntryCount++;
                 mResidencies[i].lastEntryTimestampMs = now;
                 break;
             }
         }
-    }  // release lock
+
+        mSeq.fetch_add(1, std::memory_order_release);
+    }  // end write section
 }
 
 void DisplayStateResidencyDataProvider::pollLoop() {
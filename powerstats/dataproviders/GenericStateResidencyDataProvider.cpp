@@ -15,7 +15,6 @@
  */
 
 #include <android-base/logging.h>
-#include <android-base/strings.h>
 
 #include <dataproviders/GenericStateResidencyDataProvider.h>
 
@@ -25,6 +24,8 @@ namespace hardware {
 namespace power {
 namespace stats {
 
+namespace parser = ::android::hardware::google::pixel::powerstats::parser;
+
 std::vector<GenericStateResidencyDataProvider::StateResidencyConfig>
 generateGenericStateResidencyConfigs(
         const GenericStateResidencyDataProvider::StateResidencyConfig &stateConfig,
@@ -40,92 +41,35 @@ generateGenericStateResidencyConfigs(
     return stateResidencyConfigs;
 }
 
-static bool extractStat(const char *line, const std::string &prefix, uint64_t *stat) {
-    char const *prefixStart = strstr(line, prefix.c_str());
-    if (prefixStart == nullptr) {
-        // Did not find the given prefix
-        return false;
-    }
-
-    *stat = strtoull(prefixStart + prefix.length(), nullptr, 0);
-    return true;
-}
-
-static bool parseState(StateResidency *data,
-                       const GenericStateResidencyDataProvider::StateResidencyConfig &config,
-                       FILE *fp, char **line, size_t *len) {
-    size_t numFieldsRead = 0;
-    const size_t numFields =
-            config.entryCountSupported + config.totalTimeSupported + config.lastEntrySupported;
-
-    while ((numFieldsRead < numFields) && (getline(line, len, fp) != -1)) {
-        uint64_t stat = 0;
-        // Attempt to extract data from the current line
-        if (config.entryCountSupported && extractStat(*line, config.entryCountPrefix, &stat)) {
-            data->totalStateEntryCount =
-                    config.entryCountTransform ? config.entryCountTransform(stat) : stat;
-            ++numFieldsRead;
-        } else if (config.totalTimeSupported && extractStat(*line, config.totalTimePrefix, &stat)) {
-            data->totalTimeInStateMs =
-                    config.totalTimeTransform ? config.totalTimeTransform(stat) : stat;
-            ++numFieldsRead;
-        } else if (config.lastEntrySupported && extractStat(*line, config.lastEntryPrefix, &stat)) {
-            data->lastEntryTimestampMs =
-                    config.lastEntryTransform ? config.lastEntryTransform(stat) : stat;
-            ++numFieldsRead;
-        }
-    }
-
-    // End of file was reached and not all state data was parsed. Something
-    // went wrong
-    if (numFieldsRead != numFields) {
-        LOG(ERROR) << "Failed to parse stats for " << config.name;
-        return false;
-    }
-
-    return true;
-}
-
-template <class T, class Func>
-static int32_t findNextIndex(const std::vector<T> &collection, FILE *fp, char **line, size_t *len,
-                             Func pred) {
-    // handling the case when there is no header to look for
-    if (pred(collection[0], "")) {
-        return 0;
-    }
+void GenericStateResidencyDataProvider::compileMatchers() {
+    mStateMatchers.resize(mPowerEntityConfigs.size());
+    for (size_t i = 0; i < mPowerEntityConfigs.size(); ++i) {
+        mEntityMatcher.add(mPowerEntityConfigs[i].mHeader, i);
 
-    while (getline(line, len, fp) != -1) {
-        for (int32_t i = 0; i < collection.size(); ++i) {
-            if (pred(collection[i], *line)) {
-                return i;
-            }
+        const auto &stateConfigs = mPowerEntityConfigs[i].mStateResidencyConfigs;
+        for (size_t j = 0; j < stateConfigs.size(); ++j) {
+            mStateMatchers[i].add(stateConfigs[j].header, j);
         }
     }
-
-    return -1;
 }
 
-static bool getStateData(std::vector<StateResidency> *result,
-                         const std::vector<GenericStateResidencyDataProvider::StateResidencyConfig>
-                                 &stateResidencyConfigs,
-                         FILE *fp, char **line, size_t *len) {
+bool GenericStateResidencyDataProvider::getStateData(std::vector<StateResidency> *result,
+                                                     size_t configIndex, FILE *fp, char **line,
+                                                     size_t *len) const {
+    const auto &stateResidencyConfigs = mPowerEntityConfigs[configIndex].mStateResidencyConfigs;
+    const HeaderMatcher &matcher = mStateMatchers[configIndex];
     size_t numStatesRead = 0;
     size_t numStates = stateResidencyConfigs.size();
     int32_t nextState = -1;
-    auto pred = [](auto a, char const *b) {
-        // return true if b matches the header contained in a, ignoring whitespace
-        return (a.header == ::android::base::Trim(b));
-    };
 
     result->reserve(numStates);
 
     // Search for state headers until we have found them all or can't find anymore
     while ((numStatesRead < numStates) &&
-           (nextState = findNextIndex<GenericStateResidencyDataProvider::StateResidencyConfig>(
-                    stateResidencyConfigs, fp, line, len, pred)) >= 0) {
+           (nextState = parser::findNextIndex(matcher, fp, line, len)) >= 0) {
         // Found a matching state header. Parse the contents
         StateResidency data = {.id = nextState};
-        if (parseState(&data, stateResidencyConfigs[nextState], fp, line, len)) {
+        if (parser::parseState(&data, stateResidencyConfigs[nextState], fp, line, len)) {
             result->emplace_back(data);
             ++numStatesRead;
         } else {
@@ -155,19 +99,13 @@ bool GenericStateResidencyDataProvider::getStateResidencies(
     size_t numEntitiesRead = 0;
     size_t numEntities = mPowerEntityConfigs.size();
     int32_t nextConfig = -1;
-    auto pred = [](auto a, char const *b) {
-        // return true if b matches the header contained in a, ignoring whitespace
-        return (a.mHeader == ::android::base::Trim(b));
-    };
 
     // Search for entity headers until we have found them all or can't find anymore
     while ((numEntitiesRead < numEntities) &&
-           (nextConfig = findNextIndex<decltype(mPowerEntityConfigs)::value_type>(
-                    mPowerEntityConfigs, fp.get(), &line, &len, pred)) >= 0) {
+           (nextConfig = parser::findNextIndex(mEntityMatcher, fp.get(), &line, &len)) >= 0) {
         // Found a matching header. Retrieve its state data
         std::vector<StateResidency> result;
-        if (getStateData(&result, mPowerEntityConfigs[nextConfig].mStateResidencyConfigs, fp.get(),
-                         &line, &len)) {
+        if (getStateData(&result, nextConfig, fp.get(), &line, &len)) {
             residencies->emplace(mPowerEntityConfigs[nextConfig].mName, result);
             ++numEntitiesRead;
         } else {
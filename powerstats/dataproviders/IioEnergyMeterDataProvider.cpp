@@ -22,7 +22,10 @@
 #include <android-base/strings.h>
 #include <dataproviders/IioEnergyMeterDataProvider.h>
 #include <dataproviders/IioEnergyMeterDataSelector.h>
+#include <fcntl.h>
 #include <inttypes.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <utils/Trace.h>
 
 namespace aidl {
@@ -34,8 +37,40 @@ namespace stats {
 using aidl::android::hardware::power::stats::IioEnergyMeterDataSelector;
 
 #define MAX_RAIL_NAME_LEN 50
-#define STR(s) #s
-#define XSTR(s) STR(s)
+
+/* Fixed-column scanner helpers; no allocation, no locale handling. */
+static bool scanLiteral(const char **pos, const char *end, const char *literal) {
+    const char *p = *pos;
+    while (*literal) {
+        if (p >= end || *p != *literal) {
+            return false;
+        }
+        p++;
+        literal++;
+    }
+    *pos = p;
+    return true;
+}
+
+static bool scanU64(const char **pos, const char *end, uint64_t *val) {
+    const char *p = *pos;
+    if (p >= end || *p < '0' || *p > '9') {
+        return false;
+    }
+    uint64_t v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        v = v * 10 + (*p - '0');
+        p++;
+    }
+    *pos = p;
+    *val = v;
+    return true;
+}
+
+static bool skipU64(const char **pos, const char *end) {
+    uint64_t ignored;
+    return scanU64(pos, end, &ignored);
+}
 
 void IioEnergyMeterDataProvider::findIioEnergyMeterNodes() {
     struct dirent *ent;
@@ -69,6 +104,66 @@ void IioEnergyMeterDataProvider::findIioEnergyMeterNodes() {
     return;
 }
 
+/**
+ * The tag identifies one enumeration result: same boot (boot id) and an
+ * unchanged /sys/bus/iio/devices (directory mtime). An empty tag disables
+ * caching for this run.
+ */
+std::string IioEnergyMeterDataProvider::cacheTag() {
+    std::string bootId;
+    struct stat st;
+
+    if (!::android::base::ReadFileToString("/proc/sys/kernel/random/boot_id", &bootId) ||
+        stat(kIioRootDir.c_str(), &st) != 0) {
+        return "";
+    }
+
+    return ::android::base::Trim(bootId) + " " + std::to_string(st.st_mtim.tv_sec) + "." +
+           std::to_string(st.st_mtim.tv_nsec);
+}
+
+bool IioEnergyMeterDataProvider::loadCachedEnergyMeterNodes(const std::string &tag) {
+    std::string contents;
+
+    if (tag.empty() || !::android::base::ReadFileToString(kCachePath, &contents)) {
+        return false;
+    }
+
+    /* First line is the tag, then one "devicePath deviceName" line per match */
+    std::istringstream input(contents);
+    std::string line;
+    if (!std::getline(input, line) || line != tag) {
+        return false;
+    }
+
+    while (std::getline(input, line)) {
+        size_t split = line.find(' ');
+        if (split == std::string::npos) {
+            mDevicePaths.clear();
+            return false;
+        }
+        mDevicePaths.emplace(line.substr(0, split), line.substr(split + 1));
+    }
+
+    return !mDevicePaths.empty();
+}
+
+void IioEnergyMeterDataProvider::saveCachedEnergyMeterNodes(const std::string &tag) {
+    if (tag.empty() || mDevicePaths.empty()) {
+        return;
+    }
+
+    std::string contents = tag + "\n";
+    for (const auto &path : mDevicePaths) {
+        contents += path.first + " " + path.second + "\n";
+    }
+
+    mkdir(kCacheDir.c_str(), 0770);
+    if (!::android::base::WriteStringToFile(contents, kCachePath)) {
+        PLOG(WARNING) << "Failed to write device cache " << kCachePath;
+    }
+}
+
 void IioEnergyMeterDataProvider::parseEnabledRails() {
     std::string data;
     int32_t id = 0;
@@ -105,86 +200,119 @@ void IioEnergyMeterDataProvider::parseEnabledRails() {
     }
 }
 
+void IioEnergyMeterDataProvider::openEnergyValueNodes() {
+    for (const auto &path : mDevicePaths) {
+        ::android::base::unique_fd fd(TEMP_FAILURE_RETRY(
+                open((path.first + kEnergyValueNode).c_str(), O_RDONLY | O_CLOEXEC)));
+        if (fd.get() == -1) {
+            PLOG(ERROR) << "Failed to open energy value node in " << path.first;
+            continue;
+        }
+        mEnergyValueFds.emplace(path.first, std::move(fd));
+    }
+}
+
 IioEnergyMeterDataProvider::IioEnergyMeterDataProvider(
         const std::vector<const std::string> &deviceNames, const bool useSelector)
     : kDeviceNames(std::move(deviceNames)) {
-    findIioEnergyMeterNodes();
+    const std::string tag = cacheTag();
+    if (!loadCachedEnergyMeterNodes(tag)) {
+        findIioEnergyMeterNodes();
+        saveCachedEnergyMeterNodes(tag);
+    }
     if (useSelector) {
         /* Run meter selection in constructor; object can be discarded afterwards */
         IioEnergyMeterDataSelector selector(mDevicePaths);
     }
     parseEnabledRails();
     mReading.resize(mChannelInfos.size());
+    openEnergyValueNodes();
+    /* One timestamp line plus one line per rail; sized once so the per-read
+     * append never reallocates. */
+    mContents.reserve((mChannelInfos.size() + 1) * (MAX_RAIL_NAME_LEN + 32));
 }
 
 int IioEnergyMeterDataProvider::parseEnergyContents(const std::string &contents) {
-    std::istringstream energyData(contents);
-    std::string line;
-
-    int ret = 0;
+    const char *pos = contents.data();
+    const char *end = pos + contents.size();
     uint64_t timestamp = 0;
-    bool timestampRead = false;
-
-    while (std::getline(energyData, line)) {
-        bool parseLineSuccess = false;
 
-        if (timestampRead == false) {
-            /* Read timestamp from boot (ms) */
-            if (sscanf(line.c_str(), "t=%" PRIu64, &timestamp) == 1) {
-                if (timestamp == 0 || timestamp == ULLONG_MAX) {
-                    LOG(ERROR) << "Potentially wrong timestamp: " << timestamp;
-                }
-                timestampRead = true;
-                parseLineSuccess = true;
-            }
+    /* Read timestamp from boot (ms); format example: t=358356 */
+    if (!scanLiteral(&pos, end, "t=") || !scanU64(&pos, end, &timestamp)) {
+        return -1;
+    }
+    if (timestamp == 0 || timestamp == ULLONG_MAX) {
+        LOG(ERROR) << "Potentially wrong timestamp: " << timestamp;
+    }
 
-        } else {
-            /* Read rail energy */
-            uint64_t energy = 0;
-            uint64_t duration = 0;
-            char railNameRaw[MAX_RAIL_NAME_LEN + 1];
-
-            /* Format example: CH3(T=358356)[S2M_VDD_CPUCL2], 761330 */
-            if (sscanf(line.c_str(),
-                       "CH%*d(T=%" PRIu64 ")[%" XSTR(MAX_RAIL_NAME_LEN) "[^]]], %" PRIu64,
-                       &duration, railNameRaw, &energy) == 3) {
-                std::string railName(railNameRaw);
-
-                /* If the count == 0, the rail may not be enabled */
-                /* The count cannot be > 1; mChannelIds is a map */
-                if (mChannelIds.count(railName) == 1) {
-                    size_t index = mChannelIds[railName];
-                    mReading[index].id = index;
-                    mReading[index].timestampMs = timestamp;
-                    mReading[index].durationMs = duration;
-                    mReading[index].energyUWs = energy;
-                    if (mReading[index].energyUWs == ULLONG_MAX) {
-                        LOG(ERROR) << "Potentially wrong energy value on rail: " << railName;
-                    }
-                    ATRACE_INT(railNameRaw, energy);
-                }
-                parseLineSuccess = true;
-            }
+    /* Read rail energy for every rail in one pass over the buffer */
+    while (pos < end) {
+        if (*pos == '\n') {
+            pos++;
+            continue;
         }
 
-        if (parseLineSuccess == false) {
-            ret = -1;
-            break;
+        uint64_t energy = 0;
+        uint64_t duration = 0;
+
+        /* Format example: CH3(T=358356)[S2M_VDD_CPUCL2], 761330 */
+        if (!scanLiteral(&pos, end, "CH") || !skipU64(&pos, end) ||
+            !scanLiteral(&pos, end, "(T=") || !scanU64(&pos, end, &duration) ||
+            !scanLiteral(&pos, end, ")[")) {
+            return -1;
+        }
+        const char *nameStart = pos;
+        while (pos < end && *pos != ']') {
+            pos++;
+        }
+        size_t nameLen = pos - nameStart;
+        if (nameLen == 0 || nameLen > MAX_RAIL_NAME_LEN ||
+            !scanLiteral(&pos, end, "], ") || !scanU64(&pos, end, &energy)) {
+            return -1;
+        }
+        std::string railName(nameStart, nameLen);
+
+        /* If the count == 0, the rail may not be enabled */
+        /* The count cannot be > 1; mChannelIds is a map */
+        if (mChannelIds.count(railName) == 1) {
+            size_t index = mChannelIds[railName];
+            mReading[index].id = index;
+            mReading[index].timestampMs = timestamp;
+            mReading[index].durationMs = duration;
+            mReading[index].energyUWs = energy;
+            if (mReading[index].energyUWs == ULLONG_MAX) {
+                LOG(ERROR) << "Potentially wrong energy value on rail: " << railName;
+            }
+            ATRACE_INT(railName.c_str(), energy);
         }
     }
 
-    return ret;
+    return 0;
 }
 
-int IioEnergyMeterDataProvider::parseEnergyValue(std::string path) {
+int IioEnergyMeterDataProvider::parseEnergyValue(const std::string &path) {
     int ret = 0;
-    std::string data;
-    if (!::android::base::ReadFileToString(path + kEnergyValueNode, &data)) {
-        LOG(ERROR) << "Error reading energy value in " << path;
+    auto fdIter = mEnergyValueFds.find(path);
+    if (fdIter == mEnergyValueFds.end()) {
+        LOG(ERROR) << "No energy value fd for " << path;
+        return -1;
+    }
+
+    /* Reading from offset 0 makes sysfs regenerate the contents */
+    mContents.clear();
+    char buf[4096];
+    ssize_t n;
+    size_t offset = 0;
+    while ((n = TEMP_FAILURE_RETRY(pread(fdIter->second.get(), buf, sizeof(buf), offset))) > 0) {
+        mContents.append(buf, n);
+        offset += n;
+    }
+    if (n < 0) {
+        PLOG(ERROR) << "Error reading energy value in " << path;
         return -1;
     }
 
-    ret = parseEnergyContents(data);
+    ret = parseEnergyContents(mContents);
     if (ret != 0) {
         LOG(ERROR) << "Unexpected format in " << path;
     }
@@ -20,6 +20,9 @@
 #include <android-base/stringprintf.h>
 #include <android/binder_status.h>
 
+#include <future>
+#include <thread>
+
 namespace aidl {
 namespace android {
 namespace hardware {
@@ -44,11 +47,12 @@ void PixelStateResidencyDataProvider::start() {
 }
 
 ::ndk::ScopedAStatus PixelStateResidencyDataProvider::getStateResidenciesTimed(
-        const Entry &entry, std::vector<StateResidency> *residency) {
+        const std::string &name, const std::shared_ptr<IPixelStateResidencyCallback> &callback,
+        std::vector<StateResidency> *residency) {
     const uint64_t MAX_LATENCY_US = 2000;
 
-    if (!entry.mCallback) {
-        LOG(ERROR) << "callback for " << entry.mName << " is not registered";
+    if (!callback) {
+        LOG(ERROR) << "callback for " << name << " is not registered";
         return ndk::ScopedAStatus::fromStatus(STATUS_UNEXPECTED_NULL);
     }
 
@@ -56,13 +60,13 @@ void PixelStateResidencyDataProvider::start() {
     struct timespec now;
 
     clock_gettime(CLOCK_BOOTTIME, &then);
-    ::ndk::ScopedAStatus status = entry.mCallback->getStateResidency(residency);
+    ::ndk::ScopedAStatus status = callback->getStateResidency(residency);
     clock_gettime(CLOCK_BOOTTIME, &now);
 
     uint64_t timeElapsedUs =
             ((now.tv_sec - then.tv_sec) * 1000000) + ((now.tv_nsec - then.tv_nsec) / 1000);
     if (timeElapsedUs > MAX_LATENCY_US) {
-        LOG(WARNING) << "getStateResidency latency for " << entry.mName
+        LOG(WARNING) << "getStateResidency latency for " << name
                      << " exceeded time allowed: " << timeElapsedUs << "us";
     }
 
@@ -73,12 +77,39 @@ bool PixelStateResidencyDataProvider::getStateResidencies(
         std::unordered_map<std::string, std::vector<StateResidency>> *residencies) {
     std::lock_guard<std::mutex> lock(mLock);
 
+    // Fan the queries out concurrently and collect replies against one shared
+    // deadline. A laggard's thread keeps sole ownership of its result vector,
+    // so abandoning a reply that misses the deadline is safe.
+    struct PendingQuery {
+        std::shared_ptr<std::vector<StateResidency>> residency;
+        std::future<::ndk::ScopedAStatus> status;
+    };
+    std::vector<PendingQuery> pending(mEntries.size());
+
+    for (size_t i = 0; i < mEntries.size(); i++) {
+        pending[i].residency = std::make_shared<std::vector<StateResidency>>();
+
+        std::promise<::ndk::ScopedAStatus> promise;
+        pending[i].status = promise.get_future();
+        std::thread([this, name = mEntries[i].mName, callback = mEntries[i].mCallback,
+                     residency = pending[i].residency, promise = std::move(promise)]() mutable {
+            promise.set_value(getStateResidenciesTimed(name, callback, residency.get()));
+        }).detach();
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + kGetResidencyDeadline;
     size_t numResultsFound = 0;
     size_t numResults = mEntries.size();
-    for (auto &entry : mEntries) {
-        std::vector<StateResidency> residency;
-        ::ndk::ScopedAStatus status = getStateResidenciesTimed(entry, &residency);
+    for (size_t i = 0; i < mEntries.size(); i++) {
+        auto &entry = mEntries[i];
+
+        if (pending[i].status.wait_until(deadline) != std::future_status::ready) {
+            LOG(WARNING) << "getStateResidency for " << entry.mName
+                         << " missed the aggregation deadline; dropping this cycle";
+            continue;
+        }
 
+        ::ndk::ScopedAStatus status = pending[i].status.get();
         if (!status.isOk()) {
             LOG(ERROR) << "getStateResidency for " << entry.mName << " failed";
 
@@ -87,8 +118,8 @@ bool PixelStateResidencyDataProvider::getStateResidencies(
                 entry.mCallback = nullptr;
             }
         }
-        if (!residency.empty()) {
-            residencies->emplace(entry.mName, residency);
+        if (!pending[i].residency->empty()) {
+            residencies->emplace(entry.mName, std::move(*pending[i].residency));
             numResultsFound++;
         }
     }
@@ -18,6 +18,9 @@
 
 #include <android-base/logging.h>
 
+#include <algorithm>
+#include <future>
+
 namespace aidl {
 namespace android {
 namespace hardware {
@@ -147,17 +150,43 @@ bool PowerStatsEnergyConsumer::addAttribution(std::unordered_map<int32_t, std::s
 std::optional<EnergyConsumerResult> PowerStatsEnergyConsumer::getEnergyConsumed() {
     int64_t totalEnergyUWs = 0;
     int64_t timestampMs = 0;
+    bool meterOk = true;
 
+    /* Issue the meter read concurrently with the residency/attribution fetch
+     * below; the two go to independent interfaces and each can take
+     * milliseconds, so overlapping them roughly halves the query latency. */
+    std::vector<EnergyMeasurement> measurements;
+    std::future<bool> meterFuture;
     if (!mChannelIds.empty()) {
-        std::vector<EnergyMeasurement> measurements;
-        if (mPowerStats->readEnergyMeter(mChannelIds, &measurements).isOk()) {
-            for (const auto &m : measurements) {
-                totalEnergyUWs += m.energyUWs;
-                timestampMs = m.timestampMs;
-            }
+        if (!mCoefficients.empty()) {
+            meterFuture = std::async(std::launch::async, [this, &measurements]() {
+                return mPowerStats->readEnergyMeter(mChannelIds, &measurements).isOk();
+            });
         } else {
+            meterOk = mPowerStats->readEnergyMeter(mChannelIds, &measurements).isOk();
+        }
+    }
+
+    /* Joins the meter read (if in flight) and folds it into the totals */
+    auto collectMeter = [&]() -> bool {
+        if (meterFuture.valid()) {
+            meterOk = meterFuture.get();
+        }
+        if (!meterOk) {
             LOG(ERROR) << "Failed to read energy meter";
-            return {};
+            return false;
+        }
+        for (const auto &m : measurements) {
+            totalEnergyUWs += m.energyUWs;
+            timestampMs = m.timestampMs;
+        }
+        return true;
+    };
+
+    if (mFlatCoefficients.empty() && !mCoefficients.empty()) {
+        mFlatCoefficients.resize(mCoefficients.rbegin()->first + 1, 0);
+        for (const auto &c : mCoefficients) {
+            mFlatCoefficients[c.first] = c.second;
         }
     }
 
@@ -165,20 +194,31 @@ std::optional<EnergyConsumerResult> PowerStatsEnergyConsumer::getEnergyConsumed(
     if (!mCoefficients.empty()) {
         if (mWithAttribution) {
             AttributionStats attrStats = mEnergyAttribution.getAttributionStats(mAttrInfoPath);
+            if (!collectMeter()) {
+                return {};
+            }
             if (attrStats.uidTimeInStats.empty() || attrStats.uidTimeInStateNames.empty()) {
                 LOG(ERROR) << "Failed to read uid_time_in_state for attribution, return default EnergyConsumer";
             } else {
                 int64_t totalRelativeEnergyUWs = 0;
                 for (const auto &uidTimeInStat : attrStats.uidTimeInStats) {
+                    /* Dot product of coefficients and time-in-state deltas over
+                     * contiguous arrays; the compiler vectorizes this loop. */
+                    const long *cur = uidTimeInStat.second.data();
+                    const long *prev = nullptr;
+                    size_t numStates =
+                            std::min(mFlatCoefficients.size(), uidTimeInStat.second.size());
+                    auto ss = mUidTimeInStateSS.find(uidTimeInStat.first);
+                    if (ss != mUidTimeInStateSS.end()) {
+                        prev = ss->second.data();
+                        numStates = std::min(numStates, ss->second.size());
+                    }
+
                     int64_t uidEnergyUWs = 0;
-                    for (int id = 0; id < uidTimeInStat.second.size(); id++) {
-                        if (mCoefficients.count(id)) {
-                            int64_t d_time_in_state = uidTimeInStat.second.at(id);
-                            if (mUidTimeInStateSS.count(uidTimeInStat.first)) {
-                                d_time_in_state -= mUidTimeInStateSS.at(uidTimeInStat.first).at(id);
-                            }
-                            uidEnergyUWs += mCoefficients.at(id) * d_time_in_state;
-                        }
+                    for (size_t id = 0; id < numStates; id++) {
+                        const int64_t d_time_in_state = cur[id] - (prev ? prev[id] : 0);
+                        uidEnergyUWs += static_cast<int64_t>(mFlatCoefficients[id]) *
+                                        d_time_in_state;
                     }
                     totalRelativeEnergyUWs += uidEnergyUWs;
 
@@ -205,10 +245,16 @@ std::optional<EnergyConsumerResult> PowerStatsEnergyConsumer::getEnergyConsumed(
             }
         } else {
             std::vector<StateResidencyResult> results;
-            if (mPowerStats->getStateResidency({mPowerEntityId}, &results).isOk()) {
+            const bool residencyOk =
+                    mPowerStats->getStateResidency({mPowerEntityId}, &results).isOk();
+            if (!collectMeter()) {
+                return {};
+            }
+            if (residencyOk) {
                 for (const auto &s : results[0].stateResidencyData) {
-                    if (mCoefficients.count(s.id)) {
-                        totalEnergyUWs += mCoefficients.at(s.id) * s.totalTimeInStateMs;
+                    if (s.id >= 0 && static_cast<size_t>(s.id) < mFlatCoefficients.size()) {
+                        totalEnergyUWs += static_cast<int64_t>(mFlatCoefficients[s.id]) *
+                                          s.totalTimeInStateMs;
                     }
                 }
             } else {
@@ -216,6 +262,8 @@ std::optional<EnergyConsumerResult> PowerStatsEnergyConsumer::getEnergyConsumed(
                 return {};
             }
         }
+    } else if (!collectMeter()) {
+        return {};
     }
 
     return EnergyConsumerResult{.timestampMs = timestampMs,
@@ -17,6 +17,8 @@
 #include <android-base/logging.h>
 #include <android-base/properties.h>
 #include <android-base/strings.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <dataproviders/WlanStateResidencyDataProvider.h>
 
@@ -42,52 +44,74 @@ static bool extractStat(const char *line, const std::string &prefix, uint64_t *s
     return true;
 }
 
+bool WlanStateResidencyDataProvider::ensureStatsFd() {
+    if (mStatsFd.ok()) {
+        return true;
+    }
+
+    mStatsFd.reset(TEMP_FAILURE_RETRY(open(mPath.c_str(), O_RDONLY | O_CLOEXEC)));
+    if (!mStatsFd.ok()) {
+        PLOG(ERROR) << ":Failed to open file " << mPath;
+        return false;
+    }
+    return true;
+}
+
 bool WlanStateResidencyDataProvider::getStateResidencies(
         std::unordered_map<std::string, std::vector<StateResidency>> *residencies) {
     std::vector<StateResidency> result = {{.id = ACTIVE_ID}, {.id = DEEPSLEEP_ID}};
 
-    std::string wlanDriverStatus = ::android::base::GetProperty("wlan.driver.status", "unloaded");
-    if (wlanDriverStatus != "ok") {
-        LOG(ERROR) << ": wlan is " << wlanDriverStatus;
+    const char *wlanDriverStatus = mDriverStatus.Get();
+    if (strcmp(wlanDriverStatus, "ok") != 0) {
+        LOG(ERROR) << ": wlan is " << (*wlanDriverStatus ? wlanDriverStatus : "unloaded");
         // Return 0s for Wlan stats, because the driver is unloaded
         residencies->emplace(mName, result);
         return true;
     }
 
-    // Using FILE* instead of std::ifstream for performance reasons (b/122253123)
-    std::unique_ptr<FILE, decltype(&fclose)> fp(fopen(mPath.c_str(), "r"), fclose);
-    if (!fp) {
-        PLOG(ERROR) << ":Failed to open file " << mPath;
+    if (!ensureStatsFd()) {
         return false;
     }
-    size_t numFieldsRead = 0;
-    const size_t numFields = 4;
-    size_t len = 0;
-    char *line = nullptr;
-
-    while ((numFieldsRead < numFields) && (getline(&line, &len, fp.get()) != -1)) {
-        uint64_t stat = 0;
-        if (extractStat(line, "cumulative_sleep_time_ms:", &stat)) {
-            result[1].totalTimeInStateMs = stat;
-            ++numFieldsRead;
-        } else if (extractStat(line, "cumulative_total_on_time_ms:", &stat)) {
-            result[0].totalTimeInStateMs = stat;
-            ++numFieldsRead;
-        } else if (extractStat(line, "deep_sleep_enter_counter:", &stat)) {
-            result[0].totalStateEntryCount = stat;
-            result[1].totalStateEntryCount = stat;
-            ++numFieldsRead;
-        } else if (extractStat(line, "last_deep_sleep_enter_tstamp_ms:", &stat)) {
-            result[1].lastEntryTimestampMs = stat;
-            ++numFieldsRead;
+
+    /* Reading from offset 0 regenerates the contents without reopening */
+    char buf[4096];
+    ssize_t n = TEMP_FAILURE_RETRY(pread(mStatsFd.get(), buf, sizeof(buf) - 1, 0));
+    if (n <= 0) {
+        /* A driver reload invalidates the cached fd; reopen once and retry */
+        mStatsFd.reset();
+        if (!ensureStatsFd()) {
+            return false;
+        }
+        n = TEMP_FAILURE_RETRY(pread(mStatsFd.get(), buf, sizeof(buf) - 1, 0));
+        if (n <= 0) {
+            PLOG(ERROR) << ":Failed to read file " << mPath;
+            return false;
         }
     }
+    buf[n] = '\0';
 
-    free(line);
+    size_t numFieldsRead = 0;
+    uint64_t stat = 0;
+    if (extractStat(buf, "cumulative_sleep_time_ms:", &stat)) {
+        result[1].totalTimeInStateMs = stat;
+        ++numFieldsRead;
+    }
+    if (extractStat(buf, "cumulative_total_on_time_ms:", &stat)) {
+        result[0].totalTimeInStateMs = stat;
+        ++numFieldsRead;
+    }
+    if (extractStat(buf, "deep_sleep_enter_counter:", &stat)) {
+        result[0].totalStateEntryCount = stat;
+        result[1].totalStateEntryCount = stat;
+        ++numFieldsRead;
+    }
+    if (extractStat(buf, "last_deep_sleep_enter_tstamp_ms:", &stat)) {
+        result[1].lastEntryTimestampMs = stat;
+        ++numFieldsRead;
+    }
 
-    // End of file was reached and not all state data was parsed. Something
-    // went wrong
-    if (numFieldsRead != numFields) {
+    // Not all state data was present in the readback. Something went wrong
+    if (numFieldsRead != 4) {
         LOG(ERROR) << __func__ << ": failed to parse stats for wlan";
         return false;
     }
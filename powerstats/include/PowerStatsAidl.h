@@ -18,6 +18,9 @@
 
 #include <aidl/android/hardware/power/stats/BnPowerStats.h>
 
+#include <chrono>
+#include <deque>
+#include <mutex>
 #include <optional>
 #include <unordered_map>
 
@@ -58,6 +61,14 @@ class PowerStats : public BnPowerStats {
     void addStateResidencyDataProvider(std::unique_ptr<IStateResidencyDataProvider> p);
     void addEnergyConsumer(std::unique_ptr<IEnergyConsumer> p);
     void setEnergyMeterDataProvider(std::unique_ptr<IEnergyMeterDataProvider> p);
+    /*
+     * Optionally record periodic residency snapshots into a fixed-budget,
+     * delta-compressed ring; hours of history at near-zero steady-state cost
+     * with no client polling loop. Dump the raw bytes with
+     * "dumpsys <service> residency-history" and decode offline. Call once,
+     * after all providers are registered.
+     */
+    void enableResidencyHistory(uint32_t intervalMs);
 
     // Methods from aidl::android::hardware::power::stats::IPowerStats
     ndk::ScopedAStatus getPowerEntityInfo(std::vector<PowerEntity> *_aidl_return) override;
@@ -72,19 +83,43 @@ class PowerStats : public BnPowerStats {
     binder_status_t dump(int fd, const char **args, uint32_t numArgs) override;
 
   private:
+    /*
+     * Per-provider residency cache. Holding the entry lock across the
+     * provider read collapses concurrent queries for the same provider into
+     * one sysfs pass (single-flight): waiters block briefly and then serve
+     * the freshly stamped result from memory.
+     */
+    struct ResidencyCache {
+        std::mutex lock;
+        std::chrono::steady_clock::time_point lastUpdate;
+        bool valid = false;
+        std::unordered_map<std::string, std::vector<StateResidency>> residencies;
+    };
+
+    ndk::ScopedAStatus getStateResidencyInternal(const std::vector<int32_t> &in_powerEntityIds,
+                                                 std::vector<StateResidencyResult> *_aidl_return,
+                                                 bool forceRefresh);
+    void readProviderResidencies(
+            size_t providerIndex, bool forceRefresh,
+            std::unordered_map<std::string, std::vector<StateResidency>> *stateResidencies);
+    void getStateResidenciesConcurrently(
+            const std::vector<size_t> &providerIndexes, bool forceRefresh,
+            std::unordered_map<std::string, std::vector<StateResidency>> *stateResidencies);
     void getEntityStateNames(
             std::unordered_map<int32_t, std::string> *entityNames,
             std::unordered_map<int32_t, std::unordered_map<int32_t, std::string>> *stateNames);
     void getChannelNames(std::unordered_map<int32_t, std::string> *channelNames);
-    void dumpStateResidency(std::ostringstream &oss, bool delta);
-    void dumpStateResidencyDelta(std::ostringstream &oss,
-                                 const std::vector<StateResidencyResult> &results);
-    void dumpStateResidencyOneShot(std::ostringstream &oss,
-                                   const std::vector<StateResidencyResult> &results);
-    void dumpEnergyConsumer(std::ostringstream &oss, bool delta);
-    void dumpEnergyMeter(std::ostringstream &oss, bool delta);
+    void dumpStateResidency(int fd, bool delta);
+    void dumpEnergyConsumer(int fd, bool delta);
+    void dumpEnergyMeter(int fd, bool delta);
+    void residencyHistoryLoop(uint32_t intervalMs);
+    void appendHistoryRecord(const std::vector<StateResidencyResult> &results,
+                             uint64_t timestampMs);
+    void dumpResidencyHistory(int fd);
 
     std::vector<std::unique_ptr<IStateResidencyDataProvider>> mStateResidencyDataProviders;
+    /* One cache entry per provider, parallel to mStateResidencyDataProviders */
+    std::vector<std::unique_ptr<ResidencyCache>> mResidencyCaches;
     std::vector<PowerEntity> mPowerEntityInfos;
     /* Index that maps each power entity id to an entry in mStateResidencyDataProviders */
     std::vector<size_t> mStateResidencyDataProviderIndex;
@@ -93,6 +128,18 @@ class PowerStats : public BnPowerStats {
     std::vector<EnergyConsumer> mEnergyConsumerInfos;
 
     std::unique_ptr<IEnergyMeterDataProvider> mEnergyMeterDataProvider;
+
+    /*
+     * Residency history ring: varint-encoded records, oldest first. Key
+     * frames carry absolute values and the layout; the records between them
+     * carry zigzag deltas against the previous snapshot.
+     */
+    std::mutex mHistoryLock;
+    std::deque<std::vector<uint8_t>> mHistoryRecords;
+    size_t mHistoryBytes = 0;
+    uint32_t mHistoryRecordsSinceKeyFrame = 0;
+    std::vector<StateResidencyResult> mHistoryPrevious;
+    uint64_t mHistoryPreviousTimestampMs = 0;
 };
 
 }  // namespace stats
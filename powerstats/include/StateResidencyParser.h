@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android-base/logging.h>
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Header-only, zero-copy parsing core shared by the legacy
+ * (pixelpowerstats) and AIDL (dataproviders) GenericStateResidencyData
+ * providers. Both trees consume the same sysfs format - a header line per
+ * entity/state followed by "<prefix><number>" stat lines - and both parse it
+ * on every getStateResidencies/getResults call, so the matching is compiled
+ * once from the config and each line is examined without allocating.
+ *
+ * The two providers keep their own config and result types; everything here
+ * is generic over them, relying on the shared field names
+ * ({entryCount,totalTime,lastEntry}{Supported,Prefix,Transform} on configs,
+ * totalStateEntryCount/totalTimeInStateMs/lastEntryTimestampMs on results).
+ */
+namespace android {
+namespace hardware {
+namespace google {
+namespace pixel {
+namespace powerstats {
+namespace parser {
+
+/* Returns the view of s with surrounding whitespace removed; never copies. */
+inline std::string_view trim(std::string_view s) {
+    while (!s.empty() && isspace(static_cast<unsigned char>(s.front()))) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && isspace(static_cast<unsigned char>(s.back()))) {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+/*
+ * Header lookup compiled from a config: candidates are bucketed by first
+ * character so each line is compared against only the headers sharing its
+ * leading byte, and the comparison is a length check plus memcmp on the
+ * trimmed view.
+ */
+class HeaderMatcher {
+  public:
+    /*
+     * Registers header under index. The header string must outlive the
+     * matcher (the owning config is expected to be const).
+     */
+    void add(const std::string &header, int32_t index) {
+        if (header.empty()) {
+            if (mEmptyIndex < 0) {
+                mEmptyIndex = index;
+            }
+            return;
+        }
+        mBuckets[static_cast<unsigned char>(header[0])].push_back({&header, index});
+    }
+
+    /* Returns the index registered for the matching header, or -1. */
+    int32_t match(std::string_view line) const {
+        std::string_view trimmed = trim(line);
+        if (trimmed.empty()) {
+            return -1;
+        }
+        for (const auto &candidate : mBuckets[static_cast<unsigned char>(trimmed[0])]) {
+            if (candidate.header->size() == trimmed.size() &&
+                memcmp(candidate.header->data(), trimmed.data(), trimmed.size()) == 0) {
+                return candidate.index;
+            }
+        }
+        return -1;
+    }
+
+    /* Index registered with an empty header ("no header to look for"). */
+    int32_t emptyIndex() const { return mEmptyIndex; }
+
+  private:
+    struct Candidate {
+        const std::string *header;
+        int32_t index;
+    };
+    std::array<std::vector<Candidate>, 256> mBuckets;
+    int32_t mEmptyIndex = -1;
+};
+
+inline bool extractStat(const char *line, const std::string &prefix, uint64_t *stat) {
+    char const *prefixStart = strstr(line, prefix.c_str());
+    if (prefixStart == nullptr) {
+        // Did not find the given prefix
+        return false;
+    }
+
+    *stat = strtoull(prefixStart + prefix.length(), nullptr, 0);
+    return true;
+}
+
+/*
+ * Advances through the file until a line matches the matcher; returns the
+ * matched index, the empty-header index without consuming input, or -1 at
+ * end of file.
+ */
+inline int32_t findNextIndex(const HeaderMatcher &matcher, FILE *fp, char **line, size_t *len) {
+    int32_t index = matcher.emptyIndex();
+    if (index >= 0) {
+        return index;
+    }
+
+    while (getline(line, len, fp) != -1) {
+        index = matcher.match(*line);
+        if (index >= 0) {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Reads the stat lines following a matched state header into data. Returns
+ * false if end of file is reached before every supported field was seen.
+ */
+template <typename DataT, typename ConfigT>
+bool parseState(DataT *data, const ConfigT &config, FILE *fp, char **line, size_t *len) {
+    size_t numFieldsRead = 0;
+    const size_t numFields =
+            config.entryCountSupported + config.totalTimeSupported + config.lastEntrySupported;
+
+    while ((numFieldsRead < numFields) && (getline(line, len, fp) != -1)) {
+        uint64_t stat = 0;
+        // Attempt to extract data from the current line
+        if (config.entryCountSupported && extractStat(*line, config.entryCountPrefix, &stat)) {
+            data->totalStateEntryCount =
+                    config.entryCountTransform ? config.entryCountTransform(stat) : stat;
+            ++numFieldsRead;
+        } else if (config.totalTimeSupported && extractStat(*line, config.totalTimePrefix, &stat)) {
+            data->totalTimeInStateMs =
+                    config.totalTimeTransform ? config.totalTimeTransform(stat) : stat;
+            ++numFieldsRead;
+        } else if (config.lastEntrySupported && extractStat(*line, config.lastEntryPrefix, &stat)) {
+            data->lastEntryTimestampMs =
+                    config.lastEntryTransform ? config.lastEntryTransform(stat) : stat;
+            ++numFieldsRead;
+        }
+    }
+
+    // End of file was reached and not all state data was parsed. Something
+    // went wrong
+    if (numFieldsRead != numFields) {
+        LOG(ERROR) << "Failed to parse stats for " << config.name;
+        return false;
+    }
+
+    return true;
+}
+
+}  // namespace parser
+}  // namespace powerstats
+}  // namespace pixel
+}  // namespace google
+}  // namespace hardware
+}  // namespace android
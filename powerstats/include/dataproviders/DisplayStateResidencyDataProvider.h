@@ -21,9 +21,9 @@
 #include <utils/Looper.h>
 #include <utils/Thread.h>
 
+#include <atomic>
 #include <cstdio>
 #include <cstring>
-#include <mutex>
 #include <thread>
 #include <unordered_map>
 
@@ -52,6 +52,9 @@ class DisplayStateResidencyDataProvider : public PowerStats::IStateResidencyData
     void pollLoop();
     // Main function to update the stats when display state change is detected
     void updateStats();
+    // Fold the elapsed time of the current state into its residency counter.
+    // Must only be called from the poll thread inside a write section.
+    void foldCurrentState(uint64_t nowMs);
 
     // File descriptor of display state
     int mFd;
@@ -61,12 +64,18 @@ class DisplayStateResidencyDataProvider : public PowerStats::IStateResidencyData
     const std::string mName;
     // List of states to track indexed by mCurState
     std::vector<std::string> mStates;
-    // Lock to protect concurrent read/write to mResidencies and mCurState
-    std::mutex mLock;
+    // Sequence counter protecting mResidencies, mCurState and mCurStateSinceMs:
+    // odd while the poll thread (the only writer) is updating them, even when
+    // they are stable. Readers retry on a torn snapshot instead of blocking,
+    // so queries never stall the poll thread.
+    std::atomic<uint32_t> mSeq;
     // Accumulated display state stats indexed by mCurState
     std::vector<StateResidency> mResidencies;
     // Index of current state
     int mCurState;
+    // Timestamp up to which the current state's residency has been folded
+    // into mResidencies
+    uint64_t mCurStateSinceMs;
     // Looper to facilitate polling of display state file desciptor
     ::android::sp<::android::Looper> mLooper;
 
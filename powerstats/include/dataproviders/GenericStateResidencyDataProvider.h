@@ -17,6 +17,7 @@
 #pragma once
 
 #include <PowerStatsAidl.h>
+#include <StateResidencyParser.h>
 
 namespace aidl {
 namespace android {
@@ -58,7 +59,9 @@ class GenericStateResidencyDataProvider : public PowerStats::IStateResidencyData
 
     GenericStateResidencyDataProvider(const std::string &path,
                                       const std::vector<PowerEntityConfig> &configs)
-        : mPath(std::move(path)), mPowerEntityConfigs(std::move(configs)) {}
+        : mPath(std::move(path)), mPowerEntityConfigs(std::move(configs)) {
+        compileMatchers();
+    }
     ~GenericStateResidencyDataProvider() = default;
 
     // Methods from PowerStats::IStateResidencyDataProvider
@@ -67,8 +70,20 @@ class GenericStateResidencyDataProvider : public PowerStats::IStateResidencyData
     std::unordered_map<std::string, std::vector<State>> getInfo() override;
 
   private:
+    /* The zero-copy matching and stat parsing live in StateResidencyParser.h,
+     * shared with the legacy pixelpowerstats provider. */
+    using HeaderMatcher = ::android::hardware::google::pixel::powerstats::parser::HeaderMatcher;
+
+    void compileMatchers();
+    bool getStateData(std::vector<StateResidency> *result, size_t configIndex, FILE *fp,
+                      char **line, size_t *len) const;
+
     const std::string mPath;
     const std::vector<PowerEntityConfig> mPowerEntityConfigs;
+    /* Compiled once at construction; mPowerEntityConfigs owns the header
+     * strings and is const, so the candidate pointers stay valid. */
+    HeaderMatcher mEntityMatcher;
+    std::vector<HeaderMatcher> mStateMatchers;  // parallel to mPowerEntityConfigs
 };
 
 std::vector<GenericStateResidencyDataProvider::StateResidencyConfig>
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <PowerStatsAidl.h>
+#include <android-base/unique_fd.h>
 
 #include <unordered_map>
 
@@ -38,15 +39,27 @@ class IioEnergyMeterDataProvider : public PowerStats::IEnergyMeterDataProvider {
 
   private:
     void findIioEnergyMeterNodes();
+    // The device set cannot change within a boot, so the enumeration result
+    // is cached in a file tagged with the boot id and the iio root dir mtime.
+    // A matching tag lets a HAL restart skip the readdir walk and the
+    // per-device name reads, which gates early-boot energy accounting.
+    std::string cacheTag();
+    bool loadCachedEnergyMeterNodes(const std::string &tag);
+    void saveCachedEnergyMeterNodes(const std::string &tag);
     void parseEnabledRails();
-    int parseEnergyValue(std::string path);
+    void openEnergyValueNodes();
+    int parseEnergyValue(const std::string &path);
     int parseEnergyContents(const std::string &contents);
 
     std::mutex mLock;
     std::unordered_map<std::string, std::string> mDevicePaths;  // key: path, value: device name
+    // Persistent energy_value fds, keyed by device path. Each read starts at
+    // offset 0, which makes sysfs regenerate the contents.
+    std::unordered_map<std::string, ::android::base::unique_fd> mEnergyValueFds;
     std::unordered_map<std::string, int32_t> mChannelIds;  // key: name, value: id
     std::vector<Channel> mChannelInfos;
     std::vector<EnergyMeasurement> mReading;
+    std::string mContents;  // preallocated energy_value read buffer
 
     const std::vector<const std::string> kDeviceNames;
     const std::string kDeviceType = "iio:device";
@@ -54,6 +67,8 @@ class IioEnergyMeterDataProvider : public PowerStats::IEnergyMeterDataProvider {
     const std::string kNameNode = "/name";
     const std::string kEnabledRailsNode = "/enabled_rails";
     const std::string kEnergyValueNode = "/energy_value";
+    const std::string kCacheDir = "/data/vendor/powerstats";
+    const std::string kCachePath = "/data/vendor/powerstats/iio_devices.cache";
 };
 
 }  // namespace stats
@@ -22,6 +22,8 @@
 
 #include <android/binder_manager.h>
 
+#include <chrono>
+
 using ::aidl::android::vendor::powerstats::BnPixelStateResidencyProvider;
 using ::aidl::android::vendor::powerstats::IPixelStateResidencyCallback;
 
@@ -90,8 +92,16 @@ class PixelStateResidencyDataProvider : public PowerStats::IStateResidencyDataPr
     ::ndk::ScopedAStatus unregisterCallback(
             const std::shared_ptr<IPixelStateResidencyCallback> &in_cb);
 
-    ::ndk::ScopedAStatus getStateResidenciesTimed(const Entry &entry,
-                                                  std::vector<StateResidency> *residency);
+    ::ndk::ScopedAStatus getStateResidenciesTimed(
+            const std::string &name, const std::shared_ptr<IPixelStateResidencyCallback> &callback,
+            std::vector<StateResidency> *residency);
+
+    // Upper bound on how long getStateResidencies waits for all callback
+    // replies. The callback interface is synchronous two-way AIDL, so the
+    // queries are fanned out on one thread per entry; a reply that misses
+    // the deadline is dropped for that cycle instead of serializing the
+    // whole query behind one slow client.
+    static constexpr std::chrono::milliseconds kGetResidencyDeadline{100};
 
     const std::string kInstance = "power.stats-vendor";
     std::mutex mLock;
@@ -92,6 +92,10 @@ class PowerStatsEnergyConsumer : public PowerStats::IEnergyConsumer {
     std::unordered_map<int32_t, int64_t> mUidEnergySS;
     int64_t mTotalEnergySS = 0;
     std::map<int32_t, int32_t> mCoefficients;  // key = stateId, val = coefficients (mW)
+    // mCoefficients flattened into a stateId-indexed array (0 = no coefficient),
+    // so the per-uid attribution loop is a plain dot product over contiguous
+    // arrays instead of two map lookups per state. Built lazily on first use.
+    std::vector<int32_t> mFlatCoefficients;
 };
 
 }  // namespace stats
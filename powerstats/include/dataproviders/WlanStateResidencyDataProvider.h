@@ -17,6 +17,8 @@
 #pragma once
 
 #include <PowerStatsAidl.h>
+#include <android-base/properties.h>
+#include <android-base/unique_fd.h>
 
 namespace aidl {
 namespace android {
@@ -36,8 +38,15 @@ class WlanStateResidencyDataProvider : public PowerStats::IStateResidencyDataPro
     std::unordered_map<std::string, std::vector<State>> getInfo() override;
 
   private:
+    bool ensureStatsFd();
+
     const std::string mName;
     const std::string mPath;
+    // The stats node is opened once and reused across queries; a failed read
+    // (e.g. after a driver reload invalidates the node) drops the fd and
+    // reopens it, so repeated residency queries amortize the setup cost.
+    ::android::base::unique_fd mStatsFd;
+    ::android::base::CachedProperty mDriverStatus{"wlan.driver.status"};
 };
 
 }  // namespace stats
@@ -17,6 +17,7 @@
 #ifndef HARDWARE_GOOGLE_PIXEL_POWERSTATS_GENERICSTATERESIDENCYDATAPROVIDER_H
 #define HARDWARE_GOOGLE_PIXEL_POWERSTATS_GENERICSTATERESIDENCYDATAPROVIDER_H
 // TODO(b/167628903): Delete this file
+#include <StateResidencyParser.h>
 #include <pixelpowerstats/PowerStats.h>
 
 namespace android {
@@ -64,8 +65,21 @@ class GenericStateResidencyDataProvider : public IStateResidencyDataProvider {
     std::vector<PowerEntityStateSpace> getStateSpaces() override;
 
   private:
+    using HeaderMatcher = parser::HeaderMatcher;
+
+    /* Rebuilds the matchers from mPowerEntityConfigs. Compiled lazily on the
+     * first getResults() after addEntity(), since growing the config vector
+     * would invalidate the header pointers the matchers hold. */
+    void compileMatchers();
+    bool getStateData(PowerEntityStateResidencyResult *result,
+                      const std::vector<std::pair<uint32_t, StateResidencyConfig>> &configs,
+                      const HeaderMatcher &matcher, FILE *fp, char **line, size_t *len) const;
+
     const std::string mPath;
     std::vector<std::pair<uint32_t, PowerEntityConfig>> mPowerEntityConfigs;
+    bool mMatchersCompiled = false;
+    HeaderMatcher mEntityMatcher;
+    std::vector<HeaderMatcher> mStateMatchers;  // parallel to mPowerEntityConfigs
 };
 
 std::vector<StateResidencyConfig> generateGenericStateResidencyConfigs(
@@ -18,11 +18,132 @@
 #include "PowerStatsCollector.h"
 
 #include <android-base/logging.h>
+#include <google/protobuf/arena.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
 
 void PowerStatsCollector::addDataProvider(std::unique_ptr<IPowerStatProvider> p) {
     mStatProviders.emplace(p->typeOf(), std::move(p));
 }
 
+namespace {
+
+/**
+ * Result slot for one provider call. The call runs on its own thread; a
+ * wedged power stats HAL call cannot be cancelled, so on timeout the thread
+ * is abandoned and the slot it co-owns simply outlives the abandonment.
+ */
+struct ProviderCall {
+    std::mutex lock;
+    std::condition_variable cv;
+    bool done = false;
+    int ret = 1;
+    PowerStatistic stat;
+};
+
+/** Per-provider budget for one snapshot. */
+constexpr std::chrono::milliseconds kProviderTimeout(5000);
+
+/**
+ * Runs every call concurrently and waits until each has finished or the
+ * budget has elapsed. The deadline is shared: calls run in parallel, so each
+ * provider gets the full budget rather than its predecessors' leftovers.
+ * Slots whose call timed out come back with done == false; their worker may
+ * still complete later, which is why the closures must own everything they
+ * touch apart from the providers themselves (pwrstats_util is a one-shot
+ * tool, so the collector outlives any abandoned call that matters).
+ */
+std::vector<std::shared_ptr<ProviderCall>> runProviderCalls(
+        const std::vector<std::function<int(PowerStatistic*)>>& calls) {
+    std::vector<std::shared_ptr<ProviderCall>> slots;
+    slots.reserve(calls.size());
+    for (const auto& call : calls) {
+        auto slot = std::make_shared<ProviderCall>();
+        slots.emplace_back(slot);
+        std::thread([slot, call]() {
+            int ret = call(&slot->stat);
+            std::lock_guard<std::mutex> lg(slot->lock);
+            slot->ret = ret;
+            slot->done = true;
+            slot->cv.notify_all();
+        }).detach();
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + kProviderTimeout;
+    for (auto& slot : slots) {
+        std::unique_lock<std::mutex> ul(slot->lock);
+        slot->cv.wait_until(ul, deadline, [&]() { return slot->done; });
+    }
+    return slots;
+}
+
+}  // namespace
+
+int PowerStatsCollector::snapshot(std::ostream* output, bool humanReadable) const {
+    if (!output) {
+        LOG(ERROR) << __func__ << ": bad args; output is null";
+        return 1;
+    }
+
+    // All messages live on the arena and are freed in one shot when it goes
+    // out of scope; getting and serializing a stat never deep-copies it.
+    google::protobuf::Arena arena;
+    std::mutex lock;
+    std::condition_variable cv;
+    std::queue<const PowerStatistic*> ready;
+    bool done = false;
+
+    std::thread writer([&]() {
+        while (true) {
+            const PowerStatistic* stat;
+            {
+                std::unique_lock<std::mutex> ul(lock);
+                cv.wait(ul, [&]() { return done || !ready.empty(); });
+                if (ready.empty()) {
+                    return;
+                }
+                stat = ready.front();
+                ready.pop();
+            }
+            if (humanReadable) {
+                mStatProviders.at(stat->power_stat_case())->dump(*stat, output);
+            } else {
+                stat->SerializeToOstream(output);
+            }
+        }
+    });
+
+    int ret = 0;
+    for (auto&& provider : mStatProviders) {
+        PowerStatistic* stat = google::protobuf::Arena::CreateMessage<PowerStatistic>(&arena);
+        if (provider.second->get(stat) != 0) {
+            LOG(ERROR) << __func__ << ": a data provider failed";
+            ret = 1;
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lg(lock);
+            ready.push(stat);
+        }
+        cv.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lg(lock);
+        done = true;
+    }
+    cv.notify_one();
+    writer.join();
+
+    return ret;
+}
+
 int PowerStatsCollector::get(std::vector<PowerStatistic>* stats) const {
     if (!stats) {
         LOG(ERROR) << __func__ << ": bad args; stat is null";
@@ -30,15 +151,35 @@ int PowerStatsCollector::get(std::vector<PowerStatistic>* stats) const {
     }
 
     stats->clear();
+
+    std::vector<std::function<int(PowerStatistic*)>> calls;
+    calls.reserve(mStatProviders.size());
+    for (auto&& provider : mStatProviders) {
+        calls.emplace_back(
+                [p = provider.second.get()](PowerStatistic* stat) { return p->get(stat); });
+    }
+    auto slots = runProviderCalls(calls);
+
+    size_t i = 0;
     for (auto&& provider : mStatProviders) {
-        PowerStatistic stat;
-        if (provider.second->get(&stat) != 0) {
+        auto& slot = slots[i++];
+        std::lock_guard<std::mutex> lg(slot->lock);
+        if (!slot->done) {
+            LOG(ERROR) << __func__ << ": provider for stat case " << provider.first
+                       << " timed out; reporting partial results";
+            continue;
+        }
+        if (slot->ret != 0) {
             LOG(ERROR) << __func__ << ": a data provider failed";
-            stats->clear();
-            return 1;
+            continue;
         }
+        stats->emplace_back(slot->stat);
+    }
 
-        stats->emplace_back(stat);
+    // Degrade to a partial snapshot rather than none; fail only when every
+    // provider came up empty.
+    if (stats->empty() && !mStatProviders.empty()) {
+        return 1;
     }
     return 0;
 }
@@ -51,6 +192,9 @@ int PowerStatsCollector::get(const std::vector<PowerStatistic>& start,
     }
 
     interval->clear();
+
+    std::vector<std::function<int(PowerStatistic*)>> calls;
+    calls.reserve(start.size());
     for (auto const& curStat : start) {
         auto provider = mStatProviders.find(curStat.power_stat_case());
         if (provider == mStatProviders.end()) {
@@ -59,13 +203,33 @@ int PowerStatsCollector::get(const std::vector<PowerStatistic>& start,
             return 1;
         }
 
-        PowerStatistic curInterval;
-        if (provider->second->get(curStat, &curInterval) != 0) {
+        // curStat is copied into the closure: an abandoned call may outlive
+        // the caller's start vector.
+        calls.emplace_back([p = provider->second.get(), curStat](PowerStatistic* out) {
+            return p->get(curStat, out);
+        });
+    }
+    auto slots = runProviderCalls(calls);
+
+    for (size_t i = 0; i < slots.size(); ++i) {
+        auto& slot = slots[i];
+        std::lock_guard<std::mutex> lg(slot->lock);
+        if (!slot->done) {
+            LOG(ERROR) << __func__ << ": provider for stat case " << start[i].power_stat_case()
+                       << " timed out; reporting partial results";
+            continue;
+        }
+        if (slot->ret != 0) {
             LOG(ERROR) << __func__ << ": a data provider failed";
-            interval->clear();
-            return 1;
+            continue;
         }
-        interval->emplace_back(curInterval);
+        interval->emplace_back(slot->stat);
+    }
+
+    // Degrade to a partial interval rather than none; fail only when every
+    // provider came up empty.
+    if (interval->empty() && !start.empty()) {
+        return 1;
     }
     return 0;
 }
@@ -50,9 +50,21 @@ class IPowerStatProvider {
 class PowerStatsCollector {
   public:
     PowerStatsCollector() = default;
+    /**
+     * Providers are queried concurrently with a per-provider timeout; a
+     * wedged provider degrades the result to the stats that did arrive
+     * instead of hanging the caller. Returns nonzero only when nothing could
+     * be collected.
+     **/
     int get(std::vector<PowerStatistic>* stats) const;
     int get(const std::vector<PowerStatistic>& start, std::vector<PowerStatistic>* interval) const;
     void dump(const std::vector<PowerStatistic>& stats, std::ostream* output) const;
+    /**
+     * One-shot snapshot: messages are arena-allocated and handed to a writer
+     * thread as each provider completes, so serialization of one provider's
+     * stats overlaps the next provider's I/O and nothing is deep-copied.
+     **/
+    int snapshot(std::ostream* output, bool humanReadable) const;
     void addDataProvider(std::unique_ptr<IPowerStatProvider> statProvider);
 
   private:
@@ -42,9 +42,26 @@ int StateResidencyInterval(const StateResidency_Residency& startResidency,
 }
 
 void StateResidencyDump(const StateResidency_Residency& stateResidency, std::ostream* output) {
+    // Build the whole table in one reserved buffer and hand it to the stream
+    // in a single write. The old per-row operator<< chain with std::endl
+    // flushed the stream on every row, which dominated dump time on large
+    // residency tables.
+    size_t estimate = 2;
     for (auto const& residency : stateResidency) {
-        *output << residency.entity_name() << ":" << residency.state_name() << "="
-                << residency.time_ms() << std::endl;
+        estimate += residency.entity_name().size() + residency.state_name().size() + 24;
     }
-    *output << std::endl;
+
+    std::string table;
+    table.reserve(estimate);
+    for (auto const& residency : stateResidency) {
+        table += residency.entity_name();
+        table += ':';
+        table += residency.state_name();
+        table += '=';
+        table += std::to_string(residency.time_ms());
+        table += '\n';
+    }
+    table += '\n';
+
+    output->write(table.data(), table.size());
 }
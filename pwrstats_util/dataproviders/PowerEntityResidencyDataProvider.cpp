@@ -118,7 +118,7 @@ int PowerEntityResidencyDataProvider::getImpl(const PowerStatistic& start,
 
 void PowerEntityResidencyDataProvider::dumpImpl(const PowerStatistic& stat,
                                                 std::ostream* output) const {
-    *output << "Power Entity State Residencies:" << std::endl;
+    *output << "Power Entity State Residencies:\n";
     StateResidencyDump(stat.power_entity_state_residency().residency(), output);
 }
 
@@ -111,11 +111,24 @@ int RailEnergyDataProvider::getImpl(const PowerStatistic& start, PowerStatistic*
 }
 
 void RailEnergyDataProvider::dumpImpl(const PowerStatistic& stat, std::ostream* output) const {
-    *output << "Rail Energy:" << std::endl;
+    // Single reserved buffer, single stream write; see StateResidencyDump.
+    size_t estimate = sizeof("Rail Energy:\n") + 1;
     for (auto const& rail : stat.rail_energy().entry()) {
-        *output << rail.rail_name() << "=" << rail.energy_uws() << std::endl;
+        estimate += rail.rail_name().size() + 24;
     }
-    *output << std::endl;
+
+    std::string table;
+    table.reserve(estimate);
+    table += "Rail Energy:\n";
+    for (auto const& rail : stat.rail_energy().entry()) {
+        table += rail.rail_name();
+        table += '=';
+        table += std::to_string(rail.energy_uws());
+        table += '\n';
+    }
+    table += '\n';
+
+    output->write(table.data(), table.size());
 }
 
 PowerStatCase RailEnergyDataProvider::typeOf() const {
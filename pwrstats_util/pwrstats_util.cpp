@@ -18,15 +18,21 @@
 #include <android-base/logging.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <stddef.h>
+#include <string.h>
 #include <sys/resource.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/un.h>
 
 #include <algorithm>
 #include <chrono>
 #include <csignal>
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <unordered_map>
 
 #include <pwrstatsutil.pb.h>
 #include "PowerStatsCollector.h"
@@ -43,17 +49,29 @@ class Options {
   public:
     bool humanReadable;
     bool daemonMode;
+    bool serverMode;
+    bool clientMode;
     std::string filePath;
+    std::string socketName;
+    std::string checkpointName;
+    std::string queryName;
 };
 
 static Options parseArgs(int argc, char** argv) {
     Options opt = {
             .humanReadable = false,
             .daemonMode = false,
+            .serverMode = false,
+            .clientMode = false,
+            .socketName = "pwrstats_util",
     };
 
     static struct option long_options[] = {/* These options set a flag. */
                                            {"human-readable", no_argument, 0, 0},
+                                           {"server", no_argument, 0, 0},
+                                           {"socket", required_argument, 0, 0},
+                                           {"checkpoint", required_argument, 0, 0},
+                                           {"query", required_argument, 0, 0},
                                            {"daemon", required_argument, 0, 'd'},
                                            {0, 0, 0, 0}};
 
@@ -63,11 +81,23 @@ static Options parseArgs(int argc, char** argv) {
     int c;
     while ((c = getopt_long(argc, argv, "d:", long_options, &option_index)) != -1) {
         switch (c) {
-            case 0:
-                if ("human-readable" == std::string(long_options[option_index].name)) {
+            case 0: {
+                std::string name(long_options[option_index].name);
+                if ("human-readable" == name) {
                     opt.humanReadable = true;
+                } else if ("server" == name) {
+                    opt.serverMode = true;
+                } else if ("socket" == name) {
+                    opt.socketName = std::string(optarg);
+                } else if ("checkpoint" == name) {
+                    opt.clientMode = true;
+                    opt.checkpointName = std::string(optarg);
+                } else if ("query" == name) {
+                    opt.clientMode = true;
+                    opt.queryName = std::string(optarg);
                 }
                 break;
+            }
             case 'd':
                 opt.daemonMode = true;
                 opt.filePath = std::string(optarg);
@@ -78,6 +108,17 @@ static Options parseArgs(int argc, char** argv) {
                           << "--daemon <path/to/file>, -d <path/to/file>: daemon mode. Spawns a "
                              "daemon process and prints out its <pid>. kill -INT <pid> will "
                              "trigger a write to specified file."
+                          << std::endl
+                          << "--server: spawns a persistent daemon serving checkpoint/query "
+                             "commands over an abstract unix socket, so repeated queries skip "
+                             "process start and provider discovery"
+                          << std::endl
+                          << "--checkpoint <name>: records current stats under <name> in the "
+                             "server"
+                          << std::endl
+                          << "--query <name>: prints stats accumulated since checkpoint <name>"
+                          << std::endl
+                          << "--socket <name>: abstract socket name (default: pwrstats_util)"
                           << std::endl;
                 exit(EXIT_FAILURE);
         }
@@ -85,25 +126,87 @@ static Options parseArgs(int argc, char** argv) {
     return opt;
 }
 
-static void snapshot(const Options& opt, const PowerStatsCollector& collector) {
-    std::vector<PowerStatistic> stats;
-    int ret = collector.get(&stats);
-    if (ret) {
-        exit(EXIT_FAILURE);
+/* Abstract-namespace unix socket: no filesystem node, no stale path cleanup */
+static socklen_t makeSocketAddr(const std::string& name, struct sockaddr_un* addr) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    size_t len = std::min(name.size(), sizeof(addr->sun_path) - 2);
+    memcpy(addr->sun_path + 1, name.data(), len);
+    return offsetof(struct sockaddr_un, sun_path) + 1 + len;
+}
+
+static bool writeAll(int fd, const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = TEMP_FAILURE_RETRY(write(fd, data.data() + written, data.size() - written));
+        if (n <= 0) {
+            return false;
+        }
+        written += n;
     }
+    return true;
+}
 
-    if (opt.humanReadable) {
-        collector.dump(stats, &std::cout);
-    } else {
-        for (const auto& stat : stats) {
-            stat.SerializeToOstream(&std::cout);
+static void handleClient(int fd, const PowerStatsCollector& collector,
+                         std::unordered_map<std::string, std::vector<PowerStatistic>>* checkpoints) {
+    char buf[256];
+    ssize_t n = TEMP_FAILURE_RETRY(read(fd, buf, sizeof(buf) - 1));
+    if (n <= 0) {
+        return;
+    }
+    buf[n] = '\0';
+    std::string cmd(buf);
+    while (!cmd.empty() && (cmd.back() == '\n' || cmd.back() == '\r')) {
+        cmd.pop_back();
+    }
+
+    std::ostringstream response;
+    if (cmd.rfind("checkpoint ", 0) == 0) {
+        std::string name = cmd.substr(strlen("checkpoint "));
+        std::vector<PowerStatistic> stats;
+        if (collector.get(&stats) != 0) {
+            response << "error: collection failed" << std::endl;
+        } else {
+            (*checkpoints)[name] = std::move(stats);
+            response << "ok" << std::endl;
+        }
+    } else if (cmd.rfind("diff ", 0) == 0 || cmd.rfind("diff-human ", 0) == 0) {
+        bool human = cmd.rfind("diff-human ", 0) == 0;
+        std::string name = cmd.substr(human ? strlen("diff-human ") : strlen("diff "));
+        auto checkpoint = checkpoints->find(name);
+        if (checkpoint == checkpoints->end()) {
+            response << "error: unknown checkpoint " << name << std::endl;
+        } else {
+            std::vector<PowerStatistic> interval;
+            if (collector.get(checkpoint->second, &interval) != 0) {
+                response << "error: collection failed" << std::endl;
+            } else if (human) {
+                collector.dump(interval, &response);
+            } else {
+                for (const auto& stat : interval) {
+                    stat.SerializeToOstream(&response);
+                }
+            }
         }
+    } else {
+        response << "error: unknown command" << std::endl;
+    }
+
+    writeAll(fd, response.str());
+}
+
+static void snapshot(const Options& opt, const PowerStatsCollector& collector) {
+    // Streams each provider's stats as it completes; see
+    // PowerStatsCollector::snapshot
+    int ret = collector.snapshot(&std::cout, opt.humanReadable);
+    if (ret) {
+        exit(EXIT_FAILURE);
     }
 
     exit(EXIT_SUCCESS);
 }
 
-static void daemon(const Options& opt, const PowerStatsCollector& collector) {
+static void daemonize() {
     // Following a subset of steps outlined in http://man7.org/linux/man-pages/man7/daemon.7.html
 
     // Call fork to create child process
@@ -154,6 +257,91 @@ static void daemon(const Options& opt, const PowerStatsCollector& collector) {
         LOG(ERROR) << "can't change directory to /" << std::endl;
         exit(EXIT_FAILURE);
     }
+}
+
+static void server(const Options& opt, const PowerStatsCollector& collector) {
+    daemonize();
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        PLOG(ERROR) << "can't create server socket";
+        exit(EXIT_FAILURE);
+    }
+
+    struct sockaddr_un addr;
+    socklen_t addrLen = makeSocketAddr(opt.socketName, &addr);
+    if (bind(listenFd, reinterpret_cast<struct sockaddr*>(&addr), addrLen) < 0) {
+        PLOG(ERROR) << "can't bind server socket " << opt.socketName;
+        exit(EXIT_FAILURE);
+    }
+    if (listen(listenFd, 4) < 0) {
+        PLOG(ERROR) << "can't listen on server socket";
+        exit(EXIT_FAILURE);
+    }
+
+    // Checkpoints persist for the daemon's lifetime; a query costs one
+    // socket round trip plus a provider read instead of a fork+collect
+    std::unordered_map<std::string, std::vector<PowerStatistic>> checkpoints;
+
+    while (true) {
+        int clientFd = TEMP_FAILURE_RETRY(accept(listenFd, nullptr, nullptr));
+        if (clientFd < 0) {
+            PLOG(ERROR) << "accept failed";
+            continue;
+        }
+        handleClient(clientFd, collector, &checkpoints);
+        close(clientFd);
+    }
+}
+
+static int client(const Options& opt) {
+    std::string command;
+    if (!opt.checkpointName.empty()) {
+        command = "checkpoint " + opt.checkpointName;
+    } else {
+        command = (opt.humanReadable ? "diff-human " : "diff ") + opt.queryName;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        PLOG(ERROR) << "can't create client socket";
+        return 1;
+    }
+
+    struct sockaddr_un addr;
+    socklen_t addrLen = makeSocketAddr(opt.socketName, &addr);
+    if (TEMP_FAILURE_RETRY(connect(fd, reinterpret_cast<struct sockaddr*>(&addr), addrLen)) < 0) {
+        PLOG(ERROR) << "can't connect to " << opt.socketName << "; is --server running?";
+        close(fd);
+        return 1;
+    }
+
+    if (!writeAll(fd, command + "\n")) {
+        PLOG(ERROR) << "failed to send command";
+        close(fd);
+        return 1;
+    }
+    shutdown(fd, SHUT_WR);
+
+    int ret = 0;
+    bool first = true;
+    char buf[4096];
+    ssize_t n;
+    while ((n = TEMP_FAILURE_RETRY(read(fd, buf, sizeof(buf)))) > 0) {
+        if (first) {
+            first = false;
+            if (n >= 6 && memcmp(buf, "error:", 6) == 0) {
+                ret = 1;
+            }
+        }
+        std::cout.write(buf, n);
+    }
+    close(fd);
+    return ret;
+}
+
+static void daemon(const Options& opt, const PowerStatsCollector& collector) {
+    daemonize();
 
     // Install a signal handler
     std::signal(SIGINT, signalHandler);
@@ -205,7 +393,11 @@ static void daemon(const Options& opt, const PowerStatsCollector& collector) {
 }
 
 static void runWithOptions(const Options& opt, const PowerStatsCollector& collector) {
-    if (opt.daemonMode) {
+    if (opt.serverMode) {
+        server(opt, collector);
+    } else if (opt.clientMode) {
+        exit(client(opt) ? EXIT_FAILURE : EXIT_SUCCESS);
+    } else if (opt.daemonMode) {
         daemon(opt, collector);
     } else {
         snapshot(opt, collector);
@@ -35,8 +35,12 @@
  *
  */
 
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #include <dirent.h>
+#include <unistd.h>
 
 #include <iostream>
 #include <list>
@@ -49,12 +53,17 @@
 #include <android-base/format.h>
 #include <android-base/logging.h>
 #include <android-base/parseint.h>
+#include <android-base/properties.h>
 #include <android-base/strings.h>
+#include <android-base/unique_fd.h>
 
 
 #define POLICY0_CORES_PATH "/sys/devices/system/cpu/cpufreq/policy0/affected_cpus"
 #define SYSFS_IRQDIR "/sys/kernel/irq"
 #define PROC_IRQDIR "/proc/irq"
+#define PROC_INTERRUPTS "/proc/interrupts"
+#define DEFAULT_PROFILE_CONFIG "/vendor/etc/rebalance_interrupts.conf"
+#define PROFILE_PROPERTY "vendor.rebalance_interrupts.profile"
 
 using android::base::ParseInt;
 using android::base::ParseUint;
@@ -203,8 +212,12 @@ void ReportIfAffinityUpdated(const std::string expected_value,
 
 // Evenly distribute the IRQ actions across all the Policy0 CPUs.
 // Assign all the IRQs of an action to a single CPU core.
-bool RebalanceIrqs(const list<pair<string, list<string>>>& action_to_irqs) {
+// If assigned_cpu is non-null, record which core each IRQ was given so a
+// daemon can migrate them later.
+bool RebalanceIrqs(const list<pair<string, list<string>>>& action_to_irqs,
+                   map<int, int>* assigned_cpu = nullptr) {
   int mask_index = 0;
+  std::vector<int> cpus = Policy0AffectedCpus();
   std::vector<std::string> affinity_masks = Policy0CpuMasks();
 
   if (affinity_masks.empty()) {
@@ -218,6 +231,9 @@ bool RebalanceIrqs(const list<pair<string, list<string>>>& action_to_irqs) {
       affinity_path += irq + "/smp_affinity";
       WriteStringToFile(affinity_masks[mask_index], affinity_path);
       ReportIfAffinityUpdated(affinity_masks[mask_index], affinity_path);
+      int irq_num;
+      if (assigned_cpu && ParseInt(irq.c_str(), &irq_num))
+        (*assigned_cpu)[irq_num] = cpus[mask_index];
     }
     mask_index = (mask_index + 1) % affinity_masks.size();
   }
@@ -251,9 +267,277 @@ void ChownIrqAffinity() {
     }
 }
 
-int main(int /* argc */, char* /* argv */[]) {
+// A named interrupt layout, precompiled at startup into the exact
+// smp_affinity writes needed, so applying it is one batch of file writes
+// with no parsing or lookups on the trigger path.
+struct AffinityProfile {
+  vector<pair<string, string>> writes;  // (smp_affinity path, mask)
+  vector<int> irqs;                     // IRQs this profile pins
+};
+
+// Load affinity profiles from a config file.  Each non-comment line reads
+//   <profile> <irq action> <cpu>
+// e.g. "camera csis0 6".  Actions are resolved against this boot's
+// action-to-IRQ mapping; actions that did not register are skipped with a
+// warning so one missing driver does not invalidate a whole profile.
+map<string, AffinityProfile> LoadProfiles(
+    const string& config_path, const map<string, list<string>>& action_to_irqs) {
+  map<string, AffinityProfile> profiles;
+  string contents;
+
+  if (!ReadFileToString(config_path, &contents))
+    return profiles;
+
+  for (const auto& line : android::base::Split(contents, "\n")) {
+    string trimmed = Trim(line);
+    if (trimmed.empty() || trimmed[0] == '#')
+      continue;
+
+    vector<string> tokens = android::base::Split(trimmed, " ");
+    int cpu;
+    if (tokens.size() != 3 || !ParseInt(tokens[2].c_str(), &cpu)) {
+      LOG(WARNING) << "Skipping malformed profile line: " << trimmed;
+      continue;
+    }
+
+    const auto entry = action_to_irqs.find(tokens[1]);
+    if (entry == action_to_irqs.end()) {
+      LOG(WARNING) << "No IRQ registered for action \"" << tokens[1]
+                   << "\" in profile " << tokens[0];
+      continue;
+    }
+
+    AffinityProfile& profile = profiles[tokens[0]];
+    for (const auto& irq : entry->second) {
+      profile.writes.emplace_back(fmt::format(PROC_IRQDIR "/{}/smp_affinity", irq),
+                                  fmt::format("{0:02x}", 1 << cpu));
+      int irq_num;
+      if (ParseInt(irq.c_str(), &irq_num))
+        profile.irqs.push_back(irq_num);
+    }
+  }
+
+  for (const auto& [name, profile] : profiles)
+    LOG(INFO) << "Profile " << name << ": " << profile.writes.size() << " IRQ pins";
+
+  return profiles;
+}
+
+// Flip the interrupt layout to the given profile in one batch of writes.
+// The profile's IRQs leave the daemon's movable set; they now belong to the
+// profile until another profile (or a restart) says otherwise.
+void ApplyProfile(const string& name, const AffinityProfile& profile,
+                  map<int, int>* assigned_cpu) {
+  LOG(INFO) << "Applying interrupt profile " << name;
+  for (const auto& [path, mask] : profile.writes) {
+    WriteStringToFile(mask, path);
+    ReportIfAffinityUpdated(mask, path);
+  }
+  for (int irq : profile.irqs)
+    assigned_cpu->erase(irq);
+}
+
+// Daemon mode tunables.  Samples are kSampleIntervalSecs apart; a core has
+// to stay overloaded for kHysteresisSamples consecutive samples before we
+// move anything, and after a migration we sit out kCooldownSamples so the
+// counters can settle.  This keeps transient bursts (shutter press, tether
+// start) from causing affinity thrash.
+constexpr int kSampleIntervalSecs = 10;
+constexpr int kHysteresisSamples = 3;
+constexpr int kCooldownSamples = 6;
+constexpr double kImbalanceRatio = 2.0;
+constexpr uint64_t kMinInterruptsPerSample = 1000;
+
+// Parse the counter columns of /proc/interrupts into per-IRQ per-CPU counts.
+// Only numbered IRQ lines are kept; the leading IRQ number and the counter
+// columns are parsed with a cursor walk and the rest of each line (chip,
+// hwirq, action names) is skipped without tokenizing.
+void ParseProcInterrupts(const string& contents, map<int, vector<uint64_t>>* counts) {
+  const char* cursor = contents.c_str();
+
+  // Skip the "CPU0 CPU1 ..." header line.
+  cursor = strchr(cursor, '\n');
+  if (!cursor)
+    return;
+
+  while (*cursor) {
+    ++cursor;  // past the newline
+    char* after;
+    long irq = strtol(cursor, &after, 10);
+    if (after == cursor || *after != ':') {
+      // Not a numbered IRQ line (ERR:, MIS:, softirq summaries); skip it.
+      cursor = strchr(cursor, '\n');
+      if (!cursor)
+        return;
+      continue;
+    }
+
+    cursor = after + 1;
+    vector<uint64_t>& row = (*counts)[irq];
+    row.clear();
+    while (true) {
+      uint64_t count = strtoull(cursor, &after, 10);
+      if (after == cursor)
+        break;
+      row.push_back(count);
+      cursor = after;
+    }
+
+    cursor = strchr(cursor, '\n');
+    if (!cursor)
+      return;
+  }
+}
+
+// Point an IRQ we manage at the given core.
+void MigrateIrq(int irq, int cpu) {
+  string affinity_path = fmt::format(PROC_IRQDIR "/{}/smp_affinity", irq);
+  string mask = fmt::format("{0:02x}", 1 << cpu);
+  WriteStringToFile(mask, affinity_path);
+  ReportIfAffinityUpdated(mask, affinity_path);
+}
+
+// Periodically sample /proc/interrupts deltas and migrate the hottest
+// movable IRQ off a persistently overloaded Policy0 core.  Only IRQs this
+// tool assigned in the one-shot pass are considered movable; anything a
+// driver or performance-critical service pinned itself is left alone.
+int RunDaemon(map<int, int>& assigned_cpu, const map<string, AffinityProfile>& profiles) {
+  vector<int> cpus = Policy0AffectedCpus();
+  if (cpus.empty()) {
+    LOG(ERROR) << "Unable to find Policy0 CPUs for daemon mode.";
+    return 1;
+  }
+
+  android::base::unique_fd fd(TEMP_FAILURE_RETRY(
+      open(PROC_INTERRUPTS, O_RDONLY | O_CLOEXEC)));
+  if (fd < 0) {
+    PLOG(ERROR) << "opening " PROC_INTERRUPTS;
+    return 1;
+  }
+
+  map<int, vector<uint64_t>> prev_counts;
+  int overload_streak = 0;
+  int cooldown = 0;
+  string current_profile;
+
+  while (true) {
+    // Check the profile trigger once a second between samples, so a mode
+    // flip from the performance service lands promptly.  Property reads
+    // are shared-memory lookups, not syscalls.
+    for (int i = 0; i < kSampleIntervalSecs; ++i) {
+      sleep(1);
+      string requested = android::base::GetProperty(PROFILE_PROPERTY, "");
+      if (requested == current_profile)
+        continue;
+      current_profile = requested;
+      const auto profile = profiles.find(requested);
+      if (profile != profiles.end()) {
+        ApplyProfile(requested, profile->second, &assigned_cpu);
+        cooldown = kCooldownSamples;
+      } else if (!requested.empty()) {
+        LOG(WARNING) << "Unknown interrupt profile " << requested;
+      }
+    }
+
+    string contents;
+    if (lseek(fd, 0, SEEK_SET) != 0 || !android::base::ReadFdToString(fd, &contents)) {
+      PLOG(ERROR) << "reading " PROC_INTERRUPTS;
+      continue;
+    }
+
+    map<int, vector<uint64_t>> counts;
+    ParseProcInterrupts(contents, &counts);
+    map<int, vector<uint64_t>> deltas;
+    for (const auto& [irq, row] : counts) {
+      const auto prev = prev_counts.find(irq);
+      if (prev == prev_counts.end() || prev->second.size() != row.size())
+        continue;
+      vector<uint64_t> delta(row.size());
+      for (size_t cpu = 0; cpu < row.size(); ++cpu)
+        delta[cpu] = row[cpu] - prev->second[cpu];
+      deltas[irq] = std::move(delta);
+    }
+    prev_counts = std::move(counts);
+    if (deltas.empty())
+      continue;
+
+    // Per-core interrupt load over the Policy0 cores this sample.
+    map<int, uint64_t> cpu_load;
+    for (int cpu : cpus)
+      cpu_load[cpu] = 0;
+    for (const auto& [irq, delta] : deltas) {
+      for (int cpu : cpus) {
+        if ((size_t)cpu < delta.size())
+          cpu_load[cpu] += delta[cpu];
+      }
+    }
+
+    uint64_t total = 0;
+    int busiest = cpus[0], idlest = cpus[0];
+    for (const auto& [cpu, load] : cpu_load) {
+      total += load;
+      if (load > cpu_load[busiest])
+        busiest = cpu;
+      if (load < cpu_load[idlest])
+        idlest = cpu;
+    }
+    const double average = (double)total / cpus.size();
+
+    if (cooldown > 0)
+      --cooldown;
+
+    const bool overloaded = cpu_load[busiest] >= kMinInterruptsPerSample &&
+                            (double)cpu_load[busiest] > kImbalanceRatio * average;
+    overload_streak = overloaded ? overload_streak + 1 : 0;
+    if (overload_streak < kHysteresisSamples || cooldown > 0)
+      continue;
+
+    // Migrate the hottest IRQ we manage off the overloaded core.
+    int hottest_irq = -1;
+    uint64_t hottest_delta = 0;
+    for (const auto& [irq, cpu] : assigned_cpu) {
+      if (cpu != busiest)
+        continue;
+      const auto delta = deltas.find(irq);
+      if (delta == deltas.end() || (size_t)busiest >= delta->second.size())
+        continue;
+      if (delta->second[busiest] > hottest_delta) {
+        hottest_delta = delta->second[busiest];
+        hottest_irq = irq;
+      }
+    }
+    if (hottest_irq < 0) {
+      // Nothing movable is contributing on this core; stop retrying until
+      // the imbalance picture changes.
+      overload_streak = 0;
+      continue;
+    }
+
+    LOG(INFO) << "core " << busiest << " handled " << cpu_load[busiest]
+              << " interrupts last sample; moving irq " << hottest_irq
+              << " (" << hottest_delta << ") to core " << idlest;
+    MigrateIrq(hottest_irq, idlest);
+    assigned_cpu[hottest_irq] = idlest;
+    overload_streak = 0;
+    cooldown = kCooldownSamples;
+  }
+}
+
+int main(int argc, char* argv[]) {
   map<string, list<string>> irq_mapping;
   list<pair<string, list<string>>> action_to_irqs;
+  bool daemon_mode = false;
+  string config_path = DEFAULT_PROFILE_CONFIG;
+  string oneshot_profile;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--daemon"))
+      daemon_mode = true;
+    else if (!strcmp(argv[i], "--config") && i + 1 < argc)
+      config_path = argv[++i];
+    else if (!strcmp(argv[i], "--profile") && i + 1 < argc)
+      oneshot_profile = argv[++i];
+  }
 
   // Find the mapping of "irq actions" to IRQs.
   // Each IRQ has an assocatied irq_actions field, showing the actions
@@ -276,6 +560,28 @@ int main(int /* argc */, char* /* argv */[]) {
   FindUnassignedIrqs(irq_mapping, action_to_irqs);
 
   // Distribute the rebalancable IRQs across all cores.
-  return RebalanceIrqs(action_to_irqs) ? 0 : 1;
+  map<int, int> assigned_cpu;
+  if (!RebalanceIrqs(action_to_irqs, &assigned_cpu))
+    return 1;
+
+  // Named affinity profiles, resolved against this boot's IRQ numbers.
+  map<string, AffinityProfile> profiles = LoadProfiles(config_path, irq_mapping);
+
+  if (!oneshot_profile.empty()) {
+    const auto profile = profiles.find(oneshot_profile);
+    if (profile == profiles.end()) {
+      LOG(ERROR) << "Unknown interrupt profile " << oneshot_profile;
+      return 1;
+    }
+    ApplyProfile(oneshot_profile, profile->second, &assigned_cpu);
+  }
+
+  // In daemon mode, keep sampling /proc/interrupts and shift the IRQs we
+  // just placed as the load moves between camera, tethering and gaming.
+  // Profile flips are triggered through the PROFILE_PROPERTY property.
+  if (daemon_mode)
+    return RunDaemon(assigned_cpu, profiles);
+
+  return 0;
 }
 
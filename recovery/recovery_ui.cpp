@@ -14,17 +14,24 @@
  * limitations under the License.
  */
 
+#include <dirent.h>
 #include <dlfcn.h>
+#include <fcntl.h>
 #include <stdint.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <memory>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 #include <android-base/endian.h>
 #include <android-base/logging.h>
 #include <android-base/strings.h>
+#include <android-base/unique_fd.h>
 #include <app_nugget.h>
 #include <misc_writer/misc_writer.h>
 #include <nos/NuggetClient.h>
@@ -102,8 +109,71 @@ bool ProvisionSilentOtaFlag(const std::string& reason) {
     return true;
 }
 
+/* Recovery UI assets: animation frames, icons, localized text strips. */
+constexpr char kResImagesDir[] = "/res/images";
+
+/*
+ * Queue every UI asset into the page cache. ScreenRecoveryUI::Init() decodes
+ * them synchronously before the first frame can be drawn; issuing the flash
+ * reads early, overlapped with the rest of recovery's startup, leaves Init()
+ * with in-memory decodes only.
+ */
+void PreloadUiAssets() {
+    std::unique_ptr<DIR, decltype(&closedir)> dir(opendir(kResImagesDir), closedir);
+    if (dir == nullptr) {
+        PLOG(WARNING) << "Unable to open " << kResImagesDir << " for asset preload";
+        return;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir.get())) != nullptr) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        std::string path = std::string(kResImagesDir) + "/" + entry->d_name;
+        ::android::base::unique_fd fd(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+        if (fd.get() < 0) {
+            continue;
+        }
+        struct stat st;
+        if (fstat(fd.get(), &st) == 0) {
+            // readahead() queues the contents without a userspace copy.
+            readahead(fd.get(), 0, st.st_size);
+        }
+    }
+}
+
 }  // namespace
 
+/*
+ * ScreenRecoveryUI decodes the full animation into per-frame surfaces during
+ * Init() and flips between those pre-decoded buffers afterwards; what makes
+ * time-to-first-frame slow on recovery entry is pulling the PNGs off flash
+ * inside Init(). Start that read the moment the binary constructs its UI -
+ * recovery still has its own init to run before it calls Init() - and join
+ * before the decode begins.
+ */
+class PixelRecoveryUI : public ::ScreenRecoveryUI {
+  public:
+    PixelRecoveryUI() : preload_thread_(&PreloadUiAssets) {}
+
+    ~PixelRecoveryUI() override {
+        if (preload_thread_.joinable()) {
+            preload_thread_.join();
+        }
+    }
+
+    bool Init(const std::string& locale) override {
+        if (preload_thread_.joinable()) {
+            preload_thread_.join();
+        }
+        return ScreenRecoveryUI::Init(locale);
+    }
+
+  private:
+    std::thread preload_thread_;
+};
+
 class PixelDevice : public ::Device {
   public:
     explicit PixelDevice(::ScreenRecoveryUI* const ui) : ::Device(ui) {}
@@ -151,5 +221,6 @@ class PixelDevice : public ::Device {
 }  // namespace android
 
 Device *make_device() {
-    return new ::android::hardware::google::pixel::PixelDevice(new ::ScreenRecoveryUI);
+    return new ::android::hardware::google::pixel::PixelDevice(
+            new ::android::hardware::google::pixel::PixelRecoveryUI);
 }
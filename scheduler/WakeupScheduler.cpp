@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "pixelscheduler"
+
+#include "pixelscheduler/WakeupScheduler.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <log/log.h>
+#include <string.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+namespace android {
+namespace hardware {
+namespace google {
+namespace pixel {
+
+WakeupScheduler::WakeupScheduler() {
+    timerfd_ = timerfd_create(CLOCK_BOOTTIME, TFD_CLOEXEC);
+    if (timerfd_ < 0) {
+        ALOGE("Unable to create timerfd - %s", strerror(errno));
+    }
+}
+
+WakeupScheduler::~WakeupScheduler() {
+    if (timerfd_ >= 0) {
+        close(timerfd_);
+    }
+}
+
+int64_t WakeupScheduler::bootNow() {
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return ts.tv_sec;
+}
+
+int64_t WakeupScheduler::nextAlignedDeadline(int64_t period_sec, int64_t now_sec) {
+    return (now_sec / period_sec + 1) * period_sec;
+}
+
+void WakeupScheduler::addPeriodic(std::string name, int64_t period_sec, Task task,
+                                  int64_t slack_sec) {
+    if (period_sec < 1) {
+        period_sec = 1;
+    }
+    if (slack_sec < 0) {
+        slack_sec = period_sec / 20;
+    }
+    tasks_.push_back({std::move(name), period_sec, slack_sec, std::move(task)});
+    deadlines_.emplace(nextAlignedDeadline(period_sec, bootNow()), tasks_.size() - 1);
+}
+
+bool WakeupScheduler::arm() {
+    if (timerfd_ < 0 || deadlines_.empty()) {
+        return false;
+    }
+    struct itimerspec period = {};
+    period.it_value.tv_sec = std::max<int64_t>(deadlines_.top().first - bootNow(), 1);
+    if (timerfd_settime(timerfd_, 0, &period, NULL)) {
+        ALOGE("Unable to arm wakeup timer - %s", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+int WakeupScheduler::dispatch() {
+    uint64_t expire;
+    read(timerfd_, &expire, sizeof(expire));
+    const int64_t now = bootNow();
+    int tasks_run = 0;
+    // Run everything due, plus everything close enough behind the wake that
+    // pulling it in (within its slack) saves the SoC a separate wakeup.
+    while (!deadlines_.empty() &&
+           deadlines_.top().first - tasks_[deadlines_.top().second].slack_sec <= now) {
+        Deadline due = deadlines_.top();
+        deadlines_.pop();
+        const PeriodicTask &task = tasks_[due.second];
+        task.run();
+        tasks_run++;
+        // Re-anchoring on the aligned grid keeps the cadence drift-free by
+        // construction; a wake that slept past whole periods (e.g. long
+        // suspend) just lands on the next grid point.
+        int64_t next = nextAlignedDeadline(task.period_sec, std::max(now, due.first));
+        if (due.first + task.period_sec < next) {
+            ALOGW("%s wake: sleep too much: %" PRId64 "s late", task.name.c_str(),
+                  now - due.first);
+        }
+        deadlines_.emplace(next, due.second);
+    }
+    return tasks_run;
+}
+
+}  // namespace pixel
+}  // namespace google
+}  // namespace hardware
+}  // namespace android
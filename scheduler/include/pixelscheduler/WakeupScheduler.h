@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HARDWARE_GOOGLE_PIXEL_SCHEDULER_WAKEUPSCHEDULER_H
+#define HARDWARE_GOOGLE_PIXEL_SCHEDULER_WAKEUPSCHEDULER_H
+
+#include <stdint.h>
+
+#include <functional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace android {
+namespace hardware {
+namespace google {
+namespace pixel {
+
+/**
+ * Coalesced, suspend-aware periodic deadlines for daemon loops.
+ *
+ * Deadlines are tracked on CLOCK_BOOTTIME, so they keep advancing across
+ * suspend without forcing the AP awake, and every deadline is anchored to
+ * absolute multiples of its period since boot. Independent daemons that use
+ * the same period therefore land in the same wakeup window instead of each
+ * waking the SoC on its own phase. When the timer fires, every task whose
+ * deadline falls within its slack window runs on the same wake.
+ */
+class WakeupScheduler {
+  public:
+    using Task = std::function<void()>;
+
+    WakeupScheduler();
+    ~WakeupScheduler();
+    // Disallow copy and assign
+    WakeupScheduler(const WakeupScheduler &) = delete;
+    WakeupScheduler &operator=(const WakeupScheduler &) = delete;
+
+    // False if the timerfd could not be created.
+    bool valid() const { return timerfd_ >= 0; }
+    // fd to poll for POLLIN; readable when the earliest deadline is due.
+    int fd() const { return timerfd_; }
+
+    // Registers a periodic task. slack_sec bounds how early the task may run
+    // in order to share a wake with another due task; by default 5% of the
+    // period.
+    void addPeriodic(std::string name, int64_t period_sec, Task task, int64_t slack_sec = -1);
+
+    // Arms the timer for the earliest registered deadline. Returns false if
+    // the timer cannot be armed or no task is registered.
+    bool arm();
+
+    // Drains the timerfd and runs every task due within its slack window,
+    // re-anchoring each on its aligned schedule. Call when fd() polls
+    // readable. Returns the number of tasks run.
+    int dispatch();
+
+    // Seconds since boot, including time spent in suspend.
+    static int64_t bootNow();
+    // First multiple of period_sec strictly after now_sec — the shared
+    // boottime wakeup grid.
+    static int64_t nextAlignedDeadline(int64_t period_sec, int64_t now_sec);
+
+  private:
+    struct PeriodicTask {
+        std::string name;
+        int64_t period_sec;
+        int64_t slack_sec;
+        Task run;
+    };
+
+    int timerfd_;
+    std::vector<PeriodicTask> tasks_;
+    // Min-heap of {deadline, task index}.
+    typedef std::pair<int64_t, size_t> Deadline;
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> deadlines_;
+};
+
+}  // namespace pixel
+}  // namespace google
+}  // namespace hardware
+}  // namespace android
+
+#endif  // HARDWARE_GOOGLE_PIXEL_SCHEDULER_WAKEUPSCHEDULER_H
@@ -22,6 +22,8 @@
 #include <android-base/logging.h>
 #include <utils/Trace.h>
 
+#include "utils/thermal_event_journal.h"
+
 namespace aidl {
 namespace android {
 namespace hardware {
@@ -53,10 +55,24 @@ bool interfacesEqual(const std::shared_ptr<::ndk::ICInterface> left,
 Thermal::Thermal() {
     thermal_helper_ = std::make_shared<ThermalHelperImpl>(
             std::bind(&Thermal::sendThermalChangedCallback, this, std::placeholders::_1));
+    applyNotificationThreadScheduling();
 }
 
 Thermal::Thermal(const std::shared_ptr<ThermalHelper> &helper) {
     thermal_helper_ = helper;
+    applyNotificationThreadScheduling();
+}
+
+void Thermal::applyNotificationThreadScheduling() {
+    const auto sched_info =
+            thermal_helper_->getThreadSchedulingInfo(kNotificationThreadName);
+    if (!sched_info.has_value()) {
+        return;
+    }
+    // Run the change on the looper thread itself: it is the thread whose
+    // scheduling the config section names.
+    looper_.addEvent(
+            {[sched_info = *sched_info]() { ApplySchedulingToCurrentThread(sched_info); }});
 }
 
 ndk::ScopedAStatus Thermal::getTemperatures(std::vector<Temperature> *_aidl_return) {
@@ -198,7 +214,7 @@ ndk::ScopedAStatus Thermal::registerThermalChangedCallback(
             if (it != callbacks_.end()) {
                 if (AIBinder_isAlive(c.callback->asBinder().get())) {
                     for (const auto &t : temperatures) {
-                        if (!filterType || t.type == type) {
+                        if (c.wantsNotification(t)) {
                             LOG(INFO) << "Sending notification: "
                                       << " Type: " << toString(t.type) << " Name: " << t.name
                                       << " CurrentValue: " << t.value
@@ -216,29 +232,54 @@ ndk::ScopedAStatus Thermal::registerThermalChangedCallback(
     return ndk::ScopedAStatus::ok();
 }
 
-void Thermal::sendThermalChangedCallback(const Temperature &t) {
+void Thermal::sendThermalChangedCallback(const std::vector<Temperature> &temps) {
     ATRACE_CALL();
-    std::lock_guard<std::mutex> _lock(thermal_callback_mutex_);
-    LOG(VERBOSE) << "Sending notification: "
-                 << " Type: " << toString(t.type) << " Name: " << t.name
-                 << " CurrentValue: " << t.value
-                 << " ThrottlingStatus: " << toString(t.throttlingStatus);
-
-    callbacks_.erase(std::remove_if(callbacks_.begin(), callbacks_.end(),
-                                    [&](const CallbackSetting &c) {
-                                        if (!c.is_filter_type || t.type == c.type) {
-                                            ::ndk::ScopedAStatus ret =
-                                                    c.callback->notifyThrottling(t);
-                                            if (!ret.isOk()) {
-                                                LOG(ERROR) << "a Thermal callback is dead, removed "
-                                                              "from callback list.";
-                                                return true;
-                                            }
-                                            return false;
-                                        }
-                                        return false;
-                                    }),
-                     callbacks_.end());
+    // Evaluate every callback's filters and build the per-client batches
+    // under the mutex, then issue the oneway notifications with the mutex
+    // dropped so slow clients do not block registration or the next cycle.
+    std::vector<std::pair<std::shared_ptr<IThermalChangedCallback>, std::vector<Temperature>>>
+            dispatch;
+    {
+        std::lock_guard<std::mutex> _lock(thermal_callback_mutex_);
+        for (const auto &c : callbacks_) {
+            std::vector<Temperature> batch;
+            for (const auto &t : temps) {
+                if (c.wantsNotification(t)) {
+                    batch.push_back(t);
+                }
+            }
+            if (!batch.empty()) {
+                dispatch.emplace_back(c.callback, std::move(batch));
+            }
+        }
+    }
+
+    std::vector<std::shared_ptr<IThermalChangedCallback>> dead_callbacks;
+    for (const auto &[callback, batch] : dispatch) {
+        for (const auto &t : batch) {
+            LOG(VERBOSE) << "Sending notification: "
+                         << " Type: " << toString(t.type) << " Name: " << t.name
+                         << " CurrentValue: " << t.value
+                         << " ThrottlingStatus: " << toString(t.throttlingStatus);
+            ::ndk::ScopedAStatus ret = callback->notifyThrottling(t);
+            if (!ret.isOk()) {
+                LOG(ERROR) << "a Thermal callback is dead, removed from callback list.";
+                dead_callbacks.emplace_back(callback);
+                break;
+            }
+        }
+    }
+
+    if (!dead_callbacks.empty()) {
+        std::lock_guard<std::mutex> _lock(thermal_callback_mutex_);
+        for (const auto &dead_callback : dead_callbacks) {
+            callbacks_.erase(std::remove_if(callbacks_.begin(), callbacks_.end(),
+                                            [&](const CallbackSetting &c) {
+                                                return interfacesEqual(c.callback, dead_callback);
+                                            }),
+                             callbacks_.end());
+        }
+    }
 }
 
 ndk::ScopedAStatus Thermal::registerCoolingDeviceChangedCallbackWithType(
@@ -365,7 +406,8 @@ void Thermal::dumpVirtualSensorInfo(std::ostringstream *dump_buf) {
 void Thermal::dumpThrottlingInfo(std::ostringstream *dump_buf) {
     *dump_buf << "getThrottlingInfo:" << std::endl;
     const auto &map = thermal_helper_->GetSensorInfoMap();
-    const auto &thermal_throttling_status_map = thermal_helper_->GetThermalThrottlingStatusMap();
+    const auto thermal_throttling_status_map =
+            thermal_helper_->GetThermalThrottlingStatusMapSnapshot();
     for (const auto &name_info_pair : map) {
         if (name_info_pair.second.throttling_info == nullptr) {
             continue;
@@ -498,7 +540,8 @@ void Thermal::dumpThrottlingInfo(std::ostringstream *dump_buf) {
 }
 
 void Thermal::dumpThrottlingRequestStatus(std::ostringstream *dump_buf) {
-    const auto &thermal_throttling_status_map = thermal_helper_->GetThermalThrottlingStatusMap();
+    const auto thermal_throttling_status_map =
+            thermal_helper_->GetThermalThrottlingStatusMapSnapshot();
     if (!thermal_throttling_status_map.size()) {
         return;
     }
@@ -690,39 +733,50 @@ void Thermal::dumpThermalStats(std::ostringstream *dump_buf) {
 void Thermal::dumpThermalData(int fd) {
     std::ostringstream dump_buf;
 
+    /* Stream each completed section to the fd instead of accumulating the
+     * whole report in memory; the reader starts consuming output while later
+     * sections are still being formatted. */
+    auto flush_buf = [&]() {
+        if (!::android::base::WriteStringToFd(dump_buf.str(), fd)) {
+            PLOG(ERROR) << "Failed to dump state to fd";
+        }
+        dump_buf.str("");
+        dump_buf.clear();
+    };
+
     if (!thermal_helper_->isInitializedOk()) {
         dump_buf << "ThermalHAL not initialized properly." << std::endl;
     } else {
-        const auto &sensor_status_map = thermal_helper_->GetSensorStatusMap();
+        /* Per-sensor status is copied out under its lock once, then formatted
+         * with no lock held */
+        const auto sensor_status_overview = thermal_helper_->GetSensorStatusOverview();
         {
             dump_buf << "getCachedTemperatures:" << std::endl;
             boot_clock::time_point now = boot_clock::now();
-            for (const auto &sensor_status_pair : sensor_status_map) {
-                if ((sensor_status_pair.second.thermal_cached.timestamp) ==
-                    boot_clock::time_point::min()) {
+            for (const auto &sensor_status : sensor_status_overview) {
+                if (sensor_status.thermal_cached.timestamp == boot_clock::time_point::min()) {
                     continue;
                 }
-                dump_buf << " Name: " << sensor_status_pair.first
-                         << " CachedValue: " << sensor_status_pair.second.thermal_cached.temp
+                dump_buf << " Name: " << sensor_status.name
+                         << " CachedValue: " << sensor_status.thermal_cached.temp
                          << " TimeToCache: "
                          << std::chrono::duration_cast<std::chrono::milliseconds>(
-                                    now - sensor_status_pair.second.thermal_cached.timestamp)
+                                    now - sensor_status.thermal_cached.timestamp)
                                     .count()
                          << "ms" << std::endl;
             }
         }
         {
             dump_buf << "getEmulSettings:" << std::endl;
-            for (const auto &sensor_status_pair : sensor_status_map) {
-                if (sensor_status_pair.second.override_status.emul_temp == nullptr) {
+            for (const auto &sensor_status : sensor_status_overview) {
+                if (!sensor_status.has_emul_setting) {
                     continue;
                 }
-                dump_buf << " Name: " << sensor_status_pair.first << " EmulTemp: "
-                         << sensor_status_pair.second.override_status.emul_temp->temp
-                         << " EmulSeverity: "
-                         << sensor_status_pair.second.override_status.emul_temp->severity
+                dump_buf << " Name: " << sensor_status.name
+                         << " EmulTemp: " << sensor_status.emul_temp
+                         << " EmulSeverity: " << sensor_status.emul_severity
                          << " maxThrottling: " << std::boolalpha
-                         << sensor_status_pair.second.override_status.max_throttling << std::endl;
+                         << sensor_status.emul_max_throttling << std::endl;
             }
         }
         {
@@ -814,11 +868,19 @@ void Thermal::dumpThermalData(int fd) {
             }
             dump_buf << std::endl;
         }
+        flush_buf();
         dumpVirtualSensorInfo(&dump_buf);
+        flush_buf();
         dumpThrottlingInfo(&dump_buf);
+        flush_buf();
         dumpThrottlingRequestStatus(&dump_buf);
+        flush_buf();
         dumpPowerRailInfo(&dump_buf);
+        flush_buf();
         dumpThermalStats(&dump_buf);
+        flush_buf();
+        ThermalEventJournal::getInstance()->dumpToStream(&dump_buf);
+        flush_buf();
         {
             dump_buf << "getAIDLPowerHalInfo:" << std::endl;
             dump_buf << " Exist: " << std::boolalpha << thermal_helper_->isAidlPowerHalExist()
@@ -829,10 +891,7 @@ void Thermal::dumpThermalData(int fd) {
                      << thermal_helper_->isPowerHalExtConnected() << std::endl;
         }
     }
-    std::string buf = dump_buf.str();
-    if (!::android::base::WriteStringToFd(buf, fd)) {
-        PLOG(ERROR) << "Failed to dump state to fd";
-    }
+    flush_buf();
     fsync(fd);
 }
 
@@ -854,6 +913,48 @@ binder_status_t Thermal::dump(int fd, const char **args, uint32_t numArgs) {
                        numArgs == 3 ? false : std::string(args[3]) == "max_throttling")
                        ? STATUS_OK
                        : STATUS_BAD_VALUE;
+    } else if (std::string(args[0]) == "temp_history" && numArgs >= 2) {
+        std::vector<ThermalSample> samples;
+        if (!thermal_helper_->getTemperatureHistory(std::string(args[1]), &samples)) {
+            return STATUS_BAD_VALUE;
+        }
+        std::ostringstream history_buf;
+        for (const auto &sample : samples) {
+            history_buf << std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   sample.timestamp.time_since_epoch())
+                                   .count()
+                        << " " << sample.temp << std::endl;
+        }
+        if (!::android::base::WriteStringToFd(history_buf.str(), fd)) {
+            PLOG(ERROR) << "Failed to dump temp history to fd";
+            return STATUS_BAD_VALUE;
+        }
+        return STATUS_OK;
+    } else if (std::string(args[0]) == "forecast_severity" && numArgs >= 2) {
+        const std::chrono::milliseconds horizon =
+                std::chrono::milliseconds(numArgs >= 3 ? std::atoi(args[2]) : 5000);
+        ThrottlingSeverity severity = ThrottlingSeverity::NONE;
+        if (!thermal_helper_->forecastSeverity(std::string(args[1]), horizon, &severity)) {
+            return STATUS_BAD_VALUE;
+        }
+        if (!::android::base::WriteStringToFd(toString(severity) + "\n", fd)) {
+            PLOG(ERROR) << "Failed to dump forecasted severity to fd";
+            return STATUS_BAD_VALUE;
+        }
+        return STATUS_OK;
+    } else if (std::string(args[0]) == "aggregated_severity" && numArgs >= 2) {
+        ThrottlingSeverity severity = ThrottlingSeverity::NONE;
+        if (!thermal_helper_->getAggregatedSeverity(std::string(args[1]), &severity)) {
+            return STATUS_BAD_VALUE;
+        }
+        if (!::android::base::WriteStringToFd(toString(severity) + "\n", fd)) {
+            PLOG(ERROR) << "Failed to dump aggregated severity to fd";
+            return STATUS_BAD_VALUE;
+        }
+        return STATUS_OK;
+    } else if (std::string(args[0]) == "reload_config" && numArgs >= 2) {
+        return thermal_helper_->reloadThermalConfig(std::string(args[1])) ? STATUS_OK
+                                                                          : STATUS_BAD_VALUE;
     } else if (std::string(args[0]) == "emul_clear") {
         return (numArgs != 2 || !thermal_helper_->emulClear(std::string(args[1])))
                        ? STATUS_BAD_VALUE
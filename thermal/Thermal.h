@@ -20,6 +20,7 @@
 
 #include <mutex>
 #include <thread>
+#include <unordered_set>
 
 #include "thermal-helper.h"
 
@@ -33,9 +34,26 @@ struct CallbackSetting {
     CallbackSetting(std::shared_ptr<IThermalChangedCallback> callback, bool is_filter_type,
                     TemperatureType type)
         : callback(std::move(callback)), is_filter_type(is_filter_type), type(type) {}
+    // Returns true if the temperature passes every filter the client
+    // registered with. Evaluated in the HAL before dispatch so a client never
+    // pays a binder wakeup for a sensor it filtered out. The frozen AIDL
+    // registration only carries the type filter; the sensor name set and
+    // minimum severity are kept here so vendor-internal callers can narrow
+    // their subscription further.
+    bool wantsNotification(const Temperature &t) const {
+        if (is_filter_type && t.type != type) {
+            return false;
+        }
+        if (!sensor_name_filter.empty() && !sensor_name_filter.count(t.name)) {
+            return false;
+        }
+        return t.throttlingStatus >= min_severity;
+    }
     std::shared_ptr<IThermalChangedCallback> callback;
     bool is_filter_type;
     TemperatureType type;
+    std::unordered_set<std::string> sensor_name_filter;
+    ThrottlingSeverity min_severity = ThrottlingSeverity::NONE;
 };
 
 struct CoolingDeviceCallbackSetting {
@@ -81,8 +99,10 @@ class Thermal : public BnThermal {
 
     binder_status_t dump(int fd, const char **args, uint32_t numArgs) override;
 
-    // Helper function for calling callbacks
-    void sendThermalChangedCallback(const Temperature &t);
+    // Helper function for calling callbacks with one polling cycle's worth of
+    // updated temperatures. Filters are evaluated per callback before dispatch
+    // and the surviving notifications are delivered per client back to back.
+    void sendThermalChangedCallback(const std::vector<Temperature> &temps);
 
   private:
     class Looper {
@@ -116,6 +136,11 @@ class Thermal : public BnThermal {
 
     Looper looper_;
 
+    // Post an event that applies the config's "notification" thread
+    // scheduling overrides on looper_'s own thread, so callbacks keep being
+    // delivered on time when the rest of the system is saturated.
+    void applyNotificationThreadScheduling();
+
     ndk::ScopedAStatus getFilteredTemperatures(bool filterType, TemperatureType type,
                                                std::vector<Temperature> *_aidl_return);
     ndk::ScopedAStatus getFilteredCoolingDevices(bool filterType, CoolingType type,
@@ -53,6 +53,10 @@ class MockThermalHelper : public ThermalHelper {
                 (const, override));
     MOCK_METHOD((const std::unordered_map<std::string, ThermalThrottlingStatus> &),
                 GetThermalThrottlingStatusMap, (), (const, override));
+    MOCK_METHOD((std::vector<SensorStatusOverview>), GetSensorStatusOverview, (),
+                (const, override));
+    MOCK_METHOD((std::unordered_map<std::string, ThermalThrottlingStatus>),
+                GetThermalThrottlingStatusMapSnapshot, (), (const, override));
     MOCK_METHOD((const std::unordered_map<std::string, PowerRailInfo> &), GetPowerRailInfoMap, (),
                 (const, override));
     MOCK_METHOD((const std::unordered_map<std::string, PowerStatus> &), GetPowerStatusMap, (),
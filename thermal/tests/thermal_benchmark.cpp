@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Micro-benchmarks for the thermal HAL hot paths: config parsing, the sensor
+// file read loop behind fillCurrentTemperatures, PID throttling updates and
+// virtual temperature estimation. The JSON below mirrors the shape of a
+// production thermal_info_config.json (per-core CPU sensors plus a PID-driven
+// virtual skin sensor) so the parse numbers track what devices actually load.
+
+#include <android-base/file.h>
+#include <android-base/stringprintf.h>
+#include <benchmark/benchmark.h>
+#include <json/reader.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/thermal_files.h"
+#include "utils/thermal_info.h"
+#include "utils/thermal_throttling.h"
+#include "virtualtemp_estimator/virtualtemp_estimator.h"
+
+namespace aidl::android::hardware::thermal::implementation {
+namespace {
+
+using ::android::base::StringPrintf;
+
+constexpr const char *kBenchmarkConfig = R"json(
+{
+    "Sensors":[
+        {
+            "Name":"cpu0-bench",
+            "Type":"CPU",
+            "HotThreshold":["NAN", "NAN", "NAN", 95.0, "NAN", "NAN", 115.0],
+            "HotHysteresis":[0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 1.0],
+            "Multiplier":0.001
+        },
+        {
+            "Name":"cpu1-bench",
+            "Type":"CPU",
+            "HotThreshold":["NAN", "NAN", "NAN", 95.0, "NAN", "NAN", 115.0],
+            "HotHysteresis":[0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 1.0],
+            "Multiplier":0.001
+        },
+        {
+            "Name":"VIRTUAL-SKIN-BENCH",
+            "Type":"SKIN",
+            "VirtualSensor":true,
+            "Formula":"WEIGHTED_AVG",
+            "Combination":["cpu0-bench", "cpu1-bench"],
+            "Coefficient":[0.5, 0.5],
+            "HotThreshold":["NAN", 39.0, 43.0, 45.0, 46.5, 52.0, 55.0],
+            "HotHysteresis":[0.0, 1.9, 1.9, 1.9, 1.9, 1.9, 1.9],
+            "Multiplier":0.001,
+            "Monitor":true,
+            "PollingDelay":300,
+            "PassiveDelay":7000,
+            "PIDInfo":{
+                "K_Po":["NAN", "NAN", "NAN", 300, "NAN", "NAN", "NAN"],
+                "K_Pu":["NAN", "NAN", "NAN", 600, "NAN", "NAN", "NAN"],
+                "K_I":["NAN", "NAN", "NAN", 10, "NAN", "NAN", "NAN"],
+                "K_D":["NAN", "NAN", "NAN", 0, "NAN", "NAN", "NAN"],
+                "I_Max":["NAN", "NAN", "NAN", 1000, "NAN", "NAN", "NAN"],
+                "S_Power":["NAN", "NAN", "NAN", 6000, "NAN", "NAN", "NAN"],
+                "MinAllocPower":["NAN", "NAN", "NAN", 0, "NAN", "NAN", "NAN"],
+                "MaxAllocPower":["NAN", "NAN", "NAN", 10000, "NAN", "NAN", "NAN"],
+                "I_Cutoff":["NAN", "NAN", "NAN", 2, "NAN", "NAN", "NAN"]
+            },
+            "BindedCdevInfo":[
+                {
+                    "CdevRequest":"cpufreq-bench",
+                    "CdevWeightForPID":["NAN", "NAN", "NAN", 1, "NAN", "NAN", "NAN"],
+                    "CdevCeiling":[0, 0, 0, 10, 10, 10, 10]
+                }
+            ]
+        }
+    ],
+    "CoolingDevices":[
+        {
+            "Name":"cpufreq-bench",
+            "Type":"CPU",
+            "State2Power":[6000, 5500, 5000, 4500, 4000, 3500, 3000, 2500, 2000, 1500, 1000]
+        }
+    ]
+}
+)json";
+
+bool parseBenchmarkConfig(Json::Value *config) {
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string errors;
+    const std::string doc(kBenchmarkConfig);
+    return reader->parse(&*doc.begin(), &*doc.end(), config, &errors);
+}
+
+void BM_ParseSensorInfo(benchmark::State &state) {
+    Json::Value config;
+    if (!parseBenchmarkConfig(&config)) {
+        state.SkipWithError("Failed to parse benchmark JSON");
+        return;
+    }
+
+    for (auto _ : state) {
+        std::unordered_map<std::string, SensorInfo> sensors_parsed;
+        if (!ParseSensorInfo(config, &sensors_parsed)) {
+            state.SkipWithError("ParseSensorInfo failed");
+            return;
+        }
+        benchmark::DoNotOptimize(sensors_parsed);
+    }
+}
+BENCHMARK(BM_ParseSensorInfo)->Unit(benchmark::kMicrosecond);
+
+// The sysfs read loop is what dominates fillCurrentTemperatures once the
+// helper is initialized; benchmark it against a mocked sysfs tree so the
+// numbers are stable on any host or device.
+void BM_ReadAllThermalFiles(benchmark::State &state) {
+    TemporaryDir sysfs_tree;
+    ThermalFiles thermal_files;
+    const int num_sensors = state.range(0);
+
+    for (int i = 0; i < num_sensors; ++i) {
+        const std::string name = StringPrintf("tz-bench-%d", i);
+        const std::string path = StringPrintf("%s/%s", sysfs_tree.path, name.c_str());
+        if (!::android::base::WriteStringToFile("48000\n", path)) {
+            state.SkipWithError("Failed to create mocked sysfs file");
+            return;
+        }
+        thermal_files.addThermalFile(name, path);
+    }
+
+    std::unordered_map<std::string, std::string> readings;
+    for (auto _ : state) {
+        if (thermal_files.readAllThermalFiles(&readings) !=
+            static_cast<size_t>(num_sensors)) {
+            state.SkipWithError("Failed to read all thermal files");
+            return;
+        }
+        benchmark::DoNotOptimize(readings);
+    }
+    state.SetItemsProcessed(state.iterations() * num_sensors);
+}
+BENCHMARK(BM_ReadAllThermalFiles)->Arg(8)->Arg(32)->Arg(64)->Unit(benchmark::kMicrosecond);
+
+void BM_ThermalThrottlingUpdate(benchmark::State &state) {
+    Json::Value config;
+    std::unordered_map<std::string, SensorInfo> sensors_parsed;
+    std::unordered_map<std::string, CdevInfo> cooling_devices_parsed;
+    if (!parseBenchmarkConfig(&config) || !ParseSensorInfo(config, &sensors_parsed) ||
+        !ParseCoolingDevice(config, &cooling_devices_parsed)) {
+        state.SkipWithError("Failed to parse benchmark config");
+        return;
+    }
+
+    const auto &sensor_info = sensors_parsed.at("VIRTUAL-SKIN-BENCH");
+    ThermalThrottling thermal_throttling;
+    if (!thermal_throttling.registerThermalThrottling(
+                "VIRTUAL-SKIN-BENCH", sensor_info.throttling_info, cooling_devices_parsed)) {
+        state.SkipWithError("Failed to register thermal throttling");
+        return;
+    }
+
+    const std::unordered_map<std::string, PowerStatus> power_status_map;
+    Temperature temp;
+    temp.type = TemperatureType::SKIN;
+    temp.name = "VIRTUAL-SKIN-BENCH";
+    temp.value = 45.0f;
+
+    for (auto _ : state) {
+        // Oscillate around the SEVERE threshold so both the budget-shrinking
+        // and budget-releasing PID branches are exercised.
+        temp.value = (state.iterations() & 1) ? 46.0f : 44.0f;
+        thermal_throttling.thermalThrottlingUpdate(
+                temp, sensor_info, ThrottlingSeverity::SEVERE, std::chrono::milliseconds(100),
+                power_status_map, cooling_devices_parsed);
+    }
+}
+BENCHMARK(BM_ThermalThrottlingUpdate)->Unit(benchmark::kMicrosecond);
+
+void BM_VirtualTempEstimatorEstimate(benchmark::State &state) {
+    const size_t num_sensors = state.range(0);
+    ::thermal::vtestimator::VirtualTempEstimator estimator(
+            ::thermal::vtestimator::kUseLinearModel, num_sensors);
+    ::thermal::vtestimator::VtEstimationInitData init_data(
+            ::thermal::vtestimator::kUseLinearModel);
+    init_data.linear_model_init_data.coefficients.assign(num_sensors,
+                                                         1.0f / static_cast<float>(num_sensors));
+    if (estimator.Initialize(init_data) != ::thermal::vtestimator::kVtEstimatorOk) {
+        state.SkipWithError("Failed to initialize linear model estimator");
+        return;
+    }
+
+    const std::vector<float> thermistors(num_sensors, 38.5f);
+    float output = 0;
+    for (auto _ : state) {
+        if (estimator.Estimate(thermistors, &output) != ::thermal::vtestimator::kVtEstimatorOk) {
+            state.SkipWithError("Estimate failed");
+            return;
+        }
+        benchmark::DoNotOptimize(output);
+    }
+}
+BENCHMARK(BM_VirtualTempEstimatorEstimate)->Arg(2)->Arg(8)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace aidl::android::hardware::thermal::implementation
+
+BENCHMARK_MAIN();
@@ -0,0 +1,464 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Offline trace-replay harness for the thermal throttling pipeline.
+//
+// Feeds a recorded multi-sensor temperature trace through the same config
+// parsing, virtual sensor formulas, severity hysteresis and ThermalThrottling
+// PID/hardlimit code the HAL runs on device, as fast as the CPU allows, and
+// prints per-sensor severity residency and per-cooling-device duty so a
+// thermal tuning change can be regression-tested against recorded field
+// incidents without an hour-long device rerun.
+//
+// Trace format: CSV with a header row "time_ms,<sensor>,<sensor>,...". Each
+// column after time_ms names a physical (non-virtual) sensor from the config
+// and holds its raw sysfs reading (pre-Multiplier, e.g. millidegrees), which
+// is the unit the virtual sensor formulas operate on in the HAL. Lines
+// starting with '#' are skipped. time_ms must be monotonically increasing;
+// the deltas between rows drive the PID integration time.
+//
+// Usage:
+//   thermal_trace_replay -c thermal_info_config.json -t trace.csv \
+//       [-o fake_cdev_dir] [-v]
+//
+// With -o, every cooling device's aggregated max request is mirrored to
+// <dir>/<cdev_name> the way updateCoolingDevices writes cur_state, so the
+// replayed actuation sequence can be diffed between two configs.
+
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <android-base/parsedouble.h>
+#include <android-base/stringprintf.h>
+#include <android-base/strings.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <json/value.h>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "utils/thermal_info.h"
+#include "utils/thermal_stats_helper.h"
+#include "utils/thermal_throttling.h"
+
+namespace aidl::android::hardware::thermal::implementation {
+namespace {
+
+using ::android::base::StringPrintf;
+
+struct ReplayOptions {
+    std::string config_path;
+    std::string trace_path;
+    std::string cdev_dir;
+    bool verbose = false;
+};
+
+struct SensorReplayStats {
+    ThrottlingSeverity severity = ThrottlingSeverity::NONE;
+    int transitions = 0;
+    float peak_temp = std::numeric_limits<float>::lowest();
+    std::array<int64_t, static_cast<size_t>(kThrottlingSeverityCount)> time_in_severity_ms{};
+};
+
+struct CdevReplayStats {
+    int cur_state = 0;
+    int peak_state = 0;
+    int64_t throttled_ms = 0;
+    int64_t state_time_ms = 0;
+};
+
+// Hot-side severity evaluation with hysteresis, mirroring
+// ThermalHelperImpl::getSeverityFromThresholds (the replay has no cold-bound
+// sensors to care about).
+ThrottlingSeverity hotSeverity(const SensorInfo &sensor_info, const ThrottlingSeverity prev,
+                               const float value) {
+    ThrottlingSeverity ret_hot = ThrottlingSeverity::NONE;
+    ThrottlingSeverity ret_hot_hysteresis = ThrottlingSeverity::NONE;
+    for (size_t i = static_cast<size_t>(ThrottlingSeverity::SHUTDOWN);
+         i > static_cast<size_t>(ThrottlingSeverity::NONE); --i) {
+        if (!std::isnan(sensor_info.hot_thresholds[i]) && sensor_info.hot_thresholds[i] <= value &&
+            ret_hot == ThrottlingSeverity::NONE) {
+            ret_hot = static_cast<ThrottlingSeverity>(i);
+        }
+        if (!std::isnan(sensor_info.hot_thresholds[i]) &&
+            (sensor_info.hot_thresholds[i] - sensor_info.hot_hysteresis[i]) < value &&
+            ret_hot_hysteresis == ThrottlingSeverity::NONE) {
+            ret_hot_hysteresis = static_cast<ThrottlingSeverity>(i);
+        }
+    }
+    if (static_cast<size_t>(ret_hot) < static_cast<size_t>(prev)) {
+        ret_hot = ret_hot_hysteresis;
+    }
+    return ret_hot;
+}
+
+// Resolve one sensor's raw reading for the current trace row: physical
+// sensors come straight from the trace columns, virtual sensors are computed
+// from their linked sensors with the same formula arithmetic as
+// readThermalSensor. Values are memoized in *resolved per row.
+bool resolveSensorValue(const std::string &sensor_name,
+                        const std::unordered_map<std::string, SensorInfo> &sensor_info_map,
+                        std::unordered_map<std::string, float> *resolved, const int depth,
+                        float *out) {
+    constexpr int kMaxVirtualSensorDepth = 10;
+    const auto resolved_it = resolved->find(sensor_name);
+    if (resolved_it != resolved->end()) {
+        *out = resolved_it->second;
+        return true;
+    }
+    if (depth > kMaxVirtualSensorDepth) {
+        LOG(ERROR) << "Virtual sensor chain too deep at " << sensor_name;
+        return false;
+    }
+
+    const auto info_it = sensor_info_map.find(sensor_name);
+    if (info_it == sensor_info_map.end()) {
+        LOG(ERROR) << sensor_name << " is not in the config";
+        return false;
+    }
+    const auto &sensor_info = info_it->second;
+    if (sensor_info.virtual_sensor_info == nullptr) {
+        // A physical sensor that the trace does not provide.
+        return false;
+    }
+    const auto &vs_info = *sensor_info.virtual_sensor_info;
+    if (vs_info.formula == FormulaOption::USE_ML_MODEL ||
+        vs_info.formula == FormulaOption::USE_LINEAR_MODEL) {
+        // Model files are not shipped with traces; these sensors are skipped.
+        return false;
+    }
+
+    float temp_val = 0.0;
+    for (size_t i = 0; i < vs_info.linked_sensors.size(); i++) {
+        if (vs_info.linked_sensors_type[i] != SensorFusionType::SENSOR) {
+            // ODPM readings are not part of the temperature trace.
+            return false;
+        }
+        float sensor_reading = NAN;
+        if (!resolveSensorValue(vs_info.linked_sensors[i], sensor_info_map, resolved, depth + 1,
+                                &sensor_reading)) {
+            return false;
+        }
+
+        float coefficient = NAN;
+        if (vs_info.coefficients_type[i] == SensorFusionType::SENSOR) {
+            if (!resolveSensorValue(vs_info.coefficients[i], sensor_info_map, resolved, depth + 1,
+                                    &coefficient)) {
+                return false;
+            }
+        } else if (!::android::base::ParseFloat(vs_info.coefficients[i], &coefficient)) {
+            LOG(ERROR) << sensor_name << " has unparsable coefficient "
+                       << vs_info.coefficients[i];
+            return false;
+        }
+
+        switch (vs_info.formula) {
+            case FormulaOption::COUNT_THRESHOLD:
+                if ((coefficient < 0 && sensor_reading < -coefficient) ||
+                    (coefficient >= 0 && sensor_reading >= coefficient))
+                    temp_val += 1;
+                break;
+            case FormulaOption::WEIGHTED_AVG:
+                temp_val += sensor_reading * coefficient;
+                break;
+            case FormulaOption::MAXIMUM:
+                if (i == 0)
+                    temp_val = std::numeric_limits<float>::lowest();
+                if (sensor_reading * coefficient > temp_val)
+                    temp_val = sensor_reading * coefficient;
+                break;
+            case FormulaOption::MINIMUM:
+                if (i == 0)
+                    temp_val = std::numeric_limits<float>::max();
+                if (sensor_reading * coefficient < temp_val)
+                    temp_val = sensor_reading * coefficient;
+                break;
+            default:
+                LOG(ERROR) << "Unknown formula type for sensor " << sensor_name;
+                return false;
+        }
+    }
+
+    *out = temp_val + vs_info.offset;
+    resolved->emplace(sensor_name, *out);
+    return true;
+}
+
+bool parseTraceHeader(const std::string &header, std::vector<std::string> *columns) {
+    *columns = ::android::base::Split(::android::base::Trim(header), ",");
+    if (columns->size() < 2 || (*columns)[0] != "time_ms") {
+        LOG(ERROR) << "Trace header must be \"time_ms,<sensor>,...\", got: " << header;
+        return false;
+    }
+    for (auto &column : *columns) {
+        column = ::android::base::Trim(column);
+    }
+    return true;
+}
+
+int runReplay(const ReplayOptions &options) {
+    Json::Value config;
+    std::unordered_map<std::string, SensorInfo> sensor_info_map;
+    std::unordered_map<std::string, CdevInfo> cooling_device_info_map;
+    if (!ParseThermalConfig(options.config_path, &config) ||
+        !ParseSensorInfo(config, &sensor_info_map) ||
+        !ParseCoolingDevice(config, &cooling_device_info_map)) {
+        LOG(ERROR) << "Failed to parse thermal config " << options.config_path;
+        return 1;
+    }
+
+    ThermalThrottling thermal_throttling;
+    ThermalStatsHelper thermal_stats_helper;
+    for (const auto &[sensor_name, sensor_info] : sensor_info_map) {
+        if (sensor_info.throttling_info == nullptr) {
+            continue;
+        }
+        if (!thermal_throttling.registerThermalThrottling(sensor_name, sensor_info.throttling_info,
+                                                          cooling_device_info_map)) {
+            LOG(ERROR) << sensor_name << " failed to register thermal throttling";
+            return 1;
+        }
+    }
+
+    std::ifstream trace(options.trace_path);
+    if (!trace.is_open()) {
+        LOG(ERROR) << "Failed to open trace " << options.trace_path;
+        return 1;
+    }
+    std::string line;
+    std::vector<std::string> columns;
+    if (!std::getline(trace, line) || !parseTraceHeader(line, &columns)) {
+        return 1;
+    }
+    for (size_t i = 1; i < columns.size(); i++) {
+        const auto info_it = sensor_info_map.find(columns[i]);
+        if (info_it == sensor_info_map.end()) {
+            LOG(ERROR) << "Trace column " << columns[i] << " is not in the config";
+            return 1;
+        }
+        if (info_it->second.virtual_sensor_info != nullptr) {
+            LOG(ERROR) << "Trace column " << columns[i]
+                       << " is a virtual sensor; traces carry physical readings only";
+            return 1;
+        }
+    }
+
+    std::unordered_map<std::string, SensorReplayStats> sensor_stats;
+    std::unordered_map<std::string, CdevReplayStats> cdev_stats;
+    std::unordered_set<std::string> skipped_sensors;
+    const std::unordered_map<std::string, PowerStatus> empty_power_status_map;
+    std::vector<std::string> cooling_devices_to_update;
+
+    int64_t prev_time_ms = -1;
+    int64_t first_time_ms = 0;
+    size_t rows = 0;
+    const auto wall_start = std::chrono::steady_clock::now();
+
+    while (std::getline(trace, line)) {
+        line = ::android::base::Trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        const auto fields = ::android::base::Split(line, ",");
+        if (fields.size() != columns.size()) {
+            LOG(ERROR) << "Trace row " << rows + 1 << " has " << fields.size() << " fields, want "
+                       << columns.size();
+            return 1;
+        }
+
+        double time_ms_raw;
+        if (!::android::base::ParseDouble(::android::base::Trim(fields[0]), &time_ms_raw)) {
+            LOG(ERROR) << "Unparsable time_ms in trace row " << rows + 1;
+            return 1;
+        }
+        const int64_t time_ms = static_cast<int64_t>(time_ms_raw);
+        if (prev_time_ms >= 0 && time_ms <= prev_time_ms) {
+            LOG(ERROR) << "time_ms is not monotonic at trace row " << rows + 1;
+            return 1;
+        }
+        if (prev_time_ms < 0) {
+            first_time_ms = time_ms;
+        }
+
+        std::unordered_map<std::string, float> resolved;
+        for (size_t i = 1; i < columns.size(); i++) {
+            float reading;
+            if (!::android::base::ParseFloat(::android::base::Trim(fields[i]), &reading)) {
+                LOG(ERROR) << "Unparsable reading for " << columns[i] << " in trace row "
+                           << rows + 1;
+                return 1;
+            }
+            resolved[columns[i]] = reading;
+        }
+
+        const std::chrono::milliseconds time_elapsed_ms(prev_time_ms < 0 ? 0
+                                                                         : time_ms - prev_time_ms);
+        for (const auto &[sensor_name, sensor_info] : sensor_info_map) {
+            if (!sensor_info.is_watch || skipped_sensors.count(sensor_name)) {
+                continue;
+            }
+            float raw_value;
+            if (!resolveSensorValue(sensor_name, sensor_info_map, &resolved, 0, &raw_value)) {
+                LOG(WARNING) << "Skipping " << sensor_name
+                             << ": not computable from this trace";
+                skipped_sensors.insert(sensor_name);
+                continue;
+            }
+
+            auto &stats = sensor_stats[sensor_name];
+            const float value = raw_value * sensor_info.multiplier;
+            const ThrottlingSeverity severity = hotSeverity(sensor_info, stats.severity, value);
+            stats.peak_temp = std::max(stats.peak_temp, value);
+            stats.time_in_severity_ms[static_cast<size_t>(severity)] += time_elapsed_ms.count();
+            if (severity != stats.severity) {
+                if (options.verbose) {
+                    std::cout << StringPrintf("%8" PRId64 " ms  %s: %s -> %s (%.2f)\n",
+                                              time_ms - first_time_ms, sensor_name.c_str(),
+                                              toString(stats.severity).c_str(),
+                                              toString(severity).c_str(), value);
+                }
+                stats.transitions++;
+                stats.severity = severity;
+            }
+
+            if (sensor_info.throttling_info == nullptr || prev_time_ms < 0) {
+                continue;
+            }
+            Temperature temp;
+            temp.type = sensor_info.type;
+            temp.name = sensor_name;
+            temp.value = value;
+            temp.throttlingStatus = severity;
+            if (severity == ThrottlingSeverity::NONE) {
+                thermal_throttling.clearThrottlingData(sensor_name, sensor_info);
+            } else {
+                thermal_throttling.thermalThrottlingUpdate(temp, sensor_info, severity,
+                                                           time_elapsed_ms, empty_power_status_map,
+                                                           cooling_device_info_map);
+            }
+            thermal_throttling.computeCoolingDevicesRequest(sensor_name, sensor_info, severity,
+                                                            &cooling_devices_to_update,
+                                                            &thermal_stats_helper);
+            cooling_devices_to_update.clear();
+        }
+
+        for (const auto &[cdev_name, cdev_info] : cooling_device_info_map) {
+            int max_state = 0;
+            if (!thermal_throttling.getCdevMaxRequest(cdev_name, &max_state)) {
+                continue;
+            }
+            auto &stats = cdev_stats[cdev_name];
+            stats.peak_state = std::max(stats.peak_state, max_state);
+            if (max_state > 0) {
+                stats.throttled_ms += time_elapsed_ms.count();
+                stats.state_time_ms += max_state * time_elapsed_ms.count();
+            }
+            if (max_state != stats.cur_state) {
+                if (options.verbose) {
+                    std::cout << StringPrintf("%8" PRId64 " ms  cdev %s: %d -> %d\n",
+                                              time_ms - first_time_ms, cdev_name.c_str(),
+                                              stats.cur_state, max_state);
+                }
+                stats.cur_state = max_state;
+                if (!options.cdev_dir.empty()) {
+                    const std::string path =
+                            StringPrintf("%s/%s", options.cdev_dir.c_str(), cdev_name.c_str());
+                    if (!::android::base::WriteStringToFile(std::to_string(max_state), path)) {
+                        LOG(ERROR) << "Failed to write " << path;
+                        return 1;
+                    }
+                }
+            }
+        }
+
+        prev_time_ms = time_ms;
+        rows++;
+    }
+
+    const auto wall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::steady_clock::now() - wall_start)
+                                 .count();
+    const int64_t trace_span_ms = rows ? prev_time_ms - first_time_ms : 0;
+    std::cout << StringPrintf("Replayed %zu samples spanning %" PRId64 " ms in %" PRId64
+                              " ms (%.0fx real time)\n",
+                              rows, trace_span_ms, wall_ms,
+                              wall_ms > 0 ? static_cast<double>(trace_span_ms) / wall_ms : 0.0);
+
+    for (const auto &[sensor_name, stats] : sensor_stats) {
+        std::cout << StringPrintf("Sensor %s: transitions=%d peak=%.2f", sensor_name.c_str(),
+                                  stats.transitions, stats.peak_temp);
+        for (size_t i = 1; i < static_cast<size_t>(kThrottlingSeverityCount); i++) {
+            if (stats.time_in_severity_ms[i] > 0) {
+                std::cout << StringPrintf(
+                        " %s=%" PRId64 "ms",
+                        toString(static_cast<ThrottlingSeverity>(i)).c_str(),
+                        stats.time_in_severity_ms[i]);
+            }
+        }
+        std::cout << "\n";
+    }
+    for (const auto &[cdev_name, stats] : cdev_stats) {
+        std::cout << StringPrintf(
+                "Cdev %s: duty=%.1f%% avg_state=%.2f peak_state=%d\n", cdev_name.c_str(),
+                trace_span_ms > 0 ? 100.0 * stats.throttled_ms / trace_span_ms : 0.0,
+                trace_span_ms > 0 ? static_cast<double>(stats.state_time_ms) / trace_span_ms : 0.0,
+                stats.peak_state);
+    }
+    return 0;
+}
+
+}  // namespace
+}  // namespace aidl::android::hardware::thermal::implementation
+
+int main(int argc, char **argv) {
+    using ::aidl::android::hardware::thermal::implementation::ReplayOptions;
+    using ::aidl::android::hardware::thermal::implementation::runReplay;
+
+    ReplayOptions options;
+    int opt;
+    while ((opt = getopt(argc, argv, "c:t:o:v")) != -1) {
+        switch (opt) {
+            case 'c':
+                options.config_path = optarg;
+                break;
+            case 't':
+                options.trace_path = optarg;
+                break;
+            case 'o':
+                options.cdev_dir = optarg;
+                break;
+            case 'v':
+                options.verbose = true;
+                break;
+            default:
+                break;
+        }
+    }
+    if (options.config_path.empty() || options.trace_path.empty()) {
+        std::cerr << "Usage: " << argv[0]
+                  << " -c thermal_info_config.json -t trace.csv [-o fake_cdev_dir] [-v]\n";
+        return 1;
+    }
+    return runReplay(options);
+}
@@ -22,14 +22,18 @@
 #include <android-base/properties.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
+#include <malloc.h>
 #include <utils/Trace.h>
 
+#include <functional>
 #include <iterator>
 #include <set>
 #include <sstream>
 #include <thread>
 #include <vector>
 
+#include "utils/thermal_event_journal.h"
+
 namespace aidl {
 namespace android {
 namespace hardware {
@@ -52,6 +56,14 @@ constexpr std::string_view kConfigProperty("vendor.thermal.config");
 constexpr std::string_view kConfigDefaultFileName("thermal_info_config.json");
 constexpr std::string_view kThermalGenlProperty("persist.vendor.enable.thermal.genl");
 constexpr std::string_view kThermalDisabledProperty("vendor.disable.thermalhal.control");
+constexpr std::string_view kThermalTripRearmProperty("persist.vendor.enable.thermal.trip.rearm");
+constexpr std::string_view kThermalParallelPollingProperty(
+        "persist.vendor.enable.thermal.parallel.polling");
+constexpr std::string_view kThermalAdaptivePollingProperty(
+        "persist.vendor.enable.thermal.adaptive.polling");
+// The adaptive scheduler may stretch an idle sensor's polling interval up to
+// this multiple of its configured polling_delay.
+constexpr int kAdaptivePollingMaxFactor = 10;
 
 namespace {
 using ::android::base::StringPrintf;
@@ -123,6 +135,11 @@ ThermalHelperImpl::ThermalHelperImpl(const NotificationCallback &cb)
             ::android::base::GetProperty(kConfigProperty.data(), kConfigDefaultFileName.data());
     bool thermal_throttling_disabled =
             ::android::base::GetBoolProperty(kThermalDisabledProperty.data(), false);
+    trip_rearm_enabled_ = ::android::base::GetBoolProperty(kThermalTripRearmProperty.data(), false);
+    parallel_polling_enabled_ =
+            ::android::base::GetBoolProperty(kThermalParallelPollingProperty.data(), false);
+    adaptive_polling_enabled_ =
+            ::android::base::GetBoolProperty(kThermalAdaptivePollingProperty.data(), false);
     bool ret = true;
     Json::Value config;
     if (!ParseThermalConfig(config_path, &config)) {
@@ -140,6 +157,17 @@ ThermalHelperImpl::ThermalHelperImpl(const NotificationCallback &cb)
         ret = false;
     }
 
+    if (!ParseThreadSchedulingInfo(config, &thread_scheduling_map_)) {
+        LOG(ERROR) << "Failed to parse thread scheduling config";
+        ret = false;
+    }
+
+    std::unordered_map<std::string, std::vector<std::string>> severity_group_sensors;
+    if (!ParseSeverityGroups(config, sensor_info_map_, &severity_group_sensors)) {
+        LOG(ERROR) << "Failed to parse severity groups config";
+        ret = false;
+    }
+
     auto tz_map = parseThermalPathMap(kSensorPrefix.data());
     if (!initializeSensorMap(tz_map)) {
         LOG(ERROR) << "Failed to initialize sensor map";
@@ -164,6 +192,12 @@ ThermalHelperImpl::ThermalHelperImpl(const NotificationCallback &cb)
         }
     }
 
+    // The retained info maps are fully built: drop the transient Json::Value
+    // tree now and hand its freed pages back to the kernel, instead of letting
+    // several MB of parse residue sit in RSS for the HAL's lifetime.
+    config = Json::Value();
+    mallopt(M_PURGE, 0);
+
     for (auto &name_status_pair : sensor_info_map_) {
         sensor_status_map_[name_status_pair.first] = {
                 .severity = ThrottlingSeverity::NONE,
@@ -231,6 +265,171 @@ ThermalHelperImpl::ThermalHelperImpl(const NotificationCallback &cb)
         }
     }
 
+    watcher_temps_scratch_.reserve(sensor_info_map_.size());
+    watcher_cdevs_scratch_.reserve(cooling_device_info_map_.size());
+    watcher_poll_scratch_.reserve(sensor_info_map_.size());
+
+    // The runtime structures below assume a fully populated status map: the
+    // population loop above bails on a failed throttling registration and
+    // leaves later sensors without entries, so skip straight to the !ret
+    // handling instead of interning dangling iterators.
+    if (ret) {
+        // Partition sensors into dependency groups with union-find: any two sensors
+        // joined through a virtual sensor's linked or trigger edges share a group,
+        // everything else can be polled concurrently.
+        {
+            std::unordered_map<std::string, std::string> parent;
+            for (const auto &name_info_pair : sensor_info_map_) {
+                parent[name_info_pair.first] = name_info_pair.first;
+            }
+            auto find = [&parent](std::string name) {
+                while (parent.at(name) != name) {
+                    name = parent.at(name);
+                }
+                return name;
+            };
+            auto unite = [&parent, &find](const std::string &a, const std::string &b) {
+                if (!parent.count(a) || !parent.count(b)) {
+                    return;
+                }
+                parent[find(a)] = find(b);
+            };
+            for (const auto &name_info_pair : sensor_info_map_) {
+                const auto &virtual_sensor_info = name_info_pair.second.virtual_sensor_info;
+                if (virtual_sensor_info == nullptr) {
+                    continue;
+                }
+                for (size_t i = 0; i < virtual_sensor_info->linked_sensors.size(); ++i) {
+                    if (virtual_sensor_info->linked_sensors_type[i] == SensorFusionType::SENSOR) {
+                        unite(name_info_pair.first, virtual_sensor_info->linked_sensors[i]);
+                    }
+                }
+                for (const auto &trigger_sensor : virtual_sensor_info->trigger_sensors) {
+                    unite(name_info_pair.first, trigger_sensor);
+                }
+            }
+            std::unordered_map<std::string, size_t> root_ids;
+            for (const auto &name_info_pair : sensor_info_map_) {
+                const auto root = find(name_info_pair.first);
+                const auto root_itr = root_ids.emplace(root, root_ids.size()).first;
+                sensor_group_map_[name_info_pair.first] = root_itr->second;
+            }
+        }
+
+        // Compile the virtual sensor dependency graph into a topologically sorted
+        // evaluation order: a virtual sensor's linked sensors come before it.
+        std::vector<std::string> watch_eval_order;
+        {
+            std::unordered_set<std::string> visited;
+            std::function<void(const std::string &)> visit = [&](const std::string &sensor_name) {
+                if (visited.count(sensor_name)) {
+                    return;
+                }
+                visited.insert(sensor_name);
+                const auto &sensor_info = sensor_info_map_.at(sensor_name);
+                if (sensor_info.virtual_sensor_info != nullptr) {
+                    const auto &virtual_sensor_info = *sensor_info.virtual_sensor_info;
+                    for (size_t i = 0; i < virtual_sensor_info.linked_sensors.size(); ++i) {
+                        if (virtual_sensor_info.linked_sensors_type[i] ==
+                                    SensorFusionType::SENSOR &&
+                            sensor_info_map_.count(virtual_sensor_info.linked_sensors[i])) {
+                            visit(virtual_sensor_info.linked_sensors[i]);
+                        }
+                    }
+                }
+                if (sensor_info.is_watch) {
+                    watch_eval_order.push_back(sensor_name);
+                }
+            };
+            for (const auto &name_info_pair : sensor_info_map_) {
+                visit(name_info_pair.first);
+            }
+        }
+
+        // Generate the severity transition tables once the watch flags are final.
+        for (const auto &name_info_pair : sensor_info_map_) {
+            if (name_info_pair.second.is_watch) {
+                severity_transition_table_map_[name_info_pair.first] =
+                        buildSeverityTransitionTable(name_info_pair.second);
+            }
+        }
+
+        // Interning pass: assign each watched sensor a dense id in evaluation
+        // order and resolve everything the polling cycle needs about it into
+        // SensorRuntime, so the hot path never hashes a sensor name. The maps
+        // never change shape after this point, so the node pointers stay valid.
+        sensor_runtime_.reserve(watch_eval_order.size());
+        for (const auto &sensor_name : watch_eval_order) {
+            const auto status_itr = sensor_status_map_.find(sensor_name);
+            if (status_itr == sensor_status_map_.end()) {
+                // Unreachable while this build is gated on ret, but never hand
+                // the hot path a dangling iterator if that gating changes.
+                LOG(FATAL) << sensor_name << " is watched but has no status entry";
+            }
+            SensorRuntime runtime = {
+                    .entry = &(*status_itr),
+                    .info = &sensor_info_map_.at(sensor_name),
+                    .transitions = &severity_transition_table_map_.at(sensor_name),
+                    .trigger_statuses = {},
+                    .group_id = sensor_group_map_.at(sensor_name),
+            };
+            if (runtime.info->virtual_sensor_info != nullptr) {
+                for (const auto &trigger_sensor :
+                     runtime.info->virtual_sensor_info->trigger_sensors) {
+                    if (sensor_status_map_.count(trigger_sensor)) {
+                        runtime.trigger_statuses.push_back(&sensor_status_map_.at(trigger_sensor));
+                    }
+                }
+            }
+            sensor_id_map_[sensor_name] = sensor_runtime_.size();
+            sensor_runtime_.push_back(std::move(runtime));
+        }
+
+        // Build the uevent dependency index once the ids are assigned: a physical
+        // sensor maps to itself and to every watched virtual sensor it triggers.
+        for (const auto &name_info_pair : sensor_info_map_) {
+            const auto &sensor_info = name_info_pair.second;
+            if (!sensor_info.is_watch) {
+                continue;
+            }
+            const size_t sensor_id = sensor_id_map_.at(name_info_pair.first);
+            if (sensor_info.virtual_sensor_info != nullptr) {
+                for (const auto &trigger_sensor :
+                     sensor_info.virtual_sensor_info->trigger_sensors) {
+                    uevent_dependent_sensors_map_[trigger_sensor].insert(sensor_id);
+                }
+            } else {
+                uevent_dependent_sensors_map_[name_info_pair.first].insert(sensor_id);
+            }
+        }
+
+        // Resolve the severity groups to dense ids and build the per-sensor group
+        // index the merge pass consults; all aggregates start at NONE, matching
+        // the initial sensor statuses.
+        sensor_severity_groups_.resize(sensor_runtime_.size());
+        for (auto &group_sensors_pair : severity_group_sensors) {
+            auto &group = severity_group_map_[group_sensors_pair.first];
+            group.sensor_ids.reserve(group_sensors_pair.second.size());
+            for (const auto &sensor_name : group_sensors_pair.second) {
+                const auto id_itr = sensor_id_map_.find(sensor_name);
+                if (id_itr == sensor_id_map_.end()) {
+                    LOG(ERROR) << "SeverityGroups[" << group_sensors_pair.first << "]'s sensor "
+                               << sensor_name << " is not watched";
+                    ret = false;
+                    continue;
+                }
+                group.sensor_ids.push_back(id_itr->second);
+                sensor_severity_groups_[id_itr->second].push_back(&group);
+            }
+        }
+    }
+
+    rebuildTemperatureThresholdsSnapshot();
+
+    if (!shmem_cache_.initialize(sensor_info_map_)) {
+        LOG(ERROR) << "Failed to initialize thermal shmem cache";
+    }
+
     if (!power_hal_service_.connect()) {
         LOG(ERROR) << "Fail to connect to Power Hal";
     } else {
@@ -264,6 +463,11 @@ ThermalHelperImpl::ThermalHelperImpl(const NotificationCallback &cb)
         thermal_watcher_->registerFilesToWatch(monitored_sensors);
     }
 
+    if (thread_scheduling_map_.count(kWatcherThreadName.data())) {
+        thermal_watcher_->setThreadSchedulingInfo(
+                thread_scheduling_map_.at(kWatcherThreadName.data()));
+    }
+
     // Need start watching after status map initialized
     is_initialized_ = thermal_watcher_->startWatchingDeviceFiles();
     if (!is_initialized_) {
@@ -417,10 +621,24 @@ bool ThermalHelperImpl::readTemperature(
         std::string_view sensor_name, Temperature *out,
         std::pair<ThrottlingSeverity, ThrottlingSeverity> *throttling_status,
         const bool force_no_cache) {
+    // The maps never change shape after init, so resolving the nodes takes no
+    // lock; their contents are read under the status map lock below.
+    const auto table_itr = severity_transition_table_map_.find(sensor_name.data());
+    return readTemperature(sensor_name, sensor_info_map_.at(sensor_name.data()),
+                           sensor_status_map_.at(sensor_name.data()),
+                           table_itr != severity_transition_table_map_.end() ? &table_itr->second
+                                                                             : nullptr,
+                           out, throttling_status, force_no_cache);
+}
+
+bool ThermalHelperImpl::readTemperature(
+        std::string_view sensor_name, const SensorInfo &sensor_info, SensorStatus &sensor_status,
+        const SeverityTransitionTable *transitions, Temperature *out,
+        std::pair<ThrottlingSeverity, ThrottlingSeverity> *throttling_status,
+        const bool force_no_cache) {
     // Return fail if the thermal sensor cannot be read.
     float temp = NAN;
     std::map<std::string, float> sensor_log_map;
-    auto &sensor_status = sensor_status_map_.at(sensor_name.data());
 
     if (!readThermalSensor(sensor_name, &temp, force_no_cache, &sensor_log_map)) {
         LOG(ERROR) << "Failed to read thermal sensor " << sensor_name.data();
@@ -434,7 +652,6 @@ bool ThermalHelperImpl::readTemperature(
         return false;
     }
 
-    const auto &sensor_info = sensor_info_map_.at(sensor_name.data());
     out->type = sensor_info.type;
     out->name = sensor_name.data();
     out->value = temp * sensor_info.multiplier;
@@ -446,13 +663,20 @@ bool ThermalHelperImpl::readTemperature(
         ThrottlingSeverity prev_hot_severity, prev_cold_severity;
         {
             // reader lock, readTemperature will be called in Binder call and the watcher thread.
+            // Also covers the transition table, which config reload regenerates
+            // under the writer lock.
             std::shared_lock<std::shared_mutex> _lock(sensor_status_map_mutex_);
             prev_hot_severity = sensor_status.prev_hot_severity;
             prev_cold_severity = sensor_status.prev_cold_severity;
+            if (transitions != nullptr) {
+                status = transitions->lookup(prev_hot_severity, prev_cold_severity, out->value);
+            } else {
+                status = getSeverityFromThresholds(
+                        sensor_info.hot_thresholds, sensor_info.cold_thresholds,
+                        sensor_info.hot_hysteresis, sensor_info.cold_hysteresis, prev_hot_severity,
+                        prev_cold_severity, out->value);
+            }
         }
-        status = getSeverityFromThresholds(sensor_info.hot_thresholds, sensor_info.cold_thresholds,
-                                           sensor_info.hot_hysteresis, sensor_info.cold_hysteresis,
-                                           prev_hot_severity, prev_cold_severity, out->value);
     }
 
     if (throttling_status) {
@@ -470,14 +694,27 @@ bool ThermalHelperImpl::readTemperature(
                         ? status.first
                         : status.second;
     }
+    shmem_cache_.update(sensor_name, out->value, out->throttlingStatus);
+
     if (sensor_info.is_watch) {
-        std::ostringstream sensor_log;
-        for (const auto &sensor_log_pair : sensor_log_map) {
-            sensor_log << sensor_log_pair.first << ":" << sensor_log_pair.second << " ";
-        }
         // Update sensor temperature time in state
         thermal_stats_helper_.updateSensorTempStatsBySeverity(sensor_name, out->throttlingStatus);
-        LOG(INFO) << sensor_name.data() << ":" << out->value << " raw data: " << sensor_log.str();
+        // The journal is the primary per-read instrumentation; the text log
+        // is a rate-limited heartbeat so logd stays quiet during storms.
+        auto *journal = ThermalEventJournal::getInstance();
+        journal->record(ThermalEventJournal::EventType::kTempUpdate, sensor_name, out->value,
+                        static_cast<int32_t>(out->throttlingStatus));
+        if (journal->shouldLogText(ThermalEventJournal::EventType::kTempUpdate, sensor_name)) {
+            // Reused across reads so steady-state logging does not allocate.
+            static thread_local std::string sensor_log;
+            sensor_log.clear();
+            for (const auto &sensor_log_pair : sensor_log_map) {
+                ::android::base::StringAppendF(&sensor_log, "%s:%0.2f ",
+                                               sensor_log_pair.first.c_str(),
+                                               sensor_log_pair.second);
+            }
+            LOG(INFO) << sensor_name.data() << ":" << out->value << " raw data: " << sensor_log;
+        }
     }
 
     return true;
@@ -509,16 +746,87 @@ void ThermalHelperImpl::updateCoolingDevices(const std::vector<std::string> &upd
     int max_state;
 
     for (const auto &target_cdev : updated_cdev) {
-        if (thermal_throttling_.getCdevMaxRequest(target_cdev, &max_state)) {
-            if (cooling_devices_.writeCdevFile(target_cdev, std::to_string(max_state))) {
-                ATRACE_INT(target_cdev.c_str(), max_state);
-                LOG(INFO) << "Successfully update cdev " << target_cdev << " sysfs to "
-                          << max_state;
-            } else {
-                LOG(ERROR) << "Failed to update cdev " << target_cdev << " sysfs to " << max_state;
+        if (!thermal_throttling_.getCdevMaxRequest(target_cdev, &max_state)) {
+            continue;
+        }
+        // Multiple sensors can queue the same cdev in one cycle; the first
+        // occurrence writes the aggregated request and the rest are skipped,
+        // as are requests that match the device's last written state.
+        const auto written_itr = cdev_written_state_map_.find(target_cdev);
+        if (written_itr != cdev_written_state_map_.end() && written_itr->second == max_state) {
+            LOG(VERBOSE) << "Skip update cdev " << target_cdev << " sysfs, already in state "
+                         << max_state;
+            continue;
+        }
+        if (cooling_devices_.writeCdevFile(target_cdev, std::to_string(max_state))) {
+            ATRACE_INT(target_cdev.c_str(), max_state);
+            cdev_written_state_map_[target_cdev] = max_state;
+            ThermalEventJournal::getInstance()->record(
+                    ThermalEventJournal::EventType::kCdevUpdate, target_cdev,
+                    static_cast<float>(max_state), max_state);
+            LOG(VERBOSE) << "Successfully update cdev " << target_cdev << " sysfs to " << max_state;
+        } else {
+            LOG(ERROR) << "Failed to update cdev " << target_cdev << " sysfs to " << max_state;
+        }
+    }
+}
+
+SeverityTransitionTable ThermalHelperImpl::buildSeverityTransitionTable(
+        const SensorInfo &sensor_info) const {
+    SeverityTransitionTable table;
+
+    // Every temperature the severity scan compares against becomes a region
+    // breakpoint; between two breakpoints every comparison is constant.
+    for (size_t i = 1; i < kThrottlingSeverityCount; ++i) {
+        if (!std::isnan(sensor_info.hot_thresholds[i])) {
+            table.breakpoints.push_back(sensor_info.hot_thresholds[i]);
+            const float hot_clear = sensor_info.hot_thresholds[i] - sensor_info.hot_hysteresis[i];
+            if (!std::isnan(hot_clear)) {
+                table.breakpoints.push_back(hot_clear);
+            }
+        }
+        if (!std::isnan(sensor_info.cold_thresholds[i])) {
+            table.breakpoints.push_back(sensor_info.cold_thresholds[i]);
+            const float cold_clear = sensor_info.cold_thresholds[i] + sensor_info.cold_hysteresis[i];
+            if (!std::isnan(cold_clear)) {
+                table.breakpoints.push_back(cold_clear);
             }
         }
     }
+    std::sort(table.breakpoints.begin(), table.breakpoints.end());
+    table.breakpoints.erase(std::unique(table.breakpoints.begin(), table.breakpoints.end()),
+                            table.breakpoints.end());
+
+    const size_t region_count = 2 * table.breakpoints.size() + 1;
+    table.hot_severity.resize(region_count * kThrottlingSeverityCount);
+    table.cold_severity.resize(region_count * kThrottlingSeverityCount);
+    for (size_t region = 0; region < region_count; ++region) {
+        // Pick a representative temperature inside the region: the breakpoint
+        // itself for odd regions, the closest representable value beside it
+        // for the open intervals.
+        float rep_value;
+        if (table.breakpoints.empty()) {
+            rep_value = 0.0f;
+        } else if (region % 2 == 1) {
+            rep_value = table.breakpoints[region / 2];
+        } else if (region == 0) {
+            rep_value = std::nextafter(table.breakpoints.front(),
+                                       -std::numeric_limits<float>::infinity());
+        } else {
+            rep_value = std::nextafter(table.breakpoints[region / 2 - 1],
+                                       std::numeric_limits<float>::infinity());
+        }
+        for (size_t prev = 0; prev < kThrottlingSeverityCount; ++prev) {
+            const auto prev_severity = static_cast<ThrottlingSeverity>(prev);
+            const auto result = getSeverityFromThresholds(
+                    sensor_info.hot_thresholds, sensor_info.cold_thresholds,
+                    sensor_info.hot_hysteresis, sensor_info.cold_hysteresis, prev_severity,
+                    prev_severity, rep_value);
+            table.hot_severity[region * kThrottlingSeverityCount + prev] = result.first;
+            table.cold_severity[region * kThrottlingSeverityCount + prev] = result.second;
+        }
+    }
+    return table;
 }
 
 std::pair<ThrottlingSeverity, ThrottlingSeverity> ThermalHelperImpl::getSeverityFromThresholds(
@@ -589,6 +897,7 @@ void ThermalHelperImpl::clearAllThrottling(void) {
         cooling_devices_.writeCdevFile(cdev_info_pair.first, "0");
     }
 
+    std::vector<Temperature> cleared_temps;
     for (auto &sensor_info_pair : sensor_info_map_) {
         sensor_info_pair.second.is_watch = false;
         sensor_info_pair.second.throttling_info.reset();
@@ -601,8 +910,8 @@ void ThermalHelperImpl::clearAllThrottling(void) {
                 .throttlingStatus = ThrottlingSeverity::NONE,
         };
         // Send callbacks with NONE severity
-        if (sensor_info_pair.second.send_cb && cb_) {
-            cb_(temp);
+        if (sensor_info_pair.second.send_cb) {
+            cleared_temps.emplace_back(temp);
         }
         // Disable thermal power hints
         if (sensor_info_pair.second.send_powerhint) {
@@ -611,6 +920,9 @@ void ThermalHelperImpl::clearAllThrottling(void) {
             }
         }
     }
+    if (!cleared_temps.empty() && cb_) {
+        cb_(cleared_temps);
+    }
 }
 
 bool ThermalHelperImpl::initializeSensorMap(
@@ -799,6 +1111,7 @@ void ThermalHelperImpl::initializeTrip(const std::unordered_map<std::string, std
                 }
             }
             monitored_sensors->insert(sensor_info.first);
+            monitored_tz_path_map_[sensor_info.first] = std::string(tz_path);
         }
 
         if (!trip_update) {
@@ -809,10 +1122,277 @@ void ThermalHelperImpl::initializeTrip(const std::unordered_map<std::string, std
     }
 }
 
+bool ThermalHelperImpl::getTemperatureHistory(std::string_view sensor_name,
+                                              std::vector<ThermalSample> *samples) const {
+    samples->clear();
+    const auto status_itr = sensor_status_map_.find(sensor_name.data());
+    if (status_itr == sensor_status_map_.end()) {
+        LOG(ERROR) << __func__ << ": sensor not found: " << sensor_name;
+        return false;
+    }
+
+    std::shared_lock<std::shared_mutex> _lock(sensor_status_map_mutex_);
+    const auto &ring = status_itr->second.temp_history;
+    samples->reserve(ring.count);
+    const size_t start = (ring.next + kTempHistoryLength - ring.count) % kTempHistoryLength;
+    for (size_t i = 0; i < ring.count; ++i) {
+        samples->push_back(ring.samples[(start + i) % kTempHistoryLength]);
+    }
+    return true;
+}
+
+bool ThermalHelperImpl::forecastSeverity(std::string_view sensor_name,
+                                         std::chrono::milliseconds horizon,
+                                         ThrottlingSeverity *severity) {
+    if (severity == nullptr || horizon <= std::chrono::milliseconds::zero()) {
+        return false;
+    }
+    const auto sensor_itr = sensor_info_map_.find(sensor_name.data());
+    if (sensor_itr == sensor_info_map_.end()) {
+        LOG(ERROR) << __func__ << ": sensor not found: " << sensor_name;
+        return false;
+    }
+    const auto &sensor_info = sensor_itr->second;
+
+    float forecast_temp = NAN;
+    // Prefer the model's own forecast when it predicts ahead: output labels
+    // beyond the first are the estimates one polling interval apart.
+    if (sensor_info.virtual_sensor_info != nullptr &&
+        sensor_info.virtual_sensor_info->vt_estimator != nullptr &&
+        sensor_info.polling_delay > std::chrono::milliseconds::zero()) {
+        std::vector<float> predictions;
+        if (sensor_info.virtual_sensor_info->vt_estimator->GetAllPredictions(&predictions) ==
+                    ::thermal::vtestimator::kVtEstimatorOk &&
+            predictions.size() > 1) {
+            const size_t label = std::min<size_t>(
+                    predictions.size() - 1, horizon.count() / sensor_info.polling_delay.count());
+            forecast_temp = predictions[label] * sensor_info.multiplier;
+        }
+    }
+
+    // Otherwise extrapolate the recent sample slope over the horizon.
+    if (std::isnan(forecast_temp)) {
+        std::shared_lock<std::shared_mutex> _lock(sensor_status_map_mutex_);
+        const auto status_itr = sensor_status_map_.find(sensor_name.data());
+        if (status_itr == sensor_status_map_.end()) {
+            return false;
+        }
+        const auto &ring = status_itr->second.temp_history;
+        if (ring.count < 2) {
+            return false;
+        }
+        const auto &newest =
+                ring.samples[(ring.next + kTempHistoryLength - 1) % kTempHistoryLength];
+        const auto &oldest =
+                ring.samples[(ring.next + kTempHistoryLength - ring.count) % kTempHistoryLength];
+        const auto window_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                newest.timestamp - oldest.timestamp);
+        if (window_ms <= std::chrono::milliseconds::zero()) {
+            return false;
+        }
+        const float slope_per_ms = (newest.temp - oldest.temp) / window_ms.count();
+        forecast_temp = newest.temp + slope_per_ms * horizon.count();
+    }
+
+    // A forecast carries no hysteresis state, so classify the predicted value
+    // against the thresholds directly.
+    *severity = getSeverityFromThresholds(sensor_info.hot_thresholds, sensor_info.cold_thresholds,
+                                          sensor_info.hot_hysteresis, sensor_info.cold_hysteresis,
+                                          ThrottlingSeverity::NONE, ThrottlingSeverity::NONE,
+                                          forecast_temp)
+                        .first;
+    return true;
+}
+
+void ThermalHelperImpl::updateSeverityGroups(size_t sensor_id, ThrottlingSeverity new_severity) {
+    for (auto *group : sensor_severity_groups_[sensor_id]) {
+        if (new_severity >= group->max_severity.load(std::memory_order_relaxed)) {
+            group->max_severity.store(new_severity, std::memory_order_relaxed);
+            continue;
+        }
+        // A member dropped below the aggregate: only a rescan can tell
+        // whether another member still holds it. Member severities are
+        // written by this thread only, so no status map lock is needed.
+        ThrottlingSeverity max_severity = new_severity;
+        for (const size_t id : group->sensor_ids) {
+            max_severity = std::max(max_severity, sensor_runtime_[id].entry->second.severity);
+        }
+        group->max_severity.store(max_severity, std::memory_order_relaxed);
+    }
+}
+
+bool ThermalHelperImpl::getAggregatedSeverity(std::string_view group_name,
+                                              ThrottlingSeverity *severity) const {
+    if (severity == nullptr) {
+        return false;
+    }
+    const auto group_itr = severity_group_map_.find(group_name.data());
+    if (group_itr == severity_group_map_.end()) {
+        LOG(ERROR) << __func__ << ": severity group not found: " << group_name;
+        return false;
+    }
+    *severity = group_itr->second.max_severity.load(std::memory_order_relaxed);
+    return true;
+}
+
+std::optional<ThreadSchedulingInfo> ThermalHelperImpl::getThreadSchedulingInfo(
+        std::string_view thread_name) const {
+    const auto it = thread_scheduling_map_.find(thread_name.data());
+    if (it == thread_scheduling_map_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+bool ThermalHelperImpl::reloadThermalConfig(std::string_view config_path) {
+    Json::Value config;
+    std::unordered_map<std::string, SensorInfo> new_sensor_info_map;
+
+    if (!ParseThermalConfig(config_path, &config)) {
+        LOG(ERROR) << __func__ << ": failed to read JSON config from " << config_path;
+        return false;
+    }
+
+    if (!ParseSensorInfo(config, &new_sensor_info_map)) {
+        LOG(ERROR) << __func__ << ": failed to parse sensor info config";
+        return false;
+    }
+
+    // Only tuning deltas are supported: the sensor set must match the live
+    // map. Adding or removing sensors or cooling devices changes the
+    // monitoring topology and still requires a HAL restart.
+    if (new_sensor_info_map.size() != sensor_info_map_.size()) {
+        LOG(ERROR) << __func__ << ": sensor count mismatch, reload rejected";
+        return false;
+    }
+    for (const auto &new_sensor_info_pair : new_sensor_info_map) {
+        if (!sensor_info_map_.count(new_sensor_info_pair.first)) {
+            LOG(ERROR) << __func__ << ": unknown sensor " << new_sensor_info_pair.first
+                       << ", reload rejected";
+            return false;
+        }
+    }
+
+    size_t updated_sensor_count = 0;
+    std::unique_lock<std::shared_mutex> _lock(sensor_status_map_mutex_);
+    for (auto &new_sensor_info_pair : new_sensor_info_map) {
+        auto &sensor_info = sensor_info_map_.at(new_sensor_info_pair.first);
+        const auto &new_sensor_info = new_sensor_info_pair.second;
+
+        if (sensor_info.hot_thresholds == new_sensor_info.hot_thresholds &&
+            sensor_info.cold_thresholds == new_sensor_info.cold_thresholds &&
+            sensor_info.hot_hysteresis == new_sensor_info.hot_hysteresis &&
+            sensor_info.cold_hysteresis == new_sensor_info.cold_hysteresis &&
+            sensor_info.polling_delay == new_sensor_info.polling_delay &&
+            sensor_info.passive_delay == new_sensor_info.passive_delay &&
+            sensor_info.step_ratio == new_sensor_info.step_ratio) {
+            continue;
+        }
+
+        sensor_info.hot_thresholds = new_sensor_info.hot_thresholds;
+        sensor_info.cold_thresholds = new_sensor_info.cold_thresholds;
+        sensor_info.hot_hysteresis = new_sensor_info.hot_hysteresis;
+        sensor_info.cold_hysteresis = new_sensor_info.cold_hysteresis;
+        sensor_info.polling_delay = new_sensor_info.polling_delay;
+        sensor_info.passive_delay = new_sensor_info.passive_delay;
+        sensor_info.step_ratio = new_sensor_info.step_ratio;
+        // Drop the cached value so the next poll re-evaluates the sensor
+        // against the new thresholds; severity and history are preserved.
+        sensor_status_map_.at(new_sensor_info_pair.first).thermal_cached.timestamp =
+                boot_clock::time_point::min();
+        if (sensor_info.is_watch) {
+            severity_transition_table_map_[new_sensor_info_pair.first] =
+                    buildSeverityTransitionTable(sensor_info);
+        }
+        updated_sensor_count++;
+        LOG(INFO) << __func__ << ": updated tuning of sensor " << new_sensor_info_pair.first;
+    }
+    _lock.unlock();
+
+    LOG(INFO) << __func__ << ": applied " << updated_sensor_count << " sensor tuning delta(s) from "
+              << config_path;
+    if (updated_sensor_count) {
+        rebuildTemperatureThresholdsSnapshot();
+        thermal_watcher_->wake();
+    }
+
+    // Drop the transient parse tree and return its freed pages to the kernel,
+    // matching what the constructor does after the initial parse.
+    config = Json::Value();
+    new_sensor_info_map.clear();
+    mallopt(M_PURGE, 0);
+    return true;
+}
+
+bool ThermalHelperImpl::rearmSensorTrip(std::string_view sensor_name,
+                                        ThrottlingSeverity severity) {
+    const auto tz_path_itr = monitored_tz_path_map_.find(sensor_name.data());
+    if (tz_path_itr == monitored_tz_path_map_.end()) {
+        return false;
+    }
+    const auto &sensor_info = sensor_info_map_.at(sensor_name.data());
+
+    // Trip up at the first valid threshold above the current severity. At top
+    // severity keep the trip parked on the current threshold so only the
+    // down-crossing can fire.
+    float trip = NAN;
+    size_t trip_idx = 0;
+    for (size_t i = static_cast<size_t>(severity) + 1; i < kThrottlingSeverityCount; ++i) {
+        if (!std::isnan(sensor_info.hot_thresholds[i]) &&
+            !std::isnan(sensor_info.hot_hysteresis[i])) {
+            trip = sensor_info.hot_thresholds[i];
+            trip_idx = i;
+            break;
+        }
+    }
+    // Trip down once the temperature falls below the current severity's
+    // threshold minus its hysteresis.
+    float clear = NAN;
+    for (size_t i = static_cast<size_t>(severity); i > 0; --i) {
+        if (!std::isnan(sensor_info.hot_thresholds[i]) &&
+            !std::isnan(sensor_info.hot_hysteresis[i])) {
+            if (std::isnan(trip)) {
+                trip = sensor_info.hot_thresholds[i];
+                trip_idx = i;
+            }
+            clear = sensor_info.hot_thresholds[i] - sensor_info.hot_hysteresis[i];
+            break;
+        }
+    }
+    if (std::isnan(trip)) {
+        return false;
+    }
+
+    const std::string trip_str =
+            std::to_string(std::lround(trip / sensor_info.multiplier));
+    std::string path = ::android::base::StringPrintf("%s/%s", tz_path_itr->second.c_str(),
+                                                     kSensorTripPointTempZeroFile.data());
+    if (!::android::base::WriteStringToFile(trip_str, path)) {
+        LOG(ERROR) << "fail to re-arm " << sensor_name << " trip point: " << path << " to "
+                   << trip_str;
+        return false;
+    }
+
+    const float hyst = std::isnan(clear) ? sensor_info.hot_hysteresis[trip_idx] : (trip - clear);
+    const std::string hyst_str = std::to_string(std::lround(hyst / sensor_info.multiplier));
+    path = ::android::base::StringPrintf("%s/%s", tz_path_itr->second.c_str(),
+                                         kSensorTripPointHystZeroFile.data());
+    if (!::android::base::WriteStringToFile(hyst_str, path)) {
+        LOG(ERROR) << "fail to re-arm " << sensor_name << " trip hyst: " << path << " to "
+                   << hyst_str;
+        return false;
+    }
+
+    LOG(VERBOSE) << "re-armed " << sensor_name << " trip to " << trip_str << " hyst " << hyst_str
+                 << " at severity " << toString(severity);
+    return true;
+}
+
 bool ThermalHelperImpl::fillCurrentTemperatures(bool filterType, bool filterCallback,
                                                 TemperatureType type,
                                                 std::vector<Temperature> *temperatures) {
-    std::vector<Temperature> ret;
+    temperatures->clear();
+    temperatures->reserve(sensor_info_map_.size());
     for (const auto &name_info_pair : sensor_info_map_) {
         Temperature temp;
         if (name_info_pair.second.is_hidden) {
@@ -825,57 +1405,76 @@ bool ThermalHelperImpl::fillCurrentTemperatures(bool filterType, bool filterCall
             continue;
         }
         if (readTemperature(name_info_pair.first, &temp, nullptr, false)) {
-            ret.emplace_back(std::move(temp));
+            temperatures->emplace_back(std::move(temp));
         } else {
             LOG(ERROR) << __func__
                        << ": error reading temperature for sensor: " << name_info_pair.first;
         }
     }
-    *temperatures = ret;
-    return ret.size() > 0;
+    return temperatures->size() > 0;
 }
 
-bool ThermalHelperImpl::fillTemperatureThresholds(
-        bool filterType, TemperatureType type,
-        std::vector<TemperatureThreshold> *thresholds) const {
-    std::vector<TemperatureThreshold> ret;
+void ThermalHelperImpl::rebuildTemperatureThresholdsSnapshot() {
+    auto snapshot = std::make_shared<std::vector<TemperatureThreshold>>();
+    snapshot->reserve(sensor_info_map_.size());
     for (const auto &name_info_pair : sensor_info_map_) {
         TemperatureThreshold temp;
         if (name_info_pair.second.is_hidden) {
             continue;
         }
-        if (filterType && name_info_pair.second.type != type) {
-            continue;
-        }
         if (readTemperatureThreshold(name_info_pair.first, &temp)) {
-            ret.emplace_back(std::move(temp));
+            snapshot->emplace_back(std::move(temp));
         } else {
             LOG(ERROR) << __func__ << ": error reading temperature threshold for sensor: "
                        << name_info_pair.first;
-            return false;
         }
     }
-    *thresholds = ret;
-    return ret.size() > 0;
+    std::lock_guard<std::mutex> _lock(thresholds_snapshot_mutex_);
+    thresholds_snapshot_ = std::move(snapshot);
+}
+
+bool ThermalHelperImpl::fillTemperatureThresholds(
+        bool filterType, TemperatureType type,
+        std::vector<TemperatureThreshold> *thresholds) const {
+    std::shared_ptr<const std::vector<TemperatureThreshold>> snapshot;
+    {
+        std::lock_guard<std::mutex> _lock(thresholds_snapshot_mutex_);
+        snapshot = thresholds_snapshot_;
+    }
+    if (snapshot == nullptr) {
+        return false;
+    }
+    if (!filterType) {
+        *thresholds = *snapshot;
+    } else {
+        thresholds->clear();
+        thresholds->reserve(snapshot->size());
+        for (const auto &threshold : *snapshot) {
+            if (threshold.type == type) {
+                thresholds->emplace_back(threshold);
+            }
+        }
+    }
+    return thresholds->size() > 0;
 }
 
 bool ThermalHelperImpl::fillCurrentCoolingDevices(
         bool filterType, CoolingType type, std::vector<CoolingDevice> *cooling_devices) const {
-    std::vector<CoolingDevice> ret;
+    cooling_devices->clear();
+    cooling_devices->reserve(cooling_device_info_map_.size());
     for (const auto &name_info_pair : cooling_device_info_map_) {
         CoolingDevice value;
         if (filterType && name_info_pair.second.type != type) {
             continue;
         }
         if (readCoolingDevice(name_info_pair.first, &value)) {
-            ret.emplace_back(std::move(value));
+            cooling_devices->emplace_back(std::move(value));
         } else {
             LOG(ERROR) << __func__ << ": error reading cooling device: " << name_info_pair.first;
             return false;
         }
     }
-    *cooling_devices = ret;
-    return ret.size() > 0;
+    return cooling_devices->size() > 0;
 }
 
 bool ThermalHelperImpl::readDataByType(std::string_view sensor_data, float *reading_value,
@@ -1083,57 +1682,126 @@ bool ThermalHelperImpl::readThermalSensor(std::string_view sensor_name, float *t
         std::unique_lock<std::shared_mutex> _lock(sensor_status_map_mutex_);
         sensor_status.thermal_cached.temp = *temp;
         sensor_status.thermal_cached.timestamp = now;
+        sensor_status.temp_history.push({(*temp) * sensor_info.multiplier, now});
     }
     auto real_temp = (*temp) * sensor_info.multiplier;
     thermal_stats_helper_.updateSensorTempStatsByThreshold(sensor_name, real_temp);
     return true;
 }
 
+void ThermalHelperImpl::pollSensor(SensorPollState *poll_state) {
+    const SensorRuntime &runtime = *poll_state->runtime;
+    const auto &sensor_name = runtime.entry->first;
+
+    ATRACE_NAME(StringPrintf("ThermalHelper::pollSensor - %s", sensor_name.data()).c_str());
+    if (!readTemperature(sensor_name, *runtime.info, runtime.entry->second, runtime.transitions,
+                         &poll_state->temp, &poll_state->throttling_status,
+                         poll_state->force_no_cache)) {
+        LOG(ERROR) << __func__ << ": error reading temperature for sensor: " << sensor_name;
+        poll_state->read_ok = false;
+        return;
+    }
+    poll_state->read_ok = true;
+}
+
+std::chrono::milliseconds ThermalHelperImpl::getAdaptiveSleepMs(
+        const SensorInfo &sensor_info, const SensorStatus &sensor_status) const {
+    const auto max_sleep_ms = sensor_info.polling_delay * kAdaptivePollingMaxFactor;
+    const auto &ring = sensor_status.temp_history;
+    if (ring.count < 2) {
+        return sensor_info.polling_delay;
+    }
+
+    const auto &newest = ring.samples[(ring.next + kTempHistoryLength - 1) % kTempHistoryLength];
+    const auto &oldest =
+            ring.samples[(ring.next + kTempHistoryLength - ring.count) % kTempHistoryLength];
+    const auto window_ms = std::chrono::duration_cast<std::chrono::milliseconds>(newest.timestamp -
+                                                                                 oldest.timestamp);
+    if (window_ms <= std::chrono::milliseconds::zero()) {
+        return sensor_info.polling_delay;
+    }
+
+    // Headroom to the nearest hot threshold above the current temperature.
+    float headroom = std::numeric_limits<float>::max();
+    for (size_t i = 0; i < kThrottlingSeverityCount; ++i) {
+        if (std::isnan(sensor_info.hot_thresholds[i])) {
+            continue;
+        }
+        const float distance = sensor_info.hot_thresholds[i] - newest.temp;
+        if (distance > 0) {
+            headroom = std::min(headroom, distance);
+        }
+    }
+    if (headroom == std::numeric_limits<float>::max()) {
+        // No hot threshold above the current value; let the severity logic
+        // drive the polling rate.
+        return sensor_info.polling_delay;
+    }
+
+    const float slope_per_ms = (newest.temp - oldest.temp) / window_ms.count();
+    if (slope_per_ms <= 0) {
+        // Stable or cooling sensor, stretch toward the maximum interval.
+        return max_sleep_ms;
+    }
+
+    // Poll again after half the projected time to the nearest threshold so a
+    // ramp is observed well before it crosses.
+    const auto sleep_ms =
+            std::chrono::milliseconds(static_cast<int64_t>(headroom / slope_per_ms / 2));
+    return std::max(sensor_info.passive_delay, std::min(sleep_ms, max_sleep_ms));
+}
+
 // This is called in the different thread context and will update sensor_status
 // uevent_sensors is the set of sensors which trigger uevent from thermal core driver.
 std::chrono::milliseconds ThermalHelperImpl::thermalWatcherCallbackFunc(
         const std::set<std::string> &uevent_sensors) {
-    std::vector<Temperature> temps;
-    std::vector<std::string> cooling_devices_to_update;
+    std::vector<Temperature> &temps = watcher_temps_scratch_;
+    std::vector<std::string> &cooling_devices_to_update = watcher_cdevs_scratch_;
+    temps.clear();
+    cooling_devices_to_update.clear();
     boot_clock::time_point now = boot_clock::now();
     auto min_sleep_ms = std::chrono::milliseconds::max();
     bool power_data_is_updated = false;
 
     ATRACE_CALL();
-    for (auto &name_status_pair : sensor_status_map_) {
+    // Resolve the affected subtree once, as dense ids, instead of scanning
+    // each virtual sensor's trigger list per sensor per wake.
+    std::unordered_set<size_t> uevent_affected_sensors;
+    for (const auto &uevent_sensor : uevent_sensors) {
+        const auto it = uevent_dependent_sensors_map_.find(uevent_sensor);
+        if (it != uevent_dependent_sensors_map_.end()) {
+            uevent_affected_sensors.insert(it->second.begin(), it->second.end());
+        }
+    }
+
+    // Planning pass: decide which sensors to read this cycle and collect their
+    // per-cycle parameters; sensors that are not due only vote on the timeout.
+    std::vector<SensorPollState> &poll_states = watcher_poll_scratch_;
+    poll_states.clear();
+    for (size_t sensor_id = 0; sensor_id < sensor_runtime_.size(); ++sensor_id) {
+        const SensorRuntime &runtime = sensor_runtime_[sensor_id];
+        auto &name_status_pair = *runtime.entry;
         bool force_update = false;
         bool force_no_cache = false;
-        Temperature temp;
-        TemperatureThreshold threshold;
         SensorStatus &sensor_status = name_status_pair.second;
-        const SensorInfo &sensor_info = sensor_info_map_.at(name_status_pair.first);
+        const SensorInfo &sensor_info = *runtime.info;
         bool max_throttling = false;
 
-        // Only handle the sensors in allow list
-        if (!sensor_info.is_watch) {
-            continue;
-        }
-
-        ATRACE_NAME(StringPrintf("ThermalHelper::thermalWatcherCallbackFunc - %s",
-                                 name_status_pair.first.data())
-                            .c_str());
-
         std::chrono::milliseconds time_elapsed_ms = std::chrono::milliseconds::zero();
         auto sleep_ms = (sensor_status.severity != ThrottlingSeverity::NONE)
                                 ? sensor_info.passive_delay
                                 : sensor_info.polling_delay;
 
-        if (sensor_info.virtual_sensor_info != nullptr &&
-            !sensor_info.virtual_sensor_info->trigger_sensors.empty()) {
-            for (size_t i = 0; i < sensor_info.virtual_sensor_info->trigger_sensors.size(); i++) {
-                const auto &trigger_sensor_status =
-                        sensor_status_map_.at(sensor_info.virtual_sensor_info->trigger_sensors[i]);
-                if (trigger_sensor_status.severity != ThrottlingSeverity::NONE) {
-                    sleep_ms = sensor_info.passive_delay;
-                    break;
-                }
+        for (const SensorStatus *trigger_sensor_status : runtime.trigger_statuses) {
+            if (trigger_sensor_status->severity != ThrottlingSeverity::NONE) {
+                sleep_ms = sensor_info.passive_delay;
+                break;
             }
         }
+        if (adaptive_polling_enabled_ && sleep_ms == sensor_info.polling_delay &&
+            sensor_status.severity == ThrottlingSeverity::NONE) {
+            sleep_ms = getAdaptiveSleepMs(sensor_info, sensor_status);
+        }
         // Check if the sensor need to be updated
         if (sensor_status.last_update_time == boot_clock::time_point::min()) {
             force_update = true;
@@ -1142,15 +1810,7 @@ std::chrono::milliseconds ThermalHelperImpl::thermalWatcherCallbackFunc(
                     now - sensor_status.last_update_time);
             if (uevent_sensors.size()) {
                 if (sensor_info.virtual_sensor_info != nullptr) {
-                    for (size_t i = 0; i < sensor_info.virtual_sensor_info->trigger_sensors.size();
-                         i++) {
-                        if (uevent_sensors.find(
-                                    sensor_info.virtual_sensor_info->trigger_sensors[i]) !=
-                            uevent_sensors.end()) {
-                            force_update = true;
-                            break;
-                        }
-                    }
+                    force_update = uevent_affected_sensors.count(sensor_id) > 0;
                 } else if (uevent_sensors.find(name_status_pair.first) != uevent_sensors.end()) {
                     force_update = true;
                     force_no_cache = true;
@@ -1182,18 +1842,65 @@ std::chrono::milliseconds ThermalHelperImpl::thermalWatcherCallbackFunc(
             continue;
         }
 
-        std::pair<ThrottlingSeverity, ThrottlingSeverity> throttling_status;
-        if (!readTemperature(name_status_pair.first, &temp, &throttling_status, force_no_cache)) {
-            LOG(ERROR) << __func__
-                       << ": error reading temperature for sensor: " << name_status_pair.first;
-            continue;
+        poll_states.push_back(SensorPollState{
+                .runtime = &runtime,
+                .force_no_cache = force_no_cache,
+                .max_throttling = max_throttling,
+                .read_ok = false,
+                .time_elapsed_ms = time_elapsed_ms,
+                .sleep_ms = sleep_ms,
+                .temp = {},
+                .throttling_status = {ThrottlingSeverity::NONE, ThrottlingSeverity::NONE},
+        });
+    }
+
+    // Read pass: dependency groups are disjoint sensor subtrees, so when more
+    // than one group is due the reads can proceed concurrently. The relative
+    // order inside poll_states is topological and bucketing preserves it.
+    bool read_in_parallel = false;
+    if (parallel_polling_enabled_ && poll_states.size() > 1) {
+        std::map<size_t, std::vector<size_t>> group_work;
+        for (size_t i = 0; i < poll_states.size(); ++i) {
+            group_work[poll_states[i].runtime->group_id].push_back(i);
         }
-        if (!readTemperatureThreshold(name_status_pair.first, &threshold)) {
-            LOG(ERROR) << __func__ << ": error reading temperature threshold for sensor: "
-                       << name_status_pair.first;
-            continue;
+        if (group_work.size() > 1) {
+            read_in_parallel = true;
+            std::vector<std::thread> workers;
+            workers.reserve(group_work.size());
+            for (auto &group_work_pair : group_work) {
+                workers.emplace_back([this, &poll_states, indices = &group_work_pair.second]() {
+                    for (const size_t idx : *indices) {
+                        pollSensor(&poll_states[idx]);
+                    }
+                });
+            }
+            for (auto &worker : workers) {
+                worker.join();
+            }
         }
+    }
+    if (!read_in_parallel) {
+        for (auto &poll_state : poll_states) {
+            pollSensor(&poll_state);
+        }
+    }
 
+    // Merge pass: apply severity transitions, throttling updates and timeout
+    // votes serially on the watcher thread.
+    for (auto &poll_state : poll_states) {
+        if (!poll_state.read_ok) {
+            continue;
+        }
+        auto &name_status_pair = *poll_state.runtime->entry;
+        SensorStatus &sensor_status = name_status_pair.second;
+        const SensorInfo &sensor_info = *poll_state.runtime->info;
+        Temperature &temp = poll_state.temp;
+        const auto &throttling_status = poll_state.throttling_status;
+        const auto time_elapsed_ms = poll_state.time_elapsed_ms;
+        const bool max_throttling = poll_state.max_throttling;
+        auto sleep_ms = poll_state.sleep_ms;
+
+        bool severity_changed = false;
         {
             // writer lock
             std::unique_lock<std::shared_mutex> _lock(sensor_status_map_mutex_);
@@ -1205,13 +1912,30 @@ std::chrono::milliseconds ThermalHelperImpl::thermalWatcherCallbackFunc(
             }
             if (temp.throttlingStatus != sensor_status.severity) {
                 temps.push_back(temp);
+                severity_changed = true;
                 sensor_status.severity = temp.throttlingStatus;
                 sleep_ms = (sensor_status.severity != ThrottlingSeverity::NONE)
                                    ? sensor_info.passive_delay
-                                   : sensor_info.polling_delay;
+                                   : (adaptive_polling_enabled_
+                                              ? getAdaptiveSleepMs(sensor_info, sensor_status)
+                                              : sensor_info.polling_delay);
             }
         }
 
+        if (severity_changed) {
+            ThermalEventJournal::getInstance()->record(
+                    ThermalEventJournal::EventType::kSeverityChange, name_status_pair.first,
+                    temp.value, static_cast<int32_t>(sensor_status.severity));
+            updateSeverityGroups(poll_state.runtime - sensor_runtime_.data(),
+                                 sensor_status.severity);
+        }
+
+        // Keep the kernel trip point tracking the severity state so the zone
+        // stays silent until the next meaningful crossing.
+        if (severity_changed && trip_rearm_enabled_ && sensor_info.virtual_sensor_info == nullptr) {
+            rearmSensorTrip(name_status_pair.first, sensor_status.severity);
+        }
+
         if (!power_data_is_updated) {
             power_files_.refreshPowerStatus();
             power_data_is_updated = true;
@@ -1243,15 +1967,21 @@ std::chrono::milliseconds ThermalHelperImpl::thermalWatcherCallbackFunc(
     }
 
     if (!temps.empty()) {
+        std::vector<Temperature> update_temps;
         for (const auto &t : temps) {
-            if (sensor_info_map_.at(t.name).send_cb && cb_) {
-                cb_(t);
+            if (sensor_info_map_.at(t.name).send_cb) {
+                update_temps.emplace_back(t);
             }
 
             if (sensor_info_map_.at(t.name).send_powerhint) {
                 power_hal_service_.sendPowerExtHint(t);
             }
         }
+        // Deliver the whole cycle's updates in one fan-out so simultaneous
+        // severity changes wake each client once.
+        if (!update_temps.empty() && cb_) {
+            cb_(update_temps);
+        }
     }
 
     int count_failed_reporting = thermal_stats_helper_.reportStats();
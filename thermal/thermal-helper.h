@@ -18,20 +18,25 @@
 
 #include <aidl/android/hardware/thermal/IThermal.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <map>
 #include <mutex>
+#include <optional>
 #include <shared_mutex>
 #include <string>
 #include <string_view>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "utils/power_files.h"
 #include "utils/powerhal_helper.h"
 #include "utils/thermal_files.h"
+#include "utils/thermal_shmem_cache.h"
 #include "utils/thermal_info.h"
 #include "utils/thermal_stats_helper.h"
 #include "utils/thermal_throttling.h"
@@ -45,7 +50,10 @@ namespace implementation {
 
 using ::android::sp;
 
-using NotificationCallback = std::function<void(const Temperature &t)>;
+// Invoked once per polling cycle with every updated temperature that has
+// send_cb set, so the receiver can filter and fan the whole batch out to its
+// clients in one pass instead of once per sensor.
+using NotificationCallback = std::function<void(const std::vector<Temperature> &temps)>;
 
 // Get thermal_zone type
 bool getThermalZoneTypeById(int tz_id, std::string *);
@@ -66,6 +74,22 @@ struct OverrideStatus {
     bool pending_update;
 };
 
+// Fixed-size ring of the most recent temperature samples, preallocated so the
+// polling loop records history without touching the heap. Retrieval returns
+// oldest-first in a single pass.
+constexpr size_t kTempHistoryLength = 60;
+struct TempHistoryRing {
+    std::array<ThermalSample, kTempHistoryLength> samples;
+    size_t next = 0;
+    size_t count = 0;
+
+    void push(const ThermalSample &sample) {
+        samples[next] = sample;
+        next = (next + 1) % kTempHistoryLength;
+        count = std::min(count + 1, kTempHistoryLength);
+    }
+};
+
 struct SensorStatus {
     ThrottlingSeverity severity;
     ThrottlingSeverity prev_hot_severity;
@@ -73,6 +97,88 @@ struct SensorStatus {
     boot_clock::time_point last_update_time;
     ThermalSample thermal_cached;
     OverrideStatus override_status;
+    TempHistoryRing temp_history;
+};
+
+// Flat copy of the per-sensor status fields dump() prints. SensorStatus
+// itself is not copyable (the emul override is a unique_ptr), so dump takes
+// these snapshots under the status map lock and formats with no lock held.
+struct SensorStatusOverview {
+    std::string name;
+    ThermalSample thermal_cached;
+    bool has_emul_setting;
+    float emul_temp;
+    int emul_severity;
+    bool emul_max_throttling;
+};
+
+// Precomputed (previous severity, temperature region) to severity lookup. The
+// temperature axis is bucketed at every threshold and hysteresis-clear value,
+// so resolving a sample is one binary search plus two table reads instead of
+// the scan over all severities. Thresholds come from the runtime config, so
+// the table is generated per sensor at initialization.
+struct SeverityTransitionTable {
+    // Sorted unique threshold and clear values splitting the temperature axis.
+    std::vector<float> breakpoints;
+    // Region-major tables: entry index = region * kThrottlingSeverityCount +
+    // previous severity. Odd regions are the exact breakpoint values, even
+    // regions the open intervals between them.
+    std::vector<ThrottlingSeverity> hot_severity;
+    std::vector<ThrottlingSeverity> cold_severity;
+
+    size_t regionOf(float value) const {
+        const auto it = std::lower_bound(breakpoints.begin(), breakpoints.end(), value);
+        const size_t idx = it - breakpoints.begin();
+        return (it != breakpoints.end() && *it == value) ? 2 * idx + 1 : 2 * idx;
+    }
+
+    std::pair<ThrottlingSeverity, ThrottlingSeverity> lookup(ThrottlingSeverity prev_hot_severity,
+                                                             ThrottlingSeverity prev_cold_severity,
+                                                             float value) const {
+        const size_t base = regionOf(value) * kThrottlingSeverityCount;
+        return std::make_pair(hot_severity[base + static_cast<size_t>(prev_hot_severity)],
+                              cold_severity[base + static_cast<size_t>(prev_cold_severity)]);
+    }
+};
+
+// One watched sensor's interned runtime references, resolved from the
+// name-keyed maps in one pass at initialization. The maps never change shape
+// after the constructor (config reload only rewrites values in place), so the
+// pointers stay valid and a polling cycle runs entirely on ids and pointers;
+// string hashing is left to the API boundaries.
+struct SensorRuntime {
+    // Node in sensor_status_map_; entry->first is the interned name.
+    std::pair<const std::string, SensorStatus> *entry;
+    const SensorInfo *info;
+    const SeverityTransitionTable *transitions;
+    // A virtual sensor's trigger sensors' statuses, for the passive-delay vote.
+    std::vector<const SensorStatus *> trigger_statuses;
+    // Dependency group for the parallel read pass.
+    size_t group_id;
+};
+
+// One planned sensor read within a polling cycle: filled by the planning pass,
+// executed (possibly in parallel per dependency group) by the read pass and
+// consumed serially by the merge pass.
+struct SensorPollState {
+    const SensorRuntime *runtime;
+    bool force_no_cache;
+    bool max_throttling;
+    bool read_ok;
+    std::chrono::milliseconds time_elapsed_ms;
+    std::chrono::milliseconds sleep_ms;
+    Temperature temp;
+    std::pair<ThrottlingSeverity, ThrottlingSeverity> throttling_status;
+};
+
+// One severity group from the SeverityGroups config section: the member
+// sensors' dense ids and the maintained reduction over their severities. The
+// aggregate is rewritten by the watcher thread as member severities change
+// and read lock-free by getAggregatedSeverity, so a governor polling a group
+// costs one atomic load instead of a getTemperatures round trip.
+struct SeverityGroupRuntime {
+    std::vector<size_t> sensor_ids;
+    std::atomic<ThrottlingSeverity> max_severity{ThrottlingSeverity::NONE};
 };
 
 class ThermalHelper {
@@ -111,6 +217,42 @@ class ThermalHelper {
     virtual bool isAidlPowerHalExist() = 0;
     virtual bool isPowerHalConnected() = 0;
     virtual bool isPowerHalExtConnected() = 0;
+    // Copy the retained temperature history of a sensor, oldest sample first.
+    virtual bool getTemperatureHistory(std::string_view /*sensor_name*/,
+                                       std::vector<ThermalSample> * /*samples*/) const {
+        return false;
+    }
+    // Re-parse the config and apply the sensor tuning deltas without a restart.
+    virtual bool reloadThermalConfig(std::string_view /*config_path*/) { return false; }
+    // Point-in-time copies for dump(): taken under the owning locks and then
+    // formatted with no lock held, so dumpsys never walks a live map while
+    // the polling and throttling threads mutate it.
+    virtual std::vector<SensorStatusOverview> GetSensorStatusOverview() const { return {}; }
+    virtual std::unordered_map<std::string, ThermalThrottlingStatus>
+    GetThermalThrottlingStatusMapSnapshot() const {
+        return {};
+    }
+    // Forecast the sensor's hot severity horizon milliseconds from now, so
+    // clients can begin ramping down before a trip instead of reacting to it.
+    virtual bool forecastSeverity(std::string_view /*sensor_name*/,
+                                  std::chrono::milliseconds /*horizon*/,
+                                  ThrottlingSeverity * /*severity*/) {
+        return false;
+    }
+    // Max severity across the named SeverityGroups config group, maintained
+    // incrementally as member severities change. Returns false for a group
+    // the config does not declare.
+    virtual bool getAggregatedSeverity(std::string_view /*group_name*/,
+                                       ThrottlingSeverity * /*severity*/) const {
+        return false;
+    }
+    // Scheduling overrides parsed from the ThreadScheduling config section
+    // for the named HAL service thread; nullopt when the config leaves the
+    // thread at default scheduling.
+    virtual std::optional<ThreadSchedulingInfo> getThreadSchedulingInfo(
+            std::string_view /*thread_name*/) const {
+        return std::nullopt;
+    }
 };
 
 class ThermalHelperImpl : public ThermalHelper {
@@ -144,6 +286,15 @@ class ThermalHelperImpl : public ThermalHelper {
 
     bool readTemperatureThreshold(std::string_view sensor_name,
                                   TemperatureThreshold *out) const override;
+    bool getTemperatureHistory(std::string_view sensor_name,
+                               std::vector<ThermalSample> *samples) const override;
+    bool reloadThermalConfig(std::string_view config_path) override;
+    bool forecastSeverity(std::string_view sensor_name, std::chrono::milliseconds horizon,
+                          ThrottlingSeverity *severity) override;
+    bool getAggregatedSeverity(std::string_view group_name,
+                               ThrottlingSeverity *severity) const override;
+    std::optional<ThreadSchedulingInfo> getThreadSchedulingInfo(
+            std::string_view thread_name) const override;
     // Read the value of a single cooling device.
     bool readCoolingDevice(std::string_view cooling_device, CoolingDevice *out) const override;
     // Get SensorInfo Map
@@ -164,6 +315,24 @@ class ThermalHelperImpl : public ThermalHelper {
             const override {
         return thermal_throttling_.GetThermalThrottlingStatusMap();
     }
+    std::vector<SensorStatusOverview> GetSensorStatusOverview() const override {
+        std::shared_lock<std::shared_mutex> _lock(sensor_status_map_mutex_);
+        std::vector<SensorStatusOverview> overview;
+        overview.reserve(sensor_status_map_.size());
+        for (const auto &sensor_status_pair : sensor_status_map_) {
+            const auto &override_status = sensor_status_pair.second.override_status;
+            overview.push_back({sensor_status_pair.first, sensor_status_pair.second.thermal_cached,
+                                override_status.emul_temp != nullptr,
+                                override_status.emul_temp ? override_status.emul_temp->temp : 0,
+                                override_status.emul_temp ? override_status.emul_temp->severity : 0,
+                                override_status.max_throttling});
+        }
+        return overview;
+    }
+    std::unordered_map<std::string, ThermalThrottlingStatus> GetThermalThrottlingStatusMapSnapshot()
+            const override {
+        return thermal_throttling_.GetThermalThrottlingStatusMapSnapshot();
+    }
     // Get PowerRailInfo Map
     const std::unordered_map<std::string, PowerRailInfo> &GetPowerRailInfoMap() const override {
         return power_files_.GetPowerRailInfoMap();
@@ -188,6 +357,10 @@ class ThermalHelperImpl : public ThermalHelper {
     bool isPowerHalConnected() override { return power_hal_service_.isPowerHalConnected(); }
     bool isPowerHalExtConnected() override { return power_hal_service_.isPowerHalExtConnected(); }
 
+    // Shared-memory temperature cache, to be duped out to trusted clients so
+    // repeated headroom queries can skip the binder round trip.
+    const ThermalShmemCache &GetShmemCache() const { return shmem_cache_; }
+
   private:
     bool initializeSensorMap(const std::unordered_map<std::string, std::string> &path_map);
     bool initializeCoolingDevices(const std::unordered_map<std::string, std::string> &path_map);
@@ -195,6 +368,30 @@ class ThermalHelperImpl : public ThermalHelper {
     void setMinTimeout(SensorInfo *sensor_info);
     void initializeTrip(const std::unordered_map<std::string, std::string> &path_map,
                         std::set<std::string> *monitored_sensors, bool thermal_genl_enabled);
+    // Re-arm the kernel trip point of a monitored thermal zone around the
+    // sensor's current severity so the zone only notifies when the severity
+    // can actually change, keeping the steady-state HAL wakeup rate near zero.
+    bool rearmSensorTrip(std::string_view sensor_name, ThrottlingSeverity severity);
+    // Execute one planned sensor read; safe to run concurrently for sensors in
+    // different dependency groups.
+    void pollSensor(SensorPollState *poll_state);
+    // readTemperature body with the sensor's map nodes already resolved; the
+    // public overload looks them up by name, the polling path hands over the
+    // interned SensorRuntime pointers directly.
+    bool readTemperature(std::string_view sensor_name, const SensorInfo &sensor_info,
+                         SensorStatus &sensor_status, const SeverityTransitionTable *transitions,
+                         Temperature *out,
+                         std::pair<ThrottlingSeverity, ThrottlingSeverity> *throttling_status,
+                         const bool force_no_cache);
+    // Compute the next-poll interval of an unthrottled sensor from its recent
+    // temperature slope and the headroom to the nearest hot threshold.
+    std::chrono::milliseconds getAdaptiveSleepMs(const SensorInfo &sensor_info,
+                                                 const SensorStatus &sensor_status) const;
+    // Generate the severity transition table of one sensor from its thresholds.
+    SeverityTransitionTable buildSeverityTransitionTable(const SensorInfo &sensor_info) const;
+    // Rebuild the preformed getTemperatureThresholds response; called at init
+    // and after a config reload changes thresholds.
+    void rebuildTemperatureThresholdsSnapshot();
     void clearAllThrottling();
     // For thermal_watcher_'s polling thread, return the sleep interval
     std::chrono::milliseconds thermalWatcherCallbackFunc(
@@ -219,21 +416,76 @@ class ThermalHelperImpl : public ThermalHelper {
     void maxCoolingRequestCheck(
             std::unordered_map<std::string, BindedCdevInfo> *binded_cdev_info_map);
     void checkUpdateSensorForEmul(std::string_view target_sensor, const bool max_throttling);
+    // Re-reduce the severity groups containing the sensor after its severity
+    // changed to new_severity. Watcher thread only: member severities are
+    // written by the same thread, so a raised aggregate is one store and only
+    // a member dropping below the aggregate pays the group rescan.
+    void updateSeverityGroups(size_t sensor_id, ThrottlingSeverity new_severity);
     sp<ThermalWatcher> thermal_watcher_;
     PowerFiles power_files_;
     ThermalFiles thermal_sensors_;
     ThermalFiles cooling_devices_;
     ThermalThrottling thermal_throttling_;
     bool is_initialized_;
+    // Scheduling overrides from the ThreadScheduling config section, keyed by
+    // HAL service thread name.
+    std::unordered_map<std::string, ThreadSchedulingInfo> thread_scheduling_map_;
+    bool trip_rearm_enabled_;
+    bool parallel_polling_enabled_;
+    bool adaptive_polling_enabled_;
+    // Sensor name to dependency-group id: sensors that never share a virtual
+    // sensor subtree land in different groups and can be read concurrently.
+    std::unordered_map<std::string, size_t> sensor_group_map_;
+    // Per-sensor severity transition tables generated at init and rebuilt on
+    // config reload; consulted by readTemperature instead of the full scan.
+    std::unordered_map<std::string, SeverityTransitionTable> severity_transition_table_map_;
+    // Last state written to each cooling device sysfs node, used to coalesce
+    // duplicate requests within a cycle and to suppress writes that would
+    // repeat the current state. Only touched by the watcher thread.
+    std::unordered_map<std::string, int> cdev_written_state_map_;
+    // Thermal zone sysfs paths for the monitored physical sensors that accept
+    // trip point updates, captured at initializeTrip time.
+    std::unordered_map<std::string, std::string> monitored_tz_path_map_;
     const NotificationCallback cb_;
     std::unordered_map<std::string, CdevInfo> cooling_device_info_map_;
     std::unordered_map<std::string, SensorInfo> sensor_info_map_;
+    // Index from a physical sensor to the dense ids of the watched sensors
+    // that must be re-evaluated when it reports a uevent, so a single-zone
+    // event does not trigger a trigger-sensor scan across the whole
+    // sensor_info_map_. Keyed by name because uevents arrive as strings.
+    std::unordered_map<std::string, std::unordered_set<size_t>> uevent_dependent_sensors_map_;
     std::unordered_map<std::string, std::unordered_map<ThrottlingSeverity, ThrottlingSeverity>>
             supported_powerhint_map_;
     PowerHalService power_hal_service_;
     ThermalStatsHelper thermal_stats_helper_;
+    ThermalShmemCache shmem_cache_;
     mutable std::shared_mutex sensor_status_map_mutex_;
     std::unordered_map<std::string, SensorStatus> sensor_status_map_;
+    // Scratch buffers reused across polling cycles so the steady-state loop
+    // stays free of heap allocations; only touched by the watcher thread.
+    std::vector<Temperature> watcher_temps_scratch_;
+    std::vector<std::string> watcher_cdevs_scratch_;
+    std::vector<SensorPollState> watcher_poll_scratch_;
+    // Watched sensors in topological order: a virtual sensor's linked sensors
+    // appear before it, so a polling cycle evaluates everything in one linear
+    // pass with cache-fresh inputs and without recursive map lookups. The
+    // vector index is the sensor's dense id.
+    std::vector<SensorRuntime> sensor_runtime_;
+    // Watched sensor name to dense id, used only at API boundaries.
+    std::unordered_map<std::string, size_t> sensor_id_map_;
+    // Severity groups from the SeverityGroups config section, keyed by group
+    // name. unordered_map nodes are stable, so the per-sensor index below can
+    // hold plain pointers into it.
+    std::unordered_map<std::string, SeverityGroupRuntime> severity_group_map_;
+    // Per dense sensor id, the severity groups the sensor belongs to; empty
+    // for sensors no group references.
+    std::vector<std::vector<SeverityGroupRuntime *>> sensor_severity_groups_;
+    // Preformed TemperatureThreshold parcelables for the non-hidden sensors.
+    // Thresholds are static outside config reload, so getTemperatureThresholds
+    // reduces to copying this immutable snapshot; only the pointer swap is
+    // guarded.
+    std::shared_ptr<const std::vector<TemperatureThreshold>> thresholds_snapshot_;
+    mutable std::mutex thresholds_snapshot_mutex_;
 };
 
 }  // namespace implementation
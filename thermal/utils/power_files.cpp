@@ -135,9 +135,56 @@ bool PowerFiles::registerPowerRailsToWatch(const Json::Value &config) {
 
     power_status_log_ = {.prev_log_time = boot_clock::now(),
                          .prev_energy_info_map = energy_info_map_};
+
+    // Sample the rails from a dedicated thread so a slow IIO read can no
+    // longer stall the throttling loop.
+    for (const auto &power_status_pair : power_status_map_) {
+        power_sampling_interval_ =
+                std::min(power_sampling_interval_,
+                         power_rail_info_map_.at(power_status_pair.first).power_sample_delay);
+    }
+    if (power_status_map_.size() && power_sampling_interval_ != std::chrono::milliseconds::max()) {
+        power_sampling_active_ = true;
+        power_sampling_thread_ = std::thread(&PowerFiles::powerSamplingLoop, this);
+    }
     return true;
 }
 
+void PowerFiles::powerSamplingLoop(void) {
+    std::unique_lock<std::mutex> _lock(power_sampling_mutex_);
+    while (!power_sampling_stop_) {
+        _lock.unlock();
+        {
+            std::unique_lock<std::shared_mutex> _map_lock(power_status_map_mutex_);
+            if (updateEnergyValues()) {
+                for (const auto &power_status_pair : power_status_map_) {
+                    updatePowerRail(power_status_pair.first);
+                }
+            } else {
+                LOG(ERROR) << "Failed to update energy values";
+            }
+        }
+        _lock.lock();
+        power_sampling_cv_.wait_for(_lock, power_sampling_interval_,
+                                    [this] { return power_sampling_stop_; });
+    }
+}
+
+void PowerFiles::stopPowerSampling(void) {
+    if (!power_sampling_active_.load()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> _lock(power_sampling_mutex_);
+        power_sampling_stop_ = true;
+    }
+    power_sampling_cv_.notify_all();
+    if (power_sampling_thread_.joinable()) {
+        power_sampling_thread_.join();
+    }
+    power_sampling_active_ = false;
+}
+
 bool PowerFiles::findEnergySourceToWatch(void) {
     std::string devicePath;
 
@@ -329,6 +376,12 @@ float PowerFiles::updatePowerRail(std::string_view power_rail) {
 }
 
 bool PowerFiles::refreshPowerStatus(void) {
+    // The background sampling thread keeps the rails fresh; the throttling
+    // loop only consumes the latest published averages.
+    if (power_sampling_active_.load()) {
+        return true;
+    }
+
     if (!updateEnergyValues()) {
         LOG(ERROR) << "Failed to update energy values";
         return false;
@@ -341,6 +394,9 @@ bool PowerFiles::refreshPowerStatus(void) {
 }
 
 void PowerFiles::logPowerStatus(const boot_clock::time_point &now) {
+    // Hold the map lock so the sampling thread cannot rehash energy_info_map_
+    // while it is being walked here.
+    std::shared_lock<std::shared_mutex> _lock(power_status_map_mutex_);
     // calculate energy and print
     uint8_t power_rail_log_cnt = 0;
     uint64_t max_duration = 0;
@@ -18,10 +18,14 @@
 
 #include <android-base/chrono_utils.h>
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <queue>
 #include <shared_mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -57,7 +61,7 @@ struct PowerStatusLog {
 class PowerFiles {
   public:
     PowerFiles() = default;
-    ~PowerFiles() = default;
+    ~PowerFiles() { stopPowerSampling(); }
     // Disallow copy and assign.
     PowerFiles(const PowerFiles &) = delete;
     void operator=(const PowerFiles &) = delete;
@@ -79,8 +83,12 @@ class PowerFiles {
     const std::unordered_map<std::string, PowerRailInfo> &GetPowerRailInfoMap() const {
         return power_rail_info_map_;
     }
+    // Stop the background rail sampling thread
+    void stopPowerSampling(void);
 
   private:
+    // Loop of the background rail sampling thread
+    void powerSamplingLoop(void);
     // Update energy value to energy_info_map_, return false if the value is failed to update.
     bool updateEnergyValues(void);
     // Compute the average power for physical power rail.
@@ -99,6 +107,15 @@ class PowerFiles {
     // The set to store the energy source paths
     std::unordered_set<std::string> energy_path_set_;
     PowerStatusLog power_status_log_;
+    // Background thread which samples the rails so the throttling loop never
+    // blocks on IIO I/O; it publishes into power_status_map_ and the
+    // throttling loop consumes the latest averages.
+    std::thread power_sampling_thread_;
+    std::mutex power_sampling_mutex_;
+    std::condition_variable power_sampling_cv_;
+    bool power_sampling_stop_ = false;
+    std::atomic_bool power_sampling_active_{false};
+    std::chrono::milliseconds power_sampling_interval_ = std::chrono::milliseconds::max();
 };
 
 }  // namespace implementation
@@ -44,6 +44,18 @@ using ::android::base::StringPrintf;
 PowerHalService::PowerHalService()
     : power_hal_aidl_exist_(true), power_hal_aidl_(nullptr), power_hal_ext_aidl_(nullptr) {
     connect();
+    hint_worker_ = std::thread(&PowerHalService::hintWorkerLoop, this);
+}
+
+PowerHalService::~PowerHalService() {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        abort_ = true;
+    }
+    pending_cv_.notify_all();
+    if (hint_worker_.joinable()) {
+        hint_worker_.join();
+    }
 }
 
 bool PowerHalService::connect() {
@@ -106,25 +118,70 @@ bool PowerHalService::connect() {
 
 void PowerHalService::reconnect() {
     ATRACE_CALL();
-    if (!connect()) {
-        LOG(ERROR) << " Failed to reconnect power_hal_ext";
-        return;
+    /* Reconnection and hint resend happen on the hint worker; the binder
+     * death callback returns immediately. */
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        resend_all_ = true;
     }
+    pending_cv_.notify_one();
+}
 
-    LOG(INFO) << "Resend the power hints when power_hal_ext is reconnected";
-    std::lock_guard<std::shared_mutex> _lock(powerhint_status_mutex_);
-    for (const auto &[sensor_name, supported_powerhint] : supported_powerhint_map_) {
-        std::stringstream log_buf;
-        for (const auto &severity : ::ndk::enum_range<ThrottlingSeverity>()) {
-            bool mode = severity <= supported_powerhint.prev_hint_severity;
-            setMode(sensor_name, severity, mode);
-            log_buf << toString(severity).c_str() << ":" << mode << " ";
+void PowerHalService::hintWorkerLoop() {
+    while (true) {
+        std::unordered_map<std::string, ThrottlingSeverity> batch;
+        bool resend_all = false;
+        {
+            std::unique_lock<std::mutex> lock(pending_mutex_);
+            pending_cv_.wait(lock,
+                             [this] { return abort_ || resend_all_ || !pending_hints_.empty(); });
+            if (abort_) {
+                return;
+            }
+            batch.swap(pending_hints_);
+            resend_all = resend_all_;
+            resend_all_ = false;
+        }
+
+        /* connect() blocks in waitForService while the power HAL restarts;
+         * that wait now happens here instead of in the throttling callback. */
+        if (!connect()) {
+            LOG(ERROR) << " Failed to reconnect power_hal_ext";
+            continue;
+        }
+
+        if (resend_all) {
+            LOG(INFO) << "Resend the power hints when power_hal_ext is reconnected";
+            std::lock_guard<std::shared_mutex> _lock(powerhint_status_mutex_);
+            for (const auto &[sensor_name, supported_powerhint] : supported_powerhint_map_) {
+                /* Latest-wins: an update queued meanwhile supersedes the resend */
+                batch.emplace(sensor_name, supported_powerhint.prev_hint_severity);
+            }
         }
 
-        LOG(INFO) << sensor_name << " send powerhint: " << log_buf.str();
-        log_buf.clear();
+        for (const auto &[sensor_name, target_severity] : batch) {
+            std::unordered_map<ThrottlingSeverity, ThrottlingSeverity> hint_severity_map;
+            {
+                std::lock_guard<std::shared_mutex> _lock(powerhint_status_mutex_);
+                hint_severity_map = supported_powerhint_map_[sensor_name].hint_severity_map;
+            }
+
+            std::stringstream log_buf;
+            for (const auto &severity : ::ndk::enum_range<ThrottlingSeverity>()) {
+                const auto supported = hint_severity_map.find(severity);
+                if (supported == hint_severity_map.end() || severity != supported->second) {
+                    continue;
+                }
+                bool mode = severity <= target_severity;
+                setMode(sensor_name, severity, mode);
+                log_buf << toString(severity).c_str() << ":" << mode << " ";
+            }
+            LOG(INFO) << sensor_name << " send powerhint: " << log_buf.str();
+
+            std::lock_guard<std::shared_mutex> _lock(powerhint_status_mutex_);
+            supported_powerhint_map_[sensor_name].prev_hint_severity = target_severity;
+        }
     }
-    return;
 }
 
 void PowerHalService::updateSupportedPowerHints(
@@ -157,33 +214,30 @@ void PowerHalService::updateSupportedPowerHints(
 
 void PowerHalService::sendPowerExtHint(const Temperature &t) {
     ATRACE_CALL();
-    std::lock_guard<std::shared_mutex> _lock(powerhint_status_mutex_);
-    ThrottlingSeverity prev_hint_severity = supported_powerhint_map_[t.name].prev_hint_severity;
-    ThrottlingSeverity current_hint_severity =
-            supported_powerhint_map_[t.name].hint_severity_map[t.throttlingStatus];
-    std::stringstream log_buf;
+    ThrottlingSeverity current_hint_severity;
+    {
+        std::lock_guard<std::shared_mutex> _lock(powerhint_status_mutex_);
+        ThrottlingSeverity prev_hint_severity = supported_powerhint_map_[t.name].prev_hint_severity;
+        current_hint_severity =
+                supported_powerhint_map_[t.name].hint_severity_map[t.throttlingStatus];
+
+        if (prev_hint_severity == current_hint_severity) {
+            return;
+        }
+    }
 
     if (!power_hal_aidl_exist_) {
         LOG(ERROR) << "power_hal_aidl is not exist";
         return;
     }
 
-    if (prev_hint_severity == current_hint_severity) {
-        return;
+    // Enqueue for hint_worker_; a newer target for the same sensor simply
+    // overwrites the pending one.
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending_hints_[t.name] = current_hint_severity;
     }
-
-    for (const auto &severity : ::ndk::enum_range<ThrottlingSeverity>()) {
-        if (severity != supported_powerhint_map_[t.name].hint_severity_map[severity]) {
-            continue;
-        }
-        bool mode = severity <= current_hint_severity;
-        setMode(t.name, severity, mode);
-        log_buf << toString(severity).c_str() << ":" << mode << " ";
-    }
-
-    LOG(INFO) << t.name << " send powerhint: " << log_buf.str();
-
-    supported_powerhint_map_[t.name].prev_hint_severity = current_hint_severity;
+    pending_cv_.notify_one();
 }
 
 bool PowerHalService::isModeSupported(const std::string &type, const ThrottlingSeverity &t) {
@@ -22,9 +22,11 @@
 #include <aidl/google/hardware/power/extension/pixel/IPowerExt.h>
 #include <utils/Trace.h>
 
+#include <condition_variable>
 #include <queue>
 #include <shared_mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -49,7 +51,7 @@ struct PowerHintstatus {
 class PowerHalService {
   public:
     PowerHalService();
-    ~PowerHalService() = default;
+    ~PowerHalService();
     bool connect();
     void reconnect();
     bool isAidlPowerHalExist() { return power_hal_aidl_exist_; }
@@ -76,12 +78,27 @@ class PowerHalService {
         }
     }
 
+    // Drains pending_hints_ and owns all setMode binder traffic, so severity
+    // evaluation never blocks on the power HAL (including the blocking
+    // waitForService during a power HAL restart).
+    void hintWorkerLoop();
+
     bool power_hal_aidl_exist_;
     std::shared_ptr<IPower> power_hal_aidl_;
     std::shared_ptr<IPowerExt> power_hal_ext_aidl_;
     std::mutex lock_;
     std::unordered_map<std::string, PowerHintstatus> supported_powerhint_map_;
     mutable std::shared_mutex powerhint_status_mutex_;
+
+    // Pending hint targets, latest-wins per sensor, drained by hint_worker_.
+    // resend_all_ re-sends every sensor's current hint state (set after the
+    // power HAL comes back).
+    std::unordered_map<std::string, ThrottlingSeverity> pending_hints_;
+    bool resend_all_ = false;
+    bool abort_ = false;
+    std::mutex pending_mutex_;
+    std::condition_variable pending_cv_;
+    std::thread hint_worker_;
 };
 
 }  // namespace implementation
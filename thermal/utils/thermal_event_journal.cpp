@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "thermal_event_journal.h"
+
+#include <android-base/chrono_utils.h>
+#include <android-base/stringprintf.h>
+#include <inttypes.h>
+
+#include <algorithm>
+
+namespace aidl {
+namespace android {
+namespace hardware {
+namespace thermal {
+namespace implementation {
+
+using ::android::base::boot_clock;
+using ::android::base::StringAppendF;
+
+namespace {
+
+const char *eventTypeToString(ThermalEventJournal::EventType type) {
+    switch (type) {
+        case ThermalEventJournal::EventType::kTempUpdate:
+            return "TEMP";
+        case ThermalEventJournal::EventType::kSeverityChange:
+            return "SEVERITY";
+        case ThermalEventJournal::EventType::kPidUpdate:
+            return "PID";
+        case ThermalEventJournal::EventType::kPowerBudget:
+            return "BUDGET";
+        case ThermalEventJournal::EventType::kCdevUpdate:
+            return "CDEV";
+        case ThermalEventJournal::EventType::kPowerCheck:
+            return "POWER";
+    }
+    return "UNKNOWN";
+}
+
+int64_t nowNs() {
+    return boot_clock::now().time_since_epoch().count();
+}
+
+}  // namespace
+
+ThermalEventJournal::ThermalEventJournal() {
+    ring_.resize(kJournalDepth);
+}
+
+ThermalEventJournal *ThermalEventJournal::getInstance() {
+    static ThermalEventJournal instance;
+    return &instance;
+}
+
+uint16_t ThermalEventJournal::internNameLocked(std::string_view name) {
+    const auto it = name_ids_.find(name.data());
+    if (it != name_ids_.end()) {
+        return it->second;
+    }
+    const uint16_t id = static_cast<uint16_t>(names_.size());
+    names_.emplace_back(name);
+    name_ids_.emplace(names_.back(), id);
+    return id;
+}
+
+void ThermalEventJournal::record(EventType type, std::string_view name, float value, int32_t aux) {
+    const int64_t timestamp_ns = nowNs();
+    std::lock_guard<std::mutex> _lock(journal_mutex_);
+    ring_[next_] = Record{
+            .timestamp_ns = timestamp_ns,
+            .value = value,
+            .aux = aux,
+            .name_id = internNameLocked(name),
+            .type = type,
+    };
+    next_ = (next_ + 1) % kJournalDepth;
+    total_recorded_++;
+}
+
+bool ThermalEventJournal::shouldLogText(EventType type, std::string_view name) {
+    const int64_t timestamp_ns = nowNs();
+    std::lock_guard<std::mutex> _lock(journal_mutex_);
+    const uint32_t key =
+            (static_cast<uint32_t>(internNameLocked(name)) << 8) | static_cast<uint32_t>(type);
+    auto &last_ns = last_text_log_ns_[key];
+    if (timestamp_ns - last_ns < kTextLogIntervalNs) {
+        return false;
+    }
+    last_ns = timestamp_ns;
+    return true;
+}
+
+void ThermalEventJournal::dumpToStream(std::ostringstream *dump_buf) {
+    std::lock_guard<std::mutex> _lock(journal_mutex_);
+    const size_t retained = std::min<uint64_t>(total_recorded_, kJournalDepth);
+    *dump_buf << "Thermal event journal (" << retained << " of " << total_recorded_
+              << " records):" << std::endl;
+    for (size_t i = 0; i < retained; ++i) {
+        const Record &r = ring_[(next_ + kJournalDepth - retained + i) % kJournalDepth];
+        std::string line;
+        StringAppendF(&line, " %" PRId64 ".%03" PRId64 " %-8s %s value=%0.2f aux=%d",
+                      r.timestamp_ns / 1000000000, (r.timestamp_ns / 1000000) % 1000,
+                      eventTypeToString(r.type), names_[r.name_id].c_str(), r.value, r.aux);
+        *dump_buf << line << std::endl;
+    }
+}
+
+}  // namespace implementation
+}  // namespace thermal
+}  // namespace hardware
+}  // namespace android
+}  // namespace aidl
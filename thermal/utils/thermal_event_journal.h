@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace aidl {
+namespace android {
+namespace hardware {
+namespace thermal {
+namespace implementation {
+
+// Binary structured journal for the throttling hot path: fixed-size records
+// appended into a preallocated ring and decoded only on dump, so steady-state
+// instrumentation costs one short lock and a struct store instead of text
+// formatting and logd traffic. Written from the watcher thread and the binder
+// threads; read by dumpsys.
+class ThermalEventJournal {
+  public:
+    enum class EventType : uint8_t {
+        kTempUpdate = 0,      // value = temperature, aux = throttling severity
+        kSeverityChange = 1,  // value = temperature, aux = new severity
+        kPidUpdate = 2,       // value = power budget, aux = PID target state
+        kPowerBudget = 3,     // value = budget after excluded rails, aux unused
+        kCdevUpdate = 4,      // value = written cdev state, aux = max state
+        kPowerCheck = 5,      // value = avg rail power, aux = power threshold
+    };
+
+    static ThermalEventJournal *getInstance();
+
+    // Append one record; name is interned to a dense id on first use and the
+    // record stores only the id.
+    void record(EventType type, std::string_view name, float value, int32_t aux);
+
+    // Rate limiter for the text summaries that back up the journal: returns
+    // true at most once per minute per (type, name), so logd sees a heartbeat
+    // instead of every cycle.
+    bool shouldLogText(EventType type, std::string_view name);
+
+    // Decode the retained records into dump_buf, oldest first.
+    void dumpToStream(std::ostringstream *dump_buf);
+
+  private:
+    ThermalEventJournal();
+    ThermalEventJournal(const ThermalEventJournal &) = delete;
+    void operator=(const ThermalEventJournal &) = delete;
+
+    // One journal entry; fixed size so the ring never reallocates.
+    struct Record {
+        int64_t timestamp_ns;
+        float value;
+        int32_t aux;
+        uint16_t name_id;
+        EventType type;
+    };
+
+    uint16_t internNameLocked(std::string_view name);
+
+    static constexpr size_t kJournalDepth = 8192;
+    static constexpr int64_t kTextLogIntervalNs = 60LL * 1000 * 1000 * 1000;
+
+    mutable std::mutex journal_mutex_;
+    std::vector<Record> ring_;
+    size_t next_ = 0;
+    uint64_t total_recorded_ = 0;
+    // Interned names: id is the index into names_.
+    std::vector<std::string> names_;
+    std::unordered_map<std::string, uint16_t> name_ids_;
+    // (name id, type) to last text emission, for shouldLogText.
+    std::unordered_map<uint32_t, int64_t> last_text_log_ns_;
+};
+
+}  // namespace implementation
+}  // namespace thermal
+}  // namespace hardware
+}  // namespace android
+}  // namespace aidl
@@ -22,9 +22,12 @@
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <utils/Trace.h>
 
 #include <algorithm>
+#include <cctype>
 #include <string_view>
 
 namespace aidl {
@@ -44,23 +47,45 @@ std::string ThermalFiles::getThermalFilePath(std::string_view thermal_name) cons
 }
 
 bool ThermalFiles::addThermalFile(std::string_view thermal_name, std::string_view path) {
-    return thermal_name_to_path_map_.emplace(thermal_name, path).second;
+    if (!thermal_name_to_path_map_.emplace(thermal_name, path).second) {
+        return false;
+    }
+
+    ::android::base::unique_fd fd(TEMP_FAILURE_RETRY(open(path.data(), O_RDONLY | O_CLOEXEC)));
+    if (fd.ok()) {
+        thermal_name_to_fd_map_.emplace(thermal_name, std::move(fd));
+    }
+    return true;
 }
 
 bool ThermalFiles::readThermalFile(std::string_view thermal_name, std::string *data) const {
     std::string sensor_reading;
-    std::string file_path = getThermalFilePath(std::string_view(thermal_name));
     *data = "";
 
     ATRACE_NAME(StringPrintf("ThermalFiles::readThermalFile - %s", thermal_name.data()).c_str());
-    if (file_path.empty()) {
-        PLOG(WARNING) << "Failed to find " << thermal_name << "'s path";
-        return false;
-    }
 
-    if (!::android::base::ReadFileToString(file_path, &sensor_reading)) {
-        PLOG(WARNING) << "Failed to read sensor: " << thermal_name;
-        return false;
+    const auto fd_itr = thermal_name_to_fd_map_.find(thermal_name.data());
+    if (fd_itr != thermal_name_to_fd_map_.end()) {
+        char buf[128];
+        const ssize_t len =
+                TEMP_FAILURE_RETRY(pread(fd_itr->second.get(), buf, sizeof(buf) - 1, 0));
+        if (len > 0) {
+            sensor_reading.assign(buf, len);
+        } else {
+            PLOG(WARNING) << "Failed to pread sensor: " << thermal_name;
+            return false;
+        }
+    } else {
+        std::string file_path = getThermalFilePath(std::string_view(thermal_name));
+        if (file_path.empty()) {
+            PLOG(WARNING) << "Failed to find " << thermal_name << "'s path";
+            return false;
+        }
+
+        if (!::android::base::ReadFileToString(file_path, &sensor_reading)) {
+            PLOG(WARNING) << "Failed to read sensor: " << thermal_name;
+            return false;
+        }
     }
 
     if (sensor_reading.size() <= 1) {
@@ -73,6 +98,31 @@ bool ThermalFiles::readThermalFile(std::string_view thermal_name, std::string *d
     return true;
 }
 
+size_t ThermalFiles::readAllThermalFiles(
+        std::unordered_map<std::string, std::string> *readings) const {
+    size_t read_count = 0;
+
+    ATRACE_NAME("ThermalFiles::readAllThermalFiles");
+    for (const auto &fd_pair : thermal_name_to_fd_map_) {
+        char buf[128];
+        const ssize_t len = TEMP_FAILURE_RETRY(pread(fd_pair.second.get(), buf, sizeof(buf) - 1, 0));
+        if (len <= 1) {
+            PLOG(WARNING) << "Failed to pread sensor: " << fd_pair.first;
+            readings->erase(fd_pair.first);
+            continue;
+        }
+        // Strip the trailing newline in place instead of going through Trim()
+        // so the reused value string is the only buffer touched.
+        ssize_t end = len;
+        while (end > 0 && std::isspace(static_cast<unsigned char>(buf[end - 1]))) {
+            end--;
+        }
+        (*readings)[fd_pair.first].assign(buf, end);
+        read_count++;
+    }
+    return read_count;
+}
+
 bool ThermalFiles::writeCdevFile(std::string_view cdev_name, std::string_view data) {
     std::string file_path =
             getThermalFilePath(::android::base::StringPrintf("%s_%s", cdev_name.data(), "w"));
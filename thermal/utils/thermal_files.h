@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <android-base/unique_fd.h>
+
 #include <string>
 #include <unordered_map>
 
@@ -33,17 +35,28 @@ class ThermalFiles {
     void operator=(const ThermalFiles &) = delete;
 
     std::string getThermalFilePath(std::string_view thermal_name) const;
-    // Returns true if add was successful, false otherwise.
+    // Returns true if add was successful, false otherwise. On success this also
+    // opens a persistent fd for the file so the hot read path can issue a single
+    // pread() per sensor instead of an open/read/close triple.
     bool addThermalFile(std::string_view thermal_name, std::string_view path);
     // If thermal_name is not found in the thermal names to path map, this will set
     // data to empty and return false. If the thermal_name is found and its content
     // is read, this function will fill in data accordingly then return true.
     bool readThermalFile(std::string_view thermal_name, std::string *data) const;
+    // Read every registered thermal file with one pread each into the
+    // caller-provided map, reusing the existing value strings so a steady-state
+    // bulk poll performs no allocation. Entries that fail to read are erased.
+    // Returns the number of files read successfully.
+    size_t readAllThermalFiles(std::unordered_map<std::string, std::string> *readings) const;
     bool writeCdevFile(std::string_view thermal_name, std::string_view data);
     size_t getNumThermalFiles() const { return thermal_name_to_path_map_.size(); }
 
   private:
     std::unordered_map<std::string, std::string> thermal_name_to_path_map_;
+    // Persistent fds keyed by thermal name, opened once at registration time.
+    // pread() with an explicit offset keeps the shared fds thread-safe without
+    // additional locking since the map itself is immutable after init.
+    std::unordered_map<std::string, ::android::base::unique_fd> thermal_name_to_fd_map_;
 };
 
 }  // namespace implementation
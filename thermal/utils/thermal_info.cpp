@@ -20,6 +20,7 @@
 #include <android-base/properties.h>
 #include <android-base/strings.h>
 #include <json/reader.h>
+#include <sched.h>
 
 #include <cmath>
 #include <unordered_set>
@@ -89,7 +90,7 @@ bool getIntFromJsonValues(const Json::Value &values, CdevArray *out, bool inc_ch
                 return false;
             }
             last = ret[i];
-            LOG(INFO) << "[" << i << "]: " << ret[i];
+            LOG(VERBOSE) << "[" << i << "]: " << ret[i];
         }
     }
 
@@ -122,7 +123,7 @@ bool getFloatFromJsonValues(const Json::Value &values, ThrottlingArray *out, boo
                 return false;
             }
             last = std::isnan(ret[i]) ? last : ret[i];
-            LOG(INFO) << "[" << i << "]: " << ret[i];
+            LOG(VERBOSE) << "[" << i << "]: " << ret[i];
         }
     }
 
@@ -152,7 +153,7 @@ bool getTempRangeInfoFromJsonValues(const Json::Value &values, TempRangeInfo *te
     }
     temp_range_info->min_temp_threshold = min_temp;
     temp_range_info->max_temp_threshold = max_temp;
-    LOG(INFO) << "Temp Range Info: " << temp_range_info->min_temp_threshold
+    LOG(VERBOSE) << "Temp Range Info: " << temp_range_info->min_temp_threshold
               << " <= t <= " << temp_range_info->max_temp_threshold;
     return true;
 }
@@ -179,7 +180,7 @@ bool getTempStuckInfoFromJsonValue(const Json::Value &values, TempStuckInfo *tem
     }
     temp_stuck_info->min_stuck_duration = std::chrono::milliseconds(min_stuck_duration_int);
     temp_stuck_info->min_polling_count = min_polling_count;
-    LOG(INFO) << "Temp Stuck Info: polling_count=" << temp_stuck_info->min_polling_count
+    LOG(VERBOSE) << "Temp Stuck Info: polling_count=" << temp_stuck_info->min_polling_count
               << " stuck_duration=" << temp_stuck_info->min_stuck_duration.count();
     return true;
 }
@@ -205,6 +206,10 @@ bool ParseThermalConfig(std::string_view config_path, Json::Value *config) {
         return false;
     }
     Json::CharReaderBuilder builder;
+    // Comments are allowed in the config but there is no reason to retain them
+    // in the parsed tree; collecting them measurably slows down the multi
+    // thousand line config parse on the boot critical path.
+    builder["collectComments"] = false;
     std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
     std::string errorMessage;
     if (!reader->parse(&*json_doc.begin(), &*json_doc.end(), config, &errorMessage)) {
@@ -217,11 +222,11 @@ bool ParseThermalConfig(std::string_view config_path, Json::Value *config) {
 bool ParseVirtualSensorInfo(const std::string_view name, const Json::Value &sensor,
                             std::unique_ptr<VirtualSensorInfo> *virtual_sensor_info) {
     if (sensor["VirtualSensor"].empty() || !sensor["VirtualSensor"].isBool()) {
-        LOG(INFO) << "Failed to read Sensor[" << name << "]'s VirtualSensor";
+        LOG(VERBOSE) << "Failed to read Sensor[" << name << "]'s VirtualSensor";
         return true;
     }
     bool is_virtual_sensor = sensor["VirtualSensor"].asBool();
-    LOG(INFO) << "Sensor[" << name << "]'s' VirtualSensor: " << is_virtual_sensor;
+    LOG(VERBOSE) << "Sensor[" << name << "]'s' VirtualSensor: " << is_virtual_sensor;
     if (!is_virtual_sensor) {
         return true;
     }
@@ -240,7 +245,7 @@ bool ParseVirtualSensorInfo(const std::string_view name, const Json::Value &sens
         linked_sensors.reserve(values.size());
         for (Json::Value::ArrayIndex j = 0; j < values.size(); ++j) {
             linked_sensors.emplace_back(values[j].asString());
-            LOG(INFO) << "Sensor[" << name << "]'s Combination[" << j << "]: " << linked_sensors[j];
+            LOG(VERBOSE) << "Sensor[" << name << "]'s Combination[" << j << "]: " << linked_sensors[j];
         }
     } else {
         LOG(ERROR) << "Sensor[" << name << "] has no Combination setting";
@@ -286,7 +291,7 @@ bool ParseVirtualSensorInfo(const std::string_view name, const Json::Value &sens
                            << values[j].asString();
                 return false;
             }
-            LOG(INFO) << "Sensor[" << name << "]'s CombinationType[" << j
+            LOG(VERBOSE) << "Sensor[" << name << "]'s CombinationType[" << j
                       << "]: " << linked_sensors_type[j];
         }
     }
@@ -296,7 +301,7 @@ bool ParseVirtualSensorInfo(const std::string_view name, const Json::Value &sens
         coefficients.reserve(values.size());
         for (Json::Value::ArrayIndex j = 0; j < values.size(); ++j) {
             coefficients.emplace_back(values[j].asString());
-            LOG(INFO) << "Sensor[" << name << "]'s coefficient[" << j << "]: " << coefficients[j];
+            LOG(VERBOSE) << "Sensor[" << name << "]'s coefficient[" << j << "]: " << coefficients[j];
         }
     } else if ((formula != FormulaOption::USE_ML_MODEL)) {
         LOG(ERROR) << "Sensor[" << name << "] has no Coefficient setting";
@@ -330,7 +335,7 @@ bool ParseVirtualSensorInfo(const std::string_view name, const Json::Value &sens
                            << values[j].asString();
                 return false;
             }
-            LOG(INFO) << "Sensor[" << name << "]'s coefficient type[" << j
+            LOG(VERBOSE) << "Sensor[" << name << "]'s coefficient type[" << j
                       << "]: " << coefficients_type[j];
         }
     }
@@ -349,7 +354,7 @@ bool ParseVirtualSensorInfo(const std::string_view name, const Json::Value &sens
     if (!values.empty()) {
         if (values.isString()) {
             trigger_sensors.emplace_back(values.asString());
-            LOG(INFO) << "Sensor[" << name << "]'s TriggerSensor: " << values.asString();
+            LOG(VERBOSE) << "Sensor[" << name << "]'s TriggerSensor: " << values.asString();
         } else if (values.size()) {
             trigger_sensors.reserve(values.size());
             for (Json::Value::ArrayIndex j = 0; j < values.size(); ++j) {
@@ -358,7 +363,7 @@ bool ParseVirtualSensorInfo(const std::string_view name, const Json::Value &sens
                     return false;
                 }
                 trigger_sensors.emplace_back(values[j].asString());
-                LOG(INFO) << "Sensor[" << name << "]'s TriggerSensor[" << j
+                LOG(VERBOSE) << "Sensor[" << name << "]'s TriggerSensor[" << j
                           << "]: " << trigger_sensors[j];
             }
         } else {
@@ -394,22 +399,36 @@ bool ParseVirtualSensorInfo(const std::string_view name, const Json::Value &sens
         if (!sensor["PreviousSampleCount"].empty()) {
             init_data.ml_model_init_data.use_prev_samples = true;
             init_data.ml_model_init_data.prev_samples_order = sensor["PreviousSampleCount"].asInt();
-            LOG(INFO) << "Sensor[" << name << "] takes "
+            LOG(VERBOSE) << "Sensor[" << name << "] takes "
                       << init_data.ml_model_init_data.prev_samples_order << " historic samples";
         }
 
         if (!sensor["OutputLabelCount"].empty()) {
             init_data.ml_model_init_data.output_label_count = sensor["OutputLabelCount"].asInt();
-            LOG(INFO) << "Sensor[" << name << "] outputs "
+            LOG(VERBOSE) << "Sensor[" << name << "] outputs "
                       << init_data.ml_model_init_data.output_label_count << " labels";
         }
 
         if (!sensor["PredictHotSpotCount"].empty()) {
             init_data.ml_model_init_data.num_hot_spots = sensor["PredictHotSpotCount"].asInt();
-            LOG(INFO) << "Sensor[" << name << "] predicts temperature at "
+            LOG(VERBOSE) << "Sensor[" << name << "] predicts temperature at "
                       << init_data.ml_model_init_data.num_hot_spots << " hot spots";
         }
 
+        if (!sensor["UseQuantizedInference"].empty() && sensor["UseQuantizedInference"].isBool()) {
+            init_data.ml_model_init_data.use_quantized_inference =
+                    sensor["UseQuantizedInference"].asBool();
+            LOG(VERBOSE) << "Sensor[" << name << "] UseQuantizedInference: "
+                      << init_data.ml_model_init_data.use_quantized_inference;
+        }
+
+        if (!sensor["UseXNNPackDelegate"].empty() && sensor["UseXNNPackDelegate"].isBool()) {
+            init_data.ml_model_init_data.use_xnnpack_delegate =
+                    sensor["UseXNNPackDelegate"].asBool();
+            LOG(VERBOSE) << "Sensor[" << name << "] UseXNNPackDelegate: "
+                      << init_data.ml_model_init_data.use_xnnpack_delegate;
+        }
+
         ::thermal::vtestimator::VtEstimatorStatus ret = vt_estimator->Initialize(init_data);
         if (ret != ::thermal::vtestimator::kVtEstimatorOk) {
             LOG(ERROR) << "Failed to initialize vt estimator for Sensor[" << name
@@ -418,7 +437,7 @@ bool ParseVirtualSensorInfo(const std::string_view name, const Json::Value &sens
             return false;
         }
 
-        LOG(INFO) << "Successfully created vt_estimator for Sensor[" << name
+        LOG(VERBOSE) << "Successfully created vt_estimator for Sensor[" << name
                   << "] with input samples: " << linked_sensors.size();
 
     } else if (formula == FormulaOption::USE_LINEAR_MODEL) {
@@ -464,7 +483,7 @@ bool ParseVirtualSensorInfo(const std::string_view name, const Json::Value &sens
             return false;
         }
 
-        LOG(INFO) << "Successfully created vt_estimator for Sensor[" << name
+        LOG(VERBOSE) << "Successfully created vt_estimator for Sensor[" << name
                   << "] with input samples: " << linked_sensors.size();
     }
 
@@ -488,7 +507,7 @@ bool ParseBindedCdevInfo(const Json::Value &values,
         int max_throttle_step = std::numeric_limits<int>::max();
         if (support_pid) {
             if (!values[j]["CdevWeightForPID"].empty()) {
-                LOG(INFO) << "Star to parse " << cdev_name << "'s CdevWeightForPID";
+                LOG(VERBOSE) << "Star to parse " << cdev_name << "'s CdevWeightForPID";
                 if (!getFloatFromJsonValues(values[j]["CdevWeightForPID"], &cdev_weight_for_pid,
                                             false, false)) {
                     LOG(ERROR) << "Failed to parse CdevWeightForPID";
@@ -497,7 +516,7 @@ bool ParseBindedCdevInfo(const Json::Value &values,
                 }
             }
             if (!values[j]["CdevCeiling"].empty()) {
-                LOG(INFO) << "Start to parse CdevCeiling: " << cdev_name;
+                LOG(VERBOSE) << "Start to parse CdevCeiling: " << cdev_name;
                 if (!getIntFromJsonValues(values[j]["CdevCeiling"], &cdev_ceiling, false, false)) {
                     LOG(ERROR) << "Failed to parse CdevCeiling";
                     binded_cdev_info_map->clear();
@@ -512,7 +531,7 @@ bool ParseBindedCdevInfo(const Json::Value &values,
                     binded_cdev_info_map->clear();
                     return false;
                 } else {
-                    LOG(INFO) << cdev_name << " MaxReleaseStep: " << max_release_step;
+                    LOG(VERBOSE) << cdev_name << " MaxReleaseStep: " << max_release_step;
                 }
             }
             if (!values[j]["MaxThrottleStep"].empty()) {
@@ -522,7 +541,7 @@ bool ParseBindedCdevInfo(const Json::Value &values,
                     binded_cdev_info_map->clear();
                     return false;
                 } else {
-                    LOG(INFO) << cdev_name << " MaxThrottleStep: " << max_throttle_step;
+                    LOG(VERBOSE) << cdev_name << " MaxThrottleStep: " << max_throttle_step;
                 }
             }
         }
@@ -534,7 +553,7 @@ bool ParseBindedCdevInfo(const Json::Value &values,
 
         sub_values = values[j]["LimitInfo"];
         if (sub_values.size()) {
-            LOG(INFO) << "Start to parse LimitInfo: " << cdev_name;
+            LOG(VERBOSE) << "Start to parse LimitInfo: " << cdev_name;
             if (!getIntFromJsonValues(sub_values, &limit_info, false, false)) {
                 LOG(ERROR) << "Failed to parse LimitInfo";
                 binded_cdev_info_map->clear();
@@ -558,17 +577,17 @@ bool ParseBindedCdevInfo(const Json::Value &values,
             if (values[j]["HighPowerCheck"].asBool()) {
                 high_power_check = true;
             }
-            LOG(INFO) << "Highpowercheck: " << std::boolalpha << high_power_check;
+            LOG(VERBOSE) << "Highpowercheck: " << std::boolalpha << high_power_check;
 
             if (values[j]["ThrottlingWithPowerLink"].asBool()) {
                 throttling_with_power_link = true;
             }
-            LOG(INFO) << "ThrottlingwithPowerLink: " << std::boolalpha
+            LOG(VERBOSE) << "ThrottlingwithPowerLink: " << std::boolalpha
                       << throttling_with_power_link;
 
             sub_values = values[j]["CdevFloorWithPowerLink"];
             if (sub_values.size()) {
-                LOG(INFO) << "Start to parse " << cdev_name << "'s CdevFloorWithPowerLink";
+                LOG(VERBOSE) << "Start to parse " << cdev_name << "'s CdevFloorWithPowerLink";
                 if (!getIntFromJsonValues(sub_values, &cdev_floor_with_power_link, false, false)) {
                     LOG(ERROR) << "Failed to parse CdevFloor";
                     binded_cdev_info_map->clear();
@@ -577,7 +596,7 @@ bool ParseBindedCdevInfo(const Json::Value &values,
             }
             sub_values = values[j]["PowerThreshold"];
             if (sub_values.size()) {
-                LOG(INFO) << "Start to parse " << cdev_name << "'s PowerThreshold";
+                LOG(VERBOSE) << "Start to parse " << cdev_name << "'s PowerThreshold";
                 if (!getFloatFromJsonValues(sub_values, &power_thresholds, false, false)) {
                     LOG(ERROR) << "Failed to parse power thresholds";
                     binded_cdev_info_map->clear();
@@ -585,16 +604,16 @@ bool ParseBindedCdevInfo(const Json::Value &values,
                 }
                 if (values[j]["ReleaseLogic"].asString() == "INCREASE") {
                     release_logic = ReleaseLogic::INCREASE;
-                    LOG(INFO) << "Release logic: INCREASE";
+                    LOG(VERBOSE) << "Release logic: INCREASE";
                 } else if (values[j]["ReleaseLogic"].asString() == "DECREASE") {
                     release_logic = ReleaseLogic::DECREASE;
-                    LOG(INFO) << "Release logic: DECREASE";
+                    LOG(VERBOSE) << "Release logic: DECREASE";
                 } else if (values[j]["ReleaseLogic"].asString() == "STEPWISE") {
                     release_logic = ReleaseLogic::STEPWISE;
-                    LOG(INFO) << "Release logic: STEPWISE";
+                    LOG(VERBOSE) << "Release logic: STEPWISE";
                 } else if (values[j]["ReleaseLogic"].asString() == "RELEASE_TO_FLOOR") {
                     release_logic = ReleaseLogic::RELEASE_TO_FLOOR;
-                    LOG(INFO) << "Release logic: RELEASE_TO_FLOOR";
+                    LOG(VERBOSE) << "Release logic: RELEASE_TO_FLOOR";
                 } else {
                     LOG(ERROR) << "Release logic is invalid";
                     binded_cdev_info_map->clear();
@@ -652,42 +671,42 @@ bool ParseSensorThrottlingInfo(const std::string_view name, const Json::Value &s
 
     // Parse PID parameters
     if (!sensor["PIDInfo"].empty()) {
-        LOG(INFO) << "Start to parse"
+        LOG(VERBOSE) << "Start to parse"
                   << " Sensor[" << name << "]'s K_Po";
         if (sensor["PIDInfo"]["K_Po"].empty() ||
             !getFloatFromJsonValues(sensor["PIDInfo"]["K_Po"], &k_po, false, false)) {
             LOG(ERROR) << "Sensor[" << name << "]: Failed to parse K_Po";
             return false;
         }
-        LOG(INFO) << "Start to parse"
+        LOG(VERBOSE) << "Start to parse"
                   << " Sensor[" << name << "]'s  K_Pu";
         if (sensor["PIDInfo"]["K_Pu"].empty() ||
             !getFloatFromJsonValues(sensor["PIDInfo"]["K_Pu"], &k_pu, false, false)) {
             LOG(ERROR) << "Sensor[" << name << "]: Failed to parse K_Pu";
             return false;
         }
-        LOG(INFO) << "Start to parse"
+        LOG(VERBOSE) << "Start to parse"
                   << " Sensor[" << name << "]'s K_I";
         if (sensor["PIDInfo"]["K_I"].empty() ||
             !getFloatFromJsonValues(sensor["PIDInfo"]["K_I"], &k_i, false, false)) {
             LOG(ERROR) << "Sensor[" << name << "]: Failed to parse K_I";
             return false;
         }
-        LOG(INFO) << "Start to parse"
+        LOG(VERBOSE) << "Start to parse"
                   << " Sensor[" << name << "]'s K_D";
         if (sensor["PIDInfo"]["K_D"].empty() ||
             !getFloatFromJsonValues(sensor["PIDInfo"]["K_D"], &k_d, false, false)) {
             LOG(ERROR) << "Sensor[" << name << "]: Failed to parse K_D";
             return false;
         }
-        LOG(INFO) << "Start to parse"
+        LOG(VERBOSE) << "Start to parse"
                   << " Sensor[" << name << "]'s I_Max";
         if (sensor["PIDInfo"]["I_Max"].empty() ||
             !getFloatFromJsonValues(sensor["PIDInfo"]["I_Max"], &i_max, false, false)) {
             LOG(ERROR) << "Sensor[" << name << "]: Failed to parse I_Max";
             return false;
         }
-        LOG(INFO) << "Start to parse"
+        LOG(VERBOSE) << "Start to parse"
                   << " Sensor[" << name << "]'s MaxAllocPower";
         if (sensor["PIDInfo"]["MaxAllocPower"].empty() ||
             !getFloatFromJsonValues(sensor["PIDInfo"]["MaxAllocPower"], &max_alloc_power, false,
@@ -695,7 +714,7 @@ bool ParseSensorThrottlingInfo(const std::string_view name, const Json::Value &s
             LOG(ERROR) << "Sensor[" << name << "]: Failed to parse MaxAllocPower";
             return false;
         }
-        LOG(INFO) << "Start to parse"
+        LOG(VERBOSE) << "Start to parse"
                   << " Sensor[" << name << "]'s MinAllocPower";
         if (sensor["PIDInfo"]["MinAllocPower"].empty() ||
             !getFloatFromJsonValues(sensor["PIDInfo"]["MinAllocPower"], &min_alloc_power, false,
@@ -703,23 +722,23 @@ bool ParseSensorThrottlingInfo(const std::string_view name, const Json::Value &s
             LOG(ERROR) << "Sensor[" << name << "]: Failed to parse MinAllocPower";
             return false;
         }
-        LOG(INFO) << "Start to parse Sensor[" << name << "]'s S_Power";
+        LOG(VERBOSE) << "Start to parse Sensor[" << name << "]'s S_Power";
         if (sensor["PIDInfo"]["S_Power"].empty() ||
             !getFloatFromJsonValues(sensor["PIDInfo"]["S_Power"], &s_power, false, true)) {
             LOG(ERROR) << "Sensor[" << name << "]: Failed to parse S_Power";
             return false;
         }
-        LOG(INFO) << "Start to parse Sensor[" << name << "]'s I_Cutoff";
+        LOG(VERBOSE) << "Start to parse Sensor[" << name << "]'s I_Cutoff";
         if (sensor["PIDInfo"]["I_Cutoff"].empty() ||
             !getFloatFromJsonValues(sensor["PIDInfo"]["I_Cutoff"], &i_cutoff, false, false)) {
             LOG(ERROR) << "Sensor[" << name << "]: Failed to parse I_Cutoff";
             return false;
         }
         i_default = getFloatFromValue(sensor["PIDInfo"]["I_Default"]);
-        LOG(INFO) << "Sensor[" << name << "]'s I_Default: " << i_default;
+        LOG(VERBOSE) << "Sensor[" << name << "]'s I_Default: " << i_default;
 
         tran_cycle = getFloatFromValue(sensor["PIDInfo"]["TranCycle"]);
-        LOG(INFO) << "Sensor[" << name << "]'s TranCycle: " << tran_cycle;
+        LOG(VERBOSE) << "Sensor[" << name << "]'s TranCycle: " << tran_cycle;
 
         // Confirm we have at least one valid PID combination
         bool valid_pid_combination = false;
@@ -776,7 +795,7 @@ bool ParseSensorThrottlingInfo(const std::string_view name, const Json::Value &s
                                    << "'s power rail is not included in default rules";
                         return false;
                     } else {
-                        LOG(INFO) << "Sensor[" << name << "]:'s profile " << mode
+                        LOG(VERBOSE) << "Sensor[" << name << "]:'s profile " << mode
                                   << " is parsed successfully";
                     }
                 } else {
@@ -802,7 +821,7 @@ bool ParseSensorThrottlingInfo(const std::string_view name, const Json::Value &s
         ThrottlingArray power_weight;
         power_weight.fill(1);
         if (!values[j]["PowerWeight"].empty()) {
-            LOG(INFO) << "Sensor[" << name << "]: Start to parse " << power_rail
+            LOG(VERBOSE) << "Sensor[" << name << "]: Start to parse " << power_rail
                       << "'s PowerWeight";
             if (!getFloatFromJsonValues(values[j]["PowerWeight"], &power_weight, false, false)) {
                 LOG(ERROR) << "Failed to parse PowerWeight";
@@ -826,7 +845,7 @@ bool ParseSensorInfo(const Json::Value &config,
 
     for (Json::Value::ArrayIndex i = 0; i < sensors.size(); ++i) {
         const std::string &name = sensors[i]["Name"].asString();
-        LOG(INFO) << "Sensor[" << i << "]'s Name: " << name;
+        LOG(VERBOSE) << "Sensor[" << i << "]'s Name: " << name;
         if (name.empty()) {
             LOG(ERROR) << "Failed to read Sensor[" << i << "]'s Name";
             sensors_parsed->clear();
@@ -841,7 +860,7 @@ bool ParseSensorInfo(const Json::Value &config,
         }
 
         std::string sensor_type_str = sensors[i]["Type"].asString();
-        LOG(INFO) << "Sensor[" << name << "]'s Type: " << sensor_type_str;
+        LOG(VERBOSE) << "Sensor[" << name << "]'s Type: " << sensor_type_str;
         TemperatureType sensor_type;
 
         if (!getTypeFromString(sensor_type_str, &sensor_type)) {
@@ -856,25 +875,25 @@ bool ParseSensorInfo(const Json::Value &config,
         } else if (!sensors[i]["SendCallback"].empty() && sensors[i]["SendCallback"].isBool()) {
             send_cb = sensors[i]["SendCallback"].asBool();
         }
-        LOG(INFO) << "Sensor[" << name << "]'s SendCallback: " << std::boolalpha << send_cb
+        LOG(VERBOSE) << "Sensor[" << name << "]'s SendCallback: " << std::boolalpha << send_cb
                   << std::noboolalpha;
 
         bool send_powerhint = false;
         if (sensors[i]["SendPowerHint"].empty() || !sensors[i]["SendPowerHint"].isBool()) {
-            LOG(INFO) << "Failed to read Sensor[" << name << "]'s SendPowerHint, set to 'false'";
+            LOG(VERBOSE) << "Failed to read Sensor[" << name << "]'s SendPowerHint, set to 'false'";
         } else if (sensors[i]["SendPowerHint"].asBool()) {
             send_powerhint = true;
         }
-        LOG(INFO) << "Sensor[" << name << "]'s SendPowerHint: " << std::boolalpha << send_powerhint
+        LOG(VERBOSE) << "Sensor[" << name << "]'s SendPowerHint: " << std::boolalpha << send_powerhint
                   << std::noboolalpha;
 
         bool is_hidden = false;
         if (sensors[i]["Hidden"].empty() || !sensors[i]["Hidden"].isBool()) {
-            LOG(INFO) << "Failed to read Sensor[" << name << "]'s Hidden, set to 'false'";
+            LOG(VERBOSE) << "Failed to read Sensor[" << name << "]'s Hidden, set to 'false'";
         } else if (sensors[i]["Hidden"].asBool()) {
             is_hidden = true;
         }
-        LOG(INFO) << "Sensor[" << name << "]'s Hidden: " << std::boolalpha << is_hidden
+        LOG(VERBOSE) << "Sensor[" << name << "]'s Hidden: " << std::boolalpha << is_hidden
                   << std::noboolalpha;
 
         std::array<float, kThrottlingSeverityCount> hot_thresholds;
@@ -888,7 +907,7 @@ bool ParseSensorInfo(const Json::Value &config,
 
         Json::Value values = sensors[i]["HotThreshold"];
         if (!values.size()) {
-            LOG(INFO) << "Sensor[" << name << "]'s HotThreshold, default all to NAN";
+            LOG(VERBOSE) << "Sensor[" << name << "]'s HotThreshold, default all to NAN";
         } else if (values.size() != kThrottlingSeverityCount) {
             LOG(ERROR) << "Invalid Sensor[" << name << "]'s HotThreshold count:" << values.size();
             sensors_parsed->clear();
@@ -907,14 +926,14 @@ bool ParseSensorInfo(const Json::Value &config,
                     }
                     min = hot_thresholds[j];
                 }
-                LOG(INFO) << "Sensor[" << name << "]'s HotThreshold[" << j
+                LOG(VERBOSE) << "Sensor[" << name << "]'s HotThreshold[" << j
                           << "]: " << hot_thresholds[j];
             }
         }
 
         values = sensors[i]["HotHysteresis"];
         if (!values.size()) {
-            LOG(INFO) << "Sensor[" << name << "]'s HotHysteresis, default all to 0.0";
+            LOG(VERBOSE) << "Sensor[" << name << "]'s HotHysteresis, default all to 0.0";
         } else if (values.size() != kThrottlingSeverityCount) {
             LOG(ERROR) << "Invalid Sensor[" << name << "]'s HotHysteresis, count:" << values.size();
             sensors_parsed->clear();
@@ -928,7 +947,7 @@ bool ParseSensorInfo(const Json::Value &config,
                     sensors_parsed->clear();
                     return false;
                 }
-                LOG(INFO) << "Sensor[" << name << "]'s HotHysteresis[" << j
+                LOG(VERBOSE) << "Sensor[" << name << "]'s HotHysteresis[" << j
                           << "]: " << hot_hysteresis[j];
             }
         }
@@ -953,7 +972,7 @@ bool ParseSensorInfo(const Json::Value &config,
 
         values = sensors[i]["ColdThreshold"];
         if (!values.size()) {
-            LOG(INFO) << "Sensor[" << name << "]'s ColdThreshold, default all to NAN";
+            LOG(VERBOSE) << "Sensor[" << name << "]'s ColdThreshold, default all to NAN";
         } else if (values.size() != kThrottlingSeverityCount) {
             LOG(ERROR) << "Invalid Sensor[" << name << "]'s ColdThreshold count:" << values.size();
             sensors_parsed->clear();
@@ -972,14 +991,14 @@ bool ParseSensorInfo(const Json::Value &config,
                     }
                     max = cold_thresholds[j];
                 }
-                LOG(INFO) << "Sensor[" << name << "]'s ColdThreshold[" << j
+                LOG(VERBOSE) << "Sensor[" << name << "]'s ColdThreshold[" << j
                           << "]: " << cold_thresholds[j];
             }
         }
 
         values = sensors[i]["ColdHysteresis"];
         if (!values.size()) {
-            LOG(INFO) << "Sensor[" << name << "]'s ColdHysteresis, default all to 0.0";
+            LOG(VERBOSE) << "Sensor[" << name << "]'s ColdHysteresis, default all to 0.0";
         } else if (values.size() != kThrottlingSeverityCount) {
             LOG(ERROR) << "Invalid Sensor[" << name << "]'s ColdHysteresis count:" << values.size();
             sensors_parsed->clear();
@@ -993,7 +1012,7 @@ bool ParseSensorInfo(const Json::Value &config,
                     sensors_parsed->clear();
                     return false;
                 }
-                LOG(INFO) << "Sensor[" << name << "]'s ColdHysteresis[" << j
+                LOG(VERBOSE) << "Sensor[" << name << "]'s ColdHysteresis[" << j
                           << "]: " << cold_hysteresis[j];
             }
         }
@@ -1019,20 +1038,20 @@ bool ParseSensorInfo(const Json::Value &config,
         std::string temp_path;
         if (!sensors[i]["TempPath"].empty()) {
             temp_path = sensors[i]["TempPath"].asString();
-            LOG(INFO) << "Sensor[" << name << "]'s TempPath: " << temp_path;
+            LOG(VERBOSE) << "Sensor[" << name << "]'s TempPath: " << temp_path;
         }
 
         float vr_threshold = NAN;
         if (!sensors[i]["VrThreshold"].empty()) {
             vr_threshold = getFloatFromValue(sensors[i]["VrThreshold"]);
-            LOG(INFO) << "Sensor[" << name << "]'s VrThreshold: " << vr_threshold;
+            LOG(VERBOSE) << "Sensor[" << name << "]'s VrThreshold: " << vr_threshold;
         }
 
         float multiplier = 1.0;
         if (!sensors[i]["Multiplier"].empty()) {
             multiplier = sensors[i]["Multiplier"].asFloat();
         }
-        LOG(INFO) << "Sensor[" << name << "]'s Multiplier: " << multiplier;
+        LOG(VERBOSE) << "Sensor[" << name << "]'s Multiplier: " << multiplier;
 
         std::chrono::milliseconds polling_delay = kUeventPollTimeoutMs;
         if (!sensors[i]["PollingDelay"].empty()) {
@@ -1040,7 +1059,7 @@ bool ParseSensorInfo(const Json::Value &config,
             polling_delay = (value > 0) ? std::chrono::milliseconds(value)
                                         : std::chrono::milliseconds::max();
         }
-        LOG(INFO) << "Sensor[" << name << "]'s Polling delay: " << polling_delay.count();
+        LOG(VERBOSE) << "Sensor[" << name << "]'s Polling delay: " << polling_delay.count();
 
         std::chrono::milliseconds passive_delay = kMinPollIntervalMs;
         if (!sensors[i]["PassiveDelay"].empty()) {
@@ -1048,7 +1067,7 @@ bool ParseSensorInfo(const Json::Value &config,
             passive_delay = (value > 0) ? std::chrono::milliseconds(value)
                                         : std::chrono::milliseconds::max();
         }
-        LOG(INFO) << "Sensor[" << name << "]'s Passive delay: " << passive_delay.count();
+        LOG(VERBOSE) << "Sensor[" << name << "]'s Passive delay: " << passive_delay.count();
 
         std::chrono::milliseconds time_resolution;
         if (sensors[i]["TimeResolution"].empty()) {
@@ -1057,7 +1076,7 @@ bool ParseSensorInfo(const Json::Value &config,
             time_resolution =
                     std::chrono::milliseconds(getIntFromValue(sensors[i]["TimeResolution"]));
         }
-        LOG(INFO) << "Sensor[" << name << "]'s Time resolution: " << time_resolution.count();
+        LOG(VERBOSE) << "Sensor[" << name << "]'s Time resolution: " << time_resolution.count();
 
         float step_ratio = NAN;
         if (!sensors[i]["StepRatio"].empty()) {
@@ -1091,7 +1110,7 @@ bool ParseSensorInfo(const Json::Value &config,
         }
 
         bool is_watch = (send_cb | send_powerhint | support_throttling);
-        LOG(INFO) << "Sensor[" << name << "]'s is_watch: " << std::boolalpha << is_watch;
+        LOG(VERBOSE) << "Sensor[" << name << "]'s is_watch: " << std::boolalpha << is_watch;
 
         (*sensors_parsed)[name] = {
                 .type = sensor_type,
@@ -1116,7 +1135,7 @@ bool ParseSensorInfo(const Json::Value &config,
 
         ++total_parsed;
     }
-    LOG(INFO) << total_parsed << " Sensors parsed successfully";
+    LOG(VERBOSE) << total_parsed << " Sensors parsed successfully";
     return true;
 }
 
@@ -1128,7 +1147,7 @@ bool ParseCoolingDevice(const Json::Value &config,
 
     for (Json::Value::ArrayIndex i = 0; i < cooling_devices.size(); ++i) {
         const std::string &name = cooling_devices[i]["Name"].asString();
-        LOG(INFO) << "CoolingDevice[" << i << "]'s Name: " << name;
+        LOG(VERBOSE) << "CoolingDevice[" << i << "]'s Name: " << name;
         if (name.empty()) {
             LOG(ERROR) << "Failed to read CoolingDevice[" << i << "]'s Name";
             cooling_devices_parsed->clear();
@@ -1143,7 +1162,7 @@ bool ParseCoolingDevice(const Json::Value &config,
         }
 
         std::string cooling_device_type_str = cooling_devices[i]["Type"].asString();
-        LOG(INFO) << "CoolingDevice[" << name << "]'s Type: " << cooling_device_type_str;
+        LOG(VERBOSE) << "CoolingDevice[" << name << "]'s Type: " << cooling_device_type_str;
         CoolingType cooling_device_type;
 
         if (!getTypeFromString(cooling_device_type_str, &cooling_device_type)) {
@@ -1154,10 +1173,10 @@ bool ParseCoolingDevice(const Json::Value &config,
         }
 
         const std::string &read_path = cooling_devices[i]["ReadPath"].asString();
-        LOG(INFO) << "Cdev Read Path: " << (read_path.empty() ? "default" : read_path);
+        LOG(VERBOSE) << "Cdev Read Path: " << (read_path.empty() ? "default" : read_path);
 
         const std::string &write_path = cooling_devices[i]["WritePath"].asString();
-        LOG(INFO) << "Cdev Write Path: " << (write_path.empty() ? "default" : write_path);
+        LOG(VERBOSE) << "Cdev Write Path: " << (write_path.empty() ? "default" : write_path);
 
         std::vector<float> state2power;
         Json::Value values = cooling_devices[i]["State2Power"];
@@ -1165,16 +1184,16 @@ bool ParseCoolingDevice(const Json::Value &config,
             state2power.reserve(values.size());
             for (Json::Value::ArrayIndex j = 0; j < values.size(); ++j) {
                 state2power.emplace_back(getFloatFromValue(values[j]));
-                LOG(INFO) << "Cooling device[" << name << "]'s Power2State[" << j
+                LOG(VERBOSE) << "Cooling device[" << name << "]'s Power2State[" << j
                           << "]: " << state2power[j];
             }
         } else {
-            LOG(INFO) << "CoolingDevice[" << i << "]'s Name: " << name
+            LOG(VERBOSE) << "CoolingDevice[" << i << "]'s Name: " << name
                       << " does not support State2Power";
         }
 
         const std::string &power_rail = cooling_devices[i]["PowerRail"].asString();
-        LOG(INFO) << "Cooling device power rail : " << power_rail;
+        LOG(VERBOSE) << "Cooling device power rail : " << power_rail;
 
         (*cooling_devices_parsed)[name] = {
                 .type = cooling_device_type,
@@ -1184,7 +1203,7 @@ bool ParseCoolingDevice(const Json::Value &config,
         };
         ++total_parsed;
     }
-    LOG(INFO) << total_parsed << " CoolingDevices parsed successfully";
+    LOG(VERBOSE) << total_parsed << " CoolingDevices parsed successfully";
     return true;
 }
 
@@ -1196,7 +1215,7 @@ bool ParsePowerRailInfo(const Json::Value &config,
 
     for (Json::Value::ArrayIndex i = 0; i < power_rails.size(); ++i) {
         const std::string &name = power_rails[i]["Name"].asString();
-        LOG(INFO) << "PowerRail[" << i << "]'s Name: " << name;
+        LOG(VERBOSE) << "PowerRail[" << i << "]'s Name: " << name;
         if (name.empty()) {
             LOG(ERROR) << "Failed to read PowerRail[" << i << "]'s Name";
             power_rails_parsed->clear();
@@ -1214,7 +1233,7 @@ bool ParsePowerRailInfo(const Json::Value &config,
 
         if (!power_rails[i]["VirtualRails"].empty() && power_rails[i]["VirtualRails"].isBool()) {
             is_virtual_power_rail = power_rails[i]["VirtualRails"].asBool();
-            LOG(INFO) << "PowerRails[" << name << "]'s VirtualRail, set to 'true'";
+            LOG(VERBOSE) << "PowerRails[" << name << "]'s VirtualRail, set to 'true'";
         }
 
         if (is_virtual_power_rail) {
@@ -1223,7 +1242,7 @@ bool ParsePowerRailInfo(const Json::Value &config,
                 linked_power_rails.reserve(values.size());
                 for (Json::Value::ArrayIndex j = 0; j < values.size(); ++j) {
                     linked_power_rails.emplace_back(values[j].asString());
-                    LOG(INFO) << "PowerRail[" << name << "]'s combination[" << j
+                    LOG(VERBOSE) << "PowerRail[" << name << "]'s combination[" << j
                               << "]: " << linked_power_rails[j];
                 }
             } else {
@@ -1237,7 +1256,7 @@ bool ParsePowerRailInfo(const Json::Value &config,
                 coefficient.reserve(values.size());
                 for (Json::Value::ArrayIndex j = 0; j < values.size(); ++j) {
                     coefficient.emplace_back(getFloatFromValue(values[j]));
-                    LOG(INFO) << "PowerRail[" << name << "]'s coefficient[" << j
+                    LOG(VERBOSE) << "PowerRail[" << name << "]'s coefficient[" << j
                               << "]: " << coefficient[j];
                 }
             } else {
@@ -1286,7 +1305,7 @@ bool ParsePowerRailInfo(const Json::Value &config,
         }
 
         power_sample_count = power_rails[i]["PowerSampleCount"].asInt();
-        LOG(INFO) << "Power sample Count: " << power_sample_count;
+        LOG(VERBOSE) << "Power sample Count: " << power_sample_count;
 
         if (!power_rails[i]["PowerSampleDelay"]) {
             power_sample_delay = std::chrono::milliseconds::max();
@@ -1302,7 +1321,7 @@ bool ParsePowerRailInfo(const Json::Value &config,
         };
         ++total_parsed;
     }
-    LOG(INFO) << total_parsed << " PowerRails parsed successfully";
+    LOG(VERBOSE) << total_parsed << " PowerRails parsed successfully";
     return true;
 }
 
@@ -1311,18 +1330,18 @@ bool ParseStatsInfo(const Json::Value &stats_config,
                     const std::unordered_map<std::string, U> &entity_info, StatsInfo<T> *stats_info,
                     T min_value) {
     if (stats_config.empty()) {
-        LOG(INFO) << "No stats config";
+        LOG(VERBOSE) << "No stats config";
         return true;
     }
     std::variant<bool, std::unordered_set<std::string>>
             record_by_default_threshold_all_or_name_set_ = false;
     if (stats_config["DefaultThresholdEnableAll"].empty() ||
         !stats_config["DefaultThresholdEnableAll"].isBool()) {
-        LOG(INFO) << "Failed to read stats DefaultThresholdEnableAll, set to 'false'";
+        LOG(VERBOSE) << "Failed to read stats DefaultThresholdEnableAll, set to 'false'";
     } else if (stats_config["DefaultThresholdEnableAll"].asBool()) {
         record_by_default_threshold_all_or_name_set_ = true;
     }
-    LOG(INFO) << "DefaultThresholdEnableAll " << std::boolalpha
+    LOG(VERBOSE) << "DefaultThresholdEnableAll " << std::boolalpha
               << std::get<bool>(record_by_default_threshold_all_or_name_set_) << std::noboolalpha;
 
     Json::Value values = stats_config["RecordWithDefaultThreshold"];
@@ -1343,7 +1362,7 @@ bool ParseStatsInfo(const Json::Value &stats_config,
                     .insert(name);
         }
     } else {
-        LOG(INFO) << "No stat by default threshold enabled.";
+        LOG(VERBOSE) << "No stat by default threshold enabled.";
     }
 
     std::unordered_map<std::string, std::vector<ThresholdList<T>>> record_by_threshold;
@@ -1360,11 +1379,11 @@ bool ParseStatsInfo(const Json::Value &stats_config,
             std::optional<std::string> logging_name;
             if (!values[i]["LoggingName"].empty()) {
                 logging_name = values[i]["LoggingName"].asString();
-                LOG(INFO) << "For [" << name << "]"
+                LOG(VERBOSE) << "For [" << name << "]"
                           << ", stats logging name is [" << logging_name.value() << "]";
             }
 
-            LOG(INFO) << "Start to parse stats threshold for [" << name << "]";
+            LOG(VERBOSE) << "Start to parse stats threshold for [" << name << "]";
             threshold_values = values[i]["Thresholds"];
             if (threshold_values.empty()) {
                 LOG(ERROR) << "Empty stats threshold not valid.";
@@ -1378,7 +1397,7 @@ bool ParseStatsInfo(const Json::Value &stats_config,
             }
             std::vector<T> stats_threshold(threshold_values_count);
             T prev_value = min_value;
-            LOG(INFO) << "Thresholds:";
+            LOG(VERBOSE) << "Thresholds:";
             for (Json::Value::ArrayIndex i = 0; i < threshold_values_count; ++i) {
                 stats_threshold[i] = std::is_floating_point_v<T>
                                              ? getFloatFromValue(threshold_values[i])
@@ -1389,12 +1408,12 @@ bool ParseStatsInfo(const Json::Value &stats_config,
                     return false;
                 }
                 prev_value = stats_threshold[i];
-                LOG(INFO) << "[" << i << "]: " << stats_threshold[i];
+                LOG(VERBOSE) << "[" << i << "]: " << stats_threshold[i];
             }
             record_by_threshold[name].emplace_back(logging_name, stats_threshold);
         }
     } else {
-        LOG(INFO) << "No stat by threshold enabled.";
+        LOG(VERBOSE) << "No stat by threshold enabled.";
     }
 
     (*stats_info) = {.record_by_default_threshold_all_or_name_set_ =
@@ -1408,7 +1427,7 @@ bool ParseSensorAbnormalStatsConfig(
         const std::unordered_map<std::string, SensorInfo> &sensor_info_map_,
         AbnormalStatsInfo *abnormal_stats_info_parsed) {
     if (abnormal_stats_config.empty()) {
-        LOG(INFO) << "No sensors abnormality monitoring info present.";
+        LOG(VERBOSE) << "No sensors abnormality monitoring info present.";
         return true;
     }
 
@@ -1418,10 +1437,10 @@ bool ParseSensorAbnormalStatsConfig(
     std::vector<AbnormalStatsInfo::SensorsTempRangeInfo> sensors_temp_range_infos;
     Json::Value outlier_temp_config = abnormal_stats_config["Outlier"];
     if (outlier_temp_config) {
-        LOG(INFO) << "Start to parse outlier temp config.";
+        LOG(VERBOSE) << "Start to parse outlier temp config.";
 
         if (outlier_temp_config["Default"]) {
-            LOG(INFO) << "Start to parse defaultTempRange.";
+            LOG(VERBOSE) << "Start to parse defaultTempRange.";
             if (!getTempRangeInfoFromJsonValues(outlier_temp_config["Default"],
                                                 &default_temp_range_info.value())) {
                 LOG(ERROR) << "Failed to parse default temp range config.";
@@ -1433,7 +1452,7 @@ bool ParseSensorAbnormalStatsConfig(
         if (configs) {
             std::unordered_set<std::string> sensors_parsed;
             for (Json::Value::ArrayIndex i = 0; i < configs.size(); i++) {
-                LOG(INFO) << "Start to parse temp range config[" << i << "]";
+                LOG(VERBOSE) << "Start to parse temp range config[" << i << "]";
                 AbnormalStatsInfo::SensorsTempRangeInfo sensors_temp_range_info;
                 values = configs[i]["Monitor"];
                 if (!values.size()) {
@@ -1452,7 +1471,7 @@ bool ParseSensorAbnormalStatsConfig(
                         LOG(ERROR) << "Duplicate Sensor Temp Range Config: " << sensor;
                         return false;
                     }
-                    LOG(INFO) << "Monitored sensor [" << j << "]: " << sensor;
+                    LOG(VERBOSE) << "Monitored sensor [" << j << "]: " << sensor;
                     sensors_temp_range_info.sensors.push_back(sensor);
                 }
                 if (!getTempRangeInfoFromJsonValues(configs[i]["TempRange"],
@@ -1468,10 +1487,10 @@ bool ParseSensorAbnormalStatsConfig(
     std::vector<AbnormalStatsInfo::SensorsTempStuckInfo> sensors_temp_stuck_infos;
     Json::Value stuck_temp_config = abnormal_stats_config["Stuck"];
     if (stuck_temp_config) {
-        LOG(INFO) << "Start to parse stuck temp config.";
+        LOG(VERBOSE) << "Start to parse stuck temp config.";
 
         if (stuck_temp_config["Default"]) {
-            LOG(INFO) << "Start to parse defaultTempStuck.";
+            LOG(VERBOSE) << "Start to parse defaultTempStuck.";
             if (!getTempStuckInfoFromJsonValue(stuck_temp_config["Default"],
                                                &default_temp_stuck_info.value())) {
                 LOG(ERROR) << "Failed to parse default temp stuck config.";
@@ -1483,7 +1502,7 @@ bool ParseSensorAbnormalStatsConfig(
         if (configs) {
             std::unordered_set<std::string> sensors_parsed;
             for (Json::Value::ArrayIndex i = 0; i < configs.size(); i++) {
-                LOG(INFO) << "Start to parse temp stuck config[" << i << "]";
+                LOG(VERBOSE) << "Start to parse temp stuck config[" << i << "]";
                 AbnormalStatsInfo::SensorsTempStuckInfo sensor_temp_stuck_info;
                 values = configs[i]["Monitor"];
                 if (!values.size()) {
@@ -1502,7 +1521,7 @@ bool ParseSensorAbnormalStatsConfig(
                         LOG(ERROR) << "Duplicate Sensor Temp Stuck Config: " << sensor;
                         return false;
                     }
-                    LOG(INFO) << "Monitored sensor [" << j << "]: " << sensor;
+                    LOG(VERBOSE) << "Monitored sensor [" << j << "]: " << sensor;
                     sensor_temp_stuck_info.sensors.push_back(sensor);
                 }
                 if (!getTempStuckInfoFromJsonValue(configs[i]["TempStuck"],
@@ -1529,16 +1548,16 @@ bool ParseSensorStatsConfig(const Json::Value &config,
                             AbnormalStatsInfo *abnormal_stats_info_parsed) {
     Json::Value stats_config = config["Stats"];
     if (stats_config.empty()) {
-        LOG(INFO) << "No Stats Config present.";
+        LOG(VERBOSE) << "No Stats Config present.";
         return true;
     }
     // Parse cooling device user vote
     Json::Value sensor_config = stats_config["Sensors"];
     if (sensor_config.empty()) {
-        LOG(INFO) << "No Sensor Stats Config present.";
+        LOG(VERBOSE) << "No Sensor Stats Config present.";
         return true;
     }
-    LOG(INFO) << "Parse Stats Config for Sensor Temp.";
+    LOG(VERBOSE) << "Parse Stats Config for Sensor Temp.";
     // Parse sensor stats config
     if (!ParseStatsInfo(stats_config["Sensors"], sensor_info_map_, sensor_stats_info_parsed,
                         std::numeric_limits<float>::lowest())) {
@@ -1560,15 +1579,15 @@ bool ParseCoolingDeviceStatsConfig(
         StatsInfo<int> *cooling_device_request_info_parsed) {
     Json::Value stats_config = config["Stats"];
     if (stats_config.empty()) {
-        LOG(INFO) << "No Stats Config present.";
+        LOG(VERBOSE) << "No Stats Config present.";
         return true;
     }
     // Parse cooling device user vote
     if (stats_config["CoolingDevices"].empty()) {
-        LOG(INFO) << "No cooling device stats present.";
+        LOG(VERBOSE) << "No cooling device stats present.";
         return true;
     }
-    LOG(INFO) << "Parse Stats Config for Sensor CDev Request.";
+    LOG(VERBOSE) << "Parse Stats Config for Sensor CDev Request.";
     if (!ParseStatsInfo(stats_config["CoolingDevices"]["RecordVotePerSensor"],
                         cooling_device_info_map_, cooling_device_request_info_parsed, -1)) {
         LOG(ERROR) << "Failed to parse cooling device user vote stats info.";
@@ -1577,6 +1596,147 @@ bool ParseCoolingDeviceStatsConfig(
     }
     return true;
 }
+
+bool ParseThreadSchedulingInfo(
+        const Json::Value &config,
+        std::unordered_map<std::string, ThreadSchedulingInfo> *scheduling_parsed) {
+    Json::Value threads = config["ThreadScheduling"];
+    if (threads.empty()) {
+        LOG(VERBOSE) << "No ThreadScheduling config present.";
+        return true;
+    }
+
+    for (Json::Value::ArrayIndex i = 0; i < threads.size(); ++i) {
+        const std::string &name = threads[i]["Name"].asString();
+        LOG(VERBOSE) << "ThreadScheduling[" << i << "]'s Name: " << name;
+        if (name != kWatcherThreadName && name != kNotificationThreadName) {
+            LOG(ERROR) << "ThreadScheduling[" << i << "]'s Name is invalid: " << name;
+            scheduling_parsed->clear();
+            return false;
+        }
+        if (scheduling_parsed->count(name)) {
+            LOG(ERROR) << "Duplicate ThreadScheduling entry: " << name;
+            scheduling_parsed->clear();
+            return false;
+        }
+
+        int rt_priority = 0;
+        if (!threads[i]["RtPriority"].empty()) {
+            rt_priority = getIntFromValue(threads[i]["RtPriority"]);
+            if (rt_priority < sched_get_priority_min(SCHED_FIFO) ||
+                rt_priority > sched_get_priority_max(SCHED_FIFO)) {
+                LOG(ERROR) << "ThreadScheduling[" << name
+                           << "]'s RtPriority is invalid: " << rt_priority;
+                scheduling_parsed->clear();
+                return false;
+            }
+            LOG(VERBOSE) << "ThreadScheduling[" << name << "]'s RtPriority: " << rt_priority;
+        }
+
+        std::vector<int> allowed_cpus;
+        Json::Value values = threads[i]["AllowedCpus"];
+        if (values.size()) {
+            allowed_cpus.reserve(values.size());
+            for (Json::Value::ArrayIndex j = 0; j < values.size(); ++j) {
+                int cpu = getIntFromValue(values[j]);
+                if (cpu < 0 || cpu >= CPU_SETSIZE) {
+                    LOG(ERROR) << "ThreadScheduling[" << name << "]'s AllowedCpus[" << j
+                               << "] is invalid: " << cpu;
+                    scheduling_parsed->clear();
+                    return false;
+                }
+                allowed_cpus.emplace_back(cpu);
+                LOG(VERBOSE) << "ThreadScheduling[" << name << "]'s AllowedCpus[" << j
+                             << "]: " << cpu;
+            }
+        }
+
+        if (!rt_priority && allowed_cpus.empty()) {
+            LOG(ERROR) << "ThreadScheduling[" << name << "] has no RtPriority or AllowedCpus";
+            scheduling_parsed->clear();
+            return false;
+        }
+
+        (*scheduling_parsed)[name] = {
+                .rt_priority = rt_priority,
+                .allowed_cpus = allowed_cpus,
+        };
+    }
+    LOG(VERBOSE) << scheduling_parsed->size() << " ThreadScheduling entries parsed successfully";
+    return true;
+}
+
+bool ParseSeverityGroups(const Json::Value &config,
+                         const std::unordered_map<std::string, SensorInfo> &sensor_info_map_,
+                         std::unordered_map<std::string, std::vector<std::string>> *groups_parsed) {
+    Json::Value groups = config["SeverityGroups"];
+    if (groups.empty()) {
+        LOG(VERBOSE) << "No SeverityGroups config present.";
+        return true;
+    }
+
+    for (Json::Value::ArrayIndex i = 0; i < groups.size(); ++i) {
+        const std::string &name = groups[i]["Name"].asString();
+        LOG(VERBOSE) << "SeverityGroups[" << i << "]'s Name: " << name;
+        if (name.empty()) {
+            LOG(ERROR) << "SeverityGroups[" << i << "] has no Name";
+            groups_parsed->clear();
+            return false;
+        }
+        if (groups_parsed->count(name)) {
+            LOG(ERROR) << "Duplicate SeverityGroups entry: " << name;
+            groups_parsed->clear();
+            return false;
+        }
+
+        Json::Value values = groups[i]["Sensors"];
+        if (values.empty()) {
+            LOG(ERROR) << "SeverityGroups[" << name << "] has no Sensors";
+            groups_parsed->clear();
+            return false;
+        }
+        std::vector<std::string> sensors;
+        sensors.reserve(values.size());
+        for (Json::Value::ArrayIndex j = 0; j < values.size(); ++j) {
+            const std::string &sensor_name = values[j].asString();
+            if (!sensor_info_map_.count(sensor_name)) {
+                LOG(ERROR) << "SeverityGroups[" << name << "]'s Sensors[" << j
+                           << "] is invalid: " << sensor_name;
+                groups_parsed->clear();
+                return false;
+            }
+            sensors.emplace_back(sensor_name);
+            LOG(VERBOSE) << "SeverityGroups[" << name << "]'s Sensors[" << j
+                         << "]: " << sensor_name;
+        }
+        (*groups_parsed)[name] = std::move(sensors);
+    }
+    LOG(VERBOSE) << groups_parsed->size() << " SeverityGroups entries parsed successfully";
+    return true;
+}
+
+bool ApplySchedulingToCurrentThread(const ThreadSchedulingInfo &sched_info) {
+    bool ret = true;
+    if (sched_info.rt_priority > 0) {
+        struct sched_param param = {.sched_priority = sched_info.rt_priority};
+        if (sched_setscheduler(0, SCHED_FIFO, &param)) {
+            PLOG(ERROR) << "Failed to set SCHED_FIFO priority " << sched_info.rt_priority;
+            ret = false;
+        }
+    }
+    if (!sched_info.allowed_cpus.empty()) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        for (const int cpu : sched_info.allowed_cpus) {
+            CPU_SET(cpu, &cpuset);
+        }
+        if (sched_setaffinity(0, sizeof(cpuset), &cpuset)) {
+            PLOG(ERROR) << "Failed to set thread affinity";
+            ret = false;
+        }
+    }
+    return ret;
+}
 }  // namespace implementation
 }  // namespace thermal
 }  // namespace hardware
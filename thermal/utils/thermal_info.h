@@ -234,6 +234,20 @@ struct PowerRailInfo {
     std::unique_ptr<VirtualPowerRailInfo> virtual_power_rail_info;
 };
 
+// Thread names accepted in the ThreadScheduling config section.
+constexpr std::string_view kWatcherThreadName("watcher");
+constexpr std::string_view kNotificationThreadName("notification");
+
+// Scheduling overrides for one of the HAL's service threads. A RtPriority
+// of 1..99 moves the thread to SCHED_FIFO at that priority so throttling
+// reaction time stays bounded when CFS is saturated; a non-empty AllowedCpus
+// list pins the thread to those cpus. Threads without an entry keep the
+// default policy and affinity.
+struct ThreadSchedulingInfo {
+    int rt_priority;
+    std::vector<int> allowed_cpus;
+};
+
 bool ParseThermalConfig(std::string_view config_path, Json::Value *config);
 bool ParseSensorInfo(const Json::Value &config,
                      std::unordered_map<std::string, SensorInfo> *sensors_parsed);
@@ -249,6 +263,18 @@ bool ParseCoolingDeviceStatsConfig(
         const Json::Value &config,
         const std::unordered_map<std::string, CdevInfo> &cooling_device_info_map_,
         StatsInfo<int> *cooling_device_request_info_parsed);
+bool ParseThreadSchedulingInfo(
+        const Json::Value &config,
+        std::unordered_map<std::string, ThreadSchedulingInfo> *scheduling_parsed);
+// Parse the SeverityGroups config section: named sensor groups whose max
+// severity the HAL keeps aggregated for single-enum queries. Every listed
+// sensor must exist in the sensor config.
+bool ParseSeverityGroups(const Json::Value &config,
+                         const std::unordered_map<std::string, SensorInfo> &sensor_info_map_,
+                         std::unordered_map<std::string, std::vector<std::string>> *groups_parsed);
+// Apply sched_info's policy and affinity to the calling thread. Failures are
+// logged and leave the thread at its previous scheduling.
+bool ApplySchedulingToCurrentThread(const ThreadSchedulingInfo &sched_info);
 }  // namespace implementation
 }  // namespace thermal
 }  // namespace hardware
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define ATRACE_TAG (ATRACE_TAG_THERMAL | ATRACE_TAG_HAL)
+
+#include "thermal_shmem_cache.h"
+
+#include <android-base/logging.h>
+#include <fcntl.h>
+#include <math.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace aidl {
+namespace android {
+namespace hardware {
+namespace thermal {
+namespace implementation {
+
+namespace {
+
+constexpr uint32_t kShmemCacheVersion = 1;
+
+int64_t getBootTimeNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+}  // namespace
+
+ThermalShmemCache::~ThermalShmemCache() {
+    if (region_ != nullptr) {
+        munmap(region_, region_size_);
+    }
+}
+
+ShmemSensorEntry *ThermalShmemCache::entryAt(size_t idx) {
+    return reinterpret_cast<ShmemSensorEntry *>(static_cast<char *>(region_) +
+                                                sizeof(ShmemCacheHeader)) +
+           idx;
+}
+
+bool ThermalShmemCache::initialize(
+        const std::unordered_map<std::string, SensorInfo> &sensor_info_map) {
+    if (region_ != nullptr) {
+        LOG(ERROR) << "Thermal shmem cache already initialized";
+        return false;
+    }
+
+    std::vector<std::string> sensor_names;
+    for (const auto &sensor_info_pair : sensor_info_map) {
+        if (sensor_info_pair.second.is_hidden) {
+            continue;
+        }
+        sensor_names.push_back(sensor_info_pair.first);
+    }
+    if (sensor_names.empty()) {
+        return false;
+    }
+
+    region_size_ = sizeof(ShmemCacheHeader) + sensor_names.size() * sizeof(ShmemSensorEntry);
+    fd_.reset(memfd_create("thermal_temp_cache", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+    if (!fd_.ok()) {
+        PLOG(ERROR) << "Failed to create thermal shmem cache memfd";
+        return false;
+    }
+    if (ftruncate(fd_.get(), region_size_) < 0) {
+        PLOG(ERROR) << "Failed to size thermal shmem cache to " << region_size_;
+        fd_.reset();
+        return false;
+    }
+    // Readers map the region for real, so make sure it can never shrink under them.
+    if (fcntl(fd_.get(), F_ADD_SEALS, F_SEAL_GROW | F_SEAL_SHRINK | F_SEAL_SEAL) < 0) {
+        PLOG(WARNING) << "Failed to seal thermal shmem cache";
+    }
+
+    region_ = mmap(nullptr, region_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_.get(), 0);
+    if (region_ == MAP_FAILED) {
+        PLOG(ERROR) << "Failed to map thermal shmem cache";
+        region_ = nullptr;
+        fd_.reset();
+        return false;
+    }
+
+    auto *header = static_cast<ShmemCacheHeader *>(region_);
+    header->version = kShmemCacheVersion;
+    header->sensor_count = sensor_names.size();
+    for (size_t i = 0; i < sensor_names.size(); ++i) {
+        ShmemSensorEntry *entry = entryAt(i);
+        entry->seq.store(0, std::memory_order_relaxed);
+        strlcpy(entry->name, sensor_names[i].c_str(), sizeof(entry->name));
+        entry->temp = NAN;
+        entry->severity = 0;
+        entry->timestamp_ns = 0;
+        entry_index_map_.emplace(sensor_names[i], i);
+    }
+
+    LOG(INFO) << "Thermal shmem cache initialized with " << sensor_names.size() << " sensors, "
+              << region_size_ << " bytes";
+    return true;
+}
+
+void ThermalShmemCache::update(std::string_view sensor_name, float temp,
+                               ThrottlingSeverity severity) {
+    if (region_ == nullptr) {
+        return;
+    }
+    const auto it = entry_index_map_.find(sensor_name.data());
+    if (it == entry_index_map_.end()) {
+        return;
+    }
+
+    // Serialize writers: the same sensor can be published from both the
+    // watcher thread and a binder read.
+    std::lock_guard<std::mutex> _lock(writer_mutex_);
+    ShmemSensorEntry *entry = entryAt(it->second);
+    const uint32_t seq = entry->seq.load(std::memory_order_relaxed);
+    entry->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    entry->temp = temp;
+    entry->severity = static_cast<int32_t>(severity);
+    entry->timestamp_ns = getBootTimeNs();
+    std::atomic_thread_fence(std::memory_order_release);
+    entry->seq.store(seq + 2, std::memory_order_release);
+}
+
+}  // namespace implementation
+}  // namespace thermal
+}  // namespace hardware
+}  // namespace android
+}  // namespace aidl
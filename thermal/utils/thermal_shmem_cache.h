@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android-base/unique_fd.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "thermal_info.h"
+
+namespace aidl {
+namespace android {
+namespace hardware {
+namespace thermal {
+namespace implementation {
+
+// Per-sensor record published into the shared memory region. Each entry is
+// protected by its own seqlock: seq is bumped to an odd value before the
+// payload is written and to the next even value afterwards, so a reader
+// retries whenever it observes an odd seq or a seq change across its read.
+struct ShmemSensorEntry {
+    std::atomic<uint32_t> seq;
+    char name[52];
+    float temp;
+    int32_t severity;
+    int64_t timestamp_ns;
+};
+
+struct ShmemCacheHeader {
+    uint32_t version;
+    uint32_t sensor_count;
+};
+
+// Publishes the latest per-sensor temperature and severity into a memfd-backed
+// region so trusted clients can read current values lock-free without paying
+// binder latency on the headroom query hot path. The writer side is the
+// thermal watcher / binder read path which already produces fresh values.
+class ThermalShmemCache {
+  public:
+    ThermalShmemCache() = default;
+    ~ThermalShmemCache();
+    ThermalShmemCache(const ThermalShmemCache &) = delete;
+    void operator=(const ThermalShmemCache &) = delete;
+
+    // Sizes and maps the region for all non-hidden sensors in sensor_info_map.
+    // Returns false if the memfd cannot be created or mapped.
+    bool initialize(const std::unordered_map<std::string, SensorInfo> &sensor_info_map);
+    // Publishes one sample under the entry's seqlock. No-op for sensors that
+    // were not registered at initialize() time.
+    void update(std::string_view sensor_name, float temp, ThrottlingSeverity severity);
+    // The region fd, sealed against resize, to be duped out to clients.
+    int getFd() const { return fd_.get(); }
+    size_t getSensorCount() const { return entry_index_map_.size(); }
+    bool isInitialized() const { return region_ != nullptr; }
+
+  private:
+    ::android::base::unique_fd fd_;
+    std::mutex writer_mutex_;
+    void *region_ = nullptr;
+    size_t region_size_ = 0;
+    std::unordered_map<std::string, size_t> entry_index_map_;
+
+    ShmemSensorEntry *entryAt(size_t idx);
+};
+
+}  // namespace implementation
+}  // namespace thermal
+}  // namespace hardware
+}  // namespace android
+}  // namespace aidl
@@ -62,18 +62,6 @@ bool isRecordByDefaultThreshold(const std::variant<bool, std::unordered_set<std:
             .count(name.data());
 }
 
-template <typename T>
-int calculateThresholdBucket(const std::vector<T> &thresholds, T value) {
-    if (thresholds.empty()) {
-        LOG(VERBOSE) << "No threshold present, so bucket is " << value << " as int.";
-        return static_cast<int>(value);
-    }
-    auto threshold_idx = std::upper_bound(thresholds.begin(), thresholds.end(), value);
-    int bucket = (threshold_idx - thresholds.begin());
-    LOG(VERBOSE) << "For value: " << value << " bucket is: " << bucket;
-    return bucket;
-}
-
 void resetCurrentTempStatus(CurrTempStatus *curr_temp_status, float new_temp) {
     curr_temp_status->temp = new_temp;
     curr_temp_status->start_time = boot_clock::now();
@@ -115,6 +103,7 @@ bool ThermalStatsHelper::initializeStats(
 
     last_total_stats_report_time = boot_clock::now();
     abnormal_stats_reported_per_update_interval = 0;
+    publishStatsSnapshots();
     LOG(INFO) << "Thermal Stats Initialized Successfully";
     return true;
 }
@@ -280,7 +269,8 @@ void ThermalStatsHelper::updateSensorCdevRequestStats(std::string_view sensor,
     }
     auto &request_stats = sensor_cdev_request_stats_map_[sensor.data()][cdev.data()];
     for (auto &stats_by_threshold : request_stats.stats_by_custom_threshold) {
-        int value = calculateThresholdBucket(stats_by_threshold.thresholds, new_value);
+        int value = stats_by_threshold.bucket_lookup.bucketFor(stats_by_threshold.thresholds,
+                                                               new_value);
         if (value != stats_by_threshold.stats_record.cur_state) {
             LOG(VERBOSE) << "Updating bindedCdev stats for sensor: " << sensor.data()
                          << " , cooling_device: " << cdev.data() << " with new value: " << value;
@@ -309,7 +299,8 @@ void ThermalStatsHelper::updateSensorTempStatsByThreshold(std::string_view senso
     }
     auto &sensor_temp_stats = temp_stats_map_[sensor.data()];
     for (auto &stats_by_threshold : sensor_temp_stats.stats_by_custom_threshold) {
-        int value = calculateThresholdBucket(stats_by_threshold.thresholds, temperature);
+        int value = stats_by_threshold.bucket_lookup.bucketFor(stats_by_threshold.thresholds,
+                                                               temperature);
         if (value != stats_by_threshold.stats_record.cur_state) {
             LOG(VERBOSE) << "Updating sensor stats for sensor: " << sensor.data()
                          << " with value: " << value;
@@ -389,6 +380,10 @@ void ThermalStatsHelper::verifySensorAbnormality(std::string_view sensor, float
 }
 
 int ThermalStatsHelper::reportStats() {
+    // Republish the reader snapshots once per polling cycle, after this
+    // cycle's updates have landed.
+    publishStatsSnapshots();
+
     const auto curTime = boot_clock::now();
     const auto since_last_total_stats_update_ms =
             std::chrono::duration_cast<std::chrono::milliseconds>(curTime -
@@ -413,39 +408,36 @@ int ThermalStatsHelper::reportStats() {
 }
 
 int ThermalStatsHelper::reportAllSensorTempStats(const std::shared_ptr<IStats> &stats_client) {
-    int count_failed_reporting = 0;
-    std::unique_lock<std::shared_mutex> _lock(sensor_stats_mutex_);
-    for (auto &[sensor, temp_stats] : sensor_stats.temp_stats_map_) {
-        for (size_t threshold_set_idx = 0;
-             threshold_set_idx < temp_stats.stats_by_custom_threshold.size(); threshold_set_idx++) {
-            auto &stats_by_threshold = temp_stats.stats_by_custom_threshold[threshold_set_idx];
-            std::string sensor_name = stats_by_threshold.logging_name.value_or(
-                    sensor + kCustomThresholdSetSuffix.data() + std::to_string(threshold_set_idx));
-            if (!reportSensorTempStats(stats_client, sensor_name, temp_stats,
-                                       &stats_by_threshold.stats_record)) {
-                count_failed_reporting++;
+    std::vector<PendingStatsReport> pending;
+    {
+        std::unique_lock<std::shared_mutex> _lock(sensor_stats_mutex_);
+        for (auto &[sensor, temp_stats] : sensor_stats.temp_stats_map_) {
+            for (size_t threshold_set_idx = 0;
+                 threshold_set_idx < temp_stats.stats_by_custom_threshold.size();
+                 threshold_set_idx++) {
+                auto &stats_by_threshold = temp_stats.stats_by_custom_threshold[threshold_set_idx];
+                std::string sensor_name = stats_by_threshold.logging_name.value_or(
+                        sensor + kCustomThresholdSetSuffix.data() +
+                        std::to_string(threshold_set_idx));
+                pending.push_back(prepareSensorTempStatsReport(sensor_name, temp_stats,
+                                                               &stats_by_threshold.stats_record));
             }
-        }
-        if (temp_stats.stats_by_default_threshold.has_value()) {
-            if (!reportSensorTempStats(stats_client, sensor, temp_stats,
-                                       &temp_stats.stats_by_default_threshold.value())) {
-                count_failed_reporting++;
+            if (temp_stats.stats_by_default_threshold.has_value()) {
+                pending.push_back(prepareSensorTempStatsReport(
+                        sensor, temp_stats, &temp_stats.stats_by_default_threshold.value()));
             }
+            // Reset temp stats after preparing the report
+            temp_stats.max_temp = std::numeric_limits<float>::min();
+            temp_stats.min_temp = std::numeric_limits<float>::max();
         }
-        // Reset temp stats after reporting
-        temp_stats.max_temp = std::numeric_limits<float>::min();
-        temp_stats.min_temp = std::numeric_limits<float>::max();
     }
-    return count_failed_reporting;
+    return submitPendingReports(stats_client, &pending, &sensor_stats_mutex_);
 }
 
-bool ThermalStatsHelper::reportSensorTempStats(const std::shared_ptr<IStats> &stats_client,
-                                               std::string_view sensor,
-                                               const SensorTempStats &sensor_temp_stats,
-                                               StatsRecord *stats_record) {
-    LOG(VERBOSE) << "Reporting sensor stats for " << sensor;
-    // maintain a copy in case reporting fails
-    StatsRecord thermal_stats_before_reporting = *stats_record;
+ThermalStatsHelper::PendingStatsReport ThermalStatsHelper::prepareSensorTempStatsReport(
+        std::string_view sensor, const SensorTempStats &sensor_temp_stats,
+        StatsRecord *stats_record) {
+    LOG(VERBOSE) << "Preparing sensor stats for " << sensor;
     std::vector<VendorAtomValue> values(2);
     values[0].set<VendorAtomValue::stringValue>(sensor);
     std::vector<int64_t> time_in_state_ms = processStatsRecordForReporting(stats_record);
@@ -473,58 +465,43 @@ bool ThermalStatsHelper::reportSensorTempStats(const std::shared_ptr<IStats> &st
             system_clock::to_time_t(sensor_temp_stats.min_temp_timestamp));
     values.push_back(tmp);
 
-    if (!reportAtom(stats_client, PixelAtoms::Atom::kVendorTempResidencyStats, std::move(values))) {
-        LOG(ERROR) << "Unable to report VendorTempResidencyStats to Stats service for "
-                      "sensor: "
-                   << sensor;
-        *stats_record = restoreStatsRecordOnFailure(std::move(thermal_stats_before_reporting));
-        return false;
-    }
-    // Update last time of stats reporting
-    stats_record->last_stats_report_time = boot_clock::now();
-    return true;
+    return {PixelAtoms::Atom::kVendorTempResidencyStats, std::move(values), stats_record,
+            std::move(time_in_state_ms), std::string(sensor)};
 }
 
 int ThermalStatsHelper::reportAllSensorCdevRequestStats(
         const std::shared_ptr<IStats> &stats_client) {
-    int count_failed_reporting = 0;
-    std::unique_lock<std::shared_mutex> _lock(sensor_cdev_request_stats_map_mutex_);
-    for (auto &[sensor, cdev_request_stats_map] : sensor_cdev_request_stats_map_) {
-        for (auto &[cdev, request_stats] : cdev_request_stats_map) {
-            for (size_t threshold_set_idx = 0;
-                 threshold_set_idx < request_stats.stats_by_custom_threshold.size();
-                 threshold_set_idx++) {
-                auto &stats_by_threshold =
-                        request_stats.stats_by_custom_threshold[threshold_set_idx];
-                std::string cdev_name = stats_by_threshold.logging_name.value_or(
-                        cdev + kCustomThresholdSetSuffix.data() +
-                        std::to_string(threshold_set_idx));
-                if (!reportSensorCdevRequestStats(stats_client, sensor, cdev_name,
-                                                  &stats_by_threshold.stats_record)) {
-                    count_failed_reporting++;
+    std::vector<PendingStatsReport> pending;
+    {
+        std::unique_lock<std::shared_mutex> _lock(sensor_cdev_request_stats_map_mutex_);
+        for (auto &[sensor, cdev_request_stats_map] : sensor_cdev_request_stats_map_) {
+            for (auto &[cdev, request_stats] : cdev_request_stats_map) {
+                for (size_t threshold_set_idx = 0;
+                     threshold_set_idx < request_stats.stats_by_custom_threshold.size();
+                     threshold_set_idx++) {
+                    auto &stats_by_threshold =
+                            request_stats.stats_by_custom_threshold[threshold_set_idx];
+                    std::string cdev_name = stats_by_threshold.logging_name.value_or(
+                            cdev + kCustomThresholdSetSuffix.data() +
+                            std::to_string(threshold_set_idx));
+                    pending.push_back(prepareSensorCdevRequestStatsReport(
+                            sensor, cdev_name, &stats_by_threshold.stats_record));
                 }
-            }
 
-            if (request_stats.stats_by_default_threshold.has_value()) {
-                if (!reportSensorCdevRequestStats(
-                            stats_client, sensor, cdev,
-                            &request_stats.stats_by_default_threshold.value())) {
-                    count_failed_reporting++;
+                if (request_stats.stats_by_default_threshold.has_value()) {
+                    pending.push_back(prepareSensorCdevRequestStatsReport(
+                            sensor, cdev, &request_stats.stats_by_default_threshold.value()));
                 }
             }
         }
     }
-    return count_failed_reporting;
+    return submitPendingReports(stats_client, &pending, &sensor_cdev_request_stats_map_mutex_);
 }
 
-bool ThermalStatsHelper::reportSensorCdevRequestStats(const std::shared_ptr<IStats> &stats_client,
-                                                      std::string_view sensor,
-                                                      std::string_view cdev,
-                                                      StatsRecord *stats_record) {
-    LOG(VERBOSE) << "Reporting bindedCdev stats for sensor: " << sensor
+ThermalStatsHelper::PendingStatsReport ThermalStatsHelper::prepareSensorCdevRequestStatsReport(
+        std::string_view sensor, std::string_view cdev, StatsRecord *stats_record) {
+    LOG(VERBOSE) << "Preparing bindedCdev stats for sensor: " << sensor
                  << " cooling_device: " << cdev;
-    // maintain a copy in case reporting fails
-    StatsRecord thermal_stats_before_reporting = *stats_record;
     std::vector<VendorAtomValue> values(3);
     values[0].set<VendorAtomValue::stringValue>(sensor);
     values[1].set<VendorAtomValue::stringValue>(cdev);
@@ -538,17 +515,55 @@ bool ThermalStatsHelper::reportSensorCdevRequestStats(const std::shared_ptr<ISta
         values.push_back(tmp);
     }
 
-    if (!reportAtom(stats_client, PixelAtoms::Atom::kVendorSensorCoolingDeviceStats,
-                    std::move(values))) {
-        LOG(ERROR) << "Unable to report VendorSensorCoolingDeviceStats to Stats "
-                      "service for sensor: "
-                   << sensor << " cooling_device: " << cdev;
-        *stats_record = restoreStatsRecordOnFailure(std::move(thermal_stats_before_reporting));
-        return false;
+    return {PixelAtoms::Atom::kVendorSensorCoolingDeviceStats, std::move(values), stats_record,
+            std::move(time_in_state_ms), std::string(sensor) + "-" + cdev.data()};
+}
+
+int ThermalStatsHelper::submitPendingReports(const std::shared_ptr<IStats> &stats_client,
+                                             std::vector<PendingStatsReport> *pending,
+                                             std::shared_mutex *stats_mutex) {
+    // Submit the whole batch back to back with the stats mutex dropped: the
+    // binder round trips are the dominant cost of the periodic report and must
+    // not stall the sensor update path.
+    std::vector<bool> report_succeeded(pending->size(), false);
+    int count_failed_reporting = 0;
+    for (size_t i = 0; i < pending->size(); i++) {
+        auto &report = (*pending)[i];
+        report_succeeded[i] = reportAtom(stats_client, report.atom_id, std::move(report.values));
+        if (!report_succeeded[i]) {
+            LOG(ERROR) << "Unable to report residency stats atom " << report.atom_id
+                       << " to Stats service for " << report.logging_name;
+            count_failed_reporting++;
+        }
     }
-    // Update last time of stats reporting
-    stats_record->last_stats_report_time = boot_clock::now();
-    return true;
+
+    const auto report_time = boot_clock::now();
+    std::unique_lock<std::shared_mutex> _lock(*stats_mutex);
+    for (size_t i = 0; i < pending->size(); i++) {
+        auto &report = (*pending)[i];
+        StatsRecord *stats_record = report.stats_record;
+        if (report_succeeded[i]) {
+            // Update last time of stats reporting
+            stats_record->last_stats_report_time = report_time;
+            continue;
+        }
+        stats_record->report_fail_count += 1;
+        // If consecutive count of failure is high, reset stat to avoid overflow
+        if (stats_record->report_fail_count >= kMaxStatsReportingFailCount) {
+            *stats_record =
+                    StatsRecord(stats_record->time_in_state_ms.size(), stats_record->cur_state);
+            continue;
+        }
+        // Fold the unreported residency back into the live record; updates
+        // that landed while the mutex was dropped are preserved.
+        for (size_t state = 0; state < report.reported_time_in_state_ms.size() &&
+                               state < stats_record->time_in_state_ms.size();
+             state++) {
+            stats_record->time_in_state_ms[state] +=
+                    std::chrono::milliseconds(report.reported_time_in_state_ms[state]);
+        }
+    }
+    return count_failed_reporting;
 }
 
 std::vector<int64_t> ThermalStatsHelper::processStatsRecordForReporting(StatsRecord *stats_record) {
@@ -607,20 +622,37 @@ bool ThermalStatsHelper::reportAtom(const std::shared_ptr<IStats> &stats_client,
     return ret.isOk();
 }
 
-StatsRecord ThermalStatsHelper::restoreStatsRecordOnFailure(
-        StatsRecord &&stats_record_before_failure) {
-    stats_record_before_failure.report_fail_count += 1;
-    // If consecutive count of failure is high, reset stat to avoid overflow
-    if (stats_record_before_failure.report_fail_count >= kMaxStatsReportingFailCount) {
-        return StatsRecord(stats_record_before_failure.time_in_state_ms.size(),
-                           stats_record_before_failure.cur_state);
-    } else {
-        return stats_record_before_failure;
-    }
+void ThermalStatsHelper::publishStatsSnapshots() {
+    std::shared_ptr<const std::unordered_map<std::string, SensorTempStats>> temp_stats_snapshot;
+    {
+        std::shared_lock<std::shared_mutex> _lock(sensor_stats_mutex_);
+        temp_stats_snapshot = std::make_shared<const std::unordered_map<std::string, SensorTempStats>>(
+                sensor_stats.temp_stats_map_);
+    }
+    std::shared_ptr<
+            const std::unordered_map<std::string, std::unordered_map<std::string, ThermalStats<int>>>>
+            cdev_request_stats_snapshot;
+    {
+        std::shared_lock<std::shared_mutex> _lock(sensor_cdev_request_stats_map_mutex_);
+        cdev_request_stats_snapshot = std::make_shared<const std::unordered_map<
+                std::string, std::unordered_map<std::string, ThermalStats<int>>>>(
+                sensor_cdev_request_stats_map_);
+    }
+    std::lock_guard<std::mutex> _lock(snapshot_mutex_);
+    sensor_temp_stats_snapshot_ = std::move(temp_stats_snapshot);
+    sensor_cdev_request_stats_snapshot_ = std::move(cdev_request_stats_snapshot);
 }
 
 std::unordered_map<std::string, SensorTempStats> ThermalStatsHelper::GetSensorTempStatsSnapshot() {
-    auto sensor_temp_stats_snapshot = sensor_stats.temp_stats_map_;
+    std::shared_ptr<const std::unordered_map<std::string, SensorTempStats>> published_snapshot;
+    {
+        std::lock_guard<std::mutex> _lock(snapshot_mutex_);
+        published_snapshot = sensor_temp_stats_snapshot_;
+    }
+    if (published_snapshot == nullptr) {
+        return {};
+    }
+    auto sensor_temp_stats_snapshot = *published_snapshot;
     for (auto &sensor_temp_stats_pair : sensor_temp_stats_snapshot) {
         for (auto &temp_stats : sensor_temp_stats_pair.second.stats_by_custom_threshold) {
             // update the last unclosed entry and start new record with same state
@@ -638,7 +670,17 @@ std::unordered_map<std::string, SensorTempStats> ThermalStatsHelper::GetSensorTe
 
 std::unordered_map<std::string, std::unordered_map<std::string, ThermalStats<int>>>
 ThermalStatsHelper::GetSensorCoolingDeviceRequestStatsSnapshot() {
-    auto sensor_cdev_request_stats_snapshot = sensor_cdev_request_stats_map_;
+    std::shared_ptr<
+            const std::unordered_map<std::string, std::unordered_map<std::string, ThermalStats<int>>>>
+            published_snapshot;
+    {
+        std::lock_guard<std::mutex> _lock(snapshot_mutex_);
+        published_snapshot = sensor_cdev_request_stats_snapshot_;
+    }
+    if (published_snapshot == nullptr) {
+        return {};
+    }
+    auto sensor_cdev_request_stats_snapshot = *published_snapshot;
     for (auto &sensor_cdev_request_stats_pair : sensor_cdev_request_stats_snapshot) {
         for (auto &cdev_request_stats_pair : sensor_cdev_request_stats_pair.second) {
             for (auto &request_stats : cdev_request_stats_pair.second.stats_by_custom_threshold) {
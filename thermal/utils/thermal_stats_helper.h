@@ -21,7 +21,11 @@
 #include <android-base/chrono_utils.h>
 #include <hardware/google/pixel/pixelstats/pixelatoms.pb.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <shared_mutex>
 #include <string_view>
 #include <unordered_map>
@@ -73,13 +77,92 @@ struct StatsRecord {
     ~StatsRecord() = default;
 };
 
+/*
+ * Precomputed bucket lookup for a strictly increasing threshold vector.
+ * Finding the residency bucket used to run an upper_bound over the thresholds
+ * for every sample; on the per-polling update path with tens of sensors the
+ * search branches dominate the update cost. The table quantizes the span
+ * between the first and last threshold into fixed-width cells and stores the
+ * bucket for every cell that lies entirely inside one bucket, so steady-state
+ * samples resolve with one multiply and one load. Cells that contain a
+ * threshold boundary fall back to the exact search, so bucket edges stay
+ * identical to the previous behavior.
+ */
+template <typename ValueType>
+class ThresholdBucketLookup {
+  public:
+    ThresholdBucketLookup() = default;
+    explicit ThresholdBucketLookup(const std::vector<ValueType> &thresholds) {
+        if (thresholds.size() < 2) {
+            return;
+        }
+        min_ = static_cast<float>(thresholds.front());
+        const float span = static_cast<float>(thresholds.back()) - min_;
+        if (!(span > 0)) {
+            return;
+        }
+        inv_cell_width_ = kCellCount / span;
+        table_.resize(kCellCount);
+        for (size_t i = 0; i < kCellCount; ++i) {
+            const float cell_begin = min_ + i / inv_cell_width_;
+            const float cell_end = min_ + (i + 1) / inv_cell_width_;
+            // The bucket for a value is the count of thresholds <= value, so
+            // the cell is uniform iff no threshold lies strictly inside
+            // (cell_begin, cell_end).
+            const auto first_above_begin =
+                    std::upper_bound(thresholds.begin(), thresholds.end(), cell_begin);
+            const auto first_at_or_above_end =
+                    std::lower_bound(thresholds.begin(), thresholds.end(), cell_end);
+            table_[i] = (first_above_begin == first_at_or_above_end)
+                                ? static_cast<int16_t>(first_above_begin - thresholds.begin())
+                                : kMixedCell;
+        }
+    }
+
+    // Returns the same bucket std::upper_bound over thresholds would yield.
+    // thresholds must be the vector this lookup was built from.
+    int bucketFor(const std::vector<ValueType> &thresholds, ValueType value) const {
+        if (thresholds.empty()) {
+            return static_cast<int>(value);
+        }
+        const float v = static_cast<float>(value);
+        if (table_.empty() || v < min_ ||
+            v >= min_ + kCellCount / inv_cell_width_) {
+            return searchBucket(thresholds, value);
+        }
+        size_t idx = static_cast<size_t>((v - min_) * inv_cell_width_);
+        if (idx >= kCellCount) {
+            idx = kCellCount - 1;
+        }
+        const int16_t bucket = table_[idx];
+        return (bucket != kMixedCell) ? bucket : searchBucket(thresholds, value);
+    }
+
+  private:
+    static constexpr size_t kCellCount = 256;
+    static constexpr int16_t kMixedCell = -1;
+
+    static int searchBucket(const std::vector<ValueType> &thresholds, ValueType value) {
+        const auto threshold_idx =
+                std::upper_bound(thresholds.begin(), thresholds.end(), value);
+        return static_cast<int>(threshold_idx - thresholds.begin());
+    }
+
+    float min_ = 0;
+    float inv_cell_width_ = 0;
+    std::vector<int16_t> table_;
+};
+
 template <typename ValueType>
 struct StatsByThreshold {
     std::vector<ValueType> thresholds;
+    ThresholdBucketLookup<ValueType> bucket_lookup;
     std::optional<std::string> logging_name;
     StatsRecord stats_record;
     explicit StatsByThreshold(ThresholdList<ValueType> threshold_list)
-        : thresholds(threshold_list.thresholds), logging_name(threshold_list.logging_name) {
+        : thresholds(threshold_list.thresholds),
+          bucket_lookup(threshold_list.thresholds),
+          logging_name(threshold_list.logging_name) {
         // number of states = number of thresholds + 1
         // e.g. threshold: [30, 50, 60]
         //      buckets: [MIN - 30, 30 - 50, 50-60, 60-MAX]
@@ -168,7 +251,18 @@ class ThermalStatsHelper {
     // StatsRecord)
     std::unordered_map<std::string, std::unordered_map<std::string, ThermalStats<int>>>
             sensor_cdev_request_stats_map_;
+    // Immutable snapshots republished by the updater once per polling cycle.
+    // Snapshot readers only swap these pointers, so they never contend with
+    // the throttling-critical update path on the stats mutexes.
+    mutable std::mutex snapshot_mutex_;
+    std::shared_ptr<const std::unordered_map<std::string, SensorTempStats>>
+            sensor_temp_stats_snapshot_;
+    std::shared_ptr<
+            const std::unordered_map<std::string, std::unordered_map<std::string, ThermalStats<int>>>>
+            sensor_cdev_request_stats_snapshot_;
 
+    // Fill the inactive snapshot buffers from the live maps and swap them in.
+    void publishStatsSnapshots();
     bool initializeSensorTempStats(
             const StatsInfo<float> &sensor_stats_info,
             const std::unordered_map<std::string, SensorInfo> &sensor_info_map_);
@@ -179,19 +273,34 @@ class ThermalStatsHelper {
     bool initializeSensorAbnormalityStats(
             const AbnormalStatsInfo &abnormal_stats_info,
             const std::unordered_map<std::string, SensorInfo> &sensor_info_map_);
+    // A fully-built residency atom waiting for submission. Atoms are prepared
+    // under the stats mutexes but submitted to IStats in one batch with the
+    // mutexes dropped, so the per-polling update path never blocks behind the
+    // periodic burst of binder calls.
+    struct PendingStatsReport {
+        int32_t atom_id;
+        std::vector<VendorAtomValue> values;
+        StatsRecord *stats_record;
+        std::vector<int64_t> reported_time_in_state_ms;
+        std::string logging_name;
+    };
+
     void updateStatsRecord(StatsRecord *stats_record, int new_state);
     void verifySensorAbnormality(std::string_view sensor, float temperature);
     int reportAllSensorTempStats(const std::shared_ptr<IStats> &stats_client);
-    bool reportSensorTempStats(const std::shared_ptr<IStats> &stats_client, std::string_view sensor,
-                               const SensorTempStats &sensor_temp_stats, StatsRecord *stats_record);
+    PendingStatsReport prepareSensorTempStatsReport(std::string_view sensor,
+                                                    const SensorTempStats &sensor_temp_stats,
+                                                    StatsRecord *stats_record);
     int reportAllSensorCdevRequestStats(const std::shared_ptr<IStats> &stats_client);
-    bool reportSensorCdevRequestStats(const std::shared_ptr<IStats> &stats_client,
-                                      std::string_view sensor, std::string_view cdev,
-                                      StatsRecord *stats_record);
+    PendingStatsReport prepareSensorCdevRequestStatsReport(std::string_view sensor,
+                                                           std::string_view cdev,
+                                                           StatsRecord *stats_record);
+    int submitPendingReports(const std::shared_ptr<IStats> &stats_client,
+                             std::vector<PendingStatsReport> *pending,
+                             std::shared_mutex *stats_mutex);
     bool reportAtom(const std::shared_ptr<IStats> &stats_client, const int32_t &atom_id,
                     std::vector<VendorAtomValue> &&values);
     std::vector<int64_t> processStatsRecordForReporting(StatsRecord *stats_record);
-    StatsRecord restoreStatsRecordOnFailure(StatsRecord &&stats_record_before_failure);
 };
 
 }  // namespace implementation
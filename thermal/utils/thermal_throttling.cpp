@@ -31,6 +31,7 @@
 #include <vector>
 
 #include "power_files.h"
+#include "thermal_event_journal.h"
 #include "thermal_info.h"
 
 namespace aidl {
@@ -40,13 +41,16 @@ namespace thermal {
 namespace implementation {
 using ::android::base::StringPrintf;
 
-// To find the next PID target state according to the current thermal severity
-size_t getTargetStateOfPID(const SensorInfo &sensor_info, const ThrottlingSeverity curr_severity) {
+namespace {
+// Scan s_power for the PID target state of one severity, used to fill the
+// per-sensor target state table at registration time.
+size_t scanTargetStateOfPID(const ThrottlingArray &s_power,
+                            const ThrottlingSeverity curr_severity) {
     size_t target_state = 0;
 
     for (const auto &severity : ::ndk::enum_range<ThrottlingSeverity>()) {
         size_t state = static_cast<size_t>(severity);
-        if (std::isnan(sensor_info.throttling_info->s_power[state])) {
+        if (std::isnan(s_power[state])) {
             continue;
         }
         target_state = state;
@@ -54,6 +58,14 @@ size_t getTargetStateOfPID(const SensorInfo &sensor_info, const ThrottlingSeveri
             break;
         }
     }
+    return target_state;
+}
+}  // namespace
+
+// To find the next PID target state according to the current thermal severity
+size_t getTargetStateOfPID(const SensorInfo &sensor_info, const ThrottlingSeverity curr_severity) {
+    const size_t target_state =
+            scanTargetStateOfPID(sensor_info.throttling_info->s_power, curr_severity);
     LOG(VERBOSE) << "PID target state = " << target_state;
     return target_state;
 }
@@ -139,6 +151,14 @@ bool ThermalThrottling::registerThermalThrottling(
     thermal_throttling_status_map_[sensor_name.data()].tran_cycle = 0;
     thermal_throttling_status_map_[sensor_name.data()].profile = "";
 
+    // Compile the PID target state selection into a dense per-severity table
+    // so the throttling loop does not rescan s_power on every cycle.
+    for (const auto &severity : ::ndk::enum_range<ThrottlingSeverity>()) {
+        thermal_throttling_status_map_[sensor_name.data()]
+                .pid_target_state_table[static_cast<size_t>(severity)] =
+                scanTargetStateOfPID(throttling_info->s_power, severity);
+    }
+
     for (auto &binded_cdev_pair : throttling_info->binded_cdev_info_map) {
         if (!cooling_device_info_map.count(binded_cdev_pair.first)) {
             LOG(ERROR) << "Could not find " << sensor_name.data() << "'s binded CDEV "
@@ -200,7 +220,9 @@ float ThermalThrottling::updatePowerBudget(const Temperature &temp, const Sensor
         return power_budget;
     }
 
-    const auto target_state = getTargetStateOfPID(sensor_info, curr_severity);
+    const auto target_state =
+            throttling_status.pid_target_state_table[static_cast<size_t>(curr_severity)];
+    LOG(VERBOSE) << "PID target state = " << target_state;
     if (throttling_status.prev_target != static_cast<size_t>(ThrottlingSeverity::NONE) &&
         target_state != throttling_status.prev_target &&
         sensor_info.throttling_info->tran_cycle > 0) {
@@ -257,11 +279,18 @@ float ThermalThrottling::updatePowerBudget(const Temperature &temp, const Sensor
         throttling_status.tran_cycle--;
     }
 
-    LOG(INFO) << temp.name << " power_budget=" << power_budget << " err=" << err
-              << " s_power=" << sensor_info.throttling_info->s_power[target_state]
-              << " time_elapsed_ms=" << time_elapsed_ms.count() << " p=" << p
-              << " i=" << throttling_status.i_budget << " d=" << d
-              << " budget transient=" << budget_transient << " control target=" << target_state;
+    // Journal first, text second: the PID runs every polling cycle during
+    // throttling, so the full breakdown goes to logd at most once a minute.
+    auto *journal = ThermalEventJournal::getInstance();
+    journal->record(ThermalEventJournal::EventType::kPidUpdate, temp.name, power_budget,
+                    static_cast<int32_t>(target_state));
+    if (journal->shouldLogText(ThermalEventJournal::EventType::kPidUpdate, temp.name)) {
+        LOG(INFO) << temp.name << " power_budget=" << power_budget << " err=" << err
+                  << " s_power=" << sensor_info.throttling_info->s_power[target_state]
+                  << " time_elapsed_ms=" << time_elapsed_ms.count() << " p=" << p
+                  << " i=" << throttling_status.i_budget << " d=" << d
+                  << " budget transient=" << budget_transient << " control target=" << target_state;
+    }
 
     ATRACE_INT((sensor_name + std::string("-power_budget")).c_str(),
                static_cast<int>(power_budget));
@@ -338,23 +367,30 @@ bool ThermalThrottling::allocatePowerToCdev(
     std::unique_lock<std::shared_mutex> _lock(thermal_throttling_status_map_mutex_);
     auto total_power_budget =
             updatePowerBudget(temp, sensor_info, time_elapsed_ms, curr_severity, max_throttling);
-    const auto &profile = thermal_throttling_status_map_[temp.name].profile;
+    auto &throttling_status = thermal_throttling_status_map_.at(temp.name);
+    const auto &profile = throttling_status.profile;
+    const auto &binded_cdev_info_map =
+            sensor_info.throttling_info->profile_map.count(profile)
+                    ? sensor_info.throttling_info->profile_map.at(profile)
+                    : sensor_info.throttling_info->binded_cdev_info_map;
 
     if (sensor_info.throttling_info->excluded_power_info_map.size()) {
         total_power_budget -= computeExcludedPower(sensor_info, curr_severity, power_status_map,
                                                    &log_buf, temp.name);
         total_power_budget = std::max(total_power_budget, 0.0f);
         if (!log_buf.empty()) {
-            LOG(INFO) << temp.name << " power budget=" << total_power_budget << " after " << log_buf
-                      << " is excluded";
+            auto *journal = ThermalEventJournal::getInstance();
+            journal->record(ThermalEventJournal::EventType::kPowerBudget, temp.name,
+                            total_power_budget, 0);
+            if (journal->shouldLogText(ThermalEventJournal::EventType::kPowerBudget, temp.name)) {
+                LOG(INFO) << temp.name << " power budget=" << total_power_budget << " after "
+                          << log_buf << " is excluded";
+            }
         }
     }
 
     // Compute total cdev weight
-    for (const auto &binded_cdev_info_pair :
-         (sensor_info.throttling_info->profile_map.count(profile)
-                  ? sensor_info.throttling_info->profile_map.at(profile)
-                  : sensor_info.throttling_info->binded_cdev_info_map)) {
+    for (const auto &binded_cdev_info_pair : binded_cdev_info_map) {
         const auto cdev_weight = binded_cdev_info_pair.second
                                          .cdev_weight_for_pid[static_cast<size_t>(curr_severity)];
         if (!binded_cdev_info_pair.second.enabled) {
@@ -367,10 +403,7 @@ bool ThermalThrottling::allocatePowerToCdev(
     }
 
     while (!is_budget_allocated) {
-        for (const auto &binded_cdev_info_pair :
-             (sensor_info.throttling_info->profile_map.count(profile)
-                      ? sensor_info.throttling_info->profile_map.at(profile)
-                      : sensor_info.throttling_info->binded_cdev_info_map)) {
+        for (const auto &binded_cdev_info_pair : binded_cdev_info_map) {
             float cdev_power_adjustment = 0;
             const auto cdev_weight =
                     binded_cdev_info_pair.second
@@ -411,7 +444,7 @@ bool ThermalThrottling::allocatePowerToCdev(
             if (low_power_device_check) {
                 // Share the budget for the CDEV which power is lower than target
                 if (cdev_power_adjustment > 0 &&
-                    thermal_throttling_status_map_[temp.name].pid_cdev_request_map.at(
+                    throttling_status.pid_cdev_request_map.at(
                             binded_cdev_info_pair.first) == 0) {
                     allocated_power += last_updated_avg_power;
                     allocated_weight += cdev_weight;
@@ -433,7 +466,7 @@ bool ThermalThrottling::allocatePowerToCdev(
                 }
                 // Ignore the power distribution if the CDEV has no space to reduce power
                 if ((cdev_power_adjustment < 0 &&
-                     thermal_throttling_status_map_[temp.name].pid_cdev_request_map.at(
+                     throttling_status.pid_cdev_request_map.at(
                              binded_cdev_info_pair.first) == cdev_info.max_state)) {
                     LOG(VERBOSE) << temp.name << " binded " << binded_cdev_info_pair.first
                                  << " has been already at max state " << cdev_info.max_state;
@@ -444,7 +477,7 @@ bool ThermalThrottling::allocatePowerToCdev(
                     cdev_power_budget = cdev_info.state2power[0];
                 } else if (!power_data_invalid && binded_cdev_info_pair.second.power_rail != "") {
                     auto cdev_curr_power_budget =
-                            thermal_throttling_status_map_[temp.name].pid_power_budget_map.at(
+                            throttling_status.pid_power_budget_map.at(
                                     binded_cdev_info_pair.first);
 
                     if (last_updated_avg_power > cdev_curr_power_budget) {
@@ -471,7 +504,7 @@ bool ThermalThrottling::allocatePowerToCdev(
                 }
 
                 const auto curr_cdev_vote =
-                        thermal_throttling_status_map_[temp.name].pid_cdev_request_map.at(
+                        throttling_status.pid_cdev_request_map.at(
                                 binded_cdev_info_pair.first);
 
                 if (!max_throttling) {
@@ -504,10 +537,10 @@ bool ThermalThrottling::allocatePowerToCdev(
                     }
                 }
 
-                thermal_throttling_status_map_[temp.name].pid_power_budget_map.at(
+                throttling_status.pid_power_budget_map.at(
                         binded_cdev_info_pair.first) = cdev_power_budget;
                 LOG(VERBOSE) << temp.name << " allocate "
-                             << thermal_throttling_status_map_[temp.name].pid_power_budget_map.at(
+                             << throttling_status.pid_power_budget_map.at(
                                         binded_cdev_info_pair.first)
                              << "mW to " << binded_cdev_info_pair.first
                              << "(cdev_weight=" << cdev_weight << ")";
@@ -527,7 +560,9 @@ bool ThermalThrottling::allocatePowerToCdev(
             is_budget_allocated = true;
         }
     }
-    if (log_buf.size()) {
+    if (log_buf.size() &&
+        ThermalEventJournal::getInstance()->shouldLogText(
+                ThermalEventJournal::EventType::kPowerCheck, temp.name)) {
         LOG(INFO) << temp.name << " binded power rails: " << log_buf;
     }
     return true;
@@ -539,8 +574,8 @@ void ThermalThrottling::updateCdevRequestByPower(
     size_t i;
 
     std::unique_lock<std::shared_mutex> _lock(thermal_throttling_status_map_mutex_);
-    for (auto &pid_power_budget_pair :
-         thermal_throttling_status_map_[sensor_name.data()].pid_power_budget_map) {
+    auto &throttling_status = thermal_throttling_status_map_.at(sensor_name.data());
+    for (auto &pid_power_budget_pair : throttling_status.pid_power_budget_map) {
         const CdevInfo &cdev_info = cooling_device_info_map.at(pid_power_budget_pair.first);
 
         for (i = 0; i < cdev_info.state2power.size() - 1; ++i) {
@@ -548,8 +583,8 @@ void ThermalThrottling::updateCdevRequestByPower(
                 break;
             }
         }
-        thermal_throttling_status_map_[sensor_name.data()].pid_cdev_request_map.at(
-                pid_power_budget_pair.first) = static_cast<int>(i);
+        throttling_status.pid_cdev_request_map.at(pid_power_budget_pair.first) =
+                static_cast<int>(i);
     }
 
     return;
@@ -559,26 +594,25 @@ void ThermalThrottling::updateCdevRequestBySeverity(std::string_view sensor_name
                                                     const SensorInfo &sensor_info,
                                                     ThrottlingSeverity curr_severity) {
     std::unique_lock<std::shared_mutex> _lock(thermal_throttling_status_map_mutex_);
-    const auto &profile = thermal_throttling_status_map_[sensor_name.data()].profile;
+    auto &throttling_status = thermal_throttling_status_map_.at(sensor_name.data());
+    const auto &profile = throttling_status.profile;
 
     for (const auto &binded_cdev_info_pair :
          (sensor_info.throttling_info->profile_map.count(profile)
                   ? sensor_info.throttling_info->profile_map.at(profile)
                   : sensor_info.throttling_info->binded_cdev_info_map)) {
-        if (!thermal_throttling_status_map_[sensor_name.data()].hardlimit_cdev_request_map.count(
-                    binded_cdev_info_pair.first)) {
+        if (!throttling_status.hardlimit_cdev_request_map.count(binded_cdev_info_pair.first)) {
             continue;
         }
-        thermal_throttling_status_map_[sensor_name.data()].hardlimit_cdev_request_map.at(
-                binded_cdev_info_pair.first) =
+        throttling_status.hardlimit_cdev_request_map.at(binded_cdev_info_pair.first) =
                 (binded_cdev_info_pair.second.enabled)
                         ? binded_cdev_info_pair.second
                                   .limit_info[static_cast<size_t>(curr_severity)]
                         : 0;
         LOG(VERBOSE) << "Hard Limit: Sensor " << sensor_name.data() << " update cdev "
                      << binded_cdev_info_pair.first << " to "
-                     << thermal_throttling_status_map_[sensor_name.data()]
-                                .hardlimit_cdev_request_map.at(binded_cdev_info_pair.first);
+                     << throttling_status.hardlimit_cdev_request_map.at(
+                                binded_cdev_info_pair.first);
     }
 }
 
@@ -625,11 +659,19 @@ bool ThermalThrottling::throttlingReleaseUpdate(
                 is_over_budget = false;
             }
         }
-        LOG(INFO) << sensor_name.data() << "'s " << binded_cdev_info_pair.first
-                  << " binded power rail " << binded_cdev_info_pair.second.power_rail
-                  << ": power threshold = "
-                  << binded_cdev_info_pair.second.power_thresholds[static_cast<int>(severity)]
-                  << ", avg power = " << avg_power;
+        auto *journal = ThermalEventJournal::getInstance();
+        journal->record(ThermalEventJournal::EventType::kPowerCheck,
+                        binded_cdev_info_pair.second.power_rail, avg_power,
+                        static_cast<int32_t>(binded_cdev_info_pair.second
+                                                     .power_thresholds[static_cast<int>(severity)]));
+        if (journal->shouldLogText(ThermalEventJournal::EventType::kPowerCheck,
+                                   binded_cdev_info_pair.second.power_rail)) {
+            LOG(INFO) << sensor_name.data() << "'s " << binded_cdev_info_pair.first
+                      << " binded power rail " << binded_cdev_info_pair.second.power_rail
+                      << ": power threshold = "
+                      << binded_cdev_info_pair.second.power_thresholds[static_cast<int>(severity)]
+                      << ", avg power = " << avg_power;
+        }
         std::string atrace_prefix = ::android::base::StringPrintf(
                 "%s-%s", sensor_name.data(), binded_cdev_info_pair.second.power_rail.data());
         ATRACE_INT(
@@ -18,6 +18,7 @@
 
 #include <aidl/android/hardware/thermal/Temperature.h>
 
+#include <array>
 #include <queue>
 #include <set>
 #include <shared_mutex>
@@ -36,6 +37,9 @@ namespace thermal {
 namespace implementation {
 
 struct ThermalThrottlingStatus {
+    // PID target state per severity, precomputed at registration so the
+    // throttling loop can index it directly instead of rescanning s_power.
+    std::array<size_t, static_cast<size_t>(kThrottlingSeverityCount)> pid_target_state_table;
     std::unordered_map<std::string, int> pid_power_budget_map;
     std::unordered_map<std::string, int> pid_cdev_request_map;
     std::unordered_map<std::string, int> hardlimit_cdev_request_map;
@@ -74,6 +78,13 @@ class ThermalThrottling {
         std::shared_lock<std::shared_mutex> _lock(thermal_throttling_status_map_mutex_);
         return thermal_throttling_status_map_;
     }
+    // Copy of the throttling status map taken under the lock, for readers
+    // (dump) that format after the lock is released
+    std::unordered_map<std::string, ThermalThrottlingStatus> GetThermalThrottlingStatusMapSnapshot()
+            const {
+        std::shared_lock<std::shared_mutex> _lock(thermal_throttling_status_map_mutex_);
+        return thermal_throttling_status_map_;
+    }
     // Update thermal throttling request for the specific sensor
     void thermalThrottlingUpdate(
             const Temperature &temp, const SensorInfo &sensor_info,
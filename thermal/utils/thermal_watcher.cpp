@@ -33,6 +33,7 @@
 
 #include <chrono>
 #include <fstream>
+#include <unordered_set>
 
 #include "../thermal-helper.h"
 
@@ -190,7 +191,7 @@ static int handleEvent(struct nl_msg *n, void *arg) {
     struct nlmsghdr *nlh = nlmsg_hdr(n);
     struct genlmsghdr *glh = genlmsg_hdr(nlh);
     struct nlattr *attrs[THERMAL_GENL_ATTR_MAX + 1];
-    int *tz_id = reinterpret_cast<int *>(arg);
+    auto *tz_ids = reinterpret_cast<std::unordered_set<int> *>(arg);
 
     genlmsg_parse(nlh, 0, attrs, THERMAL_GENL_ATTR_MAX, NULL);
 
@@ -198,7 +199,7 @@ static int handleEvent(struct nl_msg *n, void *arg) {
         LOG(INFO) << "THERMAL_GENL_EVENT_TZ_TRIP_UP";
         if (attrs[THERMAL_GENL_ATTR_TZ_ID]) {
             LOG(INFO) << "Thermal zone id: " << nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
-            *tz_id = nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
+            tz_ids->insert(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]));
         }
         if (attrs[THERMAL_GENL_ATTR_TZ_TRIP_ID])
             LOG(INFO) << "Thermal zone trip id: "
@@ -209,7 +210,7 @@ static int handleEvent(struct nl_msg *n, void *arg) {
         LOG(INFO) << "THERMAL_GENL_EVENT_TZ_TRIP_DOWN";
         if (attrs[THERMAL_GENL_ATTR_TZ_ID]) {
             LOG(INFO) << "Thermal zone id: " << nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
-            *tz_id = nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
+            tz_ids->insert(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]));
         }
         if (attrs[THERMAL_GENL_ATTR_TZ_TRIP_ID])
             LOG(INFO) << "Thermal zone trip id: "
@@ -220,7 +221,7 @@ static int handleEvent(struct nl_msg *n, void *arg) {
         LOG(INFO) << "THERMAL_GENL_EVENT_TZ_GOV_CHANGE";
         if (attrs[THERMAL_GENL_ATTR_TZ_ID]) {
             LOG(INFO) << "Thermal zone id: " << nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
-            *tz_id = nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
+            tz_ids->insert(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]));
         }
         if (attrs[THERMAL_GENL_ATTR_GOV_NAME])
             LOG(INFO) << "Governor name: " << nla_get_string(attrs[THERMAL_GENL_ATTR_GOV_NAME]);
@@ -230,7 +231,7 @@ static int handleEvent(struct nl_msg *n, void *arg) {
         LOG(INFO) << "THERMAL_GENL_EVENT_TZ_CREATE";
         if (attrs[THERMAL_GENL_ATTR_TZ_ID]) {
             LOG(INFO) << "Thermal zone id: " << nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
-            *tz_id = nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
+            tz_ids->insert(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]));
         }
         if (attrs[THERMAL_GENL_ATTR_TZ_NAME])
             LOG(INFO) << "Thermal zone name: " << nla_get_string(attrs[THERMAL_GENL_ATTR_TZ_NAME]);
@@ -240,7 +241,7 @@ static int handleEvent(struct nl_msg *n, void *arg) {
         LOG(INFO) << "THERMAL_GENL_EVENT_TZ_DELETE";
         if (attrs[THERMAL_GENL_ATTR_TZ_ID]) {
             LOG(INFO) << "Thermal zone id: " << nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
-            *tz_id = nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
+            tz_ids->insert(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]));
         }
     }
 
@@ -248,7 +249,7 @@ static int handleEvent(struct nl_msg *n, void *arg) {
         LOG(INFO) << "THERMAL_GENL_EVENT_TZ_DISABLE";
         if (attrs[THERMAL_GENL_ATTR_TZ_ID]) {
             LOG(INFO) << "Thermal zone id: " << nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
-            *tz_id = nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
+            tz_ids->insert(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]));
         }
     }
 
@@ -256,7 +257,7 @@ static int handleEvent(struct nl_msg *n, void *arg) {
         LOG(INFO) << "THERMAL_GENL_EVENT_TZ_ENABLE";
         if (attrs[THERMAL_GENL_ATTR_TZ_ID]) {
             LOG(INFO) << "Thermal zone id: " << nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
-            *tz_id = nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
+            tz_ids->insert(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]));
         }
     }
 
@@ -264,7 +265,7 @@ static int handleEvent(struct nl_msg *n, void *arg) {
         LOG(INFO) << "THERMAL_GENL_EVENT_TZ_TRIP_CHANGE";
         if (attrs[THERMAL_GENL_ATTR_TZ_ID]) {
             LOG(INFO) << "Thermal zone id: " << nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
-            *tz_id = nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
+            tz_ids->insert(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]));
         }
         if (attrs[THERMAL_GENL_ATTR_TZ_TRIP_ID])
             LOG(INFO) << "Trip id:: " << nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_TRIP_ID]);
@@ -294,7 +295,7 @@ static int handleEvent(struct nl_msg *n, void *arg) {
         LOG(INFO) << "THERMAL_GENL_EVENT_TZ_TRIP_DELETE";
         if (attrs[THERMAL_GENL_ATTR_TZ_ID]) {
             LOG(INFO) << "Thermal zone id: " << nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
-            *tz_id = nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
+            tz_ids->insert(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]));
         }
         if (attrs[THERMAL_GENL_ATTR_TZ_TRIP_ID])
             LOG(INFO) << "Trip id:: " << nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_TRIP_ID]);
@@ -330,7 +331,7 @@ static int handleEvent(struct nl_msg *n, void *arg) {
         LOG(INFO) << "THERMAL_GENL_SAMPLING_TEMP";
         if (attrs[THERMAL_GENL_ATTR_TZ_ID]) {
             LOG(INFO) << "Thermal zone id: " << nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
-            *tz_id = nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]);
+            tz_ids->insert(nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_ID]));
         }
         if (attrs[THERMAL_GENL_ATTR_TZ_TEMP])
             LOG(INFO) << "Thermal zone temp: " << nla_get_u32(attrs[THERMAL_GENL_ATTR_TZ_TEMP]);
@@ -399,6 +400,17 @@ void ThermalWatcher::registerFilesToWatchNl(const std::set<std::string> &sensors
     last_update_time_ = boot_clock::now();
 }
 
+void ThermalWatcher::setThreadSchedulingInfo(const ThreadSchedulingInfo &sched_info) {
+    sched_info_ = sched_info;
+}
+
+::android::status_t ThermalWatcher::readyToRun() {
+    if (sched_info_.rt_priority > 0 || !sched_info_.allowed_cpus.empty()) {
+        ApplySchedulingToCurrentThread(sched_info_);
+    }
+    return ::android::Thread::readyToRun();
+}
+
 bool ThermalWatcher::startWatchingDeviceFiles() {
     if (cb_) {
         auto ret = this->run("FileWatcherThread", -10);
@@ -467,7 +479,8 @@ void ThermalWatcher::parseUevent(std::set<std::string> *sensors_set) {
 // TODO(b/175367921): Consider for potentially adding more type of event in the function
 // instead of just add the sensors to the list.
 void ThermalWatcher::parseGenlink(std::set<std::string> *sensors_set) {
-    int err = 0, done = 0, tz_id = -1;
+    int err = 0, done = 0;
+    std::unordered_set<int> tz_ids;
 
     std::unique_ptr<nl_cb, decltype(&nl_cb_put)> cb(nl_cb_alloc(NL_CB_DEFAULT), nl_cb_put);
 
@@ -475,19 +488,24 @@ void ThermalWatcher::parseGenlink(std::set<std::string> *sensors_set) {
     nl_cb_set(cb.get(), NL_CB_FINISH, NL_CB_CUSTOM, nlFinishHandle, &done);
     nl_cb_set(cb.get(), NL_CB_ACK, NL_CB_CUSTOM, nlAckHandle, &done);
     nl_cb_set(cb.get(), NL_CB_SEQ_CHECK, NL_CB_CUSTOM, nlSeqCheckHandle, &done);
-    nl_cb_set(cb.get(), NL_CB_VALID, NL_CB_CUSTOM, handleEvent, &tz_id);
+    nl_cb_set(cb.get(), NL_CB_VALID, NL_CB_CUSTOM, handleEvent, &tz_ids);
 
-    while (!done && !err) {
-        nl_recvmsgs(sk_thermal, cb.get());
+    // Drain the non-blocking socket completely so an event storm collapses
+    // into one deduplicated batch of zone ids and a single callback.
+    while (!done && !err && nl_recvmsgs(sk_thermal, cb.get()) >= 0) {
+    }
 
-        if (tz_id < 0) {
-            break;
+    for (const int tz_id : tz_ids) {
+        auto cache_itr = tz_type_cache_.find(tz_id);
+        if (cache_itr == tz_type_cache_.end()) {
+            std::string name;
+            if (!getThermalZoneTypeById(tz_id, &name)) {
+                continue;
+            }
+            cache_itr = tz_type_cache_.emplace(tz_id, std::move(name)).first;
         }
-
-        std::string name;
-        if (getThermalZoneTypeById(tz_id, &name) &&
-            monitored_sensors_.find(name) != monitored_sensors_.end()) {
-            sensors_set->insert(name);
+        if (monitored_sensors_.find(cache_itr->second) != monitored_sensors_.end()) {
+            sensors_set->insert(cache_itr->second);
         }
     }
 }
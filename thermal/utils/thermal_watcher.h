@@ -35,6 +35,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "thermal_info.h"
+
 namespace aidl {
 namespace android {
 namespace hardware {
@@ -68,8 +70,15 @@ class ThermalWatcher : public ::android::Thread {
     // Wake up the looper thus the worker thread, immediately. This can be called
     // in any thread.
     void wake();
+    // Scheduling overrides for the watcher thread, applied when it starts.
+    // This should be called before starting watcher thread.
+    void setThreadSchedulingInfo(const ThreadSchedulingInfo &sched_info);
 
   private:
+    // Apply the configured scheduling overrides on the watcher thread before
+    // its first loop iteration.
+    ::android::status_t readyToRun() override;
+
     // The work done by the watcher thread. This will use inotify to check for
     // modifications to the files to watch. If any modification is seen this
     // will callback the registered function with the new data read from the
@@ -99,6 +108,11 @@ class ThermalWatcher : public ::android::Thread {
     ::android::base::unique_fd thermal_genl_fd_;
     // Sensor list which monitor flag is enabled.
     std::set<std::string> monitored_sensors_;
+    // Cache of thermal zone id to zone type, so draining an event storm does
+    // not re-read the tz type sysfs node per message.
+    std::unordered_map<int, std::string> tz_type_cache_;
+    // Scheduling overrides for the watcher thread; empty when unconfigured.
+    ThreadSchedulingInfo sched_info_{.rt_priority = 0, .allowed_cpus = {}};
     // Sleep interval voting result
     std::chrono::milliseconds sleep_ms_;
     // Timestamp for last thermal update
@@ -16,13 +16,49 @@
 #include "virtualtemp_estimator.h"
 
 #include <android-base/logging.h>
+#include <android-base/stringprintf.h>
 #include <dlfcn.h>
 
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 namespace thermal {
 namespace vtestimator {
 
+namespace {
+
+// Dot product kernel for the linear model evaluation. The NEON path consumes
+// four lanes per iteration with fused multiply-accumulate; the scalar loop
+// handles the tail and non-NEON builds.
+float DotProduct(const float *a, const float *b, size_t n) {
+    size_t i = 0;
+    float sum = 0.0f;
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= n; i += 4) {
+        acc = vfmaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    sum = vaddvq_f32(acc);
+#endif
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+// Registry of live shared wrapper instances keyed by model path plus the init
+// parameters that shape the interpreter. Entries are weak so the registry never
+// extends an interpreter's lifetime past its last estimator.
+std::mutex shared_wrapper_registry_mutex;
+std::unordered_map<std::string, std::weak_ptr<SharedTFLiteWrapper>> shared_wrapper_registry;
+
+}  // namespace
+
 void VirtualTempEstimator::LoadTFLiteWrapper() {
     if (!tflite_instance_) {
         LOG(ERROR) << "tflite_instance_ is nullptr during LoadTFLiteWrapper";
@@ -49,6 +85,15 @@ void VirtualTempEstimator::LoadTFLiteWrapper() {
         LOG(ERROR) << "Could not link and cast tflitewrapper_init with error: " << dlerror();
     }
 
+    // Optional: newer wrappers export InitWithOptions so quantized (int8)
+    // execution and the XNNPACK delegate can be requested at init time.
+    tflite_instance_->tflite_methods.init_options =
+            reinterpret_cast<tflitewrapper_init_options>(dlsym(mLibHandle, "InitWithOptions"));
+    if (!tflite_instance_->tflite_methods.init_options) {
+        LOG(INFO) << "tflite wrapper does not export InitWithOptions, "
+                  << "quantized inference is unavailable";
+    }
+
     tflite_instance_->tflite_methods.invoke =
             reinterpret_cast<tflitewrapper_invoke>(dlsym(mLibHandle, "Invoke"));
     if (!tflite_instance_->tflite_methods.invoke) {
@@ -174,7 +219,9 @@ VtEstimatorStatus VirtualTempEstimator::TFliteInitialize(MLModelInitData data) {
     tflite_instance_->output_label_count = output_label_count;
     tflite_instance_->num_hot_spots = num_hot_spots;
     tflite_instance_->output_buffer_size = output_label_count * num_hot_spots;
-    tflite_instance_->output_buffer = new float[tflite_instance_->output_buffer_size];
+    // Value-initialized so GetAllPredictions never hands out garbage before
+    // the first Estimate call.
+    tflite_instance_->output_buffer = new float[tflite_instance_->output_buffer_size]();
 
     if (!tflite_instance_->tflite_methods.create || !tflite_instance_->tflite_methods.init ||
         !tflite_instance_->tflite_methods.invoke || !tflite_instance_->tflite_methods.destroy) {
@@ -182,19 +229,61 @@ VtEstimatorStatus VirtualTempEstimator::TFliteInitialize(MLModelInitData data) {
         return kVtEstimatorInitFailed;
     }
 
-    tflite_instance_->tflite_wrapper =
-            tflite_instance_->tflite_methods.create(kNumInputTensors, kNumOutputTensors);
-    if (!tflite_instance_->tflite_wrapper) {
-        LOG(ERROR) << "Failed to create tflite wrapper";
-        return kVtEstimatorInitFailed;
+    int init_flags = 0;
+    if (data.use_quantized_inference) {
+        init_flags |= kTFLiteWrapperInitFlagQuantized;
+    }
+    if (data.use_xnnpack_delegate) {
+        init_flags |= kTFLiteWrapperInitFlagXNNPack;
     }
 
-    int ret = tflite_instance_->tflite_methods.init(tflite_instance_->tflite_wrapper,
-                                                    model_path.c_str());
-    if (ret) {
-        LOG(ERROR) << "Failed to Init tflite_wrapper for " << model_path << " (ret: )" << ret
-                   << ")";
-        return kVtEstimatorInitFailed;
+    // Reuse a live interpreter when another sensor already initialized the same
+    // model with the same parameters; each extra ML sensor otherwise pays for a
+    // full interpreter and tensor arena of its own.
+    const std::string wrapper_key = ::android::base::StringPrintf(
+            "%s|%d|%zu|%zu", model_path.c_str(), init_flags, tflite_instance_->input_buffer_size,
+            tflite_instance_->output_buffer_size);
+    {
+        std::lock_guard<std::mutex> registry_lock(shared_wrapper_registry_mutex);
+        const auto registry_it = shared_wrapper_registry.find(wrapper_key);
+        if (registry_it != shared_wrapper_registry.end()) {
+            tflite_instance_->shared_wrapper = registry_it->second.lock();
+        }
+    }
+
+    if (tflite_instance_->shared_wrapper) {
+        tflite_instance_->tflite_wrapper = tflite_instance_->shared_wrapper->wrapper;
+        LOG(INFO) << "Reusing shared tflite wrapper for " << model_path;
+    } else {
+        tflite_instance_->tflite_wrapper =
+                tflite_instance_->tflite_methods.create(kNumInputTensors, kNumOutputTensors);
+        if (!tflite_instance_->tflite_wrapper) {
+            LOG(ERROR) << "Failed to create tflite wrapper";
+            return kVtEstimatorInitFailed;
+        }
+
+        int ret;
+        if (init_flags && tflite_instance_->tflite_methods.init_options) {
+            ret = tflite_instance_->tflite_methods.init_options(tflite_instance_->tflite_wrapper,
+                                                                model_path.c_str(), init_flags);
+        } else {
+            if (init_flags) {
+                LOG(WARNING) << "Wrapper lacks InitWithOptions, falling back to float inference "
+                             << "for " << model_path;
+            }
+            ret = tflite_instance_->tflite_methods.init(tflite_instance_->tflite_wrapper,
+                                                        model_path.c_str());
+        }
+        if (ret) {
+            LOG(ERROR) << "Failed to Init tflite_wrapper for " << model_path << " (ret: )" << ret
+                       << ")";
+            return kVtEstimatorInitFailed;
+        }
+
+        tflite_instance_->shared_wrapper = std::make_shared<SharedTFLiteWrapper>(
+                tflite_instance_->tflite_wrapper, tflite_instance_->tflite_methods.destroy);
+        std::lock_guard<std::mutex> registry_lock(shared_wrapper_registry_mutex);
+        shared_wrapper_registry[wrapper_key] = tflite_instance_->shared_wrapper;
     }
 
     common_instance_->cur_sample_index = 0;
@@ -246,10 +335,9 @@ VtEstimatorStatus VirtualTempEstimator::LinearModelEstimate(const std::vector<fl
     int input_level = cur_sample_index;
     float estimated_value = 0;
     for (size_t i = 0; i < prev_samples_order; ++i) {
-        for (size_t j = 0; j < num_linked_sensors; ++j) {
-            estimated_value += linear_model_instance_->coefficients[i][j] *
-                               linear_model_instance_->input_samples[input_level][j];
-        }
+        estimated_value += DotProduct(linear_model_instance_->coefficients[i].data(),
+                                      linear_model_instance_->input_samples[input_level].data(),
+                                      num_linked_sensors);
         input_level--;  // go to previous samples
         input_level = (input_level >= 0) ? input_level : (prev_samples_order - 1);
     }
@@ -324,9 +412,15 @@ VtEstimatorStatus VirtualTempEstimator::TFliteEstimate(const std::vector<float>
         model_input = tflite_instance_->scratch_buffer;
     }
 
-    int ret = tflite_instance_->tflite_methods.invoke(
-            tflite_instance_->tflite_wrapper, model_input, input_buffer_size,
-            tflite_instance_->output_buffer, output_buffer_size);
+    int ret;
+    {
+        // Invoke runs on an interpreter that may be shared with other sensors
+        // bound to the same model, so serialize on the shared mutex.
+        std::unique_lock<std::mutex> invoke_lock(tflite_instance_->shared_wrapper->invoke_mutex);
+        ret = tflite_instance_->tflite_methods.invoke(
+                tflite_instance_->tflite_wrapper, model_input, input_buffer_size,
+                tflite_instance_->output_buffer, output_buffer_size);
+    }
     if (ret) {
         LOG(ERROR) << "Failed to Invoke for " << tflite_instance_->model_path << " (ret: " << ret
                    << ")";
@@ -342,6 +436,28 @@ VtEstimatorStatus VirtualTempEstimator::TFliteEstimate(const std::vector<float>
     return kVtEstimatorOk;
 }
 
+VtEstimatorStatus VirtualTempEstimator::GetAllPredictions(std::vector<float> *predictions) {
+    if (type != kUseMLModel) {
+        return kVtEstimatorUnSupported;
+    }
+
+    if (tflite_instance_ == nullptr || common_instance_ == nullptr || predictions == nullptr) {
+        LOG(ERROR) << "Invalid instance or args during GetAllPredictions";
+        return kVtEstimatorInvalidArgs;
+    }
+
+    std::unique_lock<std::mutex> lock(tflite_instance_->tflite_methods.mutex);
+
+    if (!common_instance_->is_initialized) {
+        LOG(ERROR) << "tflite_instance_ not initialized for " << tflite_instance_->model_path;
+        return kVtEstimatorInitFailed;
+    }
+
+    predictions->assign(tflite_instance_->output_buffer,
+                        tflite_instance_->output_buffer + tflite_instance_->output_buffer_size);
+    return kVtEstimatorOk;
+}
+
 VtEstimatorStatus VirtualTempEstimator::Estimate(const std::vector<float> &thermistors,
                                                  float *output) {
     if (type == kUseMLModel) {
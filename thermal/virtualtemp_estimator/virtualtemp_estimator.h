@@ -39,6 +39,10 @@ struct MLModelInitData {
     float offset;
     size_t output_label_count;
     size_t num_hot_spots;
+    // Run the quantized (int8) variant of the model instead of float inference.
+    bool use_quantized_inference;
+    // Enable the XNNPACK delegate when the wrapper initializes the interpreter.
+    bool use_xnnpack_delegate;
 };
 
 struct LinearModelInitData {
@@ -57,6 +61,8 @@ union VtEstimationInitData {
             ml_model_init_data.offset = 0;
             ml_model_init_data.output_label_count = 1;
             ml_model_init_data.num_hot_spots = 1;
+            ml_model_init_data.use_quantized_inference = false;
+            ml_model_init_data.use_xnnpack_delegate = false;
         } else if (type == kUseLinearModel) {
             linear_model_init_data.use_prev_samples = false;
             linear_model_init_data.prev_samples_order = 1;
@@ -87,6 +93,10 @@ class VirtualTempEstimator {
     // Performs the prediction and returns estimated value in output
     VtEstimatorStatus Estimate(const std::vector<float> &thermistors, float *output);
 
+    // Copies all output labels from the latest Estimate call, forecast labels
+    // included. Only supported for ML model estimators.
+    VtEstimatorStatus GetAllPredictions(std::vector<float> *predictions);
+
   private:
     void LoadTFLiteWrapper();
     VtEstimationType type;
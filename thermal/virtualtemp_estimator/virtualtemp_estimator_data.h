@@ -15,6 +15,7 @@
  */
 
 #include <cstddef>
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -27,8 +28,15 @@ namespace vtestimator {
 constexpr int kNumInputTensors = 1;
 constexpr int kNumOutputTensors = 1;
 
+// Init flags understood by wrappers that export InitWithOptions. The wrapper
+// owns the TFLite interpreter, so quantized (int8) execution and the XNNPACK
+// delegate are set up there; the estimator only requests them.
+constexpr int kTFLiteWrapperInitFlagQuantized = 1 << 0;
+constexpr int kTFLiteWrapperInitFlagXNNPack = 1 << 1;
+
 typedef void *(*tflitewrapper_create)(int num_input_tensors, int num_output_tensors);
 typedef bool (*tflitewrapper_init)(void *handle, const char *model_path);
+typedef bool (*tflitewrapper_init_options)(void *handle, const char *model_path, int init_flags);
 typedef bool (*tflitewrapper_invoke)(void *handle, float *input_samples, int num_input_samples,
                                      float *output_samples, int num_output_samples);
 typedef void (*tflitewrapper_destroy)(void *handle);
@@ -36,6 +44,7 @@ typedef void (*tflitewrapper_destroy)(void *handle);
 struct TFLiteWrapperMethods {
     tflitewrapper_create create;
     tflitewrapper_init init;
+    tflitewrapper_init_options init_options;
     tflitewrapper_invoke invoke;
     tflitewrapper_destroy destroy;
     mutable std::mutex mutex;
@@ -61,6 +70,24 @@ struct VtEstimatorCommonData {
     bool first_iteration;
 };
 
+// One wrapper instance (interpreter + tensor arena) shared by every estimator
+// that initializes the same model file with identical parameters. Refcounted so
+// the interpreter is destroyed with its last estimator; invoke_mutex serializes
+// Invoke calls on the shared interpreter.
+struct SharedTFLiteWrapper {
+    SharedTFLiteWrapper(void *wrapper, tflitewrapper_destroy destroy)
+        : wrapper(wrapper), destroy(destroy) {}
+    ~SharedTFLiteWrapper() {
+        if (wrapper && destroy) {
+            destroy(wrapper);
+        }
+    }
+
+    void *wrapper;
+    tflitewrapper_destroy destroy;
+    std::mutex invoke_mutex;
+};
+
 struct VtEstimatorTFLiteData {
     VtEstimatorTFLiteData() {
         scratch_buffer = nullptr;
@@ -74,6 +101,7 @@ struct VtEstimatorTFLiteData {
 
         tflite_methods.create = nullptr;
         tflite_methods.init = nullptr;
+        tflite_methods.init_options = nullptr;
         tflite_methods.invoke = nullptr;
         tflite_methods.destroy = nullptr;
     }
@@ -87,10 +115,13 @@ struct VtEstimatorTFLiteData {
     float *output_buffer;
     size_t output_buffer_size;
     std::string model_path;
+    std::shared_ptr<SharedTFLiteWrapper> shared_wrapper;
     TFLiteWrapperMethods tflite_methods;
 
     ~VtEstimatorTFLiteData() {
-        if (tflite_wrapper && tflite_methods.destroy) {
+        // A shared interpreter is torn down by its last owner through
+        // SharedTFLiteWrapper; only destroy wrappers this instance created.
+        if (tflite_wrapper && !shared_wrapper && tflite_methods.destroy) {
             tflite_methods.destroy(tflite_wrapper);
         }
 
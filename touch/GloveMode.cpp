@@ -22,13 +22,19 @@
 
 namespace vendor::lineage::touch::pixel {
 
+GloveMode::GloveMode() : mEnabled(android::base::GetBoolProperty(TOUCH_SENSITIVITY_PROP, false)) {}
+
 // Methods from ::vendor::lineage::touch::V1_0::IGloveMode follow.
 Return<bool> GloveMode::isEnabled() {
-    return android::base::GetBoolProperty(TOUCH_SENSITIVITY_PROP, false);
+    return mEnabled.load(std::memory_order_relaxed);
 }
 
 Return<bool> GloveMode::setEnabled(bool enabled) {
-    return android::base::SetProperty(TOUCH_SENSITIVITY_PROP, enabled ? "1" : "0");
+    if (!android::base::SetProperty(TOUCH_SENSITIVITY_PROP, enabled ? "1" : "0")) {
+        return false;
+    }
+    mEnabled.store(enabled, std::memory_order_relaxed);
+    return true;
 }
 
 }  // namespace vendor::lineage::touch::pixel
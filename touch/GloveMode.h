@@ -20,6 +20,8 @@
 #include <hidl/MQDescriptor.h>
 #include <hidl/Status.h>
 
+#include <atomic>
+
 namespace vendor::lineage::touch::pixel {
 
 using ::android::hardware::hidl_array;
@@ -31,9 +33,16 @@ using ::android::hardware::Void;
 using ::android::sp;
 
 struct GloveMode : public V1_0::IGloveMode {
+    GloveMode();
+
     // Methods from ::vendor::lineage::touch::V1_0::IGloveMode follow.
     Return<bool> isEnabled() override;
     Return<bool> setEnabled(bool enabled) override;
+
+  private:
+    // This HAL is the only writer of the sensitivity property, so the state
+    // is mirrored here and queries skip the property lookup.
+    std::atomic<bool> mEnabled;
 };
 
 }  // namespace vendor::lineage::touch::pixel
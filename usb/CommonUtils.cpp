@@ -20,12 +20,15 @@
 
 #include <android-base/file.h>
 #include <android-base/properties.h>
+#include <fcntl.h>
+#include <string.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
 #include <sys/inotify.h>
 #include <utils/Log.h>
 
 #include <chrono>
+#include <map>
 #include <memory>
 #include <mutex>
 
@@ -38,7 +41,6 @@ namespace usb {
 // Android metrics requires number of elements in any repeated field cannot exceed 127 elements
 constexpr int kWestworldRepeatedFieldSizeLimit = 127;
 
-using ::android::base::GetProperty;
 using ::android::base::SetProperty;
 using ::android::base::WriteStringToFile;
 using ::std::chrono::microseconds;
@@ -82,12 +84,23 @@ int addEpollFd(const base::unique_fd &epfd, const base::unique_fd &fd) {
 }
 
 std::string getVendorFunctions() {
-    if (GetProperty(kBuildType, "") == "user")
+    // Property handles are resolved once; afterwards each Get() is an atomic
+    // serial compare that only re-reads the value when the property actually
+    // changed, so steady-state reconfigurations skip the property-service
+    // lookups entirely. CachedProperty is not thread safe, hence the lock.
+    static std::mutex sPropLock;
+    static ::android::base::CachedProperty sBuildType(kBuildType);
+    static ::android::base::CachedProperty sBootMode(PERSISTENT_BOOT_MODE);
+    static ::android::base::CachedProperty sPersistentVendorConfig(kPersistentVendorConfig);
+    static ::android::base::CachedProperty sVendorConfig(kVendorConfig);
+
+    std::lock_guard<std::mutex> lock(sPropLock);
+    if (strcmp(sBuildType.Get(), "user") == 0)
         return "user";
 
-    std::string bootMode = GetProperty(PERSISTENT_BOOT_MODE, "");
-    std::string persistVendorFunctions = GetProperty(kPersistentVendorConfig, "");
-    std::string vendorFunctions = GetProperty(kVendorConfig, "");
+    std::string bootMode = sBootMode.Get();
+    std::string persistVendorFunctions = sPersistentVendorConfig.Get();
+    std::string vendorFunctions = sVendorConfig.Get();
     std::string ret = "";
 
     if (vendorFunctions != "") {
@@ -105,14 +118,87 @@ std::string getVendorFunctions() {
     return ret;
 }
 
+// Function-config fingerprint: the GadgetFunction bitmask the current
+// configfs links were built for. sAppliedFunctionsValid goes false whenever
+// configfs might not match the record (partial apply, failed unlink).
+static std::mutex sAppliedFunctionsLock;
+static uint64_t sAppliedFunctions = 0;
+static bool sAppliedFunctionsValid = false;
+
+bool isFunctionConfigApplied(uint64_t functions) {
+    std::lock_guard<std::mutex> lock(sAppliedFunctionsLock);
+    return sAppliedFunctionsValid && sAppliedFunctions == functions;
+}
+
+void markFunctionConfigApplied(uint64_t functions) {
+    std::lock_guard<std::mutex> lock(sAppliedFunctionsLock);
+    // Applies accumulate on top of the reset state: a reset records the
+    // empty set, then each helper ORs in the functions it linked.
+    sAppliedFunctions |= functions;
+}
+
+void clearFunctionConfigApplied() {
+    std::lock_guard<std::mutex> lock(sAppliedFunctionsLock);
+    sAppliedFunctionsValid = false;
+}
+
+static void resetFunctionConfigApplied() {
+    std::lock_guard<std::mutex> lock(sAppliedFunctionsLock);
+    sAppliedFunctions = 0;
+    sAppliedFunctionsValid = true;
+}
+
+// Gadget attribute write path: attributes are opened relative to a single
+// cached directory fd, and values matching the last successful write are
+// skipped. Each configfs attribute is its own file, so writes cannot be
+// vectored across attributes; the savings come from resolving GADGET_PATH
+// once instead of walking the full path per attribute, and from eliding
+// rewrites of values the gadget already has. UDC is deliberately not routed
+// through here - writing it has side effects even when the value is
+// unchanged.
+static std::mutex sGadgetAttrLock;
+static std::map<std::string, std::string> sGadgetAttrCache;
+
+bool writeGadgetAttr(const char *attr, const char *value) {
+    std::lock_guard<std::mutex> lock(sGadgetAttrLock);
+
+    auto itr = sGadgetAttrCache.find(attr);
+    if (itr != sGadgetAttrCache.end() && itr->second == value)
+        return true;
+
+    static base::unique_fd sGadgetDirFd;
+    if (sGadgetDirFd.get() < 0)
+        sGadgetDirFd.reset(TEMP_FAILURE_RETRY(open(GADGET_PATH, O_RDONLY | O_DIRECTORY | O_CLOEXEC)));
+
+    bool written;
+    if (sGadgetDirFd.get() >= 0) {
+        base::unique_fd fd(
+                TEMP_FAILURE_RETRY(openat(sGadgetDirFd.get(), attr, O_WRONLY | O_CLOEXEC)));
+        written = fd.get() >= 0 && ::android::base::WriteStringToFd(value, fd);
+    } else {
+        // Gadget directory is not up yet; fall back to a full-path write
+        written = WriteStringToFile(value, std::string(GADGET_PATH) + attr);
+    }
+
+    if (!written) {
+        ALOGE("Unable to write gadget attribute %s errno:%d", attr, errno);
+        sGadgetAttrCache.erase(attr);
+        return false;
+    }
+    sGadgetAttrCache[attr] = value;
+    return true;
+}
+
 int unlinkFunctions(const char *path) {
     DIR *config = opendir(path);
     struct dirent *function;
     char filepath[kMaxFilePathLength];
     int ret = 0;
 
-    if (config == NULL)
+    if (config == NULL) {
+        clearFunctionConfigApplied();
         return -1;
+    }
 
     // d_type does not seems to be supported in /config
     // so filtering by name.
@@ -129,27 +215,46 @@ int unlinkFunctions(const char *path) {
     }
 
     closedir(config);
+    if (ret) {
+        clearFunctionConfigApplied();
+    } else {
+        resetFunctionConfigApplied();
+    }
     return ret;
 }
 
 int linkFunction(const char *function, int index) {
     char functionPath[kMaxFilePathLength];
     char link[kMaxFilePathLength];
+    char existing[kMaxFilePathLength];
 
     snprintf(functionPath, kMaxFilePathLength, "%s%s", FUNCTIONS_PATH, function);
     snprintf(link, kMaxFilePathLength, "%s%d", FUNCTION_PATH, index);
+
+    // Toggle only the links that changed: a link at this index already
+    // pointing at the requested function is kept, one pointing elsewhere is
+    // repointed.
+    ssize_t len = readlink(link, existing, sizeof(existing) - 1);
+    if (len > 0) {
+        existing[len] = '\0';
+        if (strcmp(existing, functionPath) == 0)
+            return 0;
+        remove(link);
+    }
+
     if (symlink(functionPath, link)) {
         ALOGE("Cannot create symlink %s -> %s errno:%d", link, functionPath, errno);
+        clearFunctionConfigApplied();
         return -1;
     }
     return 0;
 }
 
 bool setVidPidCommon(const char *vid, const char *pid) {
-    if (!WriteStringToFile(vid, VENDOR_ID_PATH))
+    if (!writeGadgetAttr("idVendor", vid))
         return false;
 
-    if (!WriteStringToFile(pid, PRODUCT_ID_PATH))
+    if (!writeGadgetAttr("idProduct", pid))
         return false;
 
     return true;
@@ -161,16 +266,16 @@ bool resetGadgetCommon() {
     if (!WriteStringToFile("none", PULLUP_PATH))
         ALOGI("Gadget cannot be pulled down");
 
-    if (!WriteStringToFile("0", DEVICE_CLASS_PATH))
+    if (!writeGadgetAttr("bDeviceClass", "0"))
         return false;
 
-    if (!WriteStringToFile("0", DEVICE_SUB_CLASS_PATH))
+    if (!writeGadgetAttr("bDeviceSubClass", "0"))
         return false;
 
-    if (!WriteStringToFile("0", DEVICE_PROTOCOL_PATH))
+    if (!writeGadgetAttr("bDeviceProtocol", "0"))
         return false;
 
-    if (!WriteStringToFile("0", DESC_USE_PATH))
+    if (!writeGadgetAttr("os_desc/use", "0"))
         return false;
 
     if (unlinkFunctions(CONFIG_PATH))
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "libpixelusb-fileforwarder"
+
+#include "include/pixelusb/FileForwarder.h"
+
+#include <android-base/unique_fd.h>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+#include <utils/Log.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace android {
+namespace hardware {
+namespace google {
+namespace pixel {
+namespace usb {
+
+using ::android::base::unique_fd;
+
+// Chunk per kernel call; also the pipe size requested for the splice path.
+constexpr size_t kForwardChunk = 1 << 20;
+
+static ssize_t spliceRange(int outFd, int inFd, size_t count) {
+    unique_fd pipeRead, pipeWrite;
+    {
+        int pipeFds[2];
+        if (pipe2(pipeFds, O_CLOEXEC)) {
+            ALOGE("pipe2 failed errno:%d", errno);
+            return -1;
+        }
+        pipeRead.reset(pipeFds[0]);
+        pipeWrite.reset(pipeFds[1]);
+    }
+    // Bigger pipe, fewer kernel round trips; the default 64K is fine too.
+    fcntl(pipeWrite, F_SETPIPE_SZ, kForwardChunk);
+
+    size_t total = 0;
+    while (total < count) {
+        ssize_t inPipe = splice(inFd, NULL, pipeWrite, NULL, std::min(kForwardChunk, count - total),
+                                SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (inPipe == 0)
+            break;
+        if (inPipe < 0) {
+            if (errno == EINTR)
+                continue;
+            return total ? total : -1;
+        }
+        while (inPipe > 0) {
+            ssize_t out = splice(pipeRead, NULL, outFd, NULL, inPipe, SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (out <= 0) {
+                if (out < 0 && errno == EINTR)
+                    continue;
+                ALOGE("splice to outFd failed errno:%d", errno);
+                return -1;
+            }
+            inPipe -= out;
+            total += out;
+        }
+    }
+    return total;
+}
+
+static ssize_t readWriteRange(int outFd, int inFd, size_t count) {
+    std::vector<char> buf(64 * 1024);
+    size_t total = 0;
+
+    while (total < count) {
+        ssize_t numRead =
+                TEMP_FAILURE_RETRY(read(inFd, buf.data(), std::min(buf.size(), count - total)));
+        if (numRead == 0)
+            break;
+        if (numRead < 0)
+            return total ? total : -1;
+        for (ssize_t written = 0; written < numRead;) {
+            ssize_t out = TEMP_FAILURE_RETRY(write(outFd, buf.data() + written, numRead - written));
+            if (out < 0)
+                return -1;
+            written += out;
+            total += out;
+        }
+    }
+    return total;
+}
+
+ssize_t forwardFileRange(int outFd, int inFd, size_t count) {
+    size_t total = 0;
+
+    while (total < count) {
+        ssize_t moved = sendfile(outFd, inFd, NULL, std::min(kForwardChunk, count - total));
+        if (moved == 0)
+            return total;
+        if (moved > 0) {
+            total += moved;
+            continue;
+        }
+        if (errno == EINTR)
+            continue;
+        // sendfile wants an mmap-able source and, pre-5.12, a socket-like
+        // sink; functionfs endpoints and pipes land here. Splice moves the
+        // remainder through a pipe without lifting pages into userspace.
+        if (total == 0 && (errno == EINVAL || errno == ENOSYS)) {
+            ssize_t spliced = spliceRange(outFd, inFd, count);
+            if (spliced >= 0)
+                return spliced;
+            if (errno == EINVAL || errno == ENOSYS)
+                return readWriteRange(outFd, inFd, count);
+            return -1;
+        }
+        ALOGE("sendfile failed errno:%d", errno);
+        return total ? total : -1;
+    }
+    return total;
+}
+
+ssize_t forwardFile(int outFd, int inFd) {
+    size_t total = 0;
+
+    while (true) {
+        ssize_t moved = forwardFileRange(outFd, inFd, kForwardChunk);
+        if (moved < 0)
+            return total ? total : -1;
+        total += moved;
+        if (moved < static_cast<ssize_t>(kForwardChunk))
+            return total;
+    }
+}
+
+}  // namespace usb
+}  // namespace pixel
+}  // namespace google
+}  // namespace hardware
+}  // namespace android
@@ -19,8 +19,14 @@
 #include "include/pixelusb/I2cHelper.h"
 
 #include <dirent.h>
+#include <fcntl.h>
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+#include <sys/ioctl.h>
 #include <utils/Log.h>
 
+#include <algorithm>
+
 namespace android {
 namespace hardware {
 namespace google {
@@ -106,6 +112,86 @@ string getI2cClientPath(const string hsi2cPath, const string devName, const stri
     return string("");
 }
 
+I2cBatchReader::I2cBatchReader(const string hsi2cPath, uint16_t clientAddr)
+    : mHsi2cPath(hsi2cPath), mClientAddr(clientAddr) {}
+
+bool I2cBatchReader::ensureOpen() {
+    if (mFd >= 0) {
+        return true;
+    }
+
+    string strBusNumber = getI2cBusNumberString(mHsi2cPath);
+    if (strBusNumber.empty()) {
+        return false;
+    }
+
+    string devPath = "/dev/i2c-" + strBusNumber;
+    mFd.reset(open(devPath.c_str(), O_RDWR | O_CLOEXEC));
+    if (mFd < 0) {
+        ALOGE("Failed to open %s errno:%d", devPath.c_str(), errno);
+        return false;
+    }
+    return true;
+}
+
+bool I2cBatchReader::readRegisters(const std::vector<uint8_t> &regs, std::vector<uint8_t> *values) {
+    if (regs.empty() || !ensureOpen()) {
+        return false;
+    }
+
+    std::vector<uint8_t> result(regs.size());
+    // Each register costs a write of its address plus a repeated-start read,
+    // and the kernel caps a combined transaction at I2C_RDWR_IOCTL_MAX_MSGS
+    // messages, so batch the poll set in chunks of that many pairs.
+    constexpr size_t kRegsPerIoctl = I2C_RDWR_IOCTL_MAX_MSGS / 2;
+    std::vector<uint8_t> addrs(regs);
+
+    for (size_t base = 0; base < regs.size(); base += kRegsPerIoctl) {
+        size_t count = std::min(kRegsPerIoctl, regs.size() - base);
+        struct i2c_msg msgs[I2C_RDWR_IOCTL_MAX_MSGS];
+
+        for (size_t i = 0; i < count; i++) {
+            msgs[i * 2] = {
+                    .addr = mClientAddr,
+                    .flags = 0,
+                    .len = 1,
+                    .buf = &addrs[base + i],
+            };
+            msgs[i * 2 + 1] = {
+                    .addr = mClientAddr,
+                    .flags = I2C_M_RD,
+                    .len = 1,
+                    .buf = &result[base + i],
+            };
+        }
+
+        struct i2c_rdwr_ioctl_data xfer = {
+                .msgs = msgs,
+                .nmsgs = static_cast<uint32_t>(count * 2),
+        };
+        if (ioctl(mFd, I2C_RDWR, &xfer) < 0) {
+            ALOGE("I2C_RDWR failed on client 0x%x errno:%d", mClientAddr, errno);
+            // Drop the fd so the next poll reopens the bus; the client may
+            // have been rebound or the adapter renumbered.
+            mFd.reset();
+            return false;
+        }
+    }
+
+    *values = std::move(result);
+    return true;
+}
+
+bool I2cBatchReader::readRegister(uint8_t reg, uint8_t *value) {
+    std::vector<uint8_t> values;
+
+    if (!readRegisters({reg}, &values)) {
+        return false;
+    }
+    *value = values[0];
+    return true;
+}
+
 }  // namespace usb
 }  // namespace pixel
 }  // namespace google
@@ -19,15 +19,16 @@
 #include "include/pixelusb/MonitorFfs.h"
 
 #include <android-base/file.h>
-#include <sys/epoll.h>
-#include <sys/eventfd.h>
 #include <sys/inotify.h>
+#include <sys/timerfd.h>
 #include <utils/Log.h>
 
 #include <chrono>
 #include <memory>
 #include <mutex>
 
+#include "include/pixelusb/UsbReactor.h"
+
 namespace android {
 namespace hardware {
 namespace google {
@@ -48,38 +49,32 @@ MonitorFfs::MonitorFfs(const char *const gadget)
       mCv(),
       mLockFd(),
       mCurrentUsbFunctionsApplied(false),
-      mMonitor(),
       mCallback(NULL),
       mPayload(NULL),
       mGadgetName(gadget),
-      mMonitorRunning(false) {
-    unique_fd eventFd(eventfd(0, 0));
-    if (eventFd == -1) {
-        ALOGE("mEventFd failed to create %d", errno);
-        abort();
-    }
-
-    unique_fd epollFd(epoll_create(2));
-    if (epollFd == -1) {
-        ALOGE("mEpollFd failed to create %d", errno);
-        abort();
-    }
-
+      mMonitorRunning(false),
+      mWriteUdc(true) {
     unique_fd inotifyFd(inotify_init());
     if (inotifyFd < 0) {
         ALOGE("inotify init failed");
         abort();
     }
 
-    if (addEpollFd(epollFd, inotifyFd) == -1)
+    unique_fd pullUpTimerFd(timerfd_create(CLOCK_MONOTONIC, 0));
+    if (pullUpTimerFd == -1) {
+        ALOGE("mPullUpTimerFd failed to create %d", errno);
         abort();
+    }
 
-    if (addEpollFd(epollFd, eventFd) == -1)
+    unique_fd deadlineTimerFd(timerfd_create(CLOCK_MONOTONIC, 0));
+    if (deadlineTimerFd == -1) {
+        ALOGE("mDeadlineTimerFd failed to create %d", errno);
         abort();
+    }
 
-    mEpollFd = std::move(epollFd);
     mInotifyFd = std::move(inotifyFd);
-    mEventFd = std::move(eventFd);
+    mPullUpTimerFd = std::move(pullUpTimerFd);
+    mDeadlineTimerFd = std::move(deadlineTimerFd);
     gadgetPullup = false;
 }
 
@@ -127,121 +122,129 @@ static void displayInotifyEvent(struct inotify_event *i) {
         ALOGE("        name = %s\n", i->name);
 }
 
-void *MonitorFfs::startMonitorFd(void *param) {
-    MonitorFfs *monitorFfs = (MonitorFfs *)param;
-    char buf[kBufferSize];
-    bool writeUdc = true, stopMonitor = false;
-    struct epoll_event events[kEpollEvents];
-    steady_clock::time_point disconnect;
-
-    bool descriptorWritten = true;
-    for (int i = 0; i < static_cast<int>(monitorFfs->mEndpointList.size()); i++) {
-        if (access(monitorFfs->mEndpointList.at(i).c_str(), R_OK)) {
-            descriptorWritten = false;
-            break;
-        }
+bool MonitorFfs::pullUpGadget() {
+    if (WriteStringToFile(mGadgetName, PULLUP_PATH)) {
+        armTimer(mDeadlineTimerFd, 0);
+        std::lock_guard<std::mutex> lock(mLock);
+        mCurrentUsbFunctionsApplied = true;
+        mCallback(mCurrentUsbFunctionsApplied, mPayload);
+        ALOGI("GADGET pulled up");
+        mWriteUdc = false;
+        gadgetPullup = true;
+        // notify the main thread to signal userspace.
+        mCv.notify_all();
+        return true;
     }
+    return false;
+}
 
-    // notify here if the endpoints are already present.
-    if (descriptorWritten) {
-        usleep(kPullUpDelay);
-        if (WriteStringToFile(monitorFfs->mGadgetName, PULLUP_PATH)) {
-            std::lock_guard<std::mutex> lock(monitorFfs->mLock);
-            monitorFfs->mCurrentUsbFunctionsApplied = true;
-            monitorFfs->mCallback(monitorFfs->mCurrentUsbFunctionsApplied, monitorFfs->mPayload);
-            gadgetPullup = true;
-            writeUdc = false;
-            ALOGI("GADGET pulled up");
-            monitorFfs->mCv.notify_all();
+bool MonitorFfs::allEndpointsPresent() {
+    for (int i = 0; i < static_cast<int>(mEndpointList.size()); i++) {
+        if (access(mEndpointList.at(i).c_str(), R_OK)) {
+            if (kDebug) {
+                ALOGI("%s absent", mEndpointList.at(i).c_str());
+            }
+            return false;
         }
     }
+    return true;
+}
+
+void MonitorFfs::armTimer(const unique_fd &timerFd, int64_t delayUs) {
+    struct itimerspec delay = itimerspec();
+    delay.it_value.tv_sec = delayUs / 1000000;
+    delay.it_value.tv_nsec = (delayUs % 1000000) * 1000;
+    if (timerfd_settime(timerFd, 0, &delay, NULL) < 0)
+        ALOGE("timerfd_settime failed. err:%d", errno);
+}
+
+void MonitorFfs::armPullUpTimer(int64_t delayUs) {
+    armTimer(mPullUpTimerFd, delayUs);
+}
+
+void MonitorFfs::handlePullUpTimer() {
+    uint64_t fired;
+
+    read(mPullUpTimerFd, &fired, sizeof(fired));
+    if (!mWriteUdc)
+        return;
+    // The endpoints may have flapped since the timer was armed; re-verify
+    // and make sure the full debounce window has elapsed since the last
+    // disconnect before writing the UDC.
+    if (!allEndpointsPresent())
+        return;
+    int64_t elapsed =
+            std::chrono::duration_cast<microseconds>(steady_clock::now() - mDisconnect).count();
+    if (elapsed < kPullUpDelay) {
+        armPullUpTimer(kPullUpDelay - elapsed);
+        return;
+    }
+    pullUpGadget();
+}
+
+void MonitorFfs::handleDeadlineTimer() {
+    uint64_t fired;
 
-    while (!stopMonitor) {
-        int nrEvents = epoll_wait(monitorFfs->mEpollFd, events, kEpollEvents, -1);
+    read(mDeadlineTimerFd, &fired, sizeof(fired));
+    std::lock_guard<std::mutex> lock(mLock);
+    if (!gadgetPullup && mCallback) {
+        ALOGI("Pullup deadline passed, signalling failure");
+        mCallback(false, mPayload);
+    }
+}
 
-        if (nrEvents <= 0) {
-            ALOGE("epoll wait did not return descriptor number");
-            continue;
+void MonitorFfs::handleInotifyEvent() {
+    char buf[kBufferSize];
+
+    // Process all of the events in buffer returned by read().
+    int numRead = read(mInotifyFd, buf, kBufferSize);
+    for (char *p = buf; p < buf + numRead;) {
+        struct inotify_event *event = (struct inotify_event *)p;
+        if (kDebug) {
+            displayInotifyEvent(event);
         }
 
-        for (int i = 0; i < nrEvents; i++) {
-            ALOGV("event=%u on fd=%d\n", events[i].events, events[i].data.fd);
-
-            if (events[i].data.fd == monitorFfs->mInotifyFd) {
-                // Process all of the events in buffer returned by read().
-                int numRead = read(monitorFfs->mInotifyFd, buf, kBufferSize);
-                for (char *p = buf; p < buf + numRead;) {
-                    struct inotify_event *event = (struct inotify_event *)p;
-                    if (kDebug) {
-                        displayInotifyEvent(event);
-                    }
-
-                    p += sizeof(struct inotify_event) + event->len;
-
-                    bool descriptorPresent = true;
-                    for (int j = 0; j < static_cast<int>(monitorFfs->mEndpointList.size()); j++) {
-                        if (access(monitorFfs->mEndpointList.at(j).c_str(), R_OK)) {
-                            if (kDebug) {
-                                ALOGI("%s absent", monitorFfs->mEndpointList.at(j).c_str());
-                            }
-                            descriptorPresent = false;
-                            break;
-                        }
-                    }
-
-                    if (!descriptorPresent && !writeUdc) {
-                        if (kDebug) {
-                            ALOGI("endpoints not up");
-                        }
-                        writeUdc = true;
-                        disconnect = std::chrono::steady_clock::now();
-                    } else if (descriptorPresent && writeUdc) {
-                        steady_clock::time_point temp = steady_clock::now();
-
-                        if (std::chrono::duration_cast<microseconds>(temp - disconnect).count() <
-                            kPullUpDelay)
-                            usleep(kPullUpDelay);
-
-                        if (WriteStringToFile(monitorFfs->mGadgetName, PULLUP_PATH)) {
-                            std::lock_guard<std::mutex> lock(monitorFfs->mLock);
-                            monitorFfs->mCurrentUsbFunctionsApplied = true;
-                            monitorFfs->mCallback(monitorFfs->mCurrentUsbFunctionsApplied,
-                                                  monitorFfs->mPayload);
-                            ALOGI("GADGET pulled up");
-                            writeUdc = false;
-                            gadgetPullup = true;
-                            // notify the main thread to signal userspace.
-                            monitorFfs->mCv.notify_all();
-                        }
-                    }
-                }
+        p += sizeof(struct inotify_event) + event->len;
+
+        bool descriptorPresent = allEndpointsPresent();
+
+        if (!descriptorPresent && !mWriteUdc) {
+            if (kDebug) {
+                ALOGI("endpoints not up");
+            }
+            mWriteUdc = true;
+            mDisconnect = std::chrono::steady_clock::now();
+        } else if (descriptorPresent && mWriteUdc) {
+            int64_t elapsed =
+                    std::chrono::duration_cast<microseconds>(steady_clock::now() - mDisconnect)
+                            .count();
+
+            if (elapsed < kPullUpDelay) {
+                // Defer the UDC write for the remainder of the debounce
+                // window. The old code slept a full kPullUpDelay from this
+                // point, so endpoints landing in quick succession during a
+                // function switch each paid the whole delay again; the
+                // pullup timer re-verifies the endpoints when it fires.
+                armPullUpTimer(kPullUpDelay - elapsed);
             } else {
-                uint64_t flag;
-                read(monitorFfs->mEventFd, &flag, sizeof(flag));
-                if (flag == 100) {
-                    stopMonitor = true;
-                    break;
-                }
+                pullUpGadget();
             }
         }
     }
-    return NULL;
 }
 
 void MonitorFfs::reset() {
     std::lock_guard<std::mutex> lock(mLockFd);
-    uint64_t flag = 100;
-    unsigned long ret;
 
     if (mMonitorRunning) {
-        // Stop the monitor thread by writing into signal fd.
-        ret = TEMP_FAILURE_RETRY(write(mEventFd, &flag, sizeof(flag)));
-        if (ret < 0)
-            ALOGE("Error writing eventfd errno=%d", errno);
-
-        ALOGI("mMonitor signalled to exit");
-        mMonitor->join();
-        ALOGI("mMonitor destroyed");
+        // Unregister from the reactor; removeFd blocks until an in-flight
+        // callback has returned, so no pullup can race the teardown below.
+        UsbReactor::getInstance().removeFd(mInotifyFd);
+        UsbReactor::getInstance().removeFd(mPullUpTimerFd);
+        UsbReactor::getInstance().removeFd(mDeadlineTimerFd);
+        armPullUpTimer(0);
+        armTimer(mDeadlineTimerFd, 0);
+        ALOGI("mMonitor unregistered");
         mMonitorRunning = false;
     }
 
@@ -250,13 +253,28 @@ void MonitorFfs::reset() {
 
     mEndpointList.clear();
     gadgetPullup = false;
+    mWriteUdc = true;
     mCallback = NULL;
     mPayload = NULL;
 }
 
 bool MonitorFfs::startMonitor() {
-    mMonitor = std::make_unique<std::thread>(this->startMonitorFd, this);
+    mWriteUdc = true;
+    mDisconnect = steady_clock::now();
+    if (!UsbReactor::getInstance().addFd(mInotifyFd, [this]() { handleInotifyEvent(); }) ||
+        !UsbReactor::getInstance().addFd(mPullUpTimerFd, [this]() { handlePullUpTimer(); }) ||
+        !UsbReactor::getInstance().addFd(mDeadlineTimerFd, [this]() { handleDeadlineTimer(); })) {
+        return false;
+    }
     mMonitorRunning = true;
+
+    // Schedule the pullup if the endpoints are already present. The old
+    // monitor thread slept kPullUpDelay before the first UDC write; arm the
+    // timer for the same delay instead of blocking the caller. Endpoints
+    // that come up later re-arm through the inotify path.
+    if (allEndpointsPresent()) {
+        armPullUpTimer(kPullUpDelay);
+    }
     return true;
 }
 
@@ -265,12 +283,16 @@ bool MonitorFfs::isMonitorRunning() {
 }
 
 bool MonitorFfs::waitForPullUp(int timeout_ms) {
+    return waitForPullUp(steady_clock::now() + timeout_ms * 1ms);
+}
+
+bool MonitorFfs::waitForPullUp(std::chrono::steady_clock::time_point deadline) {
     std::unique_lock<std::mutex> lk(mLock);
 
     if (gadgetPullup)
         return true;
 
-    if (mCv.wait_for(lk, timeout_ms * 1ms, [] { return gadgetPullup; })) {
+    if (mCv.wait_until(lk, deadline, [] { return gadgetPullup; })) {
         ALOGI("monitorFfs signalled true");
         return true;
     } else {
@@ -281,6 +303,23 @@ bool MonitorFfs::waitForPullUp(int timeout_ms) {
     }
 }
 
+bool MonitorFfs::waitForPullUpAsync(int timeout_ms) {
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        if (!mMonitorRunning || !mCallback)
+            return false;
+        if (gadgetPullup) {
+            mCallback(true, mPayload);
+            return true;
+        }
+    }
+    // The pullup path reports success through the functions-applied callback
+    // and disarms this timer; if the deadline fires first the reactor
+    // reports failure. Either way no thread blocks here.
+    armTimer(mDeadlineTimerFd, static_cast<int64_t>(timeout_ms) * 1000);
+    return true;
+}
+
 bool MonitorFfs::addInotifyFd(std::string fd) {
     std::lock_guard<std::mutex> lock(mLockFd);
     int wfd;
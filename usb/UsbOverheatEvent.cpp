@@ -20,9 +20,13 @@
 
 #include <aidl/android/hardware/thermal/IThermal.h>
 #include <android/binder_manager.h>
+#include <inttypes.h>
+#include <pixelscheduler/WakeupScheduler.h>
 #include <thermalutils/ThermalHidlWrapper.h>
 #include <time.h>
 
+#include "include/pixelusb/UsbReactor.h"
+
 namespace android {
 namespace hardware {
 namespace google {
@@ -32,74 +36,60 @@ namespace usb {
 // Start monitoring the temperature
 static volatile bool monitorTemperature;
 
-constexpr int kEpollEvents = 10;
 constexpr char kOverheatLock[] = "overheat";
 constexpr char kWakeLockPath[] = "/sys/power/wake_lock";
 constexpr char kWakeUnlockPath[] = "/sys/power/wake_unlock";
 
-int addEpollFdWakeUp(const unique_fd &epfd, const unique_fd &fd) {
-    struct epoll_event event {};
-    int ret;
-
-    event.data.fd = fd;
-    event.events = EPOLLIN | EPOLLWAKEUP;
-
-    ret = epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event);
-    if (ret)
-        ALOGE("epoll_ctl error %d", errno);
-
-    return ret;
-}
-
 UsbOverheatEvent::UsbOverheatEvent(const ZoneInfo &monitored_zone,
                                    const std::vector<ZoneInfo> &queried_zones,
-                                   const int &monitor_interval_sec)
+                                   const int &monitor_interval_sec, const int &monitor_slack_sec)
     : monitored_zone_(monitored_zone),
       queried_zones_(queried_zones),
       monitor_interval_sec_(monitor_interval_sec),
-      monitor_() {
-    int fd = timerfd_create(CLOCK_BOOTTIME_ALARM, 0);
-    if (fd < 0) {
-        ALOGE("timerfd_create failed: %d", errno);
-    }
-
+      monitor_slack_sec_(monitor_slack_sec >= 0 ? monitor_slack_sec : monitor_interval_sec / 20) {
     unique_fd timerFd(timerfd_create(CLOCK_BOOTTIME_ALARM, 0));
     if (timerFd == -1) {
         ALOGE("timerFd failed to create %d", errno);
         abort();
     }
 
-    unique_fd epollFd(epoll_create(2));
-    if (epollFd == -1) {
-        ALOGE("epoll_fd_ failed to create %d", errno);
-        abort();
-    }
-
     unique_fd eventFd(eventfd(0, 0));
     if (eventFd == -1) {
         ALOGE("event_fd_ failed to create %d", errno);
         abort();
     }
 
-    if (addEpollFdWakeUp(epollFd, timerFd) == -1) {
+    timer_fd_ = std::move(timerFd);
+    event_fd_ = std::move(eventFd);
+
+    // Publish every sample into the shared stream; failure only disables
+    // the shared consumers, recording itself still works.
+    vector<string> zoneNames;
+    for (const ZoneInfo &zone : queried_zones_)
+        zoneNames.push_back(zone.name_);
+    if (!temp_stream_.initialize(zoneNames))
+        ALOGE("usb temp stream unavailable");
+
+    // Both fds are serviced by the shared reactor instead of a dedicated
+    // epoll thread. EPOLLWAKEUP keeps the wakeup source held while events
+    // are pending, as before.
+    if (!UsbReactor::getInstance().addFd(
+                timer_fd_, [this]() { handleTimerFired(); }, true)) {
         ALOGE("Adding timerFd failed");
         abort();
     }
-
-    if (addEpollFdWakeUp(epollFd, eventFd) == -1) {
+    if (!UsbReactor::getInstance().addFd(
+                event_fd_, [this]() { handleWakeup(); }, true)) {
         ALOGE("Adding eventFd failed");
         abort();
     }
 
-    epoll_fd_ = std::move(epollFd);
-    timer_fd_ = std::move(timerFd);
-    event_fd_ = std::move(eventFd);
-
-    monitor_ = unique_ptr<thread>(new thread(this->monitorThread, this));
     registerListener();
 }
 
 UsbOverheatEvent::~UsbOverheatEvent() {
+    UsbReactor::getInstance().removeFd(timer_fd_);
+    UsbReactor::getInstance().removeFd(event_fd_);
     unregisterThermalCallback();
 }
 
@@ -130,63 +120,113 @@ static void wakeLockRelease() {
     }
 }
 
-void *UsbOverheatEvent::monitorThread(void *param) {
-    auto *overheatEvent = reinterpret_cast<UsbOverheatEvent *>(param);
-    struct epoll_event events[kEpollEvents];
+void UsbOverheatEvent::handleTimerFired() {
+    uint64_t fired;
+
+    ALOGI("Wake up caused by timer fd");
+    int numRead = read(timer_fd_, &fired, sizeof(fired));
+    if (numRead != sizeof(fired)) {
+        ALOGV("numRead incorrect");
+    }
+    if (fired != 1) {
+        ALOGV("Fired not set to 1");
+    }
+    sampleAndRearmTimer();
+}
+
+void UsbOverheatEvent::handleWakeup() {
+    uint64_t fired;
+
+    ALOGI("Wake up caused by event fd");
+    read(event_fd_, &fired, sizeof(fired));
+    sampleAndRearmTimer();
+}
+
+void UsbOverheatEvent::sampleAndRearmTimer() {
     struct itimerspec delay = itimerspec();
+    float temperature = 0;
+    string status;
 
-    while (true) {
-        uint64_t fired;
-        float temperature = 0;
-        string status;
-
-        for (vector<ZoneInfo>::size_type i = 0; i < overheatEvent->queried_zones_.size(); i++) {
-            if (overheatEvent->getCurrentTemperature(overheatEvent->queried_zones_[i].name_,
-                                                     &temperature)) {
-                if (i == 0)
-                    overheatEvent->max_overheat_temp_ =
-                            max(temperature, overheatEvent->max_overheat_temp_);
-                status.append(overheatEvent->queried_zones_[i].name_);
-                status.append(":");
-                status.append(std::to_string(temperature));
-                status.append(" ");
+    // Hold the wakelock for the sampling itself; pending events keep the
+    // EPOLLWAKEUP source held until the reactor dispatches us.
+    wakeLockAcquire();
+    for (vector<ZoneInfo>::size_type i = 0; i < queried_zones_.size(); i++) {
+        if (getCurrentTemperature(queried_zones_[i].name_, &temperature)) {
+            if (i == 0) {
+                max_overheat_temp_ = max(temperature, max_overheat_temp_);
+                if (monitorTemperature)
+                    recordSample(temperature);
             }
+            temp_stream_.publish(queried_zones_[i].name_, temperature);
+            status.append(queried_zones_[i].name_);
+            status.append(":");
+            status.append(std::to_string(temperature));
+            status.append(" ");
         }
-        ALOGW("%s", status.c_str());
+    }
+    ALOGW("%s", status.c_str());
+
+    // Arm the next sample as an absolute deadline on the shared boottime
+    // wakeup grid instead of a free-running relative interval, so the wake
+    // lands in the same window as the other daemons polling on the same
+    // period. A grid point within monitor_slack_sec_ of the sample just taken
+    // is skipped: an eventfd kick or late dispatch already covered it, and
+    // re-firing moments later would waste the wakeup the alignment saved.
+    int flags = 0;
+    if (monitorTemperature) {
+        delay.it_value.tv_sec = WakeupScheduler::nextAlignedDeadline(
+                monitor_interval_sec_, WakeupScheduler::bootNow() + monitor_slack_sec_);
+        flags = TFD_TIMER_ABSTIME;
+    }
+    int ret = timerfd_settime(timer_fd_, flags, &delay, NULL);
+    if (ret < 0) {
+        ALOGE("timerfd_settime failed. err:%d tv_sec:%ld", errno, delay.it_value.tv_sec);
+    }
+    wakeLockRelease();
+}
 
-        delay.it_value.tv_sec = monitorTemperature ? overheatEvent->monitor_interval_sec_ : 0;
-        int ret = timerfd_settime(overheatEvent->timer_fd_, 0, &delay, NULL);
-        if (ret < 0) {
-            ALOGE("timerfd_settime failed. err:%d tv_sec:%ld", errno, delay.it_value.tv_sec);
-            continue;
-        }
+void UsbOverheatEvent::recordSample(float temp) {
+    struct timespec ts;
 
-        wakeLockRelease();
-        int nrEvents = epoll_wait(overheatEvent->epoll_fd_, events, kEpollEvents, -1);
-        wakeLockAcquire();
-        if (nrEvents <= 0) {
-            ALOGE("nrEvents negative skipping");
-            continue;
-        }
+    clock_gettime(CLOCK_BOOTTIME, &ts);
 
-        for (int i = 0; i < nrEvents; i++) {
-            ALOGV("event=%u on fd=%d\n", events[i].events, events[i].data.fd);
-
-            if (events[i].data.fd == overheatEvent->timer_fd_) {
-                ALOGI("Wake up caused by timer fd");
-                int numRead = read(overheatEvent->timer_fd_, &fired, sizeof(fired));
-                if (numRead != sizeof(fired)) {
-                    ALOGV("numRead incorrect");
-                }
-                if (fired != 1) {
-                    ALOGV("Fired not set to 1");
-                }
-            } else {
-                ALOGI("Wake up caused by event fd");
-                read(overheatEvent->event_fd_, &fired, sizeof(fired));
-            }
-        }
+    lock_guard<mutex> lock(sample_lock_);
+    if (polls_until_keep_ > 0) {
+        polls_until_keep_--;
+        return;
+    }
+
+    if (sample_count_ == kSampleRingDepth) {
+        // Full: promote every other kept sample to the front half and double
+        // the keep stride. The curve spans the whole event at half the
+        // resolution; no memory moves beyond the in-place compaction.
+        for (size_t i = 1; i < kSampleRingDepth / 2; i++)
+            sample_ring_[i] = sample_ring_[i * 2];
+        sample_count_ = kSampleRingDepth / 2;
+        sample_stride_ *= 2;
     }
+
+    sample_ring_[sample_count_].timestampMs =
+            static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+    sample_ring_[sample_count_].temp = temp;
+    sample_count_++;
+    polls_until_keep_ = sample_stride_ - 1;
+}
+
+void UsbOverheatEvent::resetSampleHistory() {
+    lock_guard<mutex> lock(sample_lock_);
+    sample_count_ = 0;
+    sample_stride_ = 1;
+    polls_until_keep_ = 0;
+}
+
+void UsbOverheatEvent::dumpOverheatHistory(int fd) {
+    lock_guard<mutex> lock(sample_lock_);
+    dprintf(fd, "USB overheat temperature history: %zu samples, every %u%s poll of %d sec\n",
+            sample_count_, sample_stride_, sample_stride_ == 1 ? "st" : "th",
+            monitor_interval_sec_);
+    for (size_t i = 0; i < sample_count_; i++)
+        dprintf(fd, "%" PRId64 " %.2f\n", sample_ring_[i].timestampMs, sample_ring_[i].temp);
 }
 
 bool UsbOverheatEvent::registerListener() {
@@ -269,6 +309,7 @@ bool UsbOverheatEvent::startRecording() {
         return true;
 
     wakeLockAcquire();
+    resetSampleHistory();
     monitorTemperature = true;
     wakeupMonitor();
     return true;
@@ -316,6 +357,10 @@ float UsbOverheatEvent::getMaxOverheatTemperature() {
     return max_overheat_temp_;
 }
 
+int UsbOverheatEvent::getTempStreamFd() {
+    return temp_stream_.isInitialized() ? temp_stream_.getFd() : -1;
+}
+
 Return<void> UsbOverheatEvent::onRegistration(const hidl_string & /*fully_qualified_name*/,
                                               const hidl_string & /*instance_name*/,
                                               bool /*pre_existing*/) {
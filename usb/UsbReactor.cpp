@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "libpixelusb-UsbReactor"
+
+#include "include/pixelusb/UsbReactor.h"
+
+#include <sys/epoll.h>
+#include <utils/Log.h>
+
+#include "include/pixelusb/CommonUtils.h"
+
+namespace android {
+namespace hardware {
+namespace google {
+namespace pixel {
+namespace usb {
+
+using ::android::base::unique_fd;
+
+UsbReactor &UsbReactor::getInstance() {
+    // Never destroyed: the reactor thread runs for the life of the process,
+    // like the per-object monitor threads it replaces.
+    static UsbReactor *instance = new UsbReactor();
+    return *instance;
+}
+
+UsbReactor::UsbReactor() : mDispatchingFd(-1) {
+    unique_fd epollFd(epoll_create(kEpollEvents));
+    if (epollFd == -1) {
+        ALOGE("mEpollFd failed to create %d", errno);
+        abort();
+    }
+    mEpollFd = std::move(epollFd);
+    mThread = std::thread(&UsbReactor::reactorLoop, this);
+}
+
+bool UsbReactor::addFd(int fd, std::function<void()> callback, bool wakeup) {
+    struct epoll_event event {};
+    event.data.fd = fd;
+    event.events = EPOLLIN | (wakeup ? EPOLLWAKEUP : 0);
+
+    std::lock_guard<std::mutex> lock(mLock);
+    if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &event)) {
+        ALOGE("epoll_ctl add error %d", errno);
+        return false;
+    }
+    mCallbacks[fd] = std::move(callback);
+    return true;
+}
+
+bool UsbReactor::removeFd(int fd) {
+    std::unique_lock<std::mutex> lock(mLock);
+    if (mCallbacks.erase(fd) == 0) {
+        return false;
+    }
+    if (epoll_ctl(mEpollFd, EPOLL_CTL_DEL, fd, NULL)) {
+        ALOGE("epoll_ctl del error %d", errno);
+    }
+    // Make sure the fd's callback is not mid-flight before the caller tears
+    // down the state it captures. A callback removing its own fd must not
+    // wait on itself.
+    if (std::this_thread::get_id() != mThread.get_id()) {
+        mCv.wait(lock, [this, fd] { return mDispatchingFd != fd; });
+    }
+    return true;
+}
+
+void UsbReactor::reactorLoop() {
+    struct epoll_event events[kEpollEvents];
+
+    while (true) {
+        int nrEvents = epoll_wait(mEpollFd, events, kEpollEvents, -1);
+        if (nrEvents <= 0) {
+            ALOGE("epoll wait did not return descriptor number");
+            continue;
+        }
+
+        for (int i = 0; i < nrEvents; i++) {
+            ALOGV("event=%u on fd=%d\n", events[i].events, events[i].data.fd);
+
+            std::function<void()> callback;
+            {
+                std::lock_guard<std::mutex> lock(mLock);
+                auto it = mCallbacks.find(events[i].data.fd);
+                if (it == mCallbacks.end()) {
+                    // Removed after the event was queued
+                    continue;
+                }
+                // Copy so a concurrent removeFd cannot free the function out
+                // from under the call; removal blocks on mDispatchingFd.
+                callback = it->second;
+                mDispatchingFd = events[i].data.fd;
+            }
+            callback();
+            {
+                std::lock_guard<std::mutex> lock(mLock);
+                mDispatchingFd = -1;
+            }
+            mCv.notify_all();
+        }
+    }
+}
+
+}  // namespace usb
+}  // namespace pixel
+}  // namespace google
+}  // namespace hardware
+}  // namespace android
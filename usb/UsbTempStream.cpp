@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "libpixelusb-tempstream"
+
+#include "include/pixelusb/UsbTempStream.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include <utils/Log.h>
+
+namespace android {
+namespace hardware {
+namespace google {
+namespace pixel {
+namespace usb {
+
+static int64_t getBootTimeNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+static size_t streamRegionSize(uint32_t zoneCount, uint32_t ringDepth) {
+    return sizeof(UsbTempStreamHeader) + zoneCount * sizeof(UsbTempStreamZone) +
+           ringDepth * sizeof(UsbTempStreamSample);
+}
+
+static const UsbTempStreamSample *streamSampleAt(const void *region, uint32_t zoneCount,
+                                                 uint32_t idx) {
+    return reinterpret_cast<const UsbTempStreamSample *>(
+                   static_cast<const char *>(region) + sizeof(UsbTempStreamHeader) +
+                   zoneCount * sizeof(UsbTempStreamZone)) +
+           idx;
+}
+
+UsbTempStream::~UsbTempStream() {
+    if (mRegion != nullptr) {
+        munmap(mRegion, mRegionSize);
+    }
+}
+
+UsbTempStreamSample *UsbTempStream::sampleAt(uint32_t idx) {
+    return const_cast<UsbTempStreamSample *>(
+            streamSampleAt(mRegion, mZoneNames.size(), idx));
+}
+
+bool UsbTempStream::initialize(const std::vector<std::string> &zoneNames) {
+    if (mRegion != nullptr) {
+        ALOGE("UsbTempStream already initialized");
+        return false;
+    }
+    if (zoneNames.empty()) {
+        return false;
+    }
+
+    mRegionSize = streamRegionSize(zoneNames.size(), kUsbTempStreamRingDepth);
+    mFd.reset(memfd_create("usb_temp_stream", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+    if (!mFd.ok()) {
+        ALOGE("Failed to create usb temp stream memfd errno:%d", errno);
+        return false;
+    }
+    if (ftruncate(mFd.get(), mRegionSize) < 0) {
+        ALOGE("Failed to size usb temp stream to %zu errno:%d", mRegionSize, errno);
+        mFd.reset();
+        return false;
+    }
+    // Readers map the region for real, so make sure it can never shrink
+    // under them.
+    if (fcntl(mFd.get(), F_ADD_SEALS, F_SEAL_GROW | F_SEAL_SHRINK | F_SEAL_SEAL) < 0) {
+        ALOGW("Failed to seal usb temp stream errno:%d", errno);
+    }
+
+    mRegion = mmap(nullptr, mRegionSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFd.get(), 0);
+    if (mRegion == MAP_FAILED) {
+        ALOGE("Failed to map usb temp stream errno:%d", errno);
+        mRegion = nullptr;
+        mFd.reset();
+        return false;
+    }
+
+    mZoneNames = zoneNames;
+    auto *header = static_cast<UsbTempStreamHeader *>(mRegion);
+    header->version = kUsbTempStreamVersion;
+    header->zoneCount = zoneNames.size();
+    header->ringDepth = kUsbTempStreamRingDepth;
+    header->head.store(kUsbTempStreamRingDepth - 1, std::memory_order_relaxed);
+
+    auto *zones = reinterpret_cast<UsbTempStreamZone *>(static_cast<char *>(mRegion) +
+                                                        sizeof(UsbTempStreamHeader));
+    for (size_t i = 0; i < zoneNames.size(); i++) {
+        strlcpy(zones[i].name, zoneNames[i].c_str(), sizeof(zones[i].name));
+    }
+    for (uint32_t i = 0; i < kUsbTempStreamRingDepth; i++) {
+        UsbTempStreamSample *sample = sampleAt(i);
+        sample->seq.store(0, std::memory_order_relaxed);
+        sample->zoneIndex = UINT32_MAX;
+    }
+
+    ALOGI("usb temp stream initialized with %zu zones, %zu bytes", zoneNames.size(), mRegionSize);
+    return true;
+}
+
+void UsbTempStream::publish(const std::string &zoneName, float temp) {
+    if (mRegion == nullptr) {
+        return;
+    }
+    uint32_t zoneIndex = UINT32_MAX;
+    for (size_t i = 0; i < mZoneNames.size(); i++) {
+        if (mZoneNames[i] == zoneName) {
+            zoneIndex = i;
+            break;
+        }
+    }
+    if (zoneIndex == UINT32_MAX) {
+        return;
+    }
+
+    // Single writer (the reactor thread): claim the slot after head, write
+    // its payload under the slot's seqlock, then move head forward so
+    // readers only ever chase completed samples.
+    auto *header = static_cast<UsbTempStreamHeader *>(mRegion);
+    uint32_t next = (header->head.load(std::memory_order_relaxed) + 1) % kUsbTempStreamRingDepth;
+    UsbTempStreamSample *sample = sampleAt(next);
+
+    const uint32_t seq = sample->seq.load(std::memory_order_relaxed);
+    sample->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    sample->zoneIndex = zoneIndex;
+    sample->temp = temp;
+    sample->timestampNs = getBootTimeNs();
+    std::atomic_thread_fence(std::memory_order_release);
+    sample->seq.store(seq + 2, std::memory_order_release);
+    header->head.store(next, std::memory_order_release);
+}
+
+UsbTempStreamReader::~UsbTempStreamReader() {
+    if (mRegion != nullptr) {
+        munmap(const_cast<void *>(mRegion), mRegionSize);
+    }
+}
+
+bool UsbTempStreamReader::map(int fd) {
+    if (mRegion != nullptr) {
+        return false;
+    }
+
+    UsbTempStreamHeader header;
+    if (pread(fd, &header, sizeof(header), 0) != sizeof(header)) {
+        ALOGE("Failed to read usb temp stream header errno:%d", errno);
+        return false;
+    }
+    if (header.version != kUsbTempStreamVersion || header.zoneCount == 0 ||
+        header.ringDepth == 0) {
+        ALOGE("Unsupported usb temp stream layout version:%u", header.version);
+        return false;
+    }
+
+    mRegionSize = streamRegionSize(header.zoneCount, header.ringDepth);
+    mRegion = mmap(nullptr, mRegionSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (mRegion == MAP_FAILED) {
+        ALOGE("Failed to map usb temp stream errno:%d", errno);
+        mRegion = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool UsbTempStreamReader::getLatest(const std::string &zoneName, float *temp,
+                                    int64_t *timestampNs) {
+    if (mRegion == nullptr) {
+        return false;
+    }
+
+    const auto *header = static_cast<const UsbTempStreamHeader *>(mRegion);
+    const auto *zones = reinterpret_cast<const UsbTempStreamZone *>(
+            static_cast<const char *>(mRegion) + sizeof(UsbTempStreamHeader));
+    uint32_t zoneIndex = UINT32_MAX;
+    for (uint32_t i = 0; i < header->zoneCount; i++) {
+        if (zoneName == zones[i].name) {
+            zoneIndex = i;
+            break;
+        }
+    }
+    if (zoneIndex == UINT32_MAX) {
+        return false;
+    }
+
+    // Walk backwards from head; the first consistent sample for the zone is
+    // the newest one. A slot being rewritten while we look at it shows an
+    // odd or changed seq and is skipped — the writer never blocks on us.
+    const uint32_t head = header->head.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < header->ringDepth; i++) {
+        uint32_t idx = (head + header->ringDepth - i) % header->ringDepth;
+        const UsbTempStreamSample *sample = streamSampleAt(mRegion, header->zoneCount, idx);
+
+        const uint32_t seqBefore = sample->seq.load(std::memory_order_acquire);
+        if (seqBefore == 0 || (seqBefore & 1) != 0) {
+            continue;
+        }
+        uint32_t sampleZone = sample->zoneIndex;
+        float sampleTemp = sample->temp;
+        int64_t sampleTs = sample->timestampNs;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sample->seq.load(std::memory_order_relaxed) != seqBefore) {
+            continue;
+        }
+        if (sampleZone != zoneIndex) {
+            continue;
+        }
+        *temp = sampleTemp;
+        *timestampNs = sampleTs;
+        return true;
+    }
+    return false;
+}
+
+}  // namespace usb
+}  // namespace pixel
+}  // namespace google
+}  // namespace hardware
+}  // namespace android
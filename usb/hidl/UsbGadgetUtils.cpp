@@ -28,9 +28,7 @@ namespace google {
 namespace pixel {
 namespace usb {
 
-using ::android::base::GetProperty;
 using ::android::base::SetProperty;
-using ::android::base::WriteStringToFile;
 using ::android::hardware::usb::gadget::V1_0::GadgetFunction;
 
 Status setVidPid(const char *vid, const char *pid) {
@@ -46,35 +44,37 @@ Status addGenericAndroidFunctions(MonitorFfs *monitorFfs, uint64_t functions, bo
     if (((functions & GadgetFunction::MTP) != 0)) {
         *ffsEnabled = true;
         ALOGI("setCurrentUsbFunctions mtp");
-        if (!WriteStringToFile("1", DESC_USE_PATH))
+        if (!writeGadgetAttr("os_desc/use", "1"))
             return Status::ERROR;
 
         if (!monitorFfs->addInotifyFd("/dev/usb-ffs/mtp/"))
             return Status::ERROR;
 
-        if (linkFunction("ffs.mtp", (*functionCount)++))
-            return Status::ERROR;
-
-        // Add endpoints to be monitored.
+        // Add endpoints to be monitored before binding the function, so the
+        // daemon's descriptor writes overlap with the remaining binds.
         monitorFfs->addEndPoint("/dev/usb-ffs/mtp/ep1");
         monitorFfs->addEndPoint("/dev/usb-ffs/mtp/ep2");
         monitorFfs->addEndPoint("/dev/usb-ffs/mtp/ep3");
+
+        if (linkFunction("ffs.mtp", (*functionCount)++))
+            return Status::ERROR;
     } else if (((functions & GadgetFunction::PTP) != 0)) {
         *ffsEnabled = true;
         ALOGI("setCurrentUsbFunctions ptp");
-        if (!WriteStringToFile("1", DESC_USE_PATH))
+        if (!writeGadgetAttr("os_desc/use", "1"))
             return Status::ERROR;
 
         if (!monitorFfs->addInotifyFd("/dev/usb-ffs/ptp/"))
             return Status::ERROR;
 
-        if (linkFunction("ffs.ptp", (*functionCount)++))
-            return Status::ERROR;
-
-        // Add endpoints to be monitored.
+        // Add endpoints to be monitored before binding the function, so the
+        // daemon's descriptor writes overlap with the remaining binds.
         monitorFfs->addEndPoint("/dev/usb-ffs/ptp/ep1");
         monitorFfs->addEndPoint("/dev/usb-ffs/ptp/ep2");
         monitorFfs->addEndPoint("/dev/usb-ffs/ptp/ep3");
+
+        if (linkFunction("ffs.ptp", (*functionCount)++))
+            return Status::ERROR;
     }
 
     if ((functions & GadgetFunction::MIDI) != 0) {
@@ -97,7 +97,9 @@ Status addGenericAndroidFunctions(MonitorFfs *monitorFfs, uint64_t functions, bo
 
     if ((functions & GadgetFunction::RNDIS) != 0) {
         ALOGI("setCurrentUsbFunctions rndis");
-        std::string rndisFunction = GetProperty(kVendorRndisConfig, "");
+        // Resolved once; later calls are a serial compare, not a lookup.
+        static ::android::base::CachedProperty sRndisConfig(kVendorRndisConfig);
+        std::string rndisFunction = sRndisConfig.Get();
         if (rndisFunction != "") {
             if (linkFunction(rndisFunction.c_str(), (*functionCount)++))
                 return Status::ERROR;
@@ -108,22 +110,32 @@ Status addGenericAndroidFunctions(MonitorFfs *monitorFfs, uint64_t functions, bo
         }
     }
 
+    // Record the subset of the request this helper is responsible for, so a
+    // later identical request can be recognized as already applied.
+    markFunctionConfigApplied(functions &
+                              (GadgetFunction::MTP | GadgetFunction::PTP | GadgetFunction::MIDI |
+                               GadgetFunction::ACCESSORY | GadgetFunction::AUDIO_SOURCE |
+                               GadgetFunction::RNDIS));
+
     return Status::SUCCESS;
 }
 
 Status addAdb(MonitorFfs *monitorFfs, int *functionCount) {
     ALOGI("setCurrentUsbFunctions Adb");
-    if (!WriteStringToFile("1", DESC_USE_PATH))
+    if (!writeGadgetAttr("os_desc/use", "1"))
         return Status::ERROR;
 
     if (!monitorFfs->addInotifyFd("/dev/usb-ffs/adb/"))
         return Status::ERROR;
 
-    if (linkFunction("ffs.adb", (*functionCount)++))
-        return Status::ERROR;
-
     monitorFfs->addEndPoint("/dev/usb-ffs/adb/ep1");
     monitorFfs->addEndPoint("/dev/usb-ffs/adb/ep2");
+
+    // Bind last: once the function link exists the daemon starts writing
+    // descriptors, which then overlaps with the rest of the configuration.
+    if (linkFunction("ffs.adb", (*functionCount)++))
+        return Status::ERROR;
+    markFunctionConfigApplied(GadgetFunction::ADB);
     ALOGI("Service started");
     return Status::SUCCESS;
 }
@@ -68,8 +68,29 @@ int addEpollFd(const ::android::base::unique_fd &epfd, const ::android::base::un
 std::string getVendorFunctions();
 // Removes all the usb functions link in the specified path.
 int unlinkFunctions(const char *path);
-// Creates a configfs link for the function.
+// Creates a configfs link for the function. An identical link already in
+// place is kept as-is, so re-applying a function set only toggles the links
+// that actually changed.
 int linkFunction(const char *function, int index);
+// Config-state cache for gadget function switching. The helpers below track
+// which function set the configfs links currently reflect, fingerprinted by
+// the GadgetFunction bitmask, so a HAL re-applying the set it already
+// configured (the common unplug/replug cycle) can skip the reset and
+// re-link churn entirely.
+//
+// Returns true when the links in configfs were built for exactly this
+// function set; the HAL can then pull the gadget up directly.
+bool isFunctionConfigApplied(uint64_t functions);
+// Records that the links for the given functions were applied on top of the
+// current config; called by addGenericAndroidFunctions/addAdb.
+void markFunctionConfigApplied(uint64_t functions);
+// Invalidates the cache when configfs is in an unknown state.
+void clearFunctionConfigApplied();
+// Writes a gadget configfs attribute, path relative to GADGET_PATH, through
+// a cached directory fd and a last-written-value cache that skips rewrites
+// of unchanged attributes. Returns true on success. Must not be used for
+// UDC, whose writes have side effects even with an unchanged value.
+bool writeGadgetAttr(const char *attr, const char *value);
 // Sets the USB VID and PID. Returns true on success, false on failure
 bool setVidPidCommon(const char *vid, const char *pid);
 // Pulls down USB gadget. Returns true on success, false on failure
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HARDWARE_GOOGLE_PIXEL_USB_FILEFORWARDER_H_
+#define HARDWARE_GOOGLE_PIXEL_USB_FILEFORWARDER_H_
+
+#include <sys/types.h>
+
+#include <cstddef>
+
+namespace android {
+namespace hardware {
+namespace google {
+namespace pixel {
+namespace usb {
+
+// Zero-copy file forwarding for bulk transfers over the gadget functions
+// (logging/accessory dump pulls). Data moves inFd -> outFd inside the
+// kernel — sendfile when the fd pair supports it, otherwise spliced through
+// a pipe — so a 100+ MB log pull does not round-trip every page through a
+// userspace buffer. Falls back to plain read/write only when neither path
+// is available for the fd pair.
+
+// Forwards up to count bytes. Returns the number of bytes moved, which can
+// be short on EOF, or -1 with errno set on failure.
+ssize_t forwardFileRange(int outFd, int inFd, size_t count);
+// Forwards inFd to outFd until EOF. Returns the total bytes moved, or -1
+// with errno set on failure.
+ssize_t forwardFile(int outFd, int inFd);
+
+}  // namespace usb
+}  // namespace pixel
+}  // namespace google
+}  // namespace hardware
+}  // namespace android
+
+#endif  // HARDWARE_GOOGLE_PIXEL_USB_FILEFORWARDER_H_
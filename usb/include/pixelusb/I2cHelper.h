@@ -17,7 +17,11 @@
 #ifndef HARDWARE_GOOGLE_PIXEL_USB_I2CHELPER_H_
 #define HARDWARE_GOOGLE_PIXEL_USB_I2CHELPER_H_
 
+#include <android-base/unique_fd.h>
+
+#include <cstdint>
 #include <string>
+#include <vector>
 
 using ::std::string;
 
@@ -30,6 +34,36 @@ namespace usb {
 // Search the path of the i2c client
 string getI2cClientPath(const string hsi2cPath, const string devName, const string clientId);
 
+// Batched register access to an I2C client through /dev/i2c-<bus>.
+//
+// Polling paths used to read TCPC registers one sysfs attribute at a time,
+// paying an open/read/close per register. This keeps one fd to the bus char
+// device open across polls and reads all requested registers in a single
+// I2C_RDWR combined transaction (register-address write plus repeated-start
+// read per register), so a poll costs one ioctl and one bus arbitration.
+class I2cBatchReader {
+  public:
+    // hsi2cPath is the hsi2c sysfs device directory, as for
+    // getI2cClientPath; clientAddr is the client's 7-bit address.
+    I2cBatchReader(const string hsi2cPath, uint16_t clientAddr);
+
+    // Reads one byte for each register in regs into values (resized to
+    // match). Returns false and leaves values untouched when the bus device
+    // cannot be opened or the transaction fails.
+    bool readRegisters(const std::vector<uint8_t> &regs, std::vector<uint8_t> *values);
+    // Single-register convenience wrapper.
+    bool readRegister(uint8_t reg, uint8_t *value);
+
+  private:
+    // Opens the bus char device on first use and after errors; true when
+    // mFd is usable.
+    bool ensureOpen();
+
+    const string mHsi2cPath;
+    const uint16_t mClientAddr;
+    ::android::base::unique_fd mFd;
+};
+
 }  // namespace usb
 }  // namespace pixel
 }  // namespace google
@@ -20,9 +20,10 @@
 #include <android-base/unique_fd.h>
 #include <pixelusb/CommonUtils.h>
 
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
 #include <string>
-#include <thread>
 #include <vector>
 
 namespace android {
@@ -38,14 +39,15 @@ using ::android::base::unique_fd;
 // owner restarts.
 class MonitorFfs {
   private:
-    // Monitors the endpoints Inotify events.
+    // Monitors the endpoints Inotify events. Serviced by the shared
+    // UsbReactor instead of a dedicated epoll thread.
     unique_fd mInotifyFd;
-    // Control pipe for shutting down the mMonitor thread.
-    // mMonitor exits when SHUTDOWN_MONITOR is written into
-    // mEventFd/
-    unique_fd mEventFd;
-    // Pools on mInotifyFd and mEventFd.
-    unique_fd mEpollFd;
+    // Defers the UDC write after the endpoints come up, replacing the
+    // usleep the old monitor thread did before pulling the gadget up.
+    unique_fd mPullUpTimerFd;
+    // Fires the functions-applied callback with false if the gadget has not
+    // pulled up by the deadline passed to waitForPullUpAsync.
+    unique_fd mDeadlineTimerFd;
     std::vector<int> mWatchFd;
 
     // Maintains the list of Endpoints.
@@ -53,21 +55,39 @@ class MonitorFfs {
     // protects the CV.
     std::mutex mLock;
     std::condition_variable mCv;
-    // protects mInotifyFd, mEpollFd.
+    // protects mInotifyFd, mWatchFd, mEndpointList.
     std::mutex mLockFd;
 
     // Flag to maintain the current status of gadget pullup.
     bool mCurrentUsbFunctionsApplied;
 
-    // Thread object that executes the ep monitoring logic.
-    std::unique_ptr<std::thread> mMonitor;
     // Callback to be invoked when gadget is pulled up.
     void (*mCallback)(bool functionsApplied, void *payload);
     void *mPayload;
     // Name of the USB gadget. Used for pullup.
     const char *const mGadgetName;
-    // Monitor State
+    // Whether mInotifyFd is registered with the reactor
     bool mMonitorRunning;
+    // Pullup state carried between inotify events: whether the UDC write is
+    // still pending and when the endpoints last went away.
+    bool mWriteUdc;
+    std::chrono::steady_clock::time_point mDisconnect;
+
+    // Reactor callback: drains mInotifyFd and pulls the gadget up or down as
+    // endpoints appear and disappear.
+    void handleInotifyEvent();
+    // Reactor callback for mPullUpTimerFd: performs the deferred UDC write.
+    void handlePullUpTimer();
+    // Reactor callback for mDeadlineTimerFd: reports failure to the caller.
+    void handleDeadlineTimer();
+    // Arms (or with 0, disarms) the given timer fd.
+    void armTimer(const unique_fd &timerFd, int64_t delayUs);
+    // Arms (or with 0, disarms) the deferred pullup timer.
+    void armPullUpTimer(int64_t delayUs);
+    // True when every registered endpoint is accessible.
+    bool allEndpointsPresent();
+    // Writes the UDC and notifies waiters, returns true on success.
+    bool pullUpGadget();
 
   public:
     MonitorFfs(const char *const gadget);
@@ -79,6 +99,14 @@ class MonitorFfs {
     // Waits for timeout_ms for gadget pull up to happen.
     // Returns immediately if the gadget is already pulled up.
     bool waitForPullUp(int timeout_ms);
+    // Deadline-aware variant, usable when the budget spans several
+    // configuration steps without recomputing per-step timeouts.
+    bool waitForPullUp(std::chrono::steady_clock::time_point deadline);
+    // Async completion: returns immediately and reports the outcome through
+    // the registered functions-applied callback - true from the pullup path,
+    // false from the reactor when the deadline passes first. Lets the gadget
+    // HAL finish configuration without parking a thread in waitForPullUp.
+    bool waitForPullUpAsync(int timeout_ms);
     // Adds the given fd to the watch list.
     bool addInotifyFd(std::string fd);
     // Adds the given endpoint to the watch list.
@@ -88,8 +116,6 @@ class MonitorFfs {
     void registerFunctionsAppliedCallback(void (*callback)(bool functionsApplied, void *(payload)),
                                           void *payload);
     bool isMonitorRunning();
-    // Ep monitoring and the gadget pull up logic.
-    static void *startMonitorFd(void *param);
 };
 
 }  // namespace usb
@@ -43,6 +43,8 @@
 #include <thread>
 #include <vector>
 
+#include "UsbTempStream.h"
+
 namespace android {
 namespace hardware {
 namespace google {
@@ -88,11 +90,9 @@ class ZoneInfo {
  */
 class UsbOverheatEvent : public IServiceNotification, public IThermalChangedCallback {
   private:
-    // To wake up thread to record max temperature
+    // Fires to record max temperature. Serviced by the shared UsbReactor.
     unique_fd timer_fd_;
-    // Polls on timer_fd_ & event_fd. Thread waits here when port is cold.
-    unique_fd epoll_fd_;
-    // To wake up the thread when waiting on TimerFd
+    // To kick the monitor when recording starts or stops
     unique_fd event_fd_;
     // Thermal zone for monitoring Throttling event
     ZoneInfo monitored_zone_;
@@ -103,8 +103,11 @@ class UsbOverheatEvent : public IServiceNotification, public IThermalChangedCall
     vector<ZoneInfo> queried_zones_;
     //  Sampling interval for monitoring the temperature
     int monitor_interval_sec_;
-    // Thread object that executes the ep monitoring logic
-    unique_ptr<thread> monitor_;
+    // How early a sample may be folded into an adjacent wakeup. Deadlines are
+    // armed on the shared boottime wakeup grid, and a deadline landing within
+    // this tolerance of a sample just taken is coarsened onto the next grid
+    // point instead of waking the SoC again.
+    int monitor_slack_sec_;
     // Maximum overheat temperature recorded
     float max_overheat_temp_;
     // Reference to Thermal service
@@ -115,8 +118,40 @@ class UsbOverheatEvent : public IServiceNotification, public IThermalChangedCall
     ndk::ScopedAIBinder_DeathRecipient thermal_aidl_death_recipient_;
     // Whether the Thermal callback is successfully registered
     bool is_thermal_callback_registered_;
-    // Thread that polls temperature to record max temp
-    static void *monitorThread(void *param);
+    // Shared seqlock ring of the sampled zone temperatures, so health and
+    // pixelstats can consume the recorder's samples instead of re-polling
+    // the same thermistors themselves
+    UsbTempStream temp_stream_;
+    // One recorded sample of the port zone (queried_zones_[0])
+    struct OverheatSample {
+        int64_t timestampMs;
+        float temp;
+    };
+    // Depth of the preallocated sample history. 256 samples cover ~4 min of
+    // 1 s polling at full rate; longer events are kept downsampled.
+    static constexpr size_t kSampleRingDepth = 256;
+    // Guards the sample history: written on the reactor thread, read by
+    // dumpOverheatHistory from the HAL's dump thread
+    std::mutex sample_lock_;
+    // Temperature curve of the current (or last) overheat event. Preallocated
+    // so nothing is allocated while the port is hot; when full, every other
+    // kept sample is promoted and the keep stride doubles, trading resolution
+    // for span at fixed memory.
+    OverheatSample sample_ring_[kSampleRingDepth];
+    size_t sample_count_ = 0;
+    // Keep every sample_stride_'th poll; doubles on each compaction
+    uint32_t sample_stride_ = 1;
+    uint32_t polls_until_keep_ = 0;
+    // Reactor callbacks for timer_fd_/event_fd_; both drain the fd and
+    // resample the temperature
+    void handleTimerFired();
+    void handleWakeup();
+    // Record the queried zones and re-arm (or disarm) the sampling timer
+    void sampleAndRearmTimer();
+    // Append one port zone sample to the history, compacting when full
+    void recordSample(float temp);
+    // Drop the recorded history; each overheat event records a fresh curve
+    void resetSampleHistory();
     // Register service notification listener
     bool registerListener();
     // Helper function to wakeup monitor thread
@@ -142,8 +177,10 @@ class UsbOverheatEvent : public IServiceNotification, public IThermalChangedCall
     }
 
   public:
+    // monitor_slack_sec bounds how far a sample may shift to ride an existing
+    // wakeup; by default 5% of the interval, matching WakeupScheduler.
     UsbOverheatEvent(const ZoneInfo &monitored_zone, const std::vector<ZoneInfo> &queried_zones,
-                     const int &monitor_interval_sec);
+                     const int &monitor_interval_sec, const int &monitor_slack_sec = -1);
     ~UsbOverheatEvent();
     // Start monitoring thermal zone for maximum temperature
     bool startRecording();
@@ -153,6 +190,12 @@ class UsbOverheatEvent : public IServiceNotification, public IThermalChangedCall
     bool getCurrentTemperature(const string &name, float *temp);
     // Query Max overheat temperature
     float getMaxOverheatTemperature();
+    // Fd of the shared temperature stream, to be duped out read-only to
+    // health/pixelstats. -1 when the stream could not be set up.
+    int getTempStreamFd();
+    // Write the recorded temperature curve of the current or most recent
+    // overheat event to fd, one "timestamp_ms temp" line per sample
+    void dumpOverheatHistory(int fd);
 };
 
 }  // namespace usb
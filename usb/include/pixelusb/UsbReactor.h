@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HARDWARE_GOOGLE_PIXEL_USB_USBREACTOR_H_
+#define HARDWARE_GOOGLE_PIXEL_USB_USBREACTOR_H_
+
+#include <android-base/unique_fd.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace android {
+namespace hardware {
+namespace google {
+namespace pixel {
+namespace usb {
+
+// Shared single-threaded reactor for the USB HAL. UsbOverheatEvent and
+// MonitorFfs used to each run their own epoll loop with their own timer and
+// event fds; both register their fds here instead so one thread services all
+// USB HAL wakeups. Callbacks run on the reactor thread and must not block.
+class UsbReactor {
+  public:
+    // Shared instance; the reactor thread is started on first use and runs
+    // for the life of the process, matching the lifetime of its users.
+    static UsbReactor &getInstance();
+
+    // Registers fd for EPOLLIN and invokes callback on the reactor thread
+    // whenever it becomes readable. The callback is responsible for draining
+    // the fd. With wakeup set, EPOLLWAKEUP keeps a kernel wakeup source held
+    // while events are pending, as UsbOverheatEvent requires.
+    bool addFd(int fd, std::function<void()> callback, bool wakeup = false);
+
+    // Unregisters fd. Blocks until an in-flight callback for fd has returned
+    // (unless called from the reactor thread itself), so the caller can
+    // safely close the fd or destroy callback state afterwards.
+    bool removeFd(int fd);
+
+  private:
+    UsbReactor();
+    UsbReactor(const UsbReactor &) = delete;
+    void operator=(const UsbReactor &) = delete;
+
+    void reactorLoop();
+
+    ::android::base::unique_fd mEpollFd;
+    std::mutex mLock;
+    std::condition_variable mCv;
+    std::unordered_map<int, std::function<void()>> mCallbacks;
+    // fd whose callback is currently executing, -1 when idle
+    int mDispatchingFd;
+    std::thread mThread;
+};
+
+}  // namespace usb
+}  // namespace pixel
+}  // namespace google
+}  // namespace hardware
+}  // namespace android
+
+#endif  // HARDWARE_GOOGLE_PIXEL_USB_USBREACTOR_H_
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HARDWARE_GOOGLE_PIXEL_USB_USBTEMPSTREAM_H
+#define HARDWARE_GOOGLE_PIXEL_USB_USBTEMPSTREAM_H
+
+#include <android-base/unique_fd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace android {
+namespace hardware {
+namespace google {
+namespace pixel {
+namespace usb {
+
+// Layout of the shared temperature stream. One page holds a header, a fixed
+// table of zone names, and a ring of samples. Each sample is guarded by its
+// own seqlock: seq is bumped odd before the payload is written and to the
+// next even value afterwards, so a reader retries whenever it observes an
+// odd seq or a seq change across its read. head is the index of the most
+// recently completed sample.
+struct UsbTempStreamHeader {
+    uint32_t version;
+    uint32_t zoneCount;
+    uint32_t ringDepth;
+    std::atomic<uint32_t> head;
+};
+
+struct UsbTempStreamZone {
+    char name[52];
+};
+
+struct UsbTempStreamSample {
+    std::atomic<uint32_t> seq;
+    uint32_t zoneIndex;
+    float temp;
+    int64_t timestampNs;
+};
+
+inline constexpr uint32_t kUsbTempStreamVersion = 1;
+inline constexpr uint32_t kUsbTempStreamRingDepth = 64;
+
+// Writer side, owned by the overheat recorder. Every sample taken from the
+// USB-C thermistors is published into a memfd-backed seqlock ring so health
+// and pixelstats can map the region read-only instead of re-polling the same
+// sysfs nodes themselves. The fd is sealed against resize and handed out
+// through getFd() for the HAL to dupe to its consumers.
+class UsbTempStream {
+  public:
+    UsbTempStream() = default;
+    ~UsbTempStream();
+    UsbTempStream(const UsbTempStream &) = delete;
+    void operator=(const UsbTempStream &) = delete;
+
+    // Sizes and maps the region for the given zone names. Returns false if
+    // the memfd cannot be created or mapped.
+    bool initialize(const std::vector<std::string> &zoneNames);
+    // Publishes one sample into the next ring slot under its seqlock.
+    // No-op for zones not registered at initialize() time.
+    void publish(const std::string &zoneName, float temp);
+    // The region fd, to be duped out read-only to clients.
+    int getFd() const { return mFd.get(); }
+    bool isInitialized() const { return mRegion != nullptr; }
+
+  private:
+    ::android::base::unique_fd mFd;
+    void *mRegion = nullptr;
+    size_t mRegionSize = 0;
+    std::vector<std::string> mZoneNames;
+
+    UsbTempStreamSample *sampleAt(uint32_t idx);
+};
+
+// Reader side for consumers handed the region fd. Maps read-only and
+// returns the latest published sample for a zone without taking any lock.
+class UsbTempStreamReader {
+  public:
+    UsbTempStreamReader() = default;
+    ~UsbTempStreamReader();
+    UsbTempStreamReader(const UsbTempStreamReader &) = delete;
+    void operator=(const UsbTempStreamReader &) = delete;
+
+    // Maps the region read-only; does not take ownership of fd.
+    bool map(int fd);
+    // Scans back from head for the newest consistent sample of the zone.
+    // Returns false when no sample for the zone is in the ring yet.
+    bool getLatest(const std::string &zoneName, float *temp, int64_t *timestampNs);
+
+  private:
+    const void *mRegion = nullptr;
+    size_t mRegionSize = 0;
+};
+
+}  // namespace usb
+}  // namespace pixel
+}  // namespace google
+}  // namespace hardware
+}  // namespace android
+#endif
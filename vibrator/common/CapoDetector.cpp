@@ -92,45 +92,52 @@ void CapoDetector::onMessageReceived(const void *data, size_t length) {
  * Listen for messages from capo nanoapp and handle the message.
  */
 void CapoDetector::handleNanoappMessage(const fbs::NanoappMessageT &message) {
-    ALOGI("%s, Id %" PRIu64 ", type %d, size %d", __func__, message.app_id, message.message_type,
-          static_cast<int>(message.message.size()));
     // Exclude the message with unmatched nanoapp id.
     if (message.app_id != kCapoNanoappId)
         return;
 
-    // Handle the message with message_type.
+    ALOGV("%s, Id %" PRIu64 ", type %d, size %d", __func__, message.app_id, message.message_type,
+          static_cast<int>(message.message.size()));
+    if (message.message.size() < 2) {
+        ALOGE("%s, short message from capo nanoapp, type: %" PRIu32 ", size %d", __func__,
+              message.message_type, static_cast<int>(message.message.size()));
+        return;
+    }
+
+    // The capo payloads carry a single enum in byte 1; read it straight from
+    // the buffer instead of materializing a protobuf object per message, so
+    // a burst of queued position events decodes with no per-message
+    // allocation.
     switch (message.message_type) {
         case capo::MessageType::ACK_NOTIFICATION: {
-            capo::AckNotification gd;
-            gd.set_notification_type(static_cast<capo::NotificationType>(message.message[1]));
             ALOGD("%s, get notification event from capo nanoapp, type %d", __func__,
-                  gd.notification_type());
+                  static_cast<int>(message.message[1]));
             break;
         }
         case capo::MessageType::POSITION_DETECTED: {
-            uint8_t position;
-            uint32_t time;
+            const auto position = static_cast<capo::PositionType>(message.message[1]);
+            bool changed;
             {
                 std::lock_guard<std::mutex> lock(mCapoMutex);
-                capo::PositionDetected gd;
-                time = getCurrentTimeInMs();
-                gd.set_position_type(static_cast<capo::PositionType>(message.message[1]));
+                uint32_t time = getCurrentTimeInMs();
                 ALOGD("CapoDetector: [%u] get position event from capo nanoapp, from %d to %d",
-                      time, last_position_type_, gd.position_type());
+                      time, last_position_type_, position);
 
                 // Record the last moment we were in FACE_UP state
                 if (last_position_type_ == capo::PositionType::ON_TABLE_FACE_UP ||
-                    gd.position_type() == capo::PositionType::ON_TABLE_FACE_UP) {
+                    position == capo::PositionType::ON_TABLE_FACE_UP) {
                     mLastFaceUpEvent = time;
                 }
-                last_position_type_ = gd.position_type();
-                position = last_position_type_;
+                changed = last_position_type_ != position;
+                last_position_type_ = position;
             }
-            // Callback to function while getting carried position event.
-            if (callback_func_ != nullptr) {
-                ALOGD("%s, sent position type %d to callback function", __func__,
-                      last_position_type_);
-                callback_func_(last_position_type_);
+            // Only state transitions reach the HAL callback: during a motion
+            // burst the queued repeats of the same position collapse to the
+            // stored latest state, which readers pick up through
+            // getCarriedPositionInfo().
+            if (changed && callback_func_ != nullptr) {
+                ALOGD("%s, sent position type %d to callback function", __func__, position);
+                callback_func_(position);
             }
             break;
         }
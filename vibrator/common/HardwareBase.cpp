@@ -34,6 +34,20 @@ HwApiBase::HwApiBase() {
     if (mPathPrefix.empty() && (std::getenv("INPUT_EVENT_NAME") == NULL)) {
         ALOGE("Failed to get HWAPI path prefix!");
     }
+    openPathPrefixDir();
+}
+
+void HwApiBase::openPathPrefixDir() {
+    if (mPathPrefix.empty()) {
+        mPathPrefixFd.reset();
+        return;
+    }
+    mPathPrefixFd.reset(
+            TEMP_FAILURE_RETRY(::open(mPathPrefix.c_str(), O_DIRECTORY | O_PATH | O_CLOEXEC)));
+    if (!mPathPrefixFd.ok()) {
+        ALOGE("Failed to open HWAPI dir %s (%d): %s; falling back to full paths",
+              mPathPrefix.c_str(), errno, strerror(errno));
+    }
 }
 
 void HwApiBase::saveName(const std::string &name, const std::ios *stream) {
@@ -17,8 +17,10 @@
 
 #include <android-base/stringprintf.h>
 #include <android-base/unique_fd.h>
+#include <fcntl.h>
 #include <log/log.h>
 #include <sys/epoll.h>
+#include <unistd.h>
 #include <utils/Trace.h>
 
 #include <chrono>
@@ -74,10 +76,32 @@ class HwApiBase {
     void updatePathPrefix(const std::string &prefix) {
         ALOGI("Update HWAPI path prefix to %s", prefix.c_str());
         mPathPrefix = prefix;
+        openPathPrefixDir();
     }
     void saveName(const std::string &name, const std::ios *stream);
     template <typename T>
     void open(const std::string &name, T *stream);
+    // Open the named node relative to the cached device directory fd, so the
+    // kernel resolves only the node component instead of walking the whole
+    // prefix on every (re)open; falls back to the full path when the prefix
+    // directory could not be opened.
+    unique_fd openAt(const std::string &name, int flags) {
+        int fd;
+        if (mPathPrefixFd.ok()) {
+            fd = TEMP_FAILURE_RETRY(::openat(mPathPrefixFd.get(), name.c_str(), flags));
+        } else {
+            fd = TEMP_FAILURE_RETRY(::open((mPathPrefix + name).c_str(), flags));
+        }
+        return unique_fd{fd};
+    }
+    // Raw descriptor on the same node for callers that need single-syscall writes.
+    bool openFd(const std::string &name, unique_fd *fd) {
+        *fd = openAt(name, O_WRONLY | O_CLOEXEC);
+        if (!fd->ok()) {
+            ALOGE("Failed to open %s (%d): %s", name.c_str(), errno, strerror(errno));
+        }
+        return fd->ok();
+    }
     bool has(const std::ios &stream);
     template <typename T>
     bool get(T *value, std::istream *stream);
@@ -89,7 +113,13 @@ class HwApiBase {
     void record(const char *func, const T &value, const std::ios *stream);
 
   private:
+    // (Re-)open the cached directory fd backing openAt().
+    void openPathPrefixDir();
+
     std::string mPathPrefix;
+    // Device directory opened once per prefix change; O_PATH, only used as
+    // the dirfd anchor for openAt().
+    unique_fd mPathPrefixFd;
     NamesMap mNames;
     Records mRecords{RECORDS_SIZE};
     std::mutex mRecordsMutex;
@@ -139,8 +169,7 @@ bool HwApiBase::poll(const T &value, std::istream *stream, const int32_t timeout
     ATRACE_NAME(StringPrintf("HwApi::poll %s==%s", mNames[stream].c_str(),
                              std::to_string(value).c_str())
                         .c_str());
-    auto path = mPathPrefix + mNames[stream];
-    unique_fd fileFd{::open(path.c_str(), O_RDONLY)};
+    unique_fd fileFd{openAt(mNames[stream], O_RDONLY)};
     unique_fd epollFd{epoll_create(1)};
     epoll_event event = {
             .events = EPOLLPRI | EPOLLET,
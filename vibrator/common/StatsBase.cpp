@@ -111,6 +111,12 @@ void StatsBase::debug(int fd) {
         dprintf(fd, "  Max Latencies:%s\n", dumpData(mMaxLatencies).c_str());
         dprintf(fd, "  Latency Totals:%s\n", dumpData(mLatencyTotals).c_str());
         dprintf(fd, "  Latency Counts:%s\n", dumpData(mLatencyCounts).c_str());
+        for (size_t i = 0; (i + 1) * kLatencyHistogramBuckets <= mLatencyHistograms.size(); i++) {
+            std::vector<int32_t> histogram(
+                    mLatencyHistograms.begin() + i * kLatencyHistogramBuckets,
+                    mLatencyHistograms.begin() + (i + 1) * kLatencyHistogramBuckets);
+            dprintf(fd, "  Latency Histogram %zu (log2 ms):%s\n", i, dumpData(histogram).c_str());
+        }
         dprintf(fd, "  Error Counts: %s\n", dumpData(mErrorCounts).c_str());
     }
 }
@@ -204,6 +210,7 @@ void StatsBase::uploadLatencyAtoms() {
     clearData(&mMaxLatencies);
     clearData(&mLatencyTotals);
     clearData(&mLatencyCounts);
+    clearData(&mLatencyHistograms);
 }
 
 void StatsBase::uploadErrorAtoms() {
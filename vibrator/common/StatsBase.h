@@ -54,12 +54,39 @@ class StatsBase {
     void debug(int fd);
 
   protected:
+    // Latency distribution: one fixed 32-bucket log2 histogram per latency
+    // type, updated with a single increment per sample and dumped by scanning
+    // the buckets, so the footprint stays constant regardless of vibration
+    // volume. Bucket 0 counts non-positive samples; bucket n holds
+    // [2^(n-1), 2^n) ms with the last bucket open-ended.
+    static constexpr int32_t kLatencyHistogramBuckets = 32;
+
+    // Fold one latency sample into the min/max/total/count aggregates and the
+    // histogram; the caller must hold mDataAccess.
+    void recordLatencyLocked(uint16_t index, int32_t ms) {
+        if (ms < mMinLatencies[index] || mMinLatencies[index] == 0) {
+            mMinLatencies[index] = ms;
+        }
+        if (ms > mMaxLatencies[index]) {
+            mMaxLatencies[index] = ms;
+        }
+        mLatencyTotals[index] += ms;
+        mLatencyCounts[index]++;
+        if (!mLatencyHistograms.empty()) {
+            int32_t bucket = (ms <= 0) ? 0 : 32 - __builtin_clz(static_cast<uint32_t>(ms));
+            mLatencyHistograms[index * kLatencyHistogramBuckets + bucket]++;
+        }
+    }
+
     std::vector<int32_t> mWaveformCounts;
     std::vector<int32_t> mDurationCounts;
     std::vector<int32_t> mMinLatencies;
     std::vector<int32_t> mMaxLatencies;
     std::vector<int32_t> mLatencyTotals;
     std::vector<int32_t> mLatencyCounts;
+    // kLatencyHistogramBuckets entries per latency type; sized by the
+    // subclass alongside the other aggregates.
+    std::vector<int32_t> mLatencyHistograms;
     std::vector<int32_t> mErrorCounts;
     std::mutex mDataAccess;
 
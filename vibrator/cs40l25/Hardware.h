@@ -60,7 +60,28 @@ class HwApi : public Vibrator::HwApi, private HwApiBase {
     bool getEffectCount(uint32_t *value) override { return get(value, &mEffectCount); }
     bool getEffectDuration(uint32_t *value) override { return get(value, &mEffectDuration); }
     bool setEffectIndex(uint32_t value) override { return set(value, &mEffectIndex); }
-    bool setEffectQueue(std::string value) override { return set(value, &mEffectQueue); }
+    bool setEffectQueue(std::string value) override {
+        /*
+         * Stage the whole queue image and land it with a single write(); the
+         * stream path can split long ringtone queues into buffer-sized
+         * chunks, each a separate sysfs store. Fall back to the stream on
+         * any failure.
+         */
+        if (!mEffectQueueFd.ok()) {
+            openFd("device/cp_trigger_queue", &mEffectQueueFd);
+        }
+        if (mEffectQueueFd.ok()) {
+            std::string image = value + "\n";
+            ssize_t ret = TEMP_FAILURE_RETRY(::write(mEffectQueueFd, image.data(), image.size()));
+            if (ret == static_cast<ssize_t>(image.size())) {
+                HWAPI_RECORD(value, &mEffectQueue);
+                return true;
+            }
+            ALOGW("One-shot queue write failed (%d): %s, using the stream path", errno,
+                  strerror(errno));
+        }
+        return set(value, &mEffectQueue);
+    }
     bool hasEffectScale() override { return has(mEffectScale); }
     bool setEffectScale(uint32_t value) override { return set(value, &mEffectScale); }
     bool setGlobalScale(uint32_t value) override { return set(value, &mGlobalScale); }
@@ -108,6 +129,7 @@ class HwApi : public Vibrator::HwApi, private HwApiBase {
     std::ifstream mAvailablePwleSegments;
     std::ofstream mPwle;
     std::ofstream mPwleRampDown;
+    unique_fd mEffectQueueFd;
 };
 
 class HwCal : public Vibrator::HwCal, private HwCalBase {
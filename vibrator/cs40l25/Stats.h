@@ -169,6 +169,8 @@ class StatsApi : public Vibrator::StatsApi, private StatsBase {
         mMaxLatencies = std::vector<int32_t>(kEffectLatencyCount, 0);
         mLatencyTotals = std::vector<int32_t>(kEffectLatencyCount, 0);
         mLatencyCounts = std::vector<int32_t>(kEffectLatencyCount, 0);
+        mLatencyHistograms =
+                std::vector<int32_t>(kEffectLatencyCount * kLatencyHistogramBuckets, 0);
         mErrorCounts = std::vector<int32_t>(kVibratorErrorCount, 0);
     }
 
@@ -264,15 +266,7 @@ class StatsApi : public Vibrator::StatsApi, private StatsBase {
 
         {
             std::scoped_lock<std::mutex> lock(mDataAccess);
-            if (latency < mMinLatencies[mCurrentLatencyIndex] ||
-                mMinLatencies[mCurrentLatencyIndex] == 0) {
-                mMinLatencies[mCurrentLatencyIndex] = latency;
-            }
-            if (latency > mMaxLatencies[mCurrentLatencyIndex]) {
-                mMaxLatencies[mCurrentLatencyIndex] = latency;
-            }
-            mLatencyTotals[mCurrentLatencyIndex] += latency;
-            mLatencyCounts[mCurrentLatencyIndex]++;
+            recordLatencyLocked(mCurrentLatencyIndex, latency);
         }
 
         mCurrentLatencyIndex = kEffectLatencyCount;
@@ -21,6 +21,7 @@
 #include <utils/Trace.h>
 
 #include <cmath>
+#include <cstring>
 
 #include "Trace.h"
 
@@ -30,16 +31,16 @@ namespace hardware {
 namespace vibrator {
 
 #ifdef VIBRATOR_TRACE
-/* Function Trace */
-#define VFTRACE(...)                                                             \
-    ATRACE_NAME(StringPrintf("Vibrator::%s", __func__).c_str());                 \
-    auto f_trace_ = std::make_unique<FunctionTrace>("Vibrator", __func__);       \
-    __VA_OPT__(f_trace_->addParameter(PREPEND_EACH_ARG_WITH_NAME(__VA_ARGS__))); \
-    f_trace_->save()
-/* Effect Trace */
-#define VETRACE(i, s, d, ch)                                    \
-    auto e_trace_ = std::make_unique<EffectTrace>(i, s, d, ch); \
-    e_trace_->save()
+/* Function Trace. Stack-constructed; a no-op unless Trace::isEnabled() */
+#define VFTRACE(...)                                                            \
+    ATRACE_NAME(StringPrintf("Vibrator::%s", __func__).c_str());                \
+    FunctionTrace f_trace_("Vibrator", __func__);                               \
+    __VA_OPT__(f_trace_.addParameter(PREPEND_EACH_ARG_WITH_NAME(__VA_ARGS__))); \
+    f_trace_.save()
+/* Effect Trace. Stack-constructed; a no-op unless Trace::isEnabled() */
+#define VETRACE(i, s, d, ch)           \
+    EffectTrace e_trace_(i, s, d, ch); \
+    e_trace_.save()
 #else
 #define VFTRACE(...) ATRACE_NAME(StringPrintf("Vibrator::%s", __func__).c_str())
 #define VETRACE(...)
@@ -78,7 +79,20 @@ DspMemChunk::DspMemChunk(uint8_t type, size_t size) : head(new uint8_t[size]{0x0
     waveformType = type;
     _current = head.get();
     _max = _current + size;
+    writeHeader();
+}
+
+void DspMemChunk::reset() {
+    VFTRACE();
+    memset(head.get(), 0, _max - head.get());
+    _current = head.get();
+    bytes = 0;
+    _cache = 0;
+    _cachebits = 0;
+    writeHeader();
+}
 
+void DspMemChunk::writeHeader() {
     if (waveformType == WAVEFORM_COMPOSE) {
         write(8, 0); /* Padding */
         write(8, 0); /* nsections placeholder */
@@ -100,31 +114,42 @@ DspMemChunk::DspMemChunk(uint8_t type, size_t size) : head(new uint8_t[size]{0x0
     }
 }
 
-int DspMemChunk::write(int nbits, uint32_t val) {
-    VFTRACE(nbits, val);
-    int nwrite;
-
-    nwrite = min(24 - _cachebits, nbits);
-    _cache <<= nwrite;
-    _cache |= val >> (nbits - nwrite);
-    _cachebits += nwrite;
-    nbits -= nwrite;
+/* Store one complete 24-bit word as 4 big-endian bytes (leading byte zero). */
+int DspMemChunk::emitWord(uint32_t word) {
+    if (isEnd())
+        return -ENOSPC;
 
-    if (_cachebits == 24) {
-        if (isEnd())
-            return -ENOSPC;
+    *_current++ = 0;
+    *_current++ = (word >> 16) & 0xFF;
+    *_current++ = (word >> 8) & 0xFF;
+    *_current++ = word & 0xFF;
 
-        _cache &= 0xFFFFFF;
-        for (size_t i = 0; i < sizeof(_cache); i++, _cache <<= 8)
-            *_current++ = (_cache & 0xFF000000) >> 24;
+    bytes += PWLE_WORD_SIZE;
+    _cache = 0;
+    _cachebits = 0;
+    return 0;
+}
 
-        bytes += sizeof(_cache);
-        _cachebits = 0;
+/*
+ * Deliberately untraced: this runs for every few bits of every segment and
+ * the trace-name formatting would dominate the packing work itself.
+ */
+int DspMemChunk::write(int nbits, uint32_t val) {
+    while (nbits) {
+        int nwrite = min(24 - _cachebits, nbits);
+
+        _cache <<= nwrite;
+        _cache |= val >> (nbits - nwrite);
+        _cachebits += nwrite;
+        nbits -= nwrite;
+
+        if (_cachebits == 24) {
+            int ret = emitWord(_cache & 0xFFFFFF);
+            if (ret < 0)
+                return ret;
+        }
     }
 
-    if (nbits)
-        return write(nbits, val);
-
     return 0;
 }
 
@@ -140,6 +165,19 @@ int DspMemChunk::fToU16(float input, uint16_t *output, float scale, float min, f
 void DspMemChunk::constructPwleSegment(uint16_t delay, uint16_t amplitude, uint16_t frequency,
                                        uint8_t flags, uint32_t vbemfTarget) {
     VFTRACE(delay, amplitude, frequency, flags, vbemfTarget);
+    if (_cachebits == 0) {
+        /* Word-aligned stream: a segment is exactly two (or three) words. */
+        if (emitWord((static_cast<uint32_t>(delay) << 8) | (amplitude >> 4)) < 0)
+            return;
+        /* feature flags to control the chirp, CLAB braking, back EMF amplitude regulation */
+        if (emitWord(((static_cast<uint32_t>(amplitude) & 0xF) << 20) |
+                     (static_cast<uint32_t>(frequency) << 8) | (((flags | 1) << 4) & 0xFF)) < 0)
+            return;
+        if (flags & PWLE_AMP_REG_BIT) {
+            emitWord(vbemfTarget & 0xFFFFFF); /* target back EMF voltage */
+        }
+        return;
+    }
     write(16, delay);
     write(12, amplitude);
     write(12, frequency);
@@ -169,6 +207,19 @@ int DspMemChunk::constructComposeSegment(uint32_t effectVolLevel, uint32_t effec
         ALOGE("%s: Invalid argument: %u, %u", __func__, effectVolLevel, effectIndex);
         return -EINVAL;
     }
+    if (_cachebits == 0) {
+        /*
+         * The compose stream stays word aligned (24-bit header, 48-bit
+         * segments), so pack each segment as two whole words instead of
+         * dribbling it through the bit cache.
+         */
+        int ret = emitWord((effectVolLevel << 16) | (effectIndex << 8) |
+                           repeat); /* amplitude, index, repeat */
+        if (ret == 0)
+            ret = emitWord((static_cast<uint32_t>(flags) << 16) |
+                           nextEffectDelay); /* flags, delay */
+        return ret;
+    }
     write(8, effectVolLevel);   /* amplitude */
     write(8, effectIndex);      /* index */
     write(8, repeat);           /* repeat */
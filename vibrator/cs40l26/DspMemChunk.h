@@ -71,6 +71,10 @@ class DspMemChunk {
     uint8_t type() const { return waveformType; }
     size_t size() const { return bytes; }
 
+    /* Rewind to a freshly written header so the allocation can be reused
+     * across compositions instead of constructing a new chunk per call. */
+    void reset();
+
     int flush();
 
     int constructComposeSegment(uint32_t effectVolLevel, uint32_t effectIndex, uint8_t repeat,
@@ -94,6 +98,8 @@ class DspMemChunk {
     bool isEnd() const { return _current == _max; }
     int min(int x, int y) { return x < y ? x : y; }
 
+    void writeHeader();
+    int emitWord(uint32_t word);
     int write(int nbits, uint32_t val);
 
     int fToU16(float input, uint16_t *output, float scale, float min, float max);
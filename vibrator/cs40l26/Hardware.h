@@ -16,6 +16,7 @@
 #pragma once
 
 #include <glob.h>
+#include <unistd.h>
 
 #include <algorithm>
 
@@ -128,6 +129,11 @@ class HwApi : public Vibrator::HwApi, private HwApiBase {
         // Scan /dev/input/event* to get the correct input device path for FF effects manipulation.
         // Then constructs the /sys/class/input/event*/../../../ for driver attributes accessing
         // across different platforms and different kernels.
+        // On dual-actuator builds (cs40l26-dual) this resolves the shared
+        // "cs40l26_dual_input" device: the kernel driver fans each EVIOCSFF
+        // upload and EV_FF trigger out to both DSPs itself, so one syscall
+        // reaches the pair and the HAL never issues serial per-actuator
+        // writes that could skew left/right onset.
         for (uint8_t retry = 1; retry < 11 && !mInputFd.ok(); retry++) {
             ret = glob(INPUT_EVENT_PATH.c_str(), 0, nullptr, &g);
             if (ret) {
@@ -195,12 +201,18 @@ class HwApi : public Vibrator::HwApi, private HwApiBase {
             ALOGE("Invalid gain");
             return false;
         }
-        mInputIoStream.write((const char *)&gain, sizeof(gain));
-        mInputIoStream.flush();
-        if (mInputIoStream.fail()) {
+        if (mLastGain == value) {
+            /* The device already carries this gain; skip the redundant write
+             * to keep the trigger path at a single syscall. */
+            return true;
+        }
+        if (TEMP_FAILURE_RETRY(::write(mInputFd, &gain, sizeof(gain))) !=
+            static_cast<ssize_t>(sizeof(gain))) {
             ALOGE("setFFGain fail");
+            mLastGain = -1;
             return false;
         }
+        mLastGain = value;
         HWAPI_RECORD(StringPrintf("%d%%", value), &mInputIoStream);
         return true;
     }
@@ -224,9 +236,10 @@ class HwApi : public Vibrator::HwApi, private HwApiBase {
                 .code = static_cast<uint16_t>(index),
                 .value = value,
         };
-        mInputIoStream.write((const char *)&play, sizeof(play));
-        mInputIoStream.flush();
-        if (mInputIoStream.fail()) {
+        /* Write the event fd directly: one syscall, no stream buffering or
+         * flush on the click-to-buzz trigger path. */
+        if (TEMP_FAILURE_RETRY(::write(mInputFd, &play, sizeof(play))) !=
+            static_cast<ssize_t>(sizeof(play))) {
             ALOGE("setFFPlay fail");
             return false;
         }
@@ -445,6 +458,8 @@ class HwApi : public Vibrator::HwApi, private HwApiBase {
     std::ofstream mInputIoStream;
     std::ofstream mPcmStream;
     ::android::base::unique_fd mInputFd;
+    /* Last gain delivered to the device; -1 when unknown. */
+    int32_t mLastGain = -1;
 
     // DBC Parameters
     std::ofstream mDbcEnvRelCoef;
@@ -19,8 +19,12 @@
 #include <utils/Trace.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 
 #include "Hardware.h"
 #include "StatsBase.h"
@@ -140,7 +144,25 @@ class StatsApi : public Vibrator::StatsApi, private StatsBase {
         mMaxLatencies = std::vector<int32_t>(kEffectLatencyCount, 0);
         mLatencyTotals = std::vector<int32_t>(kEffectLatencyCount, 0);
         mLatencyCounts = std::vector<int32_t>(kEffectLatencyCount, 0);
+        mLatencyHistograms =
+                std::vector<int32_t>(kEffectLatencyCount * kLatencyHistogramBuckets, 0);
         mErrorCounts = std::vector<int32_t>(kVibratorErrorCount, 0);
+        for (uint32_t i = 0; i < kEventRingSize; i++) {
+            mEventRing[i].seq.store(i, std::memory_order_relaxed);
+        }
+        mFlusherThread = std::thread(&StatsApi::runFlusherThread, this);
+    }
+
+    ~StatsApi() override {
+        {
+            std::scoped_lock<std::mutex> lock(mFlusherAccess);
+            mTerminateFlusherThread = true;
+        }
+        mFlusherRun.notify_all();
+        if (mFlusherThread.joinable()) {
+            mFlusherThread.join();
+        }
+        drainEvents();
     }
 
     bool logPrimitive(uint16_t effectIndex) override {
@@ -153,12 +175,7 @@ class StatsApi : public Vibrator::StatsApi, private StatsBase {
             return false;
         }
 
-        {
-            std::scoped_lock<std::mutex> lock(mDataAccess);
-            mWaveformCounts[effectIndex]++;
-        }
-
-        return true;
+        return pushEvent(kEventPrimitive, effectIndex, 0);
     }
 
     bool logWaveform(uint16_t effectIndex, int32_t duration) override {
@@ -176,17 +193,7 @@ class StatsApi : public Vibrator::StatsApi, private StatsBase {
             return false;
         }
 
-        {
-            std::scoped_lock<std::mutex> lock(mDataAccess);
-            mWaveformCounts[effectIndex]++;
-            if (duration < DURATION_BUCKET_WIDTH * DURATION_50MS_BUCKET_COUNT) {
-                mDurationCounts[duration / DURATION_BUCKET_WIDTH]++;
-            } else {
-                mDurationCounts[DURATION_50MS_BUCKET_COUNT]++;
-            }
-        }
-
-        return true;
+        return pushEvent(kEventWaveform, effectIndex, duration);
     }
 
     bool logError(uint16_t errorIndex) override {
@@ -197,12 +204,7 @@ class StatsApi : public Vibrator::StatsApi, private StatsBase {
             return false;
         }
 
-        {
-            std::scoped_lock<std::mutex> lock(mDataAccess);
-            mErrorCounts[errorIndex]++;
-        }
-
-        return true;
+        return pushEvent(kEventError, errorIndex, 0);
     }
 
     bool logLatencyStart(uint16_t latencyIndex) override {
@@ -230,28 +232,140 @@ class StatsApi : public Vibrator::StatsApi, private StatsBase {
                                    std::chrono::steady_clock::now() - mCurrentLatencyStart))
                                   .count();
 
-        {
-            std::scoped_lock<std::mutex> lock(mDataAccess);
-            if (latency < mMinLatencies[mCurrentLatencyIndex] ||
-                mMinLatencies[mCurrentLatencyIndex] == 0) {
-                mMinLatencies[mCurrentLatencyIndex] = latency;
-            }
-            if (latency > mMaxLatencies[mCurrentLatencyIndex]) {
-                mMaxLatencies[mCurrentLatencyIndex] = latency;
+        bool ret = pushEvent(kEventLatency, mCurrentLatencyIndex, latency);
+
+        mCurrentLatencyIndex = kEffectLatencyCount;
+        return ret;
+    }
+
+    void debug(int fd) override {
+        drainEvents();
+        StatsBase::debug(fd);
+    }
+
+  private:
+    /*
+     * Recording on the trigger path appends one POD event to a bounded ring
+     * (slot claimed with an atomic counter, published with the slot sequence)
+     * and takes no lock; the flusher thread folds the events into the
+     * aggregates that the reporter uploads.
+     */
+    enum EventType : uint16_t {
+        kEventPrimitive = 0,
+        kEventWaveform,
+        kEventError,
+        kEventLatency,
+    };
+
+    struct StatsEvent {
+        uint16_t type;
+        uint16_t index;
+        int32_t value;
+    };
+
+    struct EventSlot {
+        std::atomic<uint32_t> seq;
+        StatsEvent event;
+    };
+
+    static constexpr uint32_t kEventRingSize = 1024; /* power of two */
+
+    bool pushEvent(uint16_t type, uint16_t index, int32_t value) {
+        uint32_t pos = mEventHead.load(std::memory_order_relaxed);
+        for (;;) {
+            EventSlot &slot = mEventRing[pos & (kEventRingSize - 1)];
+            uint32_t seq = slot.seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (mEventHead.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.event = {type, index, value};
+                    slot.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                /* Ring full; drop rather than stall the trigger path. */
+                if (mDroppedEvents.fetch_add(1, std::memory_order_relaxed) == 0) {
+                    ALOGW("Stats event ring full, dropping events");
+                }
+                return false;
+            } else {
+                pos = mEventHead.load(std::memory_order_relaxed);
             }
-            mLatencyTotals[mCurrentLatencyIndex] += latency;
-            mLatencyCounts[mCurrentLatencyIndex]++;
         }
+    }
 
-        mCurrentLatencyIndex = kEffectLatencyCount;
+    /* Single consumer: only the flusher thread and teardown call this. */
+    bool popEvent(StatsEvent *event) {
+        EventSlot &slot = mEventRing[mEventTail & (kEventRingSize - 1)];
+        uint32_t seq = slot.seq.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(mEventTail + 1) < 0) {
+            return false;
+        }
+        *event = slot.event;
+        slot.seq.store(mEventTail + kEventRingSize, std::memory_order_release);
+        mEventTail++;
         return true;
     }
 
-    void debug(int fd) override { StatsBase::debug(fd); }
+    void drainEvents() {
+        StatsEvent event;
+        std::vector<StatsEvent> batch;
+        while (popEvent(&event)) {
+            batch.emplace_back(event);
+        }
+        if (batch.empty()) {
+            return;
+        }
+
+        std::scoped_lock<std::mutex> lock(mDataAccess);
+        for (const auto &e : batch) {
+            switch (e.type) {
+                case kEventPrimitive:
+                    mWaveformCounts[e.index]++;
+                    break;
+                case kEventWaveform:
+                    mWaveformCounts[e.index]++;
+                    if (e.value < DURATION_BUCKET_WIDTH * DURATION_50MS_BUCKET_COUNT) {
+                        mDurationCounts[e.value / DURATION_BUCKET_WIDTH]++;
+                    } else {
+                        mDurationCounts[DURATION_50MS_BUCKET_COUNT]++;
+                    }
+                    break;
+                case kEventError:
+                    mErrorCounts[e.index]++;
+                    break;
+                case kEventLatency:
+                    recordLatencyLocked(e.index, e.value);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    void runFlusherThread() {
+        std::unique_lock<std::mutex> lock(mFlusherAccess);
+        while (!mTerminateFlusherThread) {
+            lock.unlock();
+            drainEvents();
+            lock.lock();
+            mFlusherRun.wait_for(lock, std::chrono::seconds(1),
+                                 [this] { return mTerminateFlusherThread; });
+        }
+    }
 
-  private:
     uint16_t mCurrentLatencyIndex;
     std::chrono::time_point<std::chrono::steady_clock> mCurrentLatencyStart;
+
+    std::array<EventSlot, kEventRingSize> mEventRing;
+    std::atomic<uint32_t> mEventHead{0};
+    uint32_t mEventTail = 0;
+    std::atomic<uint32_t> mDroppedEvents{0};
+
+    std::thread mFlusherThread;
+    std::mutex mFlusherAccess;
+    std::condition_variable mFlusherRun;
+    bool mTerminateFlusherThread = false;
 };
 
 }  // namespace vibrator
@@ -17,7 +17,11 @@
 #include "Trace.h"
 
 #include <aidl/android/hardware/vibrator/BnVibrator.h>
+#include <android-base/properties.h>
 #include <log/log.h>
+#include <sys/system_properties.h>
+
+#include <atomic>
 
 namespace aidl {
 namespace android {
@@ -132,10 +136,29 @@ std::ostream &operator<<(std::ostream &out, EffectStrength arg) {
 
 /* Trace Interface */
 
+static constexpr char TRACE_ENABLE_PROP[] = "vendor.vibrator.hal.trace.enable";
+
 int Trace::mDepth = -1;
 std::vector<std::string> Trace::mTrace = {};
 std::vector<std::vector<std::string>> Trace::mPreviousTraces = {};
 
+bool Trace::isEnabled() {
+    static std::atomic<uint32_t> sCachedSerial{0};
+    static std::atomic<bool> sCachedEnabled{false};
+
+    /* The property area serial bumps on any property change; only then is the
+     * flag actually re-read. Ordering between the two cells does not matter:
+     * the worst case is one extra property read.
+     */
+    uint32_t serial = __system_property_area_serial();
+    if (serial != sCachedSerial.load(std::memory_order_relaxed)) {
+        sCachedEnabled.store(::android::base::GetBoolProperty(TRACE_ENABLE_PROP, false),
+                             std::memory_order_relaxed);
+        sCachedSerial.store(serial, std::memory_order_relaxed);
+    }
+    return sCachedEnabled.load(std::memory_order_relaxed);
+}
+
 void Trace::debug(int fd) {
     std::vector<std::string> tTrace;
     std::swap(mTrace, tTrace);
@@ -160,20 +183,29 @@ void Trace::debug(int fd) {
 
 /* FunctionTrace Interface */
 
-FunctionTrace::FunctionTrace(const char *funcName) : mClassName(""), mFuncName(funcName) {
-    Trace::enter();
-}
+FunctionTrace::FunctionTrace(const char *funcName) : FunctionTrace("", funcName) {}
 
 FunctionTrace::FunctionTrace(const char *className, const char *funcName)
-    : mClassName(className), mFuncName(funcName) {
+    : mActive(Trace::isEnabled()) {
+    if (!mActive) {
+        return;
+    }
+    mClassName = className;
+    mFuncName = funcName;
     Trace::enter();
 }
 
 FunctionTrace::~FunctionTrace() {
-    Trace::exit();
+    if (mActive) {
+        Trace::exit();
+    }
 }
 
 void FunctionTrace::save() {
+    if (!mActive) {
+        return;
+    }
+
     std::stringstream fmt;
     int d = Trace::depth();
     for (int i = 0; i < d; i++) {
@@ -201,7 +233,12 @@ void FunctionTrace::save() {
 
 /* Effect Trace Implementation */
 
-EffectTrace::EffectTrace(uint16_t index, float scale, int32_t duration, const DspMemChunk *ch) {
+EffectTrace::EffectTrace(uint16_t index, float scale, int32_t duration, const DspMemChunk *ch)
+    : mActive(Trace::isEnabled()) {
+    if (!mActive) {
+        return;
+    }
+
     std::stringstream fmt;
     fmt << "Effect(";
     switch (index) {
@@ -238,6 +275,10 @@ EffectTrace::EffectTrace(uint16_t index, float scale, int32_t duration, const Ds
 }
 
 void EffectTrace::save() {
+    if (!mActive) {
+        return;
+    }
+
     std::stringstream fmt;
     for (int i = 0; i < depth(); i++) {
         fmt << "   ";
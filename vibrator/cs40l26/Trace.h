@@ -169,6 +169,12 @@ std::ostream &operator<<(std::ostream &out, EffectStrength arg);
 
 class Trace {
   public:
+    /* Runtime gate for the scoped traces below. Reads a cached copy of
+     * vendor.vibrator.hal.trace.enable and only re-reads the property when the
+     * system property area has changed, so the steady-state cost on the
+     * perform() path is a couple of relaxed atomic loads.
+     */
+    static bool isEnabled();
     static void debug(int fd);
     static int depth() { return mDepth; }
     static void enter() { mDepth++; }
@@ -195,6 +201,9 @@ class FunctionTrace : public Trace {
 
     template <typename T>
     void addParameter(std::pair<const char *, T> t) {
+        if (!mActive) {
+            return;
+        }
         std::stringstream fmt;
         fmt << TypeName<T>::Get() << " " << t.first << ":" << t.second;
         mParameters.push_back(fmt.str());
@@ -211,6 +220,8 @@ class FunctionTrace : public Trace {
     void save();
 
   private:
+    // Sampled at construction; when false this instance does no work at all
+    bool mActive;
     std::string mClassName;
     std::string mFuncName;
     std::vector<std::string> mParameters;
@@ -222,6 +233,7 @@ class EffectTrace : public Trace {
     void save();
 
   private:
+    bool mActive;
     std::string mDescription;
 };
 
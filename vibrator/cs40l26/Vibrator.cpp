@@ -27,6 +27,7 @@
 #include <chrono>
 #include <cinttypes>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -50,16 +51,16 @@ namespace hardware {
 namespace vibrator {
 
 #ifdef VIBRATOR_TRACE
-/* Function Trace */
-#define VFTRACE(...)                                                             \
-    ATRACE_NAME(StringPrintf("Vibrator::%s", __func__).c_str());                 \
-    auto f_trace_ = std::make_unique<FunctionTrace>("Vibrator", __func__);       \
-    __VA_OPT__(f_trace_->addParameter(PREPEND_EACH_ARG_WITH_NAME(__VA_ARGS__))); \
-    f_trace_->save()
-/* Effect Trace */
-#define VETRACE(i, s, d, ch)                                    \
-    auto e_trace_ = std::make_unique<EffectTrace>(i, s, d, ch); \
-    e_trace_->save()
+/* Function Trace. Stack-constructed; a no-op unless Trace::isEnabled() */
+#define VFTRACE(...)                                                            \
+    ATRACE_NAME(StringPrintf("Vibrator::%s", __func__).c_str());                \
+    FunctionTrace f_trace_("Vibrator", __func__);                               \
+    __VA_OPT__(f_trace_.addParameter(PREPEND_EACH_ARG_WITH_NAME(__VA_ARGS__))); \
+    f_trace_.save()
+/* Effect Trace. Stack-constructed; a no-op unless Trace::isEnabled() */
+#define VETRACE(i, s, d, ch)           \
+    EffectTrace e_trace_(i, s, d, ch); \
+    e_trace_.save()
 #else
 #define VFTRACE(...) ATRACE_NAME(StringPrintf("Vibrator::%s", __func__).c_str())
 #define VETRACE(...)
@@ -79,6 +80,9 @@ static constexpr uint32_t MIN_ON_OFF_INTERVAL_US = 8500;  // SVC initialization
 static constexpr int8_t MAX_PAUSE_TIMING_ERROR_MS = 1;    // ALERT Irq Handling
 static constexpr uint32_t MAX_TIME_MS = UINT16_MAX;
 
+/* Boot-scoped calibration snapshot shared between HAL instances. */
+static constexpr char CAL_CACHE_PROP[] = "vendor.vibrator.hal.cal.cache";
+
 static constexpr auto ASYNC_COMPLETION_TIMEOUT = std::chrono::milliseconds(100);
 static constexpr auto POLLING_TIMEOUT = 50;  // POLLING_TIMEOUT < ASYNC_COMPLETION_TIMEOUT
 static constexpr int32_t COMPOSE_DELAY_MAX_MS = 10000;
@@ -239,22 +243,63 @@ Vibrator::Vibrator(std::unique_ptr<HwApi> hwapi, std::unique_ptr<HwCal> hwcal,
         }
     }
 
-    if (mHwCal->getF0(&caldata)) {
-        mHwApi->setF0(caldata);
+    /*
+     * The driver retains the stored calibration until reboot, so a restarted
+     * HAL can skip the f0/redc/q re-write handshake when a previous instance
+     * already delivered it this boot. The snapshot lives in a non-persist
+     * vendor property, which the (tmpfs-backed) property area clears on
+     * reboot, scoping it to the current driver state.
+     */
+    auto isHex = [](const std::string &s) {
+        return s.find_first_not_of("0123456789abcdefABCDEF") == std::string::npos;
+    };
+    std::string f0Cal, redcCal, qCal;
+    bool calRestored = false;
+    uint32_t driverEffectCount;
+    const std::string calCache = ::android::base::GetProperty(CAL_CACHE_PROP, "");
+    if (!calCache.empty() && mHwApi->getEffectCount(&driverEffectCount)) {
+        std::stringstream ss(calCache);
+        std::getline(ss, f0Cal, ',');
+        std::getline(ss, redcCal, ',');
+        std::getline(ss, qCal, ',');
+        if (isHex(f0Cal) && isHex(redcCal) && isHex(qCal)) {
+            calRestored = true;
+            ALOGI("Restored calibration snapshot, skipping the driver handshake");
+        } else {
+            ALOGW("Discarding a malformed calibration snapshot: %s", calCache.c_str());
+            f0Cal.clear();
+            redcCal.clear();
+            qCal.clear();
+        }
+    }
+
+    if (!calRestored) {
+        if (mHwCal->getF0(&caldata)) {
+            mHwApi->setF0(caldata);
+            f0Cal = caldata;
+        }
+        if (mHwCal->getRedc(&caldata)) {
+            mHwApi->setRedc(caldata);
+            redcCal = caldata;
+        }
+        if (mHwCal->getQ(&caldata)) {
+            mHwApi->setQ(caldata);
+            qCal = caldata;
+        }
+        ::android::base::SetProperty(CAL_CACHE_PROP, f0Cal + "," + redcCal + "," + qCal);
+    }
+
+    if (!f0Cal.empty()) {
         mResonantFrequency =
-                static_cast<float>(std::stoul(caldata, nullptr, 16)) / (1 << Q14_BIT_SHIFT);
+                static_cast<float>(std::stoul(f0Cal, nullptr, 16)) / (1 << Q14_BIT_SHIFT);
     } else {
         mStatsApi->logError(kHwCalError);
         ALOGE("Failed to get resonant frequency (%d): %s, using default resonant HZ: %f", errno,
               strerror(errno), RESONANT_FREQUENCY_DEFAULT);
         mResonantFrequency = RESONANT_FREQUENCY_DEFAULT;
     }
-    if (mHwCal->getRedc(&caldata)) {
-        mHwApi->setRedc(caldata);
-        mRedc = redcToFloat(&caldata);
-    }
-    if (mHwCal->getQ(&caldata)) {
-        mHwApi->setQ(caldata);
+    if (!redcCal.empty()) {
+        mRedc = redcToFloat(&redcCal);
     }
 
     mHwCal->getLongFrequencyShift(&longFrequencyShift);
@@ -280,6 +325,8 @@ Vibrator::Vibrator(std::unique_ptr<HwApi> hwapi, std::unique_ptr<HwCal> hwcal,
 
     mHasPassthroughHapticDevice = mHwApi->isPassthroughI2sHapticSupported();
 
+    mOwtCacheEnabled = ::android::base::GetBoolProperty("ro.vendor.vibrator.hal.owt_cache", false);
+
     mIsUnderExternalControl = false;
 
     mIsChirpEnabled = mHwCal->isChirpEnabled();
@@ -300,6 +347,7 @@ Vibrator::Vibrator(std::unique_ptr<HwApi> hwapi, std::unique_ptr<HwCal> hwcal,
 
     mHwApi->setMinOnOffInterval(MIN_ON_OFF_INTERVAL_US);
 
+    createSimpleEffectTable();
     createPwleMaxLevelLimitMap();
     createBandwidthAmplitudeMap();
 
@@ -361,8 +409,10 @@ ndk::ScopedAStatus Vibrator::off() {
         }
         halState = STOPPED;
 
-        if ((mActiveId >= WAVEFORM_MAX_PHYSICAL_INDEX) &&
-            (!mHwApi->eraseOwtEffect(mActiveId, &mFfEffects))) {
+        if ((mActiveId >= WAVEFORM_MAX_PHYSICAL_INDEX) && (mActiveId == mResidentOwtId)) {
+            ALOGV("Keep the cached effect %d resident", mActiveId);
+        } else if ((mActiveId >= WAVEFORM_MAX_PHYSICAL_INDEX) &&
+                   (!mHwApi->eraseOwtEffect(mActiveId, &mFfEffects))) {
             mStatsApi->logError(kHwApiError);
             ALOGE("Failed to clean up the composed effect %d", mActiveId);
             ret = false;
@@ -503,6 +553,24 @@ ndk::ScopedAStatus Vibrator::getPrimitiveDuration(CompositePrimitive primitive,
     return ndk::ScopedAStatus::ok();
 }
 
+/* FNV-1a over the request fields that determine the compiled OWT image. */
+static uint64_t hashComposite(const std::vector<CompositeEffect> &composite) {
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](uint32_t value) {
+        for (size_t i = 0; i < sizeof(value); i++, value >>= 8) {
+            hash = (hash ^ (value & 0xFF)) * 1099511628211ULL;
+        }
+    };
+    for (const auto &e : composite) {
+        uint32_t scaleBits;
+        memcpy(&scaleBits, &e.scale, sizeof(scaleBits));
+        mix(static_cast<uint32_t>(e.primitive));
+        mix(scaleBits);
+        mix(static_cast<uint32_t>(e.delayMs));
+    }
+    return hash ? hash : 1;
+}
+
 ndk::ScopedAStatus Vibrator::compose(const std::vector<CompositeEffect> &composite,
                                      const std::shared_ptr<IVibratorCallback> &callback) {
     VFTRACE(composite, callback);
@@ -531,6 +599,26 @@ ndk::ScopedAStatus Vibrator::compose(const std::vector<CompositeEffect> &composi
         size = composite.size();
     }
 
+    if (mOwtCacheEnabled) {
+        const uint64_t patternHash = hashComposite(composite);
+        int32_t residentId = -1;
+        {
+            const std::scoped_lock<std::mutex> lock(mActiveId_mutex);
+            if (patternHash == mResidentOwtHash && mResidentOwtId >= 0 &&
+                composite == mResidentOwtPattern) {
+                residentId = mResidentOwtId;
+            }
+        }
+        if (residentId >= 0) {
+            /* The identical pattern is still resident in the DSP; skip the
+             * compose and upload entirely and just replay it. */
+            mFfEffects[WAVEFORM_COMPOSE].replay.length = 0;
+            return performEffect(residentId, VOLTAGE_SCALE_MAX, nullptr /*ch*/, callback);
+        }
+        mPendingOwtHash = patternHash;
+        mPendingOwtPattern = composite;
+    }
+
     DspMemChunk ch(WAVEFORM_COMPOSE, FF_CUSTOM_DATA_LEN_MAX_COMP);
     const uint8_t header_count = ch.size();
 
@@ -607,6 +695,7 @@ ndk::ScopedAStatus Vibrator::on(uint32_t timeoutMs, uint32_t effectIndex, const
                                 const std::shared_ptr<IVibratorCallback> &callback) {
     VFTRACE(timeoutMs, effectIndex, ch, callback);
     ndk::ScopedAStatus status = ndk::ScopedAStatus::ok();
+    uint64_t pendingHash = 0;
 
     if (effectIndex >= FF_MAX_EFFECTS) {
         mStatsApi->logError(kBadEffectError);
@@ -634,6 +723,21 @@ ndk::ScopedAStatus Vibrator::on(uint32_t timeoutMs, uint32_t effectIndex, const
         }
         effectIndex = ch->type();
 
+        pendingHash = mPendingOwtHash;
+        mPendingOwtHash = 0;
+        if (mOwtCacheEnabled) {
+            /* A different pattern is coming in; retire the resident effect so
+             * its OWT memory can be reclaimed before the new upload. */
+            const std::scoped_lock<std::mutex> lock(mActiveId_mutex);
+            if (mResidentOwtId >= 0 && !mHwApi->eraseOwtEffect(mResidentOwtId, &mFfEffects)) {
+                mStatsApi->logError(kHwApiError);
+                ALOGE("Failed to retire the cached effect %d", mResidentOwtId);
+            }
+            mResidentOwtId = -1;
+            mResidentOwtHash = 0;
+            mResidentOwtPattern.clear();
+        }
+
         uint32_t freeBytes;
         mHwApi->getOwtFreeSpace(&freeBytes);
         if (ch->size() > freeBytes) {
@@ -662,6 +766,12 @@ ndk::ScopedAStatus Vibrator::on(uint32_t timeoutMs, uint32_t effectIndex, const
     }
 
     const std::scoped_lock<std::mutex> lock(mActiveId_mutex);
+    if (mOwtCacheEnabled && ch && ch->type() == WAVEFORM_COMPOSE && pendingHash) {
+        /* Keep the freshly uploaded composition resident for replay. */
+        mResidentOwtId = effectIndex;
+        mResidentOwtHash = pendingHash;
+        mResidentOwtPattern = std::move(mPendingOwtPattern);
+    }
     mActiveId = effectIndex;
     /* Play the event now. */
     VETRACE(effectIndex, mLongEffectScale, timeoutMs, ch);
@@ -1306,6 +1416,8 @@ binder_status_t Vibrator::dump(int fd, const char **args, uint32_t numArgs) {
         }
         dprintf(fd, "\t%d\t%d\t{%s}\n", mFfEffects[effectId].id, numBytes, ss.str().c_str());
     }
+    dprintf(fd, "    OWT Cache: %s, Resident ID: %" PRId32 ", Hash: %016" PRIx64 "\n",
+            mOwtCacheEnabled ? "enabled" : "disabled", mResidentOwtId, mResidentOwtHash);
 
     dprintf(fd, "\n");
 
@@ -1432,6 +1544,25 @@ ndk::ScopedAStatus Vibrator::getSimpleDetails(Effect effect, EffectStrength stre
                                               uint32_t *outEffectIndex, uint32_t *outTimeMs,
                                               uint32_t *outVolLevel) {
     VFTRACE(effect, strength, outEffectIndex, outTimeMs, outVolLevel);
+    const auto e = static_cast<size_t>(effect);
+    const auto s = static_cast<size_t>(strength);
+    if (e >= mSimpleEffectTable.size() || s >= mSimpleEffectTable[e].size() ||
+        !mSimpleEffectTable[e][s].valid) {
+        mStatsApi->logError(kUnsupportedOpError);
+        return ndk::ScopedAStatus::fromExceptionCode(EX_UNSUPPORTED_OPERATION);
+    }
+
+    const SimpleEffectSlot &slot = mSimpleEffectTable[e][s];
+    *outEffectIndex = slot.effectIndex;
+    *outTimeMs = slot.timeMs;
+    *outVolLevel = slot.volLevel;
+    return ndk::ScopedAStatus::ok();
+}
+
+ndk::ScopedAStatus Vibrator::computeSimpleDetails(Effect effect, EffectStrength strength,
+                                                  uint32_t *outEffectIndex, uint32_t *outTimeMs,
+                                                  uint32_t *outVolLevel) {
+    VFTRACE(effect, strength, outEffectIndex, outTimeMs, outVolLevel);
     uint32_t effectIndex;
     uint32_t timeMs;
     float intensity;
@@ -1482,6 +1613,27 @@ ndk::ScopedAStatus Vibrator::getSimpleDetails(Effect effect, EffectStrength stre
     return ndk::ScopedAStatus::ok();
 }
 
+void Vibrator::createSimpleEffectTable() {
+    VFTRACE();
+    constexpr std::array<Effect, 4> effects = {Effect::TEXTURE_TICK, Effect::TICK, Effect::CLICK,
+                                               Effect::HEAVY_CLICK};
+    constexpr std::array<EffectStrength, 3> strengths = {
+            EffectStrength::LIGHT, EffectStrength::MEDIUM, EffectStrength::STRONG};
+
+    for (auto effect : effects) {
+        for (auto strength : strengths) {
+            SimpleEffectSlot slot;
+            if (computeSimpleDetails(effect, strength, &slot.effectIndex, &slot.timeMs,
+                                     &slot.volLevel)
+                        .isOk()) {
+                slot.valid = true;
+                mSimpleEffectTable[static_cast<size_t>(effect)][static_cast<size_t>(strength)] =
+                        slot;
+            }
+        }
+    }
+}
+
 ndk::ScopedAStatus Vibrator::getCompoundDetails(Effect effect, EffectStrength strength,
                                                 uint32_t *outTimeMs, DspMemChunk *outCh) {
     VFTRACE(effect, strength, outTimeMs, outCh);
@@ -1642,19 +1794,27 @@ void Vibrator::waitForComplete(std::shared_ptr<IVibratorCallback> &&callback) {
 
     const std::scoped_lock<std::mutex> lock(mActiveId_mutex);
     uint32_t effectCount = WAVEFORM_MAX_PHYSICAL_INDEX;
-    if ((mActiveId >= WAVEFORM_MAX_PHYSICAL_INDEX) &&
-        (!mHwApi->eraseOwtEffect(mActiveId, &mFfEffects))) {
+    if ((mActiveId >= WAVEFORM_MAX_PHYSICAL_INDEX) && (mActiveId == mResidentOwtId)) {
+        ALOGV("waitForComplete: keep the cached effect %d resident", mActiveId);
+    } else if ((mActiveId >= WAVEFORM_MAX_PHYSICAL_INDEX) &&
+               (!mHwApi->eraseOwtEffect(mActiveId, &mFfEffects))) {
         mStatsApi->logError(kHwApiError);
         ALOGE("Failed to clean up the composed effect %d", mActiveId);
     } else {
         ALOGD("waitForComplete: Vibrator is already off");
     }
     mHwApi->getEffectCount(&effectCount);
-    // Do waveform number checking
-    if ((effectCount > WAVEFORM_MAX_PHYSICAL_INDEX) &&
-        (!mHwApi->eraseOwtEffect(WAVEFORM_MAX_INDEX, &mFfEffects))) {
-        mStatsApi->logError(kHwApiError);
-        ALOGE("Failed to forcibly clean up all composed effect");
+    // Do waveform number checking, leaving room for the cached effect
+    const uint32_t residentCount = (mResidentOwtId >= 0) ? 1 : 0;
+    if (effectCount > WAVEFORM_MAX_PHYSICAL_INDEX + residentCount) {
+        if (!mHwApi->eraseOwtEffect(WAVEFORM_MAX_INDEX, &mFfEffects)) {
+            mStatsApi->logError(kHwApiError);
+            ALOGE("Failed to forcibly clean up all composed effect");
+        }
+        /* The flush wipes every non-prestored effect, cached one included. */
+        mResidentOwtId = -1;
+        mResidentOwtHash = 0;
+        mResidentOwtPattern.clear();
     }
 
     mActiveId = -1;
@@ -221,6 +221,11 @@ class Vibrator : public BnVibrator {
     ndk::ScopedAStatus getSimpleDetails(Effect effect, EffectStrength strength,
                                         uint32_t *outEffectIndex, uint32_t *outTimeMs,
                                         uint32_t *outVolLevel);
+    // resolves one (effect, strength) pair; feeds the table built at init
+    ndk::ScopedAStatus computeSimpleDetails(Effect effect, EffectStrength strength,
+                                            uint32_t *outEffectIndex, uint32_t *outTimeMs,
+                                            uint32_t *outVolLevel);
+    void createSimpleEffectTable();
     // 'compound' effects are those composed by stringing multiple 'simple' effects
     ndk::ScopedAStatus getCompoundDetails(Effect effect, EffectStrength strength,
                                           uint32_t *outTimeMs, class DspMemChunk *outCh);
@@ -252,9 +257,31 @@ class Vibrator : public BnVibrator {
     std::array<uint32_t, 2> mLongEffectVol;
     std::vector<ff_effect> mFfEffects;
     std::vector<uint32_t> mEffectDurations;
+    // Ready-to-trigger descriptors for every supported (effect, strength)
+    // pair, resolved once at construction so the first perform() after boot
+    // pays no resolution cost.
+    struct SimpleEffectSlot {
+        bool valid{false};
+        uint32_t effectIndex{0};
+        uint32_t timeMs{0};
+        uint32_t volLevel{0};
+    };
+    std::array<std::array<SimpleEffectSlot, 3>, static_cast<size_t>(Effect::TEXTURE_TICK) + 1>
+            mSimpleEffectTable{};
     std::vector<std::vector<int16_t>> mEffectCustomData;
     std::future<void> mAsyncHandle;
     int8_t mActiveId{-1};
+    // Depth-1 cache of the most recently composed OWT effect. While the
+    // compiled pattern stays resident in the DSP it is replayed without
+    // recomposing or re-uploading. Resident state is guarded by the
+    // mActiveId lock; the pending fields only pass the pattern identity from
+    // compose() to the upload in on() on the same call path.
+    bool mOwtCacheEnabled{false};
+    int32_t mResidentOwtId{-1};
+    uint64_t mResidentOwtHash{0};
+    std::vector<CompositeEffect> mResidentOwtPattern;
+    uint64_t mPendingOwtHash{0};
+    std::vector<CompositeEffect> mPendingOwtPattern;
     struct pcm *mHapticPcm;
     int mCard;
     int mDevice;
@@ -0,0 +1,175 @@
+/* * Copyright (C) 2022 The Android Open Source Project *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark/benchmark.h"
+
+#include <gmock/gmock.h>
+
+#include "../tests/mocks.h"
+#include "Vibrator.h"
+
+namespace aidl {
+namespace android {
+namespace hardware {
+namespace vibrator {
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+
+/*
+ * The driver interface is mocked out, so these measure the HAL's own
+ * per-call overhead: argument validation, scale math, OWT packet
+ * construction and stats bookkeeping, without sysfs or I2C latency.
+ */
+class VibratorBench : public benchmark::Fixture {
+  private:
+    static constexpr uint32_t CAL_VERSION = 2;
+    static constexpr std::array<uint32_t, 2> V_LEVELS_DEFAULT = {1, 100};
+    static constexpr uint32_t OWT_BYTES_FREE = 11504;
+    /* First index past the physical waveform bank; where OWT uploads land. */
+    static constexpr uint32_t WAVEFORM_COMPOSE_INDEX = 14;
+
+  public:
+    void SetUp(::benchmark::State & /*state*/) override {
+        auto hwapi = std::make_unique<NiceMock<MockApi>>();
+        auto hwcal = std::make_unique<NiceMock<MockCal>>();
+        auto stats = std::make_unique<NiceMock<MockStats>>();
+
+        ON_CALL(*hwapi, initFF()).WillByDefault(Return(true));
+        ON_CALL(*hwapi, setFFGain(_)).WillByDefault(Return(true));
+        ON_CALL(*hwapi, setFFEffect(_, _)).WillByDefault(Return(true));
+        ON_CALL(*hwapi, setFFPlay(_, _)).WillByDefault(Return(true));
+        ON_CALL(*hwapi, pollVibeState(_, _)).WillByDefault(Return(true));
+        ON_CALL(*hwapi, getOwtFreeSpace(_))
+                .WillByDefault(DoAll(SetArgPointee<0>(OWT_BYTES_FREE), Return(true)));
+        ON_CALL(*hwapi, uploadOwtEffect(_, _, _, _, _))
+                .WillByDefault(DoAll(SetArgPointee<3>(WAVEFORM_COMPOSE_INDEX),
+                                     SetArgPointee<4>(0), Return(true)));
+        ON_CALL(*hwapi, eraseOwtEffect(_, _)).WillByDefault(Return(true));
+
+        ON_CALL(*hwcal, getVersion(_))
+                .WillByDefault(DoAll(SetArgPointee<0>(CAL_VERSION), Return(true)));
+        ON_CALL(*hwcal, getTickVolLevels(_))
+                .WillByDefault(DoAll(SetArgPointee<0>(V_LEVELS_DEFAULT), Return(true)));
+        ON_CALL(*hwcal, getClickVolLevels(_))
+                .WillByDefault(DoAll(SetArgPointee<0>(V_LEVELS_DEFAULT), Return(true)));
+        ON_CALL(*hwcal, getLongVolLevels(_))
+                .WillByDefault(DoAll(SetArgPointee<0>(V_LEVELS_DEFAULT), Return(true)));
+
+        ON_CALL(*stats, logPrimitive(_)).WillByDefault(Return(true));
+        ON_CALL(*stats, logWaveform(_, _)).WillByDefault(Return(true));
+        ON_CALL(*stats, logError(_)).WillByDefault(Return(true));
+        ON_CALL(*stats, logLatencyStart(_)).WillByDefault(Return(true));
+        ON_CALL(*stats, logLatencyEnd()).WillByDefault(Return(true));
+
+        mVibrator = ndk::SharedRefBase::make<Vibrator>(std::move(hwapi), std::move(hwcal),
+                                                       std::move(stats));
+    }
+
+    static void DefaultArgs(benchmark::internal::Benchmark *b) { b->Unit(benchmark::kMicrosecond); }
+
+    static void SupportedEffectArgs(benchmark::internal::Benchmark *b) {
+        b->ArgNames({"Effect", "Strength"});
+        for (Effect effect : ndk::enum_range<Effect>()) {
+            for (EffectStrength strength : ndk::enum_range<EffectStrength>()) {
+                b->Args({static_cast<long>(effect), static_cast<long>(strength)});
+            }
+        }
+    }
+
+    static void CompositionSizeArgs(benchmark::internal::Benchmark *b) {
+        b->ArgName("Size");
+        for (long size : {1, 4, 16}) {
+            b->Arg(size);
+        }
+    }
+
+  protected:
+    std::shared_ptr<IVibrator> mVibrator;
+};
+
+#define BENCHMARK_WRAPPER(fixt, test, code) \
+    BENCHMARK_DEFINE_F(fixt, test)          \
+    /* NOLINTNEXTLINE */                    \
+    (benchmark::State & state){code} BENCHMARK_REGISTER_F(fixt, test)->Apply(fixt::DefaultArgs)
+
+BENCHMARK_WRAPPER(VibratorBench, on, {
+    uint32_t duration = std::rand() ?: 1;
+
+    for (auto _ : state) {
+        mVibrator->on(duration, nullptr);
+    }
+});
+
+BENCHMARK_WRAPPER(VibratorBench, off, {
+    for (auto _ : state) {
+        mVibrator->off();
+    }
+});
+
+BENCHMARK_WRAPPER(VibratorBench, setAmplitude, {
+    float amplitude = 1.0f;
+
+    for (auto _ : state) {
+        mVibrator->setAmplitude(amplitude);
+    }
+});
+
+BENCHMARK_WRAPPER(VibratorBench, getCapabilities, {
+    int32_t capabilities;
+
+    for (auto _ : state) {
+        mVibrator->getCapabilities(&capabilities);
+    }
+});
+
+BENCHMARK_WRAPPER(VibratorBench, perform, {
+    Effect effect = Effect(state.range(0));
+    EffectStrength strength = EffectStrength(state.range(1));
+    int32_t lengthMs;
+
+    ndk::ScopedAStatus status = mVibrator->perform(effect, strength, nullptr, &lengthMs);
+
+    if (!status.isOk()) {
+        return;
+    }
+
+    for (auto _ : state) {
+        mVibrator->perform(effect, strength, nullptr, &lengthMs);
+    }
+})->Apply(VibratorBench::SupportedEffectArgs);
+
+BENCHMARK_WRAPPER(VibratorBench, compose, {
+    std::vector<CompositeEffect> composite(state.range(0));
+
+    for (auto &e : composite) {
+        e.primitive = CompositePrimitive::CLICK;
+        e.scale = 1.0f;
+        e.delayMs = 10;
+    }
+
+    for (auto _ : state) {
+        mVibrator->compose(composite, nullptr);
+    }
+})->Apply(VibratorBench::CompositionSizeArgs);
+
+}  // namespace vibrator
+}  // namespace hardware
+}  // namespace android
+}  // namespace aidl
+
+BENCHMARK_MAIN();
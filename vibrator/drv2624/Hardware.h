@@ -15,6 +15,8 @@
  */
 #pragma once
 
+#include <android-base/properties.h>
+
 #include "HardwareBase.h"
 #include "Vibrator.h"
 
@@ -91,6 +93,8 @@ class HwCal : public Vibrator::HwCal, private HwCalBase {
   private:
     static constexpr char AUTOCAL_CONFIG[] = "autocal";
     static constexpr char LRA_PERIOD_CONFIG[] = "lra_period";
+    // Boot-scoped (non-persist) property, so a reboot always clears it.
+    static constexpr char CAL_FINGERPRINT_PROPERTY[] = "vendor.vibrator.drv2624.cal.fingerprint";
 
     static constexpr uint32_t WAVEFORM_CLICK_EFFECT_MS = 6;
     static constexpr uint32_t WAVEFORM_TICK_EFFECT_MS = 2;
@@ -140,6 +144,13 @@ class HwCal : public Vibrator::HwCal, private HwCalBase {
     bool getHeavyClickDuration(uint32_t *value) override {
         return getProperty("heavyclick.duration", value, WAVEFORM_HEAVY_CLICK_EFFECT_MS);
     }
+    bool getCalFingerprint(std::string *value) override {
+        *value = ::android::base::GetProperty(CAL_FINGERPRINT_PROPERTY, "");
+        return !value->empty();
+    }
+    bool setCalFingerprint(const std::string &value) override {
+        return ::android::base::SetProperty(CAL_FINGERPRINT_PROPERTY, value);
+    }
     void debug(int fd) override { HwCalBase::debug(fd); }
 };
 
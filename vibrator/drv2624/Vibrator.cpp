@@ -72,10 +72,19 @@ Vibrator::Vibrator(std::unique_ptr<HwApi> hwapi, std::unique_ptr<HwCal> hwcal)
         ALOGE("Failed to set state (%d): %s", errno, strerror(errno));
     }
 
-    if (mHwCal->getAutocal(&autocal)) {
+    bool hasAutocal = mHwCal->getAutocal(&autocal);
+    mHwCal->getLraPeriod(&lraPeriod);
+
+    // The driver retains its calibration registers for the lifetime of a boot,
+    // so when a restarted HAL would reprogram the values recorded earlier in
+    // the same boot, skip the sysfs writes to shorten time-to-first-haptic.
+    std::string calFingerprint = autocal + "/" + std::to_string(lraPeriod);
+    std::string calProgrammed;
+    bool calCached = mHwCal->getCalFingerprint(&calProgrammed) && calProgrammed == calFingerprint;
+
+    if (hasAutocal && !calCached) {
         mHwApi->setAutocal(autocal);
     }
-    mHwCal->getLraPeriod(&lraPeriod);
 
     mHwCal->getCloseLoopThreshold(&mCloseLoopThreshold);
     mHwCal->getDynamicConfig(&dynamicConfig);
@@ -101,10 +110,14 @@ Vibrator::Vibrator(std::unique_ptr<HwApi> hwapi, std::unique_ptr<HwCal> hwcal)
                 // 3. Get final long lra period after put the frequency' to formula
                 .olLraPeriod = freqPeriodFormula(freqPeriodFormula(lraPeriod) - longFreqencyShift),
         }));
-    } else {
+    } else if (!calCached) {
         mHwApi->setOlLraPeriod(lraPeriod);
     }
 
+    if (!calCached) {
+        mHwCal->setCalFingerprint(calFingerprint);
+    }
+
     mHwCal->getClickDuration(&mClickDuration);
     mHwCal->getTickDuration(&mTickDuration);
     mHwCal->getDoubleClickDuration(&mDoubleClickDuration);
@@ -111,6 +111,13 @@ class Vibrator : public BnVibrator {
         virtual bool getDoubleClickDuration(uint32_t *value) = 0;
         // Obtains the duration for the heavy-click effect
         virtual bool getHeavyClickDuration(uint32_t *value) = 0;
+        // Obtains the fingerprint of the calibration last programmed into the
+        // driver, if any was recorded this boot.
+        virtual bool getCalFingerprint(std::string *value) = 0;
+        // Records the fingerprint of the calibration just programmed into the
+        // driver. The record must not survive a reboot, since the driver
+        // loses its registers across one.
+        virtual bool setCalFingerprint(const std::string &value) = 0;
         // Emit diagnostic information to the given file.
         virtual void debug(int fd) = 0;
     };
@@ -55,6 +55,8 @@ class MockCal : public ::aidl::android::hardware::vibrator::Vibrator::HwCal {
     MOCK_METHOD1(getTickDuration, bool(uint32_t *value));
     MOCK_METHOD1(getDoubleClickDuration, bool(uint32_t *value));
     MOCK_METHOD1(getHeavyClickDuration, bool(uint32_t *value));
+    MOCK_METHOD1(getCalFingerprint, bool(std::string *value));
+    MOCK_METHOD1(setCalFingerprint, bool(const std::string &value));
     MOCK_METHOD1(debug, void(int fd));
 
     ~MockCal() override { destructor(); };
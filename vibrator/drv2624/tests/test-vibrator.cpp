@@ -229,6 +229,8 @@ class VibratorTestTemplate : public Test, public WithParamInterface<std::tuple<b
         EXPECT_CALL(*mMockCal, getTickDuration(_)).Times(times);
         EXPECT_CALL(*mMockCal, getDoubleClickDuration(_)).Times(times);
         EXPECT_CALL(*mMockCal, getHeavyClickDuration(_)).Times(times);
+        EXPECT_CALL(*mMockCal, getCalFingerprint(_)).Times(times);
+        EXPECT_CALL(*mMockCal, setCalFingerprint(_)).Times(times);
         EXPECT_CALL(*mMockCal, debug(_)).Times(times);
     }
 
@@ -271,6 +273,10 @@ TEST_P(BasicTest, Constructor) {
 
     EXPECT_CALL(*mMockCal, getLraPeriod(_)).InSequence(lraPeriodSeq).WillOnce(DoDefault());
 
+    EXPECT_CALL(*mMockCal, getCalFingerprint(_)).WillOnce(Return(false));
+    EXPECT_CALL(*mMockCal, setCalFingerprint(autocalVal + "/" + std::to_string(mShortLraPeriod)))
+            .WillOnce(Return(true));
+
     EXPECT_CALL(*mMockCal, getCloseLoopThreshold(_)).WillOnce(DoDefault());
     EXPECT_CALL(*mMockCal, getDynamicConfig(_)).WillOnce(DoDefault());
 
@@ -292,6 +298,48 @@ TEST_P(BasicTest, Constructor) {
     createVibrator(std::move(mockapi), std::move(mockcal), false);
 }
 
+TEST_P(BasicTest, Constructor_cachedCal) {
+    std::unique_ptr<MockApi> mockapi;
+    std::unique_ptr<MockCal> mockcal;
+    std::string autocalVal = std::to_string(std::rand()) + " " + std::to_string(std::rand()) + " " +
+                             std::to_string(std::rand());
+
+    EXPECT_CALL(*mMockApi, destructor()).WillOnce(DoDefault());
+    EXPECT_CALL(*mMockCal, destructor()).WillOnce(DoDefault());
+
+    deleteVibrator(false);
+
+    createMock(&mockapi, &mockcal);
+
+    EXPECT_CALL(*mMockApi, setState(true)).WillOnce(Return(true));
+
+    EXPECT_CALL(*mMockCal, getAutocal(_))
+            .WillOnce(DoAll(SetArgReferee<0>(autocalVal), Return(true)));
+    EXPECT_CALL(*mMockCal, getLraPeriod(_)).WillOnce(DoDefault());
+
+    // A matching fingerprint from earlier in the boot means the driver already
+    // holds this calibration; no programming or fingerprint update happens.
+    EXPECT_CALL(*mMockCal, getCalFingerprint(_))
+            .WillOnce(DoAll(SetArgPointee<0>(autocalVal + "/" + std::to_string(mShortLraPeriod)),
+                            Return(true)));
+
+    EXPECT_CALL(*mMockCal, getCloseLoopThreshold(_)).WillOnce(DoDefault());
+    EXPECT_CALL(*mMockCal, getDynamicConfig(_)).WillOnce(DoDefault());
+
+    if (getDynamicConfig()) {
+        EXPECT_CALL(*mMockCal, getLongFrequencyShift(_)).WillOnce(DoDefault());
+        EXPECT_CALL(*mMockCal, getShortVoltageMax(_)).WillOnce(DoDefault());
+        EXPECT_CALL(*mMockCal, getLongVoltageMax(_)).WillOnce(DoDefault());
+    }
+
+    EXPECT_CALL(*mMockCal, getClickDuration(_)).WillOnce(DoDefault());
+    EXPECT_CALL(*mMockCal, getTickDuration(_)).WillOnce(DoDefault());
+    EXPECT_CALL(*mMockCal, getDoubleClickDuration(_)).WillOnce(DoDefault());
+    EXPECT_CALL(*mMockCal, getHeavyClickDuration(_)).WillOnce(DoDefault());
+
+    createVibrator(std::move(mockapi), std::move(mockcal), false);
+}
+
 TEST_P(BasicTest, on) {
     EffectDuration duration = std::rand();
     ExpectationSet e;